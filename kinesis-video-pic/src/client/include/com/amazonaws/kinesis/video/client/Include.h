@@ -164,6 +164,12 @@ extern "C" {
 #define STATUS_ACK_ERR_UNKNOWN_ACK_ERROR                                            STATUS_CLIENT_BASE + 0x0000006f
 #define STATUS_MISSING_ERR_ACK_ID                                                   STATUS_CLIENT_BASE + 0x00000070
 #define STATUS_INVALID_ACK_SEGMENT_LEN                                              STATUS_CLIENT_BASE + 0x00000071
+#define STATUS_INVALID_STREAM_ARENA_RATIO                                           STATUS_CLIENT_BASE + 0x00000072
+#define STATUS_STREAM_DATA_SPAN_PINNED                                              STATUS_CLIENT_BASE + 0x00000073
+#define STATUS_INVALID_STREAM_DATA_SPAN                                             STATUS_CLIENT_BASE + 0x00000074
+#define STATUS_MULTI_TRACK_FORMAT_CHANGE_NOT_SUPPORTED                              STATUS_CLIENT_BASE + 0x00000075
+#define STATUS_INVALID_TRACK_INFO_LIST                                              STATUS_CLIENT_BASE + 0x00000076
+#define STATUS_INVALID_STANDBY_CONNECTION_PERIOD                                    STATUS_CLIENT_BASE + 0x00000077
 
 ////////////////////////////////////////////////////
 // Main defines
@@ -228,6 +234,11 @@ extern "C" {
  */
 #define MAX_STORAGE_ALLOCATION_SIZE              (10LLU * 1024 * 1024 * 1024)
 
+/**
+ * Minimal size of the per-stream storage arena and the shared overflow pool = MIN heap size
+ */
+#define MIN_STREAM_ARENA_SIZE                    MIN_HEAP_SIZE
+
 /**
  * Max number of fragment metadatas in the segment
  */
@@ -258,6 +269,14 @@ extern "C" {
  */
 #define STREAMING_TOKEN_EXPIRATION_GRACE_PERIOD     (3 * HUNDREDS_OF_NANOS_IN_A_SECOND)
 
+/**
+ * Default period ahead of the grace period at which the streaming token rotation is started - 10 seconds.
+ * The new token is fetched and the standby PutMedia connection is established while the current
+ * connection keeps streaming. The upload switches to the standby connection on a fragment boundary.
+ * The period can be configured per stream with the standby connection period of the stream caps.
+ */
+#define STREAMING_TOKEN_STANDBY_CONNECTION_PERIOD   (10 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
 /**
  * Default frame rate - NTSC standard
  */
@@ -345,10 +364,10 @@ extern "C" {
  */
 #define DEVICE_INFO_CURRENT_VERSION                         0
 #define CALLBACKS_CURRENT_VERSION                           0
-#define STREAM_INFO_CURRENT_VERSION                         0
+#define STREAM_INFO_CURRENT_VERSION                         2
 #define TAG_CURRENT_VERSION                                 0
 #define SEGMENT_INFO_CURRENT_VERSION                        0
-#define STORAGE_INFO_CURRENT_VERSION                        0
+#define STORAGE_INFO_CURRENT_VERSION                        2
 #define AUTH_INFO_CURRENT_VERSION                           0
 #define SERVICE_CALL_CONTEXT_CURRENT_VERSION                0
 #define STREAM_DESCRIPTION_CURRENT_VERSION                  0
@@ -812,6 +831,22 @@ struct __StreamCaps {
 
     // Codec private data. Can be NULL if no CPD is used.
     PBYTE codecPrivateData;
+
+    // Number of the tracks in the track info list. 0 for a single track stream described by
+    // the content type, codec id, track name and the codec private data above.
+    // NOTE: Available from version 1 of the stream info struct.
+    UINT32 trackInfoCount;
+
+    // Track info list. The frames of the stream are tagged with the track ids of the list.
+    // The stream content type is still used to describe the stream as a whole.
+    // NOTE: Available from version 1 of the stream info struct.
+    PTrackInfo trackInfoList;
+
+    // Period in 100ns ahead of the streaming token expiration grace period at which the token rotation
+    // is started and the standby connection is established. 0 for STREAMING_TOKEN_STANDBY_CONNECTION_PERIOD.
+    // The period and the grace period should be less than MIN_STREAMING_TOKEN_EXPIRATION_DURATION.
+    // NOTE: Available from version 2 of the stream info struct.
+    UINT64 standbyConnectionPeriod;
 };
 
 typedef __StreamCaps* PStreamCaps;
@@ -866,6 +901,16 @@ struct __StorageInfo {
 
     // File location in case of the file based storage
     CHAR rootDirectory[MAX_PATH_LEN];
+
+    // Percentage of the storage in 0 - 100% to be partitioned evenly into per-stream arenas.
+    // The rest of the storage is used as a shared overflow pool. 0 disables the arenas.
+    // NOTE: Available from version 1 of the struct.
+    UINT32 streamArenaRatio;
+
+    // Whether to store the frames of a fragment in a single allocation instead of an allocation per frame.
+    // Reduces the per-frame heap overhead and lets the fragment be read with a single mapping.
+    // NOTE: Available from version 2 of the struct.
+    BOOL fragmentStorage;
 };
 
 typedef __StorageInfo* PStorageInfo;
@@ -1078,6 +1123,23 @@ struct __ServiceCallContext {
 
 typedef __ServiceCallContext* PServiceCallContext;
 
+/**
+ * Read-only span over the stream data pinned in the content store
+ */
+typedef struct __StreamDataSpan StreamDataSpan;
+struct __StreamDataSpan {
+    // Pointer to the pinned stream data. Must not be modified.
+    PBYTE pData;
+
+    // Size of the span in bytes
+    UINT32 size;
+
+    // Token to release the span with
+    UINT64 releaseToken;
+};
+
+typedef __StreamDataSpan* PStreamDataSpan;
+
 ////////////////////////////////////////////////////
 // General callbacks definitions
 ////////////////////////////////////////////////////
@@ -1198,6 +1260,21 @@ typedef STATUS (*DroppedFragmentReportFunc)(UINT64,
                                             STREAM_HANDLE,
                                             UINT64);
 
+/**
+ * Releases the frame data referenced by the stream when it's no longer needed.
+ *
+ * NOTE: The callback is invoked under the stream lock and should not call into the client.
+ *
+ * @param 1 UINT64 - Custom handle passed by the caller with the frame.
+ * @param 2 PBYTE - The referenced frame data.
+ * @param 3 UINT32 - The size of the referenced frame data.
+ *
+ * @return Status of the callback
+ */
+typedef STATUS (*FrameDataReleaseFunc)(UINT64,
+                                       PBYTE,
+                                       UINT32);
+
 /**
  * Reports a stream error due to an error ACK. The client should terminate
  * the current stream as the inlet host has/will close the connection.
@@ -1605,6 +1682,41 @@ PUBLIC_API STATUS stopKinesisVideoStream(STREAM_HANDLE);
  */
 PUBLIC_API STATUS putKinesisVideoFrame(STREAM_HANDLE, PFrame);
 
+/**
+ * Puts a batch of frames into the stream. The stream locking, the state checks and the
+ * data available notification are processed once per batch rather than per frame.
+ * The client lock is released between the frames.
+ *
+ * NOTE: The frames are processed in order. If a frame fails, the preceding frames
+ * remain stored, their count is returned and the status of the failed frame is returned.
+ *
+ * @param 1 STREAM_HANDLE - the stream handle.
+ * @param 2 PFrame - the array of frames to process.
+ * @param 3 UINT32 - the number of frames in the array.
+ * @param 4 PUINT32 - OPTIONAL - returns the number of frames stored.
+ *
+ * @return Status of the function call.
+ */
+PUBLIC_API STATUS putKinesisVideoFrames(STREAM_HANDLE, PFrame, UINT32, PUINT32);
+
+/**
+ * Puts a frame into the stream referencing the caller frame data instead of copying it.
+ * Only the MKV elements preceding the frame data are stored and the frame data is
+ * streamed out of the caller buffer which should stay valid and unmodified until released.
+ *
+ * NOTE: The release callback is fired exactly once when the frame is purged from the content
+ * store or the stream is freed. The caller retains the ownership of the frame data if the call fails.
+ * NOTE: The frames which require NALs adaptation can't be referenced.
+ *
+ * @param 1 STREAM_HANDLE - the stream handle.
+ * @param 2 PFrame - the frame to process.
+ * @param 3 FrameDataReleaseFunc - the callback to release the frame data.
+ * @param 4 UINT64 - custom data to be passed to the release callback.
+ *
+ * @return Status of the function call.
+ */
+PUBLIC_API STATUS putKinesisVideoFrameReference(STREAM_HANDLE, PFrame, FrameDataReleaseFunc, UINT64);
+
 /**
  * Gets the data for the stream.
  *
@@ -1622,6 +1734,56 @@ PUBLIC_API STATUS putKinesisVideoFrame(STREAM_HANDLE, PFrame);
  */
 PUBLIC_API STATUS getKinesisVideoStreamData(STREAM_HANDLE, PUINT64, PBYTE, UINT32, PUINT32);
 
+/**
+ * Gets a read-only span over the next contiguous stream data without copying it.
+ *
+ * NOTE: The span is pinned in the content store and will remain valid even if the
+ * underlying frame is evicted from the view until it's released. Only a single span
+ * per stream can be outstanding at a time. The span is consumed as the data is returned.
+ *
+ * @param 1 STREAM_HANDLE - the stream handle.
+ * @param 2 PUINT64 - Client stream upload handle.
+ * @param 3 UINT32 - Max size of the span.
+ * @param 4 PStreamDataSpan - OUT - The pinned span.
+ *
+ * @return Status of the function call.
+ */
+PUBLIC_API STATUS getKinesisVideoStreamDataSpan(STREAM_HANDLE, PUINT64, UINT32, PStreamDataSpan);
+
+/**
+ * Gets the data for the stream similar to getKinesisVideoStreamData but pins the rest of
+ * the contiguous stream data which is larger than the entire buffer instead of copying it.
+ *
+ * NOTE: The buffer is filled up to the pinned data which is returned in the span. The span
+ * covers the rest of the view item data and is released with releaseKinesisVideoStreamDataSpan.
+ * The span release token is invalid if no data has been pinned.
+ *
+ * @param 1 STREAM_HANDLE - the stream handle.
+ * @param 2 PUINT64 - Client stream upload handle.
+ * @param 3 PBYTE - Buffer to fill in.
+ * @param 4 UINT32 - Size of the buffer to fill up-to.
+ * @param 5 PUINT32 - Actual size filled.
+ * @param 6 PStreamDataSpan - OUT - The pinned span.
+ *
+ * @return Status of the function call.
+ */
+PUBLIC_API STATUS getKinesisVideoStreamDataWithSpan(STREAM_HANDLE, PUINT64, PBYTE, UINT32, PUINT32, PStreamDataSpan);
+
+/**
+ * Releases the stream data span returned by getKinesisVideoStreamDataSpan.
+ *
+ * NOTE: The release token is unique for the lifetime of the stream. The outstanding span is
+ * released with the stream so the token must not be used once the stream is freed.
+ * The data available callback is fired for the upload handles if a read has been rejected
+ * with STATUS_STREAM_DATA_SPAN_PINNED while the span was outstanding.
+ *
+ * @param 1 STREAM_HANDLE - the stream handle.
+ * @param 2 UINT64 - The release token of the span.
+ *
+ * @return Status of the function call.
+ */
+PUBLIC_API STATUS releaseKinesisVideoStreamDataSpan(STREAM_HANDLE, UINT64);
+
 ////////////////////////////////////////////////////
 // Diagnostics functions
 ////////////////////////////////////////////////////
@@ -30,12 +30,17 @@ CleanUp:
 STATUS parseFragmentAck(PKinesisVideoStream pKinesisVideoStream, UPLOAD_HANDLE uploadHandle, PCHAR ackSegment, UINT32 ackSegmentSize) {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 index = 0;
-    UINT32 level = 0;
+    ProfilerTrace profilerTrace = PROFILER_TRACE_INITIALIZER;
+    PFragmentAckParser pFragmentAckParser;
+    PCHAR pCur, pEnd, pTokenEnd, pToken;
+    UINT32 tokenLen;
     CHAR curChar;
 
     CHK(pKinesisVideoStream != NULL && ackSegment != NULL, STATUS_NULL_ARG);
 
+    PROFILER_TRACE_START("parseFragmentAck", TRACE_LEVEL_INFO, &profilerTrace);
+    pFragmentAckParser = &pKinesisVideoStream->fragmentAckParser;
+
     // If ack segment is specified and ack segment size is 0 then we should get the C-string size
     if (0 == ackSegmentSize) {
         ackSegmentSize = STRNLEN(ackSegment, MAX_ACK_FRAGMENT_LEN);
@@ -44,62 +49,72 @@ STATUS parseFragmentAck(PKinesisVideoStream pKinesisVideoStream, UPLOAD_HANDLE u
     }
 
     // Set the upload handle
-    if (!IS_VALID_UPLOAD_HANDLE(pKinesisVideoStream->fragmentAckParser.uploadHandle)) {
-        pKinesisVideoStream->fragmentAckParser.uploadHandle = uploadHandle;
+    if (!IS_VALID_UPLOAD_HANDLE(pFragmentAckParser->uploadHandle)) {
+        pFragmentAckParser->uploadHandle = uploadHandle;
     }
 
-    for (index = 0; index < ackSegmentSize; index++) {
-        curChar = ackSegment[index];
+    pCur = ackSegment;
+    pEnd = ackSegment + ackSegmentSize;
 
-        switch (pKinesisVideoStream->fragmentAckParser.state) {
+    // The states consuming strings and values jump to the terminating character in one go
+    while (pCur < pEnd) {
+        switch (pFragmentAckParser->state) {
             case FRAGMENT_ACK_PARSER_STATE_START:
                 // Skip until the start of the segment
-                if (ACK_PARSER_OPEN_BRACE == curChar) {
+                pTokenEnd = (PCHAR) MEMCHR(pCur, ACK_PARSER_OPEN_BRACE, pEnd - pCur);
+                if (pTokenEnd == NULL) {
+                    pCur = pEnd;
+                } else {
                     // Move to segment start state
-                    pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_ACK_START;
+                    pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_ACK_START;
+                    pCur = pTokenEnd + 1;
                 }
 
                 break;
 
             case FRAGMENT_ACK_PARSER_STATE_ACK_START:
                 // Skip until non-whitespace
+                curChar = *pCur++;
                 if (!IS_WHITE_SPACE(curChar)) {
                     // We should have a quote
                     CHK(curChar == ACK_PARSER_QUOTE, STATUS_INVALID_ACK_KEY_START);
 
                     // Start the key state
-                    pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_KEY_START;
+                    pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_KEY_START;
                 }
 
                 break;
 
             case FRAGMENT_ACK_PARSER_STATE_KEY_START:
-                // Accumulate until end of string
-                if (curChar == ACK_PARSER_QUOTE) {
-                    // End of key start - parse the key name
-                    pKinesisVideoStream->fragmentAckParser.accumulator[pKinesisVideoStream->fragmentAckParser.curPos] = '\0';
-                    pKinesisVideoStream->fragmentAckParser.curKeyName = getFragmentAckKeyName(
-                            pKinesisVideoStream->fragmentAckParser.accumulator);
+                // Find the end of the key string
+                pTokenEnd = (PCHAR) MEMCHR(pCur, ACK_PARSER_QUOTE, pEnd - pCur);
+                if (pTokenEnd == NULL) {
+                    // The key continues in the next chunk
+                    CHK_STATUS(accumulateAckToken(pFragmentAckParser, pCur, (UINT32) (pEnd - pCur)));
+                    pCur = pEnd;
+                    break;
+                }
 
-                    // Move to delimiter state
-                    pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_DELIMITER;
+                // End of key start - parse the key name
+                CHK_STATUS(getAckToken(pFragmentAckParser, pCur, pTokenEnd, &pToken, &tokenLen));
+                pFragmentAckParser->curKeyName = getFragmentAckKeyName(pToken, tokenLen);
 
-                    // Reset the cur position of the accumulator
-                    pKinesisVideoStream->fragmentAckParser.curPos = 0;
+                // Move to delimiter state
+                pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_DELIMITER;
 
-                } else {
-                    // Accumulate it
-                    pKinesisVideoStream->fragmentAckParser.accumulator[pKinesisVideoStream->fragmentAckParser.curPos++] = curChar;
-                }
+                // Reset the cur position of the accumulator
+                pFragmentAckParser->curPos = 0;
+                pCur = pTokenEnd + 1;
 
                 break;
 
             case FRAGMENT_ACK_PARSER_STATE_DELIMITER:
                 // Skip whitespaces until the delimiter
+                curChar = *pCur++;
                 if (!IS_WHITE_SPACE(curChar)) {
                     if (curChar == ACK_PARSER_DELIMITER) {
                         // Move to the body start state
-                        pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_BODY_START;
+                        pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_BODY_START;
                     }
                 }
 
@@ -107,117 +122,112 @@ STATUS parseFragmentAck(PKinesisVideoStream pKinesisVideoStream, UPLOAD_HANDLE u
 
             case FRAGMENT_ACK_PARSER_STATE_BODY_START:
                 // Skip whitespaces until the body start indicator
-                if (!IS_WHITE_SPACE(curChar)) {
-                    if (curChar == ACK_PARSER_OPEN_BRACE) {
-                        // Set the nestedness level
-                        level = 1;
-                        // Move to the skip body end state
-                        pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_SKIP_BODY_BRACE_END;
-                    } else if (curChar == ACK_PARSER_OPEN_BRACKET) {
-                        // Set the nestedness level
-                        level = 1;
-                        // Move to the skip body end state
-                        pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_SKIP_BODY_BRACKET_END;
-                    } else if (curChar == ACK_PARSER_QUOTE) {
-                        // Move to text value type
-                        pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_TEXT_VALUE;
-                    } else if (IS_ACK_START_OF_NUMERIC_VALUE(curChar)) {
-                        // Push the cur char to the accumulator
-                        pKinesisVideoStream->fragmentAckParser.accumulator[pKinesisVideoStream->fragmentAckParser.curPos++] = curChar;
-                        pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_NUMERIC_VALUE;
-                    } else {
-                        CHK(FALSE, STATUS_INVALID_ACK_INVALID_VALUE_START);
-                    }
+                curChar = *pCur;
+                if (IS_WHITE_SPACE(curChar)) {
+                    pCur++;
+                } else if (curChar == ACK_PARSER_OPEN_BRACE) {
+                    // Set the nestedness level
+                    pFragmentAckParser->level = 1;
+                    // Move to the skip body end state
+                    pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_SKIP_BODY_BRACE_END;
+                    pCur++;
+                } else if (curChar == ACK_PARSER_OPEN_BRACKET) {
+                    // Set the nestedness level
+                    pFragmentAckParser->level = 1;
+                    // Move to the skip body end state
+                    pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_SKIP_BODY_BRACKET_END;
+                    pCur++;
+                } else if (curChar == ACK_PARSER_QUOTE) {
+                    // Move to text value type
+                    pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_TEXT_VALUE;
+                    pCur++;
+                } else if (IS_ACK_START_OF_NUMERIC_VALUE(curChar)) {
+                    // The current char is the first char of the value
+                    pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_NUMERIC_VALUE;
+                } else {
+                    CHK(FALSE, STATUS_INVALID_ACK_INVALID_VALUE_START);
                 }
 
                 break;
 
             case FRAGMENT_ACK_PARSER_STATE_TEXT_VALUE:
-                // Accumulate until next quote
-                if (curChar == ACK_PARSER_QUOTE) {
-                    // Null terminate the string
-                    pKinesisVideoStream->fragmentAckParser.accumulator[pKinesisVideoStream->fragmentAckParser.curPos] = '\0';
+                // Find the closing quote
+                pTokenEnd = (PCHAR) MEMCHR(pCur, ACK_PARSER_QUOTE, pEnd - pCur);
+                if (pTokenEnd == NULL) {
+                    // The value continues in the next chunk
+                    CHK_STATUS(accumulateAckToken(pFragmentAckParser, pCur, (UINT32) (pEnd - pCur)));
+                    pCur = pEnd;
+                    break;
+                }
 
-                    // Process the value
-                    CHK_STATUS(processAckValue(&pKinesisVideoStream->fragmentAckParser));
+                // Process the value
+                CHK_STATUS(getAckToken(pFragmentAckParser, pCur, pTokenEnd, &pToken, &tokenLen));
+                CHK_STATUS(processAckValue(pFragmentAckParser, pToken, tokenLen));
 
-                    // Skip until the end of the value
-                    pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_VALUE_END;
-                } else {
-                    // Accumulate it
-                    pKinesisVideoStream->fragmentAckParser.accumulator[pKinesisVideoStream->fragmentAckParser.curPos++] = curChar;
-                }
+                // Skip until the end of the value
+                pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_VALUE_END;
+                pCur = pTokenEnd + 1;
 
                 break;
 
             case FRAGMENT_ACK_PARSER_STATE_NUMERIC_VALUE:
-                // Accumulate until delimitation
-                if (IS_WHITE_SPACE(curChar)) {
-                    // Null terminate the string
-                    pKinesisVideoStream->fragmentAckParser.accumulator[pKinesisVideoStream->fragmentAckParser.curPos] = '\0';
-
-                    // Process the value
-                    CHK_STATUS(processAckValue(&pKinesisVideoStream->fragmentAckParser));
-
-                    // Skip until the end of the value
-                    pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_VALUE_END;
-                } else if (curChar == ACK_PARSER_COMMA) {
-                    // Null terminate the string
-                    pKinesisVideoStream->fragmentAckParser.accumulator[pKinesisVideoStream->fragmentAckParser.curPos] = '\0';
+                // Find the delimitation
+                for (pTokenEnd = pCur; pTokenEnd < pEnd && !IS_ACK_END_OF_NUMERIC_VALUE(*pTokenEnd); pTokenEnd++);
+                if (pTokenEnd == pEnd) {
+                    // The value continues in the next chunk
+                    CHK_STATUS(accumulateAckToken(pFragmentAckParser, pCur, (UINT32) (pEnd - pCur)));
+                    pCur = pEnd;
+                    break;
+                }
 
-                    // Process the value
-                    CHK_STATUS(processAckValue(&pKinesisVideoStream->fragmentAckParser));
+                curChar = *pTokenEnd;
+                CHK(IS_WHITE_SPACE(curChar) || curChar == ACK_PARSER_COMMA || curChar == ACK_PARSER_CLOSE_BRACE,
+                    STATUS_INVALID_ACK_INVALID_VALUE_END);
 
-                    pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_VALUE_END;
-                } else if (curChar == ACK_PARSER_CLOSE_BRACE) {
-                    // Null terminate the string
-                    pKinesisVideoStream->fragmentAckParser.accumulator[pKinesisVideoStream->fragmentAckParser.curPos] = '\0';
-
-                    // Process the value
-                    CHK_STATUS(processAckValue(&pKinesisVideoStream->fragmentAckParser));
+                // Process the value
+                CHK_STATUS(getAckToken(pFragmentAckParser, pCur, pTokenEnd, &pToken, &tokenLen));
+                CHK_STATUS(processAckValue(pFragmentAckParser, pToken, tokenLen));
 
+                if (curChar == ACK_PARSER_CLOSE_BRACE) {
                     // Process the parsed ACK
                     CHK_STATUS(processParsedAck(pKinesisVideoStream));
-                } else if (curChar == ACK_PARSER_QUOTE
-                           || curChar == ACK_PARSER_OPEN_BRACE
-                           || curChar == ACK_PARSER_OPEN_BRACKET
-                           || curChar == ACK_PARSER_CLOSE_BRACKET
-                           || curChar == ACK_PARSER_DELIMITER) {
-                    // Error condition
-                    CHK(FALSE, STATUS_INVALID_ACK_INVALID_VALUE_END);
                 } else {
-                    // Accumulate it
-                    pKinesisVideoStream->fragmentAckParser.accumulator[pKinesisVideoStream->fragmentAckParser.curPos++] = curChar;
+                    // Skip until the end of the value
+                    pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_VALUE_END;
                 }
 
+                pCur = pTokenEnd + 1;
+
                 break;
 
             case FRAGMENT_ACK_PARSER_STATE_SKIP_BODY_BRACE_END:
                 // Skipping until the end of the body
+                curChar = *pCur++;
                 if (curChar == ACK_PARSER_OPEN_BRACE) {
-                    level++;
+                    pFragmentAckParser->level++;
                 } else if (curChar == ACK_PARSER_CLOSE_BRACE) {
-                    level--;
+                    pFragmentAckParser->level--;
                 }
 
-                if (0 == level) {
+                if (0 == pFragmentAckParser->level) {
                     // Body skipped. Move to next state
-                    pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_VALUE_END;
+                    pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_VALUE_END;
                 }
 
                 break;
 
             case FRAGMENT_ACK_PARSER_STATE_SKIP_BODY_BRACKET_END:
                 // Skipping until the end of the body
+                curChar = *pCur++;
                 if (curChar == ACK_PARSER_OPEN_BRACKET) {
-                    level++;
+                    pFragmentAckParser->level++;
                 } else if (curChar == ACK_PARSER_CLOSE_BRACKET) {
-                    level--;
+                    pFragmentAckParser->level--;
                 }
 
-                if (0 == level) {
+                if (0 == pFragmentAckParser->level) {
                     // Body skipped. Move to next state
-                    pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_VALUE_END;
+                    pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_VALUE_END;
                 }
 
                 break;
@@ -225,6 +235,7 @@ STATUS parseFragmentAck(PKinesisVideoStream pKinesisVideoStream, UPLOAD_HANDLE u
             case FRAGMENT_ACK_PARSER_STATE_VALUE_END:
                 // End of the value
                 // Skip the whitespaces or comma
+                curChar = *pCur++;
                 if (IS_WHITE_SPACE(curChar) || ACK_PARSER_COMMA == curChar) {
                     break;
                 }
@@ -235,7 +246,7 @@ STATUS parseFragmentAck(PKinesisVideoStream pKinesisVideoStream, UPLOAD_HANDLE u
                     CHK_STATUS(processParsedAck(pKinesisVideoStream));
                 } else if (ACK_PARSER_QUOTE == curChar) {
                     // Start of the new key
-                    pKinesisVideoStream->fragmentAckParser.state = FRAGMENT_ACK_PARSER_STATE_KEY_START;
+                    pFragmentAckParser->state = FRAGMENT_ACK_PARSER_STATE_KEY_START;
                 } else {
                     // An error is detected
                     CHK(FALSE, STATUS_INVALID_ACK_KEY_START);
@@ -252,6 +263,48 @@ CleanUp:
         resetAckParserState(pKinesisVideoStream);
     }
 
+    PROFILER_TRACE_STOP(profilerTrace);
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS accumulateAckToken(PFragmentAckParser pFragmentAckParser, PCHAR pStart, UINT32 size) {
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pFragmentAckParser != NULL && pStart != NULL, STATUS_NULL_ARG);
+    CHK(pFragmentAckParser->curPos + size <= MAX_ACK_FRAGMENT_LEN, STATUS_INVALID_ACK_SEGMENT_LEN);
+
+    MEMCPY(pFragmentAckParser->accumulator + pFragmentAckParser->curPos, pStart, size);
+    pFragmentAckParser->curPos += size;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS getAckToken(PFragmentAckParser pFragmentAckParser, PCHAR pStart, PCHAR pEnd, PCHAR* ppToken, PUINT32 pTokenLen) {
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pFragmentAckParser != NULL && pStart != NULL && pEnd != NULL && ppToken != NULL && pTokenLen != NULL, STATUS_NULL_ARG);
+
+    if (0 == pFragmentAckParser->curPos) {
+        // The entire token is in the current chunk
+        *ppToken = pStart;
+        *pTokenLen = (UINT32) (pEnd - pStart);
+    } else {
+        // Complete the token started in the previous chunks
+        CHK_STATUS(accumulateAckToken(pFragmentAckParser, pStart, (UINT32) (pEnd - pStart)));
+        pFragmentAckParser->accumulator[pFragmentAckParser->curPos] = '\0';
+        *ppToken = pFragmentAckParser->accumulator;
+        *pTokenLen = pFragmentAckParser->curPos;
+    }
+
+CleanUp:
+
     LEAVES();
     return retStatus;
 }
@@ -277,42 +330,84 @@ CleanUp:
     return retStatus;
 }
 
-FRAGMENT_ACK_TYPE getFragmentAckType(PCHAR eventType) {
-    if (0 == STRNCMP(ACK_EVENT_TYPE_BUFFERING, eventType, SIZEOF(ACK_EVENT_TYPE_BUFFERING))) {
-        return FRAGMENT_ACK_TYPE_BUFFERING;
-    } else if (0 == STRNCMP(ACK_EVENT_TYPE_RECEIVED, eventType, SIZEOF(ACK_EVENT_TYPE_RECEIVED))) {
-        return FRAGMENT_ACK_TYPE_RECEIVED;
-    } else if (0 == STRNCMP(ACK_EVENT_TYPE_PERSISTED, eventType, SIZEOF(ACK_EVENT_TYPE_PERSISTED))) {
-        return FRAGMENT_ACK_TYPE_PERSISTED;
-    } else if (0 == STRNCMP(ACK_EVENT_TYPE_ERROR, eventType, SIZEOF(ACK_EVENT_TYPE_ERROR))) {
-        return FRAGMENT_ACK_TYPE_ERROR;
-    } else if (0 == STRNCMP(ACK_EVENT_TYPE_IDLE, eventType, SIZEOF(ACK_EVENT_TYPE_IDLE))) {
-        return FRAGMENT_ACK_TYPE_IDLE;
-    } else {
-        return FRAGMENT_ACK_TYPE_UNDEFINED;
+FRAGMENT_ACK_TYPE getFragmentAckType(PCHAR eventType, UINT32 length) {
+    FRAGMENT_ACK_TYPE ackType;
+    PCHAR pExpected;
+
+    // Only the buffering and the persisted event types have the same length
+    switch (length) {
+        case SIZEOF(ACK_EVENT_TYPE_BUFFERING) - 1:
+            if (eventType[0] == ACK_EVENT_TYPE_BUFFERING[0]) {
+                ackType = FRAGMENT_ACK_TYPE_BUFFERING;
+                pExpected = (PCHAR) ACK_EVENT_TYPE_BUFFERING;
+            } else {
+                ackType = FRAGMENT_ACK_TYPE_PERSISTED;
+                pExpected = (PCHAR) ACK_EVENT_TYPE_PERSISTED;
+            }
+
+            break;
+
+        case SIZEOF(ACK_EVENT_TYPE_RECEIVED) - 1:
+            ackType = FRAGMENT_ACK_TYPE_RECEIVED;
+            pExpected = (PCHAR) ACK_EVENT_TYPE_RECEIVED;
+            break;
+
+        case SIZEOF(ACK_EVENT_TYPE_ERROR) - 1:
+            ackType = FRAGMENT_ACK_TYPE_ERROR;
+            pExpected = (PCHAR) ACK_EVENT_TYPE_ERROR;
+            break;
+
+        case SIZEOF(ACK_EVENT_TYPE_IDLE) - 1:
+            ackType = FRAGMENT_ACK_TYPE_IDLE;
+            pExpected = (PCHAR) ACK_EVENT_TYPE_IDLE;
+            break;
+
+        default:
+            return FRAGMENT_ACK_TYPE_UNDEFINED;
     }
+
+    return 0 == MEMCMP(pExpected, eventType, length) ? ackType : FRAGMENT_ACK_TYPE_UNDEFINED;
 }
 
-FRAGMENT_ACK_KEY_NAME getFragmentAckKeyName(PCHAR keyName) {
-    if (0 == STRNCMP(ACK_KEY_NAME_EVENT_TYPE, keyName, SIZEOF(ACK_KEY_NAME_EVENT_TYPE))) {
-        return FRAGMENT_ACK_KEY_NAME_EVENT_TYPE;
-    } else if (0 == STRNCMP(ACK_KEY_NAME_FRAGMENT_NUMBER, keyName, SIZEOF(ACK_KEY_NAME_FRAGMENT_NUMBER))) {
-        return FRAGMENT_ACK_KEY_NAME_FRAGMENT_NUMBER;
-    } else if (0 == STRNCMP(ACK_KEY_NAME_FRAGMENT_TIMECODE, keyName, SIZEOF(ACK_KEY_NAME_FRAGMENT_TIMECODE))) {
-        return FRAGMENT_ACK_KEY_NAME_FRAGMENT_TIMECODE;
-    } else if (0 == STRNCMP(ACK_KEY_NAME_ERROR_ID, keyName, SIZEOF(ACK_KEY_NAME_ERROR_ID))) {
-        return FRAGMENT_ACK_KEY_NAME_ERROR_ID;
-    } else {
-        return FRAGMENT_ACK_KEY_NAME_UNKNOWN;
+FRAGMENT_ACK_KEY_NAME getFragmentAckKeyName(PCHAR keyName, UINT32 length) {
+    FRAGMENT_ACK_KEY_NAME ackKeyName;
+    PCHAR pExpected;
+
+    // The key names have distinct lengths
+    switch (length) {
+        case SIZEOF(ACK_KEY_NAME_EVENT_TYPE) - 1:
+            ackKeyName = FRAGMENT_ACK_KEY_NAME_EVENT_TYPE;
+            pExpected = (PCHAR) ACK_KEY_NAME_EVENT_TYPE;
+            break;
+
+        case SIZEOF(ACK_KEY_NAME_FRAGMENT_NUMBER) - 1:
+            ackKeyName = FRAGMENT_ACK_KEY_NAME_FRAGMENT_NUMBER;
+            pExpected = (PCHAR) ACK_KEY_NAME_FRAGMENT_NUMBER;
+            break;
+
+        case SIZEOF(ACK_KEY_NAME_FRAGMENT_TIMECODE) - 1:
+            ackKeyName = FRAGMENT_ACK_KEY_NAME_FRAGMENT_TIMECODE;
+            pExpected = (PCHAR) ACK_KEY_NAME_FRAGMENT_TIMECODE;
+            break;
+
+        case SIZEOF(ACK_KEY_NAME_ERROR_ID) - 1:
+            ackKeyName = FRAGMENT_ACK_KEY_NAME_ERROR_ID;
+            pExpected = (PCHAR) ACK_KEY_NAME_ERROR_ID;
+            break;
+
+        default:
+            return FRAGMENT_ACK_KEY_NAME_UNKNOWN;
     }
+
+    return 0 == MEMCMP(pExpected, keyName, length) ? ackKeyName : FRAGMENT_ACK_KEY_NAME_UNKNOWN;
 }
 
-STATUS processAckValue(PFragmentAckParser pFragmentAckParser) {
+STATUS processAckValue(PFragmentAckParser pFragmentAckParser, PCHAR pValue, UINT32 valueLen) {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     UINT64 value;
 
-    CHK(pFragmentAckParser != NULL, STATUS_NULL_ARG);
+    CHK(pFragmentAckParser != NULL && pValue != NULL, STATUS_NULL_ARG);
 
     switch(pFragmentAckParser->curKeyName) {
         case FRAGMENT_ACK_KEY_NAME_EVENT_TYPE:
@@ -320,7 +415,7 @@ STATUS processAckValue(PFragmentAckParser pFragmentAckParser) {
             CHK(!pFragmentAckParser->keys[pFragmentAckParser->curKeyName], STATUS_INVALID_ACK_DUPLICATE_KEY_NAME);
 
             // Get the event type
-            pFragmentAckParser->fragmentAck.ackType = getFragmentAckType(pFragmentAckParser->accumulator);
+            pFragmentAckParser->fragmentAck.ackType = getFragmentAckType(pValue, valueLen);
 
             break;
 
@@ -328,11 +423,12 @@ STATUS processAckValue(PFragmentAckParser pFragmentAckParser) {
             // Check if we have seen it already
             CHK(!pFragmentAckParser->keys[pFragmentAckParser->curKeyName], STATUS_INVALID_ACK_DUPLICATE_KEY_NAME);
 
-            // Store the value
-            STRNCPY(pFragmentAckParser->fragmentAck.sequenceNumber, pFragmentAckParser->accumulator, MAX_FRAGMENT_SEQUENCE_NUMBER);
+            // Store the value truncating it to the max length
+            valueLen = MIN(valueLen, MAX_FRAGMENT_SEQUENCE_NUMBER - 1);
+            MEMCPY(pFragmentAckParser->fragmentAck.sequenceNumber, pValue, valueLen);
 
             // Null terminate
-            pFragmentAckParser->fragmentAck.sequenceNumber[MAX_FRAGMENT_SEQUENCE_NUMBER - 1] = '\0';
+            pFragmentAckParser->fragmentAck.sequenceNumber[valueLen] = '\0';
             break;
 
         case FRAGMENT_ACK_KEY_NAME_FRAGMENT_TIMECODE:
@@ -342,7 +438,7 @@ STATUS processAckValue(PFragmentAckParser pFragmentAckParser) {
             // Parse the value into a temporary variable. This is odd as the compiler for Arm v7 has an issue
             // in arranging the stack (FASTCALL) and the pointer passed in is being interpreted as the
             // return address which causes a crash. This is a quick workaround to use a temp variable instread.
-            CHK_STATUS(STRTOUI64(pFragmentAckParser->accumulator, NULL, 10, &value));
+            CHK_STATUS(STRTOUI64(pValue, pValue + valueLen, 10, &value));
             pFragmentAckParser->fragmentAck.timestamp = value;
 
             break;
@@ -352,7 +448,7 @@ STATUS processAckValue(PFragmentAckParser pFragmentAckParser) {
             CHK(!pFragmentAckParser->keys[pFragmentAckParser->curKeyName], STATUS_INVALID_ACK_DUPLICATE_KEY_NAME);
 
             // Parse the value
-            CHK_STATUS(STRTOUI64(pFragmentAckParser->accumulator, NULL, 10, &value));
+            CHK_STATUS(STRTOUI64(pValue, pValue + valueLen, 10, &value));
 
             // This will overwrite the value
             pFragmentAckParser->fragmentAck.result = getAckErrorTypeFromErrorId(value);
@@ -45,6 +45,11 @@ typedef __FragmentAckParser* PFragmentAckParser;
 // If the character is start of numeric value
 #define IS_ACK_START_OF_NUMERIC_VALUE(ch)       ((ch) == '-' || (ch) == '+' || (ch) == '.' || ((ch) >= '0' && (ch) <= '9') || ((ch) >= 'a' && (ch) <= 'z') || ((ch) >= 'A' && (ch) <= 'Z'))
 
+// If the character terminates a numeric value
+#define IS_ACK_END_OF_NUMERIC_VALUE(ch)         (IS_WHITE_SPACE(ch) || (ch) == ACK_PARSER_COMMA || (ch) == ACK_PARSER_CLOSE_BRACE || (ch) == ACK_PARSER_QUOTE \
+                                                 || (ch) == ACK_PARSER_OPEN_BRACE || (ch) == ACK_PARSER_OPEN_BRACKET || (ch) == ACK_PARSER_CLOSE_BRACKET \
+                                                 || (ch) == ACK_PARSER_DELIMITER)
+
 /**
  * Kinesis Video ACK parser states
  */
@@ -106,7 +111,10 @@ typedef enum {
 } FRAGMENT_ACK_KEY_NAME;
 
 /**
- * Kinesis Video ACK parser
+ * Kinesis Video ACK parser.
+ *
+ * The tokens are referenced in-place in the chunk being parsed. Only the tokens spanning chunk boundaries are
+ * assembled in the accumulator.
  */
 typedef struct __FragmentAckParser FragmentAckParser;
 struct __FragmentAckParser {
@@ -115,6 +123,7 @@ struct __FragmentAckParser {
     FragmentAck fragmentAck;
     FRAGMENT_ACK_KEY_NAME curKeyName;
     UINT32 curPos;
+    UINT32 level;
     BOOL keys[FRAGMENT_ACK_KEY_NAME_MAX];
     CHAR accumulator[MAX_ACK_FRAGMENT_LEN + 1];
 };
@@ -147,30 +156,61 @@ STATUS parseFragmentAck(PKinesisVideoStream, UPLOAD_HANDLE, PCHAR, UINT32);
 
 /**
  * Tries to match a string to an ACK type. Returns Unknown if can't extract the type.
+ * The candidate is selected by the length and the first character and confirmed with a single compare.
  *
- * @param 1 PCHAR - Event type to parse and match to an ACK type
+ * @param 1 PCHAR - Event type to parse and match to an ACK type. Doesn't need to be NULL terminated.
+ * @param 2 UINT32 - Length of the event type string
  *
  * @return Fragment ACK type if successful
  */
-FRAGMENT_ACK_TYPE getFragmentAckType(PCHAR);
+FRAGMENT_ACK_TYPE getFragmentAckType(PCHAR, UINT32);
 
 /**
  * Tries to match a string to a key name. Returns Unknown if can't extract the key name.
+ * The key names have distinct lengths so the candidate is selected by the length and confirmed with a single compare.
  *
- * @param 1 PCHAR - Key name string to match.
+ * @param 1 PCHAR - Key name string to match. Doesn't need to be NULL terminated.
+ * @param 2 UINT32 - Length of the key name string
  *
  * @return Key name if successful
  */
-FRAGMENT_ACK_KEY_NAME getFragmentAckKeyName(PCHAR);
+FRAGMENT_ACK_KEY_NAME getFragmentAckKeyName(PCHAR, UINT32);
+
+/**
+ * Appends the part of a token which spans the chunk boundary to the accumulator.
+ *
+ * @param 1 PFragmentAckParser - Ack parser
+ * @param 2 PCHAR - Start of the token part
+ * @param 3 UINT32 - Size of the token part
+ *
+ * @return STATUS of the operation
+ */
+STATUS accumulateAckToken(PFragmentAckParser, PCHAR, UINT32);
+
+/**
+ * Returns the complete token ending in the current chunk. The token is referenced in-place unless
+ * its start has been accumulated from the previous chunks.
+ *
+ * @param 1 PFragmentAckParser - Ack parser
+ * @param 2 PCHAR - Start of the token in the current chunk
+ * @param 3 PCHAR - End of the token in the current chunk
+ * @param 4 PCHAR* - OUT - The token
+ * @param 5 PUINT32 - OUT - The token length
+ *
+ * @return STATUS of the operation
+ */
+STATUS getAckToken(PFragmentAckParser, PCHAR, PCHAR, PCHAR*, PUINT32);
 
 /**
  * Processes/consumes the parsed ACK value.
  *
  * @param 1 PFragmentAckParser - Ack parser
+ * @param 2 PCHAR - The value. Doesn't need to be NULL terminated.
+ * @param 3 UINT32 - The value length
  *
  * @return STATUS of the operation
  */
-STATUS processAckValue(PFragmentAckParser);
+STATUS processAckValue(PFragmentAckParser, PCHAR, UINT32);
 
 /**
  * Validates the newly parsed ACK.
@@ -77,14 +77,6 @@ STATUS createKinesisVideoClient(PDeviceInfo pDeviceInfo, PClientCallbacks pClien
                          pKinesisVideoClient->clientCallbacks.customData);
     }
 
-    // Create the storage
-    heapFlags = pKinesisVideoClient->deviceInfo.storageInfo.storageType == DEVICE_STORAGE_TYPE_IN_MEM ?
-                MEMORY_BASED_HEAP_FLAGS : FILE_BASED_HEAP_FLAGS;
-    CHK_STATUS(heapInitialize(pKinesisVideoClient->deviceInfo.storageInfo.storageSize,
-                              pKinesisVideoClient->deviceInfo.storageInfo.spillRatio,
-                              heapFlags,
-                              &pKinesisVideoClient->pHeap));
-
     // Set the streams pointer right after the struct
     pKinesisVideoClient->streams = (PKinesisVideoStream*)(pKinesisVideoClient + 1);
 
@@ -112,6 +104,18 @@ STATUS createKinesisVideoClient(PDeviceInfo pDeviceInfo, PClientCallbacks pClien
             pKinesisVideoClient->clientCallbacks.customData,
             TRUE);
 
+    // Create the storage. In case the per-stream arenas are enabled the client heap
+    // is the shared overflow pool and the streams will create their arenas on creation.
+    pKinesisVideoClient->streamArenaSize = calculateStreamArenaSize(pDeviceInfo);
+    heapFlags = STORAGE_HEAP_FLAGS(&pKinesisVideoClient->deviceInfo.storageInfo);
+    // NOTE: The file based storage spills into the memory mapped segment files in the root directory.
+    CHK_STATUS(heapInitializeWithRootDirectory(pKinesisVideoClient->deviceInfo.storageInfo.storageSize -
+                                                       pKinesisVideoClient->streamArenaSize * pDeviceInfo->streamCount,
+                                               pKinesisVideoClient->deviceInfo.storageInfo.spillRatio,
+                                               heapFlags,
+                                               pKinesisVideoClient->deviceInfo.storageInfo.rootDirectory,
+                                               &pKinesisVideoClient->pHeap));
+
     // Create the state machine and step it
     CHK_STATUS(createStateMachine(CLIENT_STATE_MACHINE_STATES,
                                   CLIENT_STATE_MACHINE_STATE_COUNT,
@@ -211,7 +215,7 @@ STATUS getKinesisVideoMetrics(CLIENT_HANDLE clientHandle, PClientMetrics pKinesi
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    UINT64 heapSize;
+    UINT64 heapSize, arenaSize;
     UINT32 i, viewAllocationSize;
     PKinesisVideoClient pKinesisVideoClient = FROM_CLIENT_HANDLE(clientHandle);
 
@@ -222,11 +226,6 @@ STATUS getKinesisVideoMetrics(CLIENT_HANDLE clientHandle, PClientMetrics pKinesi
 
     CHK_STATUS(heapGetSize(pKinesisVideoClient->pHeap, &heapSize));
 
-    pKinesisVideoMetrics->contentStoreSize = pKinesisVideoClient->deviceInfo.storageInfo.storageSize;
-    pKinesisVideoMetrics->contentStoreAllocatedSize = heapSize;
-    // Calculate the available size from the overall heap limit
-    pKinesisVideoMetrics->contentStoreAvailableSize = pKinesisVideoClient->deviceInfo.storageInfo.storageSize - heapSize;
-
     pKinesisVideoMetrics->totalContentViewsSize = 0;
     pKinesisVideoMetrics->totalTransferRate = 0;
     pKinesisVideoMetrics->totalFrameRate = 0;
@@ -236,9 +235,20 @@ STATUS getKinesisVideoMetrics(CLIENT_HANDLE clientHandle, PClientMetrics pKinesi
             pKinesisVideoMetrics->totalContentViewsSize += viewAllocationSize;
             pKinesisVideoMetrics->totalFrameRate += pKinesisVideoClient->streams[i]->diagnostics.currentFrameRate;
             pKinesisVideoMetrics->totalTransferRate += pKinesisVideoClient->streams[i]->diagnostics.currentTransferRate;
+
+            // Account for the stream arena if any
+            if (pKinesisVideoClient->streams[i]->pArena != NULL) {
+                CHK_STATUS(heapGetSize(pKinesisVideoClient->streams[i]->pArena, &arenaSize));
+                heapSize += arenaSize;
+            }
         }
     }
 
+    pKinesisVideoMetrics->contentStoreSize = pKinesisVideoClient->deviceInfo.storageInfo.storageSize;
+    pKinesisVideoMetrics->contentStoreAllocatedSize = heapSize;
+    // Calculate the available size from the overall heap limit
+    pKinesisVideoMetrics->contentStoreAvailableSize = pKinesisVideoClient->deviceInfo.storageInfo.storageSize - heapSize;
+
 CleanUp:
 
     LEAVES();
@@ -382,6 +392,76 @@ STATUS putKinesisVideoFrame(STREAM_HANDLE streamHandle, PFrame pFrame)
 
 CleanUp:
 
+    // Return the frame references released from the storage to the application outside of the locks
+    if (pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL) {
+        releasePendingFrameReferences(pKinesisVideoStream);
+    }
+
+    LEAVES();
+    return retStatus;
+
+}
+
+/**
+ * Puts a batch of frames into the Kinesis Video stream.
+ */
+STATUS putKinesisVideoFrames(STREAM_HANDLE streamHandle, PFrame pFrames, UINT32 frameCount, PUINT32 pStoredCount)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKinesisVideoStream pKinesisVideoStream = FROM_STREAM_HANDLE(streamHandle);
+
+    DLOGS("Putting %u frames into an Kinesis Video stream.", frameCount);
+
+    if (pStoredCount != NULL) {
+        *pStoredCount = 0;
+    }
+
+    CHK(pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL, STATUS_NULL_ARG);
+
+    // Process and store the batch
+    CHK_STATUS(putFrames(pKinesisVideoStream, pFrames, frameCount, NULL, pStoredCount));
+
+CleanUp:
+
+    // Return the frame references released from the storage to the application outside of the locks
+    if (pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL) {
+        releasePendingFrameReferences(pKinesisVideoStream);
+    }
+
+    LEAVES();
+    return retStatus;
+
+}
+
+/**
+ * Puts a frame referencing the caller frame data into the Kinesis Video stream.
+ */
+STATUS putKinesisVideoFrameReference(STREAM_HANDLE streamHandle, PFrame pFrame, FrameDataReleaseFunc releaseFn, UINT64 customData)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKinesisVideoStream pKinesisVideoStream = FROM_STREAM_HANDLE(streamHandle);
+    FrameReference frameReference;
+
+    DLOGS("Putting frame reference into an Kinesis Video stream.");
+
+    CHK(pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL &&
+        pFrame != NULL && releaseFn != NULL, STATUS_NULL_ARG);
+
+    frameReference.pFrameData = pFrame->frameData;
+    frameReference.size = pFrame->size;
+    frameReference.releaseFn = releaseFn;
+    frameReference.customData = customData;
+
+    // Process and store the header with the reference
+    CHK_STATUS(putFrames(pKinesisVideoStream, pFrame, 1, &frameReference, NULL));
+
+CleanUp:
+
+    // Return the frame references released from the storage to the application outside of the locks
+    if (pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL) {
+        releasePendingFrameReferences(pKinesisVideoStream);
+    }
+
     LEAVES();
     return retStatus;
 
@@ -435,6 +515,75 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Gets a pinned span over the stream data
+ */
+STATUS getKinesisVideoStreamDataSpan(STREAM_HANDLE streamHandle, PUINT64 pClientStreamHandle, UINT32 maxSize,
+                                     PStreamDataSpan pSpan)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKinesisVideoStream pKinesisVideoStream = FROM_STREAM_HANDLE(streamHandle);
+
+    DLOGS("Getting data span from an Kinesis Video stream.");
+
+    CHK(pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL, STATUS_NULL_ARG);
+
+    // Process and store the result
+    CHK_STATUS(getStreamDataSpan(pKinesisVideoStream, pClientStreamHandle, maxSize, pSpan));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Gets the stream data pinning the data larger than the buffer
+ */
+STATUS getKinesisVideoStreamDataWithSpan(STREAM_HANDLE streamHandle, PUINT64 pClientStreamHandle, PBYTE pBuffer,
+                                         UINT32 bufferSize, PUINT32 pFillSize, PStreamDataSpan pSpan)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKinesisVideoStream pKinesisVideoStream = FROM_STREAM_HANDLE(streamHandle);
+
+    DLOGS("Getting data with span from an Kinesis Video stream.");
+
+    CHK(pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL, STATUS_NULL_ARG);
+
+    // Process and store the result
+    CHK_STATUS(getStreamDataWithSpan(pKinesisVideoStream, pClientStreamHandle, pBuffer, bufferSize, pFillSize, pSpan));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Releases the pinned span over the stream data
+ */
+STATUS releaseKinesisVideoStreamDataSpan(STREAM_HANDLE streamHandle, UINT64 releaseToken)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKinesisVideoStream pKinesisVideoStream = FROM_STREAM_HANDLE(streamHandle);
+
+    DLOGS("Releasing data span of an Kinesis Video stream.");
+
+    CHK(pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(releaseStreamDataSpan(pKinesisVideoStream, releaseToken));
+
+CleanUp:
+
+    // Return the frame references released from the storage to the application outside of the locks
+    if (pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL) {
+        releasePendingFrameReferences(pKinesisVideoStream);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
 //////////////////////////////////////////////////////////
 // Event functions
 //////////////////////////////////////////////////////////
@@ -632,6 +781,12 @@ STATUS kinesisVideoStreamTerminated(STREAM_HANDLE streamHandle, UPLOAD_HANDLE st
     CHK_STATUS(streamTerminatedEvent(pKinesisVideoStream, streamUploadHandle, callResult));
 
 CleanUp:
+
+    // Return the frame references released from the storage to the application outside of the locks
+    if (pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL) {
+        releasePendingFrameReferences(pKinesisVideoStream);
+    }
+
     LEAVES();
     return retStatus;
 }
@@ -652,6 +807,12 @@ STATUS kinesisVideoStreamFragmentAck(STREAM_HANDLE streamHandle, UPLOAD_HANDLE u
     CHK_STATUS(streamFragmentAckEvent(pKinesisVideoStream, uploadHandle, pFragmentAck));
 
 CleanUp:
+
+    // Return the frame references released from the storage to the application outside of the locks
+    if (pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL) {
+        releasePendingFrameReferences(pKinesisVideoStream);
+    }
+
     LEAVES();
     return retStatus;
 }
@@ -672,6 +833,12 @@ STATUS kinesisVideoStreamParseFragmentAck(STREAM_HANDLE streamHandle, UPLOAD_HAN
     CHK_STATUS(parseFragmentAck(pKinesisVideoStream, uploadHandle, ackSegment, ackSegmentSize));
 
 CleanUp:
+
+    // Return the frame references released from the storage to the application outside of the locks
+    if (pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL) {
+        releasePendingFrameReferences(pKinesisVideoStream);
+    }
+
     LEAVES();
     return retStatus;
 }
@@ -689,7 +856,7 @@ VOID viewItemRemoved(PContentView pContentView, UINT64 customData, PViewItem pVi
     STATUS retStatus = STATUS_SUCCESS;
     PKinesisVideoStream pKinesisVideoStream = STREAM_FROM_CUSTOM_DATA(customData);
     PKinesisVideoClient pKinesisVideoClient = NULL;
-    BOOL streamLocked = FALSE;
+    BOOL streamLocked = FALSE, clientLocked = FALSE;
     PUploadHandleInfo pUploadHandleInfo;
 
     // Validate the input just in case
@@ -714,8 +881,10 @@ VOID viewItemRemoved(PContentView pContentView, UINT64 customData, PViewItem pVi
 
     // Notify the client about the dropped frame - only if we are removing the current view item
     // or the item that's been partially sent is being removed which was the one before the current.
+    // NOTE: The items of a fragment might share the allocation handle so the item index is compared.
     if (currentRemoved ||
-            (pViewItem->handle == pKinesisVideoStream->curViewItem.viewItem.handle &&
+            (IS_VALID_ALLOCATION_HANDLE(pKinesisVideoStream->curViewItem.viewItem.handle) &&
+                    pViewItem->index == pKinesisVideoStream->curViewItem.viewItem.index &&
                     pKinesisVideoStream->curViewItem.offset != pKinesisVideoStream->curViewItem.viewItem.length)) {
         DLOGW("Reporting a dropped frame/fragment.");
 
@@ -754,15 +923,15 @@ VOID viewItemRemoved(PContentView pContentView, UINT64 customData, PViewItem pVi
 
 CleanUp:
 
-    // Lock the client
-    pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
-
-    // Remove the item from the storage
-    heapFree(pKinesisVideoClient->pHeap, pViewItem->handle);
+    // Remove the item from the storage. This will lock the client only if the item is stored in the shared heap
+    // as the stream arena is protected by the stream lock. The pinned item will be freed when the span is released.
+    freeStreamStorage(pKinesisVideoStream, pViewItem->handle, pViewItem->flags, &clientLocked);
     pViewItem->handle = INVALID_ALLOCATION_HANDLE_VALUE;
 
-    // Unlock the client
-    pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
+    if (clientLocked) {
+        // Unlock the client
+        pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
+    }
 
     if (streamLocked) {
         // Unlock the stream lock
@@ -773,6 +942,20 @@ CleanUp:
     LEAVES();
 }
 
+/**
+ * Calculates the size of the per-stream storage arena. The arenas are sized for the max number of streams.
+ */
+UINT64 calculateStreamArenaSize(PDeviceInfo pDeviceInfo)
+{
+    UINT32 streamArenaRatio = GET_STREAM_ARENA_RATIO(&pDeviceInfo->storageInfo);
+
+    if (streamArenaRatio == 0 || pDeviceInfo->streamCount == 0) {
+        return 0;
+    }
+
+    return pDeviceInfo->storageInfo.storageSize * streamArenaRatio / 100 / pDeviceInfo->streamCount;
+}
+
 /**
  * Creates random null terminating string. The caller should ensure the
  * buffer has enough space to add the null terminator
@@ -14,6 +14,7 @@ extern "C" {
 // Project include files
 ////////////////////////////////////////////////////
 #include "com/amazonaws/kinesis/video/client/Include.h"
+#include "com/amazonaws/kinesis/video/trace/Include.h"
 
 // For tight packing
 #pragma pack(push, include_i, 1) // for byte alignment
@@ -119,6 +120,47 @@ typedef __KinesisVideoBase* PKinesisVideoBase;
 #define MEMORY_BASED_HEAP_FLAGS     FLAGS_USE_AIV_HEAP
 #define FILE_BASED_HEAP_FLAGS       (FLAGS_USE_AIV_HEAP | FLAGS_USE_HYBRID_FILE_HEAP)
 
+/**
+ * Heap flags for the storage type. Used for the client storage and the per-stream arenas.
+ */
+#define STORAGE_HEAP_FLAGS(pStorageInfo)    ((pStorageInfo)->storageType == DEVICE_STORAGE_TYPE_IN_MEM ? \
+                                                MEMORY_BASED_HEAP_FLAGS : FILE_BASED_HEAP_FLAGS)
+
+/**
+ * Stream arena ratio accessor as the field is available from version 1 of the storage info
+ */
+#define STORAGE_INFO_STREAM_ARENA_VERSION           1
+#define GET_STREAM_ARENA_RATIO(pStorageInfo)        ((pStorageInfo)->version >= STORAGE_INFO_STREAM_ARENA_VERSION ? \
+                                                     (pStorageInfo)->streamArenaRatio : 0)
+
+/**
+ * Fragment storage accessor as the field is available from version 2 of the storage info
+ */
+#define STORAGE_INFO_FRAGMENT_STORAGE_VERSION       2
+#define GET_FRAGMENT_STORAGE(pStorageInfo)          ((pStorageInfo)->version >= STORAGE_INFO_FRAGMENT_STORAGE_VERSION && \
+                                                     (pStorageInfo)->fragmentStorage)
+
+/**
+ * Track info accessor as the track info list is available from version 1 of the stream info
+ */
+#define STREAM_INFO_TRACKS_VERSION                  1
+#define GET_TRACK_INFO_COUNT(pStreamInfo)           ((pStreamInfo)->version >= STREAM_INFO_TRACKS_VERSION ? \
+                                                     (pStreamInfo)->streamCaps.trackInfoCount : 0)
+
+/**
+ * Standby connection period accessor as the field is available from version 2 of the stream info
+ */
+#define STREAM_INFO_STANDBY_CONNECTION_VERSION      2
+#define GET_STANDBY_CONNECTION_PERIOD(pStreamInfo)  ((pStreamInfo)->version >= STREAM_INFO_STANDBY_CONNECTION_VERSION && \
+                                                     (pStreamInfo)->streamCaps.standbyConnectionPeriod != 0 ? \
+                                                     (pStreamInfo)->streamCaps.standbyConnectionPeriod : \
+                                                     STREAMING_TOKEN_STANDBY_CONNECTION_PERIOD)
+
+/**
+ * Whether the stream frames are muxed from multiple tracks
+ */
+#define IS_MULTI_TRACK_STREAM(pKinesisVideoStream)  ((pKinesisVideoStream)->streamInfo.streamCaps.trackInfoCount > 1)
+
 /**
  * Defines the full tag structure length when the pointers to the strings are allocated after the struct
  */
@@ -193,9 +235,12 @@ struct __KinesisVideoClient {
     // Client callbacks
     ClientCallbacks clientCallbacks;
 
-    // Client storage
+    // Client storage. In case the per-stream arenas are enabled this is the shared overflow pool.
     PHeap pHeap;
 
+    // Size of the per-stream storage arena. 0 if the arenas are not enabled.
+    UINT64 streamArenaSize;
+
     // Current number of the streams
     UINT32 streamCount;
 
@@ -233,6 +278,11 @@ PKinesisVideoStream fromStreamHandle(STREAM_HANDLE);
  */
 VOID viewItemRemoved(PContentView, UINT64, PViewItem, BOOL);
 
+/**
+ * Calculates the size of the per-stream storage arena or 0 if the arenas are not enabled
+ */
+UINT64 calculateStreamArenaSize(PDeviceInfo);
+
 /**
  * Creates a random alpha num name
  */
@@ -93,6 +93,7 @@ CleanUp:
 STATUS validateDeviceInfo(PDeviceInfo pDeviceInfo)
 {
     STATUS retStatus = STATUS_SUCCESS;
+    UINT64 streamArenaSize;
 
     CHK(pDeviceInfo != NULL, STATUS_NULL_ARG);
     CHK(pDeviceInfo->version <= DEVICE_INFO_CURRENT_VERSION, STATUS_INVALID_DEVICE_INFO_VERSION);
@@ -103,6 +104,16 @@ STATUS validateDeviceInfo(PDeviceInfo pDeviceInfo)
                 pDeviceInfo->storageInfo.storageSize <= MAX_STORAGE_ALLOCATION_SIZE,
         STATUS_INVALID_STORAGE_SIZE);
     CHK(pDeviceInfo->storageInfo.spillRatio <= 100, STATUS_INVALID_SPILL_RATIO);
+    CHK(GET_STREAM_ARENA_RATIO(&pDeviceInfo->storageInfo) < 100, STATUS_INVALID_STREAM_ARENA_RATIO);
+
+    // Both the per-stream arenas and the shared overflow pool need to be large enough for a heap
+    streamArenaSize = calculateStreamArenaSize(pDeviceInfo);
+    if (streamArenaSize != 0) {
+        CHK(streamArenaSize >= MIN_STREAM_ARENA_SIZE &&
+                    pDeviceInfo->storageInfo.storageSize - streamArenaSize * pDeviceInfo->streamCount >= MIN_STREAM_ARENA_SIZE,
+            STATUS_INVALID_STORAGE_SIZE);
+    }
+
     CHK(STRNLEN(pDeviceInfo->storageInfo.rootDirectory, MAX_PATH_LEN) < MAX_PATH_LEN, STATUS_INVALID_ROOT_DIRECTORY_LENGTH);
     CHK(STRNLEN(pDeviceInfo->name, MAX_DEVICE_NAME_LEN) < MAX_DEVICE_NAME_LEN, STATUS_INVALID_DEVICE_NAME_LENGTH);
 
@@ -156,6 +167,7 @@ CleanUp:
 STATUS validateStreamInfo(PStreamInfo pStreamInfo, PClientCallbacks pClientCallbacks)
 {
     STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i;
 
     // Validate the stream info struct
     CHK(pStreamInfo != NULL, STATUS_NULL_ARG);
@@ -172,6 +184,26 @@ STATUS validateStreamInfo(PStreamInfo pStreamInfo, PClientCallbacks pClientCallb
     // If we have tags then the tagResource callback should be present
     CHK(pStreamInfo->tagCount == 0 || pClientCallbacks->tagResourceFn != NULL, STATUS_SERVICE_CALL_CALLBACKS_MISSING);
 
+    // Validate the codec private data as it's copied into the stream object
+    CHK(pStreamInfo->streamCaps.codecPrivateDataSize <= MKV_MAX_CODEC_PRIVATE_LEN, STATUS_MKV_INVALID_CODEC_PRIVATE_LENGTH);
+    CHK(pStreamInfo->streamCaps.codecPrivateDataSize == 0 || pStreamInfo->streamCaps.codecPrivateData != NULL,
+        STATUS_MKV_CODEC_PRIVATE_NULL);
+
+    // Validate the track info list and the track codec private data which is copied into the stream object.
+    // The rest of the track info is validated by the packager.
+    CHK(GET_TRACK_INFO_COUNT(pStreamInfo) <= MKV_MAX_TRACK_COUNT, STATUS_INVALID_TRACK_INFO_LIST);
+    CHK(GET_TRACK_INFO_COUNT(pStreamInfo) == 0 || pStreamInfo->streamCaps.trackInfoList != NULL, STATUS_INVALID_TRACK_INFO_LIST);
+    for (i = 0; i < GET_TRACK_INFO_COUNT(pStreamInfo); i++) {
+        CHK(pStreamInfo->streamCaps.trackInfoList[i].codecPrivateDataSize <= MKV_MAX_CODEC_PRIVATE_LEN,
+            STATUS_MKV_INVALID_CODEC_PRIVATE_LENGTH);
+        CHK(pStreamInfo->streamCaps.trackInfoList[i].codecPrivateDataSize == 0 ||
+            pStreamInfo->streamCaps.trackInfoList[i].codecPrivateData != NULL, STATUS_MKV_CODEC_PRIVATE_NULL);
+    }
+
+    // The token rotation should not start right away after the minimal token has been received
+    CHK(GET_STANDBY_CONNECTION_PERIOD(pStreamInfo) + STREAMING_TOKEN_EXPIRATION_GRACE_PERIOD < MIN_STREAMING_TOKEN_EXPIRATION_DURATION,
+        STATUS_INVALID_STANDBY_CONNECTION_PERIOD);
+
     // Fix-up the timecode scale if the value is the value of the sentinel
     if (pStreamInfo->streamCaps.timecodeScale == DEFAULT_TIMECODE_SCALE_SENTINEL) {
         pStreamInfo->streamCaps.timecodeScale = DEFAULT_MKV_TIMECODE_SCALE;
@@ -24,8 +24,9 @@ STATUS createStream(PKinesisVideoClient pKinesisVideoClient, PStreamInfo pStream
     PStackQueue pStackQueue = NULL;
     PMkvGenerator pMkvGenerator = NULL;
     PStateMachine pStateMachine = NULL;
-    UINT32 allocationSize, maxViewItems, i;
+    UINT32 allocationSize, tracksOffset, trackInfoCount, maxViewItems, i;
     PCHAR pCurPnt = NULL;
+    PBYTE pTrackCpd;
     BOOL locked = FALSE;
     BOOL tearDownOnError = TRUE;
     CHAR tempStreamName[MAX_STREAM_NAME_LEN];
@@ -67,8 +68,15 @@ STATUS createStream(PKinesisVideoClient pKinesisVideoClient, PStreamInfo pStream
     // Allocate the main struct
     // NOTE: The calloc will Zero the fields
     // We are allocating more than the structure size to accommodate for
-    // the variable size buffers which will come at the end and for the tags
-    allocationSize = SIZEOF(KinesisVideoStream) + pStreamInfo->streamCaps.codecPrivateDataSize + pStreamInfo->tagCount * TAG_FULL_LENGTH;
+    // the variable size buffers which will come at the end and for the tags.
+    // The track info list and the track codec private data follow the tags.
+    tracksOffset = ROUND_UP(SIZEOF(KinesisVideoStream) + pStreamInfo->streamCaps.codecPrivateDataSize + pStreamInfo->tagCount * TAG_FULL_LENGTH, 8);
+    trackInfoCount = GET_TRACK_INFO_COUNT(pStreamInfo);
+    allocationSize = tracksOffset + trackInfoCount * SIZEOF(TrackInfo);
+    for (i = 0; i < trackInfoCount; i++) {
+        allocationSize += pStreamInfo->streamCaps.trackInfoList[i].codecPrivateDataSize;
+    }
+
     pKinesisVideoStream = (PKinesisVideoStream) MEMCALLOC(1, allocationSize);
     CHK(pKinesisVideoStream != NULL, STATUS_NOT_ENOUGH_MEMORY);
 
@@ -125,8 +133,19 @@ STATUS createStream(PKinesisVideoClient pKinesisVideoClient, PStreamInfo pStream
     MEMSET(&pKinesisVideoStream->curViewItem, 0x00, SIZEOF(CurrentViewItem));
     pKinesisVideoStream->curViewItem.viewItem.handle = INVALID_ALLOCATION_HANDLE_VALUE;
 
+    // Nothing is pinned yet
+    MEMSET(&pKinesisVideoStream->pinnedViewItem, 0x00, SIZEOF(PinnedViewItem));
+    pKinesisVideoStream->pinnedViewItem.handle = INVALID_ALLOCATION_HANDLE_VALUE;
+    pKinesisVideoStream->pinnedViewItem.token = INVALID_ALLOCATION_HANDLE_VALUE;
+    pKinesisVideoStream->spanTokenSequence = 0;
+
+    // No fragment storage region is open yet
+    MEMSET(&pKinesisVideoStream->fragmentStorage, 0x00, SIZEOF(FragmentStorage));
+    pKinesisVideoStream->fragmentStorage.handle = INVALID_ALLOCATION_HANDLE_VALUE;
+
     // Copy the structures in their entirety
     MEMCPY(&pKinesisVideoStream->streamInfo, pStreamInfo, SIZEOF(StreamInfo));
+    pKinesisVideoStream->streamInfo.streamCaps.standbyConnectionPeriod = GET_STANDBY_CONNECTION_PERIOD(pStreamInfo);
     if (pKinesisVideoStream->streamInfo.streamCaps.codecPrivateDataSize != 0 &&
         pKinesisVideoStream->streamInfo.streamCaps.codecPrivateData != NULL) {
         // Set the pointer to the end of the structure
@@ -168,9 +187,49 @@ STATUS createStream(PKinesisVideoClient pKinesisVideoClient, PStreamInfo pStream
         STRNCPY(pKinesisVideoStream->streamInfo.tags[i].value, pStreamInfo->tags[i].value, MAX_TAG_VALUE_LEN);
     }
 
+    // Copy the track info list if any followed by the codec private data of the tracks
+    pKinesisVideoStream->streamInfo.streamCaps.trackInfoCount = trackInfoCount;
+    if (trackInfoCount != 0) {
+        pKinesisVideoStream->streamInfo.streamCaps.trackInfoList = (PTrackInfo) ((PBYTE) pKinesisVideoStream + tracksOffset);
+        MEMCPY(pKinesisVideoStream->streamInfo.streamCaps.trackInfoList,
+               pStreamInfo->streamCaps.trackInfoList,
+               trackInfoCount * SIZEOF(TrackInfo));
+
+        pTrackCpd = (PBYTE) (pKinesisVideoStream->streamInfo.streamCaps.trackInfoList + trackInfoCount);
+        for (i = 0; i < trackInfoCount; i++) {
+            if (pStreamInfo->streamCaps.trackInfoList[i].codecPrivateDataSize != 0) {
+                pKinesisVideoStream->streamInfo.streamCaps.trackInfoList[i].codecPrivateData = pTrackCpd;
+                MEMCPY(pTrackCpd,
+                       pStreamInfo->streamCaps.trackInfoList[i].codecPrivateData,
+                       pStreamInfo->streamCaps.trackInfoList[i].codecPrivateDataSize);
+                pTrackCpd += pStreamInfo->streamCaps.trackInfoList[i].codecPrivateDataSize;
+            } else {
+                pKinesisVideoStream->streamInfo.streamCaps.trackInfoList[i].codecPrivateData = NULL;
+            }
+        }
+    } else {
+        pKinesisVideoStream->streamInfo.streamCaps.trackInfoList = NULL;
+    }
+
     // Calculate the max items in the view
     maxViewItems = calculateViewItemCount(&pKinesisVideoStream->streamInfo);
 
+    // Create the per-stream storage arena if enabled. The arena is backed by the same storage type as the client storage.
+    if (pKinesisVideoClient->streamArenaSize != 0) {
+        CHK_STATUS(heapInitializeWithRootDirectory(pKinesisVideoClient->streamArenaSize,
+                                                   pKinesisVideoClient->deviceInfo.storageInfo.spillRatio,
+                                                   STORAGE_HEAP_FLAGS(&pKinesisVideoClient->deviceInfo.storageInfo),
+                                                   pKinesisVideoClient->deviceInfo.storageInfo.rootDirectory,
+                                                   &pKinesisVideoStream->pArena));
+    }
+
+    // Create the fragment storage region index if enabled
+    if (GET_FRAGMENT_STORAGE(&pKinesisVideoClient->deviceInfo.storageInfo)) {
+        CHK_STATUS(hashTableCreateOpenAddressing(FRAGMENT_STORAGE_HASH_SLOT_COUNT,
+                                                 &pKinesisVideoStream->fragmentStorage.pRegionTable));
+        pKinesisVideoStream->fragmentStorage.enabled = TRUE;
+    }
+
     // Create the view
     CHK_STATUS(createContentView(maxViewItems,
                                  pKinesisVideoStream->streamInfo.streamCaps.bufferDuration,
@@ -197,10 +256,17 @@ STATUS createStream(PKinesisVideoClient pKinesisVideoClient, PStreamInfo pStream
                                   &pStateMachine));
     pKinesisVideoStream->base.pStateMachine = pStateMachine;
 
-    // Create the stream upload handle queue
-    CHK_STATUS(stackQueueCreate(&pStackQueue));
+    // Create the stream upload handle queue. The nodes come from a pool to keep the allocator off the reconnects.
+    CHK_STATUS(stackQueueCreateWithPool(UPLOAD_HANDLE_INFO_QUEUE_NODE_COUNT, TRUE, &pStackQueue));
     pKinesisVideoStream->pUploadInfoQueue = pStackQueue;
 
+    // Create the queue of the frame references to be released outside of the locks
+    CHK_STATUS(stackQueueCreate(&pKinesisVideoStream->pFrameReleaseQueue));
+
+    // Create the upload handle info indexes
+    CHK_STATUS(hashTableCreateOpenAddressing(UPLOAD_HANDLE_INFO_HASH_SLOT_COUNT, &pKinesisVideoStream->pUploadInfoTable));
+    CHK_STATUS(hashTableCreateOpenAddressing(UPLOAD_HANDLE_INFO_HASH_SLOT_COUNT, &pKinesisVideoStream->pUploadInfoEndIndexTable));
+
     // Set the call result to unknown to start
     pKinesisVideoStream->base.result = SERVICE_CALL_RESULT_NOT_SET;
 
@@ -247,6 +313,7 @@ STATUS freeStream(PKinesisVideoStream pKinesisVideoStream)
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PKinesisVideoClient pKinesisVideoClient = NULL;
+    BOOL clientLocked = FALSE;
 
     // Call is idempotent
     CHK(pKinesisVideoStream != NULL, retStatus);
@@ -260,8 +327,23 @@ STATUS freeStream(PKinesisVideoStream pKinesisVideoStream)
     // Stop the processing
     stopStream(pKinesisVideoStream);
 
+    // Release the outstanding stream data span if any
+    unpinViewItem(pKinesisVideoStream);
+
+    // Close the fragment storage region so it's freed together with the last view item
+    closeFragmentStorage(pKinesisVideoStream, &clientLocked);
+    if (clientLocked) {
+        pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
+    }
+
     // Release the underlying objects
     freeContentView(pKinesisVideoStream->pView);
+
+    // The view items referencing the fragment storage have been removed with the view
+    if (pKinesisVideoStream->fragmentStorage.pRegionTable != NULL) {
+        hashTableFree(pKinesisVideoStream->fragmentStorage.pRegionTable);
+    }
+
     freeMkvGenerator(pKinesisVideoStream->pMkvGenerator);
     freeStateMachine(pKinesisVideoStream->base.pStateMachine);
 
@@ -270,6 +352,9 @@ STATUS freeStream(PKinesisVideoStream pKinesisVideoStream)
     // Free the codec private data if any
     freeCodecPrivateData(pKinesisVideoStream);
 
+    // Release the stream arena after the view is freed
+    heapRelease(pKinesisVideoStream->pArena);
+
     // Lock the client to update the streams
     pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
 
@@ -280,8 +365,12 @@ STATUS freeStream(PKinesisVideoStream pKinesisVideoStream)
     // Release the client lock
     pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
 
-    // Unlock and free the lock
+    // Unlock the stream and return the frame references released with the view
     pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
+    releasePendingFrameReferences(pKinesisVideoStream);
+    stackQueueFree(pKinesisVideoStream->pFrameReleaseQueue);
+
+    // Free the lock
     pKinesisVideoClient->clientCallbacks.freeMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
 
     // Release the object
@@ -316,6 +405,455 @@ STATUS freeUploadInfoQueue(PKinesisVideoStream pKinesisVideoStream)
     // Free the object itself
     stackQueueFree(pKinesisVideoStream->pUploadInfoQueue);
 
+    // Free the indexes if created
+    if (pKinesisVideoStream->pUploadInfoTable != NULL) {
+        hashTableFree(pKinesisVideoStream->pUploadInfoTable);
+    }
+
+    if (pKinesisVideoStream->pUploadInfoEndIndexTable != NULL) {
+        hashTableFree(pKinesisVideoStream->pUploadInfoEndIndexTable);
+    }
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Allocates the storage for the stream. The stream arena is protected by the stream lock
+ * so the client lock is acquired only when we overflow into the shared client heap.
+ */
+STATUS streamStorageAlloc(PKinesisVideoStream pKinesisVideoStream, UINT32 size, PALLOCATION_HANDLE pAllocHandle,
+                          PUINT32 pStorageFlags, PBOOL pClientLocked)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pKinesisVideoStream != NULL && pAllocHandle != NULL && pStorageFlags != NULL && pClientLocked != NULL, STATUS_NULL_ARG);
+
+    *pAllocHandle = INVALID_ALLOCATION_HANDLE_VALUE;
+    *pStorageFlags = ITEM_FLAG_NONE;
+
+    // Try the stream arena first
+    if (pKinesisVideoStream->pArena != NULL) {
+        CHK_STATUS(heapAlloc(pKinesisVideoStream->pArena, size, pAllocHandle));
+
+        if (IS_VALID_ALLOCATION_HANDLE(*pAllocHandle)) {
+            SET_ITEM_STREAM_ARENA(*pStorageFlags);
+            CHK(FALSE, retStatus);
+        }
+    }
+
+    // Allocate from the shared heap under the client lock
+    lockStreamStorage(pKinesisVideoStream, ITEM_FLAG_NONE, pClientLocked);
+    CHK_STATUS(heapAlloc(pKinesisVideoStream->pKinesisVideoClient->pHeap, size, pAllocHandle));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Returns the stream arena or the shared client heap based on the storage flags
+ */
+PHeap getStreamStorageHeap(PKinesisVideoStream pKinesisVideoStream, UINT32 storageFlags)
+{
+    return CHECK_ITEM_STREAM_ARENA(storageFlags) ? pKinesisVideoStream->pArena :
+           pKinesisVideoStream->pKinesisVideoClient->pHeap;
+}
+
+/**
+ * Locks the client if the allocation is stored in the shared client heap
+ */
+VOID lockStreamStorage(PKinesisVideoStream pKinesisVideoStream, UINT32 storageFlags, PBOOL pClientLocked)
+{
+    PKinesisVideoClient pKinesisVideoClient = pKinesisVideoStream->pKinesisVideoClient;
+
+    if (!*pClientLocked && !CHECK_ITEM_STREAM_ARENA(storageFlags)) {
+        pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
+        *pClientLocked = TRUE;
+    }
+}
+
+/**
+ * Frees the stream storage allocation. The allocation which is pinned by an outstanding
+ * stream data span is freed later when the span is released.
+ */
+VOID freeStreamStorage(PKinesisVideoStream pKinesisVideoStream, ALLOCATION_HANDLE handle, UINT32 storageFlags, PBOOL pClientLocked)
+{
+    // The fragment storage region is freed together with the last view item referencing it
+    if (CHECK_ITEM_FRAGMENT_STORAGE(storageFlags) && !releaseFragmentStorage(pKinesisVideoStream, handle)) {
+        return;
+    }
+
+    if (handle == pKinesisVideoStream->pinnedViewItem.handle) {
+        // The storage might have been re-allocated by a fix-up so the frame reference is released based on the latest flags
+        pKinesisVideoStream->pinnedViewItem.flags = storageFlags;
+        pKinesisVideoStream->pinnedViewItem.removed = TRUE;
+        return;
+    }
+
+    lockStreamStorage(pKinesisVideoStream, storageFlags, pClientLocked);
+
+    if (CHECK_ITEM_FRAME_REFERENCE(storageFlags)) {
+        releaseFrameReference(pKinesisVideoStream, handle, storageFlags);
+    }
+
+    heapFree(getStreamStorageHeap(pKinesisVideoStream, storageFlags), handle);
+}
+
+/**
+ * Fires the release callback of the referenced frame data stored after the MKV elements
+ */
+VOID releaseFrameReference(PKinesisVideoStream pKinesisVideoStream, ALLOCATION_HANDLE handle, UINT32 storageFlags)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PHeap pHeap = getStreamStorageHeap(pKinesisVideoStream, storageFlags);
+    PBYTE pAlloc = NULL;
+    UINT32 allocSize;
+    PFrameReference pFrameReference = NULL;
+
+    CHK_STATUS(heapMap(pHeap, handle, (PVOID*) &pAlloc, &allocSize));
+    CHK(GET_ITEM_DATA_OFFSET(storageFlags) + SIZEOF(FrameReference) <= allocSize, STATUS_VIEW_ITEM_SIZE_GREATER_THAN_ALLOCATION);
+
+    // The reference is not necessarily aligned within the storage
+    pFrameReference = (PFrameReference) MEMALLOC(SIZEOF(FrameReference));
+    CHK(pFrameReference != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    MEMCPY(pFrameReference, pAlloc + GET_ITEM_DATA_OFFSET(storageFlags), SIZEOF(FrameReference));
+    CHK_STATUS(heapUnmap(pHeap, (PVOID) pAlloc));
+    pAlloc = NULL;
+
+    // The application callback is fired once the locks are released
+    CHK_STATUS(stackQueueEnqueue(pKinesisVideoStream->pFrameReleaseQueue, (UINT64) pFrameReference));
+    pFrameReference = NULL;
+
+CleanUp:
+
+    if (pAlloc != NULL) {
+        heapUnmap(pHeap, (PVOID) pAlloc);
+    }
+
+    if (pFrameReference != NULL) {
+        MEMFREE(pFrameReference);
+    }
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGW("Failed to release the frame reference of the allocation 0x%016" PRIx64 " with status 0x%08x", handle, retStatus);
+    }
+}
+
+/**
+ * Fires the release callbacks of the queued frame references without holding the locks.
+ */
+VOID releasePendingFrameReferences(PKinesisVideoStream pKinesisVideoStream)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PKinesisVideoClient pKinesisVideoClient = pKinesisVideoStream->pKinesisVideoClient;
+    PFrameReference pFrameReference;
+    UINT64 item;
+    BOOL empty;
+
+    while (TRUE) {
+        // The queue is protected by the stream lock
+        pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
+        empty = TRUE;
+        if (pKinesisVideoStream->pFrameReleaseQueue != NULL) {
+            stackQueueIsEmpty(pKinesisVideoStream->pFrameReleaseQueue, &empty);
+        }
+
+        if (!empty) {
+            stackQueueDequeue(pKinesisVideoStream->pFrameReleaseQueue, &item);
+        }
+
+        pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
+
+        if (empty) {
+            break;
+        }
+
+        pFrameReference = (PFrameReference) item;
+        retStatus = pFrameReference->releaseFn(pFrameReference->customData, pFrameReference->pFrameData, pFrameReference->size);
+        if (STATUS_FAILED(retStatus)) {
+            DLOGW("Failed to release the frame reference with status 0x%08x", retStatus);
+        }
+
+        MEMFREE(pFrameReference);
+    }
+}
+
+/**
+ * Unmaps the stream storage. This will lock the client only if the storage is in the shared heap.
+ */
+STATUS unmapStreamStorage(PKinesisVideoStream pKinesisVideoStream, UINT32 storageFlags, PVOID pAlloc, PBOOL pClientLocked)
+{
+    lockStreamStorage(pKinesisVideoStream, storageFlags, pClientLocked);
+    return heapUnmap(getStreamStorageHeap(pKinesisVideoStream, storageFlags), pAlloc);
+}
+
+/**
+ * Makes room for the packaged frame in the open fragment storage region.
+ *
+ * NOTE: Only the key frames might start a new fragment. With the duration based fragmentation,
+ * a fragment might span multiple regions which doesn't affect the correctness.
+ */
+STATUS reserveFragmentStorage(PKinesisVideoStream pKinesisVideoStream, UINT32 size, BOOL newFragment, PBOOL pClientLocked)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFragmentStorage pFragmentStorage;
+    ALLOCATION_HANDLE handle = INVALID_ALLOCATION_HANDLE_VALUE;
+    UINT32 flags = ITEM_FLAG_NONE, regionSize, allocSize;
+    UINT64 expectedSize;
+    PBYTE pAlloc;
+
+    CHK(pKinesisVideoStream != NULL && pClientLocked != NULL, STATUS_NULL_ARG);
+    pFragmentStorage = &pKinesisVideoStream->fragmentStorage;
+
+    if (newFragment) {
+        // The size of the completed fragment is used to size the regions of the new one
+        if (pFragmentStorage->fragmentSize != 0) {
+            pFragmentStorage->lastFragmentSize = pFragmentStorage->fragmentSize;
+            pFragmentStorage->fragmentSize = 0;
+        }
+
+        CHK_STATUS(closeFragmentStorage(pKinesisVideoStream, pClientLocked));
+    }
+
+    // Early return if the frame fits into the open region
+    CHK(!IS_VALID_ALLOCATION_HANDLE(pFragmentStorage->handle) ||
+        pFragmentStorage->size - pFragmentStorage->used < size, retStatus);
+
+    // The region is full so continue the fragment in a new region
+    CHK_STATUS(closeFragmentStorage(pKinesisVideoStream, pClientLocked));
+
+    // Size the region for the rest of the fragment. The continuation regions at least double the fragment storage
+    // so a fragment growing over the previous one ends up in a few regions only.
+    expectedSize = pFragmentStorage->lastFragmentSize + pFragmentStorage->lastFragmentSize / FRAGMENT_STORAGE_HEADROOM_DIVISOR;
+    regionSize = expectedSize > pFragmentStorage->fragmentSize ? (UINT32) (expectedSize - pFragmentStorage->fragmentSize) : 0;
+    regionSize = MAX(regionSize, pFragmentStorage->fragmentSize);
+    regionSize = MIN(MAX(regionSize, MIN_FRAGMENT_STORAGE_REGION_SIZE), MAX_FRAGMENT_STORAGE_REGION_SIZE);
+    regionSize = MAX(regionSize, size);
+
+    CHK_STATUS(streamStorageAlloc(pKinesisVideoStream, regionSize, &handle, &flags, pClientLocked));
+
+    // Fall back to the frame size in a low memory situation
+    if (!IS_VALID_ALLOCATION_HANDLE(handle) && regionSize > size) {
+        CHK_STATUS(streamStorageAlloc(pKinesisVideoStream, size, &handle, &flags, pClientLocked));
+    }
+
+    // Out of storage - the caller will check the region handle
+    CHK(IS_VALID_ALLOCATION_HANDLE(handle), retStatus);
+
+    // The region stays mapped while it's being filled
+    lockStreamStorage(pKinesisVideoStream, flags, pClientLocked);
+    CHK_STATUS(heapMap(getStreamStorageHeap(pKinesisVideoStream, flags), handle, (PVOID*) &pAlloc, &allocSize));
+
+    SET_ITEM_FRAGMENT_STORAGE(flags);
+    pFragmentStorage->handle = handle;
+    pFragmentStorage->flags = flags;
+    pFragmentStorage->pAlloc = pAlloc;
+    pFragmentStorage->size = allocSize;
+    pFragmentStorage->used = 0;
+    pFragmentStorage->itemCount = 0;
+
+    // The region is owned by the fragment storage now
+    handle = INVALID_ALLOCATION_HANDLE_VALUE;
+
+CleanUp:
+
+    if (IS_VALID_ALLOCATION_HANDLE(handle)) {
+        lockStreamStorage(pKinesisVideoStream, flags, pClientLocked);
+        heapFree(getStreamStorageHeap(pKinesisVideoStream, flags), handle);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Closes the open fragment storage region
+ */
+STATUS closeFragmentStorage(PKinesisVideoStream pKinesisVideoStream, PBOOL pClientLocked)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFragmentStorage pFragmentStorage;
+    ALLOCATION_HANDLE handle;
+    UINT32 storageFlags;
+
+    CHK(pKinesisVideoStream != NULL && pClientLocked != NULL, STATUS_NULL_ARG);
+    pFragmentStorage = &pKinesisVideoStream->fragmentStorage;
+    CHK(IS_VALID_ALLOCATION_HANDLE(pFragmentStorage->handle), retStatus);
+
+    // Reset the open region first so the region is not left half-closed on error
+    handle = pFragmentStorage->handle;
+    storageFlags = pFragmentStorage->flags;
+    pFragmentStorage->handle = INVALID_ALLOCATION_HANDLE_VALUE;
+
+    // Index the region so it's freed together with the last view item referencing it
+    if (pFragmentStorage->itemCount != 0) {
+        CHK_STATUS(hashTablePut(pFragmentStorage->pRegionTable, handle, pFragmentStorage->itemCount));
+    }
+
+    CHK_STATUS(unmapStreamStorage(pKinesisVideoStream, storageFlags, pFragmentStorage->pAlloc, pClientLocked));
+
+    if (pFragmentStorage->itemCount == 0) {
+        // The view items referencing the region have been already removed
+        CLEAR_ITEM_FRAGMENT_STORAGE(storageFlags);
+        freeStreamStorage(pKinesisVideoStream, handle, storageFlags, pClientLocked);
+    } else if (pFragmentStorage->used < pFragmentStorage->size) {
+        // Return the unused tail of the region back to the heap
+        CHK_STATUS(heapSetAllocSize(getStreamStorageHeap(pKinesisVideoStream, storageFlags), handle, pFragmentStorage->used));
+    }
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Releases the view item reference to the fragment storage region
+ */
+BOOL releaseFragmentStorage(PKinesisVideoStream pKinesisVideoStream, ALLOCATION_HANDLE handle)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PFragmentStorage pFragmentStorage = &pKinesisVideoStream->fragmentStorage;
+    UINT64 itemCount;
+    BOOL lastReference = FALSE;
+
+    // The open region is kept until it's closed even if there are no more view items referencing it
+    if (handle == pFragmentStorage->handle) {
+        pFragmentStorage->itemCount--;
+        CHK(FALSE, retStatus);
+    }
+
+    CHK_STATUS(hashTableGet(pFragmentStorage->pRegionTable, handle, &itemCount));
+
+    if (--itemCount == 0) {
+        CHK_STATUS(hashTableRemove(pFragmentStorage->pRegionTable, handle));
+        lastReference = TRUE;
+    } else {
+        CHK_STATUS(hashTableUpsert(pFragmentStorage->pRegionTable, handle, itemCount));
+    }
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGW("Failed to release the fragment storage region 0x%016" PRIx64 " with status 0x%08x", handle, retStatus);
+    }
+
+    return lastReference;
+}
+
+/**
+ * Whether the view item references the frame data and its storage is pinned by the outstanding span.
+ * NOTE: The span might be sending the referenced frame data so the reference can't move off the pinned storage.
+ */
+BOOL isPinnedFrameReference(PKinesisVideoStream pKinesisVideoStream, PViewItem pViewItem)
+{
+    return CHECK_ITEM_FRAME_REFERENCE(pViewItem->flags) && pViewItem->handle == pKinesisVideoStream->pinnedViewItem.handle;
+}
+
+/**
+ * Copies the packaged data of the view item referencing the frame data from the offset
+ * with the referenced frame data in place of the reference.
+ */
+VOID copyReferencedViewItemData(PViewItem pViewItem, PBYTE pStored, UINT32 offset, PBYTE pBuffer, UINT32 size)
+{
+    UINT32 dataOffset = GET_ITEM_DATA_OFFSET(pViewItem->flags), headerSize;
+    FrameReference frameReference;
+
+    // Copy the part of the packaging header and then the referenced frame data
+    headerSize = offset < dataOffset ? MIN(size, dataOffset - offset) : 0;
+    MEMCPY(pBuffer, pStored + offset, headerSize);
+    MEMCPY(&frameReference, pStored + dataOffset, SIZEOF(FrameReference));
+    MEMCPY(pBuffer + headerSize, frameReference.pFrameData + offset + headerSize - dataOffset, size - headerSize);
+}
+
+/**
+ * Unmaps the pinned view item storage and frees it if the item has been removed while pinned.
+ * NOTE: The stream lock should be held.
+ */
+STATUS unpinViewItem(PKinesisVideoStream pKinesisVideoStream)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKinesisVideoClient pKinesisVideoClient = pKinesisVideoStream->pKinesisVideoClient;
+    PPinnedViewItem pPinned = &pKinesisVideoStream->pinnedViewItem;
+    PHeap pHeap;
+    BOOL clientLocked = FALSE;
+
+    CHK(IS_VALID_ALLOCATION_HANDLE(pPinned->handle), retStatus);
+
+    lockStreamStorage(pKinesisVideoStream, pPinned->flags, &clientLocked);
+    pHeap = getStreamStorageHeap(pKinesisVideoStream, pPinned->flags);
+
+    CHK_STATUS(heapUnmap(pHeap, (PVOID) pPinned->pAlloc));
+
+    if (pPinned->removed) {
+        if (CHECK_ITEM_FRAME_REFERENCE(pPinned->flags)) {
+            releaseFrameReference(pKinesisVideoStream, pPinned->handle, pPinned->flags);
+        }
+
+        CHK_STATUS(heapFree(pHeap, pPinned->handle));
+    }
+
+CleanUp:
+
+    if (clientLocked) {
+        pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
+    }
+
+    // Reset the pinned item regardless of the result
+    MEMSET(pPinned, 0x00, SIZEOF(PinnedViewItem));
+    pPinned->handle = INVALID_ALLOCATION_HANDLE_VALUE;
+    pPinned->token = INVALID_ALLOCATION_HANDLE_VALUE;
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Notifies the ready and the streaming upload handles of the available stream data.
+ * NOTE: The stream lock should be held.
+ */
+STATUS notifyStreamDataAvailable(PKinesisVideoStream pKinesisVideoStream)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKinesisVideoClient pKinesisVideoClient = pKinesisVideoStream->pKinesisVideoClient;
+    PUploadHandleInfo pUploadHandleInfo;
+    UINT64 duration, viewByteSize, item;
+    UINT32 i, sessionCount;
+
+    CHK_STATUS(contentViewGetWindowDuration(pKinesisVideoStream->pView, &duration, NULL));
+    CHK_STATUS(contentViewGetWindowAllocationSize(pKinesisVideoStream->pView, &viewByteSize, NULL));
+    viewByteSize += pKinesisVideoStream->curViewItem.viewItem.length - pKinesisVideoStream->curViewItem.offset;
+
+    // Nothing to notify on
+    CHK(viewByteSize != 0, retStatus);
+
+    CHK_STATUS(stackQueueGetCount(pKinesisVideoStream->pUploadInfoQueue, &sessionCount));
+    for (i = 0; i < sessionCount; i++) {
+        CHK_STATUS(stackQueueGetAt(pKinesisVideoStream->pUploadInfoQueue, i, &item));
+        pUploadHandleInfo = (PUploadHandleInfo) item;
+        CHK(pUploadHandleInfo != NULL, STATUS_INTERNAL_ERROR);
+
+        if ((pUploadHandleInfo->state == UPLOAD_HANDLE_STATE_READY || pUploadHandleInfo->state == UPLOAD_HANDLE_STATE_STREAMING) &&
+            IS_VALID_UPLOAD_HANDLE(pUploadHandleInfo->handle)) {
+            CHK_STATUS(pKinesisVideoClient->clientCallbacks.streamDataAvailableFn(
+                    pKinesisVideoClient->clientCallbacks.customData,
+                    TO_STREAM_HANDLE(pKinesisVideoStream),
+                    pKinesisVideoStream->streamInfo.name,
+                    pUploadHandleInfo->handle,
+                    duration,
+                    viewByteSize));
+        }
+    }
+
 CleanUp:
 
     LEAVES();
@@ -419,20 +957,37 @@ CleanUp:
 STATUS putFrame(PKinesisVideoStream pKinesisVideoStream, PFrame pFrame) {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PKinesisVideoClient pKinesisVideoClient = NULL;
-    ALLOCATION_HANDLE allocHandle = INVALID_ALLOCATION_HANDLE_VALUE;
-    UINT64 remainingSize = 0, thresholdPercent = 0, duration = 0, viewByteSize = 0;
-    PBYTE pAlloc = NULL;
-    UINT32 allocSize = 0, packagedSize = 0;
-    UINT32 itemFlags;
-    BOOL streamLocked = FALSE, clientLocked = FALSE, freeOnError = TRUE, contains = FALSE;
-    EncodedFrameInfo encodedFrameInfo;
-    UINT64 currentTime;
+
+    CHK(pKinesisVideoStream != NULL && pFrame != NULL, STATUS_NULL_ARG);
+    CHK_STATUS(putFrames(pKinesisVideoStream, pFrame, 1, NULL, NULL));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+STATUS putFrames(PKinesisVideoStream pKinesisVideoStream, PFrame pFrames, UINT32 frameCount, PFrameReference pFrameReference,
+                 PUINT32 pStoredCount) {
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS, storeStatus = STATUS_SUCCESS;
+    ProfilerTrace profilerTrace = PROFILER_TRACE_INITIALIZER;
+    PKinesisVideoClient pKinesisVideoClient = NULL;
+    UINT64 remainingSize = 0, storageLimit = 0, thresholdPercent = 0, duration = 0, viewByteSize = 0;
+    UINT32 i, itemFlags = ITEM_FLAG_NONE;
+    BOOL streamLocked = FALSE, clientLocked = FALSE;
+    UINT64 currentTime;
     DOUBLE frameRate, deltaInSeconds;
-    PViewItem pViewItem = NULL;
     PUploadHandleInfo pUploadHandleInfo;
 
-    CHK(pKinesisVideoStream != NULL && pFrame != NULL, STATUS_NULL_ARG);
+    CHK(pKinesisVideoStream != NULL && pFrames != NULL, STATUS_NULL_ARG);
+    CHK(frameCount != 0 && (pFrameReference == NULL || frameCount == 1), STATUS_INVALID_ARG);
+
+    if (pStoredCount != NULL) {
+        *pStoredCount = 0;
+    }
+
+    PROFILER_TRACE_START("putFrame", TRACE_LEVEL_INFO, &profilerTrace);
     pKinesisVideoClient = pKinesisVideoStream->pKinesisVideoClient;
 
     // Check if the stream has been stopped
@@ -461,19 +1016,165 @@ STATUS putFrame(PKinesisVideoStream pKinesisVideoStream, PFrame pFrame) {
     // get the streaming end point and the new streaming token.
     CHK_STATUS(checkStreamingTokenExpiration(pKinesisVideoStream));
 
-    // NOTE: If the connection has been reset we need to start from a new header
+    // NOTE: During the token rotation the generator is reset on the first key frame after
+    // the standby upload handle has been put into rotation. Until then the current upload
+    // handle keeps streaming so the upload is not paused while the new connection is being established.
     if (pKinesisVideoStream->streamState == STREAM_STATE_NEW
         || pKinesisVideoStream->streamState == STREAM_STATE_STOPPED) {
+        // Step the state machine once to get out of the Ready state or to execute the token rotation
+        CHK_STATUS(stepStateMachine(pKinesisVideoStream->base.pStateMachine));
+    }
 
-        // Set an indicator to reset the generator on the next key frame only when we are in the stopped state
-        if (pKinesisVideoStream->streamState == STREAM_STATE_STOPPED && pKinesisVideoStream->gracePeriod) {
-            pKinesisVideoStream->resetGeneratorOnKeyFrame = TRUE;
+    // Package and store the frames. The client lock is acquired on the shared heap allocation
+    // and is released after each of the frames so the other streams are not blocked for the batch.
+    for (i = 0; i < frameCount; i++) {
+        storeStatus = storeFrame(pKinesisVideoStream, &pFrames[i], pFrameReference, &itemFlags, &clientLocked);
+
+        if (clientLocked) {
+            pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
+            clientLocked = FALSE;
         }
 
-        // Step the state machine once to get out of the Ready state or to execute the token rotation
-        CHK_STATUS(stepStateMachine(pKinesisVideoStream->base.pStateMachine));
+        if (STATUS_FAILED(storeStatus)) {
+            break;
+        }
+    }
+
+    if (pStoredCount != NULL) {
+        *pStoredCount = i;
+    }
+
+    // Bail if nothing has been stored. Otherwise, the frames stored before the failure
+    // need to be notified on before we report the failure.
+    CHK(i != 0, storeStatus);
+
+    // Check for storage pressures. The stream arena and the shared overflow pool are both available to the stream.
+    // The shared heap is read under the client lock as the other streams allocate from it. The arena is protected by the stream lock.
+    pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
+    storageLimit = pKinesisVideoClient->pHeap->heapLimit;
+    remainingSize = pKinesisVideoClient->pHeap->heapLimit - pKinesisVideoClient->pHeap->heapSize;
+    pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
+
+    if (pKinesisVideoStream->pArena != NULL) {
+        storageLimit += pKinesisVideoStream->pArena->heapLimit;
+        remainingSize += pKinesisVideoStream->pArena->heapLimit - pKinesisVideoStream->pArena->heapSize;
+    }
+
+    thresholdPercent = (UINT32) (((DOUBLE) remainingSize / storageLimit) * 100);
+
+    if (thresholdPercent <= STORAGE_PRESSURE_NOTIFICATION_THRESHOLD &&
+        pKinesisVideoClient->clientCallbacks.storageOverflowPressureFn != NULL) {
+        // Notify the client app about buffer pressure
+        CHK_STATUS(pKinesisVideoClient->clientCallbacks.storageOverflowPressureFn(
+                pKinesisVideoClient->clientCallbacks.customData,
+                remainingSize));
+    }
+
+    // We need to check for the latency pressure. If the view head is ahead of the current
+    // for more than the specified max latency then we need to call the optional user callback.
+    // NOTE: A special sentinel value is used to determine whether the latency is specified.
+    if (pKinesisVideoStream->streamInfo.streamCaps.maxLatency != STREAM_LATENCY_PRESSURE_CHECK_SENTINEL &&
+            pKinesisVideoClient->clientCallbacks.streamLatencyPressureFn != NULL) {
+        // Get the window duration from the view
+        CHK_STATUS(contentViewGetWindowDuration(pKinesisVideoStream->pView, &duration, NULL));
+
+        // Check for the breach and invoke the user provided callback
+        if (duration > pKinesisVideoStream->streamInfo.streamCaps.maxLatency) {
+            CHK_STATUS(pKinesisVideoClient->clientCallbacks.streamLatencyPressureFn(
+                pKinesisVideoClient->clientCallbacks.customData,
+                TO_STREAM_HANDLE(pKinesisVideoStream),
+                duration));
+        }
+    }
+
+    // Notify about data is available
+    pUploadHandleInfo = getStreamUploadInfoWithState(pKinesisVideoStream, UPLOAD_HANDLE_STATE_READY |
+            UPLOAD_HANDLE_STATE_STREAMING);
+    if (NULL != pUploadHandleInfo && IS_VALID_UPLOAD_HANDLE(pUploadHandleInfo->handle)) {
+        // Get the duration from current point to the head
+        CHK_STATUS(contentViewGetWindowDuration(pKinesisVideoStream->pView, &duration, NULL));
+
+        // Get the size of the allocation from current point to the head
+        CHK_STATUS(contentViewGetWindowAllocationSize(pKinesisVideoStream->pView, &viewByteSize, NULL));
+
+        // Call the notification callback
+        CHK_STATUS(pKinesisVideoClient->clientCallbacks.streamDataAvailableFn(
+                pKinesisVideoClient->clientCallbacks.customData,
+                TO_STREAM_HANDLE(pKinesisVideoStream),
+                pKinesisVideoStream->streamInfo.name,
+                pUploadHandleInfo->handle,
+                duration,
+                viewByteSize));
+    }
+
+    // Recalculate frame rate if enabled
+    if (pKinesisVideoStream->streamInfo.streamCaps.recalculateMetrics) {
+        // Calculate the current frame rate only after the first iteration.
+        // The frames of the batch are accounted for as having arrived since the last put.
+        currentTime = pKinesisVideoClient->clientCallbacks.getCurrentTimeFn(pKinesisVideoClient->clientCallbacks.customData);
+        if (!CHECK_ITEM_STREAM_START(itemFlags)) {
+            // Calculate the delta time in seconds
+            deltaInSeconds = (DOUBLE) (currentTime - pKinesisVideoStream->diagnostics.lastFrameRateTimestamp) /
+                             HUNDREDS_OF_NANOS_IN_A_SECOND;
+
+            if (deltaInSeconds != 0) {
+                frameRate = i / deltaInSeconds;
+
+                // Update the current frame rate
+                pKinesisVideoStream->diagnostics.currentFrameRate = EMA_ACCUMULATOR_GET_NEXT(
+                        pKinesisVideoStream->diagnostics.currentFrameRate, frameRate);
+            }
+        }
+
+        // Store the last frame timestamp
+        pKinesisVideoStream->diagnostics.lastFrameRateTimestamp = currentTime;
+    }
+
+    // Report the failure of the frame which stopped the batch
+    CHK_STATUS(storeStatus);
+
+    // Unlock the stream (even though it will be unlocked in the cleanup
+    pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
+    streamLocked = FALSE;
+
+CleanUp:
+
+    if (clientLocked) {
+        pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
+    }
+
+    if (streamLocked) {
+        pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
     }
 
+    PROFILER_TRACE_STOP(profilerTrace);
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Packages the frame into the stream storage and adds it to the view.
+ * NOTE: The stream lock should be held. The client lock is acquired if the frame
+ * is stored in the shared heap and is left for the caller to release.
+ */
+STATUS storeFrame(PKinesisVideoStream pKinesisVideoStream, PFrame pFrame, PFrameReference pFrameReference, PUINT32 pItemFlags,
+                  PBOOL pClientLocked) {
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    ALLOCATION_HANDLE allocHandle = INVALID_ALLOCATION_HANDLE_VALUE;
+    PBYTE pAlloc = NULL;
+    UINT32 allocSize = 0, packagedSize = 0, storedSize = 0, allocationOffset = 0;
+    UINT32 itemFlags = ITEM_FLAG_NONE;
+    PHeap pHeap;
+    BOOL freeOnError = TRUE;
+    EncodedFrameInfo encodedFrameInfo;
+    PViewItem pViewItem = NULL;
+    PUploadHandleInfo pUploadHandleInfo;
+    PFragmentStorage pFragmentStorage = NULL;
+
+    CHK(pKinesisVideoStream != NULL && pFrame != NULL && pItemFlags != NULL && pClientLocked != NULL, STATUS_NULL_ARG);
+
     // if we need to reset the generator on the next key frame (during the rotation only)
     if (pKinesisVideoStream->resetGeneratorOnKeyFrame && CHECK_FRAME_FLAG_KEY_FRAME(pFrame->flags)) {
         // Store the last stream timestamp before resetting the generator
@@ -483,59 +1184,123 @@ STATUS putFrame(PKinesisVideoStream pKinesisVideoStream, PFrame pFrame) {
 
     // Package and store the frame.
 
-    // Currently, we are storing every frame in a separate allocation
-    // We will need to optimize for storing perhaps an entire cluster but
-    // Not right now as we need to deal with mapping/unmapping and allocating
-    // the cluster storage up-front which might be more hassle than needed.
-
-    // Get the size of the packaged frame
-    CHK_STATUS(mkvgenPackageFrame(pKinesisVideoStream->pMkvGenerator,
-                                  pFrame,
-                                  NULL,
-                                  &packagedSize,
-                                  &encodedFrameInfo));
+    // By default, we are storing every frame in a separate allocation. With the fragment storage
+    // enabled the frames of a fragment are appended into a shared region instead.
+    // The referenced frames are stored as the MKV elements followed by the reference in a separate allocation.
+
+    if (pFrameReference != NULL) {
+        // Get the exact size of the MKV elements
+        CHK_STATUS(mkvgenPackageFrameHeader(pKinesisVideoStream->pMkvGenerator, pFrame, NULL, &packagedSize, NULL));
+        packagedSize += SIZEOF(FrameReference);
+
+        // Allocate storage for the header. This will lock the client only if the shared heap is used.
+        CHK_STATUS(streamStorageAlloc(pKinesisVideoStream, packagedSize, &allocHandle, &itemFlags, pClientLocked));
+        CHK(IS_VALID_ALLOCATION_HANDLE(allocHandle), STATUS_STORE_OUT_OF_MEMORY);
+
+        // Map the storage
+        pHeap = getStreamStorageHeap(pKinesisVideoStream, itemFlags);
+        CHK_STATUS(heapMap(pHeap, allocHandle, (PVOID *) &pAlloc, &allocSize));
+    } else if (pKinesisVideoStream->fragmentStorage.enabled) {
+        // Get the max size of the packaged frame. This doesn't require scanning the frame data
+        // so the frame will be adapted and packaged in a single pass.
+        CHK_STATUS(mkvgenGetMaxPackagedFrameSize(pKinesisVideoStream->pMkvGenerator, pFrame, &packagedSize));
+
+        pFragmentStorage = &pKinesisVideoStream->fragmentStorage;
+
+        // The region is owned by the fragment storage and is never freed here
+        freeOnError = FALSE;
+
+        // Make room in the open region. A key frame might start a new fragment.
+        CHK_STATUS(reserveFragmentStorage(pKinesisVideoStream,
+                                          packagedSize,
+                                          CHECK_FRAME_FLAG_KEY_FRAME(pFrame->flags),
+                                          pClientLocked));
+
+        // The max size might be too pessimistic in a low memory situation so try with the actual size
+        if (!IS_VALID_ALLOCATION_HANDLE(pFragmentStorage->handle)) {
+            CHK_STATUS(mkvgenPackageFrame(pKinesisVideoStream->pMkvGenerator,
+                                          pFrame,
+                                          NULL,
+                                          &packagedSize,
+                                          NULL));
+
+            CHK_STATUS(reserveFragmentStorage(pKinesisVideoStream, packagedSize, FALSE, pClientLocked));
+        }
 
-    // Lock the client
-    pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData,
-                                                     pKinesisVideoClient->base.lock);
-    clientLocked = TRUE;
+        // Ensure we have space and if not then bail
+        CHK(IS_VALID_ALLOCATION_HANDLE(pFragmentStorage->handle), STATUS_STORE_OUT_OF_MEMORY);
 
-    // Allocate storage for the frame
-    CHK_STATUS(heapAlloc(pKinesisVideoClient->pHeap, packagedSize, &allocHandle));
+        // Append to the already mapped region
+        allocHandle = pFragmentStorage->handle;
+        itemFlags = pFragmentStorage->flags;
+        allocationOffset = pFragmentStorage->used;
+        pAlloc = pFragmentStorage->pAlloc + allocationOffset;
+        allocSize = pFragmentStorage->size - allocationOffset;
+    } else {
+        // Get the max size of the packaged frame. This doesn't require scanning the frame data
+        // so the frame will be adapted and packaged in a single pass.
+        CHK_STATUS(mkvgenGetMaxPackagedFrameSize(pKinesisVideoStream->pMkvGenerator, pFrame, &packagedSize));
+
+        // Allocate storage for the frame. This will lock the client only if the shared heap is used.
+        CHK_STATUS(streamStorageAlloc(pKinesisVideoStream, packagedSize, &allocHandle, &itemFlags, pClientLocked));
+
+        // The max size might be too pessimistic in a low memory situation so try with the actual size
+        if (!IS_VALID_ALLOCATION_HANDLE(allocHandle)) {
+            CHK_STATUS(mkvgenPackageFrame(pKinesisVideoStream->pMkvGenerator,
+                                          pFrame,
+                                          NULL,
+                                          &packagedSize,
+                                          NULL));
+
+            CHK_STATUS(streamStorageAlloc(pKinesisVideoStream, packagedSize, &allocHandle, &itemFlags, pClientLocked));
+        }
 
-    // Ensure we have space and if not then bail
-    CHK(IS_VALID_ALLOCATION_HANDLE(allocHandle), STATUS_STORE_OUT_OF_MEMORY);
+        // Ensure we have space and if not then bail
+        CHK(IS_VALID_ALLOCATION_HANDLE(allocHandle), STATUS_STORE_OUT_OF_MEMORY);
 
-    // Map the storage
-    CHK_STATUS(heapMap(pKinesisVideoClient->pHeap, allocHandle, (PVOID *) &pAlloc, &allocSize));
+        // Map the storage
+        pHeap = getStreamStorageHeap(pKinesisVideoStream, itemFlags);
+        CHK_STATUS(heapMap(pHeap, allocHandle, (PVOID *) &pAlloc, &allocSize));
+    }
 
     // Validate we had allocated enough storage just in case
     CHK(packagedSize <= allocSize, STATUS_ALLOCATION_SIZE_SMALLER_THAN_REQUESTED);
 
     // Actually package the bits in the storage
-    CHK_STATUS(mkvgenPackageFrame(pKinesisVideoStream->pMkvGenerator,
-                                  pFrame,
-                                  pAlloc,
-                                  &packagedSize,
-                                  &encodedFrameInfo));
-
-    // Unmap the storage for the frame
-    CHK_STATUS(heapUnmap(pKinesisVideoClient->pHeap, ((PVOID) pAlloc)));
+    packagedSize = allocSize;
+    if (pFrameReference != NULL) {
+        CHK_STATUS(mkvgenPackageFrameHeader(pKinesisVideoStream->pMkvGenerator,
+                                            pFrame,
+                                            pAlloc,
+                                            &packagedSize,
+                                            &encodedFrameInfo));
+
+        // Store the reference after the MKV elements. The frame data is streamed from the caller buffer.
+        CHK(packagedSize + SIZEOF(FrameReference) <= allocSize, STATUS_ALLOCATION_SIZE_SMALLER_THAN_REQUESTED);
+        MEMCPY(pAlloc + packagedSize, pFrameReference, SIZEOF(FrameReference));
+        storedSize = packagedSize + SIZEOF(FrameReference);
+        packagedSize += pFrameReference->size;
+        SET_ITEM_FRAME_REFERENCE(itemFlags);
+    } else {
+        CHK_STATUS(mkvgenPackageFrame(pKinesisVideoStream->pMkvGenerator,
+                                      pFrame,
+                                      pAlloc,
+                                      &packagedSize,
+                                      &encodedFrameInfo));
+        storedSize = packagedSize;
+    }
 
-    // Check for storage pressures
-    remainingSize = pKinesisVideoClient->pHeap->heapLimit - pKinesisVideoClient->pHeap->heapSize;
-    thresholdPercent = (UINT32) (((DOUBLE) remainingSize / pKinesisVideoClient->pHeap->heapLimit) * 100);
+    if (pFragmentStorage == NULL) {
+        // Unmap the storage for the frame
+        CHK_STATUS(heapUnmap(pHeap, ((PVOID) pAlloc)));
 
-    if (thresholdPercent <= STORAGE_PRESSURE_NOTIFICATION_THRESHOLD &&
-        pKinesisVideoClient->clientCallbacks.storageOverflowPressureFn != NULL) {
-        // Notify the client app about buffer pressure
-        CHK_STATUS(pKinesisVideoClient->clientCallbacks.storageOverflowPressureFn(
-                pKinesisVideoClient->clientCallbacks.customData,
-                remainingSize));
+        // Return the unused tail of the allocation back to the heap
+        if (storedSize < allocSize) {
+            CHK_STATUS(heapSetAllocSize(pHeap, allocHandle, storedSize));
+        }
     }
 
-    // Generate the view flags
-    itemFlags = ITEM_FLAG_NONE;
+    // Generate the view flags on top of the storage flags
     switch (encodedFrameInfo.streamState) {
         case MKV_STATE_START_STREAM:
             SET_ITEM_STREAM_START(itemFlags);
@@ -554,6 +1319,12 @@ STATUS putFrame(PKinesisVideoStream pKinesisVideoStream, PFrame pFrame) {
     // NOTE: We are using the decoding timestamp as our item timestamp.
     // Although, the intra-cluster pts might vary from dts, the cluster start frame pts
     // will be equal to dts which is important when processing ACKs.
+    // The frames of the multi-track streams interleave so the duration of the previous frame
+    // is clipped to keep the view items from overlapping.
+    if (IS_MULTI_TRACK_STREAM(pKinesisVideoStream)) {
+        CHK_STATUS(clipViewHeadDuration(pKinesisVideoStream, encodedFrameInfo.clusterTs + encodedFrameInfo.frameDts));
+    }
+
     CHK_STATUS(contentViewAddItem(pKinesisVideoStream->pView,
                                   encodedFrameInfo.clusterTs + encodedFrameInfo.frameDts,
                                   pFrame->duration,
@@ -565,6 +1336,17 @@ STATUS putFrame(PKinesisVideoStream pKinesisVideoStream, PFrame pFrame) {
     // From now on we don't need to free the allocation as it's in the view already and will be collected
     freeOnError = FALSE;
 
+    if (pFragmentStorage != NULL) {
+        // Account for the item before anything else so the region is released correctly
+        pFragmentStorage->used += packagedSize;
+        pFragmentStorage->fragmentSize += packagedSize;
+        pFragmentStorage->itemCount++;
+
+        // Point the item at its data within the region
+        CHK_STATUS(contentViewGetHead(pKinesisVideoStream->pView, &pViewItem));
+        pViewItem->allocationOffset = allocationOffset;
+    }
+
     if (CHECK_ITEM_STREAM_START(itemFlags)) {
         // Store the stream start timestamp for ACK timecode adjustment for relative cluster timecode streams
         pKinesisVideoStream->newSessionTimestamp = encodedFrameInfo.streamStartTs;
@@ -589,90 +1371,153 @@ STATUS putFrame(PKinesisVideoStream pKinesisVideoStream, PFrame pFrame) {
         }
     }
 
-    // We need to check for the latency pressure. If the view head is ahead of the current
-    // for more than the specified max latency then we need to call the optional user callback.
-    // NOTE: A special sentinel value is used to determine whether the latency is specified.
-    if (pKinesisVideoStream->streamInfo.streamCaps.maxLatency != STREAM_LATENCY_PRESSURE_CHECK_SENTINEL &&
-            pKinesisVideoClient->clientCallbacks.streamLatencyPressureFn != NULL) {
-        // Get the window duration from the view
-        CHK_STATUS(contentViewGetWindowDuration(pKinesisVideoStream->pView, &duration, NULL));
+    *pItemFlags = itemFlags;
 
-        // Check for the breach and invoke the user provided callback
-        if (duration > pKinesisVideoStream->streamInfo.streamCaps.maxLatency) {
-            CHK_STATUS(pKinesisVideoClient->clientCallbacks.streamLatencyPressureFn(
-                pKinesisVideoClient->clientCallbacks.customData,
-                TO_STREAM_HANDLE(pKinesisVideoStream),
-                duration));
-        }
+CleanUp:
+
+    // We need to see whether we need to remove the allocation on error. Otherwise, we will leak.
+    // NOTE: The referenced frame data is not released as it's still owned by the caller.
+    if (STATUS_FAILED(retStatus) && IS_VALID_ALLOCATION_HANDLE(allocHandle) && freeOnError) {
+        // Lock the client if it's not locked and the allocation is in the shared heap
+        lockStreamStorage(pKinesisVideoStream, itemFlags, pClientLocked);
+
+        // Free the actual allocation as we will leak otherwise.
+        heapFree(getStreamStorageHeap(pKinesisVideoStream, itemFlags), allocHandle);
     }
 
-    // Notify about data is available
-    pUploadHandleInfo = getStreamUploadInfoWithState(pKinesisVideoStream, UPLOAD_HANDLE_STATE_READY |
-            UPLOAD_HANDLE_STATE_STREAMING);
-    if (NULL != pUploadHandleInfo && IS_VALID_UPLOAD_HANDLE(pUploadHandleInfo->handle)) {
-        // Get the duration from current point to the head
-        CHK_STATUS(contentViewGetWindowDuration(pKinesisVideoStream->pView, &duration, NULL));
+    LEAVES();
+    return retStatus;
+}
 
-        // Get the size of the allocation from current point to the head
-        CHK_STATUS(contentViewGetWindowAllocationSize(pKinesisVideoStream->pView, &viewByteSize, NULL));
+/**
+ * Fills the caller buffer with the stream data
+ * @return STATUS of the operation
+ */
+STATUS getStreamData(PKinesisVideoStream pKinesisVideoStream, PUINT64 pClientStreamHandle, PBYTE pBuffer, UINT32 bufferSize, PUINT32 pFillSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
 
-        // Call the notification callback
-        CHK_STATUS(pKinesisVideoClient->clientCallbacks.streamDataAvailableFn(
-                pKinesisVideoClient->clientCallbacks.customData,
-                TO_STREAM_HANDLE(pKinesisVideoStream),
-                pKinesisVideoStream->streamInfo.name,
-                pUploadHandleInfo->handle,
-                duration,
-                viewByteSize));
+    CHK(pBuffer != NULL, STATUS_NULL_ARG);
+
+    retStatus = readStreamData(pKinesisVideoStream, pClientStreamHandle, pBuffer, bufferSize, pFillSize, NULL);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Gets a span over the next contiguous stream data and pins the underlying view item storage.
+ */
+STATUS getStreamDataSpan(PKinesisVideoStream pKinesisVideoStream, PUINT64 pClientStreamHandle, UINT32 maxSize, PStreamDataSpan pSpan)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKinesisVideoClient pKinesisVideoClient = NULL;
+    BOOL streamLocked = FALSE;
+
+    CHK(pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL && pSpan != NULL, STATUS_NULL_ARG);
+    pKinesisVideoClient = pKinesisVideoStream->pKinesisVideoClient;
+
+    pSpan->pData = NULL;
+    pSpan->size = 0;
+    pSpan->releaseToken = INVALID_ALLOCATION_HANDLE_VALUE;
+
+    // Lock the stream
+    pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
+    streamLocked = TRUE;
+
+    // Only a single span can be outstanding. The reader is notified once the span is released.
+    if (IS_VALID_ALLOCATION_HANDLE(pKinesisVideoStream->pinnedViewItem.handle)) {
+        pKinesisVideoStream->pinnedViewItem.readerWaiting = TRUE;
+        CHK(FALSE, STATUS_STREAM_DATA_SPAN_PINNED);
     }
 
-    // Recalculate frame rate if enabled
-    if (pKinesisVideoStream->streamInfo.streamCaps.recalculateMetrics) {
-        // Calculate the current frame rate only after the first iteration
-        currentTime = pKinesisVideoClient->clientCallbacks.getCurrentTimeFn(pKinesisVideoClient->clientCallbacks.customData);
-        if (!CHECK_ITEM_STREAM_START(itemFlags)) {
-            // Calculate the delta time in seconds
-            deltaInSeconds = (DOUBLE) (currentTime - pKinesisVideoStream->diagnostics.lastFrameRateTimestamp) /
-                             HUNDREDS_OF_NANOS_IN_A_SECOND;
+    retStatus = readStreamData(pKinesisVideoStream, pClientStreamHandle, NULL, maxSize, &pSpan->size, pSpan);
 
-            if (deltaInSeconds != 0) {
-                frameRate = 1 / deltaInSeconds;
+CleanUp:
 
-                // Update the current frame rate
-                pKinesisVideoStream->diagnostics.currentFrameRate = EMA_ACCUMULATOR_GET_NEXT(
-                        pKinesisVideoStream->diagnostics.currentFrameRate, frameRate);
-            }
-        }
+    if (streamLocked) {
+        pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Fills the caller buffer with the stream data and pins the contiguous data larger than the buffer.
+ */
+STATUS getStreamDataWithSpan(PKinesisVideoStream pKinesisVideoStream, PUINT64 pClientStreamHandle, PBYTE pBuffer, UINT32 bufferSize,
+                             PUINT32 pFillSize, PStreamDataSpan pSpan)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKinesisVideoClient pKinesisVideoClient = NULL;
+    BOOL streamLocked = FALSE;
+
+    CHK(pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL && pBuffer != NULL && pSpan != NULL,
+        STATUS_NULL_ARG);
+    pKinesisVideoClient = pKinesisVideoStream->pKinesisVideoClient;
+
+    pSpan->pData = NULL;
+    pSpan->size = 0;
+    pSpan->releaseToken = INVALID_ALLOCATION_HANDLE_VALUE;
+
+    // Lock the stream
+    pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
+    streamLocked = TRUE;
+
+    // Only a single span can be outstanding. The reader is notified once the span is released.
+    if (IS_VALID_ALLOCATION_HANDLE(pKinesisVideoStream->pinnedViewItem.handle)) {
+        pKinesisVideoStream->pinnedViewItem.readerWaiting = TRUE;
+        CHK(FALSE, STATUS_STREAM_DATA_SPAN_PINNED);
+    }
+
+    retStatus = readStreamData(pKinesisVideoStream, pClientStreamHandle, pBuffer, bufferSize, pFillSize, pSpan);
+
+CleanUp:
+
+    if (streamLocked) {
+        pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
+    }
+
+    LEAVES();
+    return retStatus;
+}
 
-        // Store the last frame timestamp
-        pKinesisVideoStream->diagnostics.lastFrameRateTimestamp = currentTime;
-    }
+/**
+ * Releases the previously returned stream data span.
+ */
+STATUS releaseStreamDataSpan(PKinesisVideoStream pKinesisVideoStream, UINT64 releaseToken)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PKinesisVideoClient pKinesisVideoClient = NULL;
+    BOOL streamLocked = FALSE, readerWaiting;
 
-    // Unlock the client as we no longer need it locked
-    pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
-    clientLocked = FALSE;
+    CHK(pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL, STATUS_NULL_ARG);
+    pKinesisVideoClient = pKinesisVideoStream->pKinesisVideoClient;
 
-    // Unlock the stream (even though it will be unlocked in the cleanup
-    pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
-    streamLocked = FALSE;
+    // Lock the stream
+    pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
+    streamLocked = TRUE;
 
-CleanUp:
+    // The token is never re-issued during the stream lifetime so a stale token can't release a newer span
+    CHK(IS_VALID_ALLOCATION_HANDLE(releaseToken) && IS_VALID_ALLOCATION_HANDLE(pKinesisVideoStream->pinnedViewItem.handle) &&
+        releaseToken == pKinesisVideoStream->pinnedViewItem.token, STATUS_INVALID_STREAM_DATA_SPAN);
 
-    // We need to see whether we need to remove the allocation on error. Otherwise, we will leak
-    if (STATUS_FAILED(retStatus) && IS_VALID_ALLOCATION_HANDLE(allocHandle) && freeOnError) {
-        // Lock the client if it's not locked
-        if (!clientLocked) {
-            pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
-            clientLocked = TRUE;
-        }
+    readerWaiting = pKinesisVideoStream->pinnedViewItem.readerWaiting;
+    CHK_STATUS(unpinViewItem(pKinesisVideoStream));
 
-        // Free the actual allocation as we will leak otherwise.
-        heapFree(pKinesisVideoClient->pHeap, allocHandle);
+    // Notify the readers which have been turned away while the data was pinned as there might be no further frames
+    if (readerWaiting) {
+        CHK_STATUS(notifyStreamDataAvailable(pKinesisVideoStream));
     }
 
-    if (clientLocked) {
-        pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
-    }
+CleanUp:
 
     if (streamLocked) {
         pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
@@ -683,31 +1528,40 @@ CleanUp:
 }
 
 /**
- * Fills the caller buffer with the stream data
- * @return STATUS of the operation
+ * Reads the stream data either by copying it into the buffer or by pinning the current
+ * view item storage and returning a span over it if the span is specified.
+ * If both are specified, the data is copied and the rest of the current view item data
+ * is pinned instead if it's larger than the entire buffer.
  */
-STATUS getStreamData(PKinesisVideoStream pKinesisVideoStream, PUINT64 pClientStreamHandle, PBYTE pBuffer, UINT32 bufferSize, PUINT32 pFillSize)
+STATUS readStreamData(PKinesisVideoStream pKinesisVideoStream, PUINT64 pClientStreamHandle, PBYTE pBuffer, UINT32 bufferSize,
+                      PUINT32 pFillSize, PStreamDataSpan pSpan)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS, stalenessCheckStatus = STATUS_SUCCESS;
+    ProfilerTrace profilerTrace = PROFILER_TRACE_INITIALIZER;
     PKinesisVideoClient pKinesisVideoClient = NULL;
     PViewItem pViewItem = NULL;
-    PBYTE pAlloc = NULL;
-    UINT32 size = 0, remainingSize = bufferSize;
+    PBYTE pAlloc = NULL, pData;
+    UINT32 size = 0, remainingSize = bufferSize, mappedSize = 0, mappedFlags = ITEM_FLAG_NONE, dataOffset, readSize = 0;
+    FrameReference frameReference;
+    ALLOCATION_HANDLE mappedHandle = INVALID_ALLOCATION_HANDLE_VALUE;
     PBYTE pCurPnt = pBuffer;
     BOOL streamLocked = FALSE, clientLocked = FALSE, rollbackToLastAck, restarted = FALSE;
+    PHeap pHeap;
     UINT64 currentTime;
     DOUBLE transferRate, deltaInSeconds;
     PUploadHandleInfo pUploadHandleInfo;
 
     CHK(pKinesisVideoStream != NULL &&
                 pKinesisVideoStream->pKinesisVideoClient != NULL &&
-                pBuffer != NULL &&
+                (pBuffer != NULL || pSpan != NULL) &&
                 pClientStreamHandle != NULL &&
                 pFillSize != NULL,
         STATUS_NULL_ARG);
     CHK(bufferSize != 0, STATUS_INVALID_ARG);
 
+    PROFILER_TRACE_START("getStreamData", TRACE_LEVEL_INFO, &profilerTrace);
+
     pKinesisVideoClient = pKinesisVideoStream->pKinesisVideoClient;
 
     // Lock the stream
@@ -762,12 +1616,12 @@ STATUS getStreamData(PKinesisVideoStream pKinesisVideoStream, PUINT64 pClientStr
     // We will exit with an EOS if we have a terminated handle
     if (pUploadHandleInfo->state == UPLOAD_HANDLE_STATE_TERMINATING) {
         DLOGV("Indicating an EOS for a terminated stream upload handle %" PRIu64, *pClientStreamHandle);
-        pUploadHandleInfo->state = UPLOAD_HANDLE_STATE_ERROR;
+        setStreamUploadInfoState(pKinesisVideoStream, pUploadHandleInfo, UPLOAD_HANDLE_STATE_ERROR);
         CHK(FALSE, STATUS_END_OF_STREAM);
     }
 
     // Reset the state to streaming
-    pUploadHandleInfo->state = UPLOAD_HANDLE_STATE_STREAMING;
+    setStreamUploadInfoState(pKinesisVideoStream, pUploadHandleInfo, UPLOAD_HANDLE_STATE_STREAMING);
 
     // Continue filling the buffer from the point we left off
     do {
@@ -797,6 +1651,12 @@ STATUS getStreamData(PKinesisVideoStream pKinesisVideoStream, PUINT64 pClientStr
                 CHK(FALSE, STATUS_NO_MORE_DATA_AVAILABLE);
             }
         } else if (pKinesisVideoStream->curViewItem.offset == pKinesisVideoStream->curViewItem.viewItem.length) {
+            // The stream start fix-up re-allocates the current item storage so release the mapping first
+            if (IS_VALID_ALLOCATION_HANDLE(mappedHandle) && CHECK_ITEM_STREAM_START(pKinesisVideoStream->curViewItem.viewItem.flags)) {
+                mappedHandle = INVALID_ALLOCATION_HANDLE_VALUE;
+                CHK_STATUS(unmapStreamStorage(pKinesisVideoStream, mappedFlags, pAlloc, &clientLocked));
+            }
+
             // Fix-up the current item as it might be a stream start
             CHK_STATUS(resetCurrentViewItemStreamStart(pKinesisVideoStream));
 
@@ -814,10 +1674,10 @@ STATUS getStreamData(PKinesisVideoStream pKinesisVideoStream, PUINT64 pClientStr
             // Check if we are finishing the previous stream and we have a boundary item
             if (CHECK_ITEM_STREAM_START(pKinesisVideoStream->curViewItem.viewItem.flags)) {
                 // Set the stream handle as we have exhausted the previous
-                pUploadHandleInfo->state = UPLOAD_HANDLE_STATE_TERMINATED;
+                setStreamUploadInfoState(pKinesisVideoStream, pUploadHandleInfo, UPLOAD_HANDLE_STATE_TERMINATED);
 
                 // Store the termination index for cleanup
-                pUploadHandleInfo->endIndex = pKinesisVideoStream->curViewItem.viewItem.index;
+                CHK_STATUS(setStreamUploadInfoEndIndex(pKinesisVideoStream, pUploadHandleInfo, pKinesisVideoStream->curViewItem.viewItem.index));
 
                 DLOGV("Indicating EOS for stream upload handle: %" PRIu64, *pClientStreamHandle);
 
@@ -828,41 +1688,104 @@ STATUS getStreamData(PKinesisVideoStream pKinesisVideoStream, PUINT64 pClientStr
             // Now, we can stream enough data out if we don't have a zero item
             CHK(pKinesisVideoStream->curViewItem.offset != pKinesisVideoStream->curViewItem.viewItem.length, STATUS_NO_MORE_DATA_AVAILABLE);
 
-            // Lock the client
-            pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
-            clientLocked = TRUE;
+            // Lock the client only if the current item is stored in the shared heap
+            lockStreamStorage(pKinesisVideoStream, pKinesisVideoStream->curViewItem.viewItem.flags, &clientLocked);
+            pHeap = getStreamStorageHeap(pKinesisVideoStream, pKinesisVideoStream->curViewItem.viewItem.flags);
 
             // Fill the rest of the buffer of the current view item first
-            // Map the storage
-            CHK_STATUS(heapMap(pKinesisVideoClient->pHeap, pKinesisVideoStream->curViewItem.viewItem.handle, (PVOID *) &pAlloc, &size));
+            // Map the storage unless the item shares the storage mapped for the previous item of the fragment
+            if (pKinesisVideoStream->curViewItem.viewItem.handle != mappedHandle) {
+                if (IS_VALID_ALLOCATION_HANDLE(mappedHandle)) {
+                    mappedHandle = INVALID_ALLOCATION_HANDLE_VALUE;
+                    CHK_STATUS(unmapStreamStorage(pKinesisVideoStream, mappedFlags, pAlloc, &clientLocked));
+                }
+
+                CHK_STATUS(heapMap(pHeap, pKinesisVideoStream->curViewItem.viewItem.handle, (PVOID *) &pAlloc, &mappedSize));
+                mappedHandle = pKinesisVideoStream->curViewItem.viewItem.handle;
+                mappedFlags = pKinesisVideoStream->curViewItem.viewItem.flags;
+            }
 
-            // Validate we had allocated enough storage just in case
-            CHK(pKinesisVideoStream->curViewItem.viewItem.length - pKinesisVideoStream->curViewItem.offset <= size, STATUS_VIEW_ITEM_SIZE_GREATER_THAN_ALLOCATION);
+            // Locate the contiguous data at the consumed offset
+            size = pKinesisVideoStream->curViewItem.viewItem.length - pKinesisVideoStream->curViewItem.offset;
+            if (CHECK_ITEM_FRAME_REFERENCE(pKinesisVideoStream->curViewItem.viewItem.flags)) {
+                // The MKV elements are stored and followed by the caller frame data
+                dataOffset = GET_ITEM_DATA_OFFSET(pKinesisVideoStream->curViewItem.viewItem.flags);
+                CHK(dataOffset + SIZEOF(FrameReference) <= mappedSize, STATUS_VIEW_ITEM_SIZE_GREATER_THAN_ALLOCATION);
+
+                if (pKinesisVideoStream->curViewItem.offset < dataOffset) {
+                    pData = pAlloc + pKinesisVideoStream->curViewItem.offset;
+                    size = dataOffset - pKinesisVideoStream->curViewItem.offset;
+                } else {
+                    MEMCPY(&frameReference, pAlloc + dataOffset, SIZEOF(FrameReference));
+                    pData = frameReference.pFrameData + pKinesisVideoStream->curViewItem.offset - dataOffset;
+                }
+            } else {
+                // Validate we had allocated enough storage just in case
+                CHK(pKinesisVideoStream->curViewItem.viewItem.allocationOffset + pKinesisVideoStream->curViewItem.viewItem.length -
+                    pKinesisVideoStream->curViewItem.offset <= mappedSize, STATUS_VIEW_ITEM_SIZE_GREATER_THAN_ALLOCATION);
 
-            // Copy as much as we can
-            size = MIN(remainingSize, pKinesisVideoStream->curViewItem.viewItem.length - pKinesisVideoStream->curViewItem.offset);
-            MEMCPY(pCurPnt, pAlloc + pKinesisVideoStream->curViewItem.offset, size);
+                pData = pAlloc + pKinesisVideoStream->curViewItem.viewItem.allocationOffset + pKinesisVideoStream->curViewItem.offset;
+            }
 
-            // Unmap the storage for the frame
-            CHK_STATUS(heapUnmap(pKinesisVideoClient->pHeap, ((PVOID) pAlloc)));
+            // Pin the data which doesn't fit into the entire buffer when copying so it's sent from the storage
+            if (pSpan != NULL && (pBuffer == NULL || size > bufferSize)) {
+                // Keep the storage mapped and pinned until the span is released
+                pKinesisVideoStream->pinnedViewItem.handle = pKinesisVideoStream->curViewItem.viewItem.handle;
+                pKinesisVideoStream->pinnedViewItem.flags = pKinesisVideoStream->curViewItem.viewItem.flags;
+                pKinesisVideoStream->pinnedViewItem.pAlloc = pAlloc;
+                pKinesisVideoStream->pinnedViewItem.removed = FALSE;
+                pKinesisVideoStream->pinnedViewItem.readerWaiting = FALSE;
+                pKinesisVideoStream->pinnedViewItem.token = ++pKinesisVideoStream->spanTokenSequence;
+
+                // The mapping is owned by the pinned item now
+                mappedHandle = INVALID_ALLOCATION_HANDLE_VALUE;
+
+                // The span can only cover a single contiguous view item segment
+                if (pBuffer == NULL) {
+                    size = MIN(remainingSize, size);
+                }
+
+                pSpan->pData = pData;
+                pSpan->size = size;
+                pSpan->releaseToken = pKinesisVideoStream->pinnedViewItem.token;
+                remainingSize = 0;
+            } else {
+                // Copy as much as we can
+                size = MIN(remainingSize, size);
+                MEMCPY(pCurPnt, pData, size);
+                pCurPnt += size;
+                remainingSize -= size;
+                *pFillSize += size;
+            }
 
             // Unlock the client
-            pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData,
-                                                               pKinesisVideoClient->base.lock);
-            clientLocked = FALSE;
+            if (clientLocked) {
+                pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData,
+                                                                   pKinesisVideoClient->base.lock);
+                clientLocked = FALSE;
+            }
 
             // Set the values
             pKinesisVideoStream->curViewItem.offset += size;
-            pCurPnt += size;
-            remainingSize -= size;
-            *pFillSize += size;
+            readSize += size;
         }
     } while (remainingSize != 0);
 
 CleanUp:
 
+    // Unmap the storage of the last read item
+    if (IS_VALID_ALLOCATION_HANDLE(mappedHandle)) {
+        mappedHandle = INVALID_ALLOCATION_HANDLE_VALUE;
+        unmapStreamStorage(pKinesisVideoStream, mappedFlags, pAlloc, &clientLocked);
+    }
+
+    if (clientLocked) {
+        pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
+        clientLocked = FALSE;
+    }
+
     // Run staleness detection if we have ACKs enabled and if we have retrieved any data
-    if (pFillSize != NULL && *pFillSize != 0) {
+    if (readSize != 0) {
         stalenessCheckStatus = checkForConnectionStaleness(pKinesisVideoStream, &pKinesisVideoStream->curViewItem.viewItem);
     }
 
@@ -876,10 +1799,10 @@ CleanUp:
             (retStatus == STATUS_SUCCESS
              || retStatus == STATUS_NO_MORE_DATA_AVAILABLE
              || retStatus == STATUS_END_OF_STREAM)
-        && pFillSize != NULL && *pFillSize != 0) {
+        && readSize != 0) {
         // Calculate the current transfer rate only after the first iteration
         currentTime = pKinesisVideoClient->clientCallbacks.getCurrentTimeFn(pKinesisVideoClient->clientCallbacks.customData);
-        pKinesisVideoStream->diagnostics.accumulatedByteCount += *pFillSize;
+        pKinesisVideoStream->diagnostics.accumulatedByteCount += readSize;
         if (!restarted) {
             // Calculate the delta time in seconds
             deltaInSeconds = (DOUBLE) (currentTime - pKinesisVideoStream->diagnostics.lastTransferRateTimestamp) / HUNDREDS_OF_NANOS_IN_A_SECOND;
@@ -924,6 +1847,8 @@ CleanUp:
         retStatus = stalenessCheckStatus;
     }
 
+    PROFILER_TRACE_STOP(profilerTrace);
+
     LEAVES();
     return retStatus;
 }
@@ -982,6 +1907,9 @@ STATUS streamFormatChanged(PKinesisVideoStream pKinesisVideoStream, UINT32 codec
     CHK(codecPrivateDataSize <= MKV_MAX_CODEC_PRIVATE_LEN, STATUS_MKV_INVALID_CODEC_PRIVATE_LENGTH);
     CHK(codecPrivateDataSize == 0 || codecPrivateData != NULL, STATUS_MKV_CODEC_PRIVATE_NULL);
 
+    // The codec private data of the individual tracks is fixed at the stream creation
+    CHK(pKinesisVideoStream->streamInfo.streamCaps.trackInfoCount == 0, STATUS_MULTI_TRACK_FORMAT_CHANGE_NOT_SUPPORTED);
+
     // Ensure we are not in a streaming state
     CHK_STATUS(acceptStateMachineState(pKinesisVideoStream->base.pStateMachine,
                                             STREAM_STATE_READY |
@@ -1046,11 +1974,14 @@ STATUS streamStartFixupOnReconnect(PKinesisVideoStream pKinesisVideoStream)
     UINT64 streamStartTs;
     PViewItem pViewItem = NULL;
     BOOL streamLocked = FALSE, clientLocked = FALSE;
-    UINT32 headerSize, packagedSize, overallSize, dataOffset;
+    UINT32 headerSize, packagedSize, storedSize, overallSize, dataOffset;
     PBYTE pAlloc = NULL, pFrame = NULL;
     PKinesisVideoClient pKinesisVideoClient;
     ALLOCATION_HANDLE allocationHandle = INVALID_ALLOCATION_HANDLE_VALUE;
     ALLOCATION_HANDLE oldAllocationHandle;
+    UINT32 storageFlags = ITEM_FLAG_NONE, oldStorageFlags;
+    PHeap pHeap;
+    BOOL copyReference;
 
     CHK(pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL, STATUS_NULL_ARG);
 
@@ -1071,10 +2002,6 @@ STATUS streamStartFixupOnReconnect(PKinesisVideoStream pKinesisVideoStream)
     CHK_STATUS(contentViewGetCurrentIndex(pKinesisVideoStream->pView, &curIndex));
     CHK_STATUS(contentViewGetItemAt(pKinesisVideoStream->pView, curIndex, &pViewItem));
 
-    // Lock the client
-    pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
-    clientLocked = TRUE;
-
     // Get the required size for the header
     CHK_STATUS(mkvgenGenerateHeader(pKinesisVideoStream->pMkvGenerator,
                                     NULL,
@@ -1090,20 +2017,31 @@ STATUS streamStartFixupOnReconnect(PKinesisVideoStream pKinesisVideoStream)
     // Early termination if the item is already has a stream start indicator.
     CHK(!CHECK_ITEM_STREAM_START(pViewItem->flags), retStatus);
 
+    // Lock the client only if the existing frame is stored in the shared heap
+    lockStreamStorage(pKinesisVideoStream, pViewItem->flags, &clientLocked);
+
     // Get the existing frame allocation
-    CHK_STATUS(heapMap(pKinesisVideoClient->pHeap, pViewItem->handle, (PVOID*) &pFrame, &packagedSize));
+    CHK_STATUS(heapMap(getStreamStorageHeap(pKinesisVideoStream, pViewItem->flags), pViewItem->handle, (PVOID*) &pFrame, &packagedSize));
     CHK(pFrame != NULL, STATUS_NOT_ENOUGH_MEMORY);
 
+    // The item might share the allocation with the other items of the fragment.
+    // Only the stored part of the referenced frame is moved unless the old storage is pinned.
+    pFrame += pViewItem->allocationOffset;
+    packagedSize = pViewItem->length;
+    copyReference = isPinnedFrameReference(pKinesisVideoStream, pViewItem);
+    storedSize = copyReference ? packagedSize : VIEW_ITEM_STORAGE_SIZE(pViewItem);
+
     // Allocate storage for the frame
     dataOffset = GET_ITEM_DATA_OFFSET(pViewItem->flags);
-    overallSize = packagedSize + headerSize;
-    CHK_STATUS(heapAlloc(pKinesisVideoClient->pHeap, overallSize, &allocationHandle));
+    overallSize = storedSize + headerSize;
+    CHK_STATUS(streamStorageAlloc(pKinesisVideoStream, overallSize, &allocationHandle, &storageFlags, &clientLocked));
 
     // Ensure we have space and if not then bail
     CHK(IS_VALID_ALLOCATION_HANDLE(allocationHandle), STATUS_STORE_OUT_OF_MEMORY);
 
     // Map the storage
-    CHK_STATUS(heapMap(pKinesisVideoClient->pHeap, allocationHandle, (PVOID*) &pAlloc, &overallSize));
+    pHeap = getStreamStorageHeap(pKinesisVideoStream, storageFlags);
+    CHK_STATUS(heapMap(pHeap, allocationHandle, (PVOID*) &pAlloc, &overallSize));
 
     // Actually package the bits in the storage
     CHK_STATUS(mkvgenGenerateHeader(pKinesisVideoStream->pMkvGenerator,
@@ -1112,25 +2050,47 @@ STATUS streamStartFixupOnReconnect(PKinesisVideoStream pKinesisVideoStream)
                                     &streamStartTs));
 
     // Copy the rest of the packaged frame
-    MEMCPY(pAlloc + headerSize, pFrame, packagedSize);
+    if (copyReference) {
+        copyReferencedViewItemData(pViewItem, pFrame, 0, pAlloc + headerSize, storedSize);
+    } else {
+        MEMCPY(pAlloc + headerSize, pFrame, storedSize);
+    }
 
-    // Unmap the storage for the frame
-    CHK_STATUS(heapUnmap(pKinesisVideoClient->pHeap, ((PVOID) pAlloc)));
+    // Unmap the storage for the frame and the existing frame
+    CHK_STATUS(heapUnmap(pHeap, ((PVOID) pAlloc)));
+    CHK_STATUS(heapUnmap(getStreamStorageHeap(pKinesisVideoStream, pViewItem->flags), (PVOID) (pFrame - pViewItem->allocationOffset)));
 
-    // Set the old allocation handle to be freed
+    // Update the length first as the view keeps the running allocation size
+    CHK_STATUS(contentViewSetItemLength(pKinesisVideoStream->pView, pViewItem->index, packagedSize + headerSize));
+
+    // Set the old allocation handle to be freed. The frame reference has moved to the new storage
+    // or stays with the pinned storage and is released once the span is released.
     oldAllocationHandle = pViewItem->handle;
+    oldStorageFlags = pViewItem->flags;
+    if (copyReference) {
+        CLEAR_ITEM_FRAME_REFERENCE(pViewItem->flags);
+    } else {
+        CLEAR_ITEM_FRAME_REFERENCE(oldStorageFlags);
+    }
+
     pViewItem->handle = allocationHandle;
+    pViewItem->allocationOffset = 0;
+    CLEAR_ITEM_STREAM_ARENA(pViewItem->flags);
+    CLEAR_ITEM_FRAGMENT_STORAGE(pViewItem->flags);
+    pViewItem->flags |= storageFlags;
     SET_ITEM_STREAM_START(pViewItem->flags);
     SET_ITEM_DATA_OFFSET(pViewItem->flags, headerSize + dataOffset);
-    pViewItem->length = overallSize;
 
     // Set the handle that will need to be freed on exit - now we should free the old one
     allocationHandle = oldAllocationHandle;
+    storageFlags = oldStorageFlags;
 
     // Unlock the client
-    pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData,
-                                                       pKinesisVideoClient->base.lock);
-    clientLocked = FALSE;
+    if (clientLocked) {
+        pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData,
+                                                           pKinesisVideoClient->base.lock);
+        clientLocked = FALSE;
+    }
 
     // Unlock the stream (even though it will be unlocked in the cleanup
     pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
@@ -1138,15 +2098,9 @@ STATUS streamStartFixupOnReconnect(PKinesisVideoStream pKinesisVideoStream)
 
 CleanUp:
 
-    // Clear up the previous allocation handle
+    // Clear up the previous allocation handle. The free is deferred if the allocation is pinned.
     if (IS_VALID_ALLOCATION_HANDLE(allocationHandle)) {
-        // Lock the client if it's not locked
-        if (!clientLocked) {
-            pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
-            clientLocked = TRUE;
-        }
-
-        heapFree(pKinesisVideoClient->pHeap, allocationHandle);
+        freeStreamStorage(pKinesisVideoStream, allocationHandle, storageFlags, &clientLocked);
     }
 
     if (clientLocked) {
@@ -1167,11 +2121,14 @@ STATUS resetCurrentViewItemStreamStart(PKinesisVideoStream pKinesisVideoStream)
     STATUS retStatus = STATUS_SUCCESS;
     PViewItem pViewItem = NULL;
     BOOL streamLocked = FALSE, clientLocked = FALSE;
-    UINT32 clusterHeaderSize, packagedSize, overallSize, dataOffset;
+    UINT32 clusterHeaderSize, packagedSize, storedSize, overallSize, itemLength, dataOffset, removedSize;
     PBYTE pAlloc = NULL, pFrame = NULL;
     PKinesisVideoClient pKinesisVideoClient;
     ALLOCATION_HANDLE allocationHandle = INVALID_ALLOCATION_HANDLE_VALUE;
     ALLOCATION_HANDLE oldAllocationHandle;
+    UINT32 storageFlags = ITEM_FLAG_NONE, oldStorageFlags;
+    PHeap pHeap;
+    BOOL copyReference;
 
     CHK(pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL, STATUS_NULL_ARG);
 
@@ -1189,53 +2146,87 @@ STATUS resetCurrentViewItemStreamStart(PKinesisVideoStream pKinesisVideoStream)
     // Get the view item corresponding to the current item
     CHK_STATUS(contentViewGetItemAt(pKinesisVideoStream->pView, pKinesisVideoStream->curViewItem.viewItem.index, &pViewItem));
 
-    // Lock the client
-    pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
-    clientLocked = TRUE;
-
     // Get the required size for the cluster header
     // NOTE: Stream start is only on a cluster boundary
     CHK_STATUS(mkvgenGetMkvOverheadSize(pKinesisVideoStream->pMkvGenerator,
                                         MKV_STATE_START_CLUSTER,
                                         &clusterHeaderSize));
 
+    // Lock the client only if the existing frame is stored in the shared heap
+    lockStreamStorage(pKinesisVideoStream, pViewItem->flags, &clientLocked);
+
     // Get the existing frame allocation
-    CHK_STATUS(heapMap(pKinesisVideoClient->pHeap, pViewItem->handle, (PVOID*) &pFrame, &packagedSize));
+    CHK_STATUS(heapMap(getStreamStorageHeap(pKinesisVideoStream, pViewItem->flags), pViewItem->handle, (PVOID*) &pFrame, &packagedSize));
     CHK(pFrame != NULL, STATUS_NOT_ENOUGH_MEMORY);
 
+    // The item might share the allocation with the other items of the fragment.
+    // Only the stored part of the referenced frame is moved unless the old storage is pinned.
+    pFrame += pViewItem->allocationOffset;
+    packagedSize = pViewItem->length;
+    copyReference = isPinnedFrameReference(pKinesisVideoStream, pViewItem);
+    storedSize = copyReference ? packagedSize : VIEW_ITEM_STORAGE_SIZE(pViewItem);
+
     // Allocate storage for the frame
     dataOffset = GET_ITEM_DATA_OFFSET(pViewItem->flags);
-    overallSize = packagedSize - dataOffset + clusterHeaderSize;
-    CHK_STATUS(heapAlloc(pKinesisVideoClient->pHeap, overallSize, &allocationHandle));
+    itemLength = packagedSize - dataOffset + clusterHeaderSize;
+    overallSize = storedSize - dataOffset + clusterHeaderSize;
+    CHK_STATUS(streamStorageAlloc(pKinesisVideoStream, overallSize, &allocationHandle, &storageFlags, &clientLocked));
 
     // Ensure we have space and if not then bail
     CHK(IS_VALID_ALLOCATION_HANDLE(allocationHandle), STATUS_STORE_OUT_OF_MEMORY);
 
     // Map the storage
-    CHK_STATUS(heapMap(pKinesisVideoClient->pHeap, allocationHandle, (PVOID*) &pAlloc, &overallSize));
+    pHeap = getStreamStorageHeap(pKinesisVideoStream, storageFlags);
+    CHK_STATUS(heapMap(pHeap, allocationHandle, (PVOID*) &pAlloc, &overallSize));
 
     // Copy the rest of the packaged frame
-    MEMCPY(pAlloc, pFrame + dataOffset - clusterHeaderSize, overallSize);
+    if (copyReference) {
+        copyReferencedViewItemData(pViewItem, pFrame, dataOffset - clusterHeaderSize, pAlloc, overallSize);
+    } else {
+        MEMCPY(pAlloc, pFrame + dataOffset - clusterHeaderSize, overallSize);
+    }
+
+    // Unmap the storage for the frame and the existing frame
+    CHK_STATUS(heapUnmap(pHeap, ((PVOID) pAlloc)));
+    CHK_STATUS(heapUnmap(getStreamStorageHeap(pKinesisVideoStream, pViewItem->flags), (PVOID) (pFrame - pViewItem->allocationOffset)));
 
-    // Unmap the storage for the frame
-    CHK_STATUS(heapUnmap(pKinesisVideoClient->pHeap, ((PVOID) pAlloc)));
+    // Update the length first as the view keeps the running allocation size
+    CHK_STATUS(contentViewSetItemLength(pKinesisVideoStream->pView, pViewItem->index, itemLength));
 
-    // Set the old allocation handle to be freed
+    // Set the old allocation handle to be freed. The frame reference has moved to the new storage
+    // or stays with the pinned storage and is released once the span is released.
     oldAllocationHandle = pViewItem->handle;
+    oldStorageFlags = pViewItem->flags;
+    if (copyReference) {
+        CLEAR_ITEM_FRAME_REFERENCE(pViewItem->flags);
+    } else {
+        CLEAR_ITEM_FRAME_REFERENCE(oldStorageFlags);
+    }
+
     pViewItem->handle = allocationHandle;
+    pViewItem->allocationOffset = 0;
+    CLEAR_ITEM_STREAM_ARENA(pViewItem->flags);
+    CLEAR_ITEM_FRAGMENT_STORAGE(pViewItem->flags);
+    pViewItem->flags |= storageFlags;
     CLEAR_ITEM_STREAM_START(pViewItem->flags);
     SET_ITEM_DATA_OFFSET(pViewItem->flags, clusterHeaderSize);
-    pViewItem->length = overallSize;
 
     // Set the handle that will need to be freed on exit - now we should free the old one
     allocationHandle = oldAllocationHandle;
+    storageFlags = oldStorageFlags;
 
     // Unlock the client
-    pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData,
-                                                       pKinesisVideoClient->base.lock);
-    clientLocked = FALSE;
+    if (clientLocked) {
+        pKinesisVideoClient->clientCallbacks.unlockMutexFn(pKinesisVideoClient->clientCallbacks.customData,
+                                                           pKinesisVideoClient->base.lock);
+        clientLocked = FALSE;
+    }
 
-    // Re-set back the current
+    // Re-set back the current keeping the consumed offset within the shortened item.
+    // NOTE: The item is reset after it has been fully consumed so the consumed offset moves to the new end.
+    removedSize = pKinesisVideoStream->curViewItem.viewItem.length - itemLength;
+    pKinesisVideoStream->curViewItem.offset = pKinesisVideoStream->curViewItem.offset > removedSize ?
+                                              pKinesisVideoStream->curViewItem.offset - removedSize : 0;
     pKinesisVideoStream->curViewItem.viewItem = *pViewItem;
 
     // Unlock the stream (even though it will be unlocked in the cleanup
@@ -1244,15 +2235,9 @@ STATUS resetCurrentViewItemStreamStart(PKinesisVideoStream pKinesisVideoStream)
 
 CleanUp:
 
-    // Clear up the previous allocation handle
+    // Clear up the previous allocation handle. The free is deferred if the allocation is pinned.
     if (IS_VALID_ALLOCATION_HANDLE(allocationHandle)) {
-        // Lock the client if it's not locked
-        if (!clientLocked) {
-            pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoClient->base.lock);
-            clientLocked = TRUE;
-        }
-
-        heapFree(pKinesisVideoClient->pHeap, allocationHandle);
+        freeStreamStorage(pKinesisVideoStream, allocationHandle, storageFlags, &clientLocked);
     }
 
     if (clientLocked) {
@@ -1276,20 +2261,14 @@ STATUS getNextBoundaryViewItem(PKinesisVideoStream pKinesisVideoStream, PViewIte
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PViewItem pViewItem = NULL;
-    BOOL iterate = TRUE;
 
     CHK(pKinesisVideoStream != NULL && pKinesisVideoStream->pKinesisVideoClient != NULL && ppViewItem != NULL, STATUS_NULL_ARG);
 
     // Set the result to null first
     *ppViewItem = NULL;
 
-    // Iterate until we find a key frame item.
-    while (iterate) {
-        CHK_STATUS(contentViewGetNext(pKinesisVideoStream->pView, &pViewItem));
-        if (CHECK_ITEM_FRAGMENT_START(pViewItem->flags)) {
-            iterate = FALSE;
-        }
-    }
+    // Skip to the next key frame item using the view fragment index.
+    CHK_STATUS(contentViewGetNextFragmentStart(pKinesisVideoStream->pView, &pViewItem));
 
     // Assign the return value
     *ppViewItem = pViewItem;
@@ -1301,103 +2280,298 @@ CleanUp:
 }
 
 /**
- * Gets the upload handle info corresponding to the specified handle and NULL otherwise
+ * Clips the duration of the view head item to end at the timestamp of the item to be added
  */
-PUploadHandleInfo getStreamUploadInfo(PKinesisVideoStream pKinesisVideoStream, UPLOAD_HANDLE uploadHandle) {
+STATUS clipViewHeadDuration(PKinesisVideoStream pKinesisVideoStream, UINT64 timestamp)
+{
+    ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    StackQueueIterator iterator;
-    PUploadHandleInfo pUploadHandleInfo = NULL, pCurHandleInfo;
-    UINT64 data;
+    PViewItem pViewItem = NULL;
 
-    // Iterate linearly and find the first ready state handle
-    CHK_STATUS(stackQueueGetIterator(pKinesisVideoStream->pUploadInfoQueue, &iterator));
-    while (IS_VALID_ITERATOR(iterator)) {
-        CHK_STATUS(stackQueueIteratorGetItem(iterator, &data));
+    CHK(pKinesisVideoStream != NULL, STATUS_NULL_ARG);
 
-        pCurHandleInfo = (PUploadHandleInfo) data;
-        CHK(pCurHandleInfo != NULL, STATUS_INTERNAL_ERROR);
-        if (pCurHandleInfo->handle == uploadHandle) {
-            pUploadHandleInfo = pCurHandleInfo;
+    // Nothing to clip in an empty view
+    retStatus = contentViewGetHead(pKinesisVideoStream->pView, &pViewItem);
+    CHK(retStatus == STATUS_SUCCESS || retStatus == STATUS_CONTENT_VIEW_NO_MORE_ITEMS, retStatus);
+    if (retStatus == STATUS_CONTENT_VIEW_NO_MORE_ITEMS) {
+        retStatus = STATUS_SUCCESS;
+        CHK(FALSE, retStatus);
+    }
 
-            // Found the item - early exit
-            CHK(FALSE, retStatus);
+    // The out of order timestamps are rejected by the view
+    if (pViewItem->timestamp <= timestamp && pViewItem->timestamp + pViewItem->duration > timestamp) {
+        pViewItem->duration = timestamp - pViewItem->timestamp;
+    }
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Gets the view item of the fragment with the ACK timestamp. The items of the multi-track streams
+ * can share the timestamp so the fragment start is picked among them.
+ */
+STATUS getFragmentViewItemWithTimestamp(PKinesisVideoStream pKinesisVideoStream, UINT64 timestamp, PViewItem* ppViewItem)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PViewItem pViewItem = NULL, pCurItem = NULL;
+    UINT64 index;
+
+    CHK(pKinesisVideoStream != NULL && ppViewItem != NULL, STATUS_NULL_ARG);
+
+    CHK_STATUS(contentViewGetItemWithTimestamp(pKinesisVideoStream->pView, timestamp, &pViewItem));
+    *ppViewItem = pViewItem;
+
+    // Nothing else to do for a single track stream
+    CHK(IS_MULTI_TRACK_STREAM(pKinesisVideoStream), retStatus);
+
+    // Rewind to the first item with the timestamp
+    index = pViewItem->index;
+    while (index != 0 && STATUS_SUCCEEDED(contentViewGetItemAt(pKinesisVideoStream->pView, index - 1, &pCurItem)) &&
+           pCurItem->timestamp == timestamp) {
+        index--;
+    }
+
+    // Find the fragment start among the items up to the timestamp
+    while (STATUS_SUCCEEDED(contentViewGetItemAt(pKinesisVideoStream->pView, index, &pCurItem)) &&
+           pCurItem->timestamp <= timestamp) {
+        if (pCurItem->timestamp == timestamp && CHECK_ITEM_FRAGMENT_START(pCurItem->flags)) {
+            *ppViewItem = pCurItem;
+            break;
         }
 
-        CHK_STATUS(stackQueueIteratorNext(&iterator));
+        index++;
     }
 
 CleanUp:
-    return pUploadHandleInfo;
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Gets the upload handle info corresponding to the specified handle and NULL otherwise
+ */
+PUploadHandleInfo getStreamUploadInfo(PKinesisVideoStream pKinesisVideoStream, UPLOAD_HANDLE uploadHandle) {
+    UINT64 data;
+
+    if (STATUS_FAILED(hashTableGet(pKinesisVideoStream->pUploadInfoTable, uploadHandle, &data))) {
+        return NULL;
+    }
+
+    return (PUploadHandleInfo) data;
 }
 
 /**
  * Gets the first upload handle info corresponding to the index and NULL otherwise
  */
 PUploadHandleInfo getStreamUploadInfoWithEndIndex(PKinesisVideoStream pKinesisVideoStream, UINT64 index) {
-    STATUS retStatus = STATUS_SUCCESS;
-    StackQueueIterator iterator;
-    PUploadHandleInfo pUploadHandleInfo = NULL, pCurHandleInfo;
     UINT64 data;
 
-    // Iterate linearly and find the first ready state handle
-    CHK_STATUS(stackQueueGetIterator(pKinesisVideoStream->pUploadInfoQueue, &iterator));
-    while (IS_VALID_ITERATOR(iterator)) {
-        CHK_STATUS(stackQueueIteratorGetItem(iterator, &data));
+    if (STATUS_FAILED(hashTableGet(pKinesisVideoStream->pUploadInfoEndIndexTable, index, &data))) {
+        return NULL;
+    }
 
-        pCurHandleInfo = (PUploadHandleInfo) data;
-        CHK(pCurHandleInfo != NULL, STATUS_INTERNAL_ERROR);
-        if (pCurHandleInfo->endIndex == index) {
-            pUploadHandleInfo = pCurHandleInfo;
+    return (PUploadHandleInfo) data;
+}
 
-            // Found the item - early exit
-            CHK(FALSE, retStatus);
-        }
+/**
+ * Gets the first upload handle corresponding to the specified state
+ */
+PUploadHandleInfo getStreamUploadInfoWithState(PKinesisVideoStream pKinesisVideoStream, UINT32 handleState) {
+    PUploadHandleInfo pUploadHandleInfo = NULL, pCurHandleInfo;
+    UINT32 i;
 
-        CHK_STATUS(stackQueueIteratorNext(&iterator));
+    // The oldest handle of each of the requested states is at the head of the state list
+    for (i = 0; i < UPLOAD_HANDLE_STATE_COUNT; i++) {
+        pCurHandleInfo = pKinesisVideoStream->uploadInfoStateHeads[i];
+        if ((handleState & (1 << i)) != UPLOAD_HANDLE_STATE_NONE && pCurHandleInfo != NULL &&
+                (pUploadHandleInfo == NULL || pCurHandleInfo->sequence < pUploadHandleInfo->sequence)) {
+            pUploadHandleInfo = pCurHandleInfo;
+        }
     }
 
-CleanUp:
     return pUploadHandleInfo;
 }
 
 /**
- * Gets the first upload handle corresponding to the specified state
+ * Peeks the current stream upload info which is not in a terminated state
  */
-PUploadHandleInfo getStreamUploadInfoWithState(PKinesisVideoStream pKinesisVideoStream, UINT32 handleState) {
+PUploadHandleInfo getCurrentStreamUploadInfo(PKinesisVideoStream pKinesisVideoStream) {
+    return getStreamUploadInfoWithState(pKinesisVideoStream, UPLOAD_HANDLE_STATE_NEW |
+            UPLOAD_HANDLE_STATE_READY |
+            UPLOAD_HANDLE_STATE_STREAMING |
+            UPLOAD_HANDLE_STATE_TERMINATING);
+}
+
+/**
+ * Returns the index of the state list for the upload handle state
+ */
+UINT32 getUploadInfoStateIndex(UPLOAD_HANDLE_STATE state) {
+    UINT32 index = 0;
+
+    while ((UINT32) state > 1) {
+        state = (UPLOAD_HANDLE_STATE) ((UINT32) state >> 1);
+        index++;
+    }
+
+    return index;
+}
+
+/**
+ * Links the upload handle info into the list of its state keeping the sequence order.
+ * The handles are mostly moved through the states in order so the info is normally appended.
+ */
+VOID linkUploadInfoState(PKinesisVideoStream pKinesisVideoStream, PUploadHandleInfo pUploadHandleInfo) {
+    UINT32 index = getUploadInfoStateIndex(pUploadHandleInfo->state);
+    PUploadHandleInfo pPrev = pKinesisVideoStream->uploadInfoStateTails[index];
+
+    while (pPrev != NULL && pPrev->sequence > pUploadHandleInfo->sequence) {
+        pPrev = pPrev->pPrevInState;
+    }
+
+    pUploadHandleInfo->pPrevInState = pPrev;
+    pUploadHandleInfo->pNextInState = (pPrev == NULL) ? pKinesisVideoStream->uploadInfoStateHeads[index] : pPrev->pNextInState;
+
+    if (pUploadHandleInfo->pPrevInState == NULL) {
+        pKinesisVideoStream->uploadInfoStateHeads[index] = pUploadHandleInfo;
+    } else {
+        pUploadHandleInfo->pPrevInState->pNextInState = pUploadHandleInfo;
+    }
+
+    if (pUploadHandleInfo->pNextInState == NULL) {
+        pKinesisVideoStream->uploadInfoStateTails[index] = pUploadHandleInfo;
+    } else {
+        pUploadHandleInfo->pNextInState->pPrevInState = pUploadHandleInfo;
+    }
+}
+
+/**
+ * Unlinks the upload handle info from the list of its state
+ */
+VOID unlinkUploadInfoState(PKinesisVideoStream pKinesisVideoStream, PUploadHandleInfo pUploadHandleInfo) {
+    UINT32 index = getUploadInfoStateIndex(pUploadHandleInfo->state);
+
+    if (pUploadHandleInfo->pPrevInState == NULL) {
+        pKinesisVideoStream->uploadInfoStateHeads[index] = pUploadHandleInfo->pNextInState;
+    } else {
+        pUploadHandleInfo->pPrevInState->pNextInState = pUploadHandleInfo->pNextInState;
+    }
+
+    if (pUploadHandleInfo->pNextInState == NULL) {
+        pKinesisVideoStream->uploadInfoStateTails[index] = pUploadHandleInfo->pPrevInState;
+    } else {
+        pUploadHandleInfo->pNextInState->pPrevInState = pUploadHandleInfo->pPrevInState;
+    }
+
+    pUploadHandleInfo->pPrevInState = NULL;
+    pUploadHandleInfo->pNextInState = NULL;
+}
+
+/**
+ * Removes the upload handle info from the end index. Another handle with the same end index takes its place.
+ */
+VOID unindexUploadInfoEndIndex(PKinesisVideoStream pKinesisVideoStream, PUploadHandleInfo pUploadHandleInfo) {
     STATUS retStatus = STATUS_SUCCESS;
     StackQueueIterator iterator;
-    PUploadHandleInfo pUploadHandleInfo = NULL, pCurHandleInfo;
+    PUploadHandleInfo pCurHandleInfo, pReplacement = NULL;
     UINT64 data;
 
-    // Iterate linearly and find the first ready state handle
+    // Nothing to do if the info is not the indexed one
+    CHK(pUploadHandleInfo->endIndex != INVALID_VIEW_INDEX_VALUE &&
+            getStreamUploadInfoWithEndIndex(pKinesisVideoStream, pUploadHandleInfo->endIndex) == pUploadHandleInfo, retStatus);
+
+    // Handles rarely share the end index so the replacement is looked up linearly
     CHK_STATUS(stackQueueGetIterator(pKinesisVideoStream->pUploadInfoQueue, &iterator));
-    while (IS_VALID_ITERATOR(iterator)) {
+    while (IS_VALID_ITERATOR(iterator) && pReplacement == NULL) {
         CHK_STATUS(stackQueueIteratorGetItem(iterator, &data));
 
         pCurHandleInfo = (PUploadHandleInfo) data;
-        CHK(pCurHandleInfo != NULL, STATUS_INTERNAL_ERROR);
-        if ((handleState & pCurHandleInfo->state) != UPLOAD_HANDLE_STATE_NONE) {
-            pUploadHandleInfo = pCurHandleInfo;
-
-            // Found the item - early exit
-            CHK(FALSE, retStatus);
+        if (pCurHandleInfo != pUploadHandleInfo && pCurHandleInfo->endIndex == pUploadHandleInfo->endIndex) {
+            pReplacement = pCurHandleInfo;
         }
 
         CHK_STATUS(stackQueueIteratorNext(&iterator));
     }
 
+    if (pReplacement != NULL) {
+        CHK_STATUS(hashTableUpsert(pKinesisVideoStream->pUploadInfoEndIndexTable, pReplacement->endIndex, (UINT64) pReplacement));
+    } else {
+        CHK_STATUS(hashTableRemove(pKinesisVideoStream->pUploadInfoEndIndexTable, pUploadHandleInfo->endIndex));
+    }
+
 CleanUp:
-    return pUploadHandleInfo;
+
+    if (STATUS_FAILED(retStatus)) {
+        DLOGW("Failed to update the upload handle end index with 0x%08x", retStatus);
+    }
 }
 
 /**
- * Peeks the current stream upload info which is not in a terminated state
+ * Adds the new upload handle info to the stream and indexes it
  */
-PUploadHandleInfo getCurrentStreamUploadInfo(PKinesisVideoStream pKinesisVideoStream) {
-    return getStreamUploadInfoWithState(pKinesisVideoStream, UPLOAD_HANDLE_STATE_NEW |
-            UPLOAD_HANDLE_STATE_READY |
-            UPLOAD_HANDLE_STATE_STREAMING |
-            UPLOAD_HANDLE_STATE_TERMINATING);
+STATUS addStreamUploadInfo(PKinesisVideoStream pKinesisVideoStream, PUploadHandleInfo pUploadHandleInfo) {
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK(pKinesisVideoStream != NULL && pUploadHandleInfo != NULL, STATUS_NULL_ARG);
+
+    // The end index is set when the session ends
+    CHK(pUploadHandleInfo->state != UPLOAD_HANDLE_STATE_NONE &&
+            pUploadHandleInfo->endIndex == INVALID_VIEW_INDEX_VALUE, STATUS_INVALID_ARG);
+
+    CHK_STATUS(hashTablePut(pKinesisVideoStream->pUploadInfoTable, pUploadHandleInfo->handle, (UINT64) pUploadHandleInfo));
+
+    retStatus = stackQueueEnqueue(pKinesisVideoStream->pUploadInfoQueue, (UINT64) pUploadHandleInfo);
+    if (STATUS_FAILED(retStatus)) {
+        hashTableRemove(pKinesisVideoStream->pUploadInfoTable, pUploadHandleInfo->handle);
+        CHK(FALSE, retStatus);
+    }
+
+    pUploadHandleInfo->sequence = pKinesisVideoStream->uploadInfoSequence++;
+    linkUploadInfoState(pKinesisVideoStream, pUploadHandleInfo);
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * Moves the upload handle info to the new state keeping the state index up to date
+ */
+VOID setStreamUploadInfoState(PKinesisVideoStream pKinesisVideoStream, PUploadHandleInfo pUploadHandleInfo, UPLOAD_HANDLE_STATE state) {
+    if (pUploadHandleInfo->state != state) {
+        unlinkUploadInfoState(pKinesisVideoStream, pUploadHandleInfo);
+        pUploadHandleInfo->state = state;
+        linkUploadInfoState(pKinesisVideoStream, pUploadHandleInfo);
+    }
+}
+
+/**
+ * Sets the end index of the upload handle info keeping the end index up to date
+ */
+STATUS setStreamUploadInfoEndIndex(PKinesisVideoStream pKinesisVideoStream, PUploadHandleInfo pUploadHandleInfo, UINT64 endIndex) {
+    STATUS retStatus = STATUS_SUCCESS;
+    PUploadHandleInfo pIndexedHandleInfo;
+
+    CHK(pKinesisVideoStream != NULL && pUploadHandleInfo != NULL, STATUS_NULL_ARG);
+    CHK(pUploadHandleInfo->endIndex != endIndex, retStatus);
+
+    unindexUploadInfoEndIndex(pKinesisVideoStream, pUploadHandleInfo);
+    pUploadHandleInfo->endIndex = endIndex;
+
+    // The oldest of the handles sharing the end index is indexed
+    CHK(endIndex != INVALID_VIEW_INDEX_VALUE, retStatus);
+    pIndexedHandleInfo = getStreamUploadInfoWithEndIndex(pKinesisVideoStream, endIndex);
+    if (pIndexedHandleInfo == NULL || pIndexedHandleInfo->sequence > pUploadHandleInfo->sequence) {
+        CHK_STATUS(hashTableUpsert(pKinesisVideoStream->pUploadInfoEndIndexTable, endIndex, (UINT64) pUploadHandleInfo));
+    }
+
+CleanUp:
+
+    return retStatus;
 }
 
 /**
@@ -1405,6 +2579,9 @@ PUploadHandleInfo getCurrentStreamUploadInfo(PKinesisVideoStream pKinesisVideoSt
  */
 VOID deleteStreamUploadInfo(PKinesisVideoStream pKinesisVideoStream, PUploadHandleInfo pUploadHandleInfo) {
     if (NULL != pUploadHandleInfo) {
+        unindexUploadInfoEndIndex(pKinesisVideoStream, pUploadHandleInfo);
+        unlinkUploadInfoState(pKinesisVideoStream, pUploadHandleInfo);
+        hashTableRemove(pKinesisVideoStream->pUploadInfoTable, pUploadHandleInfo->handle);
         stackQueueRemoveItem(pKinesisVideoStream->pUploadInfoQueue, (UINT64) pUploadHandleInfo);
         MEMFREE(pUploadHandleInfo);
     }
@@ -1484,6 +2661,20 @@ STATUS createPackager(PStreamInfo pStreamInfo, GetCurrentTimeFunc getCurrentTime
     // NOTE: The flag values are the same as defined in the mkvgen
     mkvGenFlags |= pStreamInfo->streamCaps.nalAdaptationFlags;
 
+    // Create the multi-track packager if the tracks are specified
+    if (GET_TRACK_INFO_COUNT(pStreamInfo) != 0) {
+        CHK_STATUS(createMkvGeneratorWithTracks(pStreamInfo->streamCaps.contentType,
+                                                mkvGenFlags,
+                                                pStreamInfo->streamCaps.timecodeScale,
+                                                pStreamInfo->streamCaps.fragmentDuration,
+                                                pStreamInfo->streamCaps.trackInfoList,
+                                                pStreamInfo->streamCaps.trackInfoCount,
+                                                getCurrentTimeFn,
+                                                customData,
+                                                ppGenerator));
+        CHK(FALSE, retStatus);
+    }
+
     // Create the packager
     CHK_STATUS(createMkvGenerator(pStreamInfo->streamCaps.contentType,
                                   mkvGenFlags,
@@ -1514,7 +2705,7 @@ STATUS streamFragmentBufferingAck(PKinesisVideoStream pKinesisVideoStream, UINT6
     // for the staleness detection and latency calculations.
 
     // Get the fragment start frame.
-    CHK_STATUS(contentViewGetItemWithTimestamp(pKinesisVideoStream->pView, timestamp, &pCurItem));
+    CHK_STATUS(getFragmentViewItemWithTimestamp(pKinesisVideoStream, timestamp, &pCurItem));
 
     // Set the buffering ACK
     SET_ITEM_BUFFERING_ACK(pCurItem->flags);
@@ -1536,7 +2727,7 @@ STATUS streamFragmentReceivedAck(PKinesisVideoStream pKinesisVideoStream, UINT64
     // for the staleness detection and latency calculations.
 
     // Get the fragment start frame.
-    CHK_STATUS(contentViewGetItemWithTimestamp(pKinesisVideoStream->pView, timestamp, &pCurItem));
+    CHK_STATUS(getFragmentViewItemWithTimestamp(pKinesisVideoStream, timestamp, &pCurItem));
 
     // Set the received ACK
     SET_ITEM_RECEIVED_ACK(pCurItem->flags);
@@ -1561,7 +2752,7 @@ STATUS streamFragmentPersistedAck(PKinesisVideoStream pKinesisVideoStream, UINT6
     // As we move the tail, the callbacks will be fired to process the items falling out of the window.
 
     // Get the fragment start frame.
-    CHK_STATUS(contentViewGetItemWithTimestamp(pKinesisVideoStream->pView, timestamp, &pCurItem));
+    CHK_STATUS(getFragmentViewItemWithTimestamp(pKinesisVideoStream, timestamp, &pCurItem));
 
     // Remember the current index
     CHK_STATUS(contentViewGetCurrentIndex(pKinesisVideoStream->pView, &curItemIndex));
@@ -1607,7 +2798,7 @@ STATUS streamFragmentErrorAck(PKinesisVideoStream pKinesisVideoStream, UINT64 ti
 
     // The state and the params are validated.
     // Set the latest to the timestamp of the failed fragment for re-transmission
-    CHK_STATUS(contentViewGetItemWithTimestamp(pKinesisVideoStream->pView, timestamp, &pCurItem));
+    CHK_STATUS(getFragmentViewItemWithTimestamp(pKinesisVideoStream, timestamp, &pCurItem));
     CHK_STATUS(contentViewSetCurrentIndex(pKinesisVideoStream->pView, pCurItem->index));
 
     // Trigger the stream termination
@@ -1698,12 +2889,15 @@ STATUS checkStreamingTokenExpiration(PKinesisVideoStream pKinesisVideoStream) {
     currentTime = pKinesisVideoStream->pKinesisVideoClient->clientCallbacks.getCurrentTimeFn(
             pKinesisVideoStream->pKinesisVideoClient->clientCallbacks.customData);
 
+    // Start the rotation ahead of the grace period to have the standby connection ready in time
     CHK(currentTime >= pKinesisVideoStream->streamingAuthInfo.expiration ||
-        pKinesisVideoStream->streamingAuthInfo.expiration - currentTime <= STREAMING_TOKEN_EXPIRATION_GRACE_PERIOD,
+        pKinesisVideoStream->streamingAuthInfo.expiration - currentTime <=
+                STREAMING_TOKEN_EXPIRATION_GRACE_PERIOD + pKinesisVideoStream->streamInfo.streamCaps.standbyConnectionPeriod,
         retStatus);
 
     // We are in a grace period - need to initiate the streaming token rotation.
     // We will have to transact to the get streaming endpoint state.
+    // The current upload handle is not terminated and keeps streaming until the standby one is ready.
 
     // Set the streaming mode to stopped to trigger the transitions.
     // Set the result that will move the state machinery to the get endpoint state
@@ -103,6 +103,113 @@ struct __CurrentViewItem {
 };
 typedef __CurrentViewItem* PCurrentViewItem;
 
+/**
+ * View item storage pinned by a stream data span
+ */
+typedef struct __PinnedViewItem PinnedViewItem;
+struct __PinnedViewItem {
+    // Pinned allocation handle or invalid if nothing is pinned
+    ALLOCATION_HANDLE handle;
+
+    // Storage flags of the pinned view item
+    UINT32 flags;
+
+    // Mapped storage of the allocation
+    PBYTE pAlloc;
+
+    // Whether the view item has been removed from the view while pinned
+    BOOL removed;
+
+    // Token the span is released with. Unique for the lifetime of the stream.
+    UINT64 token;
+
+    // Whether a read has been rejected while pinned so the readers need to be notified on the release
+    BOOL readerWaiting;
+};
+typedef __PinnedViewItem* PPinnedViewItem;
+
+/**
+ * Reference to the caller frame data. The view item storage of a referenced frame holds the
+ * packaged MKV elements at the data offset followed by the reference.
+ */
+typedef struct __FrameReference FrameReference;
+struct __FrameReference {
+    // The referenced frame data
+    PBYTE pFrameData;
+
+    // Size of the frame data
+    UINT32 size;
+
+    // The callback to release the frame data
+    FrameDataReleaseFunc releaseFn;
+
+    // Custom data passed to the release callback
+    UINT64 customData;
+};
+typedef __FrameReference* PFrameReference;
+
+/**
+ * Size of the storage backing the view item. The frame data of the frame reference items is not stored.
+ */
+#define VIEW_ITEM_STORAGE_SIZE(pViewItem)   (CHECK_ITEM_FRAME_REFERENCE((pViewItem)->flags) ? \
+                                             GET_ITEM_DATA_OFFSET((pViewItem)->flags) + SIZEOF(FrameReference) : \
+                                             (pViewItem)->length)
+
+/**
+ * Fragment storage region sizing. The region for the next fragment is sized based on the size of the
+ * previous fragment with some headroom. The unused tail is returned to the heap when the region is closed.
+ */
+#define MIN_FRAGMENT_STORAGE_REGION_SIZE                (16 * 1024)
+#define MAX_FRAGMENT_STORAGE_REGION_SIZE                (2 * 1024 * 1024)
+#define FRAGMENT_STORAGE_HEADROOM_DIVISOR               4
+
+/**
+ * Closed fragment storage region hash table initial slot count. There is a region per fragment in the buffer.
+ */
+#define FRAGMENT_STORAGE_HASH_SLOT_COUNT                (4 * MIN_HASH_BUCKET_COUNT)
+
+/**
+ * Storage shared by the frames of a fragment.
+ *
+ * The frames are appended into the open region which stays mapped while it's being filled. A frame which
+ * doesn't fit is stored in a continuation region. Each of the frames is still a separate view item
+ * referencing the region at an offset. The closed regions are reference counted by the number of the view
+ * items and are freed together with the last of them.
+ */
+typedef struct __FragmentStorage FragmentStorage;
+struct __FragmentStorage {
+    // Whether the fragment storage is enabled
+    BOOL enabled;
+
+    // Open region allocation handle or invalid if no region is open
+    ALLOCATION_HANDLE handle;
+
+    // View item storage flags of the open region
+    UINT32 flags;
+
+    // Mapped storage of the open region
+    PBYTE pAlloc;
+
+    // Size of the open region allocation
+    UINT32 size;
+
+    // Number of bytes used in the open region
+    UINT32 used;
+
+    // Number of the view items referencing the open region
+    UINT32 itemCount;
+
+    // Number of bytes stored so far for the current fragment including the continuation regions
+    UINT32 fragmentSize;
+
+    // Number of bytes stored for the previous fragment
+    UINT32 lastFragmentSize;
+
+    // View item counts of the closed regions indexed by the allocation handle
+    PHashTable pRegionTable;
+};
+typedef __FragmentStorage* PFragmentStorage;
+
 /**
  * Streaming type definition
  */
@@ -138,10 +245,26 @@ typedef enum {
 
 } UPLOAD_HANDLE_STATE;
 
+/**
+ * Number of the upload handle states excluding the sentinel
+ */
+#define UPLOAD_HANDLE_STATE_COUNT                       6
+
+/**
+ * Upload handle info hash table initial slot count. The number of handles is normally low but grows with the reconnects.
+ */
+#define UPLOAD_HANDLE_INFO_HASH_SLOT_COUNT              MIN_HASH_BUCKET_COUNT
+
+/**
+ * Upload handle info queue initial node pool size
+ */
+#define UPLOAD_HANDLE_INFO_QUEUE_NODE_COUNT             8
+
 /**
  * Upload handle information struct
  */
 typedef struct __UploadHandleInfo UploadHandleInfo;
+typedef __UploadHandleInfo* PUploadHandleInfo;
 struct __UploadHandleInfo {
     // The upload handle
     UPLOAD_HANDLE handle;
@@ -157,8 +280,14 @@ struct __UploadHandleInfo {
 
     // Handle state
     UPLOAD_HANDLE_STATE state;
+
+    // Order in which the handle has been added to the stream
+    UINT64 sequence;
+
+    // Neighbouring handles in the same state ordered by the sequence
+    PUploadHandleInfo pPrevInState;
+    PUploadHandleInfo pNextInState;
 };
-typedef __UploadHandleInfo* PUploadHandleInfo;
 
 /**
  * Kinesis Video stream internal structure
@@ -180,9 +309,28 @@ struct __KinesisVideoStream {
     // MKV stream generator
     PMkvGenerator pMkvGenerator;
 
+    // Per-stream storage arena protected by the stream lock. NULL if the arenas are not enabled.
+    PHeap pArena;
+
     // Upload handle queue
     PStackQueue pUploadInfoQueue;
 
+    // Frame references released from the storage which are returned to the application outside of the locks
+    PStackQueue pFrameReleaseQueue;
+
+    // Upload handle infos indexed by the upload handle
+    PHashTable pUploadInfoTable;
+
+    // The first upload handle infos indexed by the end index
+    PHashTable pUploadInfoEndIndexTable;
+
+    // Upload handle infos in each of the states ordered by the sequence. Indexed by the state bit.
+    PUploadHandleInfo uploadInfoStateHeads[UPLOAD_HANDLE_STATE_COUNT];
+    PUploadHandleInfo uploadInfoStateTails[UPLOAD_HANDLE_STATE_COUNT];
+
+    // Sequence for the next upload handle info
+    UINT64 uploadInfoSequence;
+
     // Stream Info structure
     StreamInfo streamInfo;
 
@@ -213,6 +361,15 @@ struct __KinesisVideoStream {
     // Current view item
     CurrentViewItem curViewItem;
 
+    // View item pinned by the outstanding stream data span
+    PinnedViewItem pinnedViewItem;
+
+    // The last issued stream data span release token
+    UINT64 spanTokenSequence;
+
+    // Storage shared by the frames of a fragment
+    FragmentStorage fragmentStorage;
+
     // Indicates whether the connection has been dropped
     BOOL connectionDropped;
 
@@ -225,7 +382,7 @@ struct __KinesisVideoStream {
     // Whether the stream is in a grace period for the token rotation.
     BOOL gracePeriod;
 
-    // Whether to reset the generator with the next key frame
+    // Whether to reset the generator with the next key frame to switch to the standby upload handle
     BOOL resetGeneratorOnKeyFrame;
 
     // Diagnostics information to be used with metrics
@@ -279,6 +436,33 @@ STATUS stopStream(PKinesisVideoStream);
  */
 STATUS putFrame(PKinesisVideoStream, PFrame);
 
+/**
+ * Puts a batch of frames into the stream. The stream lock, the state checks and the
+ * notifications are processed once for the entire batch.
+ *
+ * @param 1 PKinesisVideoStream - Kinesis Video stream object.
+ * @param 2 PFrame - The array of frames to process.
+ * @param 3 UINT32 - The number of frames in the array.
+ * @param 4 PFrameReference - OPTIONAL - The reference to the frame data of a single frame instead of copying it.
+ * @param 5 PUINT32 - OPTIONAL - Returns the number of frames stored.
+ *
+ * @return Status of the function call.
+ */
+STATUS putFrames(PKinesisVideoStream, PFrame, UINT32, PFrameReference, PUINT32);
+
+/**
+ * Packages the frame into the stream storage and adds it to the view.
+ *
+ * @param 1 PKinesisVideoStream - Kinesis Video stream object.
+ * @param 2 PFrame - The frame to store.
+ * @param 3 PFrameReference - OPTIONAL - The reference to the frame data to store instead of the data.
+ * @param 4 PUINT32 - OUT - The flags of the view item the frame is stored in.
+ * @param 5 PBOOL - IN/OUT - Whether the client lock is held.
+ *
+ * @return Status of the function call.
+ */
+STATUS storeFrame(PKinesisVideoStream, PFrame, PFrameReference, PUINT32, PBOOL);
+
 /**
  * Puts the frame into the stream. The stream will be started if it hasn't been yet.
  *
@@ -330,6 +514,28 @@ VOID freeCodecPrivateData(PKinesisVideoStream pKinesisVideoStream);
  */
 STATUS getNextBoundaryViewItem(PKinesisVideoStream, PViewItem*);
 
+/**
+ * Clips the duration of the view head item so the item with the given timestamp can follow it.
+ * Used for the interleaved frames of the multi-track streams.
+ *
+ * @param 1 PKinesisVideoStream - Kinesis Video stream object.
+ * @param 2 UINT64 - Timestamp of the item to be added.
+ *
+ * @return Status of the function call.
+ */
+STATUS clipViewHeadDuration(PKinesisVideoStream, UINT64);
+
+/**
+ * Gets the view item of the fragment the ACK timestamp refers to.
+ *
+ * @param 1 PKinesisVideoStream - Kinesis Video stream object.
+ * @param 2 UINT64 - ACK timestamp.
+ * @param 3 PViewItem* - OUT - The fragment view item.
+ *
+ * @return Status of the function call.
+ */
+STATUS getFragmentViewItemWithTimestamp(PKinesisVideoStream, UINT64, PViewItem*);
+
 /**
  * Generates the packager
  */
@@ -342,7 +548,8 @@ STATUS checkForConnectionStaleness(PKinesisVideoStream, PViewItem);
 
 /**
  * Checks for the streaming token expiration. If the stream token is present and is in the grace period
- * then we will move the state machinery to the get endpoint state.
+ * or within the standby connection period ahead of it then we will move the state machinery to the get
+ * endpoint state while the current upload handle keeps streaming.
  */
 STATUS checkStreamingTokenExpiration(PKinesisVideoStream);
 
@@ -361,6 +568,109 @@ STATUS resetCurrentViewItemStreamStart(PKinesisVideoStream);
  */
 STATUS freeUploadInfoQueue(PKinesisVideoStream);
 
+/**
+ * Allocates the storage from the stream arena if enabled falling back to the shared client heap.
+ *
+ * NOTE: The stream lock should be held. The client lock is acquired only when the shared heap is used.
+ *
+ * @param 1 PKinesisVideoStream - Kinesis Video stream object.
+ * @param 2 UINT32 - Size of the allocation.
+ * @param 3 PALLOCATION_HANDLE - OUT - The allocation handle. Invalid handle if out of storage.
+ * @param 4 PUINT32 - OUT - The view item storage flags of the allocation.
+ * @param 5 PBOOL - IN/OUT - Whether the client lock is held. Set to TRUE if the client lock has been acquired.
+ *
+ * @return Status of the function call.
+ */
+STATUS streamStorageAlloc(PKinesisVideoStream, UINT32, PALLOCATION_HANDLE, PUINT32, PBOOL);
+
+/**
+ * Returns the heap storing the allocation based on the view item storage flags.
+ */
+PHeap getStreamStorageHeap(PKinesisVideoStream, UINT32);
+
+/**
+ * Acquires the client lock if not held already and the allocation with the
+ * given view item storage flags is stored in the shared client heap.
+ */
+VOID lockStreamStorage(PKinesisVideoStream, UINT32, PBOOL);
+
+/**
+ * Frees the stream storage allocation with the given view item storage flags.
+ * The free is deferred until the span is released if the allocation is pinned.
+ */
+VOID freeStreamStorage(PKinesisVideoStream, ALLOCATION_HANDLE, UINT32, PBOOL);
+
+/**
+ * Queues the frame data referenced by the view item storage to be released by releasePendingFrameReferences.
+ *
+ * NOTE: The stream lock and the client lock for the shared client heap storage should be held.
+ */
+VOID releaseFrameReference(PKinesisVideoStream, ALLOCATION_HANDLE, UINT32);
+
+/**
+ * Fires the release callbacks of the queued frame references.
+ *
+ * NOTE: Should be called without holding the stream or the client lock.
+ */
+VOID releasePendingFrameReferences(PKinesisVideoStream);
+
+/**
+ * Unmaps the stream storage with the given view item storage flags.
+ * The client lock is acquired only when the storage is in the shared client heap.
+ */
+STATUS unmapStreamStorage(PKinesisVideoStream, UINT32, PVOID, PBOOL);
+
+/**
+ * Ensures the open fragment storage region can fit the packaged frame. Closes the open region
+ * on a new fragment or when it's full and opens a new region sized for the rest of the fragment.
+ *
+ * NOTE: The stream lock should be held.
+ *
+ * @param 1 PKinesisVideoStream - Kinesis Video stream object.
+ * @param 2 UINT32 - Size of the packaged frame.
+ * @param 3 BOOL - Whether the frame might start a new fragment.
+ * @param 4 PBOOL - IN/OUT - Whether the client lock is held. Set to TRUE if the client lock has been acquired.
+ *
+ * @return Status of the function call. The region handle is invalid if out of storage.
+ */
+STATUS reserveFragmentStorage(PKinesisVideoStream, UINT32, BOOL, PBOOL);
+
+/**
+ * Closes the open fragment storage region returning the unused tail to the heap.
+ * The region is freed if no view items reference it.
+ *
+ * NOTE: The stream lock should be held.
+ */
+STATUS closeFragmentStorage(PKinesisVideoStream, PBOOL);
+
+/**
+ * Releases the reference of a view item to the fragment storage region.
+ *
+ * @return Whether the last reference to a closed region has been released and the region should be freed.
+ */
+BOOL releaseFragmentStorage(PKinesisVideoStream, ALLOCATION_HANDLE);
+
+/**
+ * Unmaps the view item pinned by the outstanding stream data span and frees
+ * the storage if the item has been removed from the view in the meantime.
+ */
+STATUS unpinViewItem(PKinesisVideoStream);
+
+/**
+ * Whether the view item references the frame data and its storage is pinned by the outstanding span.
+ */
+BOOL isPinnedFrameReference(PKinesisVideoStream, PViewItem);
+
+/**
+ * Copies the packaged data of the view item referencing the frame data with the referenced frame data in place of the reference.
+ */
+VOID copyReferencedViewItemData(PViewItem, PBYTE, UINT32, PBYTE, UINT32);
+
+/**
+ * Notifies the ready and the streaming upload handles of the stream data available to them.
+ */
+STATUS notifyStreamDataAvailable(PKinesisVideoStream);
+
 /**
  * Gets the current stream upload handle info if existing or NULL otherwise.
  *
@@ -368,11 +678,34 @@ STATUS freeUploadInfoQueue(PKinesisVideoStream);
  */
 PUploadHandleInfo getCurrentStreamUploadInfo(PKinesisVideoStream);
 
+/**
+ * Adds the new upload handle info to the stream and indexes it
+ */
+STATUS addStreamUploadInfo(PKinesisVideoStream, PUploadHandleInfo);
+
 /**
  * Deletes and frees the specified stream upload info object
  */
 VOID deleteStreamUploadInfo(PKinesisVideoStream, PUploadHandleInfo);
 
+/**
+ * Moves the upload handle info to the new state keeping the state index up to date
+ */
+VOID setStreamUploadInfoState(PKinesisVideoStream, PUploadHandleInfo, UPLOAD_HANDLE_STATE);
+
+/**
+ * Sets the end index of the upload handle info keeping the end index up to date
+ */
+STATUS setStreamUploadInfoEndIndex(PKinesisVideoStream, PUploadHandleInfo, UINT64);
+
+/**
+ * Upload handle info index helpers. The state lists are indexed by the state bit.
+ */
+UINT32 getUploadInfoStateIndex(UPLOAD_HANDLE_STATE);
+VOID linkUploadInfoState(PKinesisVideoStream, PUploadHandleInfo);
+VOID unlinkUploadInfoState(PKinesisVideoStream, PUploadHandleInfo);
+VOID unindexUploadInfoEndIndex(PKinesisVideoStream, PUploadHandleInfo);
+
 /**
  * Gets the first upload handle info corresponding to the state and NULL otherwise
  */
@@ -414,6 +747,10 @@ STATUS streamFragmentErrorAck(PKinesisVideoStream, UINT64, SERVICE_CALL_RESULT);
 // Streaming event functions
 ///////////////////////////////////////////////////////////////////////////
 STATUS getStreamData(PKinesisVideoStream, PUINT64, PBYTE, UINT32, PUINT32);
+STATUS getStreamDataSpan(PKinesisVideoStream, PUINT64, UINT32, PStreamDataSpan);
+STATUS getStreamDataWithSpan(PKinesisVideoStream, PUINT64, PBYTE, UINT32, PUINT32, PStreamDataSpan);
+STATUS releaseStreamDataSpan(PKinesisVideoStream, UINT64);
+STATUS readStreamData(PKinesisVideoStream, PUINT64, PBYTE, UINT32, PUINT32, PStreamDataSpan);
 
 ///////////////////////////////////////////////////////////////////////////
 // State machine callback functionality
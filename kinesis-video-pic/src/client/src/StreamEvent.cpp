@@ -430,8 +430,11 @@ STATUS putStreamResult(PKinesisVideoStream pKinesisVideoStream, SERVICE_CALL_RES
     pUploadHandleInfo->timestamp = INVALID_TIMESTAMP_VALUE;
     pUploadHandleInfo->state = UPLOAD_HANDLE_STATE_NEW;
 
-    // Ensueue the stream upload info object
-    CHK_STATUS(stackQueueEnqueue(pKinesisVideoStream->pUploadInfoQueue, (UINT64) pUploadHandleInfo));
+    // Ensueue and index the stream upload info object
+    CHK_STATUS(addStreamUploadInfo(pKinesisVideoStream, pUploadHandleInfo));
+
+    // The stream owns the info from now on
+    pUploadHandleInfo = NULL;
 
     // Step the machine
     CHK_STATUS(stepStateMachine(pKinesisVideoStream->base.pStateMachine));
@@ -536,6 +539,7 @@ STATUS streamTerminatedEvent(PKinesisVideoStream pKinesisVideoStream, UPLOAD_HAN
                         != UPLOAD_HANDLE_STATE_NONE) {
                 // Remove the handle info from the queue
                 deleteStreamUploadInfo(pKinesisVideoStream, pUploadHandleInfo);
+                pUploadHandleInfo = NULL;
 
                 // Set the indicator of the retrying handle
                 pKinesisVideoStream->retryingOnRotation = TRUE;
@@ -550,11 +554,15 @@ STATUS streamTerminatedEvent(PKinesisVideoStream pKinesisVideoStream, UPLOAD_HAN
 
         if (NULL != pUploadHandleInfo) {
             // Set the state to terminating
-            pUploadHandleInfo->state = UPLOAD_HANDLE_STATE_TERMINATING;
+            setStreamUploadInfoState(pKinesisVideoStream, pUploadHandleInfo, UPLOAD_HANDLE_STATE_TERMINATING);
 
             // Set the ending index for cleanup
-            pUploadHandleInfo->endIndex = curItemIndex;
+            CHK_STATUS(setStreamUploadInfoEndIndex(pKinesisVideoStream, pUploadHandleInfo, curItemIndex));
         }
+
+        // Cancel the pending switch to the standby handle. The reconnect will either fix up the stream start
+        // or the next standby handle will request the switch again.
+        pKinesisVideoStream->resetGeneratorOnKeyFrame = FALSE;
     }
 
     // Stop the stream
@@ -601,14 +609,15 @@ STATUS streamFragmentAckEvent(PKinesisVideoStream pKinesisVideoStream, UPLOAD_HA
     // Check the version
     CHK(pFragmentAck->version <= FRAGMENT_ACK_CURRENT_VERSION, STATUS_INVALID_FRAGMENT_ACK_VERSION);
 
+    // The client is needed in the cleanup to notify the ACK
+    pKinesisVideoClient = pKinesisVideoStream->pKinesisVideoClient;
+
     // Early return if we have an IDLE ack
     if (pFragmentAck->ackType == FRAGMENT_ACK_TYPE_IDLE) {
         // Nothing to do if we have an IDLE ack
         CHK(FALSE, retStatus);
     }
 
-    pKinesisVideoClient = pKinesisVideoStream->pKinesisVideoClient;
-
     // Lock the state
     pKinesisVideoClient->clientCallbacks.lockMutexFn(pKinesisVideoClient->clientCallbacks.customData, pKinesisVideoStream->base.lock);
     locked = TRUE;
@@ -696,7 +705,7 @@ STATUS streamFragmentAckEvent(PKinesisVideoStream pKinesisVideoStream, UPLOAD_HA
 CleanUp:
 
     // We will notify the fragment ACK received callback even if the processing failed
-    if (pKinesisVideoClient->clientCallbacks.fragmentAckReceivedFn != NULL) {
+    if (pKinesisVideoClient != NULL && pKinesisVideoClient->clientCallbacks.fragmentAckReceivedFn != NULL) {
         pKinesisVideoClient->clientCallbacks.fragmentAckReceivedFn(pKinesisVideoClient->clientCallbacks.customData,
                                                                    TO_STREAM_HANDLE(pKinesisVideoStream),
                                                                    pFragmentAck);
@@ -257,7 +257,7 @@ STATUS fromPutStreamState(UINT64 customData, PUINT64 pState) {
     STATUS retStatus = STATUS_SUCCESS;
     PKinesisVideoStream pKinesisVideoStream = STREAM_FROM_CUSTOM_DATA(customData);
     UINT64 state = STREAM_STATE_PUT_STREAM;
-    PUploadHandleInfo pUploadHandleInfo;
+    PUploadHandleInfo pUploadHandleInfo, pActiveHandleInfo;
 
     CHK(pKinesisVideoStream != NULL && pState != NULL, STATUS_NULL_ARG);
 
@@ -265,10 +265,20 @@ STATUS fromPutStreamState(UINT64 customData, PUINT64 pState) {
     if (pKinesisVideoStream->streamState == STREAM_STATE_STOPPED) {
         state = STREAM_STATE_STOPPED;
     } else if (pKinesisVideoStream->base.result == SERVICE_CALL_RESULT_OK) {
+        // Check whether we still have an active upload handle before putting the new one into rotation
+        pActiveHandleInfo = getStreamUploadInfoWithState(pKinesisVideoStream, UPLOAD_HANDLE_STATE_READY |
+                UPLOAD_HANDLE_STATE_STREAMING);
+
         // find the handle in the new state and set it to ready
         pUploadHandleInfo = getStreamUploadInfoWithState(pKinesisVideoStream, UPLOAD_HANDLE_STATE_NEW);
         if (NULL != pUploadHandleInfo) {
-            pUploadHandleInfo->state = UPLOAD_HANDLE_STATE_READY;
+            setStreamUploadInfoState(pKinesisVideoStream, pUploadHandleInfo, UPLOAD_HANDLE_STATE_READY);
+
+            // The new handle is a standby for the token rotation. The active handle will be ended and
+            // the standby will take over on the next key frame which will start a new stream.
+            if (NULL != pActiveHandleInfo) {
+                pKinesisVideoStream->resetGeneratorOnKeyFrame = TRUE;
+            }
         }
 
         state = STREAM_STATE_STREAMING;
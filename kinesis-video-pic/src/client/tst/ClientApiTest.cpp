@@ -178,6 +178,27 @@ TEST_F(ClientApiTest, createKinesisVideoClient_ValiateDeviceInfo)
     EXPECT_TRUE(STATUS_FAILED(createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &clientHandle)));
     mDeviceInfo.storageInfo.spillRatio = 0;
 
+    // No room for the shared overflow pool
+    mDeviceInfo.storageInfo.streamArenaRatio = 100;
+    EXPECT_EQ(STATUS_INVALID_STREAM_ARENA_RATIO, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &clientHandle));
+
+    // The arenas would be smaller than the min heap size
+    mDeviceInfo.storageInfo.streamArenaRatio = 50;
+    EXPECT_EQ(STATUS_INVALID_STORAGE_SIZE, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &clientHandle));
+
+    // The overflow pool would be smaller than the min heap size
+    mDeviceInfo.storageInfo.storageSize = (MAX_TEST_STREAM_COUNT + 1) * MIN_STREAM_ARENA_SIZE;
+    mDeviceInfo.storageInfo.streamArenaRatio = 99;
+    EXPECT_EQ(STATUS_INVALID_STORAGE_SIZE, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &clientHandle));
+    mDeviceInfo.storageInfo.storageSize = TEST_DEVICE_STORAGE_SIZE;
+
+    // The ratio is ignored by the older versions of the struct
+    mDeviceInfo.storageInfo.version = 0;
+    EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &clientHandle));
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoClient(&clientHandle));
+    mDeviceInfo.storageInfo.version = STORAGE_INFO_CURRENT_VERSION;
+    mDeviceInfo.storageInfo.streamArenaRatio = 0;
+
     MEMSET(mDeviceInfo.storageInfo.rootDirectory, 'a', MAX_PATH_LEN * SIZEOF(CHAR));
     EXPECT_TRUE(STATUS_FAILED(createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &clientHandle)));
     mDeviceInfo.storageInfo.rootDirectory[0] = '\0';
@@ -193,6 +214,25 @@ TEST_F(ClientApiTest, createKinesisVideoClient_ValiateDeviceInfo)
     EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoClient(&clientHandle));
 }
 
+TEST_F(ClientApiTest, createKinesisVideoClient_HybridFileStorage)
+{
+    CLIENT_HANDLE clientHandle = INVALID_CLIENT_HANDLE_VALUE;
+
+    mDeviceInfo.storageInfo.storageType = DEVICE_STORAGE_TYPE_HYBRID_FILE;
+    mDeviceInfo.storageInfo.storageSize = 2 * MIN_STORAGE_ALLOCATION_SIZE;
+    mDeviceInfo.storageInfo.spillRatio = 50;
+
+    // The file based storage requires a root directory
+    mDeviceInfo.storageInfo.rootDirectory[0] = '\0';
+    EXPECT_EQ(STATUS_INVALID_ARG, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &clientHandle));
+    EXPECT_FALSE(IS_VALID_CLIENT_HANDLE(clientHandle));
+
+    STRCPY(mDeviceInfo.storageInfo.rootDirectory, (PCHAR) "/tmp");
+    EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &clientHandle));
+    EXPECT_TRUE(IS_VALID_CLIENT_HANDLE(clientHandle));
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoClient(&clientHandle));
+}
+
 TEST_F(ClientApiTest, freeKinesisVideoClient_NullInput)
 {
     EXPECT_TRUE(STATUS_FAILED(freeKinesisVideoClient(NULL)));
@@ -256,6 +256,8 @@ public:
         mStreamInfo.streamCaps.timecodeScale = 0;
         mStreamInfo.streamCaps.codecPrivateData = NULL;
         mStreamInfo.streamCaps.codecPrivateDataSize = 0;
+        mStreamInfo.streamCaps.trackInfoCount = 0;
+        mStreamInfo.streamCaps.trackInfoList = NULL;
     }
 
     PVOID basicProducerRoutine(UINT64);
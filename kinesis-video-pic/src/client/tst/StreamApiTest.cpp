@@ -181,6 +181,19 @@ TEST_F(StreamApiTest, kinesisVideoPutFrame_NULL_Invalid)
     EXPECT_TRUE(STATUS_FAILED(putKinesisVideoFrame(mStreamHandle, NULL)));
 }
 
+TEST_F(StreamApiTest, kinesisVideoPutFrames_NULL_Invalid)
+{
+    STREAM_HANDLE streamHandle = INVALID_STREAM_HANDLE_VALUE;
+    Frame frames[2];
+
+    // Create a stream
+    CreateStream();
+
+    EXPECT_TRUE(STATUS_FAILED(putKinesisVideoFrames(streamHandle, frames, 2, NULL)));
+    EXPECT_TRUE(STATUS_FAILED(putKinesisVideoFrames(mStreamHandle, NULL, 2, NULL)));
+    EXPECT_EQ(STATUS_INVALID_ARG, putKinesisVideoFrames(mStreamHandle, frames, 0, NULL));
+}
+
 TEST_F(StreamApiTest, kinesisVideoGetData_NULL_Invalid)
 {
     STREAM_HANDLE streamHandle = INVALID_STREAM_HANDLE_VALUE;
@@ -0,0 +1,192 @@
+#include "ClientTestFixture.h"
+#include "src/heap/src/Include_i.h"
+
+#define TEST_ARENA_STORAGE_SIZE             (25 * MIN_STORAGE_ALLOCATION_SIZE)
+#define TEST_ARENA_RATIO                    60
+#define TEST_ARENA_ROOT_DIRECTORY           "/tmp"
+
+class StreamArenaTest : public ClientTestBase {
+protected:
+    virtual void SetUp()
+    {
+        mDeviceInfo.storageInfo.storageSize = TEST_ARENA_STORAGE_SIZE;
+        mDeviceInfo.storageInfo.streamArenaRatio = TEST_ARENA_RATIO;
+        ClientTestBase::SetUp();
+    };
+
+    VOID putFrames(UINT32 frameCount, UINT32 frameSize, PBYTE pData)
+    {
+        UINT32 i;
+        Frame frame;
+
+        for (i = 0; i < frameCount; i++) {
+            frame.index = i;
+            frame.decodingTs = frame.presentationTs = i * TEST_LONG_FRAME_DURATION;
+            frame.duration = TEST_LONG_FRAME_DURATION;
+            frame.size = frameSize;
+            frame.frameData = pData;
+            frame.flags = i % 3 == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+            EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, &frame));
+
+            // Return a put stream result on 5th
+            if (i == 5) {
+                EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+            }
+        }
+    }
+
+    UINT64 drainStream()
+    {
+        UINT32 filledSize;
+        UINT64 clientStreamHandle, totalSize = 0;
+        STATUS retStatus;
+        BYTE getDataBuffer[20000];
+
+        do {
+            retStatus = getKinesisVideoStreamData(mStreamHandle, &clientStreamHandle, getDataBuffer, SIZEOF(getDataBuffer), &filledSize);
+            EXPECT_TRUE(retStatus == STATUS_SUCCESS || retStatus == STATUS_NO_MORE_DATA_AVAILABLE);
+            totalSize += filledSize;
+        } while (retStatus == STATUS_SUCCESS);
+
+        return totalSize;
+    }
+};
+
+TEST_F(StreamArenaTest, putFrame_StoredInStreamArena)
+{
+    UINT32 frameSize = 1000;
+    PBYTE pData = (PBYTE) MEMALLOC(frameSize);
+    UINT64 viewByteSize;
+    PKinesisVideoClient pKinesisVideoClient = FROM_CLIENT_HANDLE(mClientHandle);
+    PKinesisVideoStream pKinesisVideoStream;
+    PViewItem pViewItem;
+    ClientMetrics memMetrics;
+
+    // Create and ready a stream
+    ReadyStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    EXPECT_EQ(TEST_ARENA_STORAGE_SIZE * TEST_ARENA_RATIO / 100 / MAX_TEST_STREAM_COUNT, pKinesisVideoClient->streamArenaSize);
+    EXPECT_TRUE(pKinesisVideoStream->pArena != NULL);
+    EXPECT_EQ(pKinesisVideoClient->streamArenaSize, pKinesisVideoStream->pArena->heapLimit);
+    EXPECT_EQ(TEST_ARENA_STORAGE_SIZE - pKinesisVideoClient->streamArenaSize * MAX_TEST_STREAM_COUNT, pKinesisVideoClient->pHeap->heapLimit);
+
+    MEMSET(pData, 0x55, frameSize);
+    putFrames(20, frameSize, pData);
+
+    // All of the frames should be in the arena and none in the shared heap
+    EXPECT_EQ(20, pKinesisVideoStream->pArena->numAlloc);
+    EXPECT_EQ(0, pKinesisVideoClient->pHeap->numAlloc);
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetHead(pKinesisVideoStream->pView, &pViewItem));
+    EXPECT_TRUE(CHECK_ITEM_STREAM_ARENA(pViewItem->flags));
+
+    // The metrics should account for the arena
+    memMetrics.version = CLIENT_METRICS_CURRENT_VERSION;
+    EXPECT_EQ(STATUS_SUCCESS, getKinesisVideoMetrics(mClientHandle, &memMetrics));
+    EXPECT_EQ(pKinesisVideoClient->pHeap->heapSize + pKinesisVideoStream->pArena->heapSize, memMetrics.contentStoreAllocatedSize);
+    EXPECT_EQ(TEST_ARENA_STORAGE_SIZE - memMetrics.contentStoreAllocatedSize, memMetrics.contentStoreAvailableSize);
+
+    // Ensure we can stream out everything
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetWindowAllocationSize(pKinesisVideoStream->pView, &viewByteSize, NULL));
+    EXPECT_EQ(viewByteSize, drainStream());
+
+    MEMFREE(pData);
+}
+
+TEST_F(StreamArenaTest, putFrame_OverflowToSharedHeap)
+{
+    UINT32 frameSize = 1000000, arenaItems = 0, sharedItems = 0;
+    PBYTE pData = (PBYTE) MEMALLOC(frameSize);
+    UINT64 viewByteSize, curIndex, tailIndex, headIndex;
+    PKinesisVideoClient pKinesisVideoClient = FROM_CLIENT_HANDLE(mClientHandle);
+    PKinesisVideoStream pKinesisVideoStream;
+    PViewItem pViewItem;
+
+    // Create and ready a stream
+    ReadyStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    // Put more frames than the arena can hold
+    MEMSET(pData, 0x55, frameSize);
+    putFrames((UINT32) (pKinesisVideoClient->streamArenaSize / frameSize) + 10, frameSize, pData);
+
+    EXPECT_NE(0, pKinesisVideoStream->pArena->numAlloc);
+    EXPECT_NE(0, pKinesisVideoClient->pHeap->numAlloc);
+
+    // Validate the items are marked with the storage they are in
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetTail(pKinesisVideoStream->pView, &pViewItem));
+    tailIndex = pViewItem->index;
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetHead(pKinesisVideoStream->pView, &pViewItem));
+    headIndex = pViewItem->index;
+    for (curIndex = tailIndex; curIndex <= headIndex; curIndex++) {
+        EXPECT_EQ(STATUS_SUCCESS, contentViewGetItemAt(pKinesisVideoStream->pView, curIndex, &pViewItem));
+        if (CHECK_ITEM_STREAM_ARENA(pViewItem->flags)) {
+            arenaItems++;
+        } else {
+            sharedItems++;
+        }
+    }
+
+    EXPECT_EQ(pKinesisVideoStream->pArena->numAlloc, arenaItems);
+    EXPECT_EQ(pKinesisVideoClient->pHeap->numAlloc, sharedItems);
+
+    // Ensure we can stream out from both of the heaps
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetWindowAllocationSize(pKinesisVideoStream->pView, &viewByteSize, NULL));
+    EXPECT_EQ(viewByteSize, drainStream());
+
+    // Removing the items should release the storage in both of the heaps
+    EXPECT_EQ(STATUS_SUCCESS, contentViewRemoveAll(pKinesisVideoStream->pView));
+    EXPECT_EQ(0, pKinesisVideoStream->pArena->numAlloc);
+    EXPECT_EQ(0, pKinesisVideoClient->pHeap->numAlloc);
+
+    MEMFREE(pData);
+}
+
+TEST_F(StreamArenaTest, putFrame_FileBasedStreamArena)
+{
+    UINT32 frameSize = 1000000, frameCount;
+    PBYTE pData = (PBYTE) MEMALLOC(frameSize);
+    UINT64 viewByteSize;
+    PKinesisVideoClient pKinesisVideoClient;
+    PKinesisVideoStream pKinesisVideoStream;
+    PViewItem pViewItem;
+    PFileHeapEntry pEntry;
+
+    // Re-create the client with the file based storage. Both of the arena portions should fit the min heap size.
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoClient(&mClientHandle));
+    mDeviceInfo.storageInfo.storageSize = 2 * TEST_ARENA_STORAGE_SIZE;
+    mDeviceInfo.storageInfo.storageType = DEVICE_STORAGE_TYPE_HYBRID_FILE;
+    mDeviceInfo.storageInfo.spillRatio = 50;
+    STRCPY(mDeviceInfo.storageInfo.rootDirectory, (PCHAR) TEST_ARENA_ROOT_DIRECTORY);
+    EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &mClientHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createDeviceResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_DEVICE_ARN));
+
+    ReadyStream();
+    pKinesisVideoClient = FROM_CLIENT_HANDLE(mClientHandle);
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    // Fill the arena past its in-memory portion without overflowing to the shared heap
+    frameCount = (UINT32) (pKinesisVideoClient->streamArenaSize * 3 / 4 / frameSize);
+    EXPECT_GT(frameCount * frameSize, pKinesisVideoClient->streamArenaSize / 2);
+    MEMSET(pData, 0x55, frameSize);
+    putFrames(frameCount, frameSize, pData);
+
+    EXPECT_EQ(frameCount, pKinesisVideoStream->pArena->numAlloc);
+    EXPECT_EQ(0, pKinesisVideoClient->pHeap->numAlloc);
+
+    // The arena spills the oldest frames into its own segment file the same way as the client storage
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetTail(pKinesisVideoStream->pView, &pViewItem));
+    EXPECT_TRUE(CHECK_ITEM_STREAM_ARENA(pViewItem->flags));
+    pEntry = hybridFileGetEntry((PHybridFileHeap) pKinesisVideoStream->pArena, pViewItem->handle);
+    EXPECT_TRUE(pEntry != NULL && IS_FILE_ALLOCATION_HANDLE(pEntry->handle));
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetHead(pKinesisVideoStream->pView, &pViewItem));
+    EXPECT_TRUE(CHECK_ITEM_STREAM_ARENA(pViewItem->flags));
+    pEntry = hybridFileGetEntry((PHybridFileHeap) pKinesisVideoStream->pArena, pViewItem->handle);
+    EXPECT_TRUE(pEntry != NULL && IS_DIRECT_ALLOCATION_HANDLE(pEntry->handle));
+
+    // Ensure we can stream out everything including the file backed frames
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetWindowAllocationSize(pKinesisVideoStream->pView, &viewByteSize, NULL));
+    EXPECT_EQ(viewByteSize, drainStream());
+
+    MEMFREE(pData);
+}
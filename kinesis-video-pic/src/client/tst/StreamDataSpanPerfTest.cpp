@@ -0,0 +1,249 @@
+#include "ClientTestFixture.h"
+
+#define DATA_SPAN_PERF_STORAGE_SIZE             (64 * 1024 * 1024)
+#define DATA_SPAN_PERF_CONTENT_SIZE             (16 * 1024 * 1024)
+#define DATA_SPAN_PERF_FRAME_RATE               50
+#define DATA_SPAN_PERF_KEY_FRAME_INTERVAL       50
+
+// The default curl read buffer size - CURL_MAX_WRITE_SIZE
+#define DATA_SPAN_PERF_BUFFER_SIZE              (16 * 1024)
+
+/**
+ * The ways the network thread can drain the stream into the fixed size network buffer
+ */
+typedef enum {
+    // Copy under the stream lock with getKinesisVideoStreamData
+    DATA_SPAN_PERF_READ_COPY,
+
+    // Pin, copy and release spans until the buffer is filled
+    DATA_SPAN_PERF_READ_SPAN_PER_BUFFER,
+
+    // Copy the data and pin the data larger than the buffer holding the span across the buffers until it's consumed
+    DATA_SPAN_PERF_READ_HELD_SPAN,
+} DATA_SPAN_PERF_READ_MODE;
+
+class StreamDataSpanPerfTest : public ClientTestBase {
+protected:
+    /**
+     * Re-creates the client with the large storage and the non-logging counting mutex callbacks
+     */
+    VOID recreateClient()
+    {
+        if (IS_VALID_CLIENT_HANDLE(mClientHandle)) {
+            EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoClient(&mClientHandle));
+        }
+
+        mDeviceInfo.storageInfo.storageSize = DATA_SPAN_PERF_STORAGE_SIZE;
+        mClientCallbacks.lockMutexFn = countingLockMutexFunc;
+        mClientCallbacks.unlockMutexFn = countingUnlockMutexFunc;
+
+        // The stream creation expectations count the callbacks from the new client
+        mDescribeStreamFuncCount = 0;
+        mGetStreamingEndpointFuncCount = 0;
+        mGetStreamingTokenFuncCount = 0;
+        EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &mClientHandle));
+        EXPECT_EQ(STATUS_SUCCESS, createDeviceResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_DEVICE_ARN));
+        EXPECT_TRUE(mClientReady);
+    }
+
+    static VOID countingLockMutexFunc(UINT64 customData, MUTEX mutex)
+    {
+        ((StreamDataSpanPerfTest*) customData)->mLockCount++;
+        MUTEX_LOCK(mutex);
+    }
+
+    static VOID countingUnlockMutexFunc(UINT64 customData, MUTEX mutex)
+    {
+        UNUSED_PARAM(customData);
+        MUTEX_UNLOCK(mutex);
+    }
+
+    VOID putFrames(UINT32 frameCount, UINT32 frameSize, PBYTE pData)
+    {
+        UINT32 i;
+        Frame frame;
+
+        for (i = 0; i < frameCount; i++) {
+            frame.index = i;
+            frame.decodingTs = frame.presentationTs = i * TEST_FRAME_DURATION;
+            frame.duration = TEST_FRAME_DURATION;
+            frame.size = frameSize;
+            frame.frameData = pData;
+            frame.flags = i % DATA_SPAN_PERF_KEY_FRAME_INTERVAL == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+            EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, &frame));
+
+            // Return a put stream result on the first frame
+            if (i == 0) {
+                EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+            }
+        }
+    }
+
+    /**
+     * Fills the network buffer with the given read mode. The held span and its consumed
+     * offset are carried across the calls the same way the network thread would carry them.
+     */
+    STATUS fillBuffer(DATA_SPAN_PERF_READ_MODE mode, PBYTE pBuffer, UINT32 bufferSize, PUINT32 pFilledSize)
+    {
+        STATUS retStatus = STATUS_SUCCESS;
+        UINT64 clientStreamHandle;
+        UINT32 size;
+
+        *pFilledSize = 0;
+
+        switch (mode) {
+            case DATA_SPAN_PERF_READ_COPY:
+                retStatus = getKinesisVideoStreamData(mStreamHandle, &clientStreamHandle, pBuffer, bufferSize, pFilledSize);
+                break;
+
+            case DATA_SPAN_PERF_READ_SPAN_PER_BUFFER:
+                while (*pFilledSize < bufferSize) {
+                    retStatus = getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, bufferSize - *pFilledSize, &mSpan);
+                    if (STATUS_SUCCESS != retStatus) {
+                        break;
+                    }
+
+                    MEMCPY(pBuffer + *pFilledSize, mSpan.pData, mSpan.size);
+                    *pFilledSize += mSpan.size;
+
+                    retStatus = releaseKinesisVideoStreamDataSpan(mStreamHandle, mSpan.releaseToken);
+                    mSpan.releaseToken = INVALID_ALLOCATION_HANDLE_VALUE;
+                    if (STATUS_SUCCESS != retStatus) {
+                        break;
+                    }
+                }
+
+                break;
+
+            case DATA_SPAN_PERF_READ_HELD_SPAN:
+                // Copy the small data and pin the data larger than the buffer
+                if (!IS_VALID_ALLOCATION_HANDLE(mSpan.releaseToken)) {
+                    retStatus = getKinesisVideoStreamDataWithSpan(mStreamHandle, &clientStreamHandle, pBuffer, bufferSize,
+                                                                  pFilledSize, &mSpan);
+                    mSpanOffset = 0;
+                }
+
+                // Send the pinned data from the storage until it's consumed
+                if (IS_VALID_ALLOCATION_HANDLE(mSpan.releaseToken)) {
+                    size = MIN(bufferSize - *pFilledSize, mSpan.size - mSpanOffset);
+                    MEMCPY(pBuffer + *pFilledSize, mSpan.pData + mSpanOffset, size);
+                    *pFilledSize += size;
+                    mSpanOffset += size;
+
+                    if (mSpanOffset == mSpan.size) {
+                        retStatus = releaseKinesisVideoStreamDataSpan(mStreamHandle, mSpan.releaseToken);
+                        mSpan.releaseToken = INVALID_ALLOCATION_HANDLE_VALUE;
+                    }
+                }
+
+                break;
+        }
+
+        return retStatus;
+    }
+
+    /**
+     * Drains the stored content with the read mode and returns the elapsed time
+     */
+    UINT64 drainStream(DATA_SPAN_PERF_READ_MODE mode, PUINT64 pTotalSize, PUINT32 pBufferCount)
+    {
+        UINT32 filledSize;
+        STATUS retStatus;
+        UINT64 start;
+        PBYTE pBuffer = (PBYTE) MEMALLOC(DATA_SPAN_PERF_BUFFER_SIZE);
+
+        *pTotalSize = 0;
+        *pBufferCount = 0;
+        mSpan.releaseToken = INVALID_ALLOCATION_HANDLE_VALUE;
+
+        start = GETTIME();
+        do {
+            retStatus = fillBuffer(mode, pBuffer, DATA_SPAN_PERF_BUFFER_SIZE, &filledSize);
+            EXPECT_TRUE(retStatus == STATUS_SUCCESS || retStatus == STATUS_NO_MORE_DATA_AVAILABLE);
+            *pTotalSize += filledSize;
+            (*pBufferCount)++;
+        } while (retStatus == STATUS_SUCCESS);
+
+        start = GETTIME() - start;
+
+        EXPECT_FALSE(IS_VALID_ALLOCATION_HANDLE(mSpan.releaseToken));
+        MEMFREE(pBuffer);
+
+        return start;
+    }
+
+    /**
+     * Stores the content in the given frame size, drains it with each of the read modes
+     * and reports the stream lock count and the drain time per MB.
+     */
+    VOID runDataSpanBenchmark(UINT32 frameSize, PUINT32 pLockCounts)
+    {
+        UINT32 frameCount = DATA_SPAN_PERF_CONTENT_SIZE / frameSize, bufferCount, mode;
+        PBYTE pData = (PBYTE) MEMALLOC(frameSize);
+        UINT64 drainTime, totalSize, expectedSize = 0;
+        const CHAR* modeNames[] = {"copy", "span per buffer", "held span"};
+
+        MEMSET(pData, 0x55, frameSize);
+        mStreamInfo.streamCaps.frameRate = DATA_SPAN_PERF_FRAME_RATE;
+        mStreamInfo.streamCaps.bufferDuration = (UINT64) (frameCount + DATA_SPAN_PERF_FRAME_RATE) * TEST_FRAME_DURATION;
+
+        for (mode = DATA_SPAN_PERF_READ_COPY; mode <= DATA_SPAN_PERF_READ_HELD_SPAN; mode++) {
+            recreateClient();
+            ReadyStream();
+            putFrames(frameCount, frameSize, pData);
+
+            mLockCount = 0;
+            drainTime = drainStream((DATA_SPAN_PERF_READ_MODE) mode, &totalSize, &bufferCount);
+            pLockCounts[mode] = mLockCount;
+
+            // All of the modes stream out the same content
+            if (mode == DATA_SPAN_PERF_READ_COPY) {
+                expectedSize = totalSize;
+            }
+
+            EXPECT_EQ(expectedSize, totalSize);
+
+            DLOGI("Frame size %u, %s: %u buffers, %u locks, %llu ns/MB",
+                  frameSize, modeNames[mode], bufferCount, pLockCounts[mode],
+                  (unsigned long long) (drainTime * DEFAULT_TIME_UNIT_IN_NANOS * 1024 * 1024 / totalSize));
+
+            EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+        }
+
+        MEMFREE(pData);
+    }
+
+    volatile UINT32 mLockCount;
+    StreamDataSpan mSpan;
+    UINT32 mSpanOffset;
+};
+
+TEST_F(StreamDataSpanPerfTest, streamDataSpan_SmallFrames)
+{
+    UINT32 lockCounts[DATA_SPAN_PERF_READ_HELD_SPAN + 1];
+
+    runDataSpanBenchmark(1024, lockCounts);
+
+    // The small frames are copied rather than pinned one by one
+    EXPECT_GT(lockCounts[DATA_SPAN_PERF_READ_SPAN_PER_BUFFER], lockCounts[DATA_SPAN_PERF_READ_HELD_SPAN]);
+}
+
+TEST_F(StreamDataSpanPerfTest, streamDataSpan_BufferSizeFrames)
+{
+    UINT32 lockCounts[DATA_SPAN_PERF_READ_HELD_SPAN + 1];
+
+    runDataSpanBenchmark(DATA_SPAN_PERF_BUFFER_SIZE, lockCounts);
+
+    EXPECT_GT(lockCounts[DATA_SPAN_PERF_READ_SPAN_PER_BUFFER], lockCounts[DATA_SPAN_PERF_READ_HELD_SPAN]);
+}
+
+TEST_F(StreamDataSpanPerfTest, streamDataSpan_LargeFrames)
+{
+    UINT32 lockCounts[DATA_SPAN_PERF_READ_HELD_SPAN + 1];
+
+    runDataSpanBenchmark(128 * 1024, lockCounts);
+
+    // Holding the span pins a large frame once instead of once per buffer
+    EXPECT_GT(lockCounts[DATA_SPAN_PERF_READ_SPAN_PER_BUFFER], lockCounts[DATA_SPAN_PERF_READ_HELD_SPAN]);
+    EXPECT_GT(lockCounts[DATA_SPAN_PERF_READ_COPY], lockCounts[DATA_SPAN_PERF_READ_HELD_SPAN]);
+}
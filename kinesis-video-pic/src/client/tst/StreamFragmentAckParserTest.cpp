@@ -0,0 +1,178 @@
+#include "ClientTestFixture.h"
+
+#define ACK_PARSER_PERF_ACK_COUNT           200000
+#define ACK_PARSER_PERF_SMALL_CHUNK_SIZE    17
+
+// ACKs as they are returned by the service for the first fragment
+#define TEST_ACK_SEQUENCE_NUMBER            "91343852333181432392682062607743920146264080000"
+#define TEST_ACK_BUFFERING                  "{\"EventType\":\"BUFFERING\",\"FragmentTimecode\":0,\"FragmentNumber\":\"" TEST_ACK_SEQUENCE_NUMBER "\"}"
+#define TEST_ACK_RECEIVED                   "{\"EventType\":\"RECEIVED\",\"FragmentTimecode\":0,\"FragmentNumber\":\"" TEST_ACK_SEQUENCE_NUMBER "\"}"
+#define TEST_ACK_IDLE                       "{\"EventType\":\"IDLE\"}"
+
+class StreamFragmentAckParserTest : public ClientTestBase {
+protected:
+    /**
+     * Readies the stream and starts streaming the first fragment so the ACKs for it are in the view
+     */
+    VOID startStreaming()
+    {
+        BYTE frameBuffer[100];
+        Frame frame;
+
+        MEMSET(frameBuffer, 0x55, SIZEOF(frameBuffer));
+        frame.index = 0;
+        frame.decodingTs = frame.presentationTs = 0;
+        frame.duration = TEST_FRAME_DURATION;
+        frame.size = SIZEOF(frameBuffer);
+        frame.frameData = frameBuffer;
+        frame.flags = FRAME_FLAG_KEY_FRAME;
+
+        ASSERT_EQ(STATUS_SUCCESS, ReadyStream());
+        EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, &frame));
+        EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+    }
+
+    STATUS parseAck(PCHAR ack, UINT32 size)
+    {
+        return kinesisVideoStreamParseFragmentAck(mStreamHandle, TEST_STREAMING_HANDLE, ack, size);
+    }
+
+    /**
+     * Builds a recorded ACK stream - each fragment gets buffering and received ACKs with idle ACKs in between
+     */
+    UINT32 buildRecordedAcks(PCHAR pBuffer, UINT32 ackCount)
+    {
+        UINT32 i, size = 0, ackSize;
+        PCHAR acks[] = {(PCHAR) TEST_ACK_BUFFERING, (PCHAR) TEST_ACK_RECEIVED, (PCHAR) TEST_ACK_IDLE};
+
+        for (i = 0; i < ackCount; i++) {
+            ackSize = (UINT32) STRLEN(acks[i % ARRAY_SIZE(acks)]);
+            MEMCPY(pBuffer + size, acks[i % ARRAY_SIZE(acks)], ackSize);
+            size += ackSize;
+        }
+
+        return size;
+    }
+
+    /**
+     * Parses the recorded ACK stream in the chunks of the given size and returns the elapsed time
+     */
+    UINT64 parseRecordedAcks(PCHAR pBuffer, UINT32 size, UINT32 chunkSize)
+    {
+        UINT32 offset, count;
+        UINT64 start = GETTIME();
+
+        for (offset = 0; offset < size; offset += count) {
+            count = MIN(chunkSize, size - offset);
+            EXPECT_EQ(STATUS_SUCCESS, parseAck(pBuffer + offset, count));
+        }
+
+        return GETTIME() - start;
+    }
+};
+
+TEST_F(StreamFragmentAckParserTest, parseFragmentAck_SplitAtEveryPosition)
+{
+    CHAR ack[] = TEST_ACK_BUFFERING;
+    UINT32 split, i, size = (UINT32) STRLEN(ack);
+
+    startStreaming();
+
+    for (split = 1; split < size; split++) {
+        mFragmentAckReceivedFuncCount = 0;
+        MEMSET(&mFragmentAck, 0x00, SIZEOF(FragmentAck));
+        EXPECT_EQ(STATUS_SUCCESS, parseAck(ack, split));
+        EXPECT_EQ(0, mFragmentAckReceivedFuncCount);
+        EXPECT_EQ(STATUS_SUCCESS, parseAck(ack + split, size - split));
+        EXPECT_EQ(1, mFragmentAckReceivedFuncCount);
+        EXPECT_EQ(FRAGMENT_ACK_TYPE_BUFFERING, mFragmentAck.ackType);
+        EXPECT_EQ(0, mFragmentAck.timestamp);
+        EXPECT_STREQ(TEST_ACK_SEQUENCE_NUMBER, mFragmentAck.sequenceNumber);
+    }
+
+    // Byte at a time
+    mFragmentAckReceivedFuncCount = 0;
+    for (i = 0; i < size; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, parseAck(ack + i, 1));
+    }
+
+    EXPECT_EQ(1, mFragmentAckReceivedFuncCount);
+    EXPECT_STREQ(TEST_ACK_SEQUENCE_NUMBER, mFragmentAck.sequenceNumber);
+}
+
+TEST_F(StreamFragmentAckParserTest, parseFragmentAck_UnknownKeysAndWhitespaces)
+{
+    startStreaming();
+
+    EXPECT_EQ(STATUS_SUCCESS, parseAck(" \n{ \"Unknown\" : {\"a\":{\"b\":1}} , \"Array\": [[1], [2]],\n"
+                                       "  \"EventType\" : \"RECEIVED\" , \"FragmentTimecode\" : 0 ,"
+                                       " \"FragmentNumber\":\"12345\" , \"Other\":true }", 0));
+    EXPECT_EQ(1, mFragmentAckReceivedFuncCount);
+    EXPECT_EQ(FRAGMENT_ACK_TYPE_RECEIVED, mFragmentAck.ackType);
+    EXPECT_EQ(0, mFragmentAck.timestamp);
+    EXPECT_STREQ("12345", mFragmentAck.sequenceNumber);
+
+    // Key names and event types are matched exactly
+    EXPECT_EQ(FRAGMENT_ACK_KEY_NAME_UNKNOWN, getFragmentAckKeyName("EventTypo", 9));
+    EXPECT_EQ(FRAGMENT_ACK_KEY_NAME_UNKNOWN, getFragmentAckKeyName("EventTyp", 8));
+    EXPECT_EQ(FRAGMENT_ACK_KEY_NAME_ERROR_ID, getFragmentAckKeyName("ErrorId", 7));
+    EXPECT_EQ(FRAGMENT_ACK_TYPE_PERSISTED, getFragmentAckType("PERSISTED", 9));
+    EXPECT_EQ(FRAGMENT_ACK_TYPE_BUFFERING, getFragmentAckType("BUFFERING", 9));
+    EXPECT_EQ(FRAGMENT_ACK_TYPE_UNDEFINED, getFragmentAckType("BUFFERINK", 9));
+    EXPECT_EQ(FRAGMENT_ACK_TYPE_UNDEFINED, getFragmentAckType("IDLE", 3));
+    EXPECT_EQ(FRAGMENT_ACK_TYPE_UNDEFINED, getFragmentAckType("", 0));
+}
+
+TEST_F(StreamFragmentAckParserTest, parseFragmentAck_InvalidAcks)
+{
+    CHAR longKey[MAX_ACK_FRAGMENT_LEN];
+
+    startStreaming();
+
+    EXPECT_EQ(STATUS_INVALID_ACK_KEY_START, parseAck("{EventType:\"IDLE\"}", 0));
+    EXPECT_EQ(STATUS_INVALID_ACK_INVALID_VALUE_START, parseAck("{\"EventType\":}", 0));
+    EXPECT_EQ(STATUS_INVALID_ACK_INVALID_VALUE_END, parseAck("{\"FragmentTimecode\":12\"}", 0));
+    EXPECT_EQ(STATUS_INVALID_ACK_DUPLICATE_KEY_NAME, parseAck("{\"EventType\":\"IDLE\",\"EventType\":\"IDLE\"}", 0));
+    EXPECT_EQ(STATUS_INVALID_PARSED_ACK_TYPE, parseAck("{\"FragmentTimecode\":0}", 0));
+    EXPECT_EQ(STATUS_MISSING_ERR_ACK_ID, parseAck("{\"EventType\":\"ERROR\"}", 0));
+    EXPECT_NE(STATUS_SUCCESS, parseAck("{\"EventType\":\"IDLE\",\"ErrorId\":\"abc\"}", 0));
+    EXPECT_EQ(0, mFragmentAckReceivedFuncCount);
+
+    // A token spanning the chunks can't grow over the max ACK length
+    MEMSET(longKey, 'a', SIZEOF(longKey));
+    EXPECT_EQ(STATUS_SUCCESS, parseAck("{\"", 0));
+    EXPECT_EQ(STATUS_SUCCESS, parseAck(longKey, SIZEOF(longKey)));
+    EXPECT_EQ(STATUS_INVALID_ACK_SEGMENT_LEN, parseAck(longKey, 1));
+
+    // The parser recovers after the errors
+    EXPECT_EQ(STATUS_SUCCESS, parseAck(TEST_ACK_RECEIVED, 0));
+    EXPECT_EQ(1, mFragmentAckReceivedFuncCount);
+    EXPECT_EQ(FRAGMENT_ACK_TYPE_RECEIVED, mFragmentAck.ackType);
+}
+
+TEST_F(StreamFragmentAckParserTest, parseFragmentAck_RecordedAckThroughput)
+{
+    UINT32 size;
+    UINT64 wholeTime, smallTime;
+    PCHAR pBuffer = (PCHAR) MEMALLOC(ACK_PARSER_PERF_ACK_COUNT * SIZEOF(TEST_ACK_BUFFERING));
+
+    ASSERT_TRUE(pBuffer != NULL);
+    startStreaming();
+    size = buildRecordedAcks(pBuffer, ACK_PARSER_PERF_ACK_COUNT);
+
+    // Chunks as large as allowed
+    wholeTime = parseRecordedAcks(pBuffer, size, MAX_ACK_FRAGMENT_LEN);
+    EXPECT_EQ(ACK_PARSER_PERF_ACK_COUNT, mFragmentAckReceivedFuncCount);
+
+    // Small chunks splitting most of the ACKs
+    mFragmentAckReceivedFuncCount = 0;
+    smallTime = parseRecordedAcks(pBuffer, size, ACK_PARSER_PERF_SMALL_CHUNK_SIZE);
+    EXPECT_EQ(ACK_PARSER_PERF_ACK_COUNT, mFragmentAckReceivedFuncCount);
+
+    DLOGI("Parsed %u ACKs (%u bytes). %u byte chunks: %" PRIu64 " ns per ACK. %u byte chunks: %" PRIu64 " ns per ACK",
+          ACK_PARSER_PERF_ACK_COUNT, size,
+          MAX_ACK_FRAGMENT_LEN, wholeTime * DEFAULT_TIME_UNIT_IN_NANOS / ACK_PARSER_PERF_ACK_COUNT,
+          ACK_PARSER_PERF_SMALL_CHUNK_SIZE, smallTime * DEFAULT_TIME_UNIT_IN_NANOS / ACK_PARSER_PERF_ACK_COUNT);
+
+    MEMFREE(pBuffer);
+}
@@ -0,0 +1,284 @@
+#include "ClientTestFixture.h"
+
+#define TEST_FRAGMENT_FRAME_COUNT               10
+#define TEST_FRAGMENT_COUNT                     3
+#define TEST_FRAGMENT_SMALL_FRAME_SIZE          1000
+#define TEST_FRAGMENT_LARGE_FRAME_SIZE          10000
+
+#define STORAGE_BENCHMARK_STORAGE_SIZE          (64 * 1024 * 1024)
+#define STORAGE_BENCHMARK_BITRATE_BPS           (2 * 1024 * 1024)
+#define STORAGE_BENCHMARK_CONTENT_SECONDS       30
+#define STORAGE_BENCHMARK_KEY_FRAME_SECONDS     2
+
+class StreamFragmentStorageTest : public ClientTestBase {
+protected:
+    virtual void SetUp()
+    {
+        mDeviceInfo.storageInfo.fragmentStorage = TRUE;
+        ClientTestBase::SetUp();
+        mStreamInfo.streamCaps.keyFrameFragmentation = TRUE;
+    };
+
+    /**
+     * Re-creates the client with or without the fragment storage
+     */
+    VOID recreateClient(BOOL fragmentStorage)
+    {
+        if (IS_VALID_CLIENT_HANDLE(mClientHandle)) {
+            EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoClient(&mClientHandle));
+        }
+
+        mDeviceInfo.storageInfo.storageSize = STORAGE_BENCHMARK_STORAGE_SIZE;
+        mDeviceInfo.storageInfo.fragmentStorage = fragmentStorage;
+
+        // The stream creation expectations count the callbacks from the new client
+        mDescribeStreamFuncCount = 0;
+        mGetStreamingEndpointFuncCount = 0;
+        mGetStreamingTokenFuncCount = 0;
+        EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &mClientHandle));
+        EXPECT_EQ(STATUS_SUCCESS, createDeviceResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_DEVICE_ARN));
+        EXPECT_TRUE(mClientReady);
+    }
+
+    VOID putFrames(UINT32 frameCount, UINT32 keyFrameInterval, UINT64 frameDuration, UINT32 frameSize, PBYTE pData)
+    {
+        UINT32 i;
+        Frame frame;
+
+        for (i = 0; i < frameCount; i++) {
+            frame.index = i;
+            frame.decodingTs = frame.presentationTs = i * frameDuration;
+            frame.duration = frameDuration;
+            frame.size = frameSize;
+            frame.frameData = pData;
+            frame.flags = i % keyFrameInterval == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+            EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, &frame));
+
+            // Return a put stream result on the first frame
+            if (i == 0) {
+                EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+            }
+        }
+    }
+
+    UINT64 drainStream()
+    {
+        UINT32 filledSize;
+        UINT64 clientStreamHandle, totalSize = 0;
+        STATUS retStatus;
+        BYTE getDataBuffer[20000];
+
+        do {
+            retStatus = getKinesisVideoStreamData(mStreamHandle, &clientStreamHandle, getDataBuffer, SIZEOF(getDataBuffer), &filledSize);
+            EXPECT_TRUE(retStatus == STATUS_SUCCESS || retStatus == STATUS_NO_MORE_DATA_AVAILABLE);
+            totalSize += filledSize;
+        } while (retStatus == STATUS_SUCCESS);
+
+        return totalSize;
+    }
+
+    /**
+     * Validates the items of the fragment are stored back-to-back in a single allocation
+     * and returns the number of the distinct allocations backing the view.
+     */
+    UINT32 validateViewStorage()
+    {
+        PKinesisVideoStream pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+        PViewItem pViewItem, pPrevItem = NULL;
+        UINT64 tailIndex, headIndex, curIndex;
+        UINT32 allocationCount = 0;
+
+        EXPECT_EQ(STATUS_SUCCESS, contentViewGetTail(pKinesisVideoStream->pView, &pViewItem));
+        tailIndex = pViewItem->index;
+        EXPECT_EQ(STATUS_SUCCESS, contentViewGetHead(pKinesisVideoStream->pView, &pViewItem));
+        headIndex = pViewItem->index;
+
+        for (curIndex = tailIndex; curIndex <= headIndex; curIndex++) {
+            EXPECT_EQ(STATUS_SUCCESS, contentViewGetItemAt(pKinesisVideoStream->pView, curIndex, &pViewItem));
+            EXPECT_TRUE(CHECK_ITEM_FRAGMENT_STORAGE(pViewItem->flags));
+
+            if (pPrevItem != NULL && pPrevItem->handle == pViewItem->handle) {
+                EXPECT_FALSE(CHECK_ITEM_FRAGMENT_START(pViewItem->flags));
+                EXPECT_EQ(pPrevItem->allocationOffset + pPrevItem->length, pViewItem->allocationOffset);
+            } else {
+                EXPECT_EQ(0, pViewItem->allocationOffset);
+                allocationCount++;
+            }
+
+            pPrevItem = pViewItem;
+        }
+
+        return allocationCount;
+    }
+
+    /**
+     * Stores and streams out the given duration of content at the frame rate and reports
+     * the storage overhead on top of the packaged frames and the throughput.
+     */
+    VOID runStorageBenchmark(BOOL fragmentStorage, UINT32 frameRate)
+    {
+        UINT32 frameCount = frameRate * STORAGE_BENCHMARK_CONTENT_SECONDS;
+        UINT32 frameSize = STORAGE_BENCHMARK_BITRATE_BPS / 8 / frameRate;
+        PBYTE pData = (PBYTE) MEMALLOC(frameSize);
+        PKinesisVideoClient pKinesisVideoClient;
+        UINT64 viewByteSize, putTime, getTime, heapSize, numAlloc;
+
+        // The view item timestamps are in the MKV timecode scale so the frame duration is truncated to the
+        // millisecond to keep the frames from overlapping, i.e. 30 fps is stored as 33 ms frames.
+        UINT64 frameDuration = HUNDREDS_OF_NANOS_IN_A_SECOND / frameRate / HUNDREDS_OF_NANOS_IN_A_MILLISECOND *
+                HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+
+        recreateClient(fragmentStorage);
+        pKinesisVideoClient = FROM_CLIENT_HANDLE(mClientHandle);
+        mStreamInfo.streamCaps.frameRate = frameRate;
+        mStreamInfo.streamCaps.bufferDuration = (STORAGE_BENCHMARK_CONTENT_SECONDS + 1) * HUNDREDS_OF_NANOS_IN_A_SECOND;
+        ReadyStream();
+
+        MEMSET(pData, 0x55, frameSize);
+        putTime = GETTIME();
+        putFrames(frameCount, frameRate * STORAGE_BENCHMARK_KEY_FRAME_SECONDS, frameDuration, frameSize, pData);
+        putTime = GETTIME() - putTime;
+
+        EXPECT_EQ(STATUS_SUCCESS, contentViewGetWindowAllocationSize(FROM_STREAM_HANDLE(mStreamHandle)->pView, &viewByteSize, NULL));
+        heapSize = pKinesisVideoClient->pHeap->heapSize;
+        numAlloc = pKinesisVideoClient->pHeap->numAlloc;
+
+        if (fragmentStorage) {
+            EXPECT_EQ(numAlloc, validateViewStorage());
+        } else {
+            EXPECT_EQ(frameCount, numAlloc);
+        }
+
+        getTime = GETTIME();
+        EXPECT_EQ(viewByteSize, drainStream());
+        getTime = GETTIME() - getTime;
+
+        DLOGI("%s storage at %u fps, %u byte frames: %" PRIu64 " allocations, %" PRIu64 " bytes of overhead over %" PRIu64
+              " bytes stored (%" PRIu64 " bytes per frame). Put %" PRIu64 " ns per frame, get %" PRIu64 " ns per frame",
+              fragmentStorage ? "Fragment" : "Per-frame", frameRate, frameSize, numAlloc, heapSize - viewByteSize, viewByteSize,
+              (heapSize - viewByteSize) / frameCount,
+              putTime * DEFAULT_TIME_UNIT_IN_NANOS / frameCount, getTime * DEFAULT_TIME_UNIT_IN_NANOS / frameCount);
+
+        EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+        EXPECT_EQ(0, pKinesisVideoClient->pHeap->numAlloc);
+
+        MEMFREE(pData);
+    }
+};
+
+TEST_F(StreamFragmentStorageTest, putFrame_FragmentSharesAllocation)
+{
+    PBYTE pData = (PBYTE) MEMALLOC(TEST_FRAGMENT_SMALL_FRAME_SIZE);
+    PKinesisVideoClient pKinesisVideoClient = FROM_CLIENT_HANDLE(mClientHandle);
+    PKinesisVideoStream pKinesisVideoStream;
+    UINT64 viewByteSize;
+
+    ReadyStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+    EXPECT_TRUE(pKinesisVideoStream->fragmentStorage.enabled);
+
+    MEMSET(pData, 0x55, TEST_FRAGMENT_SMALL_FRAME_SIZE);
+    putFrames(TEST_FRAGMENT_FRAME_COUNT * TEST_FRAGMENT_COUNT, TEST_FRAGMENT_FRAME_COUNT, TEST_FRAME_DURATION,
+              TEST_FRAGMENT_SMALL_FRAME_SIZE, pData);
+
+    // An allocation per fragment
+    EXPECT_EQ(TEST_FRAGMENT_COUNT, validateViewStorage());
+    EXPECT_EQ(TEST_FRAGMENT_COUNT, pKinesisVideoClient->pHeap->numAlloc);
+
+    // Ensure we can stream out everything
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetWindowAllocationSize(pKinesisVideoStream->pView, &viewByteSize, NULL));
+    EXPECT_EQ(viewByteSize, drainStream());
+
+    // The closed regions are freed with the items. The open one is kept for the next frames.
+    EXPECT_EQ(STATUS_SUCCESS, contentViewRemoveAll(pKinesisVideoStream->pView));
+    EXPECT_EQ(1, pKinesisVideoClient->pHeap->numAlloc);
+    EXPECT_EQ(0, pKinesisVideoStream->fragmentStorage.itemCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+    EXPECT_EQ(0, pKinesisVideoClient->pHeap->numAlloc);
+
+    MEMFREE(pData);
+}
+
+TEST_F(StreamFragmentStorageTest, putFrame_ContinuationRegions)
+{
+    PBYTE pData = (PBYTE) MEMALLOC(TEST_FRAGMENT_LARGE_FRAME_SIZE);
+    PKinesisVideoStream pKinesisVideoStream;
+    PViewItem pFirstItem, pViewItem;
+    UINT64 viewByteSize;
+    UINT32 i;
+
+    ReadyStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    // The first fragment overflows the initial region
+    MEMSET(pData, 0x55, TEST_FRAGMENT_LARGE_FRAME_SIZE);
+    putFrames(TEST_FRAGMENT_FRAME_COUNT * TEST_FRAGMENT_COUNT, TEST_FRAGMENT_FRAME_COUNT, TEST_FRAME_DURATION,
+              TEST_FRAGMENT_LARGE_FRAME_SIZE, pData);
+
+    EXPECT_LT(TEST_FRAGMENT_COUNT, validateViewStorage());
+
+    // The following fragments are sized from the first one and fit into a single region
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetItemAt(pKinesisVideoStream->pView, TEST_FRAGMENT_FRAME_COUNT, &pFirstItem));
+    EXPECT_TRUE(CHECK_ITEM_FRAGMENT_START(pFirstItem->flags));
+    for (i = 1; i < TEST_FRAGMENT_FRAME_COUNT; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, contentViewGetItemAt(pKinesisVideoStream->pView, TEST_FRAGMENT_FRAME_COUNT + i, &pViewItem));
+        EXPECT_EQ(pFirstItem->handle, pViewItem->handle);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetWindowAllocationSize(pKinesisVideoStream->pView, &viewByteSize, NULL));
+    EXPECT_EQ(viewByteSize, drainStream());
+
+    MEMFREE(pData);
+}
+
+TEST_F(StreamFragmentStorageTest, getStreamDataSpan_PinnedRegionOutlivesItems)
+{
+    PBYTE pData = (PBYTE) MEMALLOC(TEST_FRAGMENT_SMALL_FRAME_SIZE);
+    PKinesisVideoClient pKinesisVideoClient = FROM_CLIENT_HANDLE(mClientHandle);
+    PKinesisVideoStream pKinesisVideoStream;
+    StreamDataSpan span;
+    UINT64 clientStreamHandle;
+    PViewItem pViewItem;
+    PBYTE pRegion;
+    UINT32 regionSize;
+
+    ReadyStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    MEMSET(pData, 0x55, TEST_FRAGMENT_SMALL_FRAME_SIZE);
+    putFrames(TEST_FRAGMENT_FRAME_COUNT * TEST_FRAGMENT_COUNT, TEST_FRAGMENT_FRAME_COUNT, TEST_FRAME_DURATION,
+              TEST_FRAGMENT_SMALL_FRAME_SIZE, pData);
+
+    // Consume the first item and pin the second which shares the region
+    EXPECT_EQ(STATUS_SUCCESS, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, MAX_UINT32, &span));
+    EXPECT_EQ(STATUS_SUCCESS, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken));
+    EXPECT_EQ(STATUS_SUCCESS, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, MAX_UINT32, &span));
+
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetItemAt(pKinesisVideoStream->pView, 1, &pViewItem));
+    EXPECT_EQ(pViewItem->handle, pKinesisVideoStream->pinnedViewItem.handle);
+    EXPECT_EQ(pViewItem->length, span.size);
+    EXPECT_EQ(STATUS_SUCCESS, heapMap(pKinesisVideoClient->pHeap, pViewItem->handle, (PVOID*) &pRegion, &regionSize));
+    EXPECT_EQ(pRegion + pViewItem->allocationOffset, span.pData);
+    EXPECT_EQ(STATUS_SUCCESS, heapUnmap(pKinesisVideoClient->pHeap, pRegion));
+
+    // The region stays allocated until the span is released
+    EXPECT_EQ(STATUS_SUCCESS, contentViewRemoveAll(pKinesisVideoStream->pView));
+    EXPECT_EQ(2, pKinesisVideoClient->pHeap->numAlloc);
+    EXPECT_EQ(0, MEMCMP(span.pData + span.size - TEST_FRAGMENT_SMALL_FRAME_SIZE, pData, TEST_FRAGMENT_SMALL_FRAME_SIZE));
+    EXPECT_EQ(STATUS_SUCCESS, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken));
+    EXPECT_EQ(1, pKinesisVideoClient->pHeap->numAlloc);
+
+    MEMFREE(pData);
+}
+
+TEST_F(StreamFragmentStorageTest, benchmark_StorageOverheadAndThroughput)
+{
+    UINT32 frameRates[] = {1, 30, 120};
+    UINT32 i;
+
+    for (i = 0; i < ARRAY_SIZE(frameRates); i++) {
+        runStorageBenchmark(FALSE, frameRates[i]);
+        runStorageBenchmark(TRUE, frameRates[i]);
+    }
+}
@@ -0,0 +1,467 @@
+#include "ClientTestFixture.h"
+
+#define TEST_REFERENCE_FRAME_COUNT              50
+#define TEST_REFERENCE_FRAME_SIZE               1000
+#define TEST_REFERENCE_KEY_FRAME_INTERVAL       10
+#define TEST_REFERENCE_RANDOM_SEED              12345
+#define TEST_REFERENCE_STREAM_BUFFER_SIZE       (2 * TEST_REFERENCE_FRAME_COUNT * TEST_REFERENCE_FRAME_SIZE)
+
+#define REFERENCE_BENCHMARK_STORAGE_SIZE        (64 * 1024 * 1024)
+#define REFERENCE_BENCHMARK_FRAME_COUNT         300
+#define REFERENCE_BENCHMARK_FRAME_SIZE          (64 * 1024)
+
+class StreamFrameReferenceTest : public ClientTestBase {
+protected:
+    StreamFrameReferenceTest() : mReleaseCount(0), mReleasedSize(0)
+    {
+        MEMSET(mReleased, 0x00, SIZEOF(mReleased));
+    }
+
+    virtual void SetUp()
+    {
+        UINT32 i;
+
+        ClientTestBase::SetUp();
+        mStreamInfo.streamCaps.keyFrameFragmentation = TRUE;
+
+        for (i = 0; i < TEST_REFERENCE_FRAME_COUNT * TEST_REFERENCE_FRAME_SIZE; i++) {
+            mFrameData[i] = (BYTE) (i / TEST_REFERENCE_FRAME_SIZE + i);
+        }
+    }
+
+    static STATUS frameDataReleaseFunc(UINT64 customData, PBYTE pFrameData, UINT32 size)
+    {
+        StreamFrameReferenceTest* pTest = (StreamFrameReferenceTest*) customData;
+        UINT32 index = (UINT32) ((pFrameData - pTest->mFrameData) / TEST_REFERENCE_FRAME_SIZE);
+
+        // Each frame is released exactly once without holding any of the locks
+        EXPECT_EQ(pTest->mLockMutexFuncCount, pTest->mUnlockMutexFuncCount);
+        EXPECT_GT(TEST_REFERENCE_FRAME_COUNT, index);
+        EXPECT_FALSE(pTest->mReleased[index]);
+        pTest->mReleased[index] = TRUE;
+        pTest->mReleaseCount++;
+        pTest->mReleasedSize += size;
+
+        return STATUS_SUCCESS;
+    }
+
+    static STATUS countingReleaseFunc(UINT64 customData, PBYTE pFrameData, UINT32 size)
+    {
+        StreamFrameReferenceTest* pTest = (StreamFrameReferenceTest*) customData;
+
+        UNUSED_PARAM(pFrameData);
+        pTest->mReleaseCount++;
+        pTest->mReleasedSize += size;
+
+        return STATUS_SUCCESS;
+    }
+
+    /**
+     * Puts the frame with the given index either by copying or by referencing its data
+     */
+    STATUS putFrame(UINT32 index, BOOL reference, UINT64 frameDuration = TEST_FRAME_DURATION)
+    {
+        Frame frame;
+
+        frame.index = index;
+        frame.decodingTs = frame.presentationTs = index * frameDuration;
+        frame.duration = frameDuration;
+        frame.size = TEST_REFERENCE_FRAME_SIZE;
+        frame.frameData = mFrameData + (index % TEST_REFERENCE_FRAME_COUNT) * TEST_REFERENCE_FRAME_SIZE;
+        frame.flags = index % TEST_REFERENCE_KEY_FRAME_INTERVAL == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+
+        return reference ? putKinesisVideoFrameReference(mStreamHandle, &frame, frameDataReleaseFunc, (UINT64) this) :
+               putKinesisVideoFrame(mStreamHandle, &frame);
+    }
+
+    /**
+     * Reads the stream data into the buffer in chunks of the given size until no more data is available
+     */
+    UINT32 readStream(PBYTE pBuffer, UINT32 bufferSize, UINT32 chunkSize, UINT32 maxSize = MAX_UINT32)
+    {
+        UINT32 filledSize, totalSize = 0;
+        UINT64 clientStreamHandle;
+        STATUS retStatus;
+
+        do {
+            filledSize = 0;
+            retStatus = getKinesisVideoStreamData(mStreamHandle, &clientStreamHandle, pBuffer + totalSize,
+                                                  MIN(chunkSize, bufferSize - totalSize), &filledSize);
+            EXPECT_TRUE(retStatus == STATUS_SUCCESS || retStatus == STATUS_NO_MORE_DATA_AVAILABLE ||
+                        retStatus == STATUS_END_OF_STREAM);
+            totalSize += filledSize;
+        } while (retStatus == STATUS_SUCCESS && totalSize < maxSize);
+
+        return totalSize;
+    }
+
+    /**
+     * Puts the frames, streams out a part of them, re-connects and streams out the rest.
+     * The MKV generator is seeded so the copied and the referenced streams are identical.
+     */
+    UINT32 putAndReconnect(BOOL reference, PBYTE pBuffer)
+    {
+        UINT32 i, size;
+
+        ReadyStream();
+        SRAND(TEST_REFERENCE_RANDOM_SEED);
+
+        for (i = 0; i < TEST_REFERENCE_FRAME_COUNT / 2; i++) {
+            EXPECT_EQ(STATUS_SUCCESS, putFrame(i, reference, TEST_LONG_FRAME_DURATION));
+        }
+
+        // Stream out a part of the second fragment and drop the connection
+        EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+        size = readStream(pBuffer, TEST_REFERENCE_STREAM_BUFFER_SIZE, 777, 15 * TEST_REFERENCE_FRAME_SIZE);
+        EXPECT_EQ(STATUS_SUCCESS, kinesisVideoStreamTerminated(mCallContext.customData, TEST_STREAMING_HANDLE, SERVICE_CALL_RESULT_OK));
+
+        // The next frame restarts the stream from the fragment start with the stream header
+        for (; i < TEST_REFERENCE_FRAME_COUNT; i++) {
+            EXPECT_EQ(STATUS_SUCCESS, putFrame(i, reference, TEST_LONG_FRAME_DURATION));
+        }
+
+        MoveFromEndpointToReady();
+        EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE + 1));
+
+        // The terminated upload handle reports the end of stream first
+        size += readStream(pBuffer + size, TEST_REFERENCE_STREAM_BUFFER_SIZE - size, 777);
+        size += readStream(pBuffer + size, TEST_REFERENCE_STREAM_BUFFER_SIZE - size, 777);
+
+        return size;
+    }
+
+    BYTE mFrameData[TEST_REFERENCE_FRAME_COUNT * TEST_REFERENCE_FRAME_SIZE];
+    BOOL mReleased[TEST_REFERENCE_FRAME_COUNT];
+    UINT32 mReleaseCount;
+    UINT64 mReleasedSize;
+};
+
+TEST_F(StreamFrameReferenceTest, putFrameReference_InvalidInput)
+{
+    Frame frames[2];
+    FrameReference frameReference = {mFrameData, TEST_REFERENCE_FRAME_SIZE, frameDataReleaseFunc, (UINT64) this};
+
+    ReadyStream();
+
+    MEMSET(frames, 0x00, SIZEOF(frames));
+    frames[0].duration = TEST_FRAME_DURATION;
+    frames[0].size = TEST_REFERENCE_FRAME_SIZE;
+    frames[0].frameData = mFrameData;
+    frames[0].flags = FRAME_FLAG_KEY_FRAME;
+
+    EXPECT_EQ(STATUS_NULL_ARG, putKinesisVideoFrameReference(INVALID_STREAM_HANDLE_VALUE, frames, frameDataReleaseFunc, (UINT64) this));
+    EXPECT_EQ(STATUS_NULL_ARG, putKinesisVideoFrameReference(mStreamHandle, NULL, frameDataReleaseFunc, (UINT64) this));
+    EXPECT_EQ(STATUS_NULL_ARG, putKinesisVideoFrameReference(mStreamHandle, frames, NULL, (UINT64) this));
+
+    // Only a single frame can be referenced at a time
+    EXPECT_EQ(STATUS_INVALID_ARG, putFrames(FROM_STREAM_HANDLE(mStreamHandle), frames, 2, &frameReference, NULL));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+    EXPECT_EQ(0, mReleaseCount);
+}
+
+TEST_F(StreamFrameReferenceTest, putFrameReference_NalsAdaptationNotSupported)
+{
+    PKinesisVideoClient pKinesisVideoClient = FROM_CLIENT_HANDLE(mClientHandle);
+
+    mStreamInfo.streamCaps.nalAdaptationFlags = NAL_ADAPTATION_ANNEXB_NALS;
+    ReadyStream();
+
+    // The caller keeps the ownership of the frame data on failure
+    EXPECT_EQ(STATUS_MKV_FRAME_HEADER_NALS_ADAPTATION, putFrame(0, TRUE));
+    EXPECT_EQ(0, mReleaseCount);
+    EXPECT_EQ(0, pKinesisVideoClient->pHeap->numAlloc);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+    EXPECT_EQ(0, mReleaseCount);
+}
+
+TEST_F(StreamFrameReferenceTest, putFrameReference_MatchesCopiedStream)
+{
+    PKinesisVideoClient pKinesisVideoClient = FROM_CLIENT_HANDLE(mClientHandle);
+    PKinesisVideoStream pKinesisVideoStream;
+    PBYTE pCopied = (PBYTE) MEMALLOC(TEST_REFERENCE_STREAM_BUFFER_SIZE);
+    PBYTE pReferenced = (PBYTE) MEMALLOC(TEST_REFERENCE_STREAM_BUFFER_SIZE);
+    PViewItem pViewItem;
+    UINT64 viewByteSize, heapSize;
+    UINT32 i, copiedSize, referencedSize;
+
+    // Copied
+    ReadyStream();
+    SRAND(TEST_REFERENCE_RANDOM_SEED);
+    for (i = 0; i < TEST_REFERENCE_FRAME_COUNT; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, putFrame(i, FALSE));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+    heapSize = pKinesisVideoClient->pHeap->heapSize;
+    copiedSize = readStream(pCopied, TEST_REFERENCE_STREAM_BUFFER_SIZE, 1500);
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+    mDescribeStreamFuncCount = 0;
+    mGetStreamingEndpointFuncCount = 0;
+    mGetStreamingTokenFuncCount = 0;
+
+    // Referenced
+    ReadyStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+    SRAND(TEST_REFERENCE_RANDOM_SEED);
+    for (i = 0; i < TEST_REFERENCE_FRAME_COUNT; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, putFrame(i, TRUE));
+        EXPECT_EQ(STATUS_SUCCESS, contentViewGetHead(pKinesisVideoStream->pView, &pViewItem));
+        EXPECT_TRUE(CHECK_ITEM_FRAME_REFERENCE(pViewItem->flags));
+        EXPECT_EQ(GET_ITEM_DATA_OFFSET(pViewItem->flags) + TEST_REFERENCE_FRAME_SIZE, pViewItem->length);
+    }
+
+    // The view accounts for the referenced frame data while the storage holds the headers only
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetWindowAllocationSize(pKinesisVideoStream->pView, &viewByteSize, NULL));
+    EXPECT_EQ(copiedSize, viewByteSize);
+    EXPECT_GT(heapSize - TEST_REFERENCE_FRAME_COUNT * (TEST_REFERENCE_FRAME_SIZE - SIZEOF(FrameReference)) / 2,
+              pKinesisVideoClient->pHeap->heapSize);
+
+    EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+    referencedSize = readStream(pReferenced, TEST_REFERENCE_STREAM_BUFFER_SIZE, 1500);
+
+    EXPECT_EQ(copiedSize, referencedSize);
+    EXPECT_EQ(0, MEMCMP(pCopied, pReferenced, copiedSize));
+
+    // The frames are released with the stream
+    EXPECT_EQ(0, mReleaseCount);
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+    EXPECT_EQ(TEST_REFERENCE_FRAME_COUNT, mReleaseCount);
+    EXPECT_EQ(TEST_REFERENCE_FRAME_COUNT * TEST_REFERENCE_FRAME_SIZE, mReleasedSize);
+    EXPECT_EQ(0, pKinesisVideoClient->pHeap->numAlloc);
+
+    MEMFREE(pCopied);
+    MEMFREE(pReferenced);
+}
+
+TEST_F(StreamFrameReferenceTest, putFrameReference_ReleasedOnEviction)
+{
+    PKinesisVideoStream pKinesisVideoStream;
+    PViewItem pViewItem;
+    UINT64 tailIndex, headIndex;
+    UINT32 i, frameCount;
+
+    // Buffer for a part of the frames only
+    mStreamInfo.streamCaps.bufferDuration = mStreamInfo.streamCaps.replayDuration = 20 * TEST_LONG_FRAME_DURATION;
+    ReadyStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    frameCount = TEST_REFERENCE_FRAME_COUNT;
+    for (i = 0; i < frameCount; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, putFrame(i, TRUE, TEST_LONG_FRAME_DURATION));
+    }
+
+    // The purged frames are released in order
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetTail(pKinesisVideoStream->pView, &pViewItem));
+    tailIndex = pViewItem->index;
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetHead(pKinesisVideoStream->pView, &pViewItem));
+    headIndex = pViewItem->index;
+
+    EXPECT_NE(0, mReleaseCount);
+    EXPECT_EQ(frameCount - (headIndex - tailIndex + 1), mReleaseCount);
+    for (i = 0; i < frameCount; i++) {
+        EXPECT_EQ(i < mReleaseCount, mReleased[i]);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+    EXPECT_EQ(frameCount, mReleaseCount);
+}
+
+TEST_F(StreamFrameReferenceTest, getStreamDataSpan_HeaderThenFrameData)
+{
+    PKinesisVideoStream pKinesisVideoStream;
+    PViewItem pViewItem;
+    StreamDataSpan span;
+    UINT64 clientStreamHandle;
+    UINT32 i, dataOffset;
+
+    mStreamInfo.streamCaps.bufferDuration = mStreamInfo.streamCaps.replayDuration = 20 * TEST_LONG_FRAME_DURATION;
+    ReadyStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    EXPECT_EQ(STATUS_SUCCESS, putFrame(0, TRUE, TEST_LONG_FRAME_DURATION));
+    EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetHead(pKinesisVideoStream->pView, &pViewItem));
+    dataOffset = GET_ITEM_DATA_OFFSET(pViewItem->flags);
+
+    // The header is returned from the storage
+    EXPECT_EQ(STATUS_SUCCESS, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, MAX_UINT32, &span));
+    EXPECT_EQ(dataOffset, span.size);
+    EXPECT_TRUE(span.pData < mFrameData || span.pData >= mFrameData + TEST_REFERENCE_FRAME_COUNT * TEST_REFERENCE_FRAME_SIZE);
+    EXPECT_EQ(STATUS_SUCCESS, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken));
+
+    // The frame data is returned from the caller buffer without a copy
+    EXPECT_EQ(STATUS_SUCCESS, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, MAX_UINT32, &span));
+    EXPECT_EQ(mFrameData, span.pData);
+    EXPECT_EQ(TEST_REFERENCE_FRAME_SIZE, span.size);
+
+    // Purge the pinned frame. The release is deferred until the span is released.
+    for (i = 1; i < TEST_REFERENCE_FRAME_COUNT; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, putFrame(i, TRUE, TEST_LONG_FRAME_DURATION));
+    }
+
+    EXPECT_NE(0, mReleaseCount);
+    EXPECT_FALSE(mReleased[0]);
+    EXPECT_TRUE(mReleased[1]);
+
+    EXPECT_EQ(STATUS_SUCCESS, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken));
+    EXPECT_TRUE(mReleased[0]);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+    EXPECT_EQ(TEST_REFERENCE_FRAME_COUNT, mReleaseCount);
+}
+
+TEST_F(StreamFrameReferenceTest, putFrameReference_ReconnectMatchesCopiedStream)
+{
+    PKinesisVideoClient pKinesisVideoClient = FROM_CLIENT_HANDLE(mClientHandle);
+    PBYTE pCopied = (PBYTE) MEMALLOC(TEST_REFERENCE_STREAM_BUFFER_SIZE);
+    PBYTE pReferenced = (PBYTE) MEMALLOC(TEST_REFERENCE_STREAM_BUFFER_SIZE);
+    UINT32 copiedSize, referencedSize;
+
+    copiedSize = putAndReconnect(FALSE, pCopied);
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+    mDescribeStreamFuncCount = 0;
+    mGetStreamingEndpointFuncCount = 0;
+    mGetStreamingTokenFuncCount = 0;
+
+    // The stream start fix-ups move the headers and the references without releasing the frames
+    referencedSize = putAndReconnect(TRUE, pReferenced);
+    EXPECT_EQ(0, mReleaseCount);
+
+    EXPECT_LT(TEST_REFERENCE_FRAME_COUNT * TEST_REFERENCE_FRAME_SIZE, copiedSize);
+    EXPECT_EQ(copiedSize, referencedSize);
+    EXPECT_EQ(0, MEMCMP(pCopied, pReferenced, copiedSize));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+    EXPECT_EQ(TEST_REFERENCE_FRAME_COUNT, mReleaseCount);
+    EXPECT_EQ(0, pKinesisVideoClient->pHeap->numAlloc);
+
+    MEMFREE(pCopied);
+    MEMFREE(pReferenced);
+}
+
+TEST_F(StreamFrameReferenceTest, putFrameReference_PinnedReferenceNotMovedOnReconnect)
+{
+    PKinesisVideoStream pKinesisVideoStream;
+    PViewItem pViewItem;
+    StreamDataSpan span;
+    UINT64 clientStreamHandle;
+    ALLOCATION_HANDLE pinnedHandle;
+    PBYTE pAlloc;
+    UINT32 i, allocSize;
+    PHeap pHeap;
+
+    ReadyStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    for (i = 0; i < 2 * TEST_REFERENCE_KEY_FRAME_INTERVAL; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, putFrame(i, TRUE, TEST_LONG_FRAME_DURATION));
+    }
+
+    // Pin the frame data of the second fragment start
+    EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+    do {
+        EXPECT_EQ(STATUS_SUCCESS, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, MAX_UINT32, &span));
+        if (span.pData == mFrameData + TEST_REFERENCE_KEY_FRAME_INTERVAL * TEST_REFERENCE_FRAME_SIZE) {
+            break;
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken));
+    } while (TRUE);
+
+    pinnedHandle = pKinesisVideoStream->pinnedViewItem.handle;
+
+    // Re-connect from the pinned frame. The frame data is copied as the pinned storage keeps the reference.
+    EXPECT_EQ(STATUS_SUCCESS, contentViewSetCurrentIndex(pKinesisVideoStream->pView, TEST_REFERENCE_KEY_FRAME_INTERVAL));
+    EXPECT_EQ(STATUS_SUCCESS, streamStartFixupOnReconnect(pKinesisVideoStream));
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetItemAt(pKinesisVideoStream->pView, TEST_REFERENCE_KEY_FRAME_INTERVAL, &pViewItem));
+    EXPECT_NE(pinnedHandle, pViewItem->handle);
+    EXPECT_FALSE(CHECK_ITEM_FRAME_REFERENCE(pViewItem->flags));
+    EXPECT_TRUE(CHECK_ITEM_STREAM_START(pViewItem->flags));
+
+    pHeap = getStreamStorageHeap(pKinesisVideoStream, pViewItem->flags);
+    EXPECT_EQ(STATUS_SUCCESS, heapMap(pHeap, pViewItem->handle, (PVOID*) &pAlloc, &allocSize));
+    EXPECT_EQ(pViewItem->length, allocSize);
+    EXPECT_EQ(0, MEMCMP(pAlloc + allocSize - TEST_REFERENCE_FRAME_SIZE, span.pData, TEST_REFERENCE_FRAME_SIZE));
+    EXPECT_EQ(STATUS_SUCCESS, heapUnmap(pHeap, pAlloc));
+
+    // The frame is released once the span is released
+    EXPECT_FALSE(mReleased[TEST_REFERENCE_KEY_FRAME_INTERVAL]);
+    EXPECT_EQ(STATUS_SUCCESS, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken));
+    EXPECT_TRUE(mReleased[TEST_REFERENCE_KEY_FRAME_INTERVAL]);
+
+    // The rest of the frames are released with the stream exactly once
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+    EXPECT_EQ(2 * TEST_REFERENCE_KEY_FRAME_INTERVAL, mReleaseCount);
+}
+
+TEST_F(StreamFrameReferenceTest, putFrameReference_CopyVsReferenceThroughput)
+{
+    PBYTE pData = (PBYTE) MEMALLOC(REFERENCE_BENCHMARK_FRAME_SIZE);
+    PBYTE pBuffer = (PBYTE) MEMALLOC(REFERENCE_BENCHMARK_FRAME_SIZE);
+    PKinesisVideoClient pKinesisVideoClient;
+    UINT64 time[2], storedSize[2], streamedSize[2];
+    UINT32 i, mode, filledSize;
+    UINT64 clientStreamHandle;
+    STATUS retStatus;
+    Frame frame;
+
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoClient(&mClientHandle));
+    mDeviceInfo.storageInfo.storageSize = REFERENCE_BENCHMARK_STORAGE_SIZE;
+    EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &mClientHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createDeviceResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_DEVICE_ARN));
+    pKinesisVideoClient = FROM_CLIENT_HANDLE(mClientHandle);
+    mStreamInfo.streamCaps.bufferDuration = (REFERENCE_BENCHMARK_FRAME_COUNT + 1) * TEST_FRAME_DURATION;
+    MEMSET(pData, 0x55, REFERENCE_BENCHMARK_FRAME_SIZE);
+
+    // Copied frames first then the referenced ones. The time covers putting and streaming out the frames.
+    for (mode = 0; mode < 2; mode++) {
+        mDescribeStreamFuncCount = 0;
+        mGetStreamingEndpointFuncCount = 0;
+        mGetStreamingTokenFuncCount = 0;
+        ReadyStream();
+
+        frame.duration = TEST_FRAME_DURATION;
+        frame.size = REFERENCE_BENCHMARK_FRAME_SIZE;
+        frame.frameData = pData;
+
+        time[mode] = GETTIME();
+        for (i = 0; i < REFERENCE_BENCHMARK_FRAME_COUNT; i++) {
+            frame.index = i;
+            frame.decodingTs = frame.presentationTs = i * TEST_FRAME_DURATION;
+            frame.flags = i % 50 == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+            EXPECT_EQ(STATUS_SUCCESS, mode == 0 ? putKinesisVideoFrame(mStreamHandle, &frame) :
+                                      putKinesisVideoFrameReference(mStreamHandle, &frame, countingReleaseFunc, (UINT64) this));
+        }
+
+        storedSize[mode] = pKinesisVideoClient->pHeap->heapSize;
+        EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+
+        streamedSize[mode] = 0;
+        do {
+            retStatus = getKinesisVideoStreamData(mStreamHandle, &clientStreamHandle, pBuffer, REFERENCE_BENCHMARK_FRAME_SIZE, &filledSize);
+            EXPECT_TRUE(retStatus == STATUS_SUCCESS || retStatus == STATUS_NO_MORE_DATA_AVAILABLE);
+            streamedSize[mode] += filledSize;
+        } while (retStatus == STATUS_SUCCESS);
+
+        time[mode] = GETTIME() - time[mode];
+        EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+    }
+
+    // The referenced frame data is copied only when streamed out
+    EXPECT_EQ(streamedSize[0], streamedSize[1]);
+    EXPECT_LT(storedSize[1] * 100, storedSize[0]);
+    EXPECT_EQ(REFERENCE_BENCHMARK_FRAME_COUNT, mReleaseCount);
+
+    DLOGI("Streamed %u frames of %u bytes. Copied: %" PRIu64 " bytes stored, %" PRIu64 " payload bytes copied, %" PRIu64
+          " MB/s. Referenced: %" PRIu64 " bytes stored, %" PRIu64 " payload bytes copied, %" PRIu64 " MB/s.",
+          REFERENCE_BENCHMARK_FRAME_COUNT, REFERENCE_BENCHMARK_FRAME_SIZE,
+          storedSize[0], 2 * (UINT64) REFERENCE_BENCHMARK_FRAME_COUNT * REFERENCE_BENCHMARK_FRAME_SIZE,
+          streamedSize[0] * HUNDREDS_OF_NANOS_IN_A_SECOND / MAX(time[0], 1) / (1024 * 1024),
+          storedSize[1], (UINT64) REFERENCE_BENCHMARK_FRAME_COUNT * REFERENCE_BENCHMARK_FRAME_SIZE,
+          streamedSize[1] * HUNDREDS_OF_NANOS_IN_A_SECOND / MAX(time[1], 1) / (1024 * 1024));
+
+    MEMFREE(pData);
+    MEMFREE(pBuffer);
+}
@@ -0,0 +1,202 @@
+#include "ClientTestFixture.h"
+
+#define TEST_VIDEO_TRACK_ID                 1
+#define TEST_AUDIO_TRACK_ID                 2
+#define TEST_VIDEO_FRAME_DURATION           (40 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define TEST_AUDIO_FRAME_DURATION           (20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define TEST_MULTI_TRACK_FRAGMENT_DURATION  (2 * HUNDREDS_OF_NANOS_IN_A_SECOND)
+
+class StreamMultiTrackTest : public ClientTestBase {
+protected:
+    virtual void SetUp()
+    {
+        ClientTestBase::SetUp();
+
+        MEMSET(mTrackInfos, 0x00, SIZEOF(mTrackInfos));
+        mTrackInfos[0].trackId = TEST_VIDEO_TRACK_ID;
+        STRCPY(mTrackInfos[0].contentType, "video/h264");
+        STRCPY(mTrackInfos[0].codecId, TEST_CODEC_ID);
+        STRCPY(mTrackInfos[0].trackName, TEST_TRACK_NAME);
+
+        mTrackInfos[1].trackId = TEST_AUDIO_TRACK_ID;
+        STRCPY(mTrackInfos[1].contentType, "audio/aac");
+        STRCPY(mTrackInfos[1].codecId, "A_AAC");
+        STRCPY(mTrackInfos[1].trackName, "audio");
+        mTrackInfos[1].codecPrivateData = mAudioCpd;
+        mTrackInfos[1].codecPrivateDataSize = SIZEOF(mAudioCpd);
+
+        mStreamInfo.streamCaps.keyFrameFragmentation = TRUE;
+        mStreamInfo.streamCaps.trackInfoCount = ARRAY_SIZE(mTrackInfos);
+        mStreamInfo.streamCaps.trackInfoList = mTrackInfos;
+    };
+
+    /**
+     * Puts the video and audio frames of the given duration interleaved in the decoding order.
+     * The audio frame goes first when the timestamps are equal except for the stream start.
+     */
+    VOID putInterleavedFrames(UINT64 duration)
+    {
+        UINT64 videoTs = 0, audioTs = 0;
+        UINT32 index = 0;
+        BOOL audio;
+        Frame frame;
+
+        while (videoTs < duration || audioTs < duration) {
+            audio = audioTs < duration && (audioTs < videoTs || (audioTs == videoTs && audioTs != 0));
+            frame.index = index++;
+            frame.trackId = audio ? TEST_AUDIO_TRACK_ID : TEST_VIDEO_TRACK_ID;
+            frame.decodingTs = frame.presentationTs = audio ? audioTs : videoTs;
+            frame.duration = audio ? TEST_AUDIO_FRAME_DURATION : TEST_VIDEO_FRAME_DURATION;
+            frame.flags = !audio && videoTs % TEST_MULTI_TRACK_FRAGMENT_DURATION == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+            frame.size = SIZEOF(mFrameData);
+            frame.frameData = mFrameData;
+            EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, &frame));
+
+            if (audio) {
+                audioTs += TEST_AUDIO_FRAME_DURATION;
+            } else {
+                videoTs += TEST_VIDEO_FRAME_DURATION;
+            }
+        }
+    }
+
+    TrackInfo mTrackInfos[2];
+    BYTE mAudioCpd[2] = {0x12, 0x10};
+    BYTE mFrameData[100];
+};
+
+TEST_F(StreamMultiTrackTest, createStream_TrackInfoList)
+{
+    PKinesisVideoStream pKinesisVideoStream;
+
+    // The track info list is required with the tracks
+    mStreamInfo.streamCaps.trackInfoList = NULL;
+    EXPECT_EQ(STATUS_INVALID_TRACK_INFO_LIST, createKinesisVideoStream(mClientHandle, &mStreamInfo, &mStreamHandle));
+    mStreamInfo.streamCaps.trackInfoCount = MKV_MAX_TRACK_COUNT + 1;
+    mStreamInfo.streamCaps.trackInfoList = mTrackInfos;
+    EXPECT_EQ(STATUS_INVALID_TRACK_INFO_LIST, createKinesisVideoStream(mClientHandle, &mStreamInfo, &mStreamHandle));
+
+    // The list is copied with the codec private data
+    mStreamInfo.streamCaps.trackInfoCount = ARRAY_SIZE(mTrackInfos);
+    CreateStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+    EXPECT_TRUE(IS_MULTI_TRACK_STREAM(pKinesisVideoStream));
+    EXPECT_NE(mTrackInfos, pKinesisVideoStream->streamInfo.streamCaps.trackInfoList);
+    EXPECT_EQ(TEST_AUDIO_TRACK_ID, pKinesisVideoStream->streamInfo.streamCaps.trackInfoList[1].trackId);
+    EXPECT_EQ(NULL, pKinesisVideoStream->streamInfo.streamCaps.trackInfoList[0].codecPrivateData);
+    EXPECT_NE(mAudioCpd, pKinesisVideoStream->streamInfo.streamCaps.trackInfoList[1].codecPrivateData);
+    EXPECT_EQ(0, MEMCMP(mAudioCpd, pKinesisVideoStream->streamInfo.streamCaps.trackInfoList[1].codecPrivateData, SIZEOF(mAudioCpd)));
+
+    // The codec private data of the tracks can't be changed
+    EXPECT_EQ(STATUS_MULTI_TRACK_FORMAT_CHANGE_NOT_SUPPORTED, kinesisVideoStreamFormatChanged(mStreamHandle, 0, NULL));
+}
+
+TEST_F(StreamMultiTrackTest, createStream_InvalidTrackCodecPrivateData)
+{
+    // The track codec private data is validated before the stream is allocated
+    mTrackInfos[1].codecPrivateDataSize = MKV_MAX_CODEC_PRIVATE_LEN + 1;
+    EXPECT_EQ(STATUS_MKV_INVALID_CODEC_PRIVATE_LENGTH, createKinesisVideoStream(mClientHandle, &mStreamInfo, &mStreamHandle));
+
+    // The sizes which would wrap the allocation size around
+    mTrackInfos[0].codecPrivateData = mAudioCpd;
+    mTrackInfos[0].codecPrivateDataSize = MAX_UINT32 - 100;
+    mTrackInfos[1].codecPrivateDataSize = 200;
+    EXPECT_EQ(STATUS_MKV_INVALID_CODEC_PRIVATE_LENGTH, createKinesisVideoStream(mClientHandle, &mStreamInfo, &mStreamHandle));
+
+    mTrackInfos[0].codecPrivateData = NULL;
+    mTrackInfos[0].codecPrivateDataSize = SIZEOF(mAudioCpd);
+    mTrackInfos[1].codecPrivateDataSize = SIZEOF(mAudioCpd);
+    EXPECT_EQ(STATUS_MKV_CODEC_PRIVATE_NULL, createKinesisVideoStream(mClientHandle, &mStreamInfo, &mStreamHandle));
+
+    // The stream level codec private data is validated as well
+    mTrackInfos[0].codecPrivateDataSize = 0;
+    mStreamInfo.streamCaps.codecPrivateData = NULL;
+    mStreamInfo.streamCaps.codecPrivateDataSize = SIZEOF(mAudioCpd);
+    EXPECT_EQ(STATUS_MKV_CODEC_PRIVATE_NULL, createKinesisVideoStream(mClientHandle, &mStreamInfo, &mStreamHandle));
+    EXPECT_FALSE(IS_VALID_STREAM_HANDLE(mStreamHandle));
+}
+
+TEST_F(StreamMultiTrackTest, createStream_TracksIgnoredForOlderVersion)
+{
+    PKinesisVideoStream pKinesisVideoStream;
+
+    mStreamInfo.version = STREAM_INFO_TRACKS_VERSION - 1;
+    mStreamInfo.streamCaps.trackInfoList = NULL;
+    CreateStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+    EXPECT_FALSE(IS_MULTI_TRACK_STREAM(pKinesisVideoStream));
+    EXPECT_EQ(0, pKinesisVideoStream->streamInfo.streamCaps.trackInfoCount);
+    EXPECT_EQ(NULL, pKinesisVideoStream->streamInfo.streamCaps.trackInfoList);
+}
+
+TEST_F(StreamMultiTrackTest, putFrame_InterleavedTracks)
+{
+    PKinesisVideoStream pKinesisVideoStream;
+    PViewItem pViewItem, pPrevItem = NULL;
+    UINT64 tailIndex, headIndex, curIndex, clientStreamHandle, totalSize = 0;
+    UINT32 filledSize, fragmentCount = 0;
+    STATUS retStatus;
+    BYTE getDataBuffer[10000];
+
+    ASSERT_EQ(STATUS_SUCCESS, ReadyStream());
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    putInterleavedFrames(2 * TEST_MULTI_TRACK_FRAGMENT_DURATION);
+    EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+
+    // The view items are ordered and don't overlap
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetTail(pKinesisVideoStream->pView, &pViewItem));
+    tailIndex = pViewItem->index;
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetHead(pKinesisVideoStream->pView, &pViewItem));
+    headIndex = pViewItem->index;
+    for (curIndex = tailIndex; curIndex <= headIndex; curIndex++) {
+        EXPECT_EQ(STATUS_SUCCESS, contentViewGetItemAt(pKinesisVideoStream->pView, curIndex, &pViewItem));
+        if (pPrevItem != NULL) {
+            EXPECT_LE(pPrevItem->timestamp + pPrevItem->duration, pViewItem->timestamp);
+        }
+
+        if (CHECK_ITEM_FRAGMENT_START(pViewItem->flags)) {
+            fragmentCount++;
+        }
+
+        pPrevItem = pViewItem;
+    }
+
+    EXPECT_EQ(2, fragmentCount);
+
+    do {
+        retStatus = getKinesisVideoStreamData(mStreamHandle, &clientStreamHandle, getDataBuffer, SIZEOF(getDataBuffer), &filledSize);
+        EXPECT_TRUE(retStatus == STATUS_SUCCESS || retStatus == STATUS_NO_MORE_DATA_AVAILABLE);
+        totalSize += filledSize;
+    } while (retStatus == STATUS_SUCCESS);
+
+    EXPECT_LT((headIndex - tailIndex + 1) * SIZEOF(mFrameData), totalSize);
+}
+
+TEST_F(StreamMultiTrackTest, fragmentAck_MapsToFragmentStart)
+{
+    PKinesisVideoStream pKinesisVideoStream;
+    PViewItem pViewItem, pPrevItem;
+
+    ASSERT_EQ(STATUS_SUCCESS, ReadyStream());
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    putInterleavedFrames(2 * TEST_MULTI_TRACK_FRAGMENT_DURATION);
+
+    // The audio frame of the second fragment timestamp precedes the key frame
+    EXPECT_EQ(STATUS_SUCCESS, getFragmentViewItemWithTimestamp(pKinesisVideoStream, TEST_MULTI_TRACK_FRAGMENT_DURATION, &pViewItem));
+    EXPECT_TRUE(CHECK_ITEM_FRAGMENT_START(pViewItem->flags));
+    EXPECT_EQ(TEST_MULTI_TRACK_FRAGMENT_DURATION, pViewItem->timestamp);
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetItemAt(pKinesisVideoStream->pView, pViewItem->index - 1, &pPrevItem));
+    EXPECT_EQ(TEST_MULTI_TRACK_FRAGMENT_DURATION, pPrevItem->timestamp);
+    EXPECT_FALSE(CHECK_ITEM_FRAGMENT_START(pPrevItem->flags));
+
+    EXPECT_EQ(STATUS_SUCCESS, streamFragmentReceivedAck(pKinesisVideoStream, TEST_MULTI_TRACK_FRAGMENT_DURATION));
+    EXPECT_TRUE(CHECK_ITEM_RECEIVED_ACK(pViewItem->flags));
+    EXPECT_FALSE(CHECK_ITEM_RECEIVED_ACK(pPrevItem->flags));
+
+    // The first fragment starts with the key frame
+    EXPECT_EQ(STATUS_SUCCESS, getFragmentViewItemWithTimestamp(pKinesisVideoStream, 0, &pViewItem));
+    EXPECT_TRUE(CHECK_ITEM_FRAGMENT_START(pViewItem->flags));
+    EXPECT_EQ(0, pViewItem->timestamp);
+}
@@ -1,6 +1,20 @@
 #include "ClientTestFixture.h"
 
+#define TEST_CONTENTION_FRAME_COUNT                 5000
+#define TEST_CONTENTION_FRAME_RATE                  240
+#define TEST_CONTENTION_STORAGE_SIZE                (25 * MIN_STORAGE_ALLOCATION_SIZE)
+#define TEST_CONTENTION_STREAM_ARENA_RATIO          60
+#define TEST_CONTENTION_MAX_STREAM_COUNT            8
+
 class StreamParallelTest : public ClientTestBase {
+public:
+    PVOID contentionProducerRoutine(UINT64);
+    PVOID contentionConsumerRoutine(UINT64);
+
+protected:
+    VOID recreateClient(UINT32);
+    VOID createReadyStreams(UINT32);
+    UINT64 runContention(UINT32);
 };
 
 StreamParallelTest* gParallelTest = NULL;
@@ -17,6 +31,18 @@ PVOID staticConsumerRoutine(PVOID arg)
     return pTest->basicConsumerRoutine((UINT64) arg);
 }
 
+PVOID staticContentionProducerRoutine(PVOID arg)
+{
+    StreamParallelTest* pTest = gParallelTest;
+    return pTest->contentionProducerRoutine((UINT64) arg);
+}
+
+PVOID staticContentionConsumerRoutine(PVOID arg)
+{
+    StreamParallelTest* pTest = gParallelTest;
+    return pTest->contentionConsumerRoutine((UINT64) arg);
+}
+
 PVOID ClientTestBase::basicProducerRoutine(UINT64 streamId)
 {
     UINT32 index = 0;
@@ -192,3 +218,169 @@ TEST_F(StreamParallelTest, putFrame_BasicParallelPutGet)
         EXPECT_EQ(0, pthread_join(mConsumerThreads[index], NULL));
     }
 }
+
+/**
+ * Puts the frames as fast as possible. The number of frames fits in the view so nothing is evicted.
+ */
+PVOID StreamParallelTest::contentionProducerRoutine(UINT64 streamId)
+{
+    UINT32 index;
+    BYTE tempBuffer[1000];
+    Frame frame;
+    STREAM_HANDLE streamHandle = mStreamHandles[streamId];
+
+    while(!mStartThreads) {
+        usleep(10);
+    }
+
+    frame.duration = TEST_FRAME_DURATION;
+    frame.size = SIZEOF(tempBuffer);
+    frame.frameData = tempBuffer;
+    MEMSET(tempBuffer, 0x55, SIZEOF(tempBuffer));
+
+    for (index = 0; index < TEST_CONTENTION_FRAME_COUNT; index++) {
+        frame.index = index;
+        frame.decodingTs = frame.presentationTs = index * TEST_FRAME_DURATION;
+        frame.flags = index % 30 == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+        EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(streamHandle, &frame));
+
+        if (index == 5) {
+            EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCustomDatas[streamId], SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Drains the stream data while the producers are running
+ */
+PVOID StreamParallelTest::contentionConsumerRoutine(UINT64 streamId)
+{
+    UINT32 filledSize;
+    BYTE getDataBuffer[20000];
+    UINT64 clientStreamHandle;
+    STATUS retStatus;
+    STREAM_HANDLE streamHandle = mStreamHandles[streamId];
+
+    while(!mStartThreads) {
+        usleep(10);
+    }
+
+    while(!mTerminate) {
+        clientStreamHandle = 0;
+        retStatus = getKinesisVideoStreamData(streamHandle, &clientStreamHandle, getDataBuffer, SIZEOF(getDataBuffer),
+                                              &filledSize);
+        EXPECT_TRUE(retStatus == STATUS_SUCCESS || retStatus == STATUS_NO_MORE_DATA_AVAILABLE ||
+                    retStatus == STATUS_END_OF_STREAM);
+
+        if (retStatus != STATUS_SUCCESS) {
+            usleep(100);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Re-creates the client with the given stream arena ratio
+ */
+VOID StreamParallelTest::recreateClient(UINT32 streamArenaRatio)
+{
+    if (IS_VALID_CLIENT_HANDLE(mClientHandle)) {
+        EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoClient(&mClientHandle));
+    }
+
+    mDeviceInfo.storageInfo.storageSize = TEST_CONTENTION_STORAGE_SIZE;
+    mDeviceInfo.storageInfo.streamArenaRatio = streamArenaRatio;
+    EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &mClientHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createDeviceResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_DEVICE_ARN));
+    EXPECT_TRUE(mClientReady);
+}
+
+/**
+ * Creates the streams and moves them to the ready state
+ */
+VOID StreamParallelTest::createReadyStreams(UINT32 streamCount)
+{
+    CHAR streamName[MAX_STREAM_NAME_LEN];
+
+    mStreamInfo.streamCaps.frameRate = TEST_CONTENTION_FRAME_RATE;
+
+    for (mStreamCount = 0; mStreamCount < streamCount; mStreamCount++) {
+        sprintf(streamName, "%s %d", TEST_STREAM_NAME, mStreamCount);
+        STRCPY(mStreamInfo.name, streamName);
+        EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoStream(mClientHandle, &mStreamInfo, &mStreamHandles[mStreamCount]));
+        mCustomDatas[mStreamCount] = mCallContext.customData;
+
+        mStreamDescription.version = STREAM_DESCRIPTION_CURRENT_VERSION;
+        STRCPY(mStreamDescription.deviceName, TEST_DEVICE_NAME);
+        STRCPY(mStreamDescription.streamName, streamName);
+        STRCPY(mStreamDescription.contentType, TEST_CONTENT_TYPE);
+        STRCPY(mStreamDescription.streamArn, TEST_STREAM_ARN);
+        STRCPY(mStreamDescription.updateVersion, TEST_UPDATE_VERSION);
+        mStreamDescription.streamStatus = STREAM_STATUS_ACTIVE;
+        mStreamDescription.creationTime = GETTIME();
+        EXPECT_EQ(STATUS_SUCCESS, describeStreamResultEvent(mCustomDatas[mStreamCount], SERVICE_CALL_RESULT_OK, &mStreamDescription));
+        EXPECT_EQ(STATUS_SUCCESS, getStreamingEndpointResultEvent(mCustomDatas[mStreamCount], SERVICE_CALL_RESULT_OK,
+                                                                  TEST_STREAMING_ENDPOINT));
+        EXPECT_EQ(STATUS_SUCCESS, getStreamingTokenResultEvent(mCustomDatas[mStreamCount],
+                                                               SERVICE_CALL_RESULT_OK,
+                                                               (PBYTE) TEST_STREAMING_TOKEN,
+                                                               SIZEOF(TEST_STREAMING_TOKEN),
+                                                               TEST_AUTH_EXPIRATION));
+    }
+}
+
+/**
+ * Runs a producer and a consumer thread per stream and returns the overall put frame throughput in frames per second
+ */
+UINT64 StreamParallelTest::runContention(UINT32 streamCount)
+{
+    UINT32 index;
+    UINT64 start, duration;
+
+    mTerminate = FALSE;
+    mStartThreads = FALSE;
+    gParallelTest = this;
+
+    createReadyStreams(streamCount);
+
+    for (index = 0; index < streamCount; index++) {
+        EXPECT_EQ(0, pthread_create(&mProducerThreads[index], NULL, staticContentionProducerRoutine, (PVOID) (UINT64) index));
+        EXPECT_EQ(0, pthread_create(&mConsumerThreads[index], NULL, staticContentionConsumerRoutine, (PVOID) (UINT64) index));
+    }
+
+    start = GETTIME();
+    mStartThreads = TRUE;
+
+    for (index = 0; index < streamCount; index++) {
+        EXPECT_EQ(0, pthread_join(mProducerThreads[index], NULL));
+    }
+
+    duration = GETTIME() - start;
+
+    mTerminate = TRUE;
+    for (index = 0; index < streamCount; index++) {
+        EXPECT_EQ(0, pthread_join(mConsumerThreads[index], NULL));
+        EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandles[index]));
+    }
+
+    return (UINT64) streamCount * TEST_CONTENTION_FRAME_COUNT * HUNDREDS_OF_NANOS_IN_A_SECOND / MAX(duration, 1);
+}
+
+TEST_F(StreamParallelTest, putFrame_ContentionScaling)
+{
+    UINT32 streamCount, streamArenaRatio;
+    UINT64 throughput;
+
+    for (streamArenaRatio = 0; streamArenaRatio <= TEST_CONTENTION_STREAM_ARENA_RATIO; streamArenaRatio += TEST_CONTENTION_STREAM_ARENA_RATIO) {
+        recreateClient(streamArenaRatio);
+
+        for (streamCount = 1; streamCount <= TEST_CONTENTION_MAX_STREAM_COUNT; streamCount *= 2) {
+            throughput = runContention(streamCount);
+            DLOGI("Stream arenas %s, %u streams: %" PRIu64 " frames/sec overall, %" PRIu64 " frames/sec per stream",
+                  streamArenaRatio == 0 ? "disabled" : "enabled", streamCount, throughput, throughput / streamCount);
+        }
+    }
+}
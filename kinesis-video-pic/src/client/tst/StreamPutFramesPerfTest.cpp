@@ -0,0 +1,90 @@
+#include "ClientTestFixture.h"
+
+#define PUT_FRAMES_PERF_FRAME_COUNT         20000
+#define PUT_FRAMES_PERF_FRAME_SIZE          200
+#define PUT_FRAMES_PERF_BATCH_SIZE          50
+
+class StreamPutFramesPerfTest : public ClientTestBase {
+protected:
+    /**
+     * Puts audio-like small frames into a streaming stream with the given batch size
+     * and returns the elapsed time. Batch size of 0 uses the per-frame API.
+     */
+    UINT64 putFrameTrace(UINT32 batchSize)
+    {
+        UINT32 i, j, count;
+        BYTE frameBuffer[PUT_FRAMES_PERF_FRAME_SIZE];
+        Frame frames[PUT_FRAMES_PERF_BATCH_SIZE];
+        UINT64 start;
+
+        MEMSET(frameBuffer, 0x55, SIZEOF(frameBuffer));
+
+        // Put the first frame to start streaming
+        frames[0].index = 0;
+        frames[0].decodingTs = frames[0].presentationTs = 0;
+        frames[0].duration = TEST_FRAME_DURATION;
+        frames[0].size = SIZEOF(frameBuffer);
+        frames[0].frameData = frameBuffer;
+        frames[0].flags = FRAME_FLAG_KEY_FRAME;
+        EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, &frames[0]));
+        EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+
+        start = GETTIME();
+        for (i = 1; i < PUT_FRAMES_PERF_FRAME_COUNT; i += count) {
+            count = MIN(MAX(batchSize, 1), PUT_FRAMES_PERF_FRAME_COUNT - i);
+            for (j = 0; j < count; j++) {
+                frames[j].index = i + j;
+                frames[j].decodingTs = frames[j].presentationTs = (UINT64) (i + j) * TEST_FRAME_DURATION;
+                frames[j].duration = TEST_FRAME_DURATION;
+                frames[j].size = SIZEOF(frameBuffer);
+                frames[j].frameData = frameBuffer;
+                frames[j].flags = (i + j) % 100 == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+            }
+
+            if (batchSize == 0) {
+                EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, frames));
+            } else {
+                EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrames(mStreamHandle, frames, count, NULL));
+            }
+        }
+
+        return GETTIME() - start;
+    }
+};
+
+TEST_F(StreamPutFramesPerfTest, putFrames_BatchVsPerFrameThroughput)
+{
+    UINT64 perFrameTime, batchTime;
+    UINT32 perFrameLocks, batchLocks, perFrameNotifications, batchNotifications;
+
+    // Per-frame
+    ReadyStream();
+    mLockMutexFuncCount = 0;
+    mStreamDataAvailableFuncCount = 0;
+    perFrameTime = putFrameTrace(0);
+    perFrameLocks = mLockMutexFuncCount;
+    perFrameNotifications = mStreamDataAvailableFuncCount;
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&mStreamHandle));
+    mDescribeStreamFuncCount = 0;
+    mGetStreamingEndpointFuncCount = 0;
+    mGetStreamingTokenFuncCount = 0;
+    mPutStreamFuncCount = 0;
+
+    // Batched
+    ReadyStream();
+    mLockMutexFuncCount = 0;
+    mStreamDataAvailableFuncCount = 0;
+    batchTime = putFrameTrace(PUT_FRAMES_PERF_BATCH_SIZE);
+    batchLocks = mLockMutexFuncCount;
+    batchNotifications = mStreamDataAvailableFuncCount;
+
+    EXPECT_GT(perFrameLocks, batchLocks);
+    EXPECT_GT(perFrameNotifications, batchNotifications);
+
+    DLOGI("Put %u frames of %u bytes. Per frame: %" PRIu64 " ns/frame, %u locks, %u notifications. "
+          "Batch of %u: %" PRIu64 " ns/frame, %u locks, %u notifications.",
+          PUT_FRAMES_PERF_FRAME_COUNT, PUT_FRAMES_PERF_FRAME_SIZE,
+          perFrameTime * DEFAULT_TIME_UNIT_IN_NANOS / PUT_FRAMES_PERF_FRAME_COUNT, perFrameLocks, perFrameNotifications,
+          PUT_FRAMES_PERF_BATCH_SIZE, batchTime * DEFAULT_TIME_UNIT_IN_NANOS / PUT_FRAMES_PERF_FRAME_COUNT,
+          batchLocks, batchNotifications);
+}
@@ -1209,3 +1209,384 @@ TEST_F(StreamPutGetTest, putFrame_PutGetNonKeyFrameFirstFrameCpd3Byte)
         EXPECT_TRUE(validPattern) << "Failed at offset: " << j << " from the beginning of frame: " << i;
     }
 }
+
+TEST_F(StreamPutGetTest, putFrame_PutGetSpanFrameBoundary)
+{
+    UINT32 i, j, offset;
+    BOOL validPattern;
+    BYTE tempBuffer[1000];
+    UINT64 timestamp, clientStreamHandle;
+    Frame frame;
+    StreamDataSpan span, otherSpan;
+
+    // Ensure we have fragmentation based on the key frames
+    mStreamInfo.streamCaps.keyFrameFragmentation = TRUE;
+
+    // Create and ready a stream
+    ReadyStream();
+
+    // Produce frames
+    frame.duration = TEST_LONG_FRAME_DURATION;
+    frame.size = SIZEOF(tempBuffer);
+    frame.frameData = tempBuffer;
+    for (i = 0, timestamp = 0; timestamp < TEST_BUFFER_DURATION; timestamp += TEST_LONG_FRAME_DURATION, i++) {
+        frame.index = i;
+        frame.decodingTs = timestamp;
+        frame.presentationTs = timestamp;
+
+        // Set the frame bits
+        MEMSET(frame.frameData, (BYTE) i, SIZEOF(tempBuffer));
+
+        // Key frame every 10th
+        frame.flags = i % 10 == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+        EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, &frame));
+
+        // Return a put stream result on 20th
+        if (i == 20) {
+            EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+        }
+    }
+
+    // Consume the frames as spans which should be on the frame boundary
+    for (i = 0, timestamp = 0; timestamp < TEST_BUFFER_DURATION; timestamp += TEST_LONG_FRAME_DURATION, i++) {
+        clientStreamHandle = 0;
+
+        // The first frame will have the cluster and MKV overhead
+        if (i == 0) {
+            offset = MKV_HEADER_OVERHEAD;
+        } else if (i % 10 == 0) {
+            // Cluster start will have cluster overhead
+            offset = MKV_CLUSTER_OVERHEAD;
+        } else {
+            // Simple block overhead
+            offset = MKV_SIMPLE_BLOCK_OVERHEAD;
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, MAX_UINT32, &span));
+        EXPECT_EQ(SIZEOF(tempBuffer) + offset, span.size);
+        EXPECT_EQ(TEST_STREAMING_HANDLE, clientStreamHandle);
+        EXPECT_TRUE(span.pData != NULL);
+
+        // Only a single span can be outstanding
+        EXPECT_EQ(STATUS_STREAM_DATA_SPAN_PINNED, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, MAX_UINT32, &otherSpan));
+
+        // Validate the fill pattern
+        validPattern = TRUE;
+        for (j = 0; j < SIZEOF(tempBuffer); j++) {
+            if (span.pData[offset + j] != i) {
+                validPattern = FALSE;
+                break;
+            }
+        }
+
+        EXPECT_TRUE(validPattern) << "Failed at offset: " << j << " from the beginning of frame: " << i;
+
+        EXPECT_EQ(STATUS_INVALID_STREAM_DATA_SPAN, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken + 1));
+        EXPECT_EQ(STATUS_SUCCESS, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken));
+        EXPECT_EQ(STATUS_INVALID_STREAM_DATA_SPAN, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken));
+    }
+
+    // Nothing more left
+    EXPECT_EQ(STATUS_NO_MORE_DATA_AVAILABLE, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, MAX_UINT32, &span));
+    EXPECT_EQ(0, span.size);
+}
+
+TEST_F(StreamPutGetTest, putFrame_SpanReleaseNotifiesPinnedReader)
+{
+    UINT32 i, dataAvailableCount;
+    BYTE tempBuffer[1000];
+    UINT64 clientStreamHandle;
+    Frame frame;
+    StreamDataSpan span, otherSpan;
+
+    // Create and ready a stream
+    ReadyStream();
+
+    // Produce a couple of frames and no more after that
+    frame.duration = TEST_LONG_FRAME_DURATION;
+    frame.size = SIZEOF(tempBuffer);
+    frame.frameData = tempBuffer;
+    MEMSET(frame.frameData, 0x55, SIZEOF(tempBuffer));
+    for (i = 0; i < 2; i++) {
+        frame.index = i;
+        frame.decodingTs = frame.presentationTs = i * TEST_LONG_FRAME_DURATION;
+        frame.flags = i == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+        EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, &frame));
+
+        if (i == 0) {
+            EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+        }
+    }
+
+    // Releasing a span nobody has been waiting on doesn't notify
+    EXPECT_EQ(STATUS_SUCCESS, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, MKV_HEADER_OVERHEAD, &span));
+    dataAvailableCount = mStreamDataAvailableFuncCount;
+    EXPECT_EQ(STATUS_SUCCESS, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken));
+    EXPECT_EQ(dataAvailableCount, mStreamDataAvailableFuncCount);
+
+    // The reader turned away while the data is pinned is notified on the release with no further frames put
+    EXPECT_EQ(STATUS_SUCCESS, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, 10, &otherSpan));
+    EXPECT_NE(span.releaseToken, otherSpan.releaseToken);
+    EXPECT_EQ(STATUS_STREAM_DATA_SPAN_PINNED, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, MAX_UINT32, &span));
+
+    // The token of the earlier span doesn't release the new span
+    EXPECT_EQ(STATUS_INVALID_STREAM_DATA_SPAN, releaseKinesisVideoStreamDataSpan(mStreamHandle, otherSpan.releaseToken - 1));
+
+    mDataReadySize = 0;
+    EXPECT_EQ(STATUS_SUCCESS, releaseKinesisVideoStreamDataSpan(mStreamHandle, otherSpan.releaseToken));
+    EXPECT_EQ(dataAvailableCount + 1, mStreamDataAvailableFuncCount);
+    EXPECT_EQ(TEST_STREAMING_HANDLE, mStreamUploadHandle);
+    EXPECT_LT(0, mDataReadySize);
+
+    // The notification is only fired once
+    EXPECT_EQ(STATUS_SUCCESS, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, MAX_UINT32, &span));
+    EXPECT_EQ(STATUS_SUCCESS, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken));
+    EXPECT_EQ(dataAvailableCount + 1, mStreamDataAvailableFuncCount);
+}
+
+TEST_F(StreamPutGetTest, putFrame_PinnedSpanSurvivesEviction)
+{
+    UINT32 i, j, numAlloc;
+    BOOL validPattern;
+    BYTE tempBuffer[1000];
+    UINT64 timestamp, clientStreamHandle;
+    Frame frame;
+    StreamDataSpan span;
+    PKinesisVideoClient pKinesisVideoClient = FROM_CLIENT_HANDLE(mClientHandle);
+
+    // Create and ready a stream
+    ReadyStream();
+
+    frame.duration = TEST_LONG_FRAME_DURATION;
+    frame.size = SIZEOF(tempBuffer);
+    frame.frameData = tempBuffer;
+    frame.index = 0;
+    frame.decodingTs = frame.presentationTs = 0;
+    frame.flags = FRAME_FLAG_KEY_FRAME;
+    MEMSET(frame.frameData, 0xAA, SIZEOF(tempBuffer));
+    EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, &frame));
+    EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+
+    // Pin a part of the first frame
+    EXPECT_EQ(STATUS_SUCCESS, getKinesisVideoStreamDataSpan(mStreamHandle, &clientStreamHandle, MKV_HEADER_OVERHEAD + 10, &span));
+    EXPECT_EQ(MKV_HEADER_OVERHEAD + 10, span.size);
+
+    // Produce enough frames to evict the pinned frame from the view
+    for (i = 1, timestamp = TEST_LONG_FRAME_DURATION; timestamp < 2 * TEST_BUFFER_DURATION; timestamp += TEST_LONG_FRAME_DURATION, i++) {
+        frame.index = i;
+        frame.decodingTs = timestamp;
+        frame.presentationTs = timestamp;
+        MEMSET(frame.frameData, 0x55, SIZEOF(tempBuffer));
+        frame.flags = i % 10 == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+        EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, &frame));
+    }
+
+    // The partially sent frame has been dropped
+    EXPECT_NE(0, mDroppedFrameReportFuncCount);
+
+    // The pinned storage should still be intact
+    validPattern = TRUE;
+    for (j = 0; j < 10; j++) {
+        if (span.pData[MKV_HEADER_OVERHEAD + j] != 0xAA) {
+            validPattern = FALSE;
+            break;
+        }
+    }
+
+    EXPECT_TRUE(validPattern) << "Failed at offset: " << j;
+
+    // Releasing the span should free the evicted frame storage
+    numAlloc = pKinesisVideoClient->pHeap->numAlloc;
+    EXPECT_EQ(STATUS_SUCCESS, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken));
+    EXPECT_EQ(numAlloc - 1, pKinesisVideoClient->pHeap->numAlloc);
+}
+
+TEST_F(StreamPutGetTest, putFrame_PutGetWithSpanPinsLargeFrames)
+{
+    UINT32 i, j, offset, filledSize, spanCount = 0, largeFrameCount = 0;
+    BOOL validPattern;
+    BYTE tempBuffer[10000];
+    BYTE getDataBuffer[5000];
+    UINT64 timestamp, clientStreamHandle, totalSize = 0;
+    Frame frame;
+    StreamDataSpan span, otherSpan;
+    STATUS retStatus;
+
+    // Create and ready a stream
+    ReadyStream();
+
+    // Produce the large frames larger than the read buffer interleaved with the small ones
+    frame.duration = TEST_LONG_FRAME_DURATION;
+    frame.frameData = tempBuffer;
+    for (i = 0, timestamp = 0; timestamp < TEST_BUFFER_DURATION; timestamp += TEST_LONG_FRAME_DURATION, i++) {
+        frame.index = i;
+        frame.decodingTs = timestamp;
+        frame.presentationTs = timestamp;
+        frame.size = i % 2 == 0 ? SIZEOF(tempBuffer) : 100;
+        MEMSET(frame.frameData, (BYTE) i, frame.size);
+        frame.flags = i % 10 == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+        EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, &frame));
+
+        if (i == 0) {
+            EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+        }
+
+        if (frame.size == SIZEOF(tempBuffer)) {
+            largeFrameCount++;
+        }
+    }
+
+    // The small frames are copied and each of the large frames is pinned in its entirety
+    do {
+        retStatus = getKinesisVideoStreamDataWithSpan(mStreamHandle, &clientStreamHandle, getDataBuffer, SIZEOF(getDataBuffer),
+                                                      &filledSize, &span);
+        EXPECT_TRUE(retStatus == STATUS_SUCCESS || retStatus == STATUS_NO_MORE_DATA_AVAILABLE);
+        EXPECT_EQ(TEST_STREAMING_HANDLE, clientStreamHandle);
+        totalSize += filledSize;
+
+        if (IS_VALID_ALLOCATION_HANDLE(span.releaseToken)) {
+            // The large frames are the even ones
+            i = spanCount * 2;
+            if (i == 0) {
+                offset = MKV_HEADER_OVERHEAD;
+            } else if (i % 10 == 0) {
+                offset = MKV_CLUSTER_OVERHEAD;
+            } else {
+                offset = MKV_SIMPLE_BLOCK_OVERHEAD;
+            }
+
+            EXPECT_EQ(SIZEOF(tempBuffer) + offset, span.size);
+
+            validPattern = TRUE;
+            for (j = 0; j < SIZEOF(tempBuffer); j++) {
+                if (span.pData[offset + j] != (BYTE) i) {
+                    validPattern = FALSE;
+                    break;
+                }
+            }
+
+            EXPECT_TRUE(validPattern) << "Failed at offset: " << j << " from the beginning of frame: " << i;
+
+            // Only a single span can be outstanding
+            EXPECT_EQ(STATUS_STREAM_DATA_SPAN_PINNED,
+                      getKinesisVideoStreamDataWithSpan(mStreamHandle, &clientStreamHandle, getDataBuffer, SIZEOF(getDataBuffer),
+                                                        &filledSize, &otherSpan));
+
+            totalSize += span.size;
+            spanCount++;
+            EXPECT_EQ(STATUS_SUCCESS, releaseKinesisVideoStreamDataSpan(mStreamHandle, span.releaseToken));
+        } else {
+            EXPECT_EQ(0, span.size);
+        }
+    } while (retStatus == STATUS_SUCCESS);
+
+    EXPECT_EQ(largeFrameCount, spanCount);
+    EXPECT_LT(largeFrameCount * SIZEOF(tempBuffer), totalSize);
+}
+
+TEST_F(StreamPutGetTest, putFrames_BatchNotifiesOnce)
+{
+    UINT32 i, filledSize, lockCount, dataAvailableCount, storedCount;
+    BYTE tempBuffer[1000];
+    BYTE getDataBuffer[50000];
+    UINT64 clientStreamHandle, viewByteSize, totalSize = 0;
+    Frame frames[30];
+    PKinesisVideoStream pKinesisVideoStream;
+    STATUS retStatus;
+
+    // Create and ready a stream
+    ReadyStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    MEMSET(tempBuffer, 0x55, SIZEOF(tempBuffer));
+    for (i = 0; i < ARRAY_SIZE(frames); i++) {
+        frames[i].index = i;
+        frames[i].decodingTs = frames[i].presentationTs = i * TEST_FRAME_DURATION;
+        frames[i].duration = TEST_FRAME_DURATION;
+        frames[i].size = SIZEOF(tempBuffer);
+        frames[i].frameData = tempBuffer;
+        frames[i].flags = i % 10 == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+    }
+
+    // The first frame kicks off the put stream
+    EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrames(mStreamHandle, frames, 1, &storedCount));
+    EXPECT_EQ(1, storedCount);
+    EXPECT_EQ(1, mPutStreamFuncCount);
+    EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+
+    // The rest of the frames are put in a single batch
+    lockCount = mLockMutexFuncCount;
+    dataAvailableCount = mStreamDataAvailableFuncCount;
+    EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrames(mStreamHandle, frames + 1, ARRAY_SIZE(frames) - 1, &storedCount));
+    EXPECT_EQ(ARRAY_SIZE(frames) - 1, storedCount);
+
+    // Data available is fired once for the entire batch with the totals of all the frames
+    EXPECT_EQ(dataAvailableCount + 1, mStreamDataAvailableFuncCount);
+    EXPECT_EQ(ARRAY_SIZE(frames) * TEST_FRAME_DURATION, mDataReadyDuration);
+    EXPECT_EQ(STATUS_SUCCESS, contentViewGetWindowAllocationSize(pKinesisVideoStream->pView, &viewByteSize, NULL));
+    EXPECT_EQ(viewByteSize, mDataReadySize);
+
+    // The stream lock is taken once for the batch while the client lock is released between the frames
+    EXPECT_GE(2 * ARRAY_SIZE(frames), mLockMutexFuncCount - lockCount);
+
+    // Ensure the frames can be streamed out in order
+    do {
+        retStatus = getKinesisVideoStreamData(mStreamHandle, &clientStreamHandle, getDataBuffer, SIZEOF(getDataBuffer), &filledSize);
+        EXPECT_TRUE(retStatus == STATUS_SUCCESS || retStatus == STATUS_NO_MORE_DATA_AVAILABLE);
+        totalSize += filledSize;
+    } while (retStatus == STATUS_SUCCESS);
+
+    EXPECT_EQ(viewByteSize, totalSize);
+
+    // A failed frame in the middle of the batch retains the preceding frames
+    for (i = 0; i < ARRAY_SIZE(frames); i++) {
+        frames[i].decodingTs = frames[i].presentationTs = (ARRAY_SIZE(frames) + i) * TEST_FRAME_DURATION;
+    }
+
+    frames[5].frameData = NULL;
+    dataAvailableCount = mStreamDataAvailableFuncCount;
+    EXPECT_EQ(STATUS_MKV_INVALID_FRAME_DATA, putKinesisVideoFrames(mStreamHandle, frames, ARRAY_SIZE(frames), &storedCount));
+    EXPECT_EQ(5, storedCount);
+    EXPECT_EQ(dataAvailableCount + 1, mStreamDataAvailableFuncCount);
+    EXPECT_EQ(5 * TEST_FRAME_DURATION, mDataReadyDuration);
+}
+
+TEST_F(StreamPutGetTest, putFrame_DrainAfterStreamStart)
+{
+    UINT32 i, filledSize, totalSize;
+    BYTE tempBuffer[1000];
+    BYTE getDataBuffer[10000];
+    UINT64 clientStreamHandle;
+    Frame frame;
+    STATUS retStatus;
+
+    // Create and ready a stream
+    ReadyStream();
+
+    MEMSET(tempBuffer, 0x55, SIZEOF(tempBuffer));
+    frame.duration = TEST_FRAME_DURATION;
+    frame.size = SIZEOF(tempBuffer);
+    frame.frameData = tempBuffer;
+
+    for (i = 0; i < 3; i++) {
+        frame.index = i;
+        frame.decodingTs = frame.presentationTs = i * TEST_FRAME_DURATION;
+        frame.flags = i == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+        EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(mStreamHandle, &frame));
+
+        if (i == 0) {
+            EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+        }
+
+        // Drain the frame right after it's been put. The stream start header of the first frame
+        // is stripped once the frame has been fully read which shouldn't affect the following reads.
+        totalSize = 0;
+        do {
+            retStatus = getKinesisVideoStreamData(mStreamHandle, &clientStreamHandle, getDataBuffer, SIZEOF(getDataBuffer), &filledSize);
+            EXPECT_TRUE(retStatus == STATUS_SUCCESS || retStatus == STATUS_NO_MORE_DATA_AVAILABLE) << "Frame " << i << " status 0x" << std::hex << retStatus;
+            totalSize += filledSize;
+        } while (retStatus == STATUS_SUCCESS);
+
+        EXPECT_EQ(SIZEOF(tempBuffer) + (i == 0 ? MKV_HEADER_OVERHEAD : MKV_SIMPLE_BLOCK_OVERHEAD), totalSize);
+    }
+}
@@ -153,3 +153,185 @@ TEST_F(StreamTokenRotationTest, stopStateFromCreate)
         freeKinesisVideoClient(&clientHandle);
     }
 }
+
+TEST_F(StreamTokenRotationTest, standbyConnectionSwitchOnFragmentBoundary)
+{
+    UINT32 i, filledSize, rotationIndex = 0, standbyIndex = 0, switchIndex = 0;
+    BYTE tempBuffer[1000];
+    BYTE getDataBuffer[5000];
+    BYTE ebmlHeader[] = {0x1A, 0x45, 0xDF, 0xA3};
+    UINT64 timestamp, clientStreamHandle, expectedHandle = TEST_STREAMING_HANDLE;
+    Frame frame;
+    STATUS status;
+    CLIENT_HANDLE clientHandle = INVALID_CLIENT_HANDLE_VALUE;
+    STREAM_HANDLE streamHandle = INVALID_STREAM_HANDLE_VALUE;
+
+    // Reset the values for repeated playback of the tests
+    gPresetTimeValue = 0;
+
+    // Set the specialized callback functions
+    mClientCallbacks.getCurrentTimeFn = getCurrentTimePreset;
+
+    // Create and ready a stream
+    EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &clientHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createDeviceResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_DEVICE_ARN));
+    EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoStream(clientHandle, &mStreamInfo, &streamHandle));
+
+    mStreamDescription.version = STREAM_DESCRIPTION_CURRENT_VERSION;
+    STRCPY(mStreamDescription.deviceName, TEST_DEVICE_NAME);
+    STRCPY(mStreamDescription.streamName, TEST_STREAM_NAME);
+    STRCPY(mStreamDescription.contentType, TEST_CONTENT_TYPE);
+    STRCPY(mStreamDescription.streamArn, TEST_STREAM_ARN);
+    STRCPY(mStreamDescription.updateVersion, TEST_UPDATE_VERSION);
+    mStreamDescription.streamStatus = STREAM_STATUS_ACTIVE;
+    mStreamDescription.creationTime = GETTIME();
+
+    EXPECT_EQ(STATUS_SUCCESS, describeStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, &mStreamDescription));
+    EXPECT_EQ(STATUS_SUCCESS, getStreamingEndpointResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_ENDPOINT));
+    EXPECT_EQ(STATUS_SUCCESS, getStreamingTokenResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, (PBYTE) TEST_STREAMING_TOKEN, SIZEOF(TEST_STREAMING_TOKEN), MIN_STREAMING_TOKEN_EXPIRATION_DURATION));
+    EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+
+    // Produce until the first token expires and drain the stream after every frame
+    for (i = 0, timestamp = 0; timestamp < MIN_STREAMING_TOKEN_EXPIRATION_DURATION; timestamp += TEST_LONG_FRAME_DURATION, i++) {
+        frame.index = i;
+        frame.decodingTs = timestamp;
+        frame.presentationTs = timestamp;
+        frame.duration = TEST_LONG_FRAME_DURATION;
+        frame.size = SIZEOF(tempBuffer);
+        frame.frameData = tempBuffer;
+        frame.flags = i % 5 == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+
+        gPresetTimeValue = timestamp;
+        EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(streamHandle, &frame));
+
+        // The rotation should start ahead of the grace period
+        if (rotationIndex == 0 && mGetStreamingEndpointFuncCount == 2) {
+            rotationIndex = i;
+            EXPECT_LE(MIN_STREAMING_TOKEN_EXPIRATION_DURATION - STREAMING_TOKEN_EXPIRATION_GRACE_PERIOD - STREAMING_TOKEN_STANDBY_CONNECTION_PERIOD, timestamp);
+            EXPECT_GT(MIN_STREAMING_TOKEN_EXPIRATION_DURATION - STREAMING_TOKEN_EXPIRATION_GRACE_PERIOD, timestamp);
+
+            EXPECT_EQ(STATUS_SUCCESS, getStreamingEndpointResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_ENDPOINT));
+            EXPECT_EQ(STATUS_SUCCESS, getStreamingTokenResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, (PBYTE) TEST_STREAMING_TOKEN, SIZEOF(TEST_STREAMING_TOKEN), 2 * MIN_STREAMING_TOKEN_EXPIRATION_DURATION));
+            EXPECT_EQ(2, mPutStreamFuncCount);
+        }
+
+        // Simulate a slow standby connection establishment spanning a couple of fragments
+        if (rotationIndex != 0 && standbyIndex == 0 && i == rotationIndex + 7) {
+            standbyIndex = i;
+            EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE + 1));
+        }
+
+        do {
+            status = getKinesisVideoStreamData(streamHandle, &clientStreamHandle, getDataBuffer, SIZEOF(getDataBuffer), &filledSize);
+            if (status == STATUS_END_OF_STREAM) {
+                // The current handle is ended only once on a key frame after the standby handle is ready
+                EXPECT_EQ(0, switchIndex);
+                EXPECT_EQ(TEST_STREAMING_HANDLE, clientStreamHandle);
+                EXPECT_NE(0, standbyIndex);
+                EXPECT_LT(standbyIndex, i);
+                EXPECT_EQ(0, i % 5);
+                switchIndex = i;
+                expectedHandle = TEST_STREAMING_HANDLE + 1;
+                status = STATUS_SUCCESS;
+                continue;
+            }
+
+            EXPECT_TRUE(status == STATUS_SUCCESS || status == STATUS_NO_MORE_DATA_AVAILABLE);
+
+            // Each frame is available right away either on the current or on the standby handle
+            if (filledSize != 0) {
+                EXPECT_EQ(expectedHandle, clientStreamHandle);
+
+                // The standby handle starts with a new stream
+                if (switchIndex == i && clientStreamHandle == TEST_STREAMING_HANDLE + 1) {
+                    EXPECT_EQ(0, MEMCMP(ebmlHeader, getDataBuffer, SIZEOF(ebmlHeader)));
+                    switchIndex = (UINT32) -1;
+                }
+            }
+        } while (status == STATUS_SUCCESS);
+    }
+
+    // The switch should happen before the original token expires
+    EXPECT_NE(0, rotationIndex);
+    EXPECT_EQ((UINT32) -1, switchIndex);
+    EXPECT_EQ(TEST_STREAMING_HANDLE + 1, expectedHandle);
+
+    if (IS_VALID_CLIENT_HANDLE(clientHandle)) {
+        freeKinesisVideoClient(&clientHandle);
+    }
+}
+
+TEST_F(StreamTokenRotationTest, configuredStandbyConnectionPeriod)
+{
+    UINT32 i;
+    BYTE tempBuffer[1000];
+    UINT64 timestamp, rotationTimestamp = 0, standbyPeriod = 20 * HUNDREDS_OF_NANOS_IN_A_SECOND;
+    Frame frame;
+    CLIENT_HANDLE clientHandle = INVALID_CLIENT_HANDLE_VALUE;
+    STREAM_HANDLE streamHandle = INVALID_STREAM_HANDLE_VALUE;
+
+    // Reset the values for repeated playback of the tests
+    gPresetTimeValue = 0;
+
+    // Set the specialized callback functions
+    mClientCallbacks.getCurrentTimeFn = getCurrentTimePreset;
+
+    EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoClient(&mDeviceInfo, &mClientCallbacks, &clientHandle));
+    EXPECT_EQ(STATUS_SUCCESS, createDeviceResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_DEVICE_ARN));
+
+    // The rotation can't start right away after the minimal token has been received
+    mStreamInfo.streamCaps.standbyConnectionPeriod = MIN_STREAMING_TOKEN_EXPIRATION_DURATION - STREAMING_TOKEN_EXPIRATION_GRACE_PERIOD;
+    EXPECT_EQ(STATUS_INVALID_STANDBY_CONNECTION_PERIOD, createKinesisVideoStream(clientHandle, &mStreamInfo, &streamHandle));
+
+    // The period is ignored with the older versions of the stream info
+    mStreamInfo.version = STREAM_INFO_STANDBY_CONNECTION_VERSION - 1;
+    EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoStream(clientHandle, &mStreamInfo, &streamHandle));
+    EXPECT_EQ(STREAMING_TOKEN_STANDBY_CONNECTION_PERIOD, FROM_STREAM_HANDLE(streamHandle)->streamInfo.streamCaps.standbyConnectionPeriod);
+    EXPECT_EQ(STATUS_SUCCESS, freeKinesisVideoStream(&streamHandle));
+
+    // Start the rotation earlier than the default period
+    mStreamInfo.version = STREAM_INFO_CURRENT_VERSION;
+    mStreamInfo.streamCaps.standbyConnectionPeriod = standbyPeriod;
+    EXPECT_EQ(STATUS_SUCCESS, createKinesisVideoStream(clientHandle, &mStreamInfo, &streamHandle));
+
+    mStreamDescription.version = STREAM_DESCRIPTION_CURRENT_VERSION;
+    STRCPY(mStreamDescription.deviceName, TEST_DEVICE_NAME);
+    STRCPY(mStreamDescription.streamName, TEST_STREAM_NAME);
+    STRCPY(mStreamDescription.contentType, TEST_CONTENT_TYPE);
+    STRCPY(mStreamDescription.streamArn, TEST_STREAM_ARN);
+    STRCPY(mStreamDescription.updateVersion, TEST_UPDATE_VERSION);
+    mStreamDescription.streamStatus = STREAM_STATUS_ACTIVE;
+    mStreamDescription.creationTime = GETTIME();
+
+    EXPECT_EQ(STATUS_SUCCESS, describeStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, &mStreamDescription));
+    EXPECT_EQ(STATUS_SUCCESS, getStreamingEndpointResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_ENDPOINT));
+    EXPECT_EQ(STATUS_SUCCESS, getStreamingTokenResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, (PBYTE) TEST_STREAMING_TOKEN, SIZEOF(TEST_STREAMING_TOKEN), MIN_STREAMING_TOKEN_EXPIRATION_DURATION));
+    EXPECT_EQ(STATUS_SUCCESS, putStreamResultEvent(mCallContext.customData, SERVICE_CALL_RESULT_OK, TEST_STREAMING_HANDLE));
+    EXPECT_EQ(1, mGetStreamingEndpointFuncCount);
+
+    MEMSET(tempBuffer, 0x00, SIZEOF(tempBuffer));
+    for (i = 0, timestamp = 0; rotationTimestamp == 0 && timestamp < MIN_STREAMING_TOKEN_EXPIRATION_DURATION; timestamp += TEST_LONG_FRAME_DURATION, i++) {
+        frame.index = i;
+        frame.decodingTs = timestamp;
+        frame.presentationTs = timestamp;
+        frame.duration = TEST_LONG_FRAME_DURATION;
+        frame.size = SIZEOF(tempBuffer);
+        frame.frameData = tempBuffer;
+        frame.flags = i % 5 == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+
+        gPresetTimeValue = timestamp;
+        EXPECT_EQ(STATUS_SUCCESS, putKinesisVideoFrame(streamHandle, &frame));
+
+        if (mGetStreamingEndpointFuncCount == 2) {
+            rotationTimestamp = timestamp;
+        }
+    }
+
+    // The rotation starts at the configured period ahead of the grace period
+    EXPECT_LE(MIN_STREAMING_TOKEN_EXPIRATION_DURATION - STREAMING_TOKEN_EXPIRATION_GRACE_PERIOD - standbyPeriod, rotationTimestamp);
+    EXPECT_GT(MIN_STREAMING_TOKEN_EXPIRATION_DURATION - STREAMING_TOKEN_EXPIRATION_GRACE_PERIOD - STREAMING_TOKEN_STANDBY_CONNECTION_PERIOD, rotationTimestamp);
+
+    if (IS_VALID_CLIENT_HANDLE(clientHandle)) {
+        freeKinesisVideoClient(&clientHandle);
+    }
+}
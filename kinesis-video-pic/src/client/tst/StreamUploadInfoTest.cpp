@@ -0,0 +1,166 @@
+#include "ClientTestFixture.h"
+
+#define UPLOAD_INFO_PERF_HANDLE_COUNT       1000
+#define UPLOAD_INFO_PERF_ITERATION_COUNT    10000
+
+class StreamUploadInfoTest : public ClientTestBase {
+protected:
+    PUploadHandleInfo addUploadInfo(PKinesisVideoStream pKinesisVideoStream, UPLOAD_HANDLE handle)
+    {
+        PUploadHandleInfo pUploadHandleInfo = (PUploadHandleInfo) MEMCALLOC(1, SIZEOF(UploadHandleInfo));
+
+        pUploadHandleInfo->handle = handle;
+        pUploadHandleInfo->startIndex = INVALID_VIEW_INDEX_VALUE;
+        pUploadHandleInfo->endIndex = INVALID_VIEW_INDEX_VALUE;
+        pUploadHandleInfo->timestamp = INVALID_TIMESTAMP_VALUE;
+        pUploadHandleInfo->state = UPLOAD_HANDLE_STATE_NEW;
+        EXPECT_EQ(STATUS_SUCCESS, addStreamUploadInfo(pKinesisVideoStream, pUploadHandleInfo));
+
+        return pUploadHandleInfo;
+    }
+
+    /**
+     * The linear scan of the upload handle queue the lookups used to do
+     */
+    PUploadHandleInfo scanUploadInfoWithState(PKinesisVideoStream pKinesisVideoStream, UINT32 handleState)
+    {
+        StackQueueIterator iterator;
+        UINT64 data;
+
+        EXPECT_EQ(STATUS_SUCCESS, stackQueueGetIterator(pKinesisVideoStream->pUploadInfoQueue, &iterator));
+        while (IS_VALID_ITERATOR(iterator)) {
+            EXPECT_EQ(STATUS_SUCCESS, stackQueueIteratorGetItem(iterator, &data));
+            if ((handleState & ((PUploadHandleInfo) data)->state) != UPLOAD_HANDLE_STATE_NONE) {
+                return (PUploadHandleInfo) data;
+            }
+
+            EXPECT_EQ(STATUS_SUCCESS, stackQueueIteratorNext(&iterator));
+        }
+
+        return NULL;
+    }
+};
+
+TEST_F(StreamUploadInfoTest, uploadInfo_LookupsMatchQueueOrder)
+{
+    PKinesisVideoStream pKinesisVideoStream;
+    PUploadHandleInfo pInfos[6];
+    UINT32 i, state;
+
+    CreateStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    for (i = 0; i < ARRAY_SIZE(pInfos); i++) {
+        pInfos[i] = addUploadInfo(pKinesisVideoStream, 100 + i);
+    }
+
+    // Duplicate handles are rejected
+    pInfos[0]->handle = 100;
+    EXPECT_EQ(STATUS_HASH_KEY_ALREADY_PRESENT, addStreamUploadInfo(pKinesisVideoStream, pInfos[0]));
+
+    EXPECT_EQ(pInfos[3], getStreamUploadInfo(pKinesisVideoStream, 103));
+    EXPECT_EQ(NULL, getStreamUploadInfo(pKinesisVideoStream, 200));
+    EXPECT_EQ(pInfos[0], getCurrentStreamUploadInfo(pKinesisVideoStream));
+
+    // Move the newer handles ahead through the states. The older handles reaching the same state
+    // later must still be returned first.
+    setStreamUploadInfoState(pKinesisVideoStream, pInfos[4], UPLOAD_HANDLE_STATE_STREAMING);
+    setStreamUploadInfoState(pKinesisVideoStream, pInfos[2], UPLOAD_HANDLE_STATE_STREAMING);
+    setStreamUploadInfoState(pKinesisVideoStream, pInfos[5], UPLOAD_HANDLE_STATE_READY);
+    setStreamUploadInfoState(pKinesisVideoStream, pInfos[1], UPLOAD_HANDLE_STATE_TERMINATED);
+    setStreamUploadInfoState(pKinesisVideoStream, pInfos[0], UPLOAD_HANDLE_STATE_TERMINATED);
+
+    for (state = UPLOAD_HANDLE_STATE_NONE; state <= UPLOAD_HANDLE_STATE_ANY; state++) {
+        EXPECT_EQ(scanUploadInfoWithState(pKinesisVideoStream, state), getStreamUploadInfoWithState(pKinesisVideoStream, state));
+    }
+
+    EXPECT_EQ(pInfos[2], getStreamUploadInfoWithState(pKinesisVideoStream, UPLOAD_HANDLE_STATE_STREAMING));
+    EXPECT_EQ(pInfos[0], getStreamUploadInfoWithState(pKinesisVideoStream, UPLOAD_HANDLE_STATE_TERMINATED));
+    EXPECT_EQ(pInfos[2], getCurrentStreamUploadInfo(pKinesisVideoStream));
+
+    // Deleting from the middle of the state lists
+    deleteStreamUploadInfo(pKinesisVideoStream, pInfos[2]);
+    deleteStreamUploadInfo(pKinesisVideoStream, pInfos[0]);
+    EXPECT_EQ(NULL, getStreamUploadInfo(pKinesisVideoStream, 102));
+    for (state = UPLOAD_HANDLE_STATE_NONE; state <= UPLOAD_HANDLE_STATE_ANY; state++) {
+        EXPECT_EQ(scanUploadInfoWithState(pKinesisVideoStream, state), getStreamUploadInfoWithState(pKinesisVideoStream, state));
+    }
+
+    EXPECT_EQ(pInfos[3], getCurrentStreamUploadInfo(pKinesisVideoStream));
+}
+
+TEST_F(StreamUploadInfoTest, uploadInfo_SharedEndIndex)
+{
+    PKinesisVideoStream pKinesisVideoStream;
+    PUploadHandleInfo pInfos[3];
+    UINT32 i;
+
+    CreateStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    for (i = 0; i < ARRAY_SIZE(pInfos); i++) {
+        pInfos[i] = addUploadInfo(pKinesisVideoStream, 100 + i);
+    }
+
+    EXPECT_EQ(NULL, getStreamUploadInfoWithEndIndex(pKinesisVideoStream, 10));
+
+    // The oldest handle with the end index is returned
+    EXPECT_EQ(STATUS_SUCCESS, setStreamUploadInfoEndIndex(pKinesisVideoStream, pInfos[2], 10));
+    EXPECT_EQ(STATUS_SUCCESS, setStreamUploadInfoEndIndex(pKinesisVideoStream, pInfos[0], 10));
+    EXPECT_EQ(STATUS_SUCCESS, setStreamUploadInfoEndIndex(pKinesisVideoStream, pInfos[1], 20));
+    EXPECT_EQ(pInfos[0], getStreamUploadInfoWithEndIndex(pKinesisVideoStream, 10));
+    EXPECT_EQ(pInfos[1], getStreamUploadInfoWithEndIndex(pKinesisVideoStream, 20));
+
+    // Re-pointing the end index
+    EXPECT_EQ(STATUS_SUCCESS, setStreamUploadInfoEndIndex(pKinesisVideoStream, pInfos[1], 10));
+    EXPECT_EQ(NULL, getStreamUploadInfoWithEndIndex(pKinesisVideoStream, 20));
+
+    // The purge loop removes all of the handles ending at the index
+    for (i = 0; i < ARRAY_SIZE(pInfos); i++) {
+        EXPECT_EQ(pInfos[i], getStreamUploadInfoWithEndIndex(pKinesisVideoStream, 10));
+        deleteStreamUploadInfo(pKinesisVideoStream, pInfos[i]);
+    }
+
+    EXPECT_EQ(NULL, getStreamUploadInfoWithEndIndex(pKinesisVideoStream, 10));
+    EXPECT_EQ(NULL, getCurrentStreamUploadInfo(pKinesisVideoStream));
+}
+
+TEST_F(StreamUploadInfoTest, uploadInfo_LookupPerfWithManyReconnects)
+{
+    PKinesisVideoStream pKinesisVideoStream;
+    PUploadHandleInfo pUploadHandleInfo = NULL;
+    UINT32 i;
+    UINT64 scanTime, indexedTime;
+
+    CreateStream();
+    pKinesisVideoStream = FROM_STREAM_HANDLE(mStreamHandle);
+
+    // The terminated sessions which haven't been purged yet followed by the active one
+    for (i = 0; i < UPLOAD_INFO_PERF_HANDLE_COUNT; i++) {
+        pUploadHandleInfo = addUploadInfo(pKinesisVideoStream, i);
+        setStreamUploadInfoState(pKinesisVideoStream, pUploadHandleInfo, UPLOAD_HANDLE_STATE_TERMINATED);
+        EXPECT_EQ(STATUS_SUCCESS, setStreamUploadInfoEndIndex(pKinesisVideoStream, pUploadHandleInfo, 1000 + i));
+    }
+
+    setStreamUploadInfoState(pKinesisVideoStream, pUploadHandleInfo, UPLOAD_HANDLE_STATE_STREAMING);
+
+    scanTime = GETTIME();
+    for (i = 0; i < UPLOAD_INFO_PERF_ITERATION_COUNT; i++) {
+        EXPECT_EQ(pUploadHandleInfo, scanUploadInfoWithState(pKinesisVideoStream, UPLOAD_HANDLE_STATE_READY | UPLOAD_HANDLE_STATE_STREAMING));
+    }
+
+    scanTime = GETTIME() - scanTime;
+
+    indexedTime = GETTIME();
+    for (i = 0; i < UPLOAD_INFO_PERF_ITERATION_COUNT; i++) {
+        EXPECT_EQ(pUploadHandleInfo, getStreamUploadInfoWithState(pKinesisVideoStream, UPLOAD_HANDLE_STATE_READY | UPLOAD_HANDLE_STATE_STREAMING));
+        EXPECT_EQ(pUploadHandleInfo, getStreamUploadInfoWithEndIndex(pKinesisVideoStream, 1000 + UPLOAD_INFO_PERF_HANDLE_COUNT - 1));
+    }
+
+    indexedTime = GETTIME() - indexedTime;
+
+    DLOGI("%u upload handles. State lookup with queue scan: %" PRIu64 " ns. Indexed state and end index lookups: %" PRIu64 " ns",
+          UPLOAD_INFO_PERF_HANDLE_COUNT,
+          scanTime * DEFAULT_TIME_UNIT_IN_NANOS / UPLOAD_INFO_PERF_ITERATION_COUNT,
+          indexedTime * DEFAULT_TIME_UNIT_IN_NANOS / UPLOAD_INFO_PERF_ITERATION_COUNT);
+}
@@ -573,6 +573,7 @@ extern freeMutex globalFreeMutex;
 #define MEMCALLOC                  globalMemCalloc
 #define MEMFREE                    globalMemFree
 #define MEMCMP                     memcmp
+#define MEMCHR                     memchr
 #define MEMCPY                     memcpy
 #define MEMSET                     memset
 #define MEMMOVE                    memmove
@@ -713,6 +714,25 @@ extern freeMutex globalFreeMutex;
 #define MUTEX_TRYLOCK               globalTryLockMutex
 #define MUTEX_FREE                  globalFreeMutex
 
+/**
+ * Atomic operations on the 64 bit values.
+ * The loads have the acquire and the stores the release semantics.
+ * The compare exchange returns TRUE if the value has been swapped.
+ */
+#if defined _MSC_VER
+#define ATOMIC_LOAD(p)                          ((UINT64) InterlockedCompareExchange64((volatile LONG64*) (p), 0, 0))
+#define ATOMIC_STORE(p, v)                      InterlockedExchange64((volatile LONG64*) (p), (LONG64) (v))
+#define ATOMIC_INCREMENT(p)                     ((UINT64) InterlockedIncrement64((volatile LONG64*) (p)))
+#define ATOMIC_COMPARE_EXCHANGE(p, e, v)        (InterlockedCompareExchange64((volatile LONG64*) (p), (LONG64) (v), (LONG64) (e)) == (LONG64) (e))
+#define MEMORY_BARRIER()                        MemoryBarrier()
+#else
+#define ATOMIC_LOAD(p)                          __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE(p, v)                      __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ATOMIC_INCREMENT(p)                     __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define ATOMIC_COMPARE_EXCHANGE(p, e, v)        __sync_bool_compare_and_swap((p), (e), (v))
+#define MEMORY_BARRIER()                        __sync_synchronize()
+#endif
+
 #ifndef SQRT
 #include <math.h>
     #define SQRT sqrt
@@ -73,9 +73,16 @@ typedef enum
     FLAGS_REOPEN_VRAM_LIBRARY = 0x1 << 3,
 
     /**
-     * Whether to use the hybrid heap allocator which combined RAM-based heap and file based heap
+     * Whether to use the hybrid heap allocator which combined RAM-based heap and file based heap.
+     * The file based part of the heap is in memory mapped segment files in the root directory.
      */
     FLAGS_USE_HYBRID_FILE_HEAP = 0x1 << 4,
+
+    /**
+     * Whether to use the segregated fit (TLSF) free lists in the AIV heap allocator for
+     * constant time allocation and free regardless of the fragmentation. Applies to the AIV heap only.
+     */
+    FLAGS_USE_AIV_SEGREGATED_FIT = 0x1 << 5,
 } HEAP_BEHAVIOR_FLAGS;
 
 /**
@@ -131,6 +138,8 @@ typedef struct
 #define STATUS_HEAP_VRAM_MAP_FAILED                             STATUS_HEAP_BASE + 0x00000012
 #define STATUS_HEAP_VRAM_UNMAP_FAILED                           STATUS_HEAP_BASE + 0x00000013
 #define STATUS_HEAP_VRAM_UNINIT_FAILED                          STATUS_HEAP_BASE + 0x00000014
+#define STATUS_HEAP_FILE_OPEN_FAILED                            STATUS_HEAP_BASE + 0x00000015
+#define STATUS_HEAP_FILE_MAP_FAILED                             STATUS_HEAP_BASE + 0x00000016
 
 //////////////////////////////////////////////////////////////////////////
 // Public functions
@@ -140,6 +149,12 @@ typedef struct
  */
 PUBLIC_API STATUS heapInitialize(UINT64, UINT32, UINT32, PHeap*);
 
+/**
+ * Creates and initializes the heap with the root directory for the file based heap
+ * storage. The root directory is required if the hybrid file heap is specified.
+ */
+PUBLIC_API STATUS heapInitializeWithRootDirectory(UINT64, UINT32, UINT32, PCHAR, PHeap*);
+
 /**
  * Releases the entire heap.
  * IMPORTANT: Some heaps will leak memory if the allocations are not freed previously
@@ -166,6 +181,11 @@ PUBLIC_API STATUS heapFree(PHeap, ALLOCATION_HANDLE);
  */
 PUBLIC_API STATUS heapGetAllocSize(PHeap, ALLOCATION_HANDLE, PUINT32);
 
+/**
+ * Shrinks the allocation in-place. The handle remains valid and any trailing space is returned to the heap
+ */
+PUBLIC_API STATUS heapSetAllocSize(PHeap, ALLOCATION_HANDLE, UINT32);
+
 /**
  * Maps the allocated handle and retrieves a memory address
  */
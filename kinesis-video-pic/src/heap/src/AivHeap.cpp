@@ -28,8 +28,9 @@ DEFINE_HEAP_CHK(aivHeapDebugCheckAllocator)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PAIV_ALLOCATION_HEADER pBlock = NULL;
+    PAIV_ALLOCATION_HEADER pBlock = NULL, pNext;
     PAivHeap pAivHeap = (PAivHeap) pHeap;
+    UINT32 fl, sl, blockFl, blockSl;
 
     // Call the base heap functionality
     CHK_STATUS(commonHeapDebugCheckAllocator(pHeap, dump));
@@ -99,6 +100,34 @@ DEFINE_HEAP_CHK(aivHeapDebugCheckAllocator)
         pBlock = pBlock->pNext;
     }
 
+    // walk the segregated fit free lists
+    for (fl = 0; pAivHeap->segregatedFit && fl < AIV_SEGREGATED_FL_INDEX_COUNT; fl++) {
+        for (sl = 0; sl < AIV_SEGREGATED_SL_INDEX_COUNT; sl++) {
+            if ((pAivHeap->freeLists[fl][sl] != NULL) != ((pAivHeap->slBitmap[fl] & (1 << sl)) != 0)) {
+                DLOGE("Free list bitmap doesn't match the free list [%u][%u]", fl, sl);
+                retStatus = STATUS_HEAP_CORRUPTED;
+            }
+
+            for (pBlock = pAivHeap->freeLists[fl][sl]; pBlock != NULL; pBlock = pBlock->pNext) {
+                if (dump) {
+                    DLOGI("Block:\t%p\t\tsize:\t%d\t\tclass:\t[%u][%u]", pBlock, ((PALLOCATION_HEADER)pBlock)->size, fl, sl);
+                }
+
+                getSegregatedIndex(((PALLOCATION_HEADER)pBlock)->size, &blockFl, &blockSl);
+                if (pBlock->state != ALLOCATION_FLAGS_FREE || blockFl != fl || blockSl != sl) {
+                    DLOGE("Block %p is in free list [%u][%u] but is not free or belongs to [%u][%u]", pBlock, fl, sl, blockFl, blockSl);
+                    retStatus = STATUS_HEAP_CORRUPTED;
+                }
+
+                pNext = getNextPhysicalBlock(pAivHeap, pBlock);
+                if (pNext != NULL && getPrevPhysicalBlock(pAivHeap, pNext) != pBlock) {
+                    DLOGE("Block %p is not linked as the physical previous block of %p", pBlock, pNext);
+                    retStatus = STATUS_HEAP_CORRUPTED;
+                }
+            }
+        }
+    }
+
     if (dump) {
         DLOGI("*******************************************");
     }
@@ -127,6 +156,7 @@ DEFINE_CREATE_HEAP(aivHeapCreate)
     pBaseHeap->heapAllocFn = aivHeapAlloc;
     pBaseHeap->heapFreeFn = aivHeapFree;
     pBaseHeap->heapGetAllocSizeFn = aivHeapGetAllocSize;
+    pBaseHeap->heapSetAllocSizeFn = aivHeapSetAllocSize;
     pBaseHeap->heapMapFn = aivHeapMap;
     pBaseHeap->heapUnmapFn = aivHeapUnmap;
     pBaseHeap->heapDebugCheckAllocatorFn = aivHeapDebugCheckAllocator;
@@ -140,10 +170,35 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Creates the heap with segregated fit free lists
+ */
+DEFINE_CREATE_HEAP(aivSegregatedFitHeapCreate)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK_STATUS(aivHeapCreate(ppHeap));
+
+    ((PAivHeap) *ppHeap)->segregatedFit = TRUE;
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
 /**
  * Initialize the heap
  */
 DEFINE_INIT_HEAP(aivHeapInit)
+{
+    return aivHeapInitWithBuffer(pHeap, heapLimit, NULL);
+}
+
+/**
+ * Initialize the heap over a caller provided buffer
+ */
+STATUS aivHeapInitWithBuffer(PHeap pHeap, UINT64 heapLimit, PVOID pBuffer)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
@@ -153,14 +208,18 @@ DEFINE_INIT_HEAP(aivHeapInit)
 
     // Set the initial values in case the base init fails
     pAivHeap->pAllocation = NULL;
+    pAivHeap->externalAllocation = (pBuffer != NULL);
     pAivHeap->pFree = NULL;
     pAivHeap->pAlloc = NULL;
+    pAivHeap->flBitmap = 0;
+    MEMSET(pAivHeap->slBitmap, 0x00, SIZEOF(pAivHeap->slBitmap));
+    MEMSET(pAivHeap->freeLists, 0x00, SIZEOF(pAivHeap->freeLists));
 
     // Call the base functionality
     CHK_STATUS(commonHeapInit(pHeap, heapLimit));
 
-    // Allocate the entire heap backed by the process default heap.
-    pAivHeap->pAllocation = MEMALLOC(heapLimit);
+    // Allocate the entire heap backed by the process default heap unless the buffer is provided.
+    pAivHeap->pAllocation = pAivHeap->externalAllocation ? pBuffer : MEMALLOC(heapLimit);
     CHK_ERR(pAivHeap->pAllocation != NULL,
         STATUS_NOT_ENOUGH_MEMORY,
         "Failed to allocate heap with limit size %" PRIu64,
@@ -180,15 +239,22 @@ DEFINE_INIT_HEAP(aivHeapInit)
     // We don't need to re-adjust the heap size to accommodate the header allocation as it will be taken care during alloc
     ((PALLOCATION_HEADER)pAivHeap->pFree)->size = (UINT32)(pHeap->heapLimit - AIV_ALLOCATION_HEADER_SIZE);
 
+    // Move the initial block to the segregated free lists
+    if (pAivHeap->segregatedFit) {
+        insertSegregatedFreeBlock(pAivHeap, pAivHeap->pFree);
+        pAivHeap->pFree = NULL;
+    }
+
 CleanUp:
 
     // Clean-up on error
-    if (STATUS_FAILED(retStatus)) {
-        if (pAivHeap->pAllocation != NULL) {
+    if (STATUS_FAILED(retStatus) && pAivHeap != NULL) {
+        if (pAivHeap->pAllocation != NULL && !pAivHeap->externalAllocation) {
             MEMFREE(pAivHeap->pAllocation);
-            pAivHeap->pAllocation = NULL;
         }
 
+        pAivHeap->pAllocation = NULL;
+
         // Re-set everything
         pHeap->heapLimit = 0;
     }
@@ -213,7 +279,7 @@ DEFINE_RELEASE_HEAP(aivHeapRelease)
     retStatus = commonHeapRelease(pHeap);
 
     // Release the entire heap regardless of the status that's returned earlier
-    if (pAivHeap->pAllocation != NULL) {
+    if (pAivHeap->pAllocation != NULL && !pAivHeap->externalAllocation) {
         MEMFREE(pAivHeap->pAllocation);
     }
 
@@ -340,6 +406,42 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Sets the allocation size. The trailing space is returned to the free list if it's large enough.
+ */
+DEFINE_HEAP_SET_ALLOC_SIZE(aivHeapSetAllocSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PAIV_ALLOCATION_HEADER pHeader;
+    PVOID pAllocation;
+    PAivHeap pAivHeap = (PAivHeap) pHeap;
+
+    CHK(pAivHeap != NULL, STATUS_NULL_ARG);
+
+    // IMPORTANT.. The handle is the offset so we need to convert to the pointer
+    pAllocation = FROM_AIV_HANDLE(pAivHeap, handle);
+
+    // Call the common heap function
+    CHK_STATUS(commonHeapSetAllocSize(pHeap, handle, size));
+
+    pHeader = (PAIV_ALLOCATION_HEADER)pAllocation - 1;
+
+    // Check for the validity of the allocation
+    CHK_ERR(pHeader->state == ALLOCATION_FLAGS_ALLOC && pHeader->allocSize != 0, STATUS_INVALID_HANDLE_ERROR,
+            "Invalid handle or previously freed.");
+
+    // We can only shrink in-place
+    CHK_ERR(size <= pHeader->allocSize, STATUS_INVALID_ARG, "Can't grow allocation of %u bytes to %u bytes",
+            pHeader->allocSize, size);
+
+    shrinkAllocatedBlock(pAivHeap, pHeader, size);
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
 /**
  * Map the allocation handle
  */
@@ -455,6 +557,10 @@ PAIV_ALLOCATION_HEADER getFreeBlock(PAivHeap pAivHeap, UINT32 size)
     // overall allocation size - the header is already included in the free list but not the footer
     UINT32 allocationSize = size + AIV_ALLOCATION_FOOTER_SIZE;
 
+    if (pAivHeap->segregatedFit) {
+        return getSegregatedFreeBlock(pAivHeap, allocationSize);
+    }
+
     // Perform the allocation by looking for the first fit in the free list
     while (pFree != NULL) {
         // check for the fit
@@ -476,7 +582,12 @@ VOID splitFreeBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock, UINT32 siz
 {
     CHECK(pAivHeap != NULL && pBlock != NULL && size > 0);
 
-    PAIV_ALLOCATION_HEADER pNewFree = NULL;
+    PAIV_ALLOCATION_HEADER pNewFree = NULL, pNext;
+
+    // The segregated free list is determined by the block size so it needs to be removed before any adjustments
+    if (pAivHeap->segregatedFit) {
+        removeSegregatedFreeBlock(pAivHeap, pBlock);
+    }
 
     // There are two scenarios - whether the new header + minimal block size will fit or not
     // In case we end up with smaller block then we will just attach that to the allocated
@@ -491,7 +602,7 @@ VOID splitFreeBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock, UINT32 siz
         // Fix the prev block
         if (pBlock->pPrev != NULL) {
             pBlock->pPrev->pNext = pBlock->pNext;
-        } else {
+        } else if (!pAivHeap->segregatedFit) {
             // this is the case where we need to Fix-up the pAivHeap->pFree
             CHECK_EXT(pAivHeap->pFree == pBlock, "Free block pointer is invalid");
             pAivHeap->pFree = pBlock->pNext;
@@ -541,7 +652,7 @@ VOID splitFreeBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock, UINT32 siz
         // Fix the prev block
         if (pNewFree->pPrev != NULL) {
             pNewFree->pPrev->pNext = pNewFree;
-        } else {
+        } else if (!pAivHeap->segregatedFit) {
             // This is the case where we need to Fix-up the pAivHeap->pFree
             CHECK_EXT(pAivHeap->pFree == pBlock, "Free block pointer is invalid");
             pAivHeap->pFree = pNewFree;
@@ -550,6 +661,16 @@ VOID splitFreeBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock, UINT32 siz
         // Set the type of the block
         pNewFree->state = ALLOCATION_FLAGS_FREE;
 
+        // Link the new free block with its physical neighbors and add it to its size class
+        if (pAivHeap->segregatedFit) {
+            setPrevPhysicalBlock(pAivHeap, pNewFree, pBlock);
+            if (NULL != (pNext = getNextPhysicalBlock(pAivHeap, pNewFree))) {
+                setPrevPhysicalBlock(pAivHeap, pNext, pNewFree);
+            }
+
+            insertSegregatedFreeBlock(pAivHeap, pNewFree);
+        }
+
         // adjust the free block size
         ((PALLOCATION_HEADER)pBlock)->size = size;
 
@@ -567,6 +688,49 @@ VOID splitFreeBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock, UINT32 siz
     pBlock->allocSize = size;
 }
 
+/**
+ * Shrinks the allocated block in-place and returns the trailing space to the free list
+ */
+VOID shrinkAllocatedBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock, UINT32 size)
+{
+    CHECK(pAivHeap != NULL && pBlock != NULL && size > 0 && size <= ((PALLOCATION_HEADER)pBlock)->size);
+
+    PAIV_ALLOCATION_HEADER pNewFree = NULL;
+    UINT32 remainingSize = ((PALLOCATION_HEADER)pBlock)->size - size;
+
+    // Set the requested size first - this is all we do if the trailing space is too small for a free block
+    pBlock->allocSize = size;
+
+    if (remainingSize < AIV_ALLOCATION_HEADER_SIZE + MIN_FREE_ALLOCATION_SIZE + AIV_ALLOCATION_FOOTER_SIZE) {
+        return;
+    }
+
+    // Carve out the new free block right after the footer of the shrunk allocation
+    pNewFree = (PAIV_ALLOCATION_HEADER)((PBYTE)(pBlock + 1) + size + AIV_ALLOCATION_FOOTER_SIZE);
+    MEMCPY(pNewFree, &gAivHeader, AIV_ALLOCATION_HEADER_SIZE);
+    ((PALLOCATION_HEADER)pNewFree)->size = remainingSize - AIV_ALLOCATION_HEADER_SIZE;
+    pNewFree->state = ALLOCATION_FLAGS_NONE;
+
+#ifdef HEAP_DEBUG
+    // Null the memory in debug mode
+    MEMSET(pNewFree + 1, 0x00, ((PALLOCATION_HEADER)pNewFree)->size);
+#endif
+
+    // Adjust the block size and set the footer
+    ((PALLOCATION_HEADER)pBlock)->size = size;
+    MEMCPY((PBYTE)(pBlock + 1) + size, &gAivFooter, AIV_ALLOCATION_FOOTER_SIZE);
+
+    if (pAivHeap->segregatedFit) {
+        setPrevPhysicalBlock(pAivHeap, pNewFree, pBlock);
+    }
+
+    // Fix-up the heap size as the trailing space is no longer in use
+    ((PHeap)pAivHeap)->heapSize -= remainingSize;
+
+    // Add to the free list which will coalesce with the following free block if any
+    addFreeBlock(pAivHeap, pNewFree);
+}
+
 /**
  * Adds the newly allocated block to the head of the allocations.
  */
@@ -637,6 +801,11 @@ VOID addFreeBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock)
                   pBlock->pNext == NULL && pBlock->pPrev == NULL &&
                   pBlock->state == ALLOCATION_FLAGS_NONE);
 
+    if (pAivHeap->segregatedFit) {
+        addSegregatedFreeBlock(pAivHeap, pBlock);
+        return;
+    }
+
     // Set as free
     pBlock->state = ALLOCATION_FLAGS_FREE;
 
@@ -784,3 +953,236 @@ BOOL checkOverlap(PAIV_ALLOCATION_HEADER pBlock1, PAIV_ALLOCATION_HEADER pBlock2
         return (PBYTE)(pBlock2 + 1) + ((PALLOCATION_HEADER)pBlock2)->size > (PBYTE)pBlock1;
     }
 }
+
+/**
+ * Segregated fit block lookup. The size is rounded up to the next size class so any block
+ * in the first non-empty class at or above it will fit. If none is found the list of the
+ * exact size class is searched as it might contain a large enough block.
+ */
+PAIV_ALLOCATION_HEADER getSegregatedFreeBlock(PAivHeap pAivHeap, UINT32 allocationSize)
+{
+    CHECK(pAivHeap != NULL && allocationSize > 0);
+
+    PAIV_ALLOCATION_HEADER pFree;
+    UINT32 fl, sl, slMap, flMap;
+    UINT64 roundedSize = allocationSize;
+
+    if (allocationSize >= AIV_SEGREGATED_SL_INDEX_COUNT) {
+        roundedSize += (1 << (bitScanReverse(allocationSize) - AIV_SEGREGATED_SL_INDEX_LOG2)) - 1;
+    }
+
+    if (roundedSize <= MAX_UINT32) {
+        getSegregatedIndex((UINT32) roundedSize, &fl, &sl);
+
+        // Check the second level classes of the same first level and then the higher first levels
+        slMap = pAivHeap->slBitmap[fl] & (MAX_UINT32 << sl);
+        if (slMap == 0) {
+            flMap = fl + 1 < AIV_SEGREGATED_FL_INDEX_COUNT ? pAivHeap->flBitmap & (MAX_UINT32 << (fl + 1)) : 0;
+            if (flMap != 0) {
+                fl = bitScanForward(flMap);
+                slMap = pAivHeap->slBitmap[fl];
+            }
+        }
+
+        if (slMap != 0) {
+            return pAivHeap->freeLists[fl][bitScanForward(slMap)];
+        }
+    }
+
+    // Fall back to the exact size class
+    getSegregatedIndex(allocationSize, &fl, &sl);
+    for (pFree = pAivHeap->freeLists[fl][sl]; pFree != NULL; pFree = pFree->pNext) {
+        if (((PALLOCATION_HEADER)pFree)->size >= allocationSize) {
+            return pFree;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Adds a free block to the segregated free lists coalescing with the free physical neighbors
+ */
+VOID addSegregatedFreeBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock)
+{
+    CHECK(pAivHeap != NULL && pBlock != NULL && pBlock->state == ALLOCATION_FLAGS_NONE);
+
+    PAIV_ALLOCATION_HEADER pNext, pPrev;
+
+    // Try the next first
+    pNext = getNextPhysicalBlock(pAivHeap, pBlock);
+    if (pNext != NULL && pNext->state == ALLOCATION_FLAGS_FREE) {
+        DLOGS("Coalescing %p (size %u) with %p (size %u)", pBlock, ((PALLOCATION_HEADER)pBlock)->size,
+              pNext, ((PALLOCATION_HEADER)pNext)->size);
+        removeSegregatedFreeBlock(pAivHeap, pNext);
+        ((PALLOCATION_HEADER)pBlock)->size += ((PALLOCATION_HEADER)pNext)->size + AIV_ALLOCATION_HEADER_SIZE;
+        pNext->state = ALLOCATION_FLAGS_NONE;
+    }
+
+    // Try the previous block
+    pPrev = getPrevPhysicalBlock(pAivHeap, pBlock);
+    if (pPrev != NULL && pPrev->state == ALLOCATION_FLAGS_FREE) {
+        DLOGS("Coalescing %p (size %u) with %p (size %u)", pPrev, ((PALLOCATION_HEADER)pPrev)->size,
+              pBlock, ((PALLOCATION_HEADER)pBlock)->size);
+        removeSegregatedFreeBlock(pAivHeap, pPrev);
+        ((PALLOCATION_HEADER)pPrev)->size += ((PALLOCATION_HEADER)pBlock)->size + AIV_ALLOCATION_HEADER_SIZE;
+        pBlock->state = ALLOCATION_FLAGS_NONE;
+        pBlock = pPrev;
+    }
+
+    pBlock->state = ALLOCATION_FLAGS_FREE;
+
+    // Fix-up the physical link of the following block
+    if (NULL != (pNext = getNextPhysicalBlock(pAivHeap, pBlock))) {
+        setPrevPhysicalBlock(pAivHeap, pNext, pBlock);
+    }
+
+    insertSegregatedFreeBlock(pAivHeap, pBlock);
+}
+
+/**
+ * Inserts the free block at the head of its size class list
+ */
+VOID insertSegregatedFreeBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock)
+{
+    CHECK(pAivHeap != NULL && pBlock != NULL);
+
+    UINT32 fl, sl;
+
+    getSegregatedIndex(((PALLOCATION_HEADER)pBlock)->size, &fl, &sl);
+
+    pBlock->pPrev = NULL;
+    pBlock->pNext = pAivHeap->freeLists[fl][sl];
+    if (pBlock->pNext != NULL) {
+        pBlock->pNext->pPrev = pBlock;
+    }
+
+    pAivHeap->freeLists[fl][sl] = pBlock;
+    pAivHeap->flBitmap |= 1 << fl;
+    pAivHeap->slBitmap[fl] |= 1 << sl;
+}
+
+/**
+ * Removes the free block from its size class list
+ */
+VOID removeSegregatedFreeBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock)
+{
+    CHECK(pAivHeap != NULL && pBlock != NULL);
+
+    UINT32 fl, sl;
+
+    getSegregatedIndex(((PALLOCATION_HEADER)pBlock)->size, &fl, &sl);
+
+    if (pBlock->pNext != NULL) {
+        pBlock->pNext->pPrev = pBlock->pPrev;
+    }
+
+    if (pBlock->pPrev != NULL) {
+        pBlock->pPrev->pNext = pBlock->pNext;
+    } else {
+        CHECK_EXT(pAivHeap->freeLists[fl][sl] == pBlock, "Free list head pointer is invalid");
+        pAivHeap->freeLists[fl][sl] = pBlock->pNext;
+
+        // Clear the bitmaps if the list became empty
+        if (pBlock->pNext == NULL) {
+            pAivHeap->slBitmap[fl] &= ~(1 << sl);
+            if (pAivHeap->slBitmap[fl] == 0) {
+                pAivHeap->flBitmap &= ~(1 << fl);
+            }
+        }
+    }
+
+    pBlock->pNext = pBlock->pPrev = NULL;
+}
+
+/**
+ * Maps the block size to the first and second level indexes. Sizes less than the second level
+ * count map linearly to the first level index 0.
+ */
+VOID getSegregatedIndex(UINT32 size, PUINT32 pFl, PUINT32 pSl)
+{
+    UINT32 msb;
+
+    if (size < AIV_SEGREGATED_SL_INDEX_COUNT) {
+        *pFl = 0;
+        *pSl = size;
+    } else {
+        msb = bitScanReverse(size);
+        *pFl = msb - AIV_SEGREGATED_SL_INDEX_LOG2 + 1;
+        *pSl = (size >> (msb - AIV_SEGREGATED_SL_INDEX_LOG2)) - AIV_SEGREGATED_SL_INDEX_COUNT;
+    }
+}
+
+/**
+ * Returns the physically following block or NULL if it's the last block in the heap.
+ * Allocated block size doesn't include the footer.
+ */
+PAIV_ALLOCATION_HEADER getNextPhysicalBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock)
+{
+    PBYTE pNext = (PBYTE)(pBlock + 1) + ((PALLOCATION_HEADER)pBlock)->size;
+
+    if (pBlock->state == ALLOCATION_FLAGS_ALLOC) {
+        pNext += AIV_ALLOCATION_FOOTER_SIZE;
+    }
+
+    if (pNext >= (PBYTE) pAivHeap->pAllocation + ((PHeap) pAivHeap)->heapLimit) {
+        return NULL;
+    }
+
+    return (PAIV_ALLOCATION_HEADER) pNext;
+}
+
+/**
+ * Returns the physically preceding block or NULL if it's the first block in the heap
+ */
+PAIV_ALLOCATION_HEADER getPrevPhysicalBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock)
+{
+    if ((PVOID) pBlock == pAivHeap->pAllocation) {
+        return NULL;
+    }
+
+    return (PAIV_ALLOCATION_HEADER)((PBYTE) pAivHeap->pAllocation + ((PALLOCATION_HEADER)pBlock)->handle);
+}
+
+/**
+ * Stores the physically preceding block offset in the block header
+ */
+VOID setPrevPhysicalBlock(PAivHeap pAivHeap, PAIV_ALLOCATION_HEADER pBlock, PAIV_ALLOCATION_HEADER pPrev)
+{
+    ((PALLOCATION_HEADER)pBlock)->handle = (UINT32)((PBYTE) pPrev - (PBYTE) pAivHeap->pAllocation);
+}
+
+/**
+ * Index of the least significant bit set. The value should not be 0.
+ */
+UINT32 bitScanForward(UINT32 value)
+{
+#if defined(__GNUC__)
+    return (UINT32) __builtin_ctz(value);
+#else
+    UINT32 index = 0;
+    while ((value & 1) == 0) {
+        value >>= 1;
+        index++;
+    }
+
+    return index;
+#endif
+}
+
+/**
+ * Index of the most significant bit set. The value should not be 0.
+ */
+UINT32 bitScanReverse(UINT32 value)
+{
+#if defined(__GNUC__)
+    return 31 - (UINT32) __builtin_clz(value);
+#else
+    UINT32 index = 0;
+    while (value >>= 1) {
+        index++;
+    }
+
+    return index;
+#endif
+}
@@ -46,6 +46,14 @@ typedef struct
  */
 #define MIN_FREE_ALLOCATION_SIZE 16
 
+/**
+ * Segregated fit (TLSF) size class configuration. Each power of two size range is
+ * split into 2^AIV_SEGREGATED_SL_INDEX_LOG2 linearly spaced second level classes.
+ */
+#define AIV_SEGREGATED_SL_INDEX_LOG2 4
+#define AIV_SEGREGATED_SL_INDEX_COUNT (1 << AIV_SEGREGATED_SL_INDEX_LOG2)
+#define AIV_SEGREGATED_FL_INDEX_COUNT (32 - AIV_SEGREGATED_SL_INDEX_LOG2 + 1)
+
 /**
  * AIV heap struct
  */
@@ -61,11 +69,35 @@ typedef struct
      */
     PVOID pAllocation;
 
+    /**
+     * Whether the large allocation is provided by the caller and is not owned by the heap
+     */
+    BOOL externalAllocation;
+
     /**
      * Pointers to free and allocated lists
      */
     PAIV_ALLOCATION_HEADER pFree;
     PAIV_ALLOCATION_HEADER pAlloc;
+
+    /**
+     * Whether to use the segregated fit free lists instead of the address ordered free list.
+     *
+     * NOTE: In this mode the unused handle field of the block header stores the offset of
+     * the physically preceding block to allow O(1) coalescing.
+     */
+    BOOL segregatedFit;
+
+    /**
+     * Bitmaps of the non-empty segregated fit free lists
+     */
+    UINT32 flBitmap;
+    UINT32 slBitmap[AIV_SEGREGATED_FL_INDEX_COUNT];
+
+    /**
+     * Segregated fit free lists
+     */
+    PAIV_ALLOCATION_HEADER freeLists[AIV_SEGREGATED_FL_INDEX_COUNT][AIV_SEGREGATED_SL_INDEX_COUNT];
 } AivHeap, *PAivHeap;
 
 /**
@@ -73,6 +105,11 @@ typedef struct
  */
 DEFINE_CREATE_HEAP(aivHeapCreate);
 
+/**
+ * Creates the heap with segregated fit free lists
+ */
+DEFINE_CREATE_HEAP(aivSegregatedFitHeapCreate);
+
 /**
  * Allocate a buffer from the heap
  */
@@ -88,6 +125,11 @@ DEFINE_HEAP_FREE(aivHeapFree);
  */
 DEFINE_HEAP_GET_ALLOC_SIZE(aivHeapGetAllocSize);
 
+/**
+ * Shrinks the allocation in-place
+ */
+DEFINE_HEAP_SET_ALLOC_SIZE(aivHeapSetAllocSize);
+
 /**
  * Maps the allocation handle to memory. This is needed for in-direct allocation on vRAM
  */
@@ -108,6 +150,12 @@ DEFINE_RELEASE_HEAP(aivHeapRelease);
  */
 DEFINE_INIT_HEAP(aivHeapInit);
 
+/**
+ * Initialize the heap over a caller provided buffer of the heap limit size.
+ * The buffer is not freed on release. NULL buffer will allocate the heap memory.
+ */
+STATUS aivHeapInitWithBuffer(PHeap, UINT64, PVOID);
+
 /**
  * Debug/check heap
  */
@@ -126,6 +174,7 @@ DEFINE_HEAP_LIMITS(aivGetHeapLimits);
  */
 PAIV_ALLOCATION_HEADER getFreeBlock(PAivHeap, UINT32);
 VOID splitFreeBlock(PAivHeap, PAIV_ALLOCATION_HEADER, UINT32);
+VOID shrinkAllocatedBlock(PAivHeap, PAIV_ALLOCATION_HEADER, UINT32);
 VOID addAllocatedBlock(PAivHeap, PAIV_ALLOCATION_HEADER);
 VOID removeAllocatedBlock(PAivHeap, PAIV_ALLOCATION_HEADER);
 VOID addFreeBlock(PAivHeap, PAIV_ALLOCATION_HEADER);
@@ -134,6 +183,20 @@ VOID insertFreeBlockLast(PAIV_ALLOCATION_HEADER, PAIV_ALLOCATION_HEADER);
 VOID coalesceFreeBlock(PAIV_ALLOCATION_HEADER);
 BOOL checkOverlap(PAIV_ALLOCATION_HEADER, PAIV_ALLOCATION_HEADER);
 
+/**
+ * AIV Heap segregated fit functions
+ */
+PAIV_ALLOCATION_HEADER getSegregatedFreeBlock(PAivHeap, UINT32);
+VOID addSegregatedFreeBlock(PAivHeap, PAIV_ALLOCATION_HEADER);
+VOID insertSegregatedFreeBlock(PAivHeap, PAIV_ALLOCATION_HEADER);
+VOID removeSegregatedFreeBlock(PAivHeap, PAIV_ALLOCATION_HEADER);
+VOID getSegregatedIndex(UINT32, PUINT32, PUINT32);
+PAIV_ALLOCATION_HEADER getNextPhysicalBlock(PAivHeap, PAIV_ALLOCATION_HEADER);
+PAIV_ALLOCATION_HEADER getPrevPhysicalBlock(PAivHeap, PAIV_ALLOCATION_HEADER);
+VOID setPrevPhysicalBlock(PAivHeap, PAIV_ALLOCATION_HEADER, PAIV_ALLOCATION_HEADER);
+UINT32 bitScanForward(UINT32);
+UINT32 bitScanReverse(UINT32);
+
 #ifdef __cplusplus
 }
 #endif
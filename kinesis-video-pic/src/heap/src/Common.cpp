@@ -163,6 +163,30 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Sets the allocation size
+ */
+DEFINE_HEAP_SET_ALLOC_SIZE(commonHeapSetAllocSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    DLOGS("Setting the allocation size for handle 0x%016" PRIx64 " to %u", handle, size);
+
+    // Validate the arguments
+    CHK(pHeap != NULL, STATUS_NULL_ARG);
+    CHK(handle != INVALID_ALLOCATION_HANDLE_VALUE && size != 0, STATUS_INVALID_ARG);
+
+    // Check if we are initialized by looking at heap limit
+    CHK_ERR(pHeap->heapLimit != 0, STATUS_HEAP_NOT_INITIALIZED, "Heap has not been initialized.");
+
+    // Validate the heap
+    CHK_STATUS(validateHeap(pHeap));
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
 /**
  * Allocate from the heap
  */
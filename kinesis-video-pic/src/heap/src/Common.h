@@ -53,6 +53,11 @@ DEFINE_GET_HEAP_SIZE(commonHeapGetSize);
  */
 DEFINE_HEAP_GET_ALLOC_SIZE(commonHeapGetAllocSize);
 
+/**
+ * Shrinks the allocation in-place
+ */
+DEFINE_HEAP_SET_ALLOC_SIZE(commonHeapSetAllocSize);
+
 /**
  * Maps the allocation handle to memory. This is needed for in-direct allocation on vRAM
  */
@@ -36,11 +36,27 @@ CleanUp:
  *      @ppHeap - The returned pointer to the Heap object
  */
 STATUS heapInitialize(UINT64 heapLimit, UINT32 spillRatio, UINT32 behaviorFlags, PHeap* ppHeap)
+{
+    return heapInitializeWithRootDirectory(heapLimit, spillRatio, behaviorFlags, NULL, ppHeap);
+}
+
+/**
+ * Initialize and returns the heap object
+ *
+ * Param:
+ *      @heapLimit - The overall size of the heap
+ *      @spillRatio - Spill ratio in percentage of direct allocation RAM vs. vRAM or files in the hybrid heap scenario
+ *      @behaviorFlags - Flags controlling the behavior/type of the heap
+ *      @rootDirectory - The directory for the hybrid file heap segment files. Optional otherwise.
+ *      @ppHeap - The returned pointer to the Heap object
+ */
+STATUS heapInitializeWithRootDirectory(UINT64 heapLimit, UINT32 spillRatio, UINT32 behaviorFlags, PCHAR rootDirectory, PHeap* ppHeap)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PHeap pHeap = NULL;
     PHybridHeap pHybridHeap = NULL;
+    PHybridFileHeap pHybridFileHeap = NULL;
     UINT32 heapTypeFlags = (behaviorFlags & (FLAGS_USE_AIV_HEAP | FLAGS_USE_SYSTEM_HEAP));
 
     CHK(ppHeap != NULL, STATUS_NULL_ARG);
@@ -62,6 +78,9 @@ STATUS heapInitialize(UINT64 heapLimit, UINT32 spillRatio, UINT32 behaviorFlags,
     if ((behaviorFlags & FLAGS_USE_SYSTEM_HEAP) != HEAP_FLAGS_NONE) {
         DLOGI("Creating system heap.");
         CHK_STATUS(sysHeapCreate(&pHeap));
+    } else if ((behaviorFlags & FLAGS_USE_AIV_SEGREGATED_FIT) != HEAP_FLAGS_NONE) {
+        DLOGI("Creating AIV heap with segregated fit free lists.");
+        CHK_STATUS(aivSegregatedFitHeapCreate(&pHeap));
     } else {
         DLOGI("Creating AIV heap.");
         CHK_STATUS(aivHeapCreate(&pHeap));
@@ -74,6 +93,12 @@ STATUS heapInitialize(UINT64 heapLimit, UINT32 spillRatio, UINT32 behaviorFlags,
 
         // Store the hybrid heap as the returned heap object
         pHeap = (PHeap) pHybridHeap;
+    } else if ((behaviorFlags & FLAGS_USE_HYBRID_FILE_HEAP) != HEAP_FLAGS_NONE) {
+        DLOGI("Creating hybrid file heap with flags: 0x%08x", behaviorFlags);
+        CHK_STATUS(hybridFileCreateHeap(pHeap, spillRatio, behaviorFlags, rootDirectory, &pHybridFileHeap));
+
+        // Store the hybrid heap as the returned heap object
+        pHeap = (PHeap) pHybridFileHeap;
     }
 
     // Just in case - validate the final heap object
@@ -163,15 +188,20 @@ STATUS heapAlloc(PHeap pHeap, UINT32 size, PALLOCATION_HANDLE pHandle)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
+    ProfilerTrace profilerTrace = PROFILER_TRACE_INITIALIZER;
     PBaseHeap pBase = (PBaseHeap) pHeap;
 
     CHK(pBase != NULL && pHandle != NULL, STATUS_NULL_ARG);
     CHK(size != 0, STATUS_INVALID_ARG);
 
+    PROFILER_TRACE_START("heapAlloc", TRACE_LEVEL_DEBUG, &profilerTrace);
+
     DLOGS("Allocating %u bytes", size);
     CHK_STATUS(pBase->heapAllocFn(pHeap, size, pHandle));
 
 CleanUp:
+    PROFILER_TRACE_STOP(profilerTrace);
+
     LEAVES();
     return retStatus;
 }
@@ -187,15 +217,20 @@ STATUS heapFree(PHeap pHeap, ALLOCATION_HANDLE handle)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
+    ProfilerTrace profilerTrace = PROFILER_TRACE_INITIALIZER;
     PBaseHeap pBase = (PBaseHeap) pHeap;
 
     CHK(pBase != NULL, STATUS_NULL_ARG);
     CHK(IS_VALID_ALLOCATION_HANDLE(handle), STATUS_INVALID_ARG);
 
+    PROFILER_TRACE_START("heapFree", TRACE_LEVEL_DEBUG, &profilerTrace);
+
     DLOGS("Freeing allocation handle 0x%016" PRIx64, handle);
     CHK_STATUS(pBase->heapFreeFn(pHeap, handle));
 
 CleanUp:
+    PROFILER_TRACE_STOP(profilerTrace);
+
     LEAVES();
     return retStatus;
 }
@@ -225,6 +260,31 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Shrinks the allocation in-place. The handle remains valid.
+ *
+ * Param:
+ *      @pHeap - The heap pointer
+ *      @handle - The allocated memory handle
+ *      @size - The new size of the allocation which can't be larger than the current size
+ */
+STATUS heapSetAllocSize(PHeap pHeap, ALLOCATION_HANDLE handle, UINT32 size)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBaseHeap pBase = (PBaseHeap) pHeap;
+
+    CHK(pBase != NULL, STATUS_NULL_ARG);
+    CHK(IS_VALID_ALLOCATION_HANDLE(handle) && size != 0, STATUS_INVALID_ARG);
+
+    DLOGS("Sets allocation size for handle 0x%016" PRIx64 " to %u bytes", handle, size);
+    CHK_STATUS(pBase->heapSetAllocSizeFn(pHeap, handle, size));
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
 /**
  * Maps the previously allocated memory handle.
  *
@@ -238,15 +298,20 @@ STATUS heapMap(PHeap pHeap, ALLOCATION_HANDLE handle, PVOID* ppAllocation, PUINT
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
+    ProfilerTrace profilerTrace = PROFILER_TRACE_INITIALIZER;
     PBaseHeap pBase = (PBaseHeap) pHeap;
 
     CHK(pBase != NULL && ppAllocation != NULL, STATUS_NULL_ARG);
     CHK(IS_VALID_ALLOCATION_HANDLE(handle), STATUS_INVALID_ARG);
 
+    PROFILER_TRACE_START("heapMap", TRACE_LEVEL_DEBUG, &profilerTrace);
+
     DLOGS("Mapping handle 0x%016" PRIx64, handle);
     CHK_STATUS(pBase->heapMapFn(pHeap, handle, ppAllocation, pSize));
 
 CleanUp:
+    PROFILER_TRACE_STOP(profilerTrace);
+
     LEAVES();
     return retStatus;
 }
@@ -262,14 +327,19 @@ STATUS heapUnmap(PHeap pHeap, PVOID pAllocation)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
+    ProfilerTrace profilerTrace = PROFILER_TRACE_INITIALIZER;
     PBaseHeap pBase = (PBaseHeap) pHeap;
 
     CHK(pBase != NULL && pAllocation != NULL, STATUS_NULL_ARG);
 
+    PROFILER_TRACE_START("heapUnmap", TRACE_LEVEL_DEBUG, &profilerTrace);
+
     DLOGS("Un-mapping buffer: %p", pAllocation);
     CHK_STATUS(pBase->heapUnmapFn(pHeap, pAllocation));
 
 CleanUp:
+    PROFILER_TRACE_STOP(profilerTrace);
+
     LEAVES();
     return retStatus;
 }
@@ -0,0 +1,835 @@
+/**
+ * Implementation of a heap based on RAM heap spilling into memory mapped files
+ */
+
+#define LOG_CLASS "HybridFileHeap"
+#include "Include_i.h"
+
+#if !defined _WIN32 && !defined _WIN64
+#include <fcntl.h>
+#include <sys/mman.h>
+#define FILE_HEAP_MMAP_SUPPORTED
+#endif
+
+STATUS hybridFileCreateHeap(PHeap pHeap, UINT32 spillRatio, UINT32 behaviorFlags, PCHAR rootDirectory, PHybridFileHeap* ppHybridHeap)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PHybridFileHeap pHybridHeap = NULL;
+    PBaseHeap pBaseHeap = NULL;
+    UINT32 rootDirectoryLen;
+
+    CHK(pHeap != NULL && ppHybridHeap != NULL, STATUS_NULL_ARG);
+    CHK(spillRatio <= 100, STATUS_INVALID_ARG);
+    CHK_ERR(rootDirectory != NULL && rootDirectory[0] != '\0', STATUS_INVALID_ARG, "Hybrid file heap requires a root directory");
+
+#ifndef FILE_HEAP_MMAP_SUPPORTED
+    CHK_ERR(FALSE, STATUS_NOT_IMPLEMENTED, "Memory mapped files are not supported on this platform");
+#endif
+
+    DLOGS("Creating hybrid file heap with spill ratio %d in %s", spillRatio, rootDirectory);
+
+    // Store the root directory after the struct
+    rootDirectoryLen = (UINT32) STRLEN(rootDirectory);
+    CHK_STATUS(commonHeapCreate((PHeap*) &pHybridHeap, SIZEOF(HybridFileHeap) + (rootDirectoryLen + 1) * SIZEOF(CHAR)));
+
+    // Set the values
+    pHybridHeap->pMemHeap = (PBaseHeap) pHeap;
+    pHybridHeap->spillRatio = (DOUBLE)spillRatio / 100;
+    pHybridHeap->behaviorFlags = behaviorFlags;
+    pHybridHeap->pSegments = NULL;
+    pHybridHeap->segmentCount = 0;
+    pHybridHeap->currentSegment = 0;
+    pHybridHeap->pEntries = NULL;
+    pHybridHeap->entryCount = 0;
+    pHybridHeap->freeEntry = FILE_HEAP_ENTRY_NONE;
+    pHybridHeap->memHead = FILE_HEAP_ENTRY_NONE;
+    pHybridHeap->memTail = FILE_HEAP_ENTRY_NONE;
+    pHybridHeap->pMappings = NULL;
+    pHybridHeap->rootDirectory = (PCHAR) (pHybridHeap + 1);
+    MEMCPY(pHybridHeap->rootDirectory, rootDirectory, rootDirectoryLen * SIZEOF(CHAR));
+    pHybridHeap->rootDirectory[rootDirectoryLen] = '\0';
+
+    // Return hybrid heap
+    *ppHybridHeap = pHybridHeap;
+
+    // Set the function pointers
+    pBaseHeap = (PBaseHeap) pHybridHeap;
+    pBaseHeap->heapInitializeFn = hybridFileHeapInit;
+    pBaseHeap->heapReleaseFn = hybridFileHeapRelease;
+    pBaseHeap->heapGetSizeFn = commonHeapGetSize; // Use the common heap functionality
+    pBaseHeap->heapAllocFn = hybridFileHeapAlloc;
+    pBaseHeap->heapFreeFn = hybridFileHeapFree;
+    pBaseHeap->heapGetAllocSizeFn = hybridFileHeapGetAllocSize;
+    pBaseHeap->heapSetAllocSizeFn = hybridFileHeapSetAllocSize;
+    pBaseHeap->heapMapFn = hybridFileHeapMap;
+    pBaseHeap->heapUnmapFn = hybridFileHeapUnmap;
+    pBaseHeap->heapDebugCheckAllocatorFn = hybridFileHeapDebugCheckAllocator;
+    pBaseHeap->getAllocationSizeFn = hybridFileGetAllocationSize;
+    pBaseHeap->getAllocationHeaderSizeFn = hybridFileGetAllocationHeaderSize;
+    pBaseHeap->getAllocationFooterSizeFn = hybridFileGetAllocationFooterSize;
+    pBaseHeap->getHeapLimitsFn = hybridFileGetHeapLimits;
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Creates the segment file, maps it into the address space and sets up the segment heap over the mapping.
+ *
+ * NOTE: The file is unlinked right after it's mapped so the storage is reclaimed when the heap
+ * is released or the process terminates. The dirty pages are written back to the file by the OS
+ * so the RAM usage is not growing with the size of the segments.
+ */
+STATUS hybridFileCreateSegment(PHybridFileHeap pHybridHeap, UINT32 index, UINT64 size)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFileHeapSegment pSegment = NULL;
+    CHAR filePath[MAX_PATH_LEN + 1];
+    INT32 fd = -1;
+    PVOID pMapping = NULL;
+
+    CHK(pHybridHeap != NULL && index < pHybridHeap->segmentCount, STATUS_INVALID_ARG);
+    pSegment = &pHybridHeap->pSegments[index];
+
+#ifdef FILE_HEAP_MMAP_SUPPORTED
+    SNPRINTF(filePath, MAX_PATH_LEN, FILE_HEAP_SEGMENT_FILE_NAME_FORMAT, pHybridHeap->rootDirectory, FPATHSEPARATOR, index,
+             (unsigned long long) (UINT_PTR) pHybridHeap);
+    filePath[MAX_PATH_LEN] = '\0';
+
+    CHK_ERR(-1 != (fd = open(filePath, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR)),
+            STATUS_HEAP_FILE_OPEN_FAILED,
+            "Failed to create heap segment file %s with errno %d",
+            filePath,
+            errno);
+
+    // The file is sparse and will grow on the disk as the pages are written
+    CHK_ERR(0 == ftruncate(fd, (off_t) size),
+            STATUS_HEAP_FILE_OPEN_FAILED,
+            "Failed to size heap segment file %s to %" PRIu64 " bytes with errno %d",
+            filePath,
+            size,
+            errno);
+
+    CHK_ERR(MAP_FAILED != (pMapping = mmap(NULL, (size_t) size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)),
+            STATUS_HEAP_FILE_MAP_FAILED,
+            "Failed to map heap segment file %s with errno %d",
+            filePath,
+            errno);
+
+    pSegment->pMapping = pMapping;
+    pSegment->size = size;
+
+    // Set up the segment heap over the mapping
+    if ((pHybridHeap->behaviorFlags & FLAGS_USE_AIV_SEGREGATED_FIT) != HEAP_FLAGS_NONE) {
+        CHK_STATUS(aivSegregatedFitHeapCreate((PHeap*) &pSegment->pHeap));
+    } else {
+        CHK_STATUS(aivHeapCreate((PHeap*) &pSegment->pHeap));
+    }
+
+    CHK_STATUS(aivHeapInitWithBuffer((PHeap) pSegment->pHeap, size, pMapping));
+#endif
+
+CleanUp:
+
+#ifdef FILE_HEAP_MMAP_SUPPORTED
+    if (fd != -1) {
+        close(fd);
+
+        // The mapping keeps the file alive
+        FUNLINK(filePath);
+    }
+#endif
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Propagates the usage change of the contained heap to the hybrid heap
+ */
+VOID hybridFileUpdateUsage(PHeap pHeap, PBaseHeap pSubHeap, UINT64 prevHeapSize, UINT64 prevNumAlloc)
+{
+    pHeap->heapSize += pSubHeap->heap.heapSize - prevHeapSize;
+    pHeap->numAlloc += pSubHeap->heap.numAlloc - prevNumAlloc;
+}
+
+/**
+ * Debug print analytics information
+ */
+DEFINE_HEAP_CHK(hybridFileHeapDebugCheckAllocator)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PHybridFileHeap pHybridHeap = (PHybridFileHeap) pHeap;
+    UINT32 i;
+
+    // Try the contained heaps first
+    CHK_STATUS(pHybridHeap->pMemHeap->heapDebugCheckAllocatorFn((PHeap) pHybridHeap->pMemHeap, dump));
+
+    for (i = 0; i < pHybridHeap->segmentCount; i++) {
+        CHK_STATUS(pHybridHeap->pSegments[i].pHeap->heapDebugCheckAllocatorFn((PHeap) pHybridHeap->pSegments[i].pHeap, dump));
+    }
+
+    // Delegate the call directly
+    CHK_STATUS(commonHeapDebugCheckAllocator(pHeap, dump));
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Initialize the heap
+ */
+DEFINE_INIT_HEAP(hybridFileHeapInit)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PHybridFileHeap pHybridHeap = (PHybridFileHeap) pHeap;
+    UINT64 memHeapLimit, fileHeapLimit, segmentSize;
+    UINT32 i, segmentCount;
+
+    // Calculate the in-memory and file based heap sizes
+    memHeapLimit = (UINT64) (heapLimit * pHybridHeap->spillRatio);
+    fileHeapLimit = heapLimit - memHeapLimit;
+    segmentCount = (UINT32) MAX(1, fileHeapLimit / FILE_HEAP_SEGMENT_SIZE);
+
+    // Validate the sizes of the contained heaps before creating any of the files.
+    // The segments are at least the segment size except for a single segment holding the entire file heap.
+    CHK_ERR(memHeapLimit >= MIN_HEAP_SIZE,
+            STATUS_INVALID_ARG,
+            "In-memory heap size %" PRIu64 " is less than the min heap size %" PRIu64,
+            memHeapLimit,
+            (UINT64) MIN_HEAP_SIZE);
+    CHK_ERR(fileHeapLimit == 0 || fileHeapLimit >= MIN_HEAP_SIZE,
+            STATUS_INVALID_ARG,
+            "File heap size %" PRIu64 " is less than the min heap size %" PRIu64,
+            fileHeapLimit,
+            (UINT64) MIN_HEAP_SIZE);
+    CHK_ERR(segmentCount <= MAX_FILE_HEAP_SEGMENT_COUNT,
+            STATUS_INVALID_ARG,
+            "File heap size %" PRIu64 " requires more than %u segments",
+            fileHeapLimit,
+            MAX_FILE_HEAP_SEGMENT_COUNT);
+
+    // Delegate the call directly
+    CHK_STATUS(commonHeapInit(pHeap, heapLimit));
+
+    // Index of the mapped allocations
+    CHK_STATUS(hashTableCreateOpenAddressing(FILE_HEAP_DEFAULT_MAPPING_COUNT, &pHybridHeap->pMappings));
+
+    // Initialize the encapsulated heap
+    CHK_STATUS_ERR(pHybridHeap->pMemHeap->heapInitializeFn((PHeap) pHybridHeap->pMemHeap, memHeapLimit),
+                   STATUS_HEAP_DIRECT_MEM_INIT,
+                   "Failed to initialize the in-memory heap with limit size %" PRIu64,
+                   memHeapLimit);
+
+    // Nothing is spilled to the files in case of the entire heap in memory
+    CHK(fileHeapLimit != 0, retStatus);
+
+    // Split the file based heap evenly into the segments of at least the segment size
+    pHybridHeap->segmentCount = segmentCount;
+    pHybridHeap->pSegments = (PFileHeapSegment) MEMCALLOC(pHybridHeap->segmentCount, SIZEOF(FileHeapSegment));
+    CHK(pHybridHeap->pSegments != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    segmentSize = fileHeapLimit / pHybridHeap->segmentCount;
+    for (i = 0; i < pHybridHeap->segmentCount; i++) {
+        // The last segment takes the remainder
+        CHK_STATUS(hybridFileCreateSegment(pHybridHeap,
+                                           i,
+                                           i == pHybridHeap->segmentCount - 1 ?
+                                               fileHeapLimit - segmentSize * i : segmentSize));
+    }
+
+    DLOGI("Hybrid file heap with %" PRIu64 " bytes in memory and %u segments with %" PRIu64 " bytes in %s",
+          memHeapLimit, pHybridHeap->segmentCount, fileHeapLimit, pHybridHeap->rootDirectory);
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Free the hybrid heap
+ */
+DEFINE_RELEASE_HEAP(hybridFileHeapRelease)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    STATUS memHeapStatus = STATUS_SUCCESS;
+    STATUS segmentStatus = STATUS_SUCCESS;
+    PHybridFileHeap pHybridHeap = (PHybridFileHeap) pHeap;
+    PFileHeapSegment pSegment;
+    UINT32 i;
+
+    // The call should be idempotent
+    CHK (pHeap != NULL, STATUS_SUCCESS);
+
+    // Regardless of the status (heap might be corrupted) we still want to free the memory
+    retStatus = commonHeapRelease(pHeap);
+
+    // Release the direct memory heap
+    if (STATUS_SUCCESS != (memHeapStatus = pHybridHeap->pMemHeap->heapReleaseFn((PHeap) pHybridHeap->pMemHeap))) {
+        DLOGW("Failed to release in-memory heap with 0x%08x", memHeapStatus);
+    }
+
+    // Release the segment heaps and unmap the segment files
+    for (i = 0; pHybridHeap->pSegments != NULL && i < pHybridHeap->segmentCount; i++) {
+        pSegment = &pHybridHeap->pSegments[i];
+        if (pSegment->pHeap != NULL && STATUS_SUCCESS != pSegment->pHeap->heapReleaseFn((PHeap) pSegment->pHeap)) {
+            segmentStatus = STATUS_HEAP_CORRUPTED;
+            DLOGW("Failed to release heap segment %u", i);
+        }
+
+#ifdef FILE_HEAP_MMAP_SUPPORTED
+        if (pSegment->pMapping != NULL && 0 != munmap(pSegment->pMapping, (size_t) pSegment->size)) {
+            segmentStatus = STATUS_HEAP_FILE_MAP_FAILED;
+            DLOGW("Failed to unmap heap segment %u with errno %d", i, errno);
+        }
+#endif
+    }
+
+    if (pHybridHeap->pSegments != NULL) {
+        MEMFREE(pHybridHeap->pSegments);
+    }
+
+    if (pHybridHeap->pEntries != NULL) {
+        MEMFREE(pHybridHeap->pEntries);
+    }
+
+    if (pHybridHeap->pMappings != NULL) {
+        hashTableFree(pHybridHeap->pMappings);
+    }
+
+    // Free the allocation itself
+    MEMFREE(pHeap);
+
+CleanUp:
+    LEAVES();
+    // return the combination. This works as STATUS_SUCCESS is defined as 0
+    return retStatus | memHeapStatus | segmentStatus;
+}
+
+/**
+ * Returns the entry for the allocation handle or NULL if the handle is not allocated
+ */
+PFileHeapEntry hybridFileGetEntry(PHybridFileHeap pHybridHeap, ALLOCATION_HANDLE handle)
+{
+    UINT64 index = FROM_FILE_HEAP_ENTRY_HANDLE(handle);
+
+    if (handle == INVALID_ALLOCATION_HANDLE_VALUE || index >= pHybridHeap->entryCount ||
+        pHybridHeap->pEntries[index].handle == INVALID_ALLOCATION_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    return &pHybridHeap->pEntries[index];
+}
+
+/**
+ * Takes an entry from the free list growing the entry table if needed.
+ *
+ * NOTE: Growing the table moves the entries so the entry pointers should not be held across the call.
+ */
+STATUS hybridFileReserveEntry(PHybridFileHeap pHybridHeap, PUINT32 pIndex)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFileHeapEntry pEntries = NULL;
+    UINT32 i, entryCount;
+
+    if (pHybridHeap->freeEntry == FILE_HEAP_ENTRY_NONE) {
+        CHK_ERR(pHybridHeap->entryCount < MAX_FILE_HEAP_ENTRY_COUNT,
+                STATUS_NOT_ENOUGH_MEMORY,
+                "Hybrid file heap has reached the max number of allocations %u",
+                MAX_FILE_HEAP_ENTRY_COUNT);
+
+        entryCount = pHybridHeap->entryCount == 0 ? FILE_HEAP_DEFAULT_ENTRY_COUNT :
+                         MIN(pHybridHeap->entryCount * 2, MAX_FILE_HEAP_ENTRY_COUNT);
+        pEntries = (PFileHeapEntry) MEMALLOC(entryCount * SIZEOF(FileHeapEntry));
+        CHK(pEntries != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+        if (pHybridHeap->pEntries != NULL) {
+            MEMCPY(pEntries, pHybridHeap->pEntries, pHybridHeap->entryCount * SIZEOF(FileHeapEntry));
+            MEMFREE(pHybridHeap->pEntries);
+        }
+
+        // Link the new entries into the free list
+        for (i = pHybridHeap->entryCount; i < entryCount; i++) {
+            pEntries[i].handle = INVALID_ALLOCATION_HANDLE_VALUE;
+            pEntries[i].pMapping = NULL;
+            pEntries[i].mapCount = 0;
+            pEntries[i].prev = FILE_HEAP_ENTRY_NONE;
+            pEntries[i].next = i + 1 < entryCount ? i + 1 : FILE_HEAP_ENTRY_NONE;
+        }
+
+        pHybridHeap->freeEntry = pHybridHeap->entryCount;
+        pHybridHeap->pEntries = pEntries;
+        pHybridHeap->entryCount = entryCount;
+    }
+
+    *pIndex = pHybridHeap->freeEntry;
+    pHybridHeap->freeEntry = pHybridHeap->pEntries[*pIndex].next;
+    pHybridHeap->pEntries[*pIndex].next = FILE_HEAP_ENTRY_NONE;
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Returns the entry to the free list
+ */
+VOID hybridFileReleaseEntry(PHybridFileHeap pHybridHeap, UINT32 index)
+{
+    PFileHeapEntry pEntry = &pHybridHeap->pEntries[index];
+
+    pEntry->handle = INVALID_ALLOCATION_HANDLE_VALUE;
+    pEntry->pMapping = NULL;
+    pEntry->mapCount = 0;
+    pEntry->prev = FILE_HEAP_ENTRY_NONE;
+    pEntry->next = pHybridHeap->freeEntry;
+    pHybridHeap->freeEntry = index;
+}
+
+/**
+ * Appends the entry to the in-memory allocation order list as the newest one
+ */
+VOID hybridFileLinkMemEntry(PHybridFileHeap pHybridHeap, UINT32 index)
+{
+    PFileHeapEntry pEntry = &pHybridHeap->pEntries[index];
+
+    pEntry->prev = pHybridHeap->memTail;
+    pEntry->next = FILE_HEAP_ENTRY_NONE;
+
+    if (pHybridHeap->memTail == FILE_HEAP_ENTRY_NONE) {
+        pHybridHeap->memHead = index;
+    } else {
+        pHybridHeap->pEntries[pHybridHeap->memTail].next = index;
+    }
+
+    pHybridHeap->memTail = index;
+}
+
+/**
+ * Removes the entry from the in-memory allocation order list
+ */
+VOID hybridFileUnlinkMemEntry(PHybridFileHeap pHybridHeap, UINT32 index)
+{
+    PFileHeapEntry pEntry = &pHybridHeap->pEntries[index];
+
+    if (pEntry->prev == FILE_HEAP_ENTRY_NONE) {
+        pHybridHeap->memHead = pEntry->next;
+    } else {
+        pHybridHeap->pEntries[pEntry->prev].next = pEntry->next;
+    }
+
+    if (pEntry->next == FILE_HEAP_ENTRY_NONE) {
+        pHybridHeap->memTail = pEntry->prev;
+    } else {
+        pHybridHeap->pEntries[pEntry->next].prev = pEntry->prev;
+    }
+
+    pEntry->prev = FILE_HEAP_ENTRY_NONE;
+    pEntry->next = FILE_HEAP_ENTRY_NONE;
+}
+
+/**
+ * Allocates from the contained heap and accounts for the usage in the hybrid heap
+ */
+STATUS hybridFileSubHeapAlloc(PHybridFileHeap pHybridHeap, PBaseHeap pSubHeap, UINT32 size, PALLOCATION_HANDLE pHandle)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 prevHeapSize = pSubHeap->heap.heapSize, prevNumAlloc = pSubHeap->heap.numAlloc;
+
+    CHK_STATUS(pSubHeap->heapAllocFn((PHeap) pSubHeap, size, pHandle));
+    hybridFileUpdateUsage((PHeap) pHybridHeap, pSubHeap, prevHeapSize, prevNumAlloc);
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Frees the entry location from the contained heap and accounts for the usage in the hybrid heap
+ */
+STATUS hybridFileSubHeapFree(PHybridFileHeap pHybridHeap, ALLOCATION_HANDLE location)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBaseHeap pSubHeap;
+    UINT64 prevHeapSize, prevNumAlloc;
+
+    CHK(NULL != (pSubHeap = hybridFileGetSubHeap(pHybridHeap, location)), STATUS_INVALID_ARG);
+
+    prevHeapSize = pSubHeap->heap.heapSize;
+    prevNumAlloc = pSubHeap->heap.numAlloc;
+    CHK_STATUS(pSubHeap->heapFreeFn((PHeap) pSubHeap, hybridFileGetSubHandle(location)));
+    hybridFileUpdateUsage((PHeap) pHybridHeap, pSubHeap, prevHeapSize, prevNumAlloc);
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Allocates from the file segments starting with the one we last allocated from.
+ * Returns the file segment handle or an invalid handle if the segments are full.
+ */
+STATUS hybridFileSegmentAlloc(PHybridFileHeap pHybridHeap, UINT32 size, PALLOCATION_HANDLE pHandle)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, index;
+
+    *pHandle = INVALID_ALLOCATION_HANDLE_VALUE;
+
+    for (i = 0; i < pHybridHeap->segmentCount; i++) {
+        index = (pHybridHeap->currentSegment + i) % pHybridHeap->segmentCount;
+        CHK_STATUS(hybridFileSubHeapAlloc(pHybridHeap, pHybridHeap->pSegments[index].pHeap, size, pHandle));
+
+        if (*pHandle != INVALID_ALLOCATION_HANDLE_VALUE) {
+            DLOGS("Successfully allocated from file segment %u.", index);
+            pHybridHeap->currentSegment = index;
+            *pHandle = TO_FILE_HANDLE(index, *pHandle);
+
+            CHK(FALSE, STATUS_SUCCESS);
+        }
+    }
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Moves the oldest in-memory allocation which is not mapped to the file segments.
+ * Sets the spilled flag to false if there is nothing to move or the segments are full.
+ */
+STATUS hybridFileSpillEntry(PHybridFileHeap pHybridHeap, PBOOL pSpilled)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PFileHeapEntry pEntry = NULL;
+    PBaseHeap pMemHeap = pHybridHeap->pMemHeap, pSegmentHeap = NULL;
+    ALLOCATION_HANDLE fileHandle = INVALID_ALLOCATION_HANDLE_VALUE;
+    PVOID pMemAlloc = NULL, pFileAlloc = NULL;
+    UINT32 index, size, fileSize;
+
+    *pSpilled = FALSE;
+
+    // The mapped allocations are in use and can't be moved
+    for (index = pHybridHeap->memHead; index != FILE_HEAP_ENTRY_NONE && pHybridHeap->pEntries[index].mapCount != 0;
+         index = pHybridHeap->pEntries[index].next);
+
+    CHK(index != FILE_HEAP_ENTRY_NONE, retStatus);
+    pEntry = &pHybridHeap->pEntries[index];
+
+    CHK_STATUS(pMemHeap->heapMapFn((PHeap) pMemHeap, pEntry->handle, &pMemAlloc, &size));
+    CHK_STATUS(hybridFileSegmentAlloc(pHybridHeap, size, &fileHandle));
+    CHK(fileHandle != INVALID_ALLOCATION_HANDLE_VALUE, retStatus);
+
+    pSegmentHeap = hybridFileGetSubHeap(pHybridHeap, fileHandle);
+    CHK_STATUS(pSegmentHeap->heapMapFn((PHeap) pSegmentHeap, FROM_FILE_HANDLE(fileHandle), &pFileAlloc, &fileSize));
+    MEMCPY(pFileAlloc, pMemAlloc, size);
+
+    CHK_STATUS(pSegmentHeap->heapUnmapFn((PHeap) pSegmentHeap, pFileAlloc));
+    pFileAlloc = NULL;
+    CHK_STATUS(pMemHeap->heapUnmapFn((PHeap) pMemHeap, pMemAlloc));
+    pMemAlloc = NULL;
+
+    // Move the entry to the file
+    CHK_STATUS(hybridFileSubHeapFree(pHybridHeap, pEntry->handle));
+    hybridFileUnlinkMemEntry(pHybridHeap, index);
+    pEntry->handle = fileHandle;
+    fileHandle = INVALID_ALLOCATION_HANDLE_VALUE;
+
+    DLOGS("Spilled allocation of size %u to file segment %u.", size, GET_FILE_HANDLE_SEGMENT(pEntry->handle));
+    *pSpilled = TRUE;
+
+CleanUp:
+
+    if (pFileAlloc != NULL) {
+        pSegmentHeap->heapUnmapFn((PHeap) pSegmentHeap, pFileAlloc);
+    }
+
+    if (pMemAlloc != NULL) {
+        pMemHeap->heapUnmapFn((PHeap) pMemHeap, pMemAlloc);
+    }
+
+    if (fileHandle != INVALID_ALLOCATION_HANDLE_VALUE) {
+        hybridFileSubHeapFree(pHybridHeap, fileHandle);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Allocate from the heap
+ *
+ * IMPORTANT: We allocate from the in-memory heap first. When the in-memory heap is exhausted, the oldest
+ * in-memory allocations which are not mapped are moved to the file segments to make room for the new one.
+ * As the oldest allocations are freed first, the in-memory heap keeps the newest allocations.
+ * The allocation is made directly from the file segments if nothing can be moved.
+ */
+DEFINE_HEAP_ALLOC(hybridFileHeapAlloc)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PHybridFileHeap pHybridHeap = (PHybridFileHeap) pHeap;
+    PBaseHeap pMemHeap = pHybridHeap->pMemHeap;
+    ALLOCATION_HANDLE handle = INVALID_ALLOCATION_HANDLE_VALUE;
+    UINT64 overallSize;
+    UINT32 index = FILE_HEAP_ENTRY_NONE;
+    BOOL spilled = TRUE, inMemory = FALSE;
+
+    CHK(pHeap != NULL && pHandle != NULL, STATUS_NULL_ARG);
+    *pHandle = INVALID_ALLOCATION_HANDLE_VALUE;
+
+    CHK_STATUS(hybridFileReserveEntry(pHybridHeap, &index));
+
+    // Try to allocate from the memory first. The allocation is not retried until enough of the
+    // in-memory heap is spilled. Spilling makes no sense if the allocation can't fit the in-memory heap.
+    overallSize = pMemHeap->getAllocationHeaderSizeFn() + (UINT64) size + pMemHeap->getAllocationFooterSizeFn();
+    while (!inMemory && spilled) {
+        if (pMemHeap->heap.heapSize + overallSize <= pMemHeap->heap.heapLimit) {
+            CHK_STATUS(hybridFileSubHeapAlloc(pHybridHeap, pMemHeap, size, &handle));
+            inMemory = handle != INVALID_ALLOCATION_HANDLE_VALUE;
+        }
+
+        if (inMemory) {
+            DLOGS("Successfully allocated from direct memory.");
+        } else if (overallSize <= pMemHeap->heap.heapLimit) {
+            CHK_STATUS(hybridFileSpillEntry(pHybridHeap, &spilled));
+        } else {
+            spilled = FALSE;
+        }
+    }
+
+    if (!inMemory) {
+        CHK_STATUS(hybridFileSegmentAlloc(pHybridHeap, size, &handle));
+    }
+
+    CHK(handle != INVALID_ALLOCATION_HANDLE_VALUE, retStatus);
+
+    pHybridHeap->pEntries[index].handle = handle;
+    if (inMemory) {
+        hybridFileLinkMemEntry(pHybridHeap, index);
+    }
+
+    *pHandle = TO_FILE_HEAP_ENTRY_HANDLE(index);
+    index = FILE_HEAP_ENTRY_NONE;
+
+CleanUp:
+
+    if (index != FILE_HEAP_ENTRY_NONE) {
+        hybridFileReleaseEntry(pHybridHeap, index);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Returns the contained heap the entry location is allocated from
+ */
+PBaseHeap hybridFileGetSubHeap(PHybridFileHeap pHybridHeap, ALLOCATION_HANDLE handle)
+{
+    UINT32 index;
+
+    if (IS_DIRECT_ALLOCATION_HANDLE(handle)) {
+        return pHybridHeap->pMemHeap;
+    }
+
+    index = GET_FILE_HANDLE_SEGMENT(handle);
+    if (!IS_FILE_ALLOCATION_HANDLE(handle) || index >= pHybridHeap->segmentCount) {
+        return NULL;
+    }
+
+    return pHybridHeap->pSegments[index].pHeap;
+}
+
+/**
+ * Converts the entry location to the contained heap handle
+ */
+ALLOCATION_HANDLE hybridFileGetSubHandle(ALLOCATION_HANDLE handle)
+{
+    return IS_DIRECT_ALLOCATION_HANDLE(handle) ? handle : FROM_FILE_HANDLE(handle);
+}
+
+/**
+ * Free the allocation
+ */
+DEFINE_HEAP_FREE(hybridFileHeapFree)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PHybridFileHeap pHybridHeap = (PHybridFileHeap) pHeap;
+    PFileHeapEntry pEntry;
+    UINT32 index;
+
+    CHK(pHeap != NULL, STATUS_NULL_ARG);
+    CHK(NULL != (pEntry = hybridFileGetEntry(pHybridHeap, handle)), STATUS_INVALID_ARG);
+    index = (UINT32) FROM_FILE_HEAP_ENTRY_HANDLE(handle);
+
+    CHK_STATUS(hybridFileSubHeapFree(pHybridHeap, pEntry->handle));
+
+    // Drop the outstanding mapping from the index
+    if (pEntry->mapCount != 0) {
+        CHK_STATUS(hashTableRemove(pHybridHeap->pMappings, (UINT64) pEntry->pMapping));
+    }
+
+    if (IS_DIRECT_ALLOCATION_HANDLE(pEntry->handle)) {
+        hybridFileUnlinkMemEntry(pHybridHeap, index);
+    }
+
+    hybridFileReleaseEntry(pHybridHeap, index);
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Gets the allocation size
+ */
+DEFINE_HEAP_GET_ALLOC_SIZE(hybridFileHeapGetAllocSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBaseHeap pSubHeap;
+    PFileHeapEntry pEntry;
+
+    // Call the base class to ensure the params are ok and set the default ret values
+    CHK_STATUS(commonHeapGetAllocSize(pHeap, handle, pAllocSize));
+    CHK(NULL != (pEntry = hybridFileGetEntry((PHybridFileHeap) pHeap, handle)), STATUS_INVALID_ARG);
+    CHK(NULL != (pSubHeap = hybridFileGetSubHeap((PHybridFileHeap) pHeap, pEntry->handle)), STATUS_INVALID_ARG);
+
+    CHK_STATUS(pSubHeap->heapGetAllocSizeFn((PHeap) pSubHeap, hybridFileGetSubHandle(pEntry->handle), pAllocSize));
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Sets the allocation size
+ */
+DEFINE_HEAP_SET_ALLOC_SIZE(hybridFileHeapSetAllocSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PBaseHeap pSubHeap;
+    PFileHeapEntry pEntry;
+    UINT64 prevHeapSize, prevNumAlloc;
+
+    // Call the base class to ensure the params are ok
+    CHK_STATUS(commonHeapSetAllocSize(pHeap, handle, size));
+    CHK(NULL != (pEntry = hybridFileGetEntry((PHybridFileHeap) pHeap, handle)), STATUS_INVALID_ARG);
+    CHK(NULL != (pSubHeap = hybridFileGetSubHeap((PHybridFileHeap) pHeap, pEntry->handle)), STATUS_INVALID_ARG);
+
+    prevHeapSize = pSubHeap->heap.heapSize;
+    prevNumAlloc = pSubHeap->heap.numAlloc;
+    CHK_STATUS(pSubHeap->heapSetAllocSizeFn((PHeap) pSubHeap, hybridFileGetSubHandle(pEntry->handle), size));
+    hybridFileUpdateUsage(pHeap, pSubHeap, prevHeapSize, prevNumAlloc);
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Map the allocation. The mapped allocation is pinned at its location until all of its mappings are un-mapped.
+ */
+DEFINE_HEAP_MAP(hybridFileHeapMap)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PHybridFileHeap pHybridHeap = (PHybridFileHeap) pHeap;
+    PBaseHeap pSubHeap;
+    PFileHeapEntry pEntry;
+
+    // Call the base class to ensure the params are ok and set the default ret values
+    CHK_STATUS(commonHeapMap(pHeap, handle, ppAllocation, pSize));
+    CHK(NULL != (pEntry = hybridFileGetEntry(pHybridHeap, handle)), STATUS_INVALID_ARG);
+    CHK(NULL != (pSubHeap = hybridFileGetSubHeap(pHybridHeap, pEntry->handle)), STATUS_INVALID_ARG);
+
+    CHK_STATUS(pSubHeap->heapMapFn((PHeap) pSubHeap, hybridFileGetSubHandle(pEntry->handle), ppAllocation, pSize));
+
+    // Index the mapping so it can be un-mapped without knowing the handle
+    if (pEntry->mapCount == 0) {
+        CHK_STATUS(hashTablePut(pHybridHeap->pMappings, (UINT64) *ppAllocation, FROM_FILE_HEAP_ENTRY_HANDLE(handle)));
+        pEntry->pMapping = *ppAllocation;
+    }
+
+    pEntry->mapCount++;
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Un-Maps the allocation handle. The allocation is looked up in the mapping index.
+ */
+DEFINE_HEAP_UNMAP(hybridFileHeapUnmap)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PHybridFileHeap pHybridHeap = (PHybridFileHeap) pHeap;
+    PBaseHeap pSubHeap;
+    PFileHeapEntry pEntry;
+    UINT64 index;
+
+    // Call the base class to ensure the params are ok
+    CHK_STATUS(commonHeapUnmap(pHeap, pAllocation));
+
+    retStatus = hashTableGet(pHybridHeap->pMappings, (UINT64) pAllocation, &index);
+    CHK(retStatus != STATUS_HASH_KEY_NOT_PRESENT, STATUS_INVALID_ARG);
+    CHK_STATUS(retStatus);
+
+    pEntry = &pHybridHeap->pEntries[index];
+    CHK(NULL != (pSubHeap = hybridFileGetSubHeap(pHybridHeap, pEntry->handle)), STATUS_INVALID_ARG);
+    CHK_STATUS(pSubHeap->heapUnmapFn((PHeap) pSubHeap, pAllocation));
+
+    if (--pEntry->mapCount == 0) {
+        CHK_STATUS(hashTableRemove(pHybridHeap->pMappings, (UINT64) pAllocation));
+        pEntry->pMapping = NULL;
+    }
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
+DEFINE_HEADER_SIZE(hybridFileGetAllocationHeaderSize)
+{
+    return aivGetAllocationHeaderSize();
+}
+
+DEFINE_FOOTER_SIZE(hybridFileGetAllocationFooterSize)
+{
+    return aivGetAllocationFooterSize();
+}
+
+DEFINE_ALLOC_SIZE(hybridFileGetAllocationSize)
+{
+    PFileHeapEntry pEntry = hybridFileGetEntry((PHybridFileHeap) pHeap, handle);
+    PBaseHeap pSubHeap;
+
+    if (pEntry == NULL || NULL == (pSubHeap = hybridFileGetSubHeap((PHybridFileHeap) pHeap, pEntry->handle))) {
+        return INVALID_ALLOCATION_VALUE;
+    }
+
+    return pSubHeap->getAllocationSizeFn((PHeap) pSubHeap, hybridFileGetSubHandle(pEntry->handle));
+}
+
+DEFINE_HEAP_LIMITS(hybridFileGetHeapLimits)
+{
+    *pMinHeapSize = MIN_HEAP_SIZE;
+    *pMaxHeapSize = MAX_LARGE_HEAP_SIZE;
+}
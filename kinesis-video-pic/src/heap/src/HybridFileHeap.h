@@ -0,0 +1,239 @@
+/**
+ * Hybrid file heap class
+ */
+
+#ifndef __HYBRID_FILE_HEAP_H__
+#define __HYBRID_FILE_HEAP_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#pragma once
+
+/**
+ * The file based part of the heap is split into memory mapped segment files of this size.
+ * Each segment is managed by an AIV heap so the segment size should fit the AIV heap limits.
+ */
+#define FILE_HEAP_SEGMENT_SIZE ((UINT64) 256 * 1024 * 1024)
+
+/**
+ * Max number of segments which can be encoded in the allocation handle
+ */
+#define MAX_FILE_HEAP_SEGMENT_COUNT 1024
+
+/**
+ * Segment file name format - root directory, segment index and heap object address
+ */
+#define FILE_HEAP_SEGMENT_FILE_NAME_FORMAT "%s%ckvs_heap_%u_%016llx.seg"
+
+/**
+ * File segment handle conversion macros and defines. These are used for the entry locations.
+ *
+ * The segment AIV heap handles have their low order 32 bits zeroed. We store the segment index
+ * in the low order bits and mark the handle with the low bit set. The in-memory heap handles have
+ * the two low bits clear and the VRAM handles have both of them set.
+ */
+#define FILE_ALLOCATION_BITS (UINT64)0x01
+#define TO_FILE_HANDLE(s, h) (ALLOCATION_HANDLE)((UINT64)(h) | ((UINT64)(s) << 2) | FILE_ALLOCATION_BITS)
+#define FROM_FILE_HANDLE(h) (ALLOCATION_HANDLE)((UINT64)(h) & 0xFFFFFFFF00000000ULL)
+#define GET_FILE_HANDLE_SEGMENT(h) ((UINT32)(((UINT64)(h) & 0xFFFFFFFFULL) >> 2))
+#define IS_FILE_ALLOCATION_HANDLE(h) (((UINT64)(h) & ALIGNMENT_BITS) == FILE_ALLOCATION_BITS)
+
+/**
+ * The allocations are tracked in an entry table so they can be moved from the in-memory heap to the files.
+ * The handle returned to the caller is the entry index plus one which keeps it stable across the moves.
+ */
+#define FILE_HEAP_DEFAULT_ENTRY_COUNT 1024
+#define MAX_FILE_HEAP_ENTRY_COUNT 0x10000000
+#define FILE_HEAP_ENTRY_NONE MAX_UINT32
+#define TO_FILE_HEAP_ENTRY_HANDLE(i) ((ALLOCATION_HANDLE)((UINT64)(i) + 1))
+#define FROM_FILE_HEAP_ENTRY_HANDLE(h) ((UINT64)(h) - 1)
+
+/**
+ * Initial number of slots in the mapping index
+ */
+#define FILE_HEAP_DEFAULT_MAPPING_COUNT 64
+
+/**
+ * Allocation tracking entry
+ */
+typedef struct
+{
+    /**
+     * The location of the allocation - the in-memory heap handle or the file segment handle.
+     * Invalid allocation handle value for the free entries.
+     */
+    ALLOCATION_HANDLE handle;
+
+    /**
+     * The mapped address and the number of the outstanding mappings. The mapped allocations are not moved.
+     */
+    PVOID pMapping;
+    UINT32 mapCount;
+
+    /**
+     * Previous and next entries in the in-memory allocation order list.
+     * The next entry links the free entries together.
+     */
+    UINT32 prev;
+    UINT32 next;
+} FileHeapEntry, *PFileHeapEntry;
+
+/**
+ * Memory mapped segment file
+ */
+typedef struct
+{
+    /**
+     * The AIV heap managing the segment
+     */
+    PBaseHeap pHeap;
+
+    /**
+     * The mapped segment file
+     */
+    PVOID pMapping;
+
+    /**
+     * The size of the segment file
+     */
+    UINT64 size;
+} FileHeapSegment, *PFileHeapSegment;
+
+/**
+ * Hybrid file heap struct
+ */
+typedef struct
+{
+    /**
+     * Base Heap struct encapsulation
+     */
+    BaseHeap heap;
+
+    /**
+     * Spill ratio - this will indicate the ratio of the memory to use from main memory and the files
+     */
+    DOUBLE spillRatio;
+
+    /**
+     * The direct memory allocation based heap
+     */
+    PBaseHeap pMemHeap;
+
+    /**
+     * Heap behavior flags used to create the segment heaps
+     */
+    UINT32 behaviorFlags;
+
+    /**
+     * The segment files
+     */
+    PFileHeapSegment pSegments;
+    UINT32 segmentCount;
+
+    /**
+     * The segment of the last successful allocation to try first
+     */
+    UINT32 currentSegment;
+
+    /**
+     * The allocation entry table and the head of the free entry list
+     */
+    PFileHeapEntry pEntries;
+    UINT32 entryCount;
+    UINT32 freeEntry;
+
+    /**
+     * The oldest and the newest in-memory allocation entries. The oldest ones are spilled to the files first.
+     */
+    UINT32 memHead;
+    UINT32 memTail;
+
+    /**
+     * Mapped address to the entry index
+     */
+    PHashTable pMappings;
+
+    /**
+     * The directory to create the segment files in. The string is stored after the struct.
+     */
+    PCHAR rootDirectory;
+} HybridFileHeap, *PHybridFileHeap;
+
+/**
+ * Hybrid file heap internal functions
+ */
+STATUS hybridFileCreateHeap(PHeap, UINT32, UINT32, PCHAR, PHybridFileHeap*);
+STATUS hybridFileCreateSegment(PHybridFileHeap, UINT32, UINT64);
+VOID hybridFileUpdateUsage(PHeap, PBaseHeap, UINT64, UINT64);
+PBaseHeap hybridFileGetSubHeap(PHybridFileHeap, ALLOCATION_HANDLE);
+ALLOCATION_HANDLE hybridFileGetSubHandle(ALLOCATION_HANDLE);
+PFileHeapEntry hybridFileGetEntry(PHybridFileHeap, ALLOCATION_HANDLE);
+STATUS hybridFileReserveEntry(PHybridFileHeap, PUINT32);
+VOID hybridFileReleaseEntry(PHybridFileHeap, UINT32);
+VOID hybridFileLinkMemEntry(PHybridFileHeap, UINT32);
+VOID hybridFileUnlinkMemEntry(PHybridFileHeap, UINT32);
+STATUS hybridFileSubHeapAlloc(PHybridFileHeap, PBaseHeap, UINT32, PALLOCATION_HANDLE);
+STATUS hybridFileSubHeapFree(PHybridFileHeap, ALLOCATION_HANDLE);
+STATUS hybridFileSegmentAlloc(PHybridFileHeap, UINT32, PALLOCATION_HANDLE);
+STATUS hybridFileSpillEntry(PHybridFileHeap, PBOOL);
+
+/**
+ * Allocate a buffer from the heap
+ */
+DEFINE_HEAP_ALLOC(hybridFileHeapAlloc);
+
+/**
+ * Free the previously allocated buffer handle
+ */
+DEFINE_HEAP_FREE(hybridFileHeapFree);
+
+/**
+ * Gets the allocation size
+ */
+DEFINE_HEAP_GET_ALLOC_SIZE(hybridFileHeapGetAllocSize);
+
+/**
+ * Shrinks the allocation in-place
+ */
+DEFINE_HEAP_SET_ALLOC_SIZE(hybridFileHeapSetAllocSize);
+
+/**
+ * Maps the allocation handle to memory
+ */
+DEFINE_HEAP_MAP(hybridFileHeapMap);
+
+/**
+ * Un-maps the previously mapped buffer
+ */
+DEFINE_HEAP_UNMAP(hybridFileHeapUnmap);
+
+/**
+ * Release the entire heap
+ */
+DEFINE_RELEASE_HEAP(hybridFileHeapRelease);
+
+/**
+ * Initialize the heap with a given limit
+ */
+DEFINE_INIT_HEAP(hybridFileHeapInit);
+
+/**
+ * Debug/check heap
+ */
+DEFINE_HEAP_CHK(hybridFileHeapDebugCheckAllocator);
+
+/**
+ * Dealing with the allocation sizes
+ */
+DEFINE_HEADER_SIZE(hybridFileGetAllocationHeaderSize);
+DEFINE_FOOTER_SIZE(hybridFileGetAllocationFooterSize);
+DEFINE_ALLOC_SIZE(hybridFileGetAllocationSize);
+DEFINE_HEAP_LIMITS(hybridFileGetHeapLimits);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __HYBRID_FILE_HEAP_H__
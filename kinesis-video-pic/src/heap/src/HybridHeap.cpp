@@ -106,6 +106,7 @@ STATUS hybridCreateHeap(PHeap pHeap, UINT32 spillRatio, UINT32 behaviorFlags, PH
     pBaseHeap->heapAllocFn = hybridHeapAlloc;
     pBaseHeap->heapFreeFn = hybridHeapFree;
     pBaseHeap->heapGetAllocSizeFn = hybridHeapGetAllocSize;
+    pBaseHeap->heapSetAllocSizeFn = hybridHeapSetAllocSize;
     pBaseHeap->heapMapFn = hybridHeapMap;
     pBaseHeap->heapUnmapFn = hybridHeapUnmap;
     pBaseHeap->heapDebugCheckAllocatorFn = hybridHeapDebugCheckAllocator;
@@ -420,6 +421,56 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Sets the allocation size
+ */
+DEFINE_HEAP_SET_ALLOC_SIZE(hybridHeapSetAllocSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PHybridHeap pHybridHeap = (PHybridHeap) pHeap;
+    PALLOCATION_HEADER pHeader = NULL;
+    UINT32 vramHandle = INVALID_VRAM_HANDLE;
+
+    // Call the base class to ensure the params are ok
+    CHK_STATUS(commonHeapSetAllocSize(pHeap, handle, size));
+
+    // In case it's a direct allocation handle use the encapsulated direct memory heap
+    if (IS_DIRECT_ALLOCATION_HANDLE(handle)) {
+        DLOGS("Direct allocation 0x%016" PRIx64, handle);
+        CHK_STATUS(pHybridHeap->pMemHeap->heapSetAllocSizeFn((PHeap) pHybridHeap->pMemHeap, handle, size));
+
+        // Exit on success
+        CHK(FALSE, STATUS_SUCCESS);
+    }
+
+    // Convert the handle
+    vramHandle = TO_VRAM_HANDLE(handle);
+    DLOGS("VRAM allocation. Handle 0x%016" PRIx64 " VRAM handle 0x%08x", handle, vramHandle);
+
+    CHK_ERR(NULL != (pHeader = (PALLOCATION_HEADER)pHybridHeap->vramLock(vramHandle)),
+            STATUS_HEAP_VRAM_MAP_FAILED,
+            "Failed to map VRAM handle %08x",
+            vramHandle);
+
+    // We can only shrink in-place. VRAM can't be partially released so only adjust the size and the accounting
+    CHK_ERR(size <= pHeader->size, STATUS_INVALID_ARG, "Can't grow allocation of %u bytes to %u bytes", pHeader->size, size);
+    pHeap->heapSize -= pHeader->size - size;
+    pHeader->size = size;
+    MEMCPY((PBYTE)(pHeader + 1) + size, &gVramFooter, VRAM_ALLOCATION_FOOTER_SIZE);
+
+CleanUp:
+
+    // Un-lock the allocation
+    if (pHeader != NULL && 0 != pHybridHeap->vramUnlock(vramHandle)) {
+        // Shouldn't fail here
+        DLOGW("Failed to unmap 0x%08x", vramHandle);
+    }
+
+    LEAVES();
+    return retStatus;
+}
+
 /**
  * Map the allocation.
  * IMPORTANT: We will determine whether this is direct allocation by checking the last 2 bits being 0.
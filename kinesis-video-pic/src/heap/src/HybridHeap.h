@@ -109,6 +109,11 @@ DEFINE_HEAP_FREE(hybridHeapFree);
  */
 DEFINE_HEAP_GET_ALLOC_SIZE(hybridHeapGetAllocSize);
 
+/**
+ * Shrinks the allocation in-place
+ */
+DEFINE_HEAP_SET_ALLOC_SIZE(hybridHeapSetAllocSize);
+
 /**
  * Maps the allocation handle to memory. This is needed for in-direct allocation on vRAM
  */
@@ -15,6 +15,8 @@ extern "C" {
  * Including the headers
  */
 #include "com/amazonaws/kinesis/video/heap/Include.h"
+#include "com/amazonaws/kinesis/video/utils/Include.h"
+#include "com/amazonaws/kinesis/video/trace/Include.h"
 
 /**
  * Invalid allocation value
@@ -53,6 +55,11 @@ typedef STATUS (*HeapGetSizeFunc)(PHeap, PUINT64);
  */
 typedef STATUS (*HeapGetAllocSizeFunc)(PHeap, ALLOCATION_HANDLE, PUINT32);
 
+/**
+ * Shrinks the allocation in-place
+ */
+typedef STATUS (*HeapSetAllocSizeFunc)(PHeap, ALLOCATION_HANDLE, UINT32);
+
 /**
  * Allocates memory from the heap
  */
@@ -108,6 +115,7 @@ typedef VOID (*GetHeapLimitsFunc)(PUINT64, PUINT64);
 #define DEFINE_HEAP_ALLOC(name)           STATUS name(PHeap pHeap, UINT32 size, PALLOCATION_HANDLE pHandle)
 #define DEFINE_HEAP_FREE(name)            STATUS name(PHeap pHeap, ALLOCATION_HANDLE handle)
 #define DEFINE_HEAP_GET_ALLOC_SIZE(name)  STATUS name(PHeap pHeap, ALLOCATION_HANDLE handle, PUINT32 pAllocSize)
+#define DEFINE_HEAP_SET_ALLOC_SIZE(name)  STATUS name(PHeap pHeap, ALLOCATION_HANDLE handle, UINT32 size)
 #define DEFINE_HEAP_MAP(name)             STATUS name(PHeap pHeap, ALLOCATION_HANDLE handle, PVOID* ppAllocation, PUINT32 pSize)
 #define DEFINE_HEAP_UNMAP(name)           STATUS name(PHeap pHeap, PVOID pAllocation)
 #define DEFINE_HEAP_CHK(name)             STATUS name(PHeap pHeap, BOOL dump)
@@ -131,6 +139,7 @@ typedef struct
     HeapGetSizeFunc heapGetSizeFn;
     HeapFreeFunc heapFreeFn;
     HeapGetAllocSizeFunc heapGetAllocSizeFn;
+    HeapSetAllocSizeFunc heapSetAllocSizeFn;
     HeapAllocFunc heapAllocFn;
     HeapMapFunc heapMapFn;
     HeapUnmapFunc heapUnmapFn;
@@ -148,6 +157,7 @@ typedef struct
 #include "SystemHeap.h"
 #include "AivHeap.h"
 #include "HybridHeap.h"
+#include "HybridFileHeap.h"
 
 #pragma pack(pop, include) // pop the existing settings
 
@@ -55,6 +55,7 @@ DEFINE_CREATE_HEAP(sysHeapCreate)
     pBaseHeap->heapAllocFn = sysHeapAlloc;
     pBaseHeap->heapFreeFn = sysHeapFree;
     pBaseHeap->heapGetAllocSizeFn = sysHeapGetAllocSize;
+    pBaseHeap->heapSetAllocSizeFn = sysHeapSetAllocSize;
     pBaseHeap->heapMapFn = sysHeapMap;
     pBaseHeap->heapUnmapFn = sysHeapUnmap;
     pBaseHeap->heapDebugCheckAllocatorFn = sysHeapDebugCheckAllocator;
@@ -209,6 +210,37 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Sets the allocation size. The system allocation is not re-allocated as this might move the memory
+ * and invalidate the handle so we only adjust the size and the accounting.
+ */
+DEFINE_HEAP_SET_ALLOC_SIZE(sysHeapSetAllocSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PALLOCATION_HEADER pHeader;
+
+    // This heap implementation uses a direct memory allocation so no mapping really needed - just conversion from a handle to memory pointer
+    PVOID pAllocation = (PVOID)HANDLE_TO_POINTER(handle);
+
+    // Call the common heap function
+    CHK_STATUS(commonHeapSetAllocSize(pHeap, handle, size));
+
+    pHeader = (PALLOCATION_HEADER)pAllocation - 1;
+
+    // We can only shrink in-place
+    CHK_ERR(size <= pHeader->size, STATUS_INVALID_ARG, "Can't grow allocation of %u bytes to %u bytes", pHeader->size, size);
+
+    // Adjust the accounting and move the footer
+    pHeap->heapSize -= pHeader->size - size;
+    pHeader->size = size;
+    MEMCPY((PBYTE)pAllocation + size, &gSysFooter, SYS_ALLOCATION_FOOTER_SIZE);
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
 /**
  * Map the allocation. This is simply a casting operation as we have direct allocation and non vRAM backed
  */
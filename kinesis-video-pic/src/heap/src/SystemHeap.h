@@ -33,6 +33,11 @@ DEFINE_HEAP_FREE(sysHeapFree);
  */
 DEFINE_HEAP_GET_ALLOC_SIZE(sysHeapGetAllocSize);
 
+/**
+ * Shrinks the allocation in-place
+ */
+DEFINE_HEAP_SET_ALLOC_SIZE(sysHeapSetAllocSize);
+
 /**
  * Maps the allocation handle to memory. This is needed for in-direct allocation on vRAM
  */
@@ -210,6 +210,120 @@ VOID defragmentationAlloc(PHeap pHeap)
     EXPECT_TRUE(STATUS_SUCCEEDED(heapRelease(pHeap)));
 }
 
+VOID shrinkAlloc(PHeap pHeap)
+{
+    ALLOCATION_HANDLE handle, handle2;
+    PVOID pAlloc;
+    UINT32 size, i;
+    UINT64 heapSize, heapSizeAfter;
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapAlloc(pHeap, 10000, &handle)));
+    EXPECT_TRUE(IS_VALID_ALLOCATION_HANDLE(handle));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapMap(pHeap, handle, &pAlloc, &size)));
+    MEMSET(pAlloc, 0x55, size);
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapUnmap(pHeap, pAlloc)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapGetSize(pHeap, &heapSize)));
+
+    // Shrink and ensure the handle is still valid, the content is preserved and the space is returned
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapSetAllocSize(pHeap, handle, 1000)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapGetAllocSize(pHeap, handle, &size)));
+    EXPECT_EQ(1000, size);
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapGetSize(pHeap, &heapSizeAfter)));
+    EXPECT_EQ(heapSize - 9000, heapSizeAfter);
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapMap(pHeap, handle, &pAlloc, &size)));
+    EXPECT_EQ(1000, size);
+    for (i = 0; i < size; i++) {
+        EXPECT_EQ(0x55, ((PBYTE) pAlloc)[i]);
+    }
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapUnmap(pHeap, pAlloc)));
+
+    // Shrinking to the same size is a no-op
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapSetAllocSize(pHeap, handle, 1000)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapGetSize(pHeap, &heapSize)));
+    EXPECT_EQ(heapSizeAfter, heapSize);
+
+    // Growing is not allowed
+    EXPECT_TRUE(STATUS_FAILED(heapSetAllocSize(pHeap, handle, 1001)));
+
+    // A new allocation should succeed
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapAlloc(pHeap, 1000, &handle2)));
+    EXPECT_TRUE(IS_VALID_ALLOCATION_HANDLE(handle2));
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapDebugCheckAllocator(pHeap, FALSE)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapFree(pHeap, handle)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapFree(pHeap, handle2)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapGetSize(pHeap, &heapSize)));
+    EXPECT_EQ(0, heapSize);
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapRelease(pHeap)));
+}
+
+VOID aivShrinkAllocReuse(PHeap pHeap)
+{
+    ALLOCATION_HANDLE handle, handle2;
+    UINT32 size = MIN_HEAP_SIZE / 2;
+
+    // Allocate more than half of the heap so another allocation of the same size fails
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapAlloc(pHeap, size + 1000, &handle)));
+    EXPECT_TRUE(IS_VALID_ALLOCATION_HANDLE(handle));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapAlloc(pHeap, size, &handle2)));
+    EXPECT_FALSE(IS_VALID_ALLOCATION_HANDLE(handle2));
+
+    // Shrink and ensure the trailing space is coalesced with the free block and can be re-used
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapSetAllocSize(pHeap, handle, size / 2)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapAlloc(pHeap, size, &handle2)));
+    EXPECT_TRUE(IS_VALID_ALLOCATION_HANDLE(handle2));
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapDebugCheckAllocator(pHeap, FALSE)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapFree(pHeap, handle2)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapFree(pHeap, handle)));
+
+    // The entire heap should be available after the coalescing
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapAlloc(pHeap, MIN_HEAP_SIZE - 1000, &handle)));
+    EXPECT_TRUE(IS_VALID_ALLOCATION_HANDLE(handle));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapFree(pHeap, handle)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapRelease(pHeap)));
+}
+
+VOID randomAllocFree(PHeap pHeap)
+{
+    ALLOCATION_HANDLE handles[1000];
+    UINT32 i, index;
+    UINT64 heapSize;
+
+    MEMSET(handles, 0x00, SIZEOF(handles));
+    SRAND(0x1234);
+
+    // Random sized allocations and frees in random order
+    for (i = 0; i < 20000; i++) {
+        index = RAND() % ARRAY_SIZE(handles);
+        if (IS_VALID_ALLOCATION_HANDLE(handles[index])) {
+            EXPECT_TRUE(STATUS_SUCCEEDED(heapFree(pHeap, handles[index])));
+            handles[index] = INVALID_ALLOCATION_HANDLE_VALUE;
+        } else {
+            EXPECT_TRUE(STATUS_SUCCEEDED(heapAlloc(pHeap, 1 + RAND() % 30000, &handles[index])));
+        }
+
+        if (i % 1000 == 0) {
+            EXPECT_TRUE(STATUS_SUCCEEDED(heapDebugCheckAllocator(pHeap, FALSE)));
+        }
+    }
+
+    for (i = 0; i < ARRAY_SIZE(handles); i++) {
+        if (IS_VALID_ALLOCATION_HANDLE(handles[i])) {
+            EXPECT_TRUE(STATUS_SUCCEEDED(heapFree(pHeap, handles[i])));
+        }
+    }
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapGetSize(pHeap, &heapSize)));
+    EXPECT_EQ(0, heapSize);
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapDebugCheckAllocator(pHeap, FALSE)));
+
+    // All the free blocks should have coalesced
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapAlloc(pHeap, MIN_HEAP_SIZE - 1000, &handles[0])));
+    EXPECT_TRUE(IS_VALID_ALLOCATION_HANDLE(handles[0]));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapRelease(pHeap)));
+}
+
 TEST_F(HeapApiFunctionalityTest, GetHeapSizeAndGetAllocSize)
 {
     PHeap pHeap;
@@ -277,6 +391,9 @@ TEST_F(HeapApiFunctionalityTest, SingleLargeAlloc)
     EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP, &pHeap)));
     singleLargeAlloc(pHeap);
 
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP | FLAGS_USE_AIV_SEGREGATED_FIT, &pHeap)));
+    singleLargeAlloc(pHeap);
+
     EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_SYSTEM_HEAP, &pHeap)));
     singleLargeAlloc(pHeap);
 }
@@ -288,6 +405,9 @@ TEST_F(HeapApiFunctionalityTest, MultipleLargeAlloc)
     EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP, &pHeap)));
     multipleLargeAlloc(pHeap);
 
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP | FLAGS_USE_AIV_SEGREGATED_FIT, &pHeap)));
+    multipleLargeAlloc(pHeap);
+
     EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_SYSTEM_HEAP, &pHeap)));
     multipleLargeAlloc(pHeap);
 }
@@ -298,6 +418,9 @@ TEST_F(HeapApiFunctionalityTest, DefragmentationAlloc)
 
     EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP, &pHeap)));
     defragmentationAlloc(pHeap);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP | FLAGS_USE_AIV_SEGREGATED_FIT, &pHeap)));
+    defragmentationAlloc(pHeap);
 }
 
 TEST_F(HeapApiFunctionalityTest, SingleByteAlloc)
@@ -306,6 +429,9 @@ TEST_F(HeapApiFunctionalityTest, SingleByteAlloc)
 
     EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP, &pHeap)));
     singleByteAlloc(pHeap);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP | FLAGS_USE_AIV_SEGREGATED_FIT, &pHeap)));
+    singleByteAlloc(pHeap);
 }
 
 TEST_F(HeapApiFunctionalityTest, AivHeapMinBlockFitAlloc)
@@ -322,6 +448,9 @@ TEST_F(HeapApiFunctionalityTest, AivHeapBlockCoallesceAlloc)
 
     EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP, &pHeap)));
     blockCoalesceAlloc(pHeap);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP | FLAGS_USE_AIV_SEGREGATED_FIT, &pHeap)));
+    blockCoalesceAlloc(pHeap);
 }
 
 TEST_F(HeapApiFunctionalityTest, MultipleMapUnmapByteAlloc)
@@ -331,6 +460,45 @@ TEST_F(HeapApiFunctionalityTest, MultipleMapUnmapByteAlloc)
     EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP, &pHeap)));
     multipleMapUnmapByteAlloc(pHeap);
 
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP | FLAGS_USE_AIV_SEGREGATED_FIT, &pHeap)));
+    multipleMapUnmapByteAlloc(pHeap);
+
     EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_SYSTEM_HEAP, &pHeap)));
     multipleMapUnmapByteAlloc(pHeap);
-}
\ No newline at end of file
+}
+
+TEST_F(HeapApiFunctionalityTest, ShrinkAlloc)
+{
+    PHeap pHeap;
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP, &pHeap)));
+    shrinkAlloc(pHeap);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP | FLAGS_USE_AIV_SEGREGATED_FIT, &pHeap)));
+    shrinkAlloc(pHeap);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_SYSTEM_HEAP, &pHeap)));
+    shrinkAlloc(pHeap);
+}
+
+TEST_F(HeapApiFunctionalityTest, AivHeapShrinkAllocReuse)
+{
+    PHeap pHeap;
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP, &pHeap)));
+    aivShrinkAllocReuse(pHeap);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP | FLAGS_USE_AIV_SEGREGATED_FIT, &pHeap)));
+    aivShrinkAllocReuse(pHeap);
+}
+
+TEST_F(HeapApiFunctionalityTest, RandomAllocFree)
+{
+    PHeap pHeap;
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP, &pHeap)));
+    randomAllocFree(pHeap);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP | FLAGS_USE_AIV_SEGREGATED_FIT, &pHeap)));
+    randomAllocFree(pHeap);
+}
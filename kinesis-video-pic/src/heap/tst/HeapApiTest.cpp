@@ -158,6 +158,28 @@ TEST_F(HeapApiTest, InvalidHeapGetAllocSize_NullHeapHandle) {
     EXPECT_TRUE(STATUS_SUCCEEDED(heapRelease(pHeap)));
 }
 
+TEST_F(HeapApiTest, InvalidHeapSetAllocSize) {
+    PHeap pHeap;
+    ALLOCATION_HANDLE handle;
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP, &pHeap)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapAlloc(pHeap, 1000, &handle)));
+    EXPECT_TRUE(STATUS_FAILED(heapSetAllocSize(NULL, handle, 100)));
+    EXPECT_TRUE(STATUS_FAILED(heapSetAllocSize(pHeap, INVALID_ALLOCATION_HANDLE_VALUE, 100)));
+    EXPECT_TRUE(STATUS_FAILED(heapSetAllocSize(pHeap, handle, 0)));
+    EXPECT_TRUE(STATUS_FAILED(heapSetAllocSize(pHeap, handle, 1001)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapRelease(pHeap)));
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapInitialize(MIN_HEAP_SIZE, 20, FLAGS_USE_SYSTEM_HEAP, &pHeap)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapAlloc(pHeap, 1000, &handle)));
+    EXPECT_TRUE(STATUS_FAILED(heapSetAllocSize(NULL, handle, 100)));
+    EXPECT_TRUE(STATUS_FAILED(heapSetAllocSize(pHeap, INVALID_ALLOCATION_HANDLE_VALUE, 100)));
+    EXPECT_TRUE(STATUS_FAILED(heapSetAllocSize(pHeap, handle, 0)));
+    EXPECT_TRUE(STATUS_FAILED(heapSetAllocSize(pHeap, handle, 1001)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapFree(pHeap, handle)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(heapRelease(pHeap)));
+}
+
 TEST_F(HeapApiTest, InvalidHeapAlloc_NullHandle) {
     PHeap pHeap;
 
@@ -0,0 +1,104 @@
+#include "HeapTestFixture.h"
+
+#define HEAP_PERF_TEST_HEAP_SIZE                (32 * 1024 * 1024)
+#define HEAP_PERF_TEST_FPS                      30
+#define HEAP_PERF_TEST_KEY_FRAME_INTERVAL       60
+#define HEAP_PERF_TEST_SIMULATED_HOURS          2
+#define HEAP_PERF_TEST_MAX_RETAINED_FRAMES      (HEAP_PERF_TEST_FPS * 120)
+#define HEAP_PERF_TEST_RETENTION_PERCENT        75
+#define HEAP_PERF_TEST_SMALL_ALLOC_SLOTS        256
+
+class HeapPerfTest : public HeapTestBase {
+};
+
+/**
+ * Replays a frame size trace of an H264 stream - large key frames followed by smaller delta frames.
+ * The frames are allocated with the upper bound size and shrunk to the actual packaged size.
+ * The oldest frames are evicted in FIFO order to keep the retained size under the threshold
+ * as the content view would do. Small allocations with random lifetimes are interleaved to
+ * model the bookkeeping allocations fragmenting the heap.
+ */
+VOID replayFrameTrace(PHeap pHeap, PCHAR heapName)
+{
+    ALLOCATION_HANDLE frames[HEAP_PERF_TEST_MAX_RETAINED_FRAMES];
+    UINT32 frameSizes[HEAP_PERF_TEST_MAX_RETAINED_FRAMES];
+    ALLOCATION_HANDLE smallAllocs[HEAP_PERF_TEST_SMALL_ALLOC_SLOTS];
+    UINT32 i, head = 0, tail = 0, count = 0, frameSize, index, failures = 0;
+    UINT32 frameCount = HEAP_PERF_TEST_FPS * 60 * 60 * HEAP_PERF_TEST_SIMULATED_HOURS;
+    UINT64 retainedSize = 0, start, duration, totalAllocTime = 0, maxAllocTime = 0, totalFreeTime = 0, heapSize;
+    ALLOCATION_HANDLE handle;
+
+    MEMSET(smallAllocs, 0x00, SIZEOF(smallAllocs));
+    SRAND(0x5678);
+
+    for (i = 0; i < frameCount; i++) {
+        if (i % HEAP_PERF_TEST_KEY_FRAME_INTERVAL == 0) {
+            frameSize = 60000 + RAND() % 60000;
+        } else {
+            frameSize = 5000 + RAND() % 15000;
+        }
+
+        // Evict the oldest frames
+        while (count != 0 &&
+               (count == HEAP_PERF_TEST_MAX_RETAINED_FRAMES ||
+                retainedSize + frameSize > (UINT64) HEAP_PERF_TEST_HEAP_SIZE * HEAP_PERF_TEST_RETENTION_PERCENT / 100)) {
+            start = GETTIME();
+            EXPECT_EQ(STATUS_SUCCESS, heapFree(pHeap, frames[tail]));
+            totalFreeTime += GETTIME() - start;
+            retainedSize -= frameSizes[tail];
+            tail = (tail + 1) % HEAP_PERF_TEST_MAX_RETAINED_FRAMES;
+            count--;
+        }
+
+        // Allocate with the upper bound and shrink to the actual size
+        start = GETTIME();
+        EXPECT_EQ(STATUS_SUCCESS, heapAlloc(pHeap, frameSize + frameSize / 3, &handle));
+        if (IS_VALID_ALLOCATION_HANDLE(handle)) {
+            EXPECT_EQ(STATUS_SUCCESS, heapSetAllocSize(pHeap, handle, frameSize));
+        }
+
+        duration = GETTIME() - start;
+        totalAllocTime += duration;
+        maxAllocTime = MAX(maxAllocTime, duration);
+
+        if (IS_VALID_ALLOCATION_HANDLE(handle)) {
+            frames[head] = handle;
+            frameSizes[head] = frameSize;
+            head = (head + 1) % HEAP_PERF_TEST_MAX_RETAINED_FRAMES;
+            count++;
+            retainedSize += frameSize;
+        } else {
+            failures++;
+        }
+
+        // Replace a random small allocation
+        index = RAND() % HEAP_PERF_TEST_SMALL_ALLOC_SLOTS;
+        if (IS_VALID_ALLOCATION_HANDLE(smallAllocs[index])) {
+            EXPECT_EQ(STATUS_SUCCESS, heapFree(pHeap, smallAllocs[index]));
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, heapAlloc(pHeap, 32 + RAND() % 2000, &smallAllocs[index]));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, heapDebugCheckAllocator(pHeap, FALSE));
+    EXPECT_EQ(STATUS_SUCCESS, heapGetSize(pHeap, &heapSize));
+
+    DLOGI("%s: %u frames (%u hours) with %u allocation failures. Average alloc %" PRIu64 " ns, max alloc %" PRIu64
+          " ns, average free %" PRIu64 " ns. Heap size %" PRIu64 " with %" PRIu64 " bytes of frames retained.",
+          heapName, frameCount, HEAP_PERF_TEST_SIMULATED_HOURS, failures,
+          totalAllocTime * DEFAULT_TIME_UNIT_IN_NANOS / frameCount, maxAllocTime * DEFAULT_TIME_UNIT_IN_NANOS,
+          totalFreeTime * DEFAULT_TIME_UNIT_IN_NANOS / frameCount, heapSize, retainedSize);
+
+    EXPECT_EQ(STATUS_SUCCESS, heapRelease(pHeap));
+}
+
+TEST_F(HeapPerfTest, FrameTraceFragmentation)
+{
+    PHeap pHeap;
+
+    EXPECT_EQ(STATUS_SUCCESS, heapInitialize(HEAP_PERF_TEST_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP, &pHeap));
+    replayFrameTrace(pHeap, (PCHAR) "AIV first fit");
+
+    EXPECT_EQ(STATUS_SUCCESS, heapInitialize(HEAP_PERF_TEST_HEAP_SIZE, 20, FLAGS_USE_AIV_HEAP | FLAGS_USE_AIV_SEGREGATED_FIT, &pHeap));
+    replayFrameTrace(pHeap, (PCHAR) "AIV segregated fit");
+}
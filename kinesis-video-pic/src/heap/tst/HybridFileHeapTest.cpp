@@ -0,0 +1,295 @@
+#include "HeapTestFixture.h"
+
+#define HYBRID_FILE_HEAP_TEST_TMPFS_DIRECTORY      "/dev/shm"
+#define HYBRID_FILE_HEAP_TEST_DIRECTORY            "/tmp"
+
+class HybridFileHeapTest : public HeapTestBase {
+protected:
+    virtual VOID SetUp()
+    {
+        struct stat st;
+
+        HeapTestBase::SetUp();
+
+        // Prefer tmpfs for the segment files
+        mRootDirectory = (PCHAR) (0 == FSTAT(HYBRID_FILE_HEAP_TEST_TMPFS_DIRECTORY, &st) && S_ISDIR(st.st_mode) ?
+                                  HYBRID_FILE_HEAP_TEST_TMPFS_DIRECTORY : HYBRID_FILE_HEAP_TEST_DIRECTORY);
+    }
+
+    /**
+     * Whether the allocation is currently stored in a file segment
+     */
+    static BOOL isFileAllocation(PHeap pHeap, ALLOCATION_HANDLE handle)
+    {
+        PFileHeapEntry pEntry = hybridFileGetEntry((PHybridFileHeap) pHeap, handle);
+        return pEntry != NULL && IS_FILE_ALLOCATION_HANDLE(pEntry->handle);
+    }
+
+    /**
+     * Returns the file segment of the allocation or the segment count for the in-memory allocation
+     */
+    static UINT32 getAllocationSegment(PHeap pHeap, ALLOCATION_HANDLE handle)
+    {
+        PFileHeapEntry pEntry = hybridFileGetEntry((PHybridFileHeap) pHeap, handle);
+        return isFileAllocation(pHeap, handle) ? GET_FILE_HANDLE_SEGMENT(pEntry->handle) : ((PHybridFileHeap) pHeap)->segmentCount;
+    }
+
+    PCHAR mRootDirectory;
+};
+
+TEST_F(HybridFileHeapTest, hybridFileCreateHeap_InvalidInput)
+{
+    PHeap pHeap;
+
+    EXPECT_EQ(STATUS_INVALID_ARG, heapInitialize(MIN_HEAP_SIZE * 2, 50, FLAGS_USE_AIV_HEAP | FLAGS_USE_HYBRID_FILE_HEAP, &pHeap));
+    EXPECT_EQ(STATUS_INVALID_ARG, heapInitializeWithRootDirectory(MIN_HEAP_SIZE * 2, 50, FLAGS_USE_AIV_HEAP | FLAGS_USE_HYBRID_FILE_HEAP,
+                                                                  (PCHAR) "", &pHeap));
+    EXPECT_EQ(STATUS_HEAP_FILE_OPEN_FAILED, heapInitializeWithRootDirectory(MIN_HEAP_SIZE * 2, 50, FLAGS_USE_AIV_HEAP | FLAGS_USE_HYBRID_FILE_HEAP,
+                                                                            (PCHAR) "/non/existent/directory", &pHeap));
+
+    // The in-memory part of the heap is too small
+    EXPECT_EQ(STATUS_INVALID_ARG, heapInitializeWithRootDirectory(MIN_HEAP_SIZE * 2, 10, FLAGS_USE_AIV_HEAP | FLAGS_USE_HYBRID_FILE_HEAP,
+                                                                  mRootDirectory, &pHeap));
+    EXPECT_EQ(STATUS_INVALID_ARG, heapInitializeWithRootDirectory(MIN_HEAP_SIZE * 2, 0, FLAGS_USE_AIV_HEAP | FLAGS_USE_HYBRID_FILE_HEAP,
+                                                                  mRootDirectory, &pHeap));
+
+    // The file part of the heap is too small for the segment heap
+    EXPECT_EQ(STATUS_INVALID_ARG, heapInitializeWithRootDirectory(MIN_HEAP_SIZE * 2, 90, FLAGS_USE_AIV_HEAP | FLAGS_USE_HYBRID_FILE_HEAP,
+                                                                  mRootDirectory, &pHeap));
+
+    // The file part is validated before the directory is accessed
+    EXPECT_EQ(STATUS_INVALID_ARG, heapInitializeWithRootDirectory(MIN_HEAP_SIZE * 2, 90, FLAGS_USE_AIV_HEAP | FLAGS_USE_HYBRID_FILE_HEAP,
+                                                                  (PCHAR) "/non/existent/directory", &pHeap));
+}
+
+TEST_F(HybridFileHeapTest, hybridFileHeap_SpillToFile)
+{
+    PHeap pHeap;
+    PHybridFileHeap pHybridHeap;
+    ALLOCATION_HANDLE handles[100];
+    UINT32 i, j, allocSize = 1000000, memAllocs = 0, fileAllocs = 0, size;
+    UINT64 heapSize;
+    PBYTE pAlloc;
+
+    EXPECT_EQ(STATUS_SUCCESS, heapInitializeWithRootDirectory(MIN_HEAP_SIZE * 4, 50, FLAGS_USE_AIV_HEAP | FLAGS_USE_HYBRID_FILE_HEAP,
+                                                              mRootDirectory, &pHeap));
+    pHybridHeap = (PHybridFileHeap) pHeap;
+    EXPECT_EQ(1, pHybridHeap->segmentCount);
+    EXPECT_EQ(MIN_HEAP_SIZE * 2, pHybridHeap->pMemHeap->heap.heapLimit);
+    EXPECT_EQ(MIN_HEAP_SIZE * 2, pHybridHeap->pSegments[0].size);
+
+    // Allocate more than the in-memory heap can hold
+    for (i = 0; i < ARRAY_SIZE(handles); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, heapAlloc(pHeap, allocSize, &handles[i]));
+        if (!IS_VALID_ALLOCATION_HANDLE(handles[i])) {
+            break;
+        }
+
+        // The older allocations are spilled to make room for the new one in memory
+        EXPECT_FALSE(isFileAllocation(pHeap, handles[i]));
+
+        // Write a pattern
+        EXPECT_EQ(STATUS_SUCCESS, heapMap(pHeap, handles[i], (PVOID*) &pAlloc, &size));
+        EXPECT_EQ(allocSize, size);
+        MEMSET(pAlloc, (BYTE) i, size);
+        EXPECT_EQ(STATUS_SUCCESS, heapUnmap(pHeap, pAlloc));
+    }
+
+    // The oldest allocations are in the file and the newest ones are in memory
+    for (j = 0; j < i; j++) {
+        if (isFileAllocation(pHeap, handles[j])) {
+            EXPECT_EQ(0, memAllocs);
+            fileAllocs++;
+        } else {
+            memAllocs++;
+        }
+    }
+
+    // Both of the heaps should be exhausted
+    EXPECT_LT(i, ARRAY_SIZE(handles));
+    EXPECT_NE(0, memAllocs);
+    EXPECT_NE(0, fileAllocs);
+
+    // The hybrid heap accounts for both of the heaps
+    EXPECT_EQ(i, pHeap->numAlloc);
+    EXPECT_EQ(pHybridHeap->pMemHeap->heap.heapSize + pHybridHeap->pSegments[0].pHeap->heap.heapSize, pHeap->heapSize);
+    EXPECT_EQ(STATUS_SUCCESS, heapGetSize(pHeap, &heapSize));
+    EXPECT_EQ(pHeap->heapSize, heapSize);
+    EXPECT_EQ(STATUS_SUCCESS, heapDebugCheckAllocator(pHeap, FALSE));
+
+    // Validate the pattern of the moved allocations and shrink the allocations
+    for (j = 0; j < i; j++) {
+        EXPECT_EQ(STATUS_SUCCESS, heapMap(pHeap, handles[j], (PVOID*) &pAlloc, &size));
+        EXPECT_EQ(allocSize, size);
+        EXPECT_EQ((BYTE) j, pAlloc[0]);
+        EXPECT_EQ((BYTE) j, pAlloc[size - 1]);
+        EXPECT_EQ(STATUS_SUCCESS, heapUnmap(pHeap, pAlloc));
+
+        EXPECT_EQ(STATUS_SUCCESS, heapSetAllocSize(pHeap, handles[j], allocSize / 2));
+        EXPECT_EQ(STATUS_SUCCESS, heapGetAllocSize(pHeap, handles[j], &size));
+        EXPECT_EQ(allocSize / 2, size);
+    }
+
+    EXPECT_EQ(pHybridHeap->pMemHeap->heap.heapSize + pHybridHeap->pSegments[0].pHeap->heap.heapSize, pHeap->heapSize);
+
+    // Free in FIFO order. The new allocations keep going to memory.
+    EXPECT_TRUE(isFileAllocation(pHeap, handles[0]));
+    EXPECT_EQ(STATUS_SUCCESS, heapFree(pHeap, handles[0]));
+    EXPECT_EQ(STATUS_SUCCESS, heapAlloc(pHeap, allocSize, &handles[0]));
+    EXPECT_TRUE(IS_VALID_ALLOCATION_HANDLE(handles[0]));
+    EXPECT_FALSE(isFileAllocation(pHeap, handles[0]));
+
+    for (j = 0; j < i; j++) {
+        EXPECT_EQ(STATUS_SUCCESS, heapFree(pHeap, handles[j]));
+    }
+
+    EXPECT_EQ(0, pHeap->heapSize);
+    EXPECT_EQ(0, pHeap->numAlloc);
+
+    // The handles are not valid after the free
+    EXPECT_EQ(STATUS_INVALID_ARG, heapFree(pHeap, handles[0]));
+    EXPECT_EQ(STATUS_INVALID_ARG, heapMap(pHeap, handles[0], (PVOID*) &pAlloc, &size));
+    EXPECT_EQ(STATUS_INVALID_ARG, heapFree(pHeap, TO_FILE_HANDLE(1, 0)));
+
+    EXPECT_EQ(STATUS_SUCCESS, heapRelease(pHeap));
+}
+
+TEST_F(HybridFileHeapTest, hybridFileHeap_MultipleSegments)
+{
+    PHeap pHeap;
+    PHybridFileHeap pHybridHeap;
+    ALLOCATION_HANDLE handle;
+    UINT32 i, count = 0, allocSize = 10 * 1024 * 1024, size;
+    UINT64 heapLimit = 5 * FILE_HEAP_SEGMENT_SIZE / 2, fileHeapLimit = 0;
+    BOOL usedSegments[3];
+    PBYTE allocs[100];
+
+    // The last one marks the in-memory allocations
+    MEMSET(usedSegments, 0x00, SIZEOF(usedSegments));
+
+    // All of the heap is in the files except the minimal in-memory heap
+    EXPECT_EQ(STATUS_SUCCESS, heapInitializeWithRootDirectory(heapLimit, 5, FLAGS_USE_AIV_HEAP | FLAGS_USE_AIV_SEGREGATED_FIT | FLAGS_USE_HYBRID_FILE_HEAP,
+                                                              mRootDirectory, &pHeap));
+    pHybridHeap = (PHybridFileHeap) pHeap;
+    EXPECT_EQ(2, pHybridHeap->segmentCount);
+    for (i = 0; i < pHybridHeap->segmentCount; i++) {
+        fileHeapLimit += pHybridHeap->pSegments[i].size;
+    }
+
+    EXPECT_EQ(heapLimit, pHybridHeap->pMemHeap->heap.heapLimit + fileHeapLimit);
+
+    // Allocate all of the heap touching only the first page of the allocations.
+    // The allocations are kept mapped so they are not spilled and the new ones go directly to the files.
+    do {
+        EXPECT_EQ(STATUS_SUCCESS, heapAlloc(pHeap, allocSize, &handle));
+        if (IS_VALID_ALLOCATION_HANDLE(handle)) {
+            usedSegments[getAllocationSegment(pHeap, handle)] = TRUE;
+
+            ASSERT_LT(count, ARRAY_SIZE(allocs));
+            EXPECT_EQ(STATUS_SUCCESS, heapMap(pHeap, handle, (PVOID*) &allocs[count], &size));
+            allocs[count][0] = (BYTE) count;
+            count++;
+        }
+    } while (IS_VALID_ALLOCATION_HANDLE(handle));
+
+    EXPECT_TRUE(usedSegments[0]);
+    EXPECT_TRUE(usedSegments[1]);
+    EXPECT_TRUE(usedSegments[2]);
+    EXPECT_EQ(count, pHeap->numAlloc);
+    EXPECT_LT(heapLimit - pHeap->heapSize, (UINT64) allocSize * (pHybridHeap->segmentCount + 1));
+    EXPECT_EQ(STATUS_SUCCESS, heapDebugCheckAllocator(pHeap, FALSE));
+
+    for (i = 0; i < count; i++) {
+        EXPECT_EQ((BYTE) i, allocs[i][0]);
+        EXPECT_EQ(STATUS_SUCCESS, heapUnmap(pHeap, allocs[i]));
+    }
+
+    // Release with the outstanding allocations
+    EXPECT_EQ(STATUS_SUCCESS, heapRelease(pHeap));
+}
+
+TEST_F(HybridFileHeapTest, hybridFileHeap_MappedNotSpilled)
+{
+    PHeap pHeap;
+    ALLOCATION_HANDLE mappedHandle, handle, handles[100];
+    UINT32 i, count, allocSize = 1000000, size;
+    PBYTE pMapped, pAlloc;
+
+    EXPECT_EQ(STATUS_SUCCESS, heapInitializeWithRootDirectory(MIN_HEAP_SIZE * 4, 50, FLAGS_USE_AIV_HEAP | FLAGS_USE_HYBRID_FILE_HEAP,
+                                                              mRootDirectory, &pHeap));
+
+    // The oldest allocation stays mapped
+    EXPECT_EQ(STATUS_SUCCESS, heapAlloc(pHeap, allocSize, &mappedHandle));
+    EXPECT_EQ(STATUS_SUCCESS, heapMap(pHeap, mappedHandle, (PVOID*) &pMapped, &size));
+    MEMSET(pMapped, 0xab, size);
+
+    // Mapping twice returns the same address and needs two un-maps
+    EXPECT_EQ(STATUS_SUCCESS, heapMap(pHeap, mappedHandle, (PVOID*) &pAlloc, &size));
+    EXPECT_EQ(pMapped, pAlloc);
+
+    // Fill the in-memory part of the heap and spill into the files
+    for (count = 0; count < MIN_HEAP_SIZE * 3 / allocSize; count++) {
+        EXPECT_EQ(STATUS_SUCCESS, heapAlloc(pHeap, allocSize, &handles[count]));
+        EXPECT_TRUE(IS_VALID_ALLOCATION_HANDLE(handles[count]));
+    }
+
+    EXPECT_TRUE(isFileAllocation(pHeap, handles[0]));
+    EXPECT_FALSE(isFileAllocation(pHeap, handles[count - 1]));
+
+    // The mapped allocation is not moved
+    EXPECT_FALSE(isFileAllocation(pHeap, mappedHandle));
+    EXPECT_EQ(0xab, pMapped[0]);
+    EXPECT_EQ(0xab, pMapped[size - 1]);
+
+    // Un-mapping the unknown address fails
+    EXPECT_EQ(STATUS_INVALID_ARG, heapUnmap(pHeap, pMapped + 1));
+
+    EXPECT_EQ(STATUS_SUCCESS, heapUnmap(pHeap, pMapped));
+    EXPECT_EQ(STATUS_SUCCESS, heapUnmap(pHeap, pMapped));
+    EXPECT_EQ(STATUS_INVALID_ARG, heapUnmap(pHeap, pMapped));
+
+    // The un-mapped allocation is spilled first as the oldest one
+    for (i = 0; i < MIN_HEAP_SIZE / allocSize && !isFileAllocation(pHeap, mappedHandle); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, heapAlloc(pHeap, allocSize, &handle));
+        EXPECT_TRUE(IS_VALID_ALLOCATION_HANDLE(handle));
+        handles[count++] = handle;
+    }
+
+    EXPECT_TRUE(isFileAllocation(pHeap, mappedHandle));
+    EXPECT_EQ(STATUS_SUCCESS, heapMap(pHeap, mappedHandle, (PVOID*) &pAlloc, &size));
+    EXPECT_EQ(allocSize, size);
+    EXPECT_EQ(0xab, pAlloc[0]);
+    EXPECT_EQ(0xab, pAlloc[size - 1]);
+
+    // Freeing the mapped allocation drops the mapping
+    EXPECT_EQ(STATUS_SUCCESS, heapFree(pHeap, mappedHandle));
+    EXPECT_EQ(STATUS_INVALID_ARG, heapUnmap(pHeap, pAlloc));
+
+    for (i = 0; i < count; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, heapFree(pHeap, handles[i]));
+    }
+
+    EXPECT_EQ(0, pHeap->heapSize);
+    EXPECT_EQ(0, pHeap->numAlloc);
+    EXPECT_EQ(STATUS_SUCCESS, heapRelease(pHeap));
+}
+
+TEST_F(HybridFileHeapTest, hybridFileHeap_AllInMemory)
+{
+    PHeap pHeap;
+    ALLOCATION_HANDLE handle;
+
+    EXPECT_EQ(STATUS_SUCCESS, heapInitializeWithRootDirectory(MIN_HEAP_SIZE, 100, FLAGS_USE_SYSTEM_HEAP | FLAGS_USE_HYBRID_FILE_HEAP,
+                                                              mRootDirectory, &pHeap));
+    EXPECT_EQ(0, ((PHybridFileHeap) pHeap)->segmentCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, heapAlloc(pHeap, 1000, &handle));
+    EXPECT_FALSE(isFileAllocation(pHeap, handle));
+    EXPECT_EQ(STATUS_SUCCESS, heapFree(pHeap, handle));
+
+    // Not enough memory should return an invalid handle
+    EXPECT_EQ(STATUS_SUCCESS, heapAlloc(pHeap, (UINT32) MIN_HEAP_SIZE, &handle));
+    EXPECT_FALSE(IS_VALID_ALLOCATION_HANDLE(handle));
+
+    EXPECT_EQ(STATUS_SUCCESS, heapRelease(pHeap));
+}
@@ -57,6 +57,10 @@ extern "C" {
 #define STATUS_MKV_MIN_ANNEX_B_CPD_SIZE                                             STATUS_MKVGEN_BASE + 0x0000001d
 #define STATUS_MKV_ANNEXB_CPD_MISSING_NALUS                                         STATUS_MKVGEN_BASE + 0x0000001e
 #define STATUS_MKV_INVALID_ANNEXB_CPD_NALUS                                         STATUS_MKVGEN_BASE + 0x0000001f
+#define STATUS_MKV_INVALID_TRACK_COUNT                                              STATUS_MKVGEN_BASE + 0x00000020
+#define STATUS_MKV_INVALID_TRACK_ID                                                 STATUS_MKVGEN_BASE + 0x00000021
+#define STATUS_MKV_TRACK_INFO_NOT_FOUND                                             STATUS_MKVGEN_BASE + 0x00000022
+#define STATUS_MKV_FRAME_HEADER_NALS_ADAPTATION                                     STATUS_MKVGEN_BASE + 0x00000023
 
 ////////////////////////////////////////////////////
 // Main structure declarations
@@ -82,6 +86,21 @@ extern "C" {
  */
 #define MKV_MAX_CODEC_PRIVATE_LEN       1 * 1024 * 1024
 
+/**
+ * Max number of the tracks in a stream
+ */
+#define MKV_MAX_TRACK_COUNT             8
+
+/**
+ * Max track id. The track number is encoded in a single byte in the block headers.
+ */
+#define MKV_MAX_TRACK_ID                126
+
+/**
+ * Track id used for the single track streams
+ */
+#define MKV_DEFAULT_TRACK_ID            1
+
 /**
  * Minimal and Maximal cluster durations sanity values
  */
@@ -181,6 +200,12 @@ typedef enum {
      * Whether to adapt Annex-B NALUs for the codec private data to Avcc format NALUs
      */
     MKV_GEN_ADAPT_ANNEXB_CPD_NALS       = (1 << 5),
+
+    /**
+     * Whether to encode the simple block sizes and the cluster timecodes in the minimal EBML length
+     * instead of the fixed 8 bytes. Reduces the per-frame overhead for small frames.
+     */
+    MKV_GEN_COMPACT_EBML_SIZES          = (1 << 6),
 } MKV_BEHAVIOR_FLAGS;
 
 /**
@@ -207,8 +232,35 @@ typedef struct {
 
     // The frame bits
     PBYTE frameData;
+
+    // Id of the track the frame belongs to. Ignored for the single track streams.
+    UINT64 trackId;
 } Frame, *PFrame;
 
+/**
+ * The track of a multi-track stream
+ */
+typedef struct {
+    // Track number referenced by the frames. Unique within the stream in the range of 1 - MKV_MAX_TRACK_ID.
+    UINT64 trackId;
+
+    // Content type of the track - null terminated. The track type and the codec private data
+    // processing are based on it.
+    CHAR contentType[MAX_CONTENT_TYPE_LEN];
+
+    // Codec ID of the track - null terminated
+    CHAR codecId[MKV_MAX_CODEC_ID_LEN];
+
+    // Human readable track name - null terminated
+    CHAR trackName[MKV_MAX_TRACK_NAME_LEN];
+
+    // Size of the codec private data in bytes. Can be 0 if no CPD is used.
+    UINT32 codecPrivateDataSize;
+
+    // Codec private data. Can be NULL if no CPD is used.
+    PBYTE codecPrivateData;
+} TrackInfo, *PTrackInfo;
+
 /**
  * The representation of the packaged frame information
  */
@@ -279,6 +331,29 @@ typedef UINT64 (*GetCurrentTimeFunc)(UINT64);
  */
 PUBLIC_API STATUS createMkvGenerator(PCHAR, UINT32, UINT64, UINT64, PCHAR, PCHAR, PBYTE, UINT32, GetCurrentTimeFunc, UINT64, PMkvGenerator*);
 
+/**
+ * Create the MkvGenerator object for a multi-track stream.
+ *
+ * The frames of all the tracks are packaged into the same clusters. The frames should be
+ * submitted in the decoding timestamp order across the tracks. The clusters are started on
+ * the key frames so only the frames of the video track should be flagged as key frames.
+ *
+ * NOTE: The NALs adaptation applies to the video tracks only.
+ *
+ * @PCHAR - The content type of the stream
+ * @UINT32 - The behavior flags
+ * @UINT64 - Default timecode scale which will be applied to the generated MKV in 100ns
+ * @UINT64 - Duration of the cluster in 100ns
+ * @PTrackInfo - the tracks of the stream
+ * @UINT32 - number of the tracks
+ * @GetCurrentTimeFunc - the time function callback
+ * UINT64 - custom data to be passed to the callback
+ * @PMkvGenerator* - returns the newly created object
+ *
+ * @return - STATUS code of the execution
+ */
+PUBLIC_API STATUS createMkvGeneratorWithTracks(PCHAR, UINT32, UINT64, UINT64, PTrackInfo, UINT32, GetCurrentTimeFunc, UINT64, PMkvGenerator*);
+
 /**
  * Frees and de-allocates the memory of the MkvGenerator and it's sub-objects
  *
@@ -324,6 +399,35 @@ PUBLIC_API STATUS mkvgenGenerateHeader(PMkvGenerator, PBYTE, PUINT32, PUINT64);
  */
 PUBLIC_API STATUS mkvgenPackageFrame(PMkvGenerator, PFrame, PBYTE, PUINT32, PEncodedFrameInfo);
 
+/**
+ * Packages the MKV elements of a frame without the frame data. The frame data should follow
+ * the packaged bits unmodified in the stream to produce the same output as mkvgenPackageFrame.
+ *
+ * NOTE: The frames of the tracks which require NALs adaptation can't be packaged this way.
+ *
+ * @PMkvGenerator - The generator object
+ * @PFrame - Frame to package
+ * @PBYTE - Buffer to hold the packaged bits
+ * @PUINT32 - IN/OUT - Size of the produced packaged bits
+ * @PEncodedFrameInfo - OUT OPT - Information about the encoded frame - optional.
+ *
+ * @return - STATUS code of the execution
+ */
+PUBLIC_API STATUS mkvgenPackageFrameHeader(PMkvGenerator, PFrame, PBYTE, PUINT32, PEncodedFrameInfo);
+
+/**
+ * Gets the upper bound of the packaged frame size without scanning the frame data.
+ *
+ * NOTE: Packaging into a buffer of at least this size will scan and encode the frame in a single pass.
+ *
+ * @PMkvGenerator - The generator object
+ * @PFrame - Frame to get the packaged size for
+ * @PUINT32 - OUT - The max packaged size in bytes
+ *
+ * @return - STATUS code of the execution
+ */
+PUBLIC_API STATUS mkvgenGetMaxPackagedFrameSize(PMkvGenerator, PFrame, PUINT32);
+
 /**
  * Converts an MKV timecode to a timestamp
  *
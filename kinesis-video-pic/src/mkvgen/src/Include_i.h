@@ -14,6 +14,7 @@ extern "C" {
 // Project include files
 ////////////////////////////////////////////////////
 #include "com/amazonaws/kinesis/video/mkvgen/Include.h"
+#include "com/amazonaws/kinesis/video/trace/Include.h"
 
 // For tight packing
 #pragma pack(push, include_i, 1) // for byte alignment
@@ -73,12 +74,16 @@ extern UINT32 gMkvSegmentInfoBitsSize;
 // Offset into gMkvSegmentInfoBits for fixing-up the timecode scale
 #define MKV_SEGMENT_TIMECODE_SCALE_OFFSET 28
 
+extern BYTE gMkvTracksHeaderBits[];
+extern UINT32 gMkvTracksHeaderBitsSize;
 extern BYTE gMkvTrackInfoBits[];
 extern UINT32 gMkvTrackInfoBitsSize;
 extern BYTE gMkvTrackVideoBits[];
 extern UINT32 gMkvTrackVideoBitsSize;
 extern BYTE gMkvCodecPrivateDataElem[];
 extern UINT32 gMkvCodecPrivateDataElemSize;
+#define MKV_TRACKS_HEADER_BITS gMkvTracksHeaderBits
+#define MKV_TRACKS_HEADER_BITS_SIZE gMkvTracksHeaderBitsSize
 #define MKV_TRACK_INFO_BITS gMkvTrackInfoBits
 #define MKV_TRACK_INFO_BITS_SIZE gMkvTrackInfoBitsSize
 #define MKV_TRACK_VIDEO_BITS gMkvTrackVideoBits
@@ -89,23 +94,26 @@ extern UINT32 gMkvCodecPrivateDataElemSize;
 // The size of the track ID in bytes. We are using 8 bytes for the track ID
 #define MKV_TRACK_ID_BYTE_SIZE 8
 
-// gMkvTrackInfoBits element size offset for fixing up
+// gMkvTracksHeaderBits element size offset for fixing up
 #define MKV_TRACK_HEADER_SIZE_OFFSET 4
 
 // gMkvTrackInfoBits track entry size offset for fixing up
-#define MKV_TRACK_ENTRY_SIZE_OFFSET 9
+#define MKV_TRACK_ENTRY_SIZE_OFFSET 1
+
+// gMkvTrackInfoBits track number offset for fixing up
+#define MKV_TRACK_NUMBER_OFFSET 7
 
 // gMkvTrackInfoBits track ID offset for fixing up
-#define MKV_TRACK_ID_OFFSET 19
+#define MKV_TRACK_ID_OFFSET 11
 
 // gMkvTrackInfoBits track type offset for fixing up
-#define MKV_TRACK_TYPE_OFFSET 29
+#define MKV_TRACK_TYPE_OFFSET 21
 
 // gMkvTrackInfoBits track name offset for fixing up
-#define MKV_TRACK_NAME_OFFSET 33
+#define MKV_TRACK_NAME_OFFSET 25
 
 // gMkvTrackInfoBits Codec ID offset
-#define MKV_CODEC_ID_OFFSET 67
+#define MKV_CODEC_ID_OFFSET 59
 
 // Track info video width offset for fixing up
 #define MKV_TRACK_VIDEO_WIDTH_OFFSET 7
@@ -121,9 +129,15 @@ extern UINT32 gMkvClusterInfoBitsSize;
 #define MKV_CLUSTER_INFO_BITS gMkvClusterInfoBits
 #define MKV_CLUSTER_INFO_BITS_SIZE gMkvClusterInfoBitsSize
 
+// gMkvClusterInfoBits cluster timecode length offset for fixing up
+#define MKV_CLUSTER_TIMECODE_LENGTH_OFFSET 6
+
 // gMkvClusterInfoBits cluster timecode offset for fixing up
 #define MKV_CLUSTER_TIMECODE_OFFSET 7
 
+// gMkvClusterInfoBits cluster timecode length in bytes. Compact encoding uses the minimal length instead.
+#define MKV_CLUSTER_TIMECODE_LENGTH 8
+
 extern BYTE gMkvSimpleBlockBits[];
 extern UINT32 gMkvSimpleBlockBitsSize;
 #define MKV_SIMPLE_BLOCK_BITS gMkvSimpleBlockBits
@@ -135,11 +149,20 @@ extern UINT32 gMkvSimpleBlockBitsSize;
 // gMkvSimpleBlockBits simple block element size offset for fixing up
 #define MKV_SIMPLE_BLOCK_SIZE_OFFSET 1
 
-// gMkvSimpleBlockBits block timecode offset for fixing up
-#define MKV_SIMPLE_BLOCK_TIMECODE_OFFSET 10
+// gMkvSimpleBlockBits simple block element size length in bytes. Compact encoding uses the minimal length instead.
+#define MKV_SIMPLE_BLOCK_SIZE_LENGTH 8
+
+// gMkvSimpleBlockBits payload header offset
+#define MKV_SIMPLE_BLOCK_PAYLOAD_HEADER_OFFSET 9
 
-// gMkvSimpleBlockBits simple block flags offset for fixing up
-#define MKV_SIMPLE_BLOCK_FLAGS_OFFSET 12
+// Track number offset in the payload header for fixing up
+#define MKV_SIMPLE_BLOCK_TRACK_NUMBER_OFFSET 0
+
+// Block timecode offset in the payload header for fixing up
+#define MKV_SIMPLE_BLOCK_TIMECODE_OFFSET 1
+
+// Simple block flags offset in the payload header for fixing up
+#define MKV_SIMPLE_BLOCK_FLAGS_OFFSET 3
 
 /**
  * MKV simple block flags
@@ -150,7 +173,8 @@ extern UINT32 gMkvSimpleBlockBitsSize;
 #define MKV_SIMPLE_BLOCK_DISCARDABLE_FLAG           0x01
 
 /**
- * MKV block overhead in bytes
+ * MKV block overhead in bytes.
+ * NOTE: The overheads are the upper bounds with the compact EBML sizes.
  */
 #define MKV_SIMPLE_BLOCK_OVERHEAD    (MKV_SIMPLE_BLOCK_BITS_SIZE)
 
@@ -160,9 +184,11 @@ extern UINT32 gMkvSimpleBlockBitsSize;
 #define MKV_CLUSTER_OVERHEAD     (MKV_CLUSTER_INFO_BITS_SIZE + MKV_SIMPLE_BLOCK_OVERHEAD)
 
 /**
- * MKV header size in bytes
+ * MKV header size in bytes for a single track stream.
+ * NOTE: The additional tracks are accounted for in the header overhead.
  */
-#define MKV_HEADER_SIZE         (MKV_HEADER_BITS_SIZE + MKV_SEGMENT_HEADER_BITS_SIZE + MKV_SEGMENT_INFO_BITS_SIZE + MKV_TRACK_INFO_BITS_SIZE)
+#define MKV_HEADER_SIZE         (MKV_HEADER_BITS_SIZE + MKV_SEGMENT_HEADER_BITS_SIZE + MKV_SEGMENT_INFO_BITS_SIZE + \
+                                 MKV_TRACKS_HEADER_BITS_SIZE + MKV_TRACK_INFO_BITS_SIZE)
 /**
  * MKV header overhead in bytes
  */
@@ -180,6 +206,36 @@ extern UINT32 gMkvSimpleBlockBitsSize;
 #include "NalAdapter.h"
 #include "SpsParser.h"
 
+/**
+ * Track of the generator
+ */
+typedef struct {
+    // Track number as it's referenced by the blocks
+    UINT64 trackId;
+
+    // The content type of the track
+    BYTE trackType;
+
+    // Codec ID - 1 more for the null terminator
+    CHAR codecId[MKV_MAX_CODEC_ID_LEN + 1];
+
+    // Track name - 1 more for the null terminator
+    CHAR trackName[MKV_MAX_TRACK_NAME_LEN + 1];
+
+    // NALUs adaptation of the track frames
+    MKV_NALS_ADAPTATION nalsAdaptation;
+
+    // Video height and width - Only for video
+    UINT16 videoWidth;
+    UINT16 videoHeight;
+
+    // Codec private data size
+    UINT32 codecPrivateDataSize;
+
+    // Codec private data
+    PBYTE codecPrivateData;
+} MkvTrack, *PMkvTrack;
+
 /**
  * MkvGenerator internal structure
  */
@@ -202,15 +258,6 @@ typedef struct {
     // Clusters desired duration
     UINT64 clusterDuration;
 
-    // The content type of the stream
-    BYTE trackType;
-
-    // Codec ID - 1 more for the null terminator
-    CHAR codecId[MKV_MAX_CODEC_ID_LEN + 1];
-
-    // Track name - 1 more for the null terminator
-    CHAR trackName[MKV_MAX_TRACK_NAME_LEN + 1];
-
     // Time function entry
     GetCurrentTimeFunc getTimeFn;
 
@@ -232,15 +279,14 @@ typedef struct {
     // Whether to adapt CPD NALs from Annex-B to Avcc format.
     BOOL adaptCpdNals;
 
-    // Video height and width - Only for video
-    UINT16 videoWidth;
-    UINT16 videoHeight;
+    // Whether to encode the block sizes and the cluster timecodes in the minimal EBML length
+    BOOL compactEbmlSizes;
 
-    // Codec private data size
-    UINT32 codecPrivateDataSize;
+    // Number of the tracks
+    UINT32 trackCount;
 
-    // Codec private data
-    PBYTE codecPrivateData;
+    // The tracks. The codec private data of the tracks follows the structure.
+    MkvTrack tracks[MKV_MAX_TRACK_COUNT];
 } StreamMkvGenerator, *PStreamMkvGenerator;
 
 ////////////////////////////////////////////////////
@@ -262,19 +308,73 @@ MKV_STREAM_STATE mkvgenGetStreamState(PStreamMkvGenerator, FRAME_FLAGS, UINT64);
  *
  * @PStreamMkvGenerator - the current generator object
  * @MKV_STREAM_STATE - State of the MKV parser
+ * @UINT64 - the cluster timecode. MAX_UINT64 if unknown.
+ * @UINT64 - the max adapted frame size. MAX_UINT32 if unknown.
  *
  * @return - Size of the overhead in bytes
  **/
-UINT32 mkvgenGetFrameOverhead(PStreamMkvGenerator, MKV_STREAM_STATE);
+UINT32 mkvgenGetFrameOverhead(PStreamMkvGenerator, MKV_STREAM_STATE, UINT64, UINT64);
 
 /**
- * Gets the size of the MKV header
+ * Gets the length of the encoded cluster timecode
+ *
+ * @PStreamMkvGenerator - the current generator object
+ * @UINT64 - the cluster timecode
+ *
+ * @return - Length of the timecode in bytes
+ **/
+UINT32 mkvgenGetClusterTimecodeLength(PStreamMkvGenerator, UINT64);
+
+/**
+ * Gets the length of the EBML encoded simple block size.
+ *
+ * NOTE: The length is based on the max adapted frame size so it's known before the frame is adapted.
+ *
+ * @PStreamMkvGenerator - the current generator object
+ * @UINT64 - the max adapted frame size
+ *
+ * @return - Length of the size in bytes
+ **/
+UINT32 mkvgenGetSimpleBlockSizeLength(PStreamMkvGenerator, UINT64);
+
+/**
+ * Gets the size of the MKV header on top of the single track MKV_HEADER_SIZE
  * @PStreamMkvGenerator - the current generator object
  *
  * @return - Size of the header in bytes
  */
 UINT32 mkvgenGetHeaderOverhead(PStreamMkvGenerator);
 
+/**
+ * Gets the size of the track entry on top of the MKV_TRACK_INFO_BITS_SIZE
+ * @PMkvTrack - the track
+ *
+ * @return - Size in bytes
+ */
+UINT32 mkvgenGetTrackEntryOverhead(PMkvTrack);
+
+/**
+ * Gets the track of the frame
+ *
+ * @PStreamMkvGenerator - the current generator object
+ * @PFrame - Frame object
+ * @PMkvTrack* - OUT - The track the frame belongs to
+ *
+ * @return - STATUS code of the execution
+ **/
+STATUS mkvgenGetTrack(PStreamMkvGenerator, PFrame, PMkvTrack*);
+
+/**
+ * Stores the codec private data of the track adapting it if needed and extracts the video config
+ *
+ * @PStreamMkvGenerator - the current generator object
+ * @PMkvTrack - The track with the CPD buffer and the adapted size set
+ * @PTrackInfo - The track info to take the CPD from
+ *
+ * @return - STATUS code of the execution
+ **/
+STATUS mkvgenSetTrackCodecPrivateData(PStreamMkvGenerator, PMkvTrack, PTrackInfo);
+
 /**
  * Fast validation of the frame object
  *
@@ -288,6 +388,20 @@ UINT32 mkvgenGetHeaderOverhead(PStreamMkvGenerator);
  **/
 STATUS mkvgenValidateFrame(PStreamMkvGenerator, PFrame, PUINT64, PUINT64, PMKV_STREAM_STATE);
 
+/**
+ * Packages the frame with or without the frame data
+ *
+ * @PStreamMkvGenerator - the current generator object
+ * @PFrame - Frame to package
+ * @PBYTE - Buffer to hold the packaged bits
+ * @PUINT32 - IN/OUT - Size of the produced packaged bits
+ * @PEncodedFrameInfo - OUT OPT - Information about the encoded frame - optional.
+ * @BOOL - Whether to package the MKV elements only without the frame data
+ *
+ * @return - STATUS code of the execution
+ **/
+STATUS mkvgenPackageFrameInternal(PStreamMkvGenerator, PFrame, PBYTE, PUINT32, PEncodedFrameInfo, BOOL);
+
 /**
  * Returns the MKV track type from the provided content type
  *
@@ -355,15 +469,26 @@ STATUS mkvgenEbmlEncodeSegmentInfo(PBYTE, UINT32, UINT64, PUINT32);
  */
 STATUS mkvgenEbmlEncodeTrackInfo(PBYTE, UINT32, PStreamMkvGenerator, PUINT32);
 
+/**
+ * EBML encodes a track entry and stores in the buffer
+ *
+ * @PBYTE - the buffer to store the encoded info in
+ * @UINT32 - the size of the buffer
+ * @PMkvTrack - The track to encode
+ * @PUINT32 - the returned encoded length of the number in bytes
+ */
+STATUS mkvgenEbmlEncodeTrackEntry(PBYTE, UINT32, PMkvTrack, PUINT32);
+
 /**
  * EBML encodes a cluster header and stores in the buffer
  *
  * @PBYTE - the buffer to store the encoded info in
  * @UINT32 - the size of the buffer
  * @UINT64 - cluster timestamp
+ * @UINT32 - the length of the encoded cluster timestamp
  * @PUINT32 - the returned encoded length of the number in bytes
  */
-STATUS mkvgenEbmlEncodeClusterInfo(PBYTE, UINT32, UINT64, PUINT32);
+STATUS mkvgenEbmlEncodeClusterInfo(PBYTE, UINT32, UINT64, UINT32, PUINT32);
 
 /**
  * EBML encodes a simple block and stores in the buffer
@@ -373,10 +498,35 @@ STATUS mkvgenEbmlEncodeClusterInfo(PBYTE, UINT32, UINT64, PUINT32);
  * @INT16 - frame timestamp
  * @PFrame - the frame to encode
  * @UINT32 - the adapted frame size
- * @MKV_NALS_ADAPTATION - Nal adaptation mode
+ * @UINT32 - the length of the encoded block size
+ * @PMkvTrack - the track of the frame
  * @PUINT32 - the returned encoded length of the number in bytes
  */
-STATUS mkvgenEbmlEncodeSimpleBlock(PBYTE, UINT32, INT16, PFrame, UINT32, MKV_NALS_ADAPTATION, PUINT32);
+STATUS mkvgenEbmlEncodeSimpleBlock(PBYTE, UINT32, INT16, PFrame, UINT32, UINT32, PMkvTrack, PUINT32);
+
+/**
+ * EBML encodes a simple block header without the frame data and stores in the buffer
+ *
+ * @PBYTE - the buffer to store the encoded info in
+ * @UINT32 - the size of the buffer
+ * @INT16 - frame timestamp
+ * @PFrame - the frame to encode
+ * @UINT32 - the size of the frame data following the header
+ * @UINT32 - the length of the encoded block size
+ * @PMkvTrack - the track of the frame
+ * @PUINT32 - the returned encoded length of the header in bytes
+ */
+STATUS mkvgenEbmlEncodeSimpleBlockHeader(PBYTE, UINT32, INT16, PFrame, UINT32, UINT32, PMkvTrack, PUINT32);
+
+/**
+ * EBML encodes a number using the given length
+ *
+ * @UINT64 - the number to encode
+ * @UINT32 - the length of the encoding in bytes
+ * @PBYTE - the buffer to store the encoded number in
+ * @UINT32 - the size of the buffer
+ */
+STATUS mkvgenEbmlEncodeNumberWithLength(UINT64, UINT32, PBYTE, UINT32);
 
 /**
  * Returns the byte count of a number
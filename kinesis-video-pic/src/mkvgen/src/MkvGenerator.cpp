@@ -15,15 +15,56 @@
 STATUS createMkvGenerator(PCHAR contentType, UINT32 behaviorFlags, UINT64 timecodeScale, UINT64 clusterDuration,
         PCHAR codecId, PCHAR trackName, PBYTE codecPrivateData, UINT32 codecPrivateDataSize,
         GetCurrentTimeFunc getTimeFn, UINT64 customData, PMkvGenerator* ppMkvGenerator)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    TrackInfo trackInfo;
+
+    // Check the input params
+    CHK(ppMkvGenerator != NULL, STATUS_NULL_ARG);
+    CHK(STRNLEN(contentType, MAX_CONTENT_TYPE_LEN) < MAX_CONTENT_TYPE_LEN, STATUS_MKV_INVALID_CONTENT_TYPE_LENGTH);
+    CHK(STRNLEN(codecId, MKV_MAX_CODEC_ID_LEN) < MKV_MAX_CODEC_ID_LEN, STATUS_MKV_INVALID_CODEC_ID_LENGTH);
+    CHK(STRNLEN(trackName, MKV_MAX_TRACK_NAME_LEN) < MKV_MAX_TRACK_NAME_LEN, STATUS_MKV_INVALID_TRACK_NAME_LENGTH);
+
+    // The stream content type describes the single track
+    MEMSET(&trackInfo, 0x00, SIZEOF(TrackInfo));
+    trackInfo.trackId = MKV_DEFAULT_TRACK_ID;
+    STRNCPY(trackInfo.contentType, contentType, MAX_CONTENT_TYPE_LEN);
+    STRNCPY(trackInfo.codecId, codecId, MKV_MAX_CODEC_ID_LEN);
+    STRNCPY(trackInfo.trackName, trackName, MKV_MAX_TRACK_NAME_LEN);
+    trackInfo.codecPrivateDataSize = codecPrivateDataSize;
+    trackInfo.codecPrivateData = codecPrivateData;
+
+    CHK_STATUS(createMkvGeneratorWithTracks(contentType, behaviorFlags, timecodeScale, clusterDuration, &trackInfo, 1,
+                                            getTimeFn, customData, ppMkvGenerator));
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Creates a multi-track mkv generator object
+ */
+STATUS createMkvGeneratorWithTracks(PCHAR contentType, UINT32 behaviorFlags, UINT64 timecodeScale, UINT64 clusterDuration,
+        PTrackInfo pTrackInfos, UINT32 trackInfoCount, GetCurrentTimeFunc getTimeFn, UINT64 customData,
+        PMkvGenerator* ppMkvGenerator)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PStreamMkvGenerator pMkvGenerator = NULL;
-    UINT32 allocationSize, adaptedCodecPrivateDataSize;
+    PTrackInfo pTrackInfo;
+    PMkvTrack pTrack;
+    PBYTE pCurrentCpd;
+    UINT32 i, j, allocationSize, adaptedCodecPrivateDataSize = 0;
+    UINT32 adaptedCpdSizes[MKV_MAX_TRACK_COUNT];
     BOOL adaptAnnexB = FALSE, adaptAvcc = FALSE, adaptCpdAnnexB = FALSE;
+    MKV_NALS_ADAPTATION nalsAdaptation;
 
     // Check the input params
-    CHK(ppMkvGenerator != NULL, STATUS_NULL_ARG);
+    CHK(ppMkvGenerator != NULL && pTrackInfos != NULL, STATUS_NULL_ARG);
+    CHK(trackInfoCount != 0 && trackInfoCount <= MKV_MAX_TRACK_COUNT, STATUS_MKV_INVALID_TRACK_COUNT);
 
     // Clustering boundary checks if we are not doing key-frame clustering
     if ((behaviorFlags & MKV_GEN_KEY_FRAME_PROCESSING) == MKV_GEN_FLAG_NONE) {
@@ -45,10 +86,14 @@ STATUS createMkvGenerator(PCHAR contentType, UINT32 behaviorFlags, UINT64 timeco
     CHK(!(adaptAnnexB && adaptAvcc), STATUS_MKV_BOTH_ANNEXB_AND_AVCC_SPECIFIED);
     CHK(timecodeScale <= MAX_TIMECODE_SCALE && timecodeScale >= MIN_TIMECODE_SCALE, STATUS_MKV_INVALID_TIMECODE_SCALE);
     CHK(STRNLEN(contentType, MAX_CONTENT_TYPE_LEN) < MAX_CONTENT_TYPE_LEN, STATUS_MKV_INVALID_CONTENT_TYPE_LENGTH);
-    CHK(STRNLEN(codecId, MKV_MAX_CODEC_ID_LEN) < MKV_MAX_CODEC_ID_LEN, STATUS_MKV_INVALID_CODEC_ID_LENGTH);
-    CHK(STRNLEN(trackName, MKV_MAX_TRACK_NAME_LEN) < MKV_MAX_TRACK_NAME_LEN, STATUS_MKV_INVALID_TRACK_NAME_LENGTH);
-    CHK(codecPrivateDataSize <= MKV_MAX_CODEC_PRIVATE_LEN, STATUS_MKV_INVALID_CODEC_PRIVATE_LENGTH);
-    CHK(codecPrivateDataSize == 0 || codecPrivateData != NULL, STATUS_MKV_CODEC_PRIVATE_NULL);
+
+    if (adaptAnnexB) {
+        nalsAdaptation = MKV_NALS_ADAPT_ANNEXB;
+    } else if (adaptAvcc) {
+        nalsAdaptation = MKV_NALS_ADAPT_AVCC;
+    } else {
+        nalsAdaptation = MKV_NALS_ADAPT_NONE;
+    }
 
     // Initialize the endianness for the library
     initializeEndianness();
@@ -56,20 +101,37 @@ STATUS createMkvGenerator(PCHAR contentType, UINT32 behaviorFlags, UINT64 timeco
     // Initialize the random generator
     SRAND((UINT32) GETTIME());
 
-    if (codecPrivateDataSize != 0) {
-        dumpMemoryHex(codecPrivateData, codecPrivateDataSize);
-    }
+    // Validate the tracks and calculate the adapted CPD sizes
+    for (i = 0; i < trackInfoCount; i++) {
+        pTrackInfo = &pTrackInfos[i];
+        CHK(pTrackInfo->trackId != 0 && pTrackInfo->trackId <= MKV_MAX_TRACK_ID, STATUS_MKV_INVALID_TRACK_ID);
+        for (j = 0; j < i; j++) {
+            CHK(pTrackInfos[j].trackId != pTrackInfo->trackId, STATUS_MKV_INVALID_TRACK_ID);
+        }
 
-    // Calculate the adapted CPD size
-    adaptedCodecPrivateDataSize = codecPrivateDataSize;
-    if (codecPrivateDataSize != 0 && adaptCpdAnnexB) {
-        if (0 == STRCMP(contentType, MKV_H264_CONTENT_TYPE)) {
-            CHK_STATUS(adaptH264CpdNalsFromAnnexBToAvcc(codecPrivateData, codecPrivateDataSize, NULL,
-                                                        &adaptedCodecPrivateDataSize));
-        } else if (0 == STRCMP(contentType, MKV_H265_CONTENT_TYPE)) {
-            CHK_STATUS(adaptH265CpdNalsFromAnnexBToHvcc(codecPrivateData, codecPrivateDataSize, NULL,
-                                                        &adaptedCodecPrivateDataSize));
+        CHK(STRNLEN(pTrackInfo->contentType, MAX_CONTENT_TYPE_LEN) < MAX_CONTENT_TYPE_LEN, STATUS_MKV_INVALID_CONTENT_TYPE_LENGTH);
+        CHK(STRNLEN(pTrackInfo->codecId, MKV_MAX_CODEC_ID_LEN) < MKV_MAX_CODEC_ID_LEN, STATUS_MKV_INVALID_CODEC_ID_LENGTH);
+        CHK(STRNLEN(pTrackInfo->trackName, MKV_MAX_TRACK_NAME_LEN) < MKV_MAX_TRACK_NAME_LEN, STATUS_MKV_INVALID_TRACK_NAME_LENGTH);
+        CHK(pTrackInfo->codecPrivateDataSize <= MKV_MAX_CODEC_PRIVATE_LEN, STATUS_MKV_INVALID_CODEC_PRIVATE_LENGTH);
+        CHK(pTrackInfo->codecPrivateDataSize == 0 || pTrackInfo->codecPrivateData != NULL, STATUS_MKV_CODEC_PRIVATE_NULL);
+
+        if (pTrackInfo->codecPrivateDataSize != 0) {
+            dumpMemoryHex(pTrackInfo->codecPrivateData, pTrackInfo->codecPrivateDataSize);
         }
+
+        // Calculate the adapted CPD size
+        adaptedCpdSizes[i] = pTrackInfo->codecPrivateDataSize;
+        if (pTrackInfo->codecPrivateDataSize != 0 && adaptCpdAnnexB) {
+            if (0 == STRCMP(pTrackInfo->contentType, MKV_H264_CONTENT_TYPE)) {
+                CHK_STATUS(adaptH264CpdNalsFromAnnexBToAvcc(pTrackInfo->codecPrivateData, pTrackInfo->codecPrivateDataSize,
+                                                            NULL, &adaptedCpdSizes[i]));
+            } else if (0 == STRCMP(pTrackInfo->contentType, MKV_H265_CONTENT_TYPE)) {
+                CHK_STATUS(adaptH265CpdNalsFromAnnexBToHvcc(pTrackInfo->codecPrivateData, pTrackInfo->codecPrivateDataSize,
+                                                            NULL, &adaptedCpdSizes[i]));
+            }
+        }
+
+        adaptedCodecPrivateDataSize += adaptedCpdSizes[i];
     }
 
     // Allocate the main struct
@@ -82,26 +144,15 @@ STATUS createMkvGenerator(PCHAR contentType, UINT32 behaviorFlags, UINT64 timeco
     pMkvGenerator->mkvGenerator.version = 0;
     pMkvGenerator->timecodeScale = timecodeScale * DEFAULT_TIME_UNIT_IN_NANOS; // store in nanoseconds
     pMkvGenerator->clusterDuration = clusterDuration * DEFAULT_TIME_UNIT_IN_NANOS / pMkvGenerator->timecodeScale; // No chance of an overflow as we check against max earlier
-    pMkvGenerator->trackType = mkvgenGetTrackTypeFromContentType(contentType);
     pMkvGenerator->streamStarted = FALSE;
     pMkvGenerator->keyFrameClustering = (behaviorFlags & MKV_GEN_KEY_FRAME_PROCESSING) != MKV_GEN_FLAG_NONE;
     pMkvGenerator->streamTimestamps = (behaviorFlags & MKV_GEN_IN_STREAM_TIME) != MKV_GEN_FLAG_NONE;
     pMkvGenerator->absoluteTimeClusters = (behaviorFlags & MKV_GEN_ABSOLUTE_CLUSTER_TIME) != MKV_GEN_FLAG_NONE;
     pMkvGenerator->adaptCpdNals = adaptCpdAnnexB;
+    pMkvGenerator->compactEbmlSizes = (behaviorFlags & MKV_GEN_COMPACT_EBML_SIZES) != MKV_GEN_FLAG_NONE;
+    pMkvGenerator->nalsAdaptation = nalsAdaptation;
     pMkvGenerator->lastClusterTimestamp = 0;
     pMkvGenerator->streamStartTimestamp = 0;
-    STRNCPY(pMkvGenerator->codecId, codecId, MKV_MAX_CODEC_ID_LEN);
-    pMkvGenerator->codecId[MKV_MAX_CODEC_ID_LEN] = '\0';
-    STRNCPY(pMkvGenerator->trackName, trackName, MKV_MAX_TRACK_NAME_LEN);
-    pMkvGenerator->trackName[MKV_MAX_TRACK_NAME_LEN] = '\0';
-
-    if (adaptAnnexB) {
-        pMkvGenerator->nalsAdaptation = MKV_NALS_ADAPT_ANNEXB;
-    } else if (adaptAvcc) {
-        pMkvGenerator->nalsAdaptation = MKV_NALS_ADAPT_AVCC;
-    } else {
-        pMkvGenerator->nalsAdaptation = MKV_NALS_ADAPT_NONE;
-    }
 
     // the getTime function is optional
     pMkvGenerator->getTimeFn = (getTimeFn != NULL) ? getTimeFn : getTimeAdapter;
@@ -109,57 +160,29 @@ STATUS createMkvGenerator(PCHAR contentType, UINT32 behaviorFlags, UINT64 timeco
     // Store the custom data as well
     pMkvGenerator->customData = customData;
 
-    // Set the codec private data
-    pMkvGenerator->codecPrivateDataSize = adaptedCodecPrivateDataSize;
-    pMkvGenerator->codecPrivateData = (PBYTE)(pMkvGenerator + 1);
-    if (adaptedCodecPrivateDataSize != 0) {
-        if (pMkvGenerator->adaptCpdNals) {
-            if (0 == STRCMP(contentType, MKV_H264_CONTENT_TYPE)) {
-                CHK_STATUS(adaptH264CpdNalsFromAnnexBToAvcc(codecPrivateData, codecPrivateDataSize,
-                                                            pMkvGenerator->codecPrivateData,
-                                                            &pMkvGenerator->codecPrivateDataSize));
-            } else if (0 == STRCMP(contentType, MKV_H265_CONTENT_TYPE)) {
-                CHK_STATUS(adaptH265CpdNalsFromAnnexBToHvcc(codecPrivateData, codecPrivateDataSize,
-                                                            pMkvGenerator->codecPrivateData,
-                                                            &pMkvGenerator->codecPrivateDataSize));
-            }
-        } else {
-            MEMCPY(pMkvGenerator->codecPrivateData, codecPrivateData, adaptedCodecPrivateDataSize);
-        }
-    }
-
-    // Check whether we need to generate a video config element for
-    // H264, H265 or M-JJPG content type if the CPD is present
-    if (codecPrivateData != NULL && codecPrivateDataSize != 0) {
-        // Check and process the H264 then H265 and later M-JPG content type
-        if (0 == STRCMP(contentType, MKV_H264_CONTENT_TYPE)) {
-            retStatus = getVideoWidthAndHeightFromH264Sps(pMkvGenerator->codecPrivateData,
-                                                          pMkvGenerator->codecPrivateDataSize,
-                                                          &pMkvGenerator->videoWidth,
-                                                          &pMkvGenerator->videoHeight);
-
-        } else if (0 == STRCMP(contentType, MKV_H265_CONTENT_TYPE)) {
-            retStatus = getVideoWidthAndHeightFromH265Sps(pMkvGenerator->codecPrivateData,
-                                                          pMkvGenerator->codecPrivateDataSize,
-                                                          &pMkvGenerator->videoWidth,
-                                                          &pMkvGenerator->videoHeight);
-
-        } else if ((0 == STRCMP(contentType, MKV_X_MKV_CONTENT_TYPE)) &&
-                (0 == STRCMP(codecId, MKV_FOURCC_CODEC_ID))) {
-            // For M-JPG we have content type as video/x-matroska and the codec
-            // type set as V_MS/VFW/FOURCC
-            retStatus = getVideoWidthAndHeightFromBih(pMkvGenerator->codecPrivateData,
-                                                      pMkvGenerator->codecPrivateDataSize,
-                                                      &pMkvGenerator->videoWidth,
-                                                      &pMkvGenerator->videoHeight);
-        }
-
-        if (STATUS_FAILED(retStatus)) {
-            // This might not be yet fatal so warn and reset the status
-            DLOGW("Failed extracting video configuration from SPS with %08x.", retStatus);
-
-            retStatus = STATUS_SUCCESS;
-        }
+    // Set the tracks. The codec private data of the tracks is stored following the main structure.
+    pMkvGenerator->trackCount = trackInfoCount;
+    pCurrentCpd = (PBYTE)(pMkvGenerator + 1);
+    for (i = 0; i < trackInfoCount; i++) {
+        pTrackInfo = &pTrackInfos[i];
+        pTrack = &pMkvGenerator->tracks[i];
+
+        pTrack->trackId = pTrackInfo->trackId;
+        pTrack->trackType = mkvgenGetTrackTypeFromContentType(pTrackInfo->contentType);
+        STRNCPY(pTrack->codecId, pTrackInfo->codecId, MKV_MAX_CODEC_ID_LEN);
+        pTrack->codecId[MKV_MAX_CODEC_ID_LEN] = '\0';
+        STRNCPY(pTrack->trackName, pTrackInfo->trackName, MKV_MAX_TRACK_NAME_LEN);
+        pTrack->trackName[MKV_MAX_TRACK_NAME_LEN] = '\0';
+
+        // Only the video frames are NAL adapted in a multi-track stream
+        pTrack->nalsAdaptation = (trackInfoCount == 1 || pTrack->trackType == MKV_TRACK_TYPE_VIDEO) ?
+                                 nalsAdaptation : MKV_NALS_ADAPT_NONE;
+
+        // Set the codec private data
+        pTrack->codecPrivateDataSize = adaptedCpdSizes[i];
+        pTrack->codecPrivateData = pCurrentCpd;
+        pCurrentCpd += adaptedCpdSizes[i];
+        CHK_STATUS(mkvgenSetTrackCodecPrivateData(pMkvGenerator, pTrack, pTrackInfo));
     }
 
     // Assign the created object
@@ -220,33 +243,72 @@ CleanUp:
  * Package frame in MKV format
  */
 STATUS mkvgenPackageFrame(PMkvGenerator pMkvGenerator, PFrame pFrame, PBYTE pBuffer, PUINT32 pSize, PEncodedFrameInfo pEncodedFrameInfo)
+{
+    return mkvgenPackageFrameInternal((PStreamMkvGenerator) pMkvGenerator, pFrame, pBuffer, pSize, pEncodedFrameInfo, FALSE);
+}
+
+/**
+ * Package the MKV elements of the frame without the frame data
+ */
+STATUS mkvgenPackageFrameHeader(PMkvGenerator pMkvGenerator, PFrame pFrame, PBYTE pBuffer, PUINT32 pSize, PEncodedFrameInfo pEncodedFrameInfo)
+{
+    return mkvgenPackageFrameInternal((PStreamMkvGenerator) pMkvGenerator, pFrame, pBuffer, pSize, pEncodedFrameInfo, TRUE);
+}
+
+STATUS mkvgenPackageFrameInternal(PStreamMkvGenerator pStreamMkvGenerator, PFrame pFrame, PBYTE pBuffer, PUINT32 pSize,
+                                  PEncodedFrameInfo pEncodedFrameInfo, BOOL headerOnly)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
-    PStreamMkvGenerator pStreamMkvGenerator;
+    ProfilerTrace profilerTrace = PROFILER_TRACE_INITIALIZER;
     MKV_STREAM_STATE streamState = MKV_STATE_START_STREAM;
-    UINT32 bufferSize, encodedLen, packagedSize, adaptedFrameSize, overheadSize;
+    UINT32 bufferSize, encodedLen, packagedSize, adaptedFrameSize, overheadSize, blockSizeLength;
     // Evaluated presentation and decode timestamps
-    UINT64 pts = 0, dts = 0;
+    UINT64 pts = 0, dts = 0, clusterTimecode = 0;
     BOOL clusterStart = FALSE;
     PBYTE pCurrentPnt = pBuffer;
+    PMkvTrack pTrack = NULL;
 
     // Check the input params
-    CHK(pSize != NULL && pMkvGenerator != NULL, STATUS_NULL_ARG);
+    CHK(pSize != NULL && pStreamMkvGenerator != NULL, STATUS_NULL_ARG);
 
-    pStreamMkvGenerator = (PStreamMkvGenerator) pMkvGenerator;
+    PROFILER_TRACE_START("mkvgenPackageFrame", TRACE_LEVEL_INFO, &profilerTrace);
 
     // Validate and extract the timestamp
     CHK_STATUS(mkvgenValidateFrame(pStreamMkvGenerator, pFrame, &pts, &dts, &streamState));
 
+    // Get the track the frame belongs to
+    CHK_STATUS(mkvgenGetTrack(pStreamMkvGenerator, pFrame, &pTrack));
+
+    // The frame data follows the header as is so it can't be adapted
+    CHK(!headerOnly || pTrack->nalsAdaptation == MKV_NALS_ADAPT_NONE, STATUS_MKV_FRAME_HEADER_NALS_ADAPTATION);
+
+    // Adjust the cluster timestamp to the beginning of the stream if no absolute clustering.
+    // NOTE: The stream start timestamp is stored when the first frame is packaged.
+    if (streamState != MKV_STATE_START_BLOCK) {
+        clusterTimecode = pts;
+        if (!pStreamMkvGenerator->absoluteTimeClusters) {
+            clusterTimecode -= pStreamMkvGenerator->streamStarted ? pStreamMkvGenerator->streamStartTimestamp : pts;
+        }
+    }
+
     // Calculate the necessary size
 
-    // Get the overhead when packaging MKV
-    overheadSize = mkvgenGetFrameOverhead(pStreamMkvGenerator, streamState);
+    // Get the max adapted size of the frame first which doesn't require scanning the frame
+    CHK_STATUS(getMaxAdaptedFrameSize(pFrame, pTrack->nalsAdaptation, &adaptedFrameSize));
 
-    // Get the adapted size of the frame and add to the overall size
-    CHK_STATUS(getAdaptedFrameSize(pFrame, pStreamMkvGenerator->nalsAdaptation, &adaptedFrameSize));
-    packagedSize = overheadSize + adaptedFrameSize;
+    // Get the overhead when packaging MKV. The block size length is based on the max adapted size
+    // so the overhead is the same whether or not the frame is scanned for the exact adapted size.
+    overheadSize = mkvgenGetFrameOverhead(pStreamMkvGenerator, streamState, clusterTimecode, adaptedFrameSize);
+    blockSizeLength = mkvgenGetSimpleBlockSizeLength(pStreamMkvGenerator, adaptedFrameSize);
+    packagedSize = overheadSize + (headerOnly ? 0 : adaptedFrameSize);
+
+    // Get the exact adapted size only if we are asked for size or the buffer can't hold the max size.
+    // Otherwise, the frame will be adapted and the actual size calculated in a single pass.
+    if (!headerOnly && (pBuffer == NULL || *pSize < packagedSize)) {
+        CHK_STATUS(getAdaptedFrameSize(pFrame, pTrack->nalsAdaptation, &adaptedFrameSize));
+        packagedSize = overheadSize + adaptedFrameSize;
+    }
 
     // Check if we are asked for size only and early return if so
     CHK(pBuffer != NULL, STATUS_SUCCESS);
@@ -288,10 +350,10 @@ STATUS mkvgenPackageFrame(PMkvGenerator pMkvGenerator, PFrame pFrame, PBYTE pBuf
                 pStreamMkvGenerator->streamStartTimestamp = pts;
             }
 
-            // Adjust the timestamp to the beginning of the stream if no absolute clustering
             CHK_STATUS(mkvgenEbmlEncodeClusterInfo(pCurrentPnt,
                                                    bufferSize,
-                                                   pStreamMkvGenerator->absoluteTimeClusters ? pts : pts - pStreamMkvGenerator->streamStartTimestamp,
+                                                   clusterTimecode,
+                                                   mkvgenGetClusterTimecodeLength(pStreamMkvGenerator, clusterTimecode),
                                                    &encodedLen));
             bufferSize -= encodedLen;
             pCurrentPnt += encodedLen;
@@ -317,20 +379,34 @@ STATUS mkvgenPackageFrame(PMkvGenerator pMkvGenerator, PFrame pFrame, PBYTE pBuf
             CHK(pts <= MAX_INT16, STATUS_MKV_LARGE_FRAME_TIMECODE);
 
             // Adjust the timestamp to the start of the cluster
-            CHK_STATUS(mkvgenEbmlEncodeSimpleBlock(pCurrentPnt,
-                                                   bufferSize,
-                                                   (INT16) pts,
-                                                   pFrame,
-                                                   adaptedFrameSize,
-                                                   pStreamMkvGenerator->nalsAdaptation,
-                                                   &encodedLen));
+            if (headerOnly) {
+                CHK_STATUS(mkvgenEbmlEncodeSimpleBlockHeader(pCurrentPnt,
+                                                             bufferSize,
+                                                             (INT16) pts,
+                                                             pFrame,
+                                                             adaptedFrameSize,
+                                                             blockSizeLength,
+                                                             pTrack,
+                                                             &encodedLen));
+            } else {
+                CHK_STATUS(mkvgenEbmlEncodeSimpleBlock(pCurrentPnt,
+                                                       bufferSize,
+                                                       (INT16) pts,
+                                                       pFrame,
+                                                       adaptedFrameSize,
+                                                       blockSizeLength,
+                                                       pTrack,
+                                                       &encodedLen));
+            }
+
             bufferSize -= encodedLen;
             pCurrentPnt += encodedLen;
             break;
     }
 
-    // Validate the size
-    CHK(packagedSize == (UINT32)(pCurrentPnt - pBuffer), STATUS_INTERNAL_ERROR);
+    // Validate the size and store the actual packaged size as the frame adaptation might have used less than the max
+    CHK(packagedSize >= (UINT32)(pCurrentPnt - pBuffer), STATUS_INTERNAL_ERROR);
+    packagedSize = (UINT32)(pCurrentPnt - pBuffer);
 
 CleanUp:
 
@@ -348,6 +424,52 @@ CleanUp:
         }
     }
 
+    PROFILER_TRACE_STOP(profilerTrace);
+
+    LEAVES();
+    return retStatus;
+}
+
+/**
+ * Gets the max packaged frame size
+ */
+STATUS mkvgenGetMaxPackagedFrameSize(PMkvGenerator pMkvGenerator, PFrame pFrame, PUINT32 pSize)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PStreamMkvGenerator pStreamMkvGenerator;
+    MKV_STREAM_STATE streamState;
+    UINT32 adaptedFrameSize;
+    UINT64 timecode, clusterTimecode = MAX_UINT64;
+    PMkvTrack pTrack;
+
+    // Check the input params
+    CHK(pSize != NULL && pMkvGenerator != NULL && pFrame != NULL, STATUS_NULL_ARG);
+
+    pStreamMkvGenerator = (PStreamMkvGenerator) pMkvGenerator;
+
+    CHK_STATUS(mkvgenGetTrack(pStreamMkvGenerator, pFrame, &pTrack));
+    CHK_STATUS(getMaxAdaptedFrameSize(pFrame, pTrack->nalsAdaptation, &adaptedFrameSize));
+
+    // Evaluate the state with the in-stream timestamps. Otherwise, the state depends on the
+    // current time and the frame will at most start a cluster if the stream has already started.
+    // The cluster timecode is known only with the in-stream timestamps.
+    if (pStreamMkvGenerator->streamTimestamps && pFrame->presentationTs <= MAX_TIMESTAMP_VALUE) {
+        timecode = TIMESTAMP_TO_MKV_TIMECODE(pFrame->presentationTs, pStreamMkvGenerator->timecodeScale);
+        streamState = mkvgenGetStreamState(pStreamMkvGenerator, pFrame->flags, timecode);
+        if (!pStreamMkvGenerator->absoluteTimeClusters) {
+            timecode -= pStreamMkvGenerator->streamStarted ? MIN(pStreamMkvGenerator->streamStartTimestamp, timecode) : timecode;
+        }
+
+        clusterTimecode = timecode;
+    } else {
+        streamState = pStreamMkvGenerator->streamStarted ? MKV_STATE_START_CLUSTER : MKV_STATE_START_STREAM;
+    }
+
+    *pSize = adaptedFrameSize + mkvgenGetFrameOverhead(pStreamMkvGenerator, streamState, clusterTimecode, adaptedFrameSize);
+
+CleanUp:
+
     LEAVES();
     return retStatus;
 }
@@ -434,7 +556,8 @@ STATUS mkvgenGetMkvOverheadSize(PMkvGenerator pMkvGenerator, MKV_STREAM_STATE mk
 
     pStreamMkvGenerator = (PStreamMkvGenerator) pMkvGenerator;
 
-    *pOverhead = mkvgenGetFrameOverhead(pStreamMkvGenerator, mkvStreamState);
+    // Without the frame the overhead is the upper bound
+    *pOverhead = mkvgenGetFrameOverhead(pStreamMkvGenerator, mkvStreamState, MAX_UINT64, MAX_UINT32);
 
 CleanUp:
 
@@ -547,40 +670,81 @@ MKV_STREAM_STATE mkvgenGetStreamState(PStreamMkvGenerator pStreamMkvGenerator, F
 /**
  * Gets a packaged size of a frame
  */
-UINT32 mkvgenGetFrameOverhead(PStreamMkvGenerator pStreamMkvGenerator, MKV_STREAM_STATE streamState)
+UINT32 mkvgenGetFrameOverhead(PStreamMkvGenerator pStreamMkvGenerator, MKV_STREAM_STATE streamState,
+                              UINT64 clusterTimecode, UINT64 maxAdaptedFrameSize)
 {
-    UINT32 overhead = 0;
+    UINT32 overhead = 0, blockOverhead, clusterInfoSize;
+
+    // Account for the lengths of the block size and the cluster timecode which might be shorter than in the static bits
+    blockOverhead = MKV_SIMPLE_BLOCK_OVERHEAD - MKV_SIMPLE_BLOCK_SIZE_LENGTH +
+                    mkvgenGetSimpleBlockSizeLength(pStreamMkvGenerator, maxAdaptedFrameSize);
+    clusterInfoSize = MKV_CLUSTER_INFO_BITS_SIZE - MKV_CLUSTER_TIMECODE_LENGTH +
+                      mkvgenGetClusterTimecodeLength(pStreamMkvGenerator, clusterTimecode);
 
     switch(streamState) {
         case MKV_STATE_START_STREAM:
-            overhead = MKV_HEADER_OVERHEAD + mkvgenGetHeaderOverhead(pStreamMkvGenerator);
+            overhead = MKV_HEADER_SIZE + mkvgenGetHeaderOverhead(pStreamMkvGenerator) + clusterInfoSize + blockOverhead;
             break;
         case MKV_STATE_START_CLUSTER:
-            overhead = MKV_CLUSTER_OVERHEAD;
+            overhead = clusterInfoSize + blockOverhead;
             break;
         case MKV_STATE_START_BLOCK:
-            overhead = MKV_SIMPLE_BLOCK_OVERHEAD;
+            overhead = blockOverhead;
             break;
     }
 
     return overhead;
 }
 
+UINT32 mkvgenGetClusterTimecodeLength(PStreamMkvGenerator pStreamMkvGenerator, UINT64 clusterTimecode)
+{
+    return pStreamMkvGenerator->compactEbmlSizes ? mkvgenGetByteCount(clusterTimecode) : MKV_CLUSTER_TIMECODE_LENGTH;
+}
+
+UINT32 mkvgenGetSimpleBlockSizeLength(PStreamMkvGenerator pStreamMkvGenerator, UINT64 maxAdaptedFrameSize)
+{
+    UINT32 length;
+    UINT64 size = maxAdaptedFrameSize + MKV_SIMPLE_BLOCK_PAYLOAD_HEADER_SIZE;
+
+    if (!pStreamMkvGenerator->compactEbmlSizes) {
+        return MKV_SIMPLE_BLOCK_SIZE_LENGTH;
+    }
+
+    // The all-ones value of each length is reserved for the unknown size
+    for (length = 1; length < MKV_SIMPLE_BLOCK_SIZE_LENGTH && size >= (1ULL << (7 * length)) - 1; length++);
+
+    return length;
+}
+
 UINT32 mkvgenGetHeaderOverhead(PStreamMkvGenerator pStreamMkvGenerator)
+{
+    UINT32 i, overhead = 0;
+
+    for (i = 0; i < pStreamMkvGenerator->trackCount; i++) {
+        overhead += mkvgenGetTrackEntryOverhead(&pStreamMkvGenerator->tracks[i]);
+    }
+
+    // Account for the entries of the additional tracks
+    overhead += (pStreamMkvGenerator->trackCount - 1) * MKV_TRACK_INFO_BITS_SIZE;
+
+    return overhead;
+}
+
+UINT32 mkvgenGetTrackEntryOverhead(PMkvTrack pTrack)
 {
     UINT32 encodedCpdSize = 0, encodedVideoConfig = 0;
 
-    if (pStreamMkvGenerator->codecPrivateDataSize != 0) {
-        mkvgenEbmlEncodeNumber(pStreamMkvGenerator->codecPrivateDataSize, NULL, 0, &encodedCpdSize);
+    if (pTrack->codecPrivateDataSize != 0) {
+        mkvgenEbmlEncodeNumber(pTrack->codecPrivateDataSize, NULL, 0, &encodedCpdSize);
 
         // Account for the element itself
         encodedCpdSize += MKV_CODEC_PRIVATE_DATA_ELEM_SIZE;
 
         // Account for the actual bit size too
-        encodedCpdSize += pStreamMkvGenerator->codecPrivateDataSize;
+        encodedCpdSize += pTrack->codecPrivateDataSize;
     }
 
-    if (GENERATE_VIDEO_CONFIG(pStreamMkvGenerator)) {
+    if (GENERATE_VIDEO_CONFIG(pTrack)) {
         encodedVideoConfig = MKV_TRACK_VIDEO_BITS_SIZE;
     }
 
@@ -606,6 +770,103 @@ BYTE mkvgenGetTrackTypeFromContentType(PCHAR contentType)
     return MKV_DEFAULT_TRACK_TYPE;
 }
 
+/**
+ * Stores the codec private data of the track and extracts the video configuration from it
+ */
+STATUS mkvgenSetTrackCodecPrivateData(PStreamMkvGenerator pMkvGenerator, PMkvTrack pTrack, PTrackInfo pTrackInfo)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PCHAR contentType;
+
+    CHK(pMkvGenerator != NULL && pTrack != NULL && pTrackInfo != NULL, STATUS_NULL_ARG);
+
+    // Nothing to do if no CPD is present
+    CHK(pTrackInfo->codecPrivateData != NULL && pTrackInfo->codecPrivateDataSize != 0, retStatus);
+
+    contentType = pTrackInfo->contentType;
+    if (pMkvGenerator->adaptCpdNals) {
+        if (0 == STRCMP(contentType, MKV_H264_CONTENT_TYPE)) {
+            CHK_STATUS(adaptH264CpdNalsFromAnnexBToAvcc(pTrackInfo->codecPrivateData, pTrackInfo->codecPrivateDataSize,
+                                                        pTrack->codecPrivateData,
+                                                        &pTrack->codecPrivateDataSize));
+        } else if (0 == STRCMP(contentType, MKV_H265_CONTENT_TYPE)) {
+            CHK_STATUS(adaptH265CpdNalsFromAnnexBToHvcc(pTrackInfo->codecPrivateData, pTrackInfo->codecPrivateDataSize,
+                                                        pTrack->codecPrivateData,
+                                                        &pTrack->codecPrivateDataSize));
+        } else {
+            MEMCPY(pTrack->codecPrivateData, pTrackInfo->codecPrivateData, pTrack->codecPrivateDataSize);
+        }
+    } else {
+        MEMCPY(pTrack->codecPrivateData, pTrackInfo->codecPrivateData, pTrack->codecPrivateDataSize);
+    }
+
+    // Check whether we need to generate a video config element for
+    // H264, H265 or M-JJPG content type if the CPD is present
+    // Check and process the H264 then H265 and later M-JPG content type
+    if (0 == STRCMP(contentType, MKV_H264_CONTENT_TYPE)) {
+        retStatus = getVideoWidthAndHeightFromH264Sps(pTrack->codecPrivateData,
+                                                      pTrack->codecPrivateDataSize,
+                                                      &pTrack->videoWidth,
+                                                      &pTrack->videoHeight);
+
+    } else if (0 == STRCMP(contentType, MKV_H265_CONTENT_TYPE)) {
+        retStatus = getVideoWidthAndHeightFromH265Sps(pTrack->codecPrivateData,
+                                                      pTrack->codecPrivateDataSize,
+                                                      &pTrack->videoWidth,
+                                                      &pTrack->videoHeight);
+
+    } else if ((0 == STRCMP(contentType, MKV_X_MKV_CONTENT_TYPE)) &&
+            (0 == STRCMP(pTrackInfo->codecId, MKV_FOURCC_CODEC_ID))) {
+        // For M-JPG we have content type as video/x-matroska and the codec
+        // type set as V_MS/VFW/FOURCC
+        retStatus = getVideoWidthAndHeightFromBih(pTrack->codecPrivateData,
+                                                  pTrack->codecPrivateDataSize,
+                                                  &pTrack->videoWidth,
+                                                  &pTrack->videoHeight);
+    }
+
+    if (STATUS_FAILED(retStatus)) {
+        // This might not be yet fatal so warn and reset the status
+        DLOGW("Failed extracting video configuration from SPS with %08x.", retStatus);
+
+        retStatus = STATUS_SUCCESS;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * Gets the track the frame belongs to
+ */
+STATUS mkvgenGetTrack(PStreamMkvGenerator pStreamMkvGenerator, PFrame pFrame, PMkvTrack* ppTrack)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i;
+
+    CHK(pStreamMkvGenerator != NULL && pFrame != NULL && ppTrack != NULL, STATUS_NULL_ARG);
+
+    // The track id is ignored for the single track streams
+    if (pStreamMkvGenerator->trackCount == 1) {
+        *ppTrack = &pStreamMkvGenerator->tracks[0];
+        CHK(FALSE, retStatus);
+    }
+
+    for (i = 0; i < pStreamMkvGenerator->trackCount; i++) {
+        if (pStreamMkvGenerator->tracks[i].trackId == pFrame->trackId) {
+            *ppTrack = &pStreamMkvGenerator->tracks[i];
+            CHK(FALSE, retStatus);
+        }
+    }
+
+    CHK(FALSE, STATUS_MKV_TRACK_INFO_NOT_FOUND);
+
+CleanUp:
+
+    return retStatus;
+}
+
 /**
  * EBML encodes a number
  */
@@ -668,6 +929,34 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * EBML encodes a number using the given length
+ */
+STATUS mkvgenEbmlEncodeNumberWithLength(UINT64 number, UINT32 length, PBYTE pBuffer, UINT32 bufferSize)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT64 encoded;
+    UINT32 i;
+
+    CHK(pBuffer != NULL, STATUS_NULL_ARG);
+    CHK(length != 0 && length <= 8, STATUS_INVALID_ARG);
+
+    // The all-ones value is reserved for the unknown size
+    CHK(number < (1ULL << (7 * length)) - 1, STATUS_MKV_NUMBER_TOO_BIG);
+    CHK(bufferSize >= length, STATUS_NOT_ENOUGH_MEMORY);
+
+    // Set the length marker bit
+    encoded = (1ULL << (7 * length)) | number;
+    for (i = length; i > 0; i--) {
+        *(pBuffer + i - 1) = (BYTE) encoded;
+        encoded >>= 8;
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
 /**
  * Stores a big-endian number
  */
@@ -800,38 +1089,68 @@ CleanUp:
 STATUS mkvgenEbmlEncodeTrackInfo(PBYTE pBuffer, UINT32 bufferSize, PStreamMkvGenerator pMkvGenerator, PUINT32 pEncodedLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 i, encodedCpdLen = 0, cpdSize = 0, encodedLen = 0, encodedVideoConfig = 0, cpdOffset, videoOffset;
+    UINT32 i, size, encodedLen = 0;
 
     CHK(pEncodedLen != NULL && pMkvGenerator != NULL, STATUS_NULL_ARG);
 
-    if (pMkvGenerator->codecPrivateDataSize != 0) {
-        mkvgenEbmlEncodeNumber(pMkvGenerator->codecPrivateDataSize, NULL, 0, &encodedCpdLen);
+    // Set the size first
+    size = MKV_TRACKS_HEADER_BITS_SIZE + MKV_TRACK_INFO_BITS_SIZE + mkvgenGetHeaderOverhead(pMkvGenerator);
+    *pEncodedLen = size;
 
-        // Account for the element itself
-        encodedCpdLen += MKV_CODEC_PRIVATE_DATA_ELEM_SIZE;
+    // Quick return if we just need to calculate the size
+    CHK(pBuffer != NULL, retStatus);
 
-        // Account for the actual bit size too
-        encodedCpdLen += pMkvGenerator->codecPrivateDataSize;
+    // Check the buffer size
+    CHK(bufferSize >= size, STATUS_NOT_ENOUGH_MEMORY);
+    MEMCPY(pBuffer, MKV_TRACKS_HEADER_BITS, MKV_TRACKS_HEADER_BITS_SIZE);
+    size = MKV_TRACKS_HEADER_BITS_SIZE;
+
+    // Encode the track entries following the header
+    for (i = 0; i < pMkvGenerator->trackCount; i++) {
+        CHK_STATUS(mkvgenEbmlEncodeTrackEntry(pBuffer + size, bufferSize - size, &pMkvGenerator->tracks[i], &encodedLen));
+        size += encodedLen;
     }
 
-    if (GENERATE_VIDEO_CONFIG(pMkvGenerator)) {
+    // Important! Need to fix-up the overall track header element size
+    // Encode and fix-up the size - encode 4 bytes
+    encodedLen = 0x10000000 | (UINT32) (size - MKV_TRACK_HEADER_SIZE_OFFSET - 4);
+    putInt32((PINT32)(pBuffer + MKV_TRACK_HEADER_SIZE_OFFSET), encodedLen);
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * EBML encodes a track entry
+ */
+STATUS mkvgenEbmlEncodeTrackEntry(PBYTE pBuffer, UINT32 bufferSize, PMkvTrack pTrack, PUINT32 pEncodedLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, encodedCpdLen = 0, cpdSize = 0, encodedLen = 0, encodedVideoConfig = 0, cpdOffset, videoOffset, size;
+
+    CHK(pEncodedLen != NULL && pTrack != NULL, STATUS_NULL_ARG);
+
+    if (GENERATE_VIDEO_CONFIG(pTrack)) {
         encodedVideoConfig = MKV_TRACK_VIDEO_BITS_SIZE;
     }
 
     // Set the size first
-    *pEncodedLen = MKV_TRACK_INFO_BITS_SIZE + encodedCpdLen + encodedVideoConfig;
+    size = MKV_TRACK_INFO_BITS_SIZE + mkvgenGetTrackEntryOverhead(pTrack);
+    *pEncodedLen = size;
 
     // Quick return if we just need to calculate the size
     CHK(pBuffer != NULL, retStatus);
 
     // Check the buffer size
-    CHK(bufferSize >= MKV_TRACK_INFO_BITS_SIZE + encodedCpdLen + encodedVideoConfig, STATUS_NOT_ENOUGH_MEMORY);
+    CHK(bufferSize >= size, STATUS_NOT_ENOUGH_MEMORY);
     MEMCPY(pBuffer, MKV_TRACK_INFO_BITS, MKV_TRACK_INFO_BITS_SIZE);
 
-    // Fix-up the track type, name and codec id
-    *(pBuffer + MKV_TRACK_TYPE_OFFSET) = pMkvGenerator->trackType;
-    MEMCPY(pBuffer + MKV_CODEC_ID_OFFSET, pMkvGenerator->codecId, MKV_MAX_CODEC_ID_LEN);
-    MEMCPY(pBuffer + MKV_TRACK_NAME_OFFSET, pMkvGenerator->trackName, MKV_MAX_TRACK_NAME_LEN);
+    // Fix-up the track number, type, name and codec id
+    *(pBuffer + MKV_TRACK_NUMBER_OFFSET) = (BYTE) pTrack->trackId;
+    *(pBuffer + MKV_TRACK_TYPE_OFFSET) = pTrack->trackType;
+    MEMCPY(pBuffer + MKV_CODEC_ID_OFFSET, pTrack->codecId, MKV_MAX_CODEC_ID_LEN);
+    MEMCPY(pBuffer + MKV_TRACK_NAME_OFFSET, pTrack->trackName, MKV_MAX_TRACK_NAME_LEN);
 
     // Fix up the track UID
     for (i = 0; i < MKV_TRACK_ID_BYTE_SIZE; i++) {
@@ -839,27 +1158,19 @@ STATUS mkvgenEbmlEncodeTrackInfo(PBYTE pBuffer, UINT32 bufferSize, PStreamMkvGen
     }
 
     // Append the video config if any
-    if (GENERATE_VIDEO_CONFIG(pMkvGenerator)) {
+    if (GENERATE_VIDEO_CONFIG(pTrack)) {
         // Offset of the video right after the main structure
         videoOffset = MKV_TRACK_INFO_BITS_SIZE;
         // Copy the element first
         MEMCPY(pBuffer + videoOffset, MKV_TRACK_VIDEO_BITS, MKV_TRACK_VIDEO_BITS_SIZE);
 
         // Fix-up the width and height
-        putInt16((PINT16)(pBuffer + videoOffset + MKV_TRACK_VIDEO_WIDTH_OFFSET), pMkvGenerator->videoWidth);
-        putInt16((PINT16)(pBuffer + videoOffset + MKV_TRACK_VIDEO_HEIGHT_OFFSET), pMkvGenerator->videoHeight);
-
-        // Important! Need to fix-up the overall track header element size and the track entry element size
-        // Encode and fix-up the size - encode 4 bytes
-        encodedLen = 0x10000000 | (UINT32) (videoOffset + MKV_TRACK_VIDEO_BITS_SIZE - MKV_TRACK_HEADER_SIZE_OFFSET - 4);
-        putInt32((PINT32)(pBuffer + MKV_TRACK_HEADER_SIZE_OFFSET), encodedLen);
-
-        encodedLen = 0x10000000 | (UINT32) (videoOffset + MKV_TRACK_VIDEO_BITS_SIZE - MKV_TRACK_ENTRY_SIZE_OFFSET - 4);
-        putInt32((PINT32)(pBuffer + MKV_TRACK_ENTRY_SIZE_OFFSET), encodedLen);
+        putInt16((PINT16)(pBuffer + videoOffset + MKV_TRACK_VIDEO_WIDTH_OFFSET), pTrack->videoWidth);
+        putInt16((PINT16)(pBuffer + videoOffset + MKV_TRACK_VIDEO_HEIGHT_OFFSET), pTrack->videoHeight);
     }
 
     // Append the codec private data if any
-    if (pMkvGenerator->codecPrivateDataSize != 0 && pMkvGenerator->codecPrivateData != NULL) {
+    if (pTrack->codecPrivateDataSize != 0 && pTrack->codecPrivateData != NULL) {
         // Offset of the CPD right after the main structure and the video config if any
         cpdOffset = MKV_CODEC_PRIVATE_DATA_OFFSET + encodedVideoConfig;
         // Copy the element first
@@ -867,27 +1178,23 @@ STATUS mkvgenEbmlEncodeTrackInfo(PBYTE pBuffer, UINT32 bufferSize, PStreamMkvGen
         cpdSize = MKV_CODEC_PRIVATE_DATA_ELEM_SIZE;
 
         // Encode the CPD size
-        CHK_STATUS(mkvgenEbmlEncodeNumber(pMkvGenerator->codecPrivateDataSize,
+        CHK_STATUS(mkvgenEbmlEncodeNumber(pTrack->codecPrivateDataSize,
                                           pBuffer + cpdOffset + cpdSize,
                                           bufferSize - cpdOffset - cpdSize,
                                           &encodedCpdLen));
         cpdSize += encodedCpdLen;
 
-        CHK(cpdOffset + cpdSize + pMkvGenerator->codecPrivateDataSize <= bufferSize, STATUS_NOT_ENOUGH_MEMORY);
+        CHK(cpdOffset + cpdSize + pTrack->codecPrivateDataSize <= bufferSize, STATUS_NOT_ENOUGH_MEMORY);
 
         // Copy the actual CPD bits
-        MEMCPY(pBuffer + cpdOffset + cpdSize, pMkvGenerator->codecPrivateData, pMkvGenerator->codecPrivateDataSize);
-        cpdSize += pMkvGenerator->codecPrivateDataSize;
-
-        // Important! Need to fix-up the overall track header element size and the track entry element size
-        // Encode and fix-up the size - encode 4 bytes
-        encodedLen = 0x10000000 | (UINT32) (cpdSize + cpdOffset - MKV_TRACK_HEADER_SIZE_OFFSET - 4);
-        putInt32((PINT32)(pBuffer + MKV_TRACK_HEADER_SIZE_OFFSET), encodedLen);
-
-        encodedLen = 0x10000000 | (UINT32) (cpdSize + cpdOffset - MKV_TRACK_ENTRY_SIZE_OFFSET - 4);
-        putInt32((PINT32)(pBuffer + MKV_TRACK_ENTRY_SIZE_OFFSET), encodedLen);
+        MEMCPY(pBuffer + cpdOffset + cpdSize, pTrack->codecPrivateData, pTrack->codecPrivateDataSize);
     }
 
+    // Important! Need to fix-up the track entry element size
+    // Encode and fix-up the size - encode 4 bytes
+    encodedLen = 0x10000000 | (UINT32) (size - MKV_TRACK_ENTRY_SIZE_OFFSET - 4);
+    putInt32((PINT32)(pBuffer + MKV_TRACK_ENTRY_SIZE_OFFSET), encodedLen);
+
 CleanUp:
 
     return retStatus;
@@ -896,24 +1203,38 @@ CleanUp:
 /**
  * EBML encodes a cluster
  */
-STATUS mkvgenEbmlEncodeClusterInfo(PBYTE pBuffer, UINT32 bufferSize, UINT64 timestamp, PUINT32 pEncodedLen)
+STATUS mkvgenEbmlEncodeClusterInfo(PBYTE pBuffer, UINT32 bufferSize, UINT64 timestamp, UINT32 timecodeLength, PUINT32 pEncodedLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
+    UINT32 size, encodedLen;
 
     CHK(pEncodedLen != NULL, STATUS_NULL_ARG);
+    CHK(timecodeLength != 0 && timecodeLength <= MKV_CLUSTER_TIMECODE_LENGTH, STATUS_INVALID_ARG);
 
     // Set the size first
-    *pEncodedLen = MKV_CLUSTER_INFO_BITS_SIZE;
+    size = MKV_CLUSTER_INFO_BITS_SIZE - MKV_CLUSTER_TIMECODE_LENGTH + timecodeLength;
+    *pEncodedLen = size;
 
     // Quick return if we just need to calculate the size
     CHK(pBuffer != NULL, retStatus);
 
     // Check the buffer size
-    CHK(bufferSize >= MKV_CLUSTER_INFO_BITS_SIZE, STATUS_NOT_ENOUGH_MEMORY);
-    MEMCPY(pBuffer, MKV_CLUSTER_INFO_BITS, MKV_CLUSTER_INFO_BITS_SIZE);
+    CHK(bufferSize >= size, STATUS_NOT_ENOUGH_MEMORY);
 
-    // Fix-up the cluster timecode
-    putInt64((PINT64)(pBuffer + MKV_CLUSTER_TIMECODE_OFFSET), timestamp);
+    if (timecodeLength == MKV_CLUSTER_TIMECODE_LENGTH) {
+        MEMCPY(pBuffer, MKV_CLUSTER_INFO_BITS, MKV_CLUSTER_INFO_BITS_SIZE);
+
+        // Fix-up the cluster timecode
+        putInt64((PINT64)(pBuffer + MKV_CLUSTER_TIMECODE_OFFSET), timestamp);
+    } else {
+        // Copy the bits around the timecode and store the timecode in the minimal length
+        MEMCPY(pBuffer, MKV_CLUSTER_INFO_BITS, MKV_CLUSTER_TIMECODE_OFFSET);
+        *(pBuffer + MKV_CLUSTER_TIMECODE_LENGTH_OFFSET) = (BYTE) (0x80 | timecodeLength);
+        CHK_STATUS(mkvgenBigEndianNumber(timestamp, pBuffer + MKV_CLUSTER_TIMECODE_OFFSET, timecodeLength, &encodedLen));
+        MEMCPY(pBuffer + MKV_CLUSTER_TIMECODE_OFFSET + timecodeLength,
+               MKV_CLUSTER_INFO_BITS + MKV_CLUSTER_TIMECODE_OFFSET + MKV_CLUSTER_TIMECODE_LENGTH,
+               MKV_CLUSTER_INFO_BITS_SIZE - MKV_CLUSTER_TIMECODE_OFFSET - MKV_CLUSTER_TIMECODE_LENGTH);
+    }
 
 CleanUp:
 
@@ -923,17 +1244,19 @@ CleanUp:
 /**
  * EBML encodes a simple block
  */
-STATUS mkvgenEbmlEncodeSimpleBlock(PBYTE pBuffer, UINT32 bufferSize, INT16 timestamp, PFrame pFrame, UINT32 adaptedFrameSize, MKV_NALS_ADAPTATION nalsAdaptation, PUINT32 pEncodedLen)
+STATUS mkvgenEbmlEncodeSimpleBlock(PBYTE pBuffer, UINT32 bufferSize, INT16 timestamp, PFrame pFrame, UINT32 adaptedFrameSize,
+                                   UINT32 sizeLength, PMkvTrack pTrack, PUINT32 pEncodedLen)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    UINT64 encodedLength;
-    BYTE flags;
-    UINT32 size;
+    UINT32 size, headerSize;
 
-    CHK(pEncodedLen != NULL && pFrame != NULL, STATUS_NULL_ARG);
+    CHK(pEncodedLen != NULL && pFrame != NULL && pTrack != NULL, STATUS_NULL_ARG);
+    CHK(sizeLength != 0 && sizeLength <= MKV_SIMPLE_BLOCK_SIZE_LENGTH, STATUS_INVALID_ARG);
 
-    // Set the size first
-    size = MKV_SIMPLE_BLOCK_BITS_SIZE + adaptedFrameSize;
+    // Set the size first.
+    // NOTE: For Annex-B adaptation the adapted size might be an upper bound and will be fixed up after the adaptation
+    headerSize = MKV_SIMPLE_BLOCK_BITS_SIZE - MKV_SIMPLE_BLOCK_SIZE_LENGTH + sizeLength;
+    size = headerSize + adaptedFrameSize;
     *pEncodedLen = size;
 
     // Quick return if we just need to calculate the size
@@ -941,21 +1264,20 @@ STATUS mkvgenEbmlEncodeSimpleBlock(PBYTE pBuffer, UINT32 bufferSize, INT16 times
 
     // Check the buffer size
     CHK(bufferSize >= size, STATUS_NOT_ENOUGH_MEMORY);
-    // Copy the header and the frame data
-    MEMCPY(pBuffer, MKV_SIMPLE_BLOCK_BITS, MKV_SIMPLE_BLOCK_BITS_SIZE);
 
-    switch (nalsAdaptation) {
+    // Adapt the frame data first as the header encodes the adapted size
+    switch (pTrack->nalsAdaptation) {
         case MKV_NALS_ADAPT_NONE:
             // Just copy the bits
-            MEMCPY(pBuffer + MKV_SIMPLE_BLOCK_BITS_SIZE, pFrame->frameData, adaptedFrameSize);
+            MEMCPY(pBuffer + headerSize, pFrame->frameData, adaptedFrameSize);
             break;
 
         case MKV_NALS_ADAPT_AVCC:
             // Copy the bits first
-            MEMCPY(pBuffer + MKV_SIMPLE_BLOCK_BITS_SIZE, pFrame->frameData, adaptedFrameSize);
+            MEMCPY(pBuffer + headerSize, pFrame->frameData, adaptedFrameSize);
 
             // Adapt from Avcc to Annex-B nals
-            CHK_STATUS(adaptFrameNalsFromAvccToAnnexB(pBuffer + MKV_SIMPLE_BLOCK_BITS_SIZE,
+            CHK_STATUS(adaptFrameNalsFromAvccToAnnexB(pBuffer + headerSize,
                                                       adaptedFrameSize));
             break;
 
@@ -964,16 +1286,55 @@ STATUS mkvgenEbmlEncodeSimpleBlock(PBYTE pBuffer, UINT32 bufferSize, INT16 times
             CHK_STATUS(adaptFrameNalsFromAnnexBToAvcc(pFrame->frameData,
                                                       pFrame->size,
                                                       FALSE,
-                                                      pBuffer + MKV_SIMPLE_BLOCK_BITS_SIZE,
+                                                      pBuffer + headerSize,
                                                       &adaptedFrameSize));
     }
 
-    // Encode and fix-up the size - encode 8 bytes
-    encodedLength = 0x100000000000000ULL | (UINT64) (adaptedFrameSize + MKV_SIMPLE_BLOCK_PAYLOAD_HEADER_SIZE);
-    putInt64((PINT64)(pBuffer + MKV_SIMPLE_BLOCK_SIZE_OFFSET), encodedLength);
+    // Encode the header with the actual size.
+    // NOTE: The length is based on the max adapted size so the actual size always fits
+    CHK_STATUS(mkvgenEbmlEncodeSimpleBlockHeader(pBuffer, headerSize, timestamp, pFrame, adaptedFrameSize, sizeLength, pTrack, &size));
+
+    // Set the actual encoded size
+    *pEncodedLen = size + adaptedFrameSize;
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * EBML encodes a simple block header
+ */
+STATUS mkvgenEbmlEncodeSimpleBlockHeader(PBYTE pBuffer, UINT32 bufferSize, INT16 timestamp, PFrame pFrame, UINT32 frameSize,
+                                         UINT32 sizeLength, PMkvTrack pTrack, PUINT32 pEncodedLen)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    BYTE flags;
+    UINT32 headerSize;
+    PBYTE pPayloadHeader;
+
+    CHK(pBuffer != NULL && pEncodedLen != NULL && pFrame != NULL && pTrack != NULL, STATUS_NULL_ARG);
+    CHK(sizeLength != 0 && sizeLength <= MKV_SIMPLE_BLOCK_SIZE_LENGTH, STATUS_INVALID_ARG);
+
+    headerSize = MKV_SIMPLE_BLOCK_BITS_SIZE - MKV_SIMPLE_BLOCK_SIZE_LENGTH + sizeLength;
+    CHK(bufferSize >= headerSize, STATUS_NOT_ENOUGH_MEMORY);
+
+    // Copy the header bits around the element size
+    pPayloadHeader = pBuffer + MKV_SIMPLE_BLOCK_SIZE_OFFSET + sizeLength;
+    MEMCPY(pBuffer, MKV_SIMPLE_BLOCK_BITS, MKV_SIMPLE_BLOCK_SIZE_OFFSET);
+    MEMCPY(pPayloadHeader, MKV_SIMPLE_BLOCK_BITS + MKV_SIMPLE_BLOCK_PAYLOAD_HEADER_OFFSET, MKV_SIMPLE_BLOCK_PAYLOAD_HEADER_SIZE);
+
+    // Encode the size
+    CHK_STATUS(mkvgenEbmlEncodeNumberWithLength(frameSize + MKV_SIMPLE_BLOCK_PAYLOAD_HEADER_SIZE,
+                                                sizeLength,
+                                                pBuffer + MKV_SIMPLE_BLOCK_SIZE_OFFSET,
+                                                sizeLength));
+
+    // Fix up the track number - EBML encoded in a single byte
+    *(pPayloadHeader + MKV_SIMPLE_BLOCK_TRACK_NUMBER_OFFSET) = (BYTE) (0x80 | pTrack->trackId);
 
     // Fix up the timecode
-    putInt16((PINT16)(pBuffer + MKV_SIMPLE_BLOCK_TIMECODE_OFFSET), timestamp);
+    putInt16((PINT16)(pPayloadHeader + MKV_SIMPLE_BLOCK_TIMECODE_OFFSET), timestamp);
 
     // Fix up the flags
     flags = MKV_SIMPLE_BLOCK_FLAGS_NONE;
@@ -989,7 +1350,9 @@ STATUS mkvgenEbmlEncodeSimpleBlock(PBYTE pBuffer, UINT32 bufferSize, INT16 times
         flags |= MKV_SIMPLE_BLOCK_INVISIBLE_FLAG;
     }
 
-    *(pBuffer + MKV_SIMPLE_BLOCK_FLAGS_OFFSET) = flags;
+    *(pPayloadHeader + MKV_SIMPLE_BLOCK_FLAGS_OFFSET) = flags;
+
+    *pEncodedLen = headerSize;
 
 CleanUp:
 
@@ -1029,6 +1392,34 @@ CleanUp:
     return retStatus;
 }
 
+STATUS getMaxAdaptedFrameSize(PFrame pFrame, MKV_NALS_ADAPTATION nalsAdaptation, PUINT32 pAdaptedFrameSize)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 adaptedFrameSize = 0;
+
+    CHK(pFrame != NULL && pAdaptedFrameSize != NULL, STATUS_NULL_ARG);
+
+    switch (nalsAdaptation) {
+        case MKV_NALS_ADAPT_NONE:
+            // Explicit call-through as no bloating occurs
+        case MKV_NALS_ADAPT_AVCC:
+            // No bloat converting from AVCC to Annex-B format NALs
+            adaptedFrameSize = pFrame->size;
+            break;
+        case MKV_NALS_ADAPT_ANNEXB:
+            // Worst case bloat without scanning the frame
+            adaptedFrameSize = MAX_ANNEXB_TO_AVCC_ADAPTED_SIZE(pFrame->size);
+            break;
+    }
+
+    // Set the return value
+    *pAdaptedFrameSize = adaptedFrameSize;
+
+CleanUp:
+
+    return retStatus;
+}
+
 /**
  * Returns the number of bytes required to encode
  */
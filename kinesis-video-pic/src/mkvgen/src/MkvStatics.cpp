@@ -37,12 +37,16 @@ BYTE gMkvSegmentInfoBits[] = {
 };
 UINT32 gMkvSegmentInfoBitsSize = SIZEOF(gMkvSegmentInfoBits);
 
-BYTE gMkvTrackInfoBits[] = {
+BYTE gMkvTracksHeaderBits[] = {
         0x16, 0x54, 0xAE, 0x6B, // Tracks
-        0x10, 0x00, 0x00, 0x5B, // Size of the header - 4 bytes wide to accommodate max codec private data
+        0x10, 0x00, 0x00, 0x5B, // Size of the header - 4 bytes wide to accommodate max codec private data of all the tracks
+};
+UINT32 gMkvTracksHeaderBitsSize = SIZEOF(gMkvTracksHeaderBits);
+
+BYTE gMkvTrackInfoBits[] = {
         0xAE, // Track entry
         0x10, 0x00, 0x00, 0x56, // Size of the track - 4 bytes wide to accommodate max codec private data
-        0xD7, 0x81, 0x01, // Track number
+        0xD7, 0x81, 0x01, // Track number - placeholder
         0x73, 0xC5, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // Track ID - placeholder for 8 bytes
         0x83, 0x81, 0x01, // Track type
         0x53, 0x6E,
@@ -84,7 +88,7 @@ UINT32 gMkvClusterInfoBitsSize = SIZEOF(gMkvClusterInfoBits);
 BYTE gMkvSimpleBlockBits[] = {
         0xA3, // SimpleBlock
         0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Size of the block - needs to be fixed up
-        0x81, // Track number
+        0x81, // Track number - needs to be fixed up
         0x00, 0x00, // Timecode - relative to cluster timecode - INT16 - needs to be fixed up
         0x00, // Flags - needs to be fixed up
         // Frame data follows
@@ -5,6 +5,117 @@
 #define LOG_CLASS "NalAdapter"
 #include "Include_i.h"
 
+#if defined(NAL_ADAPTER_SSE2_SCANNER)
+#include <immintrin.h>
+#elif defined(NAL_ADAPTER_NEON_SCANNER)
+#include <arm_neon.h>
+#endif
+
+/**
+ * Scalar reference zero byte scanner
+ */
+PBYTE findZeroByteScalar(PBYTE pStart, PBYTE pEnd)
+{
+    while (pStart < pEnd && *pStart != 0x00) {
+        pStart++;
+    }
+
+    return pStart;
+}
+
+#if defined(NAL_ADAPTER_SSE2_SCANNER)
+/**
+ * SSE2 zero byte scanner - skips 16 bytes at a time
+ */
+PBYTE findZeroByteSse2(PBYTE pStart, PBYTE pEnd)
+{
+    __m128i zero = _mm_setzero_si128();
+    UINT32 mask;
+
+    while (pEnd - pStart >= 16) {
+        mask = (UINT32) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) pStart), zero));
+        if (mask != 0) {
+            return pStart + __builtin_ctz(mask);
+        }
+
+        pStart += 16;
+    }
+
+    return findZeroByteScalar(pStart, pEnd);
+}
+
+/**
+ * AVX2 zero byte scanner - skips 32 bytes at a time.
+ *
+ * NOTE: Compiled for AVX2 target only and should be called only if the CPU supports it
+ */
+__attribute__((target("avx2"))) PBYTE findZeroByteAvx2(PBYTE pStart, PBYTE pEnd)
+{
+    __m256i zero = _mm256_setzero_si256();
+    UINT32 mask;
+
+    while (pEnd - pStart >= 32) {
+        mask = (UINT32) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) pStart), zero));
+        if (mask != 0) {
+            return pStart + __builtin_ctz(mask);
+        }
+
+        pStart += 32;
+    }
+
+    return findZeroByteSse2(pStart, pEnd);
+}
+#endif
+
+#if defined(NAL_ADAPTER_NEON_SCANNER)
+/**
+ * NEON zero byte scanner - skips 16 bytes at a time
+ */
+PBYTE findZeroByteNeon(PBYTE pStart, PBYTE pEnd)
+{
+    uint8x16_t zero = vdupq_n_u8(0);
+
+    while (pEnd - pStart >= 16) {
+        if (vmaxvq_u8(vceqq_u8(vld1q_u8(pStart), zero)) != 0) {
+            return findZeroByteScalar(pStart, pStart + 16);
+        }
+
+        pStart += 16;
+    }
+
+    return findZeroByteScalar(pStart, pEnd);
+}
+#endif
+
+/**
+ * Selects the fastest zero byte scanner supported by the CPU
+ */
+FindZeroByteFunc selectFindZeroByteFunc()
+{
+#if defined(NAL_ADAPTER_SSE2_SCANNER)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return findZeroByteAvx2;
+    }
+
+    return findZeroByteSse2;
+#elif defined(NAL_ADAPTER_NEON_SCANNER)
+    return findZeroByteNeon;
+#else
+    return findZeroByteScalar;
+#endif
+}
+
+/**
+ * Returns the zero byte scanner selected once based on the CPU features
+ */
+FindZeroByteFunc getFindZeroByteFunc()
+{
+    static FindZeroByteFunc findZeroByteFn = selectFindZeroByteFunc();
+
+    return findZeroByteFn;
+}
+
 /**
  * NALU adaptation from Annex-B to AVCC format
  */
@@ -13,11 +124,29 @@ STATUS adaptFrameNalsFromAnnexBToAvcc(PBYTE pFrameData,
                                       BOOL removeEpb,
                                       PBYTE pAdaptedFrameData,
                                       PUINT32 pAdaptedFrameDataSize)
+{
+    return adaptFrameNalsFromAnnexBToAvccWithScanner(pFrameData, frameDataSize, removeEpb, pAdaptedFrameData,
+                                                     pAdaptedFrameDataSize, getFindZeroByteFunc());
+}
+
+/**
+ * NALU adaptation from Annex-B to AVCC format.
+ *
+ * NOTE: Start codes and EPBs both begin with a zero byte so the runs of non-zero bytes
+ * following a non-zero byte are copied as-is. The scanner is used to skip over these runs.
+ * If the scanner is NULL then the frame is processed byte-by-byte.
+ */
+STATUS adaptFrameNalsFromAnnexBToAvccWithScanner(PBYTE pFrameData,
+                                                 UINT32 frameDataSize,
+                                                 BOOL removeEpb,
+                                                 PBYTE pAdaptedFrameData,
+                                                 PUINT32 pAdaptedFrameDataSize,
+                                                 FindZeroByteFunc findZeroByteFn)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    UINT32 i = 0, zeroCount = 0, runSize = 0;
+    UINT32 i = 0, zeroCount = 0, runSize = 0, skipSize;
     BOOL markerFound = FALSE;
-    PBYTE pCurPnt = pFrameData, pAdaptedCurPnt = pAdaptedFrameData, pRunStart = NULL;
+    PBYTE pCurPnt = pFrameData, pAdaptedCurPnt = pAdaptedFrameData, pRunStart = NULL, pEndPnt;
 
     CHK(pFrameData != NULL && pAdaptedFrameDataSize != NULL, STATUS_NULL_ARG);
     CHK(pAdaptedFrameData == NULL || *pAdaptedFrameDataSize >= frameDataSize, STATUS_INVALID_ARG_LEN);
@@ -25,9 +154,30 @@ STATUS adaptFrameNalsFromAnnexBToAvcc(PBYTE pFrameData,
     // Quick check for small size
     CHK(frameDataSize != 0, retStatus);
 
+    pEndPnt = pFrameData + frameDataSize;
+
     // Calculate the size after adaptation
     // NOTE: We will not check for the correct buffer size for performance reasons.
     for (i = 0; i < frameDataSize; i++) {
+        // Skip over the run of non-zero bytes
+        if (findZeroByteFn != NULL && zeroCount == 0 && *pCurPnt != 0x00) {
+            skipSize = (UINT32) (findZeroByteFn(pCurPnt, pEndPnt) - pCurPnt);
+
+            if (pAdaptedFrameData != NULL) {
+                MEMCPY(pAdaptedCurPnt, pCurPnt, skipSize);
+            }
+
+            pCurPnt += skipSize;
+            pAdaptedCurPnt += skipSize;
+            runSize += skipSize;
+            markerFound = FALSE;
+            i += skipSize;
+
+            if (i == frameDataSize) {
+                break;
+            }
+        }
+
         if (*pCurPnt == 0x00) {
             // Found a zero - increment the consecutive zero count
             zeroCount++;
@@ -119,6 +119,27 @@ extern "C" {
  */
 #define HEVC_SPS_NALU_TYPE          0x21
 
+/**
+ * Upper bound of the Annex-B to AVCC adapted frame size. Every 3 byte start code
+ * is replaced with a 4 byte NALu length so the worst case is a start code every 3 bytes.
+ */
+#define MAX_ANNEXB_TO_AVCC_ADAPTED_SIZE(s)     ((s) + (s) / 3)
+
+/**
+ * Vectorized zero byte scanners used for fast-forwarding through the Annex-B frame data.
+ * AVX2 is selected at runtime based on the CPU features.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define NAL_ADAPTER_SSE2_SCANNER
+#elif defined(__GNUC__) && defined(__aarch64__) && defined(__ARM_NEON)
+#define NAL_ADAPTER_NEON_SCANNER
+#endif
+
+/**
+ * Zero byte scanner function returning the pointer to the first zero byte or the end pointer if not found
+ */
+typedef PBYTE (*FindZeroByteFunc)(PBYTE, PBYTE);
+
 /**
  * NALu adaptation
  */
@@ -144,6 +165,43 @@ typedef enum {
  */
 STATUS adaptFrameNalsFromAnnexBToAvcc(PBYTE, UINT32, BOOL, PBYTE, PUINT32);
 
+/**
+ * Adapts the frame data Annex-B NALUs to AVCC using the specified zero byte scanner
+ *
+ * @PBYTE - Frame data buffer
+ * @UINT32 - Frame data buffer size
+ * @BOOL - Remove EPB (Emulation Prevention Bytes)
+ * @PBYTE - OUT - OPTIONAL - Adapted frame data buffer
+ * @PUINT32 - IN/OUT - Adapted frame data buffer size
+ * @FindZeroByteFunc - OPTIONAL - Zero byte scanner. NULL to process byte-by-byte.
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS adaptFrameNalsFromAnnexBToAvccWithScanner(PBYTE, UINT32, BOOL, PBYTE, PUINT32, FindZeroByteFunc);
+
+/**
+ * Zero byte scanners
+ *
+ * @PBYTE - Start of the buffer
+ * @PBYTE - End of the buffer
+ *
+ * @return - Pointer to the first zero byte or the end of the buffer if none
+ */
+PBYTE findZeroByteScalar(PBYTE, PBYTE);
+#if defined(NAL_ADAPTER_SSE2_SCANNER)
+PBYTE findZeroByteSse2(PBYTE, PBYTE);
+PBYTE findZeroByteAvx2(PBYTE, PBYTE);
+#elif defined(NAL_ADAPTER_NEON_SCANNER)
+PBYTE findZeroByteNeon(PBYTE, PBYTE);
+#endif
+
+/**
+ * Returns the fastest zero byte scanner supported by the CPU
+ *
+ * @return - Zero byte scanner function
+ */
+FindZeroByteFunc getFindZeroByteFunc();
+
 /**
  * Adapts the CPD Annex-B NALUs to AVCC for H264
  *
@@ -193,6 +251,17 @@ STATUS adaptFrameNalsFromAvccToAnnexB(PBYTE, UINT32);
  */
 STATUS getAdaptedFrameSize(PFrame, MKV_NALS_ADAPTATION, PUINT32);
 
+/**
+ * Gets the upper bound of the adapted frame size without scanning the frame data
+ *
+ * @PFrame - IN - Frame to get the max adapted size for
+ * @MKV_NALS_ADAPTATION - the nals adaptation mode
+ * @PUINT32 - Max adapted size of the frame
+ *
+ * @return - STATUS code of the execution
+ */
+STATUS getMaxAdaptedFrameSize(PFrame, MKV_NALS_ADAPTATION, PUINT32);
+
 /**
  * @PBYTE - CPD buffer
  * @UINT32 - CPD buffer size
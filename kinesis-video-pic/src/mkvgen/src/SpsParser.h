@@ -14,7 +14,7 @@ extern "C" {
 ////////////////////////////////////////////////////
 
 // Check whether to generate video config element based on the width not being 0
-#define GENERATE_VIDEO_CONFIG(x)        (((PStreamMkvGenerator) (x))->videoWidth != 0)
+#define GENERATE_VIDEO_CONFIG(x)        (((PMkvTrack) (x))->videoWidth != 0)
 
 // SPS NALU values
 #define SPS_NALU_67     0x67
@@ -3,6 +3,61 @@
 class AnnexBNalAdapterTest : public MkvgenTestBase {
 };
 
+/**
+ * Validates the vectorized scanners produce the same results as the byte-by-byte adaptation
+ */
+VOID verifyScannersMatchReference(PBYTE pFrameData, UINT32 frameDataSize)
+{
+    FindZeroByteFunc scanners[] = {
+            findZeroByteScalar,
+#if defined(NAL_ADAPTER_SSE2_SCANNER)
+            findZeroByteSse2,
+            findZeroByteAvx2,
+#elif defined(NAL_ADAPTER_NEON_SCANNER)
+            findZeroByteNeon,
+#endif
+            getFindZeroByteFunc(),
+    };
+    UINT32 i, j, refSize, size, bufferSize = MAX_ANNEXB_TO_AVCC_ADAPTED_SIZE(frameDataSize) + 4;
+    STATUS refStatus;
+    BOOL removeEpb;
+    PBYTE pRefBuffer = (PBYTE) MEMALLOC(bufferSize);
+    PBYTE pBuffer = (PBYTE) MEMALLOC(bufferSize);
+
+#if defined(NAL_ADAPTER_SSE2_SCANNER)
+    // Skip the AVX2 scanner if the CPU doesn't support it
+    if (!__builtin_cpu_supports("avx2")) {
+        scanners[2] = findZeroByteSse2;
+    }
+#endif
+
+    for (j = 0; j < 2; j++) {
+        removeEpb = (j == 0);
+        for (i = 0; i < SIZEOF(scanners) / SIZEOF(scanners[0]); i++) {
+            refSize = bufferSize;
+            size = bufferSize;
+            MEMSET(pRefBuffer, 0xff, bufferSize);
+            MEMSET(pBuffer, 0xff, bufferSize);
+
+            refStatus = adaptFrameNalsFromAnnexBToAvccWithScanner(pFrameData, frameDataSize, removeEpb, NULL, &refSize, NULL);
+            EXPECT_EQ(refStatus, adaptFrameNalsFromAnnexBToAvccWithScanner(pFrameData, frameDataSize, removeEpb, NULL, &size, scanners[i]));
+            EXPECT_EQ(refSize, size) << "Scanner " << i;
+
+            refSize = bufferSize;
+            size = bufferSize;
+            refStatus = adaptFrameNalsFromAnnexBToAvccWithScanner(pFrameData, frameDataSize, removeEpb, pRefBuffer, &refSize, NULL);
+            EXPECT_EQ(refStatus, adaptFrameNalsFromAnnexBToAvccWithScanner(pFrameData, frameDataSize, removeEpb, pBuffer, &size, scanners[i]));
+            if (STATUS_SUCCEEDED(refStatus)) {
+                EXPECT_EQ(refSize, size) << "Scanner " << i;
+                EXPECT_EQ(0, MEMCMP(pRefBuffer, pBuffer, bufferSize)) << "Scanner " << i;
+            }
+        }
+    }
+
+    MEMFREE(pRefBuffer);
+    MEMFREE(pBuffer);
+}
+
 TEST_F(AnnexBNalAdapterTest, nalAdapter_InvalidInput)
 {
     PBYTE pFrameData = (PBYTE) 100;
@@ -194,6 +249,7 @@ TEST_F(AnnexBNalAdapterTest, nalAdapter_ValidZerosInStream)
         EXPECT_EQ(STATUS_SUCCESS, adaptFrameNalsFromAnnexBToAvcc(frameDatas[i], frameDataSize, FALSE, adaptedFrameData, &adaptedFrameDataSize));
         EXPECT_EQ(adaptedSizes[i], adaptedFrameDataSize);
         EXPECT_EQ(0, MEMCMP(adaptedFrameDatas[i], adaptedFrameData, adaptedFrameDataSize)) << "Failed comparison on index: " << i;
+        verifyScannersMatchReference(frameDatas[i], frameDataSize);
     }
 }
 
@@ -219,6 +275,9 @@ TEST_F(AnnexBNalAdapterTest, nalAdapter_ValidSpsPpsOnly)
     EXPECT_EQ(STATUS_SUCCESS, adaptFrameNalsFromAnnexBToAvcc(frameData2, SIZEOF(frameData2), FALSE, NULL, &adaptedFrameDataSize));
     EXPECT_EQ(STATUS_SUCCESS, adaptFrameNalsFromAnnexBToAvcc(frameData2, SIZEOF(frameData2), TRUE, adaptedFrameData, &adaptedFrameDataSize));
     EXPECT_EQ(STATUS_SUCCESS, adaptFrameNalsFromAnnexBToAvcc(frameData2, SIZEOF(frameData2), FALSE, adaptedFrameData, &adaptedFrameDataSize));
+
+    verifyScannersMatchReference(frameData1, SIZEOF(frameData1));
+    verifyScannersMatchReference(frameData2, SIZEOF(frameData2));
 }
 
 TEST_F(AnnexBNalAdapterTest, nalAdapter_ValidEPB)
@@ -288,5 +347,45 @@ TEST_F(AnnexBNalAdapterTest, nalAdapter_ValidEPB)
         adaptedFrameDataSize = 0;
         EXPECT_EQ(STATUS_SUCCESS, adaptFrameNalsFromAnnexBToAvcc(frames[i], frameSizes[i], FALSE, NULL, &adaptedFrameDataSize)) << "Failed on iteration " << i;
         EXPECT_EQ(STATUS_SUCCESS, adaptFrameNalsFromAnnexBToAvcc(frames[i], frameSizes[i], FALSE, adaptedFrameData, &adaptedFrameDataSize)) << "Failed on iteration " << i;
+
+        verifyScannersMatchReference(frames[i], frameSizes[i]);
+    }
+}
+
+TEST_F(AnnexBNalAdapterTest, nalAdapter_FuzzScannersMatchReference)
+{
+    BYTE frameData[1024 + 32];
+    UINT32 i, j, size, offset, zeroRatio;
+
+    SRAND(12345);
+
+    for (i = 0; i < 2000; i++) {
+        // Vary the size, the alignment and the density of the zeros and the special bytes
+        size = RAND() % 1024;
+        offset = RAND() % 32;
+        zeroRatio = 1 + RAND() % 64;
+        for (j = 0; j < size; j++) {
+            if (RAND() % zeroRatio == 0) {
+                frameData[offset + j] = 0x00;
+            } else if (RAND() % 8 == 0) {
+                frameData[offset + j] = (BYTE) (1 + RAND() % 3);
+            } else {
+                frameData[offset + j] = (BYTE) RAND();
+            }
+        }
+
+        verifyScannersMatchReference(frameData + offset, size);
+    }
+
+    // Long runs of non-zero bytes followed by start codes at every position
+    MEMSET(frameData, 0x55, SIZEOF(frameData));
+    for (i = 0; i < 64; i++) {
+        frameData[i] = 0x00;
+        frameData[i + 1] = 0x00;
+        frameData[i + 2] = 0x01;
+        verifyScannersMatchReference(frameData, 128);
+        frameData[i] = 0x55;
+        frameData[i + 1] = 0x55;
+        frameData[i + 2] = 0x55;
     }
-}
\ No newline at end of file
+}
@@ -592,4 +592,68 @@ TEST_F(MkvgenApiFunctionalityTest, mkvgenResetGeneratorWithAnnexBAdaptation_Vari
     // Validate that it's a start of the stream + cluster
     EXPECT_EQ(adaptedSize + MKV_HEADER_OVERHEAD, size);
     EXPECT_EQ(MKV_STATE_START_STREAM, encodedFrameInfo.streamState);
-}
\ No newline at end of file
+}
+
+TEST_F(MkvgenApiFunctionalityTest, mkvgenPackageFrame_SinglePassAnnexBAdaptation)
+{
+    PMkvGenerator mkvGenerator, mkvGeneratorSinglePass;
+    UINT32 size, maxSize, singlePassSize;
+    BYTE frameBuf[10000];
+    Frame frame = {0, FRAME_FLAG_KEY_FRAME, 0, 0, MKV_TEST_FRAME_DURATION, 10000, frameBuf};
+    UINT32 i, adaptedSize;
+    PBYTE pSinglePassBuffer = (PBYTE) MEMALLOC(MKV_TEST_BUFFER_SIZE);
+    EncodedFrameInfo encodedFrameInfo, singlePassEncodedFrameInfo;
+
+    // Set the buffer info
+    MEMSET(frame.frameData, 0x55, SIZEOF(frameBuf));
+    for (i = 0; i < SIZEOF(frameBuf);) {
+        frame.frameData[i] = 0;
+        frame.frameData[i + 1] = 0;
+        frame.frameData[i + 2] = 1;
+        i += 100;
+    }
+
+    // 1 more byte for every Annex-B NAL
+    adaptedSize = SIZEOF(frameBuf) / 100 + SIZEOF(frameBuf);
+
+    EXPECT_EQ(STATUS_SUCCESS, createMkvGenerator(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS | MKV_GEN_ADAPT_ANNEXB_NALS, MKV_TEST_TIMECODE_SCALE,
+                                                 MKV_TEST_CLUSTER_DURATION, MKV_TEST_CODEC_ID, MKV_TEST_TRACK_NAME, NULL, 0, NULL, 0, &mkvGenerator));
+    EXPECT_EQ(STATUS_SUCCESS, createMkvGenerator(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS | MKV_GEN_ADAPT_ANNEXB_NALS, MKV_TEST_TIMECODE_SCALE,
+                                                 MKV_TEST_CLUSTER_DURATION, MKV_TEST_CODEC_ID, MKV_TEST_TRACK_NAME, NULL, 0, NULL, 0, &mkvGeneratorSinglePass));
+
+    for (i = 0; i < 10; i++) {
+        frame.flags = (i % 3 == 0) ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+
+        // Two pass - get the exact size first and then package
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mkvGenerator, &frame, NULL, &size, NULL));
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mkvGenerator, &frame, mBuffer, &size, &encodedFrameInfo));
+
+        // Single pass - package into a buffer of the max size
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenGetMaxPackagedFrameSize(mkvGeneratorSinglePass, &frame, &maxSize));
+        EXPECT_LE(size, maxSize);
+        singlePassSize = maxSize;
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mkvGeneratorSinglePass, &frame, pSinglePassBuffer, &singlePassSize, &singlePassEncodedFrameInfo));
+
+        // Validate the results are identical
+        EXPECT_EQ(size, singlePassSize);
+        EXPECT_EQ(encodedFrameInfo.streamState, singlePassEncodedFrameInfo.streamState);
+        if (encodedFrameInfo.streamState == MKV_STATE_START_STREAM) {
+            // The header contains a random segment UID so only the frame data is compared
+            EXPECT_EQ(adaptedSize + MKV_HEADER_OVERHEAD, size);
+            EXPECT_EQ(0, MEMCMP(mBuffer + size - adaptedSize, pSinglePassBuffer + size - adaptedSize, adaptedSize));
+        } else {
+            EXPECT_EQ(0, MEMCMP(mBuffer, pSinglePassBuffer, size));
+        }
+
+        frame.decodingTs += MKV_TEST_FRAME_DURATION;
+        frame.presentationTs += MKV_TEST_FRAME_DURATION;
+    }
+
+    // Ensure a buffer smaller than the exact size is rejected
+    singlePassSize = size - 1;
+    EXPECT_NE(STATUS_SUCCESS, mkvgenPackageFrame(mkvGeneratorSinglePass, &frame, pSinglePassBuffer, &singlePassSize, NULL));
+
+    MEMFREE(pSinglePassBuffer);
+    EXPECT_EQ(STATUS_SUCCESS, freeMkvGenerator(mkvGenerator));
+    EXPECT_EQ(STATUS_SUCCESS, freeMkvGenerator(mkvGeneratorSinglePass));
+}
@@ -197,3 +197,111 @@ TEST_F(MkvgenApiTest, mkvgenGetMkvOverheadSize_PositiveAndNegativeTest)
     EXPECT_EQ(MKV_SIMPLE_BLOCK_OVERHEAD, size);
 
 }
+
+TEST_F(MkvgenApiTest, mkvgenGetMaxPackagedFrameSize_PositiveAndNegativeTest)
+{
+    UINT32 size, maxSize;
+    BYTE frameBuf[10000];
+    Frame frame = {0, FRAME_FLAG_KEY_FRAME, 0, 0, MKV_TEST_FRAME_DURATION, 10000, frameBuf};
+
+    EXPECT_NE(STATUS_SUCCESS, mkvgenGetMaxPackagedFrameSize(NULL, &frame, &maxSize));
+    EXPECT_NE(STATUS_SUCCESS, mkvgenGetMaxPackagedFrameSize(mMkvGenerator, NULL, &maxSize));
+    EXPECT_NE(STATUS_SUCCESS, mkvgenGetMaxPackagedFrameSize(mMkvGenerator, &frame, NULL));
+
+    // With no NAL adaptation and in-stream timestamps the bound is exact
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenGetMaxPackagedFrameSize(mMkvGenerator, &frame, &maxSize));
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mMkvGenerator, &frame, NULL, &size, NULL));
+    EXPECT_EQ(size, maxSize);
+
+    // Package into a buffer of the bound size
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mMkvGenerator, &frame, mBuffer, &maxSize, NULL));
+    EXPECT_EQ(size, maxSize);
+
+    frame.flags = FRAME_FLAG_NONE;
+    frame.decodingTs += MKV_TEST_FRAME_DURATION;
+    frame.presentationTs += MKV_TEST_FRAME_DURATION;
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenGetMaxPackagedFrameSize(mMkvGenerator, &frame, &maxSize));
+    EXPECT_EQ(10000 + MKV_SIMPLE_BLOCK_OVERHEAD, maxSize);
+}
+
+TEST_F(MkvgenApiTest, mkvgenPackageFrameHeader_MatchesPackagedFrame)
+{
+    PMkvGenerator pMkvGenerator = NULL;
+    UINT32 i, size, headerSize, streamHeaderSize = 0, frameSize = 0, headerStreamSize = 0;
+    BYTE frameBuf[300];
+    Frame frame = {0, FRAME_FLAG_KEY_FRAME, 0, 0, MKV_TEST_FRAME_DURATION, SIZEOF(frameBuf), frameBuf};
+    PBYTE pHeaderBuffer = (PBYTE) MEMALLOC(MKV_TEST_BUFFER_SIZE);
+    EncodedFrameInfo frameInfo, headerInfo;
+
+    for (i = 0; i < SIZEOF(frameBuf); i++) {
+        frameBuf[i] = (BYTE) i;
+    }
+
+    EXPECT_NE(STATUS_SUCCESS, mkvgenPackageFrameHeader(NULL, &frame, pHeaderBuffer, &size, NULL));
+    EXPECT_NE(STATUS_SUCCESS, mkvgenPackageFrameHeader(mMkvGenerator, &frame, pHeaderBuffer, NULL, NULL));
+    EXPECT_NE(STATUS_SUCCESS, mkvgenPackageFrameHeader(mMkvGenerator, NULL, pHeaderBuffer, &size, NULL));
+
+    EXPECT_EQ(STATUS_SUCCESS, createMkvGenerator(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE,
+                                                 MKV_TEST_CLUSTER_DURATION, MKV_TEST_CODEC_ID, MKV_TEST_TRACK_NAME, NULL, 0, NULL, 0,
+                                                 &pMkvGenerator));
+
+    // The headers followed by the frame data produce the same stream as the packaged frames
+    for (i = 0; i < 200; i++) {
+        frame.flags = i % 50 == 0 ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+        frame.size = SIZEOF(frameBuf) - i;
+
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrameHeader(pMkvGenerator, &frame, NULL, &headerSize, NULL));
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrameHeader(pMkvGenerator, &frame, pHeaderBuffer + headerStreamSize, &headerSize, &headerInfo));
+        size = MKV_TEST_BUFFER_SIZE - frameSize;
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mMkvGenerator, &frame, mBuffer + frameSize, &size, &frameInfo));
+
+        EXPECT_EQ(size, headerSize + frame.size);
+        EXPECT_EQ(frameInfo.dataOffset, headerInfo.dataOffset);
+        EXPECT_EQ(headerSize, headerInfo.dataOffset);
+        EXPECT_EQ(frameInfo.streamState, headerInfo.streamState);
+        EXPECT_EQ(frameInfo.clusterTs, headerInfo.clusterTs);
+
+        if (i == 0) {
+            streamHeaderSize = headerSize;
+        }
+
+        MEMCPY(pHeaderBuffer + headerStreamSize + headerSize, frameBuf, frame.size);
+        headerStreamSize += size;
+        frameSize += size;
+
+        frame.decodingTs += MKV_TEST_FRAME_DURATION;
+        frame.presentationTs += MKV_TEST_FRAME_DURATION;
+    }
+
+    // NOTE: The stream headers differ in the random segment and track UIDs
+    EXPECT_EQ(frameSize, headerStreamSize);
+    EXPECT_EQ(0, MEMCMP(mBuffer + streamHeaderSize, pHeaderBuffer + streamHeaderSize, frameSize - streamHeaderSize));
+
+    // The buffer has to hold the header
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrameHeader(pMkvGenerator, &frame, NULL, &headerSize, NULL));
+    size = headerSize - 1;
+    EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY, mkvgenPackageFrameHeader(pMkvGenerator, &frame, pHeaderBuffer, &size, NULL));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeMkvGenerator(pMkvGenerator));
+    MEMFREE(pHeaderBuffer);
+}
+
+TEST_F(MkvgenApiTest, mkvgenPackageFrameHeader_NalsAdaptationNotSupported)
+{
+    PMkvGenerator pMkvGenerator = NULL;
+    UINT32 size = MKV_TEST_BUFFER_SIZE;
+    BYTE frameBuf[] = {0x00, 0x00, 0x00, 0x01, 0x65, 0x11, 0x22};
+    Frame frame = {0, FRAME_FLAG_KEY_FRAME, 0, 0, MKV_TEST_FRAME_DURATION, SIZEOF(frameBuf), frameBuf};
+
+    EXPECT_EQ(STATUS_SUCCESS, createMkvGenerator(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS | MKV_GEN_ADAPT_ANNEXB_NALS,
+                                                 MKV_TEST_TIMECODE_SCALE, MKV_TEST_CLUSTER_DURATION, MKV_TEST_CODEC_ID,
+                                                 MKV_TEST_TRACK_NAME, NULL, 0, NULL, 0, &pMkvGenerator));
+
+    EXPECT_EQ(STATUS_MKV_FRAME_HEADER_NALS_ADAPTATION, mkvgenPackageFrameHeader(pMkvGenerator, &frame, mBuffer, &size, NULL));
+    EXPECT_EQ(STATUS_MKV_FRAME_HEADER_NALS_ADAPTATION, mkvgenPackageFrameHeader(pMkvGenerator, &frame, NULL, &size, NULL));
+
+    // The generator state is not affected
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(pMkvGenerator, &frame, mBuffer, &size, NULL));
+
+    EXPECT_EQ(STATUS_SUCCESS, freeMkvGenerator(pMkvGenerator));
+}
@@ -0,0 +1,130 @@
+#include "MkvgenTestFixture.h"
+
+#define MKV_BENCHMARK_FRAME_SIZE        (100 * 1024)
+#define MKV_BENCHMARK_FRAME_COUNT       500
+#define MKV_BENCHMARK_NAL_INTERVAL      1000
+
+class MkvgenBenchmarkTest : public MkvgenTestBase {
+};
+
+/**
+ * Compares the legacy two-pass packaging (exact size query followed by the packaging)
+ * with the single-pass packaging into a buffer sized by the upper bound.
+ */
+TEST_F(MkvgenBenchmarkTest, mkvgenPackageFrame_SinglePassVsTwoPass)
+{
+    PMkvGenerator mkvGenerator;
+    UINT32 i, size, bufferSize = MKV_BENCHMARK_FRAME_SIZE + MKV_BENCHMARK_FRAME_SIZE / 2;
+    PBYTE pFrameBuf = (PBYTE) MEMALLOC(MKV_BENCHMARK_FRAME_SIZE);
+    PBYTE pBuffer = (PBYTE) MEMALLOC(bufferSize);
+    Frame frame = {0, FRAME_FLAG_NONE, 0, 0, MKV_TEST_FRAME_DURATION, MKV_BENCHMARK_FRAME_SIZE, pFrameBuf};
+    UINT64 start, twoPassTime, singlePassTime;
+
+    ASSERT_TRUE(pFrameBuf != NULL && pBuffer != NULL);
+
+    MEMSET(pFrameBuf, 0x55, MKV_BENCHMARK_FRAME_SIZE);
+    for (i = 0; i < MKV_BENCHMARK_FRAME_SIZE - 3; i += MKV_BENCHMARK_NAL_INTERVAL) {
+        pFrameBuf[i] = 0;
+        pFrameBuf[i + 1] = 0;
+        pFrameBuf[i + 2] = 1;
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, createMkvGenerator(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS | MKV_GEN_ADAPT_ANNEXB_NALS, MKV_TEST_TIMECODE_SCALE,
+                                                 MKV_TEST_CLUSTER_DURATION, MKV_TEST_CODEC_ID, MKV_TEST_TRACK_NAME, NULL, 0, NULL, 0, &mkvGenerator));
+
+    // Two pass
+    start = GETTIME();
+    for (i = 0; i < MKV_BENCHMARK_FRAME_COUNT; i++) {
+        frame.flags = (i % 30 == 0) ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mkvGenerator, &frame, NULL, &size, NULL));
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mkvGenerator, &frame, pBuffer, &size, NULL));
+        frame.decodingTs += MKV_TEST_FRAME_DURATION;
+        frame.presentationTs += MKV_TEST_FRAME_DURATION;
+    }
+
+    twoPassTime = GETTIME() - start;
+
+    // Single pass
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenResetGenerator(mkvGenerator));
+    start = GETTIME();
+    for (i = 0; i < MKV_BENCHMARK_FRAME_COUNT; i++) {
+        frame.flags = (i % 30 == 0) ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenGetMaxPackagedFrameSize(mkvGenerator, &frame, &size));
+        EXPECT_GE(bufferSize, size);
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mkvGenerator, &frame, pBuffer, &size, NULL));
+        frame.decodingTs += MKV_TEST_FRAME_DURATION;
+        frame.presentationTs += MKV_TEST_FRAME_DURATION;
+    }
+
+    singlePassTime = GETTIME() - start;
+
+    DLOGI("Packaged %u frames of %u bytes. Two pass: %" PRIu64 " us/frame, single pass: %" PRIu64 " us/frame",
+          MKV_BENCHMARK_FRAME_COUNT, MKV_BENCHMARK_FRAME_SIZE,
+          twoPassTime / HUNDREDS_OF_NANOS_IN_A_MICROSECOND / MKV_BENCHMARK_FRAME_COUNT,
+          singlePassTime / HUNDREDS_OF_NANOS_IN_A_MICROSECOND / MKV_BENCHMARK_FRAME_COUNT);
+
+    EXPECT_EQ(STATUS_SUCCESS, freeMkvGenerator(mkvGenerator));
+    MEMFREE(pFrameBuf);
+    MEMFREE(pBuffer);
+}
+
+/**
+ * Reports the MKV overhead per frame size with the fixed 8-byte EBML sizes and the compact sizes
+ */
+TEST_F(MkvgenBenchmarkTest, mkvgenPackageFrame_CompactSizesOverhead)
+{
+    PMkvGenerator fixedGenerator, compactGenerator;
+    UINT32 frameSizes[] = {32, 128, 512, 1024, 4096, 16 * 1024, 64 * 1024};
+    UINT32 i, j, size, bufferSize = 64 * 1024 + 1024;
+    UINT64 fixedOverhead, compactOverhead;
+    PBYTE pFrameBuf = (PBYTE) MEMCALLOC(1, 64 * 1024);
+    PBYTE pBuffer = (PBYTE) MEMALLOC(bufferSize);
+    Frame frame = {0, FRAME_FLAG_NONE, 0, 0, MKV_TEST_FRAME_DURATION, 0, pFrameBuf};
+
+    ASSERT_TRUE(pFrameBuf != NULL && pBuffer != NULL);
+
+    EXPECT_EQ(STATUS_SUCCESS, createMkvGenerator(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE,
+                                                 MKV_TEST_CLUSTER_DURATION, MKV_TEST_CODEC_ID, MKV_TEST_TRACK_NAME, NULL, 0, NULL, 0, &fixedGenerator));
+    EXPECT_EQ(STATUS_SUCCESS, createMkvGenerator(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS | MKV_GEN_COMPACT_EBML_SIZES, MKV_TEST_TIMECODE_SCALE,
+                                                 MKV_TEST_CLUSTER_DURATION, MKV_TEST_CODEC_ID, MKV_TEST_TRACK_NAME, NULL, 0, NULL, 0, &compactGenerator));
+
+    for (i = 0; i < ARRAY_SIZE(frameSizes); i++) {
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenResetGenerator(fixedGenerator));
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenResetGenerator(compactGenerator));
+        frame.size = frameSizes[i];
+        fixedOverhead = compactOverhead = 0;
+
+        // The stream header is the same size with both and is excluded by starting the count after the first frame
+        for (j = 0; j <= MKV_BENCHMARK_FRAME_COUNT; j++) {
+            frame.flags = (j % 30 == 0) ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+
+            size = bufferSize;
+            EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(fixedGenerator, &frame, pBuffer, &size, NULL));
+            fixedOverhead += (j == 0) ? 0 : size - frame.size;
+
+            size = bufferSize;
+            EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(compactGenerator, &frame, pBuffer, &size, NULL));
+            compactOverhead += (j == 0) ? 0 : size - frame.size;
+
+            frame.decodingTs += MKV_TEST_FRAME_DURATION;
+            frame.presentationTs += MKV_TEST_FRAME_DURATION;
+        }
+
+        EXPECT_GT(fixedOverhead, compactOverhead);
+
+        DLOGI("Frame size %u bytes. Overhead per frame: fixed %" PRIu64 ".%02" PRIu64 " bytes (%" PRIu64 ".%02" PRIu64 "%%), "
+              "compact %" PRIu64 ".%02" PRIu64 " bytes (%" PRIu64 ".%02" PRIu64 "%%)",
+              frame.size,
+              fixedOverhead / MKV_BENCHMARK_FRAME_COUNT, fixedOverhead * 100 / MKV_BENCHMARK_FRAME_COUNT % 100,
+              fixedOverhead * 100 / MKV_BENCHMARK_FRAME_COUNT / frame.size,
+              fixedOverhead * 10000 / MKV_BENCHMARK_FRAME_COUNT / frame.size % 100,
+              compactOverhead / MKV_BENCHMARK_FRAME_COUNT, compactOverhead * 100 / MKV_BENCHMARK_FRAME_COUNT % 100,
+              compactOverhead * 100 / MKV_BENCHMARK_FRAME_COUNT / frame.size,
+              compactOverhead * 10000 / MKV_BENCHMARK_FRAME_COUNT / frame.size % 100);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, freeMkvGenerator(fixedGenerator));
+    EXPECT_EQ(STATUS_SUCCESS, freeMkvGenerator(compactGenerator));
+    MEMFREE(pFrameBuf);
+    MEMFREE(pBuffer);
+}
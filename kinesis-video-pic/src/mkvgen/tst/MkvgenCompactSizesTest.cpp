@@ -0,0 +1,212 @@
+#include "MkvgenTestFixture.h"
+
+#define MKV_TEST_COMPACT_BEHAVIOR_FLAGS     (MKV_TEST_BEHAVIOR_FLAGS | MKV_GEN_COMPACT_EBML_SIZES)
+#define MKV_TEST_COMPACT_MAX_FRAME_SIZE     17000
+
+class MkvgenCompactSizesTest : public MkvgenTestBase {
+protected:
+    MkvgenCompactSizesTest() : mCompactGenerator(NULL), mFrameData(NULL) {}
+
+    virtual void SetUp()
+    {
+        UINT32 i;
+
+        MkvgenTestBase::SetUp();
+
+        mFrameData = (PBYTE) MEMALLOC(MKV_TEST_COMPACT_MAX_FRAME_SIZE);
+        ASSERT_TRUE(mFrameData != NULL);
+        for (i = 0; i < MKV_TEST_COMPACT_MAX_FRAME_SIZE; i++) {
+            mFrameData[i] = (BYTE) i;
+        }
+    }
+
+    virtual void TearDown()
+    {
+        if (mCompactGenerator != NULL) {
+            freeMkvGenerator(mCompactGenerator);
+            mCompactGenerator = NULL;
+        }
+
+        if (mFrameData != NULL) {
+            MEMFREE(mFrameData);
+            mFrameData = NULL;
+        }
+
+        MkvgenTestBase::TearDown();
+    }
+
+    /**
+     * Packages the frame at the offset of the scratch buffer validating the size query and the data offset.
+     * Returns the packaged size.
+     */
+    UINT32 packageFrame(PFrame pFrame, UINT32 adaptedFrameSize, UINT32 offset)
+    {
+        UINT32 size, maxSize, overhead, packagedSize = MKV_TEST_BUFFER_SIZE - offset;
+        EncodedFrameInfo encodedFrameInfo;
+
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenGetMaxPackagedFrameSize(mCompactGenerator, pFrame, &maxSize));
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mCompactGenerator, pFrame, NULL, &size, NULL));
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mCompactGenerator, pFrame, mBuffer + offset, &packagedSize, &encodedFrameInfo));
+
+        // The overhead is exact and doesn't exceed the upper bound
+        EXPECT_EQ(size, packagedSize);
+        EXPECT_GE(maxSize, packagedSize);
+        EXPECT_EQ(packagedSize, encodedFrameInfo.dataOffset + adaptedFrameSize);
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenGetMkvOverheadSize(mCompactGenerator, encodedFrameInfo.streamState, &overhead));
+        EXPECT_GE(overhead, encodedFrameInfo.dataOffset);
+
+        return packagedSize;
+    }
+
+    PMkvGenerator mCompactGenerator;
+    PBYTE mFrameData;
+    EbmlElement mElements[MKV_TEST_MAX_EBML_ELEMENTS];
+};
+
+TEST_F(MkvgenCompactSizesTest, mkvgenPackageFrame_RoundTrip)
+{
+    // The sizes and the timestamps cross the EBML and the big-endian length boundaries
+    UINT32 frameSizes[] = {1, 50, 122, 123, 200, 16378, 16379, MKV_TEST_COMPACT_MAX_FRAME_SIZE};
+    UINT32 sizeLengths[] = {1, 1, 1, 2, 2, 2, 3, 3};
+    UINT64 timecodes[] = {0, 255, 256, 1000, 65535, 65536, 16777215, 16777216};
+    UINT32 timecodeLengths[] = {1, 1, 2, 2, 2, 3, 3, 4};
+    UINT32 i, count, offset = 0, blockCount = 0, clusterCount = 0;
+    Frame frame;
+
+    EXPECT_EQ(STATUS_SUCCESS, createMkvGenerator(MKV_TEST_CONTENT_TYPE, MKV_TEST_COMPACT_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE,
+                                                 MKV_TEST_CLUSTER_DURATION, MKV_TEST_CODEC_ID, MKV_TEST_TRACK_NAME, NULL, 0, NULL, 0,
+                                                 &mCompactGenerator));
+
+    // Each key frame starts a cluster and is followed by a block of the same size
+    frame.trackId = MKV_DEFAULT_TRACK_ID;
+    frame.duration = MKV_TEST_FRAME_DURATION;
+    frame.frameData = mFrameData;
+    for (i = 0; i < ARRAY_SIZE(frameSizes); i++) {
+        frame.index = 2 * i;
+        frame.flags = FRAME_FLAG_KEY_FRAME;
+        frame.size = frameSizes[i];
+        frame.presentationTs = frame.decodingTs = timecodes[i] * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        offset += packageFrame(&frame, frame.size, offset);
+
+        frame.index++;
+        frame.flags = FRAME_FLAG_NONE;
+        frame.presentationTs = frame.decodingTs = frame.decodingTs + HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        offset += packageFrame(&frame, frame.size, offset);
+    }
+
+    // Read back the cluster timecodes and the blocks
+    count = parseEbmlElements(mBuffer, offset, mElements, MKV_TEST_MAX_EBML_ELEMENTS);
+    for (i = 0; i < count; i++) {
+        switch (mElements[i].id) {
+            case MKV_TEST_CLUSTER_TIMECODE_ID:
+                ASSERT_GT(ARRAY_SIZE(timecodes), clusterCount);
+                EXPECT_EQ(timecodeLengths[clusterCount], mElements[i].size);
+                EXPECT_EQ(timecodes[clusterCount], getEbmlUint(&mElements[i]));
+                clusterCount++;
+                break;
+
+            case MKV_TEST_SIMPLE_BLOCK_ID:
+                ASSERT_GT(2 * ARRAY_SIZE(frameSizes), blockCount);
+                EXPECT_EQ(1 + sizeLengths[blockCount / 2], mElements[i].headerSize);
+                EXPECT_EQ(frameSizes[blockCount / 2] + MKV_SIMPLE_BLOCK_PAYLOAD_HEADER_SIZE, mElements[i].size);
+                EXPECT_EQ(0x80 | MKV_DEFAULT_TRACK_ID, mElements[i].pData[MKV_SIMPLE_BLOCK_TRACK_NUMBER_OFFSET]);
+                EXPECT_EQ(blockCount % 2 == 0 ? 0 : 1, getInt16(*(PINT16) (mElements[i].pData + MKV_SIMPLE_BLOCK_TIMECODE_OFFSET)));
+                EXPECT_EQ(0, MEMCMP(mFrameData, mElements[i].pData + MKV_SIMPLE_BLOCK_PAYLOAD_HEADER_SIZE, frameSizes[blockCount / 2]));
+                blockCount++;
+                break;
+        }
+    }
+
+    EXPECT_EQ(ARRAY_SIZE(timecodes), clusterCount);
+    EXPECT_EQ(2 * ARRAY_SIZE(frameSizes), blockCount);
+}
+
+TEST_F(MkvgenCompactSizesTest, mkvgenPackageFrame_MatchesFixedSizesLayout)
+{
+    UINT32 fixedSize, compactSize, i;
+    PBYTE pFixedBuffer = mBuffer, pCompactBuffer = mBuffer + MKV_TEST_BUFFER_SIZE / 2;
+    Frame frame = {0, FRAME_FLAG_KEY_FRAME, 0, 0, MKV_TEST_FRAME_DURATION, 100, mFrameData};
+
+    EXPECT_EQ(STATUS_SUCCESS, createMkvGenerator(MKV_TEST_CONTENT_TYPE, MKV_TEST_COMPACT_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE,
+                                                 MKV_TEST_CLUSTER_DURATION, MKV_TEST_CODEC_ID, MKV_TEST_TRACK_NAME, NULL, 0, NULL, 0,
+                                                 &mCompactGenerator));
+
+    // The compact sizes save 7 bytes of the block size and 7 bytes of the cluster timecode
+    for (i = 0; i < 3; i++) {
+        fixedSize = compactSize = MKV_TEST_BUFFER_SIZE / 2;
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mMkvGenerator, &frame, pFixedBuffer, &fixedSize, NULL));
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(mCompactGenerator, &frame, pCompactBuffer, &compactSize, NULL));
+        EXPECT_EQ(fixedSize, compactSize + (i == 2 ? 7 : 14));
+
+        // The frame data is at the end of both
+        EXPECT_EQ(0, MEMCMP(pFixedBuffer + fixedSize - frame.size, pCompactBuffer + compactSize - frame.size, frame.size));
+
+        frame.flags = (i == 0) ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+        frame.presentationTs = frame.decodingTs = frame.decodingTs + MKV_TEST_FRAME_DURATION;
+        frame.index++;
+    }
+
+    // The upper bounds account for any frame size and cluster timecode
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenGetMkvOverheadSize(mMkvGenerator, MKV_STATE_START_CLUSTER, &fixedSize));
+    EXPECT_EQ(MKV_CLUSTER_OVERHEAD, fixedSize);
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenGetMkvOverheadSize(mCompactGenerator, MKV_STATE_START_CLUSTER, &compactSize));
+    EXPECT_EQ(MKV_CLUSTER_OVERHEAD - 3, compactSize);
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenGetMkvOverheadSize(mCompactGenerator, MKV_STATE_START_BLOCK, &compactSize));
+    EXPECT_EQ(MKV_SIMPLE_BLOCK_OVERHEAD - 3, compactSize);
+}
+
+TEST_F(MkvgenCompactSizesTest, mkvgenPackageFrame_AnnexBSizeLengthFromMaxAdaptedSize)
+{
+    UINT32 i, count, size, adaptedSize, blockCount = 0;
+    Frame frame = {0, FRAME_FLAG_KEY_FRAME, 0, 0, MKV_TEST_FRAME_DURATION, 96, mFrameData};
+
+    EXPECT_EQ(STATUS_SUCCESS, createMkvGenerator(MKV_TEST_CONTENT_TYPE, MKV_TEST_COMPACT_BEHAVIOR_FLAGS | MKV_GEN_ADAPT_ANNEXB_NALS,
+                                                 MKV_TEST_TIMECODE_SCALE, MKV_TEST_CLUSTER_DURATION, MKV_TEST_CODEC_ID,
+                                                 MKV_TEST_TRACK_NAME, NULL, 0, NULL, 0, &mCompactGenerator));
+
+    // A single NAL with a 4-byte start code adapts to the same size
+    MEMSET(mFrameData, 0x55, frame.size);
+    mFrameData[0] = mFrameData[1] = mFrameData[2] = 0;
+    mFrameData[3] = 1;
+    EXPECT_EQ(STATUS_SUCCESS, adaptFrameNalsFromAnnexBToAvcc(mFrameData, frame.size, FALSE, NULL, &adaptedSize));
+    EXPECT_EQ(frame.size, adaptedSize);
+
+    size = packageFrame(&frame, adaptedSize, 0);
+    count = parseEbmlElements(mBuffer, size, mElements, MKV_TEST_MAX_EBML_ELEMENTS);
+
+    // The adapted size fits a single byte but the max adapted size requires two
+    for (i = 0; i < count; i++) {
+        if (mElements[i].id == MKV_TEST_SIMPLE_BLOCK_ID) {
+            EXPECT_EQ(3, mElements[i].headerSize);
+            EXPECT_EQ(adaptedSize + MKV_SIMPLE_BLOCK_PAYLOAD_HEADER_SIZE, mElements[i].size);
+            EXPECT_EQ(adaptedSize - 4, (UINT32) getInt32(*(PINT32) (mElements[i].pData + MKV_SIMPLE_BLOCK_PAYLOAD_HEADER_SIZE)));
+            blockCount++;
+        }
+    }
+
+    EXPECT_EQ(1, blockCount);
+}
+
+TEST_F(MkvgenCompactSizesTest, mkvgenEbmlEncodeNumberWithLength_Boundaries)
+{
+    BYTE buffer[8];
+
+    EXPECT_EQ(STATUS_NULL_ARG, mkvgenEbmlEncodeNumberWithLength(0, 1, NULL, SIZEOF(buffer)));
+    EXPECT_EQ(STATUS_INVALID_ARG, mkvgenEbmlEncodeNumberWithLength(0, 0, buffer, SIZEOF(buffer)));
+    EXPECT_EQ(STATUS_INVALID_ARG, mkvgenEbmlEncodeNumberWithLength(0, 9, buffer, SIZEOF(buffer)));
+    EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY, mkvgenEbmlEncodeNumberWithLength(0, 2, buffer, 1));
+
+    // The all-ones values are reserved
+    EXPECT_EQ(STATUS_MKV_NUMBER_TOO_BIG, mkvgenEbmlEncodeNumberWithLength(0x7F, 1, buffer, SIZEOF(buffer)));
+    EXPECT_EQ(STATUS_MKV_NUMBER_TOO_BIG, mkvgenEbmlEncodeNumberWithLength(0x3FFF, 2, buffer, SIZEOF(buffer)));
+
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenEbmlEncodeNumberWithLength(0x7E, 1, buffer, SIZEOF(buffer)));
+    EXPECT_EQ(0xFE, buffer[0]);
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenEbmlEncodeNumberWithLength(0x7F, 2, buffer, SIZEOF(buffer)));
+    EXPECT_EQ(0x40, buffer[0]);
+    EXPECT_EQ(0x7F, buffer[1]);
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenEbmlEncodeNumberWithLength(5, 3, buffer, SIZEOF(buffer)));
+    EXPECT_EQ(0x20, buffer[0]);
+    EXPECT_EQ(0x00, buffer[1]);
+    EXPECT_EQ(0x05, buffer[2]);
+}
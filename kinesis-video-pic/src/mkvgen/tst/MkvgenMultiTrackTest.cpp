@@ -0,0 +1,210 @@
+#include "MkvgenTestFixture.h"
+
+#define MKV_TEST_VIDEO_TRACK_ID         1
+#define MKV_TEST_AUDIO_TRACK_ID         2
+#define MKV_TEST_AUDIO_FRAME_DURATION   (20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)
+#define MKV_TEST_AUDIO_CONTENT_TYPE     "audio/aac"
+#define MKV_TEST_AUDIO_CODEC_ID         "A_AAC"
+#define MKV_TEST_AUDIO_TRACK_NAME       "audio track"
+
+class MkvgenMultiTrackTest : public MkvgenTestBase {
+protected:
+    MkvgenMultiTrackTest() : mMultiTrackGenerator(NULL) {}
+
+    VOID initializeTracks()
+    {
+        MEMSET(mTrackInfos, 0x00, SIZEOF(mTrackInfos));
+
+        mTrackInfos[0].trackId = MKV_TEST_VIDEO_TRACK_ID;
+        STRCPY(mTrackInfos[0].contentType, MKV_TEST_CONTENT_TYPE);
+        STRCPY(mTrackInfos[0].codecId, MKV_TEST_CODEC_ID);
+        STRCPY(mTrackInfos[0].trackName, MKV_TEST_TRACK_NAME);
+
+        mTrackInfos[1].trackId = MKV_TEST_AUDIO_TRACK_ID;
+        STRCPY(mTrackInfos[1].contentType, MKV_TEST_AUDIO_CONTENT_TYPE);
+        STRCPY(mTrackInfos[1].codecId, MKV_TEST_AUDIO_CODEC_ID);
+        STRCPY(mTrackInfos[1].trackName, MKV_TEST_AUDIO_TRACK_NAME);
+        mTrackInfos[1].codecPrivateData = mAudioCpd;
+        mTrackInfos[1].codecPrivateDataSize = SIZEOF(mAudioCpd);
+    }
+
+    STATUS createMultiTrackGenerator()
+    {
+        initializeTracks();
+        return createMkvGeneratorWithTracks(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE,
+                                            MKV_TEST_CLUSTER_DURATION, mTrackInfos, ARRAY_SIZE(mTrackInfos), NULL, 0,
+                                            &mMultiTrackGenerator);
+    }
+
+    /**
+     * Packages the frame at the end of the scratch buffer and returns the packaged size
+     */
+    UINT32 packageFrame(PMkvGenerator pMkvGenerator, PFrame pFrame, UINT32 offset)
+    {
+        UINT32 size = MKV_TEST_BUFFER_SIZE - offset, maxSize;
+
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenGetMaxPackagedFrameSize(pMkvGenerator, pFrame, &maxSize));
+        EXPECT_EQ(STATUS_SUCCESS, mkvgenPackageFrame(pMkvGenerator, pFrame, mBuffer + offset, &size, NULL));
+        EXPECT_GE(maxSize, size);
+
+        return size;
+    }
+
+    virtual void TearDown()
+    {
+        if (mMultiTrackGenerator != NULL) {
+            freeMkvGenerator(mMultiTrackGenerator);
+            mMultiTrackGenerator = NULL;
+        }
+
+        MkvgenTestBase::TearDown();
+    }
+
+    PMkvGenerator mMultiTrackGenerator;
+    TrackInfo mTrackInfos[2];
+    BYTE mAudioCpd[2] = {0x12, 0x10};
+    BYTE mFrameData[100];
+    EbmlElement mElements[MKV_TEST_MAX_EBML_ELEMENTS];
+};
+
+TEST_F(MkvgenMultiTrackTest, createMkvGeneratorWithTracks_InvalidInput)
+{
+    PMkvGenerator pMkvGenerator = NULL;
+
+    initializeTracks();
+    EXPECT_EQ(STATUS_NULL_ARG, createMkvGeneratorWithTracks(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE, MKV_TEST_CLUSTER_DURATION, NULL, 2, NULL, 0, &pMkvGenerator));
+    EXPECT_EQ(STATUS_NULL_ARG, createMkvGeneratorWithTracks(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE, MKV_TEST_CLUSTER_DURATION, mTrackInfos, 2, NULL, 0, NULL));
+    EXPECT_EQ(STATUS_MKV_INVALID_TRACK_COUNT, createMkvGeneratorWithTracks(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE, MKV_TEST_CLUSTER_DURATION, mTrackInfos, 0, NULL, 0, &pMkvGenerator));
+    EXPECT_EQ(STATUS_MKV_INVALID_TRACK_COUNT, createMkvGeneratorWithTracks(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE, MKV_TEST_CLUSTER_DURATION, mTrackInfos, MKV_MAX_TRACK_COUNT + 1, NULL, 0, &pMkvGenerator));
+
+    mTrackInfos[1].trackId = 0;
+    EXPECT_EQ(STATUS_MKV_INVALID_TRACK_ID, createMkvGeneratorWithTracks(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE, MKV_TEST_CLUSTER_DURATION, mTrackInfos, 2, NULL, 0, &pMkvGenerator));
+    mTrackInfos[1].trackId = MKV_MAX_TRACK_ID + 1;
+    EXPECT_EQ(STATUS_MKV_INVALID_TRACK_ID, createMkvGeneratorWithTracks(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE, MKV_TEST_CLUSTER_DURATION, mTrackInfos, 2, NULL, 0, &pMkvGenerator));
+    mTrackInfos[1].trackId = MKV_TEST_VIDEO_TRACK_ID;
+    EXPECT_EQ(STATUS_MKV_INVALID_TRACK_ID, createMkvGeneratorWithTracks(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE, MKV_TEST_CLUSTER_DURATION, mTrackInfos, 2, NULL, 0, &pMkvGenerator));
+    mTrackInfos[1].trackId = MKV_MAX_TRACK_ID;
+    mTrackInfos[1].codecPrivateData = NULL;
+    EXPECT_EQ(STATUS_MKV_CODEC_PRIVATE_NULL, createMkvGeneratorWithTracks(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE, MKV_TEST_CLUSTER_DURATION, mTrackInfos, 2, NULL, 0, &pMkvGenerator));
+    mTrackInfos[1].codecPrivateDataSize = 0;
+    EXPECT_EQ(STATUS_SUCCESS, createMkvGeneratorWithTracks(MKV_TEST_CONTENT_TYPE, MKV_TEST_BEHAVIOR_FLAGS, MKV_TEST_TIMECODE_SCALE, MKV_TEST_CLUSTER_DURATION, mTrackInfos, 2, NULL, 0, &pMkvGenerator));
+    EXPECT_EQ(STATUS_SUCCESS, freeMkvGenerator(pMkvGenerator));
+}
+
+TEST_F(MkvgenMultiTrackTest, mkvgenPackageFrame_TrackEntries)
+{
+    Frame frame = {0, FRAME_FLAG_KEY_FRAME, 0, 0, MKV_TEST_FRAME_DURATION, SIZEOF(mFrameData), mFrameData, MKV_TEST_VIDEO_TRACK_ID};
+    UINT32 size, overhead, count, i, trackIndex = 0, tracksIndex = 0, entrySize = 0;
+    UINT64 trackNumbers[2], trackTypes[2];
+    BOOL audioCpdFound = FALSE;
+
+    ASSERT_EQ(STATUS_SUCCESS, createMultiTrackGenerator());
+    EXPECT_EQ(STATUS_SUCCESS, mkvgenGetMkvOverheadSize(mMultiTrackGenerator, MKV_STATE_START_STREAM, &overhead));
+
+    size = packageFrame(mMultiTrackGenerator, &frame, 0);
+    EXPECT_EQ(overhead + SIZEOF(mFrameData), size);
+
+    count = parseEbmlElements(mBuffer, size, mElements, ARRAY_SIZE(mElements));
+    for (i = 0; i < count; i++) {
+        switch (mElements[i].id) {
+            case MKV_TEST_TRACKS_ID:
+                tracksIndex = i;
+                break;
+            case MKV_TEST_TRACK_ENTRY_ID:
+                entrySize += mElements[i].headerSize + (UINT32) mElements[i].size;
+                break;
+            case MKV_TEST_TRACK_NUMBER_ID:
+                ASSERT_GT(ARRAY_SIZE(trackNumbers), trackIndex);
+                trackNumbers[trackIndex] = getEbmlUint(&mElements[i]);
+                break;
+            case MKV_TEST_TRACK_TYPE_ID:
+                trackTypes[trackIndex++] = getEbmlUint(&mElements[i]);
+                break;
+            case MKV_TEST_CODEC_PRIVATE_ID:
+                // Only the audio track has the CPD
+                EXPECT_EQ(2, trackIndex);
+                EXPECT_EQ(SIZEOF(mAudioCpd), mElements[i].size);
+                EXPECT_EQ(0, MEMCMP(mAudioCpd, mElements[i].pData, SIZEOF(mAudioCpd)));
+                audioCpdFound = TRUE;
+                break;
+            case MKV_TEST_SIMPLE_BLOCK_ID:
+                // Track number followed by the timecode and the flags
+                EXPECT_EQ(0x80 | MKV_TEST_VIDEO_TRACK_ID, mElements[i].pData[0]);
+                EXPECT_EQ(SIZEOF(mFrameData) + MKV_SIMPLE_BLOCK_PAYLOAD_HEADER_SIZE, mElements[i].size);
+                break;
+        }
+    }
+
+    EXPECT_EQ(2, trackIndex);
+    EXPECT_TRUE(audioCpdFound);
+    EXPECT_EQ(MKV_TEST_VIDEO_TRACK_ID, trackNumbers[0]);
+    EXPECT_EQ(MKV_TEST_AUDIO_TRACK_ID, trackNumbers[1]);
+    EXPECT_EQ(MKV_TRACK_TYPE_VIDEO, trackTypes[0]);
+    EXPECT_EQ(MKV_TRACK_TYPE_AUDIO, trackTypes[1]);
+
+    // The tracks element holds exactly the track entries
+    EXPECT_EQ(entrySize, mElements[tracksIndex].size);
+}
+
+TEST_F(MkvgenMultiTrackTest, mkvgenPackageFrame_InterleavedTracks)
+{
+    Frame frame;
+    UINT32 size = 0, count, i, blockCount = 0;
+    UINT64 timestamps[] = {0, 0, 20, 40, 40, 60, 80, 80};
+    UINT64 trackIds[] = {1, 2, 2, 1, 2, 2, 1, 2};
+    INT16 timecode;
+
+    ASSERT_EQ(STATUS_SUCCESS, createMultiTrackGenerator());
+
+    for (i = 0; i < ARRAY_SIZE(timestamps); i++) {
+        frame.index = i;
+        frame.trackId = trackIds[i];
+        frame.flags = (i == 0 || i == 6) && trackIds[i] == MKV_TEST_VIDEO_TRACK_ID ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+        frame.decodingTs = frame.presentationTs = timestamps[i] * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        frame.duration = trackIds[i] == MKV_TEST_VIDEO_TRACK_ID ? MKV_TEST_FRAME_DURATION : MKV_TEST_AUDIO_FRAME_DURATION;
+        frame.size = SIZEOF(mFrameData);
+        frame.frameData = mFrameData;
+        size += packageFrame(mMultiTrackGenerator, &frame, size);
+    }
+
+    // A frame of an unknown track is rejected
+    frame.trackId = 3;
+    EXPECT_EQ(STATUS_MKV_TRACK_INFO_NOT_FOUND, mkvgenPackageFrame(mMultiTrackGenerator, &frame, mBuffer + size, &i, NULL));
+    EXPECT_EQ(STATUS_MKV_TRACK_INFO_NOT_FOUND, mkvgenGetMaxPackagedFrameSize(mMultiTrackGenerator, &frame, &i));
+
+    // The blocks keep the order and the tracks of the frames with the timecodes relative to the cluster
+    count = parseEbmlElements(mBuffer, size, mElements, ARRAY_SIZE(mElements));
+    for (i = 0; i < count; i++) {
+        if (mElements[i].id == MKV_TEST_CLUSTER_TIMECODE_ID) {
+            EXPECT_EQ(blockCount == 0 ? 0 : 80, getEbmlUint(&mElements[i]));
+        } else if (mElements[i].id == MKV_TEST_SIMPLE_BLOCK_ID) {
+            ASSERT_GT(ARRAY_SIZE(timestamps), blockCount);
+            EXPECT_EQ(0x80 | trackIds[blockCount], mElements[i].pData[0]);
+            timecode = (INT16) ((mElements[i].pData[1] << 8) | mElements[i].pData[2]);
+            EXPECT_EQ(timestamps[blockCount] - (blockCount < 6 ? 0 : 80), (UINT64) timecode);
+            blockCount++;
+        }
+    }
+
+    EXPECT_EQ(ARRAY_SIZE(timestamps), blockCount);
+}
+
+TEST_F(MkvgenMultiTrackTest, mkvgenPackageFrame_SingleTrackIgnoresTrackId)
+{
+    Frame frame = {0, FRAME_FLAG_KEY_FRAME, 0, 0, MKV_TEST_FRAME_DURATION, SIZEOF(mFrameData), mFrameData, 5};
+    UINT32 size, count, i, trackEntryCount = 0;
+
+    size = packageFrame(mMkvGenerator, &frame, 0);
+    count = parseEbmlElements(mBuffer, size, mElements, ARRAY_SIZE(mElements));
+    for (i = 0; i < count; i++) {
+        if (mElements[i].id == MKV_TEST_TRACK_ENTRY_ID) {
+            trackEntryCount++;
+        } else if (mElements[i].id == MKV_TEST_TRACK_NUMBER_ID) {
+            EXPECT_EQ(MKV_DEFAULT_TRACK_ID, getEbmlUint(&mElements[i]));
+        } else if (mElements[i].id == MKV_TEST_SIMPLE_BLOCK_ID) {
+            EXPECT_EQ(0x80 | MKV_DEFAULT_TRACK_ID, mElements[i].pData[0]);
+        }
+    }
+
+    EXPECT_EQ(1, trackEntryCount);
+}
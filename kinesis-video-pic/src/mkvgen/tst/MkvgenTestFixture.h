@@ -20,6 +20,31 @@
 
 #define MKV_TEST_CUSTOM_DATA            0x12345
 
+#define MKV_TEST_MAX_EBML_ELEMENTS      1024
+
+// EBML element ids the tests look for
+#define MKV_TEST_SEGMENT_ID             0x18538067
+#define MKV_TEST_TRACKS_ID              0x1654AE6B
+#define MKV_TEST_TRACK_ENTRY_ID         0xAE
+#define MKV_TEST_TRACK_NUMBER_ID        0xD7
+#define MKV_TEST_TRACK_TYPE_ID          0x83
+#define MKV_TEST_CODEC_PRIVATE_ID       0x63A2
+#define MKV_TEST_VIDEO_ID               0xE0
+#define MKV_TEST_CLUSTER_ID             0x1F43B675
+#define MKV_TEST_CLUSTER_TIMECODE_ID    0xE7
+#define MKV_TEST_SIMPLE_BLOCK_ID        0xA3
+
+/**
+ * EBML element as parsed by the tests
+ */
+typedef struct {
+    UINT64 id;
+    UINT64 size;
+    // Size of the element id and the size in bytes
+    UINT32 headerSize;
+    PBYTE pData;
+} EbmlElement, *PEbmlElement;
+
 /**
  * Callback function
  */
@@ -76,6 +101,88 @@ protected:
         return (PCHAR) ::testing::UnitTest::GetInstance()->current_test_info()->test_case_name();
     };
 
+    /**
+     * Reads an EBML variable size integer. The id keeps the length marker bits while the size doesn't.
+     * Returns the number of bytes read or 0 on an invalid integer.
+     */
+    UINT32 readEbmlInteger(PBYTE pBuffer, UINT32 size, BOOL keepMarker, PUINT64 pValue)
+    {
+        UINT32 length, i;
+        UINT64 value;
+
+        if (size == 0 || pBuffer[0] == 0) {
+            return 0;
+        }
+
+        for (length = 1; (pBuffer[0] & (0x80 >> (length - 1))) == 0; length++);
+        if (length > size) {
+            return 0;
+        }
+
+        value = keepMarker ? pBuffer[0] : pBuffer[0] & ((0x80 >> (length - 1)) - 1);
+        for (i = 1; i < length; i++) {
+            value = (value << 8) | pBuffer[i];
+        }
+
+        *pValue = value;
+        return length;
+    }
+
+    /**
+     * Parses the EBML elements of the buffer in order. The master elements are descended into
+     * so their children follow them in the list.
+     * Returns the number of the parsed elements.
+     */
+    UINT32 parseEbmlElements(PBYTE pBuffer, UINT32 size, PEbmlElement pElements, UINT32 maxCount)
+    {
+        UINT32 offset = 0, count = 0, idLength, sizeLength;
+        PEbmlElement pElement;
+
+        while (offset < size && count < maxCount) {
+            pElement = &pElements[count++];
+            idLength = readEbmlInteger(pBuffer + offset, size - offset, TRUE, &pElement->id);
+            EXPECT_NE(0, idLength);
+            sizeLength = readEbmlInteger(pBuffer + offset + idLength, size - offset - idLength, FALSE, &pElement->size);
+            EXPECT_NE(0, sizeLength);
+            if (idLength == 0 || sizeLength == 0) {
+                break;
+            }
+
+            pElement->headerSize = idLength + sizeLength;
+            pElement->pData = pBuffer + offset + pElement->headerSize;
+            offset += pElement->headerSize;
+
+            switch (pElement->id) {
+                case MKV_TEST_SEGMENT_ID:
+                case MKV_TEST_TRACKS_ID:
+                case MKV_TEST_TRACK_ENTRY_ID:
+                case MKV_TEST_VIDEO_ID:
+                case MKV_TEST_CLUSTER_ID:
+                    // Descend into the master element
+                    break;
+                default:
+                    offset += (UINT32) pElement->size;
+            }
+        }
+
+        EXPECT_EQ(size, offset);
+        return count;
+    }
+
+    /**
+     * Reads the big-endian unsigned integer payload of an element
+     */
+    UINT64 getEbmlUint(PEbmlElement pElement)
+    {
+        UINT64 value = 0, i;
+
+        for (i = 0; i < pElement->size; i++) {
+            value = (value << 8) | pElement->pData[i];
+        }
+
+        return value;
+    }
+
 
 private:
 
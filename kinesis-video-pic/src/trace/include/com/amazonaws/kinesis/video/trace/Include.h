@@ -59,13 +59,24 @@ typedef enum
      */
     FLAGS_USE_AIV_TRACE_PROFILER_FORMAT = 0x1 << 0,
 
+    /**
+     * Whether to format the traces as Chrome trace_event JSON which can be loaded in chrome://tracing or Perfetto
+     */
+    FLAGS_USE_CHROME_TRACE_PROFILER_FORMAT = 0x1 << 1,
+
+    /**
+     * Whether to store the traces in per-thread rings. Each thread writes to its own ring without taking
+     * the profiler lock and the rings are merged by the start time when the traces are formatted.
+     */
+    FLAGS_USE_PER_THREAD_TRACE_RINGS = 0x1 << 2,
+
 } TRACE_PROFILER_BEHAVIOR_FLAGS;
 
 
 /**
- * Format flags mask - currently only AIV format is supported - Binary OR any other flags in the future
+ * Format flags mask - Binary OR any other formats in the future
  */
-#define PROFILER_FORMAT_MASK (UINT32)FLAGS_USE_AIV_TRACE_PROFILER_FORMAT
+#define PROFILER_FORMAT_MASK (UINT32)(FLAGS_USE_AIV_TRACE_PROFILER_FORMAT | FLAGS_USE_CHROME_TRACE_PROFILER_FORMAT)
 
 /**
  * Trace levels enum - matches Android profiler implementation in com.amazon.avod.perf
@@ -101,6 +112,58 @@ typedef STATUS (*TraceStopFunc)(TRACE_PROFILER_HANDLE, TRACE_HANDLE);
 #define DEFINE_TRACE_START(name)            STATUS name(TRACE_PROFILER_HANDLE traceProfilerHandle, PCHAR traceName, TRACE_LEVEL traceLevel, PTRACE_HANDLE pTraceHandle)
 #define DEFINE_TRACE_STOP(name)             STATUS name(TRACE_PROFILER_HANDLE traceProfilerHandle, TRACE_HANDLE traceHandle)
 
+/**
+ * Trace started by the trace point macros. Records the profiler which has issued the trace handle so the trace
+ * is stopped by the same profiler even if the global profiler has been changed in the meantime.
+ */
+typedef struct
+{
+    /**
+     * Profiler which has issued the trace handle
+     */
+    TRACE_PROFILER_HANDLE traceProfilerHandle;
+
+    /**
+     * The trace handle
+     */
+    TRACE_HANDLE traceHandle;
+} ProfilerTrace, *PProfilerTrace;
+
+/**
+ * Initializer for the trace point traces so they can be stopped on any path
+ */
+#define PROFILER_TRACE_INITIALIZER          {INVALID_TRACE_PROFILER_HANDLE, INVALID_TRACE_HANDLE_VALUE}
+
+/**
+ * Process wide trace profiler used by the trace points in the SDK components. Invalid unless set by the application.
+ */
+extern volatile TRACE_PROFILER_HANDLE globalTraceProfiler;
+
+/**
+ * Trace point macros used in the SDK components. These are no-ops unless the global trace profiler is set.
+ * The global profiler is loaded once when the trace starts and the trace is stopped with the same profiler.
+ * The trace should be initialized with PROFILER_TRACE_INITIALIZER so it can be stopped on any path.
+ */
+#define PROFILER_TRACE_START(name, level, pProfilerTrace) \
+    do { \
+        (pProfilerTrace)->traceProfilerHandle = (TRACE_PROFILER_HANDLE) ATOMIC_LOAD(&globalTraceProfiler); \
+        if (IS_VALID_TRACE_PROFILER_HANDLE((pProfilerTrace)->traceProfilerHandle)) { \
+            traceStart((pProfilerTrace)->traceProfilerHandle, (PCHAR) (name), (level), &(pProfilerTrace)->traceHandle); \
+        } \
+    } while (FALSE)
+
+#define PROFILER_TRACE_STOP(profilerTrace) \
+    do { \
+        if (IS_VALID_TRACE_HANDLE((profilerTrace).traceHandle) && IS_VALID_TRACE_PROFILER_HANDLE((profilerTrace).traceProfilerHandle)) { \
+            traceStop((profilerTrace).traceProfilerHandle, (profilerTrace).traceHandle); \
+        } \
+    } while (FALSE)
+
+/**
+ * Releases the per-thread trace ring of the calling thread in the global trace profiler.
+ * Should be called by the SDK threads before they exit. This is a no-op unless the global trace profiler is set.
+ */
+#define PROFILER_TRACE_THREAD_EXIT()        releaseThreadTraceRing((TRACE_PROFILER_HANDLE) ATOMIC_LOAD(&globalTraceProfiler))
 
 //////////////////////////////////////////////////////////////////////////
 // Public functions
@@ -127,6 +190,19 @@ PUBLIC_API STATUS profilerInitialize(UINT32 bufferSize, TRACE_LEVEL traceLevel,
  */
 PUBLIC_API STATUS profilerRelease(TRACE_PROFILER_HANDLE traceProfilerHandle);
 
+/**
+ * Sets the process wide trace profiler used by the trace points in putFrame, getStreamData, the MKV packaging,
+ * the heap operations and the ACK handling. The profiler should be created with FLAGS_USE_PER_THREAD_TRACE_RINGS
+ * to avoid serializing the SDK threads on the profiler lock.
+ *
+ * IMPORTANT!!! Reset the global profiler with INVALID_TRACE_PROFILER_HANDLE and quiesce the SDK threads before releasing it.
+ *
+ * Parameters:
+ *
+ *      @traceProfilerHandle Trace profiler object or INVALID_TRACE_PROFILER_HANDLE to disable the trace points.
+ */
+PUBLIC_API STATUS setGlobalTraceProfiler(TRACE_PROFILER_HANDLE traceProfilerHandle);
+
 /**
  * Sets the profiling level - can be used for enabling/disabling.
  *
@@ -189,6 +265,24 @@ PUBLIC_API DEFINE_TRACE_START(traceStart);
  */
 PUBLIC_API DEFINE_TRACE_STOP(traceStop);
 
+/**
+ * Releases the per-thread trace ring of the calling thread so it can be claimed by another thread.
+ *
+ * The per-thread rings are claimed by the thread id on the first trace and only a fixed number of the rings is available.
+ * The threads which are not able to claim a ring have their traces dropped. A thread which exits without releasing its ring
+ * keeps it claimed and a new thread which gets the same thread id inherits the ring.
+ *
+ * The traces of the released ring are reported until the ring is claimed by another thread.
+ * This is a no-op if the profiler is invalid, doesn't use the per-thread rings or the calling thread doesn't own a ring.
+ *
+ * IMPORTANT!!! This should be called by the thread which owns the ring after its last trace has been stopped.
+ *
+ * Parameters:
+ *
+ *      @traceProfilerHandle Trace profiler object.
+ */
+PUBLIC_API STATUS releaseThreadTraceRing(TRACE_PROFILER_HANDLE traceProfilerHandle);
+
 /**
  * Including the headers
  */
@@ -30,6 +30,11 @@ extern "C" {
  */
 #define MAX_DECIMAL_UINT64_CHARS    21
 
+/**
+ * Max number of threads with their own trace rings. The traces from any other threads are dropped.
+ */
+#define MAX_TRACE_RING_COUNT        32
+
 /**
  * Aiv formatting delimiter
  */
@@ -37,6 +42,22 @@ extern "C" {
 #define AIV_FORMAT_LINE_DELIMITER '\n'
 #define AIV_TRACE_TYPE_NAME "trace"
 
+/**
+ * Chrome trace_event formatting. The traces are "complete" events with the timestamps in microseconds
+ * preceded by the thread name metadata events. The numeric fields are printed as unsigned long long
+ * as the thread id and UINT64 widths vary between the platforms.
+ */
+#define CHROME_TRACE_FORMAT_HEADER          "{\"traceEvents\":["
+#define CHROME_TRACE_FORMAT_FOOTER          "]}\n"
+#define CHROME_TRACE_FORMAT_THREAD_NAME     "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%llu,\"args\":{\"name\":\"%s\"}}"
+#define CHROME_TRACE_FORMAT_EVENT           "{\"name\":\"%s\",\"cat\":\"kvs\",\"ph\":\"X\",\"pid\":0,\"tid\":%llu,\"ts\":%llu,\"dur\":%llu}"
+
+/**
+ * Max size of the formatted Chrome events including the separating comma and the quoted names
+ */
+#define MAX_CHROME_TRACE_THREAD_NAME_SIZE   (SIZEOF(CHROME_TRACE_FORMAT_THREAD_NAME) + MAX_DECIMAL_UINT64_CHARS + MAX_THREAD_NAME + 1)
+#define MAX_CHROME_TRACE_EVENT_SIZE         (SIZEOF(CHROME_TRACE_FORMAT_EVENT) + 3 * MAX_DECIMAL_UINT64_CHARS + MAX_TRACE_NAME + 1)
+
 /**
  * Trace object declaration
  */
@@ -78,6 +99,81 @@ typedef struct
     UINT64 duration;
 } Trace, *PTrace;
 
+/**
+ * Trace stored in a per-thread ring. The thread id and name are stored once per ring.
+ */
+typedef struct
+{
+    /**
+     * Trace level which will be either included or excluded based upon the perf trace level
+     */
+    TRACE_LEVEL traceLevel;
+
+    /**
+     * Trace name - user specified.
+     */
+    CHAR traceName[MAX_TRACE_NAME];
+
+    /**
+     * Sequence number of the trace in the ring
+     */
+    UINT64 traceCount;
+
+    /**
+     * Timestamp of the beginning of the trace in epoch
+     */
+    UINT64 start;
+
+    /**
+     * Duration of the trace
+     */
+    UINT64 duration;
+} ThreadTrace, *PThreadTrace;
+
+/**
+ * Single writer trace ring owned by a thread.
+ *
+ * The ring is claimed by the thread on its first trace and is released with releaseThreadTraceRing before the thread exits.
+ *
+ * Only the owner thread writes the traces. The trace count is published with a release store after the trace
+ * has been written so the formatting can read the rings without stopping the writers. The traces which might
+ * have been overwritten while being read are discarded after re-reading the count.
+ */
+typedef struct
+{
+    /**
+     * Owner thread id. 0 if the ring is free. The rings are claimed and released under the profiler lock.
+     */
+    volatile TID threadId;
+
+    /**
+     * Id of the thread which has written the traces. Kept after the ring is released so the traces
+     * of the exited thread are reported until the ring is claimed by another thread.
+     */
+    TID traceThreadId;
+
+    /**
+     * Null terminated name of the thread which has written the traces. Written by the claiming thread under the profiler lock.
+     */
+    CHAR threadName[MAX_THREAD_NAME];
+
+    /**
+     * Number of traces written to the ring - wrapping will not affect this
+     */
+    volatile UINT64 traceCount;
+
+    /**
+     * Sequence number of the first trace of the current owner. The sequence numbers keep growing when the ring
+     * is claimed by another thread so the stale handles of the previous owner can't update the newer traces.
+     */
+    UINT64 firstTraceCount;
+
+    /**
+     * The ring traces
+     */
+    PThreadTrace traces;
+} TraceRing, *PTraceRing;
+
 //////////////////////////////////////////////////////////////////////
 // Main Profiler object
 //////////////////////////////////////////////////////////////////////
@@ -125,6 +221,21 @@ typedef struct
     TraceStartFunc traceStartFn;
     TraceStopFunc traceStopFn;
 
+    /**
+     * Per-thread rings. Set only if FLAGS_USE_PER_THREAD_TRACE_RINGS is specified in which case the trace buffer is not used.
+     */
+    PTraceRing traceRings;
+
+    /**
+     * Max number of traces that can be stored in each of the per-thread rings
+     */
+    UINT32 traceRingLength;
+
+    /**
+     * Number of traces dropped as all of the per-thread rings have been claimed
+     */
+    volatile UINT64 droppedTraceCount;
+
     /**
      * Trace buffer. It's a ring buffer. IMPORTANT! This will point to the end of the main structure
      */
@@ -142,20 +253,70 @@ typedef struct
 #define TRACE_HANDLE_TO_POINTER(h) ((PTrace) (h))
 #endif
 
-STATUS getAivFormattedTraceBuffer(PTraceProfiler pTraceProfiler, PCHAR* ppBuffer, PUINT32 pBufferSize, UINT32 traceCount, PTrace pCurTrace);
+/**
+ * The per-thread ring trace handles are made of the ring index and the trace sequence number in the ring
+ * so a stale handle can't update a newer trace which has overwritten it.
+ */
+#define THREAD_TRACE_HANDLE_SEQUENCE_BITS           48
+#define THREAD_TRACE_HANDLE_SEQUENCE_MASK           ((1ULL << THREAD_TRACE_HANDLE_SEQUENCE_BITS) - 1)
+#define MAKE_THREAD_TRACE_HANDLE(ringIndex, seq)    ((TRACE_HANDLE) (((UINT64) (ringIndex) << THREAD_TRACE_HANDLE_SEQUENCE_BITS) | ((seq) & THREAD_TRACE_HANDLE_SEQUENCE_MASK)))
+#define THREAD_TRACE_HANDLE_RING_INDEX(h)           ((UINT32) ((h) >> THREAD_TRACE_HANDLE_SEQUENCE_BITS))
+#define THREAD_TRACE_HANDLE_SEQUENCE(h)             ((h) & THREAD_TRACE_HANDLE_SEQUENCE_MASK)
+
+/**
+ * The formatters take a ring of traces given by its buffer, its end, the first trace and the number of traces
+ */
+STATUS getAivFormattedTraceBuffer(PTrace pTraceBuffer, PVOID pTraceBufferEnd, PCHAR* ppBuffer, PUINT32 pBufferSize, UINT32 traceCount, PTrace pCurTrace);
+STATUS getChromeFormattedTraceBuffer(PTrace pTraceBuffer, PVOID pTraceBufferEnd, PCHAR* ppBuffer, PUINT32 pBufferSize, UINT32 traceCount, PTrace pCurTrace);
+VOID copyChromeTraceName(PCHAR pDest, PCHAR pSrc, UINT32 maxSize);
 STATUS traceStartInternalWorker(TRACE_PROFILER_HANDLE traceProfilerHandle, PCHAR traceName, TRACE_LEVEL traceLevel, PTRACE_HANDLE pTraceHandle, TID threadId, PCHAR threadName, UINT64 currentTime);
 STATUS traceStopInternalWorker(TRACE_PROFILER_HANDLE traceProfilerHandle, TRACE_HANDLE traceHandle, UINT64 currentTime);
+
+/**
+ * Per-thread ring workers. Lock free - only the owner thread writes to its ring.
+ * The thread name is used only when the thread claims its ring. If NULL the name is queried for the thread id.
+ */
+STATUS traceStartThreadRingWorker(TRACE_PROFILER_HANDLE traceProfilerHandle, PCHAR traceName, TRACE_LEVEL traceLevel, PTRACE_HANDLE pTraceHandle, TID threadId, PCHAR threadName, UINT64 currentTime);
+STATUS traceStopThreadRingWorker(TRACE_PROFILER_HANDLE traceProfilerHandle, TRACE_HANDLE traceHandle, UINT64 currentTime);
+
+/**
+ * Returns the ring owned by the thread claiming a free one on the first call. The rings which have never been claimed
+ * are preferred over the released ones. Returns NULL if all of the rings are claimed.
+ */
+PTraceRing getThreadTraceRing(PTraceProfiler pTraceProfiler, TID threadId, PCHAR threadName);
+
+/**
+ * Releases the ring owned by the thread if any
+ */
+STATUS releaseThreadTraceRingWorker(PTraceProfiler pTraceProfiler, TID threadId);
+
+/**
+ * Merges the traces of the per-thread rings by the start time into an allocated array of traces.
+ * The returned array should be freed with MEMFREE.
+ */
+STATUS mergeThreadTraceRings(PTraceProfiler pTraceProfiler, PTrace* ppTraces, PUINT32 pTraceCount);
 /**
  * We define minimal trace profiler buffer size including auxiliary array of structures
  */
 #define MIN_TRACE_PROFILER_BUFFER_SIZE (SIZEOF(TraceProfiler) + MIN_TRACE_NUM * SIZEOF(Trace))
 
+/**
+ * Min buffer size with the per-thread trace rings
+ */
+#define MIN_THREAD_RING_PROFILER_BUFFER_SIZE (SIZEOF(TraceProfiler) + MAX_TRACE_RING_COUNT * (SIZEOF(TraceRing) + SIZEOF(ThreadTrace)))
+
 /**
  * Actual trace functions definitions
  */
 DEFINE_TRACE_START(traceStartInternal);
 DEFINE_TRACE_STOP(traceStopInternal);
 
+/**
+ * Per-thread ring trace functions definitions
+ */
+DEFINE_TRACE_START(traceStartThreadRing);
+DEFINE_TRACE_STOP(traceStopThreadRing);
+
 /**
  * No-op trace functions definitions
  */
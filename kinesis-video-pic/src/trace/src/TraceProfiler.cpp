@@ -10,6 +10,11 @@
  */
 MUTEX GLOBAL_PROFILER_MUTEX = GLOBAL_REENTRANT_MUTEX;
 
+/**
+ * Process wide profiler used by the SDK trace points
+ */
+volatile TRACE_PROFILER_HANDLE globalTraceProfiler = INVALID_TRACE_PROFILER_HANDLE;
+
 //////////////////////////////////////////////////////////////////////
 // Public functions
 //////////////////////////////////////////////////////////////////////
@@ -20,6 +25,8 @@ STATUS profilerInitialize(UINT32 bufferSize, TRACE_LEVEL traceLevel, TRACE_PROFI
     STATUS retStatus = STATUS_SUCCESS;
 
     PTraceProfiler pTraceProfiler = NULL;
+    PThreadTrace pThreadTraces;
+    UINT32 i;
 
     CHK(pTraceProfilerHandle != NULL, STATUS_NULL_ARG);
     CHK(bufferSize >= MIN_TRACE_PROFILER_BUFFER_SIZE, STATUS_MIN_PROFILER_BUFFER);
@@ -30,6 +37,10 @@ STATUS profilerInitialize(UINT32 bufferSize, TRACE_LEVEL traceLevel, TRACE_PROFI
     // Check that only single formatting is specified or none by checking whether the formats is a power of two
     CHK(CHECK_POWER_2(behaviorFlags & PROFILER_FORMAT_MASK), STATUS_INVALID_ARG);
 
+    // Each of the per-thread rings needs to hold at least a single trace
+    CHK((behaviorFlags & FLAGS_USE_PER_THREAD_TRACE_RINGS) == PROFILER_FLAGS_NONE ||
+        bufferSize >= MIN_THREAD_RING_PROFILER_BUFFER_SIZE, STATUS_MIN_PROFILER_BUFFER);
+
     DLOGS("Initializing native trace profiler with buffer size %u, trace level %u flags 0x%08x", bufferSize, traceLevel, behaviorFlags);
 
     // Calculate the overall size
@@ -52,6 +63,19 @@ STATUS profilerInitialize(UINT32 bufferSize, TRACE_LEVEL traceLevel, TRACE_PROFI
     // Set the next available trace at the start of the buffer
     pTraceProfiler->nextTrace = pTraceProfiler->traceBuffer;
 
+    // Carve the per-thread rings out of the trace buffer evenly
+    if ((behaviorFlags & FLAGS_USE_PER_THREAD_TRACE_RINGS) != PROFILER_FLAGS_NONE) {
+        pTraceProfiler->traceRings = (PTraceRing) pTraceProfiler->traceBuffer;
+        pThreadTraces = (PThreadTrace) (pTraceProfiler->traceRings + MAX_TRACE_RING_COUNT);
+        pTraceProfiler->traceRingLength = (UINT32) (((PBYTE) pTraceProfiler->traceBufferEnd - (PBYTE) pThreadTraces) / SIZEOF(ThreadTrace) / MAX_TRACE_RING_COUNT);
+
+        for (i = 0; i < MAX_TRACE_RING_COUNT; i++) {
+            pTraceProfiler->traceRings[i].traces = pThreadTraces + i * pTraceProfiler->traceRingLength;
+        }
+
+        DLOGS("Using %u per-thread trace rings with %u traces each", MAX_TRACE_RING_COUNT, pTraceProfiler->traceRingLength);
+    }
+
     // Set the profiler trace level
     setProfilerLevel(POINTER_TO_HANDLE(pTraceProfiler), traceLevel);
 
@@ -112,6 +136,9 @@ STATUS setProfilerLevel(TRACE_PROFILER_HANDLE traceProfilerHandle, TRACE_LEVEL t
     if (pTraceProfiler->traceLevel == TRACE_LEVEL_DISABLED) {
         pTraceProfiler->traceStartFn = traceStartNoop;
         pTraceProfiler->traceStopFn = traceStopNoop;
+    } else if (pTraceProfiler->traceRings != NULL) {
+        pTraceProfiler->traceStartFn = traceStartThreadRing;
+        pTraceProfiler->traceStopFn = traceStopThreadRing;
     } else {
         pTraceProfiler->traceStartFn = traceStartInternal;
         pTraceProfiler->traceStopFn = traceStopInternal;
@@ -135,7 +162,8 @@ STATUS getFormattedTraceBuffer(TRACE_PROFILER_HANDLE traceProfilerHandle, PCHAR*
     PTraceProfiler pTraceProfiler = NULL;
     UINT32 format;
     UINT32 numberOfTraces;
-    PTrace pCurTrace;
+    PTrace pCurTrace, pTraceBuffer, pMergedTraces = NULL;
+    PVOID pTraceBufferEnd;
 
     CHK(IS_VALID_TRACE_PROFILER_HANDLE(traceProfilerHandle), STATUS_INVALID_ARG);
     pTraceProfiler = TRACE_PROFILER_HANDLE_TO_POINTER(traceProfilerHandle);
@@ -149,7 +177,15 @@ STATUS getFormattedTraceBuffer(TRACE_PROFILER_HANDLE traceProfilerHandle, PCHAR*
     }
 
     // Calculate the size. Need to know the number of traces - whether we had wrapped around the buffer.
-    if (pTraceProfiler->traceCount < pTraceProfiler->traceBufferLength) {
+    pTraceBuffer = pTraceProfiler->traceBuffer;
+    pTraceBufferEnd = pTraceProfiler->traceBufferEnd;
+    if (pTraceProfiler->traceRings != NULL) {
+        // The merged per-thread rings are formatted as a single non-wrapping buffer
+        CHK_STATUS(mergeThreadTraceRings(pTraceProfiler, &pMergedTraces, &numberOfTraces));
+        pTraceBuffer = pMergedTraces;
+        pTraceBufferEnd = pMergedTraces + numberOfTraces;
+        pCurTrace = pMergedTraces;
+    } else if (pTraceProfiler->traceCount < pTraceProfiler->traceBufferLength) {
         numberOfTraces = pTraceProfiler->traceCount;
         pCurTrace = pTraceProfiler->traceBuffer;
     } else {
@@ -172,7 +208,13 @@ STATUS getFormattedTraceBuffer(TRACE_PROFILER_HANDLE traceProfilerHandle, PCHAR*
             // Deliberate fall-through to the AIV format
         case FLAGS_USE_AIV_TRACE_PROFILER_FORMAT:
 
-            CHK_STATUS(getAivFormattedTraceBuffer(pTraceProfiler, ppBuffer, pBufferSize, numberOfTraces, pCurTrace));
+            CHK_STATUS(getAivFormattedTraceBuffer(pTraceBuffer, pTraceBufferEnd, ppBuffer, pBufferSize, numberOfTraces, pCurTrace));
+
+            break;
+
+        case FLAGS_USE_CHROME_TRACE_PROFILER_FORMAT:
+
+            CHK_STATUS(getChromeFormattedTraceBuffer(pTraceBuffer, pTraceBufferEnd, ppBuffer, pBufferSize, numberOfTraces, pCurTrace));
 
             break;
         default:
@@ -180,6 +222,8 @@ STATUS getFormattedTraceBuffer(TRACE_PROFILER_HANDLE traceProfilerHandle, PCHAR*
     }
 
 CleanUp:
+    SAFE_MEMFREE(pMergedTraces);
+
     // Release the lock
     MUTEX_UNLOCK(GLOBAL_PROFILER_MUTEX);
 
@@ -187,6 +231,18 @@ CleanUp:
     return retStatus;
 }
 
+STATUS setGlobalTraceProfiler(TRACE_PROFILER_HANDLE traceProfilerHandle)
+{
+    // No locking is required
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    ATOMIC_STORE(&globalTraceProfiler, traceProfilerHandle);
+
+    LEAVES();
+    return retStatus;
+}
+
 STATUS freeTraceBuffer(PCHAR pBuffer)
 {
     // No locking is required
@@ -236,6 +292,22 @@ CleanUp:
     return retStatus;
 }
 
+STATUS releaseThreadTraceRing(TRACE_PROFILER_HANDLE traceProfilerHandle)
+{
+    // Locking is handled by the worker
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+
+    // The call is idempotent
+    CHK(IS_VALID_TRACE_PROFILER_HANDLE(traceProfilerHandle), STATUS_SUCCESS);
+
+    CHK_STATUS(releaseThreadTraceRingWorker(TRACE_PROFILER_HANDLE_TO_POINTER(traceProfilerHandle), GETTID()));
+
+CleanUp:
+    LEAVES();
+    return retStatus;
+}
+
 //////////////////////////////////////////////////////////////////////
 // Internal functions
 //////////////////////////////////////////////////////////////////////
@@ -358,6 +430,293 @@ CleanUp:
     return retStatus;
 }
 
+DEFINE_TRACE_START(traceStartThreadRing)
+{
+    // No locking is required - the thread writes only to its own ring
+    STATUS retStatus = STATUS_SUCCESS;
+
+    // The thread name is queried only when the thread claims its ring
+    CHK_STATUS(traceStartThreadRingWorker(traceProfilerHandle, traceName, traceLevel, pTraceHandle, GETTID(), NULL, GETTIME()));
+
+CleanUp:
+    return retStatus;
+}
+
+DEFINE_TRACE_STOP(traceStopThreadRing)
+{
+    // No locking is required
+    STATUS retStatus = STATUS_SUCCESS;
+
+    CHK_STATUS(traceStopThreadRingWorker(traceProfilerHandle, traceHandle, GETTIME()));
+
+CleanUp:
+    return retStatus;
+}
+
+PTraceRing getThreadTraceRing(PTraceProfiler pTraceProfiler, TID threadId, PCHAR threadName)
+{
+    UINT32 i;
+    TID ownerId;
+    BOOL freeRing = FALSE;
+    PTraceRing pTraceRing = NULL, pReleasedRing = NULL;
+
+    // Lock free lookup of the ring owned by the thread. Only the owner thread releases its ring.
+    for (i = 0; i < MAX_TRACE_RING_COUNT; i++) {
+        ownerId = ATOMIC_LOAD(&pTraceProfiler->traceRings[i].threadId);
+        if (ownerId == threadId) {
+            return &pTraceProfiler->traceRings[i];
+        }
+
+        freeRing = freeRing || ownerId == 0;
+    }
+
+    // Drop the traces of the threads without a ring without taking the lock
+    if (!freeRing) {
+        return NULL;
+    }
+
+    // Claim a ring under the lock which is also held while the rings are formatted
+    MUTEX_LOCK(GLOBAL_PROFILER_MUTEX);
+
+    // Prefer the rings which have never been claimed to keep reporting the traces of the exited threads
+    for (i = 0; i < MAX_TRACE_RING_COUNT && pTraceRing == NULL; i++) {
+        if (pTraceProfiler->traceRings[i].threadId == 0) {
+            if (pTraceProfiler->traceRings[i].traceCount == 0) {
+                pTraceRing = &pTraceProfiler->traceRings[i];
+            } else if (pReleasedRing == NULL) {
+                pReleasedRing = &pTraceProfiler->traceRings[i];
+            }
+        }
+    }
+
+    if (pTraceRing == NULL) {
+        pTraceRing = pReleasedRing;
+    }
+
+    if (pTraceRing != NULL) {
+        // Discard the traces of the previous owner
+        pTraceRing->firstTraceCount = pTraceRing->traceCount;
+        pTraceRing->traceThreadId = threadId;
+        if (threadName != NULL) {
+            STRNCPY(pTraceRing->threadName, threadName, MAX_THREAD_NAME);
+        } else if (STATUS_FAILED(GETTNAME(threadId, pTraceRing->threadName, MAX_THREAD_NAME))) {
+            pTraceRing->threadName[0] = '\0';
+        }
+
+        // Null terminate just in case
+        pTraceRing->threadName[MAX_THREAD_NAME - 1] = '\0';
+
+        ATOMIC_STORE(&pTraceRing->threadId, threadId);
+    }
+
+    MUTEX_UNLOCK(GLOBAL_PROFILER_MUTEX);
+
+    return pTraceRing;
+}
+
+STATUS releaseThreadTraceRingWorker(PTraceProfiler pTraceProfiler, TID threadId)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i;
+
+    // Nothing to release without the per-thread rings
+    CHK(pTraceProfiler->traceRings != NULL, STATUS_SUCCESS);
+
+    MUTEX_LOCK(GLOBAL_PROFILER_MUTEX);
+
+    for (i = 0; i < MAX_TRACE_RING_COUNT; i++) {
+        if (pTraceProfiler->traceRings[i].threadId == threadId) {
+            // The traces are kept and reported until the ring is claimed again
+            ATOMIC_STORE(&pTraceProfiler->traceRings[i].threadId, (TID) 0);
+            break;
+        }
+    }
+
+    MUTEX_UNLOCK(GLOBAL_PROFILER_MUTEX);
+
+CleanUp:
+    return retStatus;
+}
+
+STATUS traceStartThreadRingWorker(TRACE_PROFILER_HANDLE traceProfilerHandle, PCHAR traceName, TRACE_LEVEL traceLevel, PTRACE_HANDLE pTraceHandle, TID threadId, PCHAR threadName, UINT64 currentTime)
+{
+    // No locking is required
+    STATUS retStatus = STATUS_SUCCESS;
+    PTraceProfiler pTraceProfiler = NULL;
+    PTraceRing pTraceRing;
+    PThreadTrace pTrace;
+    UINT64 traceCount;
+
+    CHK(traceName != NULL && pTraceHandle != NULL, STATUS_NULL_ARG);
+    CHK(traceName[0] != '\0', STATUS_INVALID_ARG);
+
+    // Validate the profiler
+    CHK(IS_VALID_TRACE_PROFILER_HANDLE(traceProfilerHandle), STATUS_INVALID_ARG);
+    pTraceProfiler = TRACE_PROFILER_HANDLE_TO_POINTER(traceProfilerHandle);
+
+    // See if we need to do anything due to the trace level - Early return with success
+    *pTraceHandle = INVALID_TRACE_HANDLE_VALUE;
+    CHK(traceLevel <= pTraceProfiler->traceLevel, STATUS_SUCCESS);
+
+    // Drop the trace if the thread doesn't have a ring
+    pTraceRing = getThreadTraceRing(pTraceProfiler, threadId, threadName);
+    if (pTraceRing == NULL) {
+        ATOMIC_INCREMENT(&pTraceProfiler->droppedTraceCount);
+        CHK(FALSE, STATUS_SUCCESS);
+    }
+
+    // Only the owner thread modifies the count
+    traceCount = pTraceRing->traceCount;
+    pTrace = pTraceRing->traces + traceCount % pTraceProfiler->traceRingLength;
+
+    // Setup the trace
+    pTrace->duration = 0;
+    pTrace->traceCount = traceCount;
+    pTrace->start = currentTime;
+    pTrace->traceLevel = traceLevel;
+    STRNCPY(pTrace->traceName, traceName, MAX_TRACE_NAME);
+
+    // Null terminate just in case
+    pTrace->traceName[MAX_TRACE_NAME - 1] = '\0';
+
+    // Publish the trace
+    ATOMIC_STORE(&pTraceRing->traceCount, traceCount + 1);
+
+    // Set the return value
+    *pTraceHandle = MAKE_THREAD_TRACE_HANDLE(pTraceRing - pTraceProfiler->traceRings, traceCount);
+
+CleanUp:
+    return retStatus;
+}
+
+STATUS traceStopThreadRingWorker(TRACE_PROFILER_HANDLE traceProfilerHandle, TRACE_HANDLE traceHandle, UINT64 currentTime)
+{
+    // No locking is required
+    STATUS retStatus = STATUS_SUCCESS;
+    PTraceProfiler pTraceProfiler = NULL;
+    PTraceRing pTraceRing;
+    PThreadTrace pTrace;
+    UINT64 traceCount, sequence;
+
+    // Quick check for the no-op trace. Return success
+    CHK(IS_VALID_TRACE_HANDLE(traceHandle), STATUS_SUCCESS);
+
+    // Validate the profiler
+    CHK(IS_VALID_TRACE_PROFILER_HANDLE(traceProfilerHandle), STATUS_INVALID_ARG);
+    pTraceProfiler = TRACE_PROFILER_HANDLE_TO_POINTER(traceProfilerHandle);
+    CHK(THREAD_TRACE_HANDLE_RING_INDEX(traceHandle) < MAX_TRACE_RING_COUNT, STATUS_INVALID_ARG);
+
+    pTraceRing = &pTraceProfiler->traceRings[THREAD_TRACE_HANDLE_RING_INDEX(traceHandle)];
+    sequence = THREAD_TRACE_HANDLE_SEQUENCE(traceHandle);
+    traceCount = ATOMIC_LOAD(&pTraceRing->traceCount) & THREAD_TRACE_HANDLE_SEQUENCE_MASK;
+    CHK(traceCount > sequence, STATUS_INTERNAL_ERROR);
+
+    // Check if we have wrapped around already in which case we can't do anything about it
+    CHK(traceCount - sequence <= pTraceProfiler->traceRingLength, STATUS_SUCCESS);
+
+    // Set the duration
+    pTrace = pTraceRing->traces + sequence % pTraceProfiler->traceRingLength;
+    pTrace->duration = currentTime - pTrace->start;
+
+CleanUp:
+    return retStatus;
+}
+
+STATUS mergeThreadTraceRings(PTraceProfiler pTraceProfiler, PTrace* ppTraces, PUINT32 pTraceCount)
+{
+    // Locking has been handled in the public caller. The writers are not stopped.
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 i, j, ringIndex, totalCount = 0, mergedCount = 0;
+    UINT64 traceCount, firstTrace;
+    UINT64 firstTraces[MAX_TRACE_RING_COUNT];
+    UINT32 ringOffsets[MAX_TRACE_RING_COUNT];
+    UINT32 ringCounts[MAX_TRACE_RING_COUNT];
+    UINT32 ringPositions[MAX_TRACE_RING_COUNT];
+    PTrace pTraces = NULL, pTrace;
+    PThreadTrace pThreadTrace;
+    PTraceRing pTraceRing;
+
+    *ppTraces = NULL;
+    *pTraceCount = 0;
+
+    // Snapshot the ring counts. The rings can advance while being copied.
+    for (i = 0; i < MAX_TRACE_RING_COUNT; i++) {
+        traceCount = ATOMIC_LOAD(&pTraceProfiler->traceRings[i].traceCount);
+        firstTraces[i] = traceCount > pTraceProfiler->traceRingLength ? traceCount - pTraceProfiler->traceRingLength : 0;
+
+        // The rings are not claimed while being formatted. Skip the traces of the previous owner.
+        firstTraces[i] = MAX(firstTraces[i], pTraceProfiler->traceRings[i].firstTraceCount);
+        ringCounts[i] = (UINT32) (traceCount - firstTraces[i]);
+        ringPositions[i] = 0;
+        totalCount += ringCounts[i];
+    }
+
+    CHK(totalCount != 0, STATUS_SUCCESS);
+
+    // Copy the rings next to each other in the order of the sequence numbers
+    pTraces = (PTrace) MEMCALLOC(totalCount, SIZEOF(Trace));
+    CHK(pTraces != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    for (i = 0, pTrace = pTraces; i < MAX_TRACE_RING_COUNT; i++) {
+        pTraceRing = &pTraceProfiler->traceRings[i];
+        ringOffsets[i] = (UINT32) (pTrace - pTraces);
+        for (j = 0; j < ringCounts[i]; j++, pTrace++) {
+            pThreadTrace = pTraceRing->traces + (firstTraces[i] + j) % pTraceProfiler->traceRingLength;
+            pTrace->threadId = pTraceRing->traceThreadId;
+            STRNCPY(pTrace->threadName, pTraceRing->threadName, MAX_THREAD_NAME);
+            STRNCPY(pTrace->traceName, pThreadTrace->traceName, MAX_TRACE_NAME);
+            pTrace->traceName[MAX_TRACE_NAME - 1] = '\0';
+            pTrace->traceLevel = pThreadTrace->traceLevel;
+            pTrace->traceCount = (UINT32) pThreadTrace->traceCount;
+            pTrace->start = pThreadTrace->start;
+            pTrace->duration = pThreadTrace->duration;
+        }
+    }
+
+    // Skip the traces which might have been overwritten while being copied. The owner might be in the middle of
+    // writing the trace with the next sequence number which reuses the oldest copied slot.
+    MEMORY_BARRIER();
+    for (i = 0; i < MAX_TRACE_RING_COUNT; i++) {
+        traceCount = ATOMIC_LOAD(&pTraceProfiler->traceRings[i].traceCount);
+        firstTrace = traceCount >= pTraceProfiler->traceRingLength ? traceCount - pTraceProfiler->traceRingLength + 1 : 0;
+        if (firstTrace > firstTraces[i]) {
+            ringPositions[i] = (UINT32) MIN(firstTrace - firstTraces[i], ringCounts[i]);
+        }
+    }
+
+    // Merge the rings by the start time. Each of the rings is ordered by the start time already.
+    *ppTraces = (PTrace) MEMCALLOC(totalCount, SIZEOF(Trace));
+    CHK(*ppTraces != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    while (TRUE) {
+        ringIndex = MAX_TRACE_RING_COUNT;
+        for (i = 0; i < MAX_TRACE_RING_COUNT; i++) {
+            if (ringPositions[i] < ringCounts[i] &&
+                (ringIndex == MAX_TRACE_RING_COUNT ||
+                 pTraces[ringOffsets[i] + ringPositions[i]].start < pTraces[ringOffsets[ringIndex] + ringPositions[ringIndex]].start)) {
+                ringIndex = i;
+            }
+        }
+
+        if (ringIndex == MAX_TRACE_RING_COUNT) {
+            break;
+        }
+
+        (*ppTraces)[mergedCount++] = pTraces[ringOffsets[ringIndex] + ringPositions[ringIndex]++];
+    }
+
+    *pTraceCount = mergedCount;
+
+CleanUp:
+    SAFE_MEMFREE(pTraces);
+
+    if (STATUS_FAILED(retStatus) && ppTraces != NULL) {
+        SAFE_MEMFREE(*ppTraces);
+    }
+
+    return retStatus;
+}
+
 //////////////////////////////////////////////////////////////////////
 // Internal no-op functions. These are needed for faster/no-footprint operations
 // in cas the traces are disabled.
@@ -390,7 +749,7 @@ DEFINE_TRACE_STOP(traceStopNoop)
 /*
  * Formatting for AIV trace profiler
  */
-STATUS getAivFormattedTraceBuffer(PTraceProfiler pTraceProfiler, PCHAR* ppBuffer, PUINT32 pBufferSize, UINT32 traceCount, PTrace pCurTrace)
+STATUS getAivFormattedTraceBuffer(PTrace pTraceBuffer, PVOID pTraceBufferEnd, PCHAR* ppBuffer, PUINT32 pBufferSize, UINT32 traceCount, PTrace pCurTrace)
 {
     // Locking has been handled in the public caller
     STATUS retStatus = STATUS_SUCCESS;
@@ -421,8 +780,8 @@ STATUS getAivFormattedTraceBuffer(PTraceProfiler pTraceProfiler, PCHAR* ppBuffer
     for (i = 0; i < traceCount; i++) {
 
         // Handle the wrapping
-        if ((PBYTE) pCurTrace + SIZEOF(Trace) > (PBYTE) pTraceProfiler->traceBufferEnd) {
-            pCurTrace = pTraceProfiler->traceBuffer;
+        if ((PBYTE) pCurTrace + SIZEOF(Trace) > (PBYTE) pTraceBufferEnd) {
+            pCurTrace = pTraceBuffer;
         }
 
         // Add the trace type
@@ -489,3 +848,94 @@ CleanUp:
 
     return retStatus;
 }
+
+/**
+ * Copies the name replacing the chars which would need escaping in a JSON string
+ */
+VOID copyChromeTraceName(PCHAR pDest, PCHAR pSrc, UINT32 maxSize)
+{
+    UINT32 i;
+
+    for (i = 0; i < maxSize - 1 && pSrc[i] != '\0'; i++) {
+        pDest[i] = (pSrc[i] == '"' || pSrc[i] == '\\' || (UINT8) pSrc[i] < 0x20) ? '_' : pSrc[i];
+    }
+
+    pDest[i] = '\0';
+}
+
+STATUS getChromeFormattedTraceBuffer(PTrace pTraceBuffer, PVOID pTraceBufferEnd, PCHAR* ppBuffer, PUINT32 pBufferSize, UINT32 traceCount, PTrace pCurTrace)
+{
+    // Locking has been handled in the public caller
+    STATUS retStatus = STATUS_SUCCESS;
+
+    UINT32 i, j, threadCount = 0;
+    UINT32 allocationSize;
+    PCHAR pBuffer = NULL;
+    PCHAR pCurChar;
+    TID threadIds[MAX_TRACE_RING_COUNT];
+    CHAR name[MAX_TRACE_NAME];
+    CHAR threadName[MAX_THREAD_NAME];
+
+    // Check if we need to do anything
+    CHK(traceCount != 0, STATUS_SUCCESS);
+
+    // Each of the traces might need a thread name metadata event
+    allocationSize = SIZEOF(CHROME_TRACE_FORMAT_HEADER) +
+            traceCount * (MAX_CHROME_TRACE_EVENT_SIZE + MAX_CHROME_TRACE_THREAD_NAME_SIZE) +
+            SIZEOF(CHROME_TRACE_FORMAT_FOOTER);
+
+    pBuffer = (PCHAR) MEMALLOC(allocationSize);
+    CHK(pBuffer != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    STRCPY(pBuffer, CHROME_TRACE_FORMAT_HEADER);
+    pCurChar = pBuffer + STRLEN(CHROME_TRACE_FORMAT_HEADER);
+
+    for (i = 0; i < traceCount; i++) {
+
+        // Handle the wrapping
+        if ((PBYTE) pCurTrace + SIZEOF(Trace) > (PBYTE) pTraceBufferEnd) {
+            pCurTrace = pTraceBuffer;
+        }
+
+        // Name the thread on its first trace. The thread is named again if there are too many threads to track.
+        for (j = 0; j < threadCount && threadIds[j] != pCurTrace->threadId; j++);
+        if (j == threadCount) {
+            if (threadCount < MAX_TRACE_RING_COUNT) {
+                threadIds[threadCount++] = pCurTrace->threadId;
+            }
+
+            copyChromeTraceName(threadName, pCurTrace->threadName, MAX_THREAD_NAME);
+            pCurChar += SNPRINTF(pCurChar, MAX_CHROME_TRACE_THREAD_NAME_SIZE, "%s" CHROME_TRACE_FORMAT_THREAD_NAME,
+                                 pCurChar[-1] == '[' ? "" : ",", (unsigned long long) pCurTrace->threadId, threadName);
+        }
+
+        // The Chrome format is in microseconds
+        copyChromeTraceName(name, pCurTrace->traceName, MAX_TRACE_NAME);
+        pCurChar += SNPRINTF(pCurChar, MAX_CHROME_TRACE_EVENT_SIZE, "%s" CHROME_TRACE_FORMAT_EVENT,
+                             pCurChar[-1] == '[' ? "" : ",", name, (unsigned long long) pCurTrace->threadId,
+                             (unsigned long long) (pCurTrace->start / HUNDREDS_OF_NANOS_IN_A_MICROSECOND),
+                             (unsigned long long) (pCurTrace->duration / HUNDREDS_OF_NANOS_IN_A_MICROSECOND));
+
+        // Iterate the trace
+        pCurTrace++;
+    }
+
+    STRCPY(pCurChar, CHROME_TRACE_FORMAT_FOOTER);
+    pCurChar += STRLEN(CHROME_TRACE_FORMAT_FOOTER);
+
+    // Set the return buffer pointer
+    *ppBuffer = pBuffer;
+
+    // Set the actual buffer size
+    if (pBufferSize != NULL) {
+        *pBufferSize = (UINT32) (pCurChar - pBuffer);
+    }
+
+CleanUp:
+
+    if (STATUS_FAILED(retStatus)) {
+        SAFE_MEMFREE(pBuffer);
+    }
+
+    return retStatus;
+}
@@ -0,0 +1,367 @@
+#include "TraceTestFixture.h"
+
+#define TEST_RING_LENGTH                10
+#define TEST_RING_PROFILER_BUFFER_SIZE  (SIZEOF(TraceProfiler) + MAX_TRACE_RING_COUNT * (SIZEOF(TraceRing) + TEST_RING_LENGTH * SIZEOF(ThreadTrace)))
+#define CONTENTION_THREAD_COUNT         8
+#define CONTENTION_TRACE_COUNT          200000
+#define CONTENTION_PROFILER_BUFFER_SIZE (1024 * 1024)
+
+class TraceThreadRingTest : public TraceTestBase {
+protected:
+    static PVOID contentionRoutine(PVOID arg)
+    {
+        TRACE_PROFILER_HANDLE handle = (TRACE_PROFILER_HANDLE) arg;
+        TRACE_HANDLE traceHandle;
+        UINT32 i;
+
+        for (i = 0; i < CONTENTION_TRACE_COUNT; i++) {
+            traceStart(handle, "Contention", TRACE_LEVEL_CRITICAL, &traceHandle);
+            traceStop(handle, traceHandle);
+        }
+
+        return NULL;
+    }
+
+    static PVOID releasingRoutine(PVOID arg)
+    {
+        TRACE_PROFILER_HANDLE handle = (TRACE_PROFILER_HANDLE) arg;
+        TRACE_HANDLE traceHandle;
+
+        EXPECT_TRUE(STATUS_SUCCEEDED(traceStart(handle, "Releasing", TRACE_LEVEL_CRITICAL, &traceHandle)));
+        EXPECT_TRUE(IS_VALID_TRACE_HANDLE(traceHandle));
+        EXPECT_TRUE(STATUS_SUCCEEDED(traceStop(handle, traceHandle)));
+        EXPECT_TRUE(STATUS_SUCCEEDED(releaseThreadTraceRing(handle)));
+
+        return NULL;
+    }
+
+    /**
+     * Runs the traces from multiple threads and returns the time per trace in nanoseconds
+     */
+    UINT64 runContention(TRACE_PROFILER_BEHAVIOR_FLAGS behaviorFlags)
+    {
+        TRACE_PROFILER_HANDLE handle;
+        pthread_t threads[CONTENTION_THREAD_COUNT];
+        UINT32 i;
+        UINT64 start;
+
+        EXPECT_TRUE(STATUS_SUCCEEDED(profilerInitialize(CONTENTION_PROFILER_BUFFER_SIZE, TRACE_LEVEL_INFO, behaviorFlags, &handle)));
+
+        start = GETTIME();
+        for (i = 0; i < CONTENTION_THREAD_COUNT; i++) {
+            EXPECT_EQ(0, pthread_create(&threads[i], NULL, contentionRoutine, (PVOID) handle));
+        }
+
+        for (i = 0; i < CONTENTION_THREAD_COUNT; i++) {
+            EXPECT_EQ(0, pthread_join(threads[i], NULL));
+        }
+
+        start = GETTIME() - start;
+        EXPECT_TRUE(STATUS_SUCCEEDED(profilerRelease(handle)));
+
+        return start * DEFAULT_TIME_UNIT_IN_NANOS / (CONTENTION_THREAD_COUNT * CONTENTION_TRACE_COUNT);
+    }
+};
+
+TEST_F(TraceThreadRingTest, ThreadRing_InvalidInput)
+{
+    TRACE_PROFILER_HANDLE handle;
+
+    EXPECT_EQ(STATUS_MIN_PROFILER_BUFFER, profilerInitialize(MIN_TRACE_PROFILER_BUFFER_SIZE - 1, TRACE_LEVEL_INFO, FLAGS_USE_PER_THREAD_TRACE_RINGS, &handle));
+    EXPECT_EQ(STATUS_INVALID_ARG, profilerInitialize(TEST_RING_PROFILER_BUFFER_SIZE, TRACE_LEVEL_INFO,
+                                                     (TRACE_PROFILER_BEHAVIOR_FLAGS) (FLAGS_USE_AIV_TRACE_PROFILER_FORMAT | FLAGS_USE_CHROME_TRACE_PROFILER_FORMAT),
+                                                     &handle));
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerInitialize(TEST_RING_PROFILER_BUFFER_SIZE, TRACE_LEVEL_INFO, FLAGS_USE_PER_THREAD_TRACE_RINGS, &handle)));
+    EXPECT_EQ(TEST_RING_LENGTH, TRACE_PROFILER_HANDLE_TO_POINTER(handle)->traceRingLength);
+
+    // Stop of a trace which hasn't been started yet or from a non-existing ring
+    EXPECT_EQ(STATUS_INTERNAL_ERROR, traceStopThreadRingWorker(handle, MAKE_THREAD_TRACE_HANDLE(0, 0), 0));
+    EXPECT_EQ(STATUS_INVALID_ARG, traceStopThreadRingWorker(handle, MAKE_THREAD_TRACE_HANDLE(MAX_TRACE_RING_COUNT, 0), 0));
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerRelease(handle)));
+}
+
+TEST_F(TraceThreadRingTest, ThreadRing_WrapAndStaleHandles)
+{
+    TRACE_PROFILER_HANDLE handle;
+    TRACE_HANDLE traceHandles[TEST_RING_LENGTH + 1];
+    PTraceRing pTraceRing;
+    UINT32 i;
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerInitialize(TEST_RING_PROFILER_BUFFER_SIZE, TRACE_LEVEL_INFO, FLAGS_USE_PER_THREAD_TRACE_RINGS, &handle)));
+    pTraceRing = TRACE_PROFILER_HANDLE_TO_POINTER(handle)->traceRings;
+
+    for (i = 0; i < TEST_RING_LENGTH + 1; i++) {
+        EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "Test trace name", TRACE_LEVEL_CRITICAL, &traceHandles[i], 100, "ThreadName", i * 100)));
+        EXPECT_EQ(MAKE_THREAD_TRACE_HANDLE(0, i), traceHandles[i]);
+    }
+
+    EXPECT_EQ(100, pTraceRing->threadId);
+    EXPECT_STREQ("ThreadName", pTraceRing->threadName);
+    EXPECT_EQ(TEST_RING_LENGTH + 1, pTraceRing->traceCount);
+
+    // The first trace has been overwritten by the last one which mustn't be affected by the stale handle
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStopThreadRingWorker(handle, traceHandles[0], 5000)));
+    EXPECT_EQ(0, pTraceRing->traces[0].duration);
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStopThreadRingWorker(handle, traceHandles[TEST_RING_LENGTH], 5000)));
+    EXPECT_EQ(5000 - TEST_RING_LENGTH * 100, pTraceRing->traces[0].duration);
+
+    // Lower priority traces are not recorded
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "Test trace name", TRACE_LEVEL_VERBOSE, &traceHandles[0], 100, "ThreadName", 0)));
+    EXPECT_EQ(INVALID_TRACE_HANDLE_VALUE, traceHandles[0]);
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStopThreadRingWorker(handle, traceHandles[0], 0)));
+    EXPECT_EQ(TEST_RING_LENGTH + 1, pTraceRing->traceCount);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerRelease(handle)));
+}
+
+TEST_F(TraceThreadRingTest, ThreadRing_MergedInStartOrder)
+{
+    TRACE_PROFILER_HANDLE handle;
+    TRACE_HANDLE traceHandle;
+    PCHAR pBuffer;
+    UINT32 bufferSize, i;
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerInitialize(TEST_RING_PROFILER_BUFFER_SIZE, TRACE_LEVEL_INFO,
+                                                    (TRACE_PROFILER_BEHAVIOR_FLAGS) (FLAGS_USE_PER_THREAD_TRACE_RINGS | FLAGS_USE_AIV_TRACE_PROFILER_FORMAT),
+                                                    &handle)));
+
+    // Nothing to format
+    EXPECT_TRUE(STATUS_SUCCEEDED(getFormattedTraceBuffer(handle, &pBuffer, &bufferSize)));
+    EXPECT_TRUE(pBuffer == NULL);
+    EXPECT_EQ(0, bufferSize);
+
+    // Interleave the traces of three threads. The first thread wraps its ring. The oldest trace of the wrapped ring
+    // is skipped as it might be getting overwritten by the owner at the time of the export.
+    for (i = 0; i < TEST_RING_LENGTH + 2; i++) {
+        EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "A", TRACE_LEVEL_CRITICAL, &traceHandle, 1, "First",
+                                                                (3 * i) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)));
+        EXPECT_TRUE(STATUS_SUCCEEDED(traceStopThreadRingWorker(handle, traceHandle, (3 * i + 1) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)));
+    }
+
+    for (i = 0; i < 2; i++) {
+        EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "B", TRACE_LEVEL_CRITICAL, &traceHandle, 2, "Second",
+                                                                (3 * (TEST_RING_LENGTH - 1 + i) + 1) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)));
+        EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "C", TRACE_LEVEL_CRITICAL, &traceHandle, 3, "Third",
+                                                                (3 * (TEST_RING_LENGTH - 1 + i) + 2) * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)));
+    }
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(getFormattedTraceBuffer(handle, &pBuffer, &bufferSize)));
+    EXPECT_EQ(0, STRNCMP("trace,A,First,1,9,1\n"
+                         "trace,A,First,1,12,1\n"
+                         "trace,A,First,1,15,1\n"
+                         "trace,A,First,1,18,1\n"
+                         "trace,A,First,1,21,1\n"
+                         "trace,A,First,1,24,1\n"
+                         "trace,A,First,1,27,1\n"
+                         "trace,B,Second,2,28,0\n"
+                         "trace,C,Third,3,29,0\n"
+                         "trace,A,First,1,30,1\n"
+                         "trace,B,Second,2,31,0\n"
+                         "trace,C,Third,3,32,0\n"
+                         "trace,A,First,1,33,1\n", pBuffer, bufferSize));
+    EXPECT_TRUE(STATUS_SUCCEEDED(freeTraceBuffer(pBuffer)));
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerRelease(handle)));
+}
+
+TEST_F(TraceThreadRingTest, ThreadRing_ChromeFormat)
+{
+    TRACE_PROFILER_HANDLE handle;
+    TRACE_HANDLE traceHandle;
+    PCHAR pBuffer;
+    UINT32 bufferSize;
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerInitialize(TEST_RING_PROFILER_BUFFER_SIZE, TRACE_LEVEL_INFO,
+                                                    (TRACE_PROFILER_BEHAVIOR_FLAGS) (FLAGS_USE_PER_THREAD_TRACE_RINGS | FLAGS_USE_CHROME_TRACE_PROFILER_FORMAT),
+                                                    &handle)));
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "putFrame", TRACE_LEVEL_CRITICAL, &traceHandle, 10, "Producer", 1000)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStopThreadRingWorker(handle, traceHandle, 1500)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "Quoted \"name\"", TRACE_LEVEL_CRITICAL, &traceHandle, 20, "Net\\work", 2000)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStopThreadRingWorker(handle, traceHandle, 2020)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "putFrame", TRACE_LEVEL_CRITICAL, &traceHandle, 10, "Producer", 3000)));
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(getFormattedTraceBuffer(handle, &pBuffer, &bufferSize)));
+    EXPECT_EQ(0, STRNCMP("{\"traceEvents\":["
+                         "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":10,\"args\":{\"name\":\"Producer\"}},"
+                         "{\"name\":\"putFrame\",\"cat\":\"kvs\",\"ph\":\"X\",\"pid\":0,\"tid\":10,\"ts\":100,\"dur\":50},"
+                         "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":20,\"args\":{\"name\":\"Net_work\"}},"
+                         "{\"name\":\"Quoted _name_\",\"cat\":\"kvs\",\"ph\":\"X\",\"pid\":0,\"tid\":20,\"ts\":200,\"dur\":2},"
+                         "{\"name\":\"putFrame\",\"cat\":\"kvs\",\"ph\":\"X\",\"pid\":0,\"tid\":10,\"ts\":300,\"dur\":0}"
+                         "]}\n", pBuffer, bufferSize));
+    EXPECT_EQ(STRLEN(pBuffer), bufferSize);
+    EXPECT_TRUE(STATUS_SUCCEEDED(freeTraceBuffer(pBuffer)));
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerRelease(handle)));
+}
+
+TEST_F(TraceThreadRingTest, ThreadRing_DroppedWhenOutOfRings)
+{
+    TRACE_PROFILER_HANDLE handle;
+    TRACE_HANDLE traceHandle;
+    PTraceProfiler pTraceProfiler;
+    UINT32 i;
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerInitialize(TEST_RING_PROFILER_BUFFER_SIZE, TRACE_LEVEL_INFO, FLAGS_USE_PER_THREAD_TRACE_RINGS, &handle)));
+    pTraceProfiler = TRACE_PROFILER_HANDLE_TO_POINTER(handle);
+
+    for (i = 0; i < MAX_TRACE_RING_COUNT; i++) {
+        EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "Test trace name", TRACE_LEVEL_CRITICAL, &traceHandle, 100 + i, "ThreadName", 0)));
+        EXPECT_EQ(MAKE_THREAD_TRACE_HANDLE(i, 0), traceHandle);
+    }
+
+    // No more rings for the new thread but the existing threads keep tracing
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "Test trace name", TRACE_LEVEL_CRITICAL, &traceHandle, 1000, "ThreadName", 0)));
+    EXPECT_EQ(INVALID_TRACE_HANDLE_VALUE, traceHandle);
+    EXPECT_EQ(1, pTraceProfiler->droppedTraceCount);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "Test trace name", TRACE_LEVEL_CRITICAL, &traceHandle, 100, "ThreadName", 0)));
+    EXPECT_EQ(MAKE_THREAD_TRACE_HANDLE(0, 1), traceHandle);
+    EXPECT_EQ(1, pTraceProfiler->droppedTraceCount);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerRelease(handle)));
+}
+
+TEST_F(TraceThreadRingTest, ThreadRing_ReleasedRingReclaimed)
+{
+    TRACE_PROFILER_HANDLE handle;
+    TRACE_HANDLE traceHandle, staleHandle;
+    PTraceProfiler pTraceProfiler;
+    PCHAR pBuffer;
+    UINT32 bufferSize, i;
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerInitialize(TEST_RING_PROFILER_BUFFER_SIZE, TRACE_LEVEL_INFO,
+                                                    (TRACE_PROFILER_BEHAVIOR_FLAGS) (FLAGS_USE_PER_THREAD_TRACE_RINGS | FLAGS_USE_AIV_TRACE_PROFILER_FORMAT),
+                                                    &handle)));
+    pTraceProfiler = TRACE_PROFILER_HANDLE_TO_POINTER(handle);
+
+    // Releasing a ring which the thread doesn't own is a no-op
+    EXPECT_TRUE(STATUS_SUCCEEDED(releaseThreadTraceRingWorker(pTraceProfiler, 100)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(releaseThreadTraceRing(INVALID_TRACE_PROFILER_HANDLE)));
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "A", TRACE_LEVEL_CRITICAL, &staleHandle, 100, "First", 10 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStopThreadRingWorker(handle, staleHandle, 11 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(releaseThreadTraceRingWorker(pTraceProfiler, 100)));
+    EXPECT_EQ(0, pTraceProfiler->traceRings[0].threadId);
+
+    // The same thread id claims an unused ring rather than inheriting its released ring
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "B", TRACE_LEVEL_CRITICAL, &traceHandle, 100, "Reused", 20 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)));
+    EXPECT_EQ(MAKE_THREAD_TRACE_HANDLE(1, 0), traceHandle);
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStopThreadRingWorker(handle, traceHandle, 22 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)));
+
+    // The traces of the released ring are still reported
+    EXPECT_TRUE(STATUS_SUCCEEDED(getFormattedTraceBuffer(handle, &pBuffer, &bufferSize)));
+    EXPECT_EQ(0, STRNCMP("trace,A,First,100,10,1\n"
+                         "trace,B,Reused,100,20,2\n", pBuffer, bufferSize));
+    EXPECT_TRUE(STATUS_SUCCEEDED(freeTraceBuffer(pBuffer)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(releaseThreadTraceRingWorker(pTraceProfiler, 100)));
+
+    // Claim the rest of the rings. The released rings are claimed last.
+    for (i = 2; i < MAX_TRACE_RING_COUNT; i++) {
+        EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "C", TRACE_LEVEL_CRITICAL, &traceHandle, 200 + i, "Other", 0)));
+        EXPECT_EQ(MAKE_THREAD_TRACE_HANDLE(i, 0), traceHandle);
+    }
+
+    // The released rings are reclaimed and their traces discarded instead of dropping the traces of the new threads
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "D", TRACE_LEVEL_CRITICAL, &traceHandle, 300, "Reclaimed", 30 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)));
+    EXPECT_EQ(MAKE_THREAD_TRACE_HANDLE(0, 1), traceHandle);
+    EXPECT_EQ(300, pTraceProfiler->traceRings[0].traceThreadId);
+    EXPECT_STREQ("Reclaimed", pTraceProfiler->traceRings[0].threadName);
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "E", TRACE_LEVEL_CRITICAL, &traceHandle, 301, "Reclaimed", 40 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)));
+    EXPECT_EQ(MAKE_THREAD_TRACE_HANDLE(1, 1), traceHandle);
+    EXPECT_EQ(0, pTraceProfiler->droppedTraceCount);
+
+    // The stale handle of the previous owner doesn't update the trace of the new owner
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStopThreadRingWorker(handle, staleHandle, 50 * HUNDREDS_OF_NANOS_IN_A_MILLISECOND)));
+    EXPECT_EQ(0, pTraceProfiler->traceRings[0].traces[1].duration);
+
+    // All of the rings are claimed
+    EXPECT_TRUE(STATUS_SUCCEEDED(traceStartThreadRingWorker(handle, "F", TRACE_LEVEL_CRITICAL, &traceHandle, 302, "Dropped", 0)));
+    EXPECT_EQ(INVALID_TRACE_HANDLE_VALUE, traceHandle);
+    EXPECT_EQ(1, pTraceProfiler->droppedTraceCount);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerRelease(handle)));
+}
+
+TEST_F(TraceThreadRingTest, ThreadRing_ExitedThreadsReleaseRings)
+{
+    TRACE_PROFILER_HANDLE handle;
+    pthread_t thread;
+    UINT32 i;
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerInitialize(TEST_RING_PROFILER_BUFFER_SIZE, TRACE_LEVEL_INFO, FLAGS_USE_PER_THREAD_TRACE_RINGS, &handle)));
+
+    // More threads than the rings tracing one after another
+    for (i = 0; i < 2 * MAX_TRACE_RING_COUNT; i++) {
+        EXPECT_EQ(0, pthread_create(&thread, NULL, releasingRoutine, (PVOID) handle));
+        EXPECT_EQ(0, pthread_join(thread, NULL));
+    }
+
+    EXPECT_EQ(0, TRACE_PROFILER_HANDLE_TO_POINTER(handle)->droppedTraceCount);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerRelease(handle)));
+}
+
+TEST_F(TraceThreadRingTest, ThreadRing_TracePointStoppedByIssuingProfiler)
+{
+    TRACE_PROFILER_HANDLE handle, otherHandle;
+    ProfilerTrace profilerTrace = PROFILER_TRACE_INITIALIZER;
+    PTraceRing pTraceRing;
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerInitialize(TEST_RING_PROFILER_BUFFER_SIZE, TRACE_LEVEL_INFO, FLAGS_USE_PER_THREAD_TRACE_RINGS, &handle)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerInitialize(TEST_RING_PROFILER_BUFFER_SIZE, TRACE_LEVEL_INFO, FLAGS_USE_PER_THREAD_TRACE_RINGS, &otherHandle)));
+    pTraceRing = TRACE_PROFILER_HANDLE_TO_POINTER(handle)->traceRings;
+
+    // Nothing is traced without the global profiler
+    PROFILER_TRACE_START("TracePoint", TRACE_LEVEL_INFO, &profilerTrace);
+    EXPECT_EQ(INVALID_TRACE_PROFILER_HANDLE, profilerTrace.traceProfilerHandle);
+    EXPECT_EQ(INVALID_TRACE_HANDLE_VALUE, profilerTrace.traceHandle);
+    PROFILER_TRACE_STOP(profilerTrace);
+
+    // The trace is stopped by the profiler which has started it after the global profiler has changed
+    EXPECT_TRUE(STATUS_SUCCEEDED(setGlobalTraceProfiler(handle)));
+    PROFILER_TRACE_START("TracePoint", TRACE_LEVEL_INFO, &profilerTrace);
+    EXPECT_EQ(handle, profilerTrace.traceProfilerHandle);
+    EXPECT_EQ(MAKE_THREAD_TRACE_HANDLE(0, 0), profilerTrace.traceHandle);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(setGlobalTraceProfiler(otherHandle)));
+    usleep(1000);
+    PROFILER_TRACE_STOP(profilerTrace);
+    EXPECT_LT(0, pTraceRing->traces[0].duration);
+    EXPECT_EQ(0, TRACE_PROFILER_HANDLE_TO_POINTER(otherHandle)->traceRings->traceCount);
+
+    // The thread exit releases the ring in the global profiler only
+    PROFILER_TRACE_THREAD_EXIT();
+    EXPECT_NE(0, pTraceRing->threadId);
+    EXPECT_TRUE(STATUS_SUCCEEDED(setGlobalTraceProfiler(handle)));
+    PROFILER_TRACE_THREAD_EXIT();
+    EXPECT_EQ(0, pTraceRing->threadId);
+
+    EXPECT_TRUE(STATUS_SUCCEEDED(setGlobalTraceProfiler(INVALID_TRACE_PROFILER_HANDLE)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerRelease(handle)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerRelease(otherHandle)));
+}
+
+TEST_F(TraceThreadRingTest, ThreadRing_ContentionBenchmark)
+{
+    UINT64 sharedTime, ringTime;
+    TRACE_PROFILER_HANDLE handle;
+    PCHAR pBuffer;
+    UINT32 bufferSize;
+
+    sharedTime = runContention(FLAGS_USE_AIV_TRACE_PROFILER_FORMAT);
+    ringTime = runContention((TRACE_PROFILER_BEHAVIOR_FLAGS) (FLAGS_USE_PER_THREAD_TRACE_RINGS | FLAGS_USE_AIV_TRACE_PROFILER_FORMAT));
+
+    DLOGI("%u threads tracing %u times each. Shared locked buffer: %" PRIu64 " ns per trace. Per-thread rings: %" PRIu64 " ns per trace",
+          CONTENTION_THREAD_COUNT, CONTENTION_TRACE_COUNT, sharedTime, ringTime);
+
+    // The rings of the finished threads are exported
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerInitialize(CONTENTION_PROFILER_BUFFER_SIZE, TRACE_LEVEL_INFO, FLAGS_USE_PER_THREAD_TRACE_RINGS, &handle)));
+    contentionRoutine((PVOID) handle);
+    EXPECT_TRUE(STATUS_SUCCEEDED(getFormattedTraceBuffer(handle, &pBuffer, &bufferSize)));
+    EXPECT_TRUE(pBuffer != NULL && bufferSize != 0);
+    EXPECT_TRUE(STATUS_SUCCEEDED(freeTraceBuffer(pBuffer)));
+    EXPECT_TRUE(STATUS_SUCCEEDED(profilerRelease(handle)));
+}
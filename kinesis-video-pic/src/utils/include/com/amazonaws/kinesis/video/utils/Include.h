@@ -122,6 +122,11 @@ PUBLIC_API STATUS removeDirectory(PCHAR);
  */
 PUBLIC_API STATUS getDirectorySize(PCHAR, PUINT64);
 
+/**
+ * Pool of the list nodes with an intrusive free list. Defined internally.
+ */
+typedef struct __NodePool NodePool, *PNodePool;
+
 /**
  * Double-linked list definition
  */
@@ -135,6 +140,7 @@ typedef struct {
     UINT32 count;
     PDoubleListNode pHead;
     PDoubleListNode pTail;
+    PNodePool pNodePool;
 } DoubleList, *PDoubleList;
 
 typedef struct __SingleListNode {
@@ -146,6 +152,7 @@ typedef struct {
     UINT32 count;
     PSingleListNode pHead;
     PSingleListNode pTail;
+    PNodePool pNodePool;
 } SingleList, *PSingleList;
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -156,6 +163,17 @@ typedef struct {
  */
 PUBLIC_API STATUS doubleListCreate(PDoubleList*);
 
+/**
+ * Create a new double linked list allocating the item nodes from a node pool.
+ * The pool of the given node count is allocated with the list. A growing pool adds a slab
+ * of nodes when exhausted, whereas a fixed one fails the item insertion with STATUS_NOT_ENOUGH_MEMORY.
+ *
+ * @UINT32 - initial node count
+ * @BOOL - whether the pool grows
+ * @PDoubleList* - returned list
+ */
+PUBLIC_API STATUS doubleListCreateWithPool(UINT32, BOOL, PDoubleList*);
+
 /**
  * Frees a double linked list and deallocates the nodes
  */
@@ -274,6 +292,12 @@ PUBLIC_API STATUS doubleListGetNodeCount(PDoubleList, PUINT32);
  */
 PUBLIC_API STATUS singleListCreate(PSingleList*);
 
+/**
+ * Create a new single linked list allocating the item nodes from a node pool.
+ * See doubleListCreateWithPool for the parameters.
+ */
+PUBLIC_API STATUS singleListCreateWithPool(UINT32, BOOL, PSingleList*);
+
 /**
  * Frees a single linked list and deallocates the nodes
  */
@@ -380,6 +404,12 @@ typedef StackQueueIterator* PStackQueueIterator;
  */
 PUBLIC_API STATUS stackQueueCreate(PStackQueue*);
 
+/**
+ * Create a new stack queue allocating the item nodes from a node pool.
+ * See doubleListCreateWithPool for the parameters.
+ */
+PUBLIC_API STATUS stackQueueCreateWithPool(UINT32, BOOL, PStackQueue*);
+
 /**
  * Frees and de-allocates the stack queue
  */
@@ -469,9 +499,13 @@ PUBLIC_API STATUS stackQueueIteratorGetItem(StackQueueIterator, PUINT64);
 // Hash table functionality
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Hash table collision resolution types
+ */
 /**
  * Hash table declaration
- * NOTE: Variable size structure - the buckets follow directly after the main structure
+ * NOTE: Variable size structure - the buckets or the open addressing slots follow directly after the main structure.
+ * For the open addressing table the bucket count is the number of the slots.
  */
 typedef struct {
     UINT32 itemCount;
@@ -522,6 +556,13 @@ PUBLIC_API STATUS hashTableCreate(PHashTable*);
  */
 PUBLIC_API STATUS hashTableCreateWithParams(UINT32, UINT32, PHashTable*);
 
+/**
+ * Create a new open addressing hash table with the initial number of slots.
+ * The slot count is rounded up to a power of two and is doubled as the table fills up.
+ * The rest of the hash table API works on either table type.
+ */
+PUBLIC_API STATUS hashTableCreateOpenAddressing(UINT32, PHashTable*);
+
 /**
  * Frees and de-allocates the hash table
  */
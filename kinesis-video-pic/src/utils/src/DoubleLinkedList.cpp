@@ -22,6 +22,31 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Create a new double linked list with a node pool
+ */
+STATUS doubleListCreateWithPool(UINT32 nodeCount, BOOL growable, PDoubleList* ppList)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PDoubleList pList = NULL;
+
+    CHK(ppList != NULL, STATUS_NULL_ARG);
+    CHK(nodeCount > 0, STATUS_INVALID_ARG);
+
+    // Allocate the main structure followed by the pool and its first slab
+    pList = (PDoubleList) MEMCALLOC(1, SIZEOF(DoubleList) + NODE_POOL_ALLOCATION_SIZE(SIZEOF(DoubleListNode), nodeCount));
+    CHK(pList != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pList->pNodePool = (PNodePool)(pList + 1);
+    nodePoolInit(pList->pNodePool, SIZEOF(DoubleListNode), nodeCount, growable);
+
+    *ppList = pList;
+
+CleanUp:
+
+    return retStatus;
+}
+
 /**
  * Frees a double linked list
  */
@@ -35,6 +60,11 @@ STATUS doubleListFree(PDoubleList pList)
     // We shouldn't fail here even if clear fails
     doubleListClear(pList);
 
+    // Free the grown node pool slabs. The first slab is a part of the list allocation.
+    if (pList->pNodePool != NULL) {
+        nodePoolRelease(pList->pNodePool);
+    }
+
     // Free the structure itself
     MEMFREE(pList);
 
@@ -58,7 +88,7 @@ STATUS doubleListClear(PDoubleList pList)
     pCurNode = pList->pHead;
     while (pCurNode != NULL) {
         pNextNode = pCurNode->pNext;
-        MEMFREE(pCurNode);
+        doubleListFreeNode(pList, pCurNode);
         pCurNode = pNextNode;
     }
 
@@ -97,7 +127,7 @@ STATUS doubleListInsertItemHead(PDoubleList pList, UINT64 data)
     CHK(pList != NULL, STATUS_NULL_ARG);
 
     // Allocate the node and insert
-    CHK_STATUS(doubleListAllocNode(data, &pNode));
+    CHK_STATUS(doubleListAllocNode(pList, data, &pNode));
     CHK_STATUS(doubleListInsertNodeHeadInternal(pList, pNode));
 
 CleanUp:
@@ -131,7 +161,7 @@ STATUS doubleListInsertItemTail(PDoubleList pList, UINT64 data)
     CHK(pList != NULL, STATUS_NULL_ARG);
 
     // Allocate the node and insert
-    CHK_STATUS(doubleListAllocNode(data, &pNode));
+    CHK_STATUS(doubleListAllocNode(pList, data, &pNode));
     CHK_STATUS(doubleListInsertNodeTailInternal(pList, pNode));
 
 CleanUp:
@@ -165,7 +195,7 @@ STATUS doubleListInsertItemBefore(PDoubleList pList, PDoubleListNode pNode, UINT
     CHK(pList != NULL && pNode != NULL, STATUS_NULL_ARG);
 
     // Allocate the node and insert
-    CHK_STATUS(doubleListAllocNode(data, &pInsertNode));
+    CHK_STATUS(doubleListAllocNode(pList, data, &pInsertNode));
     CHK_STATUS(doubleListInsertNodeBeforeInternal(pList, pNode, pInsertNode));
 
 CleanUp:
@@ -199,7 +229,7 @@ STATUS doubleListInsertItemAfter(PDoubleList pList, PDoubleListNode pNode, UINT6
     CHK(pList != NULL && pNode != NULL, STATUS_NULL_ARG);
 
     // Allocate the node and insert
-    CHK_STATUS(doubleListAllocNode(data, &pInsertNode));
+    CHK_STATUS(doubleListAllocNode(pList, data, &pInsertNode));
     CHK_STATUS(doubleListInsertNodeAfterInternal(pList, pNode, pInsertNode));
 
 CleanUp:
@@ -223,7 +253,7 @@ STATUS doubleListDeleteHead(PDoubleList pList)
     CHK_STATUS(doubleListRemoveNodeInternal(pList, pList->pHead));
 
     // Delete the node
-    MEMFREE(pNode);
+    doubleListFreeNode(pList, pNode);
 
 CleanUp:
 
@@ -246,7 +276,7 @@ STATUS doubleListDeleteTail(PDoubleList pList)
     CHK_STATUS(doubleListRemoveNodeInternal(pList, pList->pTail));
 
     // Delete the node
-    MEMFREE(pNode);
+    doubleListFreeNode(pList, pNode);
 
 CleanUp:
 
@@ -279,7 +309,7 @@ STATUS doubleListDeleteNode(PDoubleList pList, PDoubleListNode pNode)
     CHK_STATUS(doubleListRemoveNodeInternal(pList, pNode));
 
     // Delete the node
-    MEMFREE(pNode);
+    doubleListFreeNode(pList, pNode);
 
 CleanUp:
 
@@ -415,11 +445,17 @@ CleanUp:
 /////////////////////////////////////////////////////////////////////////////////
 // Internal operations
 /////////////////////////////////////////////////////////////////////////////////
-STATUS doubleListAllocNode(UINT64 data, PDoubleListNode* ppNode)
+STATUS doubleListAllocNode(PDoubleList pList, UINT64 data, PDoubleListNode* ppNode)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    PDoubleListNode pNode = (PDoubleListNode) MEMCALLOC(1, SIZEOF(DoubleListNode));
-    CHK(pNode != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    PDoubleListNode pNode = NULL;
+
+    if (pList->pNodePool != NULL) {
+        CHK_STATUS(nodePoolAlloc(pList->pNodePool, (PVOID*) &pNode));
+    } else {
+        pNode = (PDoubleListNode) MEMCALLOC(1, SIZEOF(DoubleListNode));
+        CHK(pNode != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    }
 
     pNode->data = data;
     *ppNode = pNode;
@@ -429,6 +465,15 @@ CleanUp:
     return retStatus;
 }
 
+VOID doubleListFreeNode(PDoubleList pList, PDoubleListNode pNode)
+{
+    if (pList->pNodePool != NULL) {
+        nodePoolFree(pList->pNodePool, pNode);
+    } else {
+        MEMFREE(pNode);
+    }
+}
+
 STATUS doubleListInsertNodeHeadInternal(PDoubleList pList, PDoubleListNode pNode)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -72,6 +72,48 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Create a new open addressing hash table with the initial number of slots
+ */
+STATUS hashTableCreateOpenAddressing(UINT32 slotCount, PHashTable* ppHashTable)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PHashTable pHashTable = NULL;
+    UINT32 allocSize, capacity = MIN_HASH_BUCKET_COUNT;
+
+    CHK(slotCount >= MIN_HASH_BUCKET_COUNT && ppHashTable != NULL, STATUS_NULL_ARG);
+    CHK(slotCount <= OPEN_HASH_TABLE_MAX_SLOT_COUNT, STATUS_INVALID_ARG);
+
+    // Pre-set the default
+    *ppHashTable = NULL;
+
+    // Round up to a power of two so the slot index is a mask of the hash
+    while (capacity < slotCount) {
+        capacity <<= 1;
+    }
+
+    // Make sure the allocation size doesn't overflow
+    CHK(capacity <= OPEN_HASH_TABLE_MAX_INLINE_SLOT_COUNT, STATUS_INVALID_ARG);
+
+    // The initial slots follow the open addressing table state in the main allocation
+    allocSize = SIZEOF(HashTable) + SIZEOF(OpenHashTable) + SIZEOF(HashSlot) * capacity;
+    pHashTable = (PHashTable) MEMCALLOC(1, allocSize);
+    CHK(pHashTable != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    // NOTE: The slots have been zeroed by calloc which marks them empty
+    pHashTable->bucketCount = capacity;
+    pHashTable->bucketLength = OPEN_HASH_TABLE_BUCKET_LENGTH;
+    pHashTable->itemCount = 0;
+    GET_OPEN_HASH_TABLE(pHashTable)->type = HASH_TABLE_TYPE_OPEN_ADDRESSING;
+    GET_OPEN_HASH_TABLE(pHashTable)->slots = GET_OPEN_HASH_TABLE_INLINE_SLOTS(pHashTable);
+
+    *ppHashTable = pHashTable;
+
+CleanUp:
+
+    return retStatus;
+}
+
 /**
  * Frees and de-allocates the hash table
  */
@@ -87,6 +129,16 @@ STATUS hashTableFree(PHashTable pHashTable)
     // We shouldn't fail here even if clear fails
     hashTableClear(pHashTable);
 
+    if (IS_OPEN_ADDRESSING_HASH_TABLE(pHashTable)) {
+        // Free the slots if they have been grown out of the main allocation
+        if (GET_OPEN_HASH_TABLE(pHashTable)->slots != GET_OPEN_HASH_TABLE_INLINE_SLOTS(pHashTable)) {
+            MEMFREE(GET_OPEN_HASH_TABLE(pHashTable)->slots);
+        }
+
+        MEMFREE(pHashTable);
+        CHK(FALSE, retStatus);
+    }
+
     // Free the buckets
     pHashBucket = (PHashBucket)(pHashTable + 1);
     for (i = 0; i < pHashTable->bucketCount; i++) {
@@ -115,11 +167,16 @@ STATUS hashTableClear(PHashTable pHashTable)
 
     CHK(pHashTable != NULL, STATUS_NULL_ARG);
 
-    // Iterate through and clear buckets.
-    // NOTE: This doesn't de-allocate the buckets
-    pHashBucket = (PHashBucket)(pHashTable + 1);
-    for (i = 0; i < pHashTable->bucketCount; i++) {
-        pHashBucket[i].count = 0;
+    if (IS_OPEN_ADDRESSING_HASH_TABLE(pHashTable)) {
+        // Empty the slots. NOTE: This doesn't shrink the slot array
+        MEMSET(GET_OPEN_HASH_TABLE(pHashTable)->slots, 0x00, SIZEOF(HashSlot) * pHashTable->bucketCount);
+    } else {
+        // Iterate through and clear buckets.
+        // NOTE: This doesn't de-allocate the buckets
+        pHashBucket = (PHashBucket)(pHashTable + 1);
+        for (i = 0; i < pHashTable->bucketCount; i++) {
+            pHashBucket[i].count = 0;
+        }
     }
 
     // Reset the table
@@ -214,6 +271,10 @@ STATUS hashTableGet(PHashTable pHashTable, UINT64 key, PUINT64 pValue)
 
     CHK(pHashTable != NULL && pValue != NULL, STATUS_NULL_ARG);
 
+    if (IS_OPEN_ADDRESSING_HASH_TABLE(pHashTable)) {
+        CHK(FALSE, openHashTableGet(pHashTable, key, pValue));
+    }
+
     // Get the bucket
     pHashBucket = getHashBucket(pHashTable, key);
     CHK(pHashBucket != NULL, STATUS_INTERNAL_ERROR);
@@ -243,6 +304,13 @@ STATUS hashTablePut(PHashTable pHashTable, UINT64 key, UINT64 value)
     STATUS retStatus = STATUS_SUCCESS;
     BOOL contains = FALSE;
 
+    CHK(pHashTable != NULL, STATUS_NULL_ARG);
+
+    // The open addressing table checks for the key while probing for the insertion slot
+    if (IS_OPEN_ADDRESSING_HASH_TABLE(pHashTable)) {
+        CHK(FALSE, openHashTablePut(pHashTable, key, value, FALSE));
+    }
+
     // Check if the item exists and bail out if it does
     CHK_STATUS(hashTableContains(pHashTable, key, &contains));
     CHK(!contains, STATUS_HASH_KEY_ALREADY_PRESENT);
@@ -268,6 +336,10 @@ STATUS hashTableUpsert(PHashTable pHashTable, UINT64 key, UINT64 value)
 
     CHK(pHashTable != NULL, STATUS_NULL_ARG);
 
+    if (IS_OPEN_ADDRESSING_HASH_TABLE(pHashTable)) {
+        CHK(FALSE, openHashTablePut(pHashTable, key, value, TRUE));
+    }
+
     // Get the bucket and the entries
     pHashBucket = getHashBucket(pHashTable, key);
     CHK(pHashBucket != NULL, STATUS_INTERNAL_ERROR);
@@ -333,6 +405,10 @@ STATUS hashTableRemove(PHashTable pHashTable, UINT64 key)
 
     CHK(pHashTable != NULL, STATUS_NULL_ARG);
 
+    if (IS_OPEN_ADDRESSING_HASH_TABLE(pHashTable)) {
+        CHK(FALSE, openHashTableRemove(pHashTable, key));
+    }
+
     // Get the bucket
     pHashBucket = getHashBucket(pHashTable, key);
     CHK(pHashBucket != NULL, STATUS_INTERNAL_ERROR);
@@ -349,7 +425,7 @@ STATUS hashTableRemove(PHashTable pHashTable, UINT64 key)
     CHK(found, STATUS_HASH_KEY_NOT_PRESENT);
 
     // Move the rest of the items
-    MEMMOVE(pHashEntry, pHashEntry + 1, (pHashBucket->count - 1) * SIZEOF(HashEntry));
+    MEMMOVE(pHashEntry, pHashEntry + 1, (pHashBucket->count - i - 1) * SIZEOF(HashEntry));
 
     // Decrement the count as we have removed and item
     pHashBucket->count--;
@@ -370,7 +446,8 @@ STATUS hashTableGetAllEntries(PHashTable pHashTable, PHashEntry pHashEntries, PU
     STATUS retStatus = STATUS_SUCCESS;
     PHashBucket pHashBucket;
     PHashEntry pHashEntry;
-    UINT32 bucketIndex;
+    PHashSlot pHashSlot;
+    UINT32 bucketIndex, slotIndex;
 
     CHK(pHashTable != NULL && pHashCount != NULL, STATUS_NULL_ARG);
 
@@ -385,6 +462,18 @@ STATUS hashTableGetAllEntries(PHashTable pHashTable, PHashEntry pHashEntries, PU
 
     pHashEntry = pHashEntries;
 
+    // Copy the entries of the occupied slots
+    if (IS_OPEN_ADDRESSING_HASH_TABLE(pHashTable)) {
+        pHashSlot = GET_OPEN_HASH_TABLE(pHashTable)->slots;
+        for (slotIndex = 0; slotIndex < pHashTable->bucketCount; slotIndex++, pHashSlot++) {
+            if (pHashSlot->distance != 0) {
+                *pHashEntry++ = pHashSlot->entry;
+            }
+        }
+
+        CHK(FALSE, retStatus);
+    }
+
     // Copy the items into the array
     pHashBucket = (PHashBucket)(pHashTable + 1);
     for (bucketIndex = 0; bucketIndex < pHashTable->bucketCount; bucketIndex++) {
@@ -419,6 +508,10 @@ STATUS hashTableIterateEntries(PHashTable pHashTable, UINT64 callerData, HashEnt
 
     CHK(pHashTable != NULL && hashEntryFn != NULL, STATUS_NULL_ARG);
 
+    if (IS_OPEN_ADDRESSING_HASH_TABLE(pHashTable)) {
+        CHK(FALSE, openHashTableIterateEntries(pHashTable, callerData, hashEntryFn));
+    }
+
     // Iterate over buckets and entries
     pHashBucket = (PHashBucket)(pHashTable + 1);
     for (bucketIndex = 0; bucketIndex < pHashTable->bucketCount; bucketIndex++) {
@@ -476,3 +569,216 @@ UINT64 getKeyHash(UINT64 key)
 
     return hash;
 }
+
+/**
+ * Mixes the key bits so the low bits used for the open addressing slot index are well distributed.
+ * NOTE: This implementation uses the public domain MurmurHash3 64-bit finalizer
+ * https://github.com/aappleby/smhasher/blob/master/src/MurmurHash3.cpp
+ */
+UINT64 getKeyMixHash(UINT64 key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccd;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53;
+    key ^= key >> 33;
+
+    return key;
+}
+
+/**
+ * Gets an item from the open addressing table
+ */
+STATUS openHashTableGet(PHashTable pHashTable, UINT64 key, PUINT64 pValue)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PHashSlot pSlots = GET_OPEN_HASH_TABLE(pHashTable)->slots;
+    UINT32 slotMask = pHashTable->bucketCount - 1;
+    UINT32 index = (UINT32) getKeyMixHash(key) & slotMask;
+    UINT32 distance = 1;
+
+    // The entries are ordered by the probe distance so the key can't be past a closer entry
+    while (pSlots[index].distance >= distance) {
+        if (pSlots[index].entry.key == key) {
+            *pValue = pSlots[index].entry.value;
+            CHK(FALSE, retStatus);
+        }
+
+        index = (index + 1) & slotMask;
+        distance++;
+    }
+
+    CHK(FALSE, STATUS_HASH_KEY_NOT_PRESENT);
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * Puts or upserts an item into the open addressing table
+ */
+STATUS openHashTablePut(PHashTable pHashTable, UINT64 key, UINT64 value, BOOL upsert)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PHashSlot pSlots;
+    HashSlot slot;
+    UINT32 slotMask, index;
+
+    // Grow ahead so the probing doesn't run into the full table
+    if (pHashTable->itemCount >= OPEN_HASH_TABLE_MAX_ITEM_COUNT(pHashTable->bucketCount)) {
+        CHK_STATUS(openHashTableGrow(pHashTable));
+    }
+
+    pSlots = GET_OPEN_HASH_TABLE(pHashTable)->slots;
+    slotMask = pHashTable->bucketCount - 1;
+    index = (UINT32) getKeyMixHash(key) & slotMask;
+
+    slot.entry.key = key;
+    slot.entry.value = value;
+    slot.distance = 1;
+
+    // Probe for the existing key until the first entry closer to its home slot
+    while (pSlots[index].distance >= slot.distance) {
+        if (pSlots[index].entry.key == key) {
+            CHK(upsert, STATUS_HASH_KEY_ALREADY_PRESENT);
+            pSlots[index].entry.value = value;
+            CHK(FALSE, retStatus);
+        }
+
+        index = (index + 1) & slotMask;
+        slot.distance++;
+    }
+
+    // The key is not present - take the slot and shift the displaced entries down the probe sequence
+    openHashTableInsertSlot(pSlots, slotMask, index, slot);
+
+    pHashTable->itemCount++;
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * Removes an item from the open addressing table.
+ * The following entries are shifted back instead of leaving a tombstone.
+ */
+STATUS openHashTableRemove(PHashTable pHashTable, UINT64 key)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PHashSlot pSlots = GET_OPEN_HASH_TABLE(pHashTable)->slots;
+    UINT32 slotMask = pHashTable->bucketCount - 1;
+    UINT32 index = (UINT32) getKeyMixHash(key) & slotMask;
+    UINT32 next, distance = 1;
+
+    while (pSlots[index].distance >= distance && pSlots[index].entry.key != key) {
+        index = (index + 1) & slotMask;
+        distance++;
+    }
+
+    CHK(pSlots[index].distance >= distance, STATUS_HASH_KEY_NOT_PRESENT);
+
+    // Shift back the entries which are not in their home slot
+    next = (index + 1) & slotMask;
+    while (pSlots[next].distance > 1) {
+        pSlots[index] = pSlots[next];
+        pSlots[index].distance--;
+        index = next;
+        next = (next + 1) & slotMask;
+    }
+
+    pSlots[index].distance = 0;
+    pHashTable->itemCount--;
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * Doubles the slot array of the open addressing table and re-inserts the entries
+ */
+STATUS openHashTableGrow(PHashTable pHashTable)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    POpenHashTable pOpenHashTable = GET_OPEN_HASH_TABLE(pHashTable);
+    PHashSlot pNewSlots = NULL, pHashSlot;
+    HashSlot slot;
+    UINT32 i, slotCount;
+
+    CHK(pHashTable->bucketCount < OPEN_HASH_TABLE_MAX_SLOT_COUNT, STATUS_NOT_ENOUGH_MEMORY);
+    slotCount = pHashTable->bucketCount << 1;
+    pNewSlots = (PHashSlot) MEMCALLOC(slotCount, SIZEOF(HashSlot));
+    CHK(pNewSlots != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pHashSlot = pOpenHashTable->slots;
+    for (i = 0; i < pHashTable->bucketCount; i++, pHashSlot++) {
+        if (pHashSlot->distance != 0) {
+            slot.entry = pHashSlot->entry;
+            slot.distance = 1;
+            openHashTableInsertSlot(pNewSlots, slotCount - 1, (UINT32) getKeyMixHash(slot.entry.key) & (slotCount - 1), slot);
+        }
+    }
+
+    // Free the previous slots if they were grown out of the main allocation
+    if (pOpenHashTable->slots != GET_OPEN_HASH_TABLE_INLINE_SLOTS(pHashTable)) {
+        MEMFREE(pOpenHashTable->slots);
+    }
+
+    pOpenHashTable->slots = pNewSlots;
+    pHashTable->bucketCount = slotCount;
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * Iterates over the entries of the occupied slots
+ */
+STATUS openHashTableIterateEntries(PHashTable pHashTable, UINT64 callerData, HashEntryCallbackFunc hashEntryFn)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PHashSlot pHashSlot = GET_OPEN_HASH_TABLE(pHashTable)->slots;
+    UINT32 slotIndex;
+
+    for (slotIndex = 0; slotIndex < pHashTable->bucketCount; slotIndex++, pHashSlot++) {
+        if (pHashSlot->distance != 0) {
+            retStatus = hashEntryFn(callerData, &pHashSlot->entry);
+
+            // Check if there was an error
+            CHK(retStatus == STATUS_HASH_ENTRY_ITERATION_ABORT || retStatus == STATUS_SUCCESS, retStatus);
+
+            // Check if we need to abort
+            CHK(retStatus != STATUS_HASH_ENTRY_ITERATION_ABORT, STATUS_SUCCESS);
+        }
+    }
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * Robin Hood insertion of a slot for a key known not to be present starting at the given index.
+ * The carried entry takes over the slot of any entry closer to its home slot, which is then carried on.
+ * NOTE: The slot distance is the probe distance at the starting index.
+ */
+VOID openHashTableInsertSlot(PHashSlot pSlots, UINT32 slotMask, UINT32 index, HashSlot slot)
+{
+    HashSlot temp;
+
+    while (pSlots[index].distance != 0) {
+        if (pSlots[index].distance < slot.distance) {
+            temp = pSlots[index];
+            pSlots[index] = slot;
+            slot = temp;
+        }
+
+        index = (index + 1) & slotMask;
+        slot.distance++;
+    }
+
+    pSlots[index] = slot;
+}
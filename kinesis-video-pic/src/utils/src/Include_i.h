@@ -24,10 +24,47 @@ STATUS strtoint(PCHAR, PCHAR, UINT32, PUINT64, PBOOL);
  */
 STATUS unsignedSafeMultiplyAdd(UINT64, UINT64, UINT64, PUINT64);
 
+/**
+ * Node pool slab declaration. The nodes follow directly after the slab.
+ */
+typedef struct __NodePoolSlab {
+    struct __NodePoolSlab* pNext;
+    UINT32 nodeCount;
+} NodePoolSlab, *PNodePoolSlab;
+
+/**
+ * Node pool declaration.
+ * NOTE: The pool and its first slab follow directly after the list structure in the same allocation.
+ * The grown slabs are separate allocations linked in front of the first slab.
+ */
+struct __NodePool {
+    UINT32 nodeSize;
+    BOOL growable;
+
+    // The free nodes are linked through their first pointer
+    PVOID pFreeList;
+
+    PNodePoolSlab pSlabs;
+};
+
+#define NODE_POOL_ALLOCATION_SIZE(nodeSize, nodeCount)  (SIZEOF(NodePool) + SIZEOF(NodePoolSlab) + (nodeSize) * (nodeCount))
+#define GET_NODE_POOL_SLAB_NODES(pSlab)                 ((PBYTE)((PNodePoolSlab)(pSlab) + 1))
+
+/**
+ * Internal Node Pool operations
+ */
+VOID nodePoolInit(PNodePool, UINT32, UINT32, BOOL);
+VOID nodePoolRelease(PNodePool);
+STATUS nodePoolAlloc(PNodePool, PVOID*);
+VOID nodePoolFree(PNodePool, PVOID);
+VOID nodePoolAddSlab(PNodePool, PNodePoolSlab, UINT32);
+BOOL nodePoolOwnsNode(PNodePool, PVOID);
+
 /**
  * Internal Double Linked List operations
  */
-STATUS doubleListAllocNode(UINT64, PDoubleListNode*);
+STATUS doubleListAllocNode(PDoubleList, UINT64, PDoubleListNode*);
+VOID doubleListFreeNode(PDoubleList, PDoubleListNode);
 STATUS doubleListInsertNodeHeadInternal(PDoubleList, PDoubleListNode);
 STATUS doubleListInsertNodeTailInternal(PDoubleList, PDoubleListNode);
 STATUS doubleListInsertNodeBeforeInternal(PDoubleList, PDoubleListNode, PDoubleListNode);
@@ -38,7 +75,8 @@ STATUS doubleListGetNodeAtInternal(PDoubleList, UINT32, PDoubleListNode*);
 /**
  * Internal Single Linked List operations
  */
-STATUS singleListAllocNode(UINT64, PSingleListNode*);
+STATUS singleListAllocNode(PSingleList, UINT64, PSingleListNode*);
+VOID singleListFreeNode(PSingleList, PSingleListNode);
 STATUS singleListInsertNodeHeadInternal(PSingleList, PSingleListNode);
 STATUS singleListInsertNodeTailInternal(PSingleList, PSingleListNode);
 STATUS singleListInsertNodeAfterInternal(PSingleList, PSingleListNode, PSingleListNode);
@@ -65,6 +103,68 @@ typedef struct {
 UINT64 getKeyHash(UINT64);
 PHashBucket getHashBucket(PHashTable, UINT64);
 
+/**
+ * Open addressing slot declaration.
+ * The distance is the probe sequence length of the entry plus one so the zeroed slots are empty.
+ */
+typedef struct {
+    HashEntry entry;
+    UINT32 distance;
+} HashSlot, *PHashSlot;
+
+/**
+ * Hash table types
+ */
+typedef enum {
+    // Each bucket holds an array of entries
+    HASH_TABLE_TYPE_BUCKETS,
+
+    // The entries are stored inline in a single slot array using Robin Hood open addressing
+    HASH_TABLE_TYPE_OPEN_ADDRESSING
+} HASH_TABLE_TYPE;
+
+/**
+ * Open addressing table state following the main structure.
+ * NOTE: The initial slots follow directly after this structure. The grown slot array is a separate allocation.
+ */
+typedef struct {
+    HASH_TABLE_TYPE type;
+    PHashSlot slots;
+} OpenHashTable, *POpenHashTable;
+
+/**
+ * The bucket length of the open addressing table. The bucket tables have at least one entry per bucket
+ * so the type is told apart without reading past the main structure whose layout depends on it.
+ */
+#define OPEN_HASH_TABLE_BUCKET_LENGTH           0
+
+#define IS_OPEN_ADDRESSING_HASH_TABLE(p)        ((p)->bucketLength == OPEN_HASH_TABLE_BUCKET_LENGTH)
+#define GET_OPEN_HASH_TABLE(p)                  ((POpenHashTable)((p) + 1))
+#define GET_OPEN_HASH_TABLE_INLINE_SLOTS(p)     ((PHashSlot)(GET_OPEN_HASH_TABLE(p) + 1))
+
+/**
+ * The table is grown before it gets over 7/8th full
+ */
+#define OPEN_HASH_TABLE_MAX_ITEM_COUNT(slotCount)  ((slotCount) - ((slotCount) >> 3))
+
+/**
+ * Max slot count keeping the slot count a power of two
+ */
+#define OPEN_HASH_TABLE_MAX_SLOT_COUNT          0x80000000
+
+/**
+ * Max slot count fitting the main allocation with the initial slots in 32 bits
+ */
+#define OPEN_HASH_TABLE_MAX_INLINE_SLOT_COUNT   ((MAX_UINT32 - SIZEOF(HashTable) - SIZEOF(OpenHashTable)) / SIZEOF(HashSlot))
+
+UINT64 getKeyMixHash(UINT64);
+STATUS openHashTableGet(PHashTable, UINT64, PUINT64);
+STATUS openHashTablePut(PHashTable, UINT64, UINT64, BOOL);
+STATUS openHashTableRemove(PHashTable, UINT64);
+STATUS openHashTableGrow(PHashTable);
+STATUS openHashTableIterateEntries(PHashTable, UINT64, HashEntryCallbackFunc);
+VOID openHashTableInsertSlot(PHashSlot, UINT32, UINT32, HashSlot);
+
 /**
  * Internal Directory functionality
  */
@@ -0,0 +1,111 @@
+#include "Include_i.h"
+
+/**
+ * Initializes the node pool with the first slab following the pool structure
+ */
+VOID nodePoolInit(PNodePool pNodePool, UINT32 nodeSize, UINT32 nodeCount, BOOL growable)
+{
+    pNodePool->nodeSize = nodeSize;
+    pNodePool->growable = growable;
+    pNodePool->pFreeList = NULL;
+    pNodePool->pSlabs = NULL;
+
+    nodePoolAddSlab(pNodePool, (PNodePoolSlab)(pNodePool + 1), nodeCount);
+}
+
+/**
+ * Frees the grown slabs. The first slab is freed with the list allocation.
+ */
+VOID nodePoolRelease(PNodePool pNodePool)
+{
+    PNodePoolSlab pSlab = pNodePool->pSlabs;
+    PNodePoolSlab pNextSlab;
+
+    while (pSlab != (PNodePoolSlab)(pNodePool + 1)) {
+        pNextSlab = pSlab->pNext;
+        MEMFREE(pSlab);
+        pSlab = pNextSlab;
+    }
+
+    pNodePool->pSlabs = pSlab;
+}
+
+/**
+ * Takes a node off the free list growing the pool if needed
+ */
+STATUS nodePoolAlloc(PNodePool pNodePool, PVOID* ppNode)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PNodePoolSlab pSlab;
+    UINT32 nodeCount;
+
+    if (pNodePool->pFreeList == NULL) {
+        CHK(pNodePool->growable, STATUS_NOT_ENOUGH_MEMORY);
+
+        // Double the capacity with each slab to keep the slab count low
+        nodeCount = pNodePool->pSlabs->nodeCount * 2;
+        pSlab = (PNodePoolSlab) MEMALLOC(SIZEOF(NodePoolSlab) + pNodePool->nodeSize * nodeCount);
+        CHK(pSlab != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+        nodePoolAddSlab(pNodePool, pSlab, nodeCount);
+    }
+
+    *ppNode = pNodePool->pFreeList;
+    pNodePool->pFreeList = *(PVOID*) pNodePool->pFreeList;
+
+CleanUp:
+
+    return retStatus;
+}
+
+/**
+ * Returns the node to the free list.
+ * NOTE: The nodes inserted by the caller are not from the pool and are freed to the heap.
+ */
+VOID nodePoolFree(PNodePool pNodePool, PVOID pNode)
+{
+    if (nodePoolOwnsNode(pNodePool, pNode)) {
+        *(PVOID*) pNode = pNodePool->pFreeList;
+        pNodePool->pFreeList = pNode;
+    } else {
+        MEMFREE(pNode);
+    }
+}
+
+/**
+ * Links the slab in and threads its nodes onto the free list
+ */
+VOID nodePoolAddSlab(PNodePool pNodePool, PNodePoolSlab pSlab, UINT32 nodeCount)
+{
+    PBYTE pNode = GET_NODE_POOL_SLAB_NODES(pSlab) + pNodePool->nodeSize * nodeCount;
+    UINT32 i;
+
+    pSlab->nodeCount = nodeCount;
+    pSlab->pNext = pNodePool->pSlabs;
+    pNodePool->pSlabs = pSlab;
+
+    // Thread backwards so the nodes are handed out in the address order
+    for (i = 0; i < nodeCount; i++) {
+        pNode -= pNodePool->nodeSize;
+        *(PVOID*) pNode = pNodePool->pFreeList;
+        pNodePool->pFreeList = pNode;
+    }
+}
+
+/**
+ * Whether the node belongs to one of the pool slabs
+ */
+BOOL nodePoolOwnsNode(PNodePool pNodePool, PVOID pNode)
+{
+    PNodePoolSlab pSlab;
+    PBYTE pNodes;
+
+    for (pSlab = pNodePool->pSlabs; pSlab != NULL; pSlab = pSlab->pNext) {
+        pNodes = GET_NODE_POOL_SLAB_NODES(pSlab);
+        if ((PBYTE) pNode >= pNodes && (PBYTE) pNode < pNodes + pNodePool->nodeSize * pSlab->nodeCount) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
@@ -22,6 +22,31 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Create a new single linked list with a node pool
+ */
+STATUS singleListCreateWithPool(UINT32 nodeCount, BOOL growable, PSingleList* ppList)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PSingleList pList = NULL;
+
+    CHK(ppList != NULL, STATUS_NULL_ARG);
+    CHK(nodeCount > 0, STATUS_INVALID_ARG);
+
+    // Allocate the main structure followed by the pool and its first slab
+    pList = (PSingleList) MEMCALLOC(1, SIZEOF(SingleList) + NODE_POOL_ALLOCATION_SIZE(SIZEOF(SingleListNode), nodeCount));
+    CHK(pList != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    pList->pNodePool = (PNodePool)(pList + 1);
+    nodePoolInit(pList->pNodePool, SIZEOF(SingleListNode), nodeCount, growable);
+
+    *ppList = pList;
+
+CleanUp:
+
+    return retStatus;
+}
+
 /**
  * Frees a single linked list
  */
@@ -35,6 +60,11 @@ STATUS singleListFree(PSingleList pList)
     // We shouldn't fail here even if clear fails
     singleListClear(pList);
 
+    // Free the grown node pool slabs. The first slab is a part of the list allocation.
+    if (pList->pNodePool != NULL) {
+        nodePoolRelease(pList->pNodePool);
+    }
+
     // Free the structure itself
     MEMFREE(pList);
 
@@ -58,7 +88,7 @@ STATUS singleListClear(PSingleList pList)
     pCurNode = pList->pHead;
     while (pCurNode != NULL) {
         pNextNode = pCurNode->pNext;
-        MEMFREE(pCurNode);
+        singleListFreeNode(pList, pCurNode);
         pCurNode = pNextNode;
     }
 
@@ -97,7 +127,7 @@ STATUS singleListInsertItemHead(PSingleList pList, UINT64 data)
     CHK(pList != NULL, STATUS_NULL_ARG);
 
     // Allocate the node and insert
-    CHK_STATUS(singleListAllocNode(data, &pNode));
+    CHK_STATUS(singleListAllocNode(pList, data, &pNode));
     CHK_STATUS(singleListInsertNodeHeadInternal(pList, pNode));
 
 CleanUp:
@@ -131,7 +161,7 @@ STATUS singleListInsertItemTail(PSingleList pList, UINT64 data)
     CHK(pList != NULL, STATUS_NULL_ARG);
 
     // Allocate the node and insert
-    CHK_STATUS(singleListAllocNode(data, &pNode));
+    CHK_STATUS(singleListAllocNode(pList, data, &pNode));
     CHK_STATUS(singleListInsertNodeTailInternal(pList, pNode));
 
 CleanUp:
@@ -165,7 +195,7 @@ STATUS singleListInsertItemAfter(PSingleList pList, PSingleListNode pNode, UINT6
     CHK(pList != NULL && pNode != NULL, STATUS_NULL_ARG);
 
     // Allocate the node and insert
-    CHK_STATUS(singleListAllocNode(data, &pInsertNode));
+    CHK_STATUS(singleListAllocNode(pList, data, &pInsertNode));
     CHK_STATUS(singleListInsertNodeAfterInternal(pList, pNode, pInsertNode));
 
 CleanUp:
@@ -198,7 +228,7 @@ STATUS singleListDeleteHead(PSingleList pList)
     pList->count--;
 
     // Delete the node
-    MEMFREE(pNode);
+    singleListFreeNode(pList, pNode);
 
 CleanUp:
 
@@ -231,7 +261,7 @@ STATUS singleListDeleteNextNode(PSingleList pList, PSingleListNode pNode)
         pList->count--;
 
         // Delete the node
-        MEMFREE(pNextNode);
+        singleListFreeNode(pList, pNextNode);
     } else {
         // Validate that it's the tail
         CHK(pList->pTail == pNode, STATUS_INVALID_ARG);
@@ -391,11 +421,17 @@ CleanUp:
 /////////////////////////////////////////////////////////////////////////////////
 // Internal operations
 /////////////////////////////////////////////////////////////////////////////////
-STATUS singleListAllocNode(UINT64 data, PSingleListNode* ppNode)
+STATUS singleListAllocNode(PSingleList pList, UINT64 data, PSingleListNode* ppNode)
 {
     STATUS retStatus = STATUS_SUCCESS;
-    PSingleListNode pNode = (PSingleListNode) MEMCALLOC(1, SIZEOF(SingleListNode));
-    CHK(pNode != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    PSingleListNode pNode = NULL;
+
+    if (pList->pNodePool != NULL) {
+        CHK_STATUS(nodePoolAlloc(pList->pNodePool, (PVOID*) &pNode));
+    } else {
+        pNode = (PSingleListNode) MEMCALLOC(1, SIZEOF(SingleListNode));
+        CHK(pNode != NULL, STATUS_NOT_ENOUGH_MEMORY);
+    }
 
     pNode->data = data;
     *ppNode = pNode;
@@ -405,6 +441,15 @@ CleanUp:
     return retStatus;
 }
 
+VOID singleListFreeNode(PSingleList pList, PSingleListNode pNode)
+{
+    if (pList->pNodePool != NULL) {
+        nodePoolFree(pList->pNodePool, pNode);
+    } else {
+        MEMFREE(pNode);
+    }
+}
+
 STATUS singleListInsertNodeHeadInternal(PSingleList pList, PSingleListNode pNode)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -8,6 +8,14 @@ STATUS stackQueueCreate(PStackQueue* ppStackQueue)
     return singleListCreate(ppStackQueue);
 }
 
+/**
+ * Create a new stack/queue with a node pool
+ */
+STATUS stackQueueCreateWithPool(UINT32 nodeCount, BOOL growable, PStackQueue* ppStackQueue)
+{
+    return singleListCreateWithPool(nodeCount, growable, ppStackQueue);
+}
+
 /**
  * Frees and de-allocates the stack queue
  */
@@ -1,5 +1,4 @@
-#include "gtest/gtest.h"
-#include <com/amazonaws/kinesis/video/utils/Include.h>
+#include "UtilsTestFixture.h"
 
 TEST(NegativeInvalidInput, DoubleListCreate)
 {
@@ -484,3 +483,76 @@ TEST(FunctionalTest, DoubleListInsertBeforeAfter)
     // Destroy the list
     EXPECT_EQ(STATUS_SUCCESS, doubleListFree(pList));
 }
+
+class DoubleListPoolTest : public UtilsTestBase {
+};
+
+TEST_F(DoubleListPoolTest, DoubleListCreateWithPool)
+{
+    PDoubleList pList;
+
+    EXPECT_NE(STATUS_SUCCESS, doubleListCreateWithPool(10, TRUE, NULL));
+    EXPECT_NE(STATUS_SUCCESS, doubleListCreateWithPool(0, TRUE, &pList));
+    EXPECT_EQ(0, gAllocationCount);
+}
+
+TEST_F(DoubleListPoolTest, DoubleListFixedPoolNoAllocations)
+{
+    PDoubleList pList;
+    UINT64 data;
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListCreateWithPool(3, FALSE, &pList));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemHead(pList, 1));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemBefore(pList, pList->pHead, 0));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemAfter(pList, pList->pHead->pNext, 2));
+    EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY, doubleListInsertItemTail(pList, 3));
+
+    // Rotate the items through the pool
+    for (UINT64 i = 3; i < 1000; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, doubleListGetNodeDataAt(pList, 0, &data));
+        EXPECT_EQ(i - 3, data);
+        if (i % 2 == 0) {
+            EXPECT_EQ(STATUS_SUCCESS, doubleListDeleteHead(pList));
+        } else {
+            EXPECT_EQ(STATUS_SUCCESS, doubleListDeleteNode(pList, pList->pHead));
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemTail(pList, i));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListDeleteTail(pList));
+    EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemTail(pList, 999));
+
+    EXPECT_EQ(1, gAllocationCount);
+    EXPECT_EQ(0, gFreeCount);
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(pList));
+    EXPECT_EQ(1, gFreeCount);
+}
+
+TEST_F(DoubleListPoolTest, DoubleListGrowingPool)
+{
+    PDoubleList pList;
+    UINT64 data;
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListCreateWithPool(1, TRUE, &pList));
+
+    // The slabs double - 1 + 2 + 4 + 8 nodes
+    for (UINT64 i = 0; i < 15; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemTail(pList, i));
+    }
+
+    EXPECT_EQ(4, gAllocationCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListClear(pList));
+    for (UINT64 i = 0; i < 15; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, doubleListInsertItemHead(pList, i));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListGetNodeDataAt(pList, 14, &data));
+    EXPECT_EQ(0, data);
+    EXPECT_EQ(4, gAllocationCount);
+    EXPECT_EQ(0, gFreeCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, doubleListFree(pList));
+    EXPECT_EQ(4, gFreeCount);
+}
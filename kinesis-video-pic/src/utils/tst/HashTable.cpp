@@ -404,3 +404,225 @@ TEST(FunctionalTest, HashTableIterateEntries)
     // Destroy the table
     EXPECT_EQ(STATUS_SUCCESS, hashTableFree(pHashTable));
 }
+
+TEST(NegativeInvalidInput, HashTableCreateOpenAddressing)
+{
+    PHashTable pHashTable;
+    EXPECT_NE(STATUS_SUCCESS, hashTableCreateOpenAddressing(0, &pHashTable));
+    EXPECT_NE(STATUS_SUCCESS, hashTableCreateOpenAddressing(MIN_HASH_BUCKET_COUNT - 1, &pHashTable));
+    EXPECT_NE(STATUS_SUCCESS, hashTableCreateOpenAddressing(MIN_HASH_BUCKET_COUNT, NULL));
+    EXPECT_NE(STATUS_SUCCESS, hashTableCreateOpenAddressing(MAX_UINT32, &pHashTable));
+
+    // The max slot count is accepted but the initial slots don't fit the 32 bit allocation size
+    EXPECT_EQ(STATUS_INVALID_ARG, hashTableCreateOpenAddressing(0x80000000, &pHashTable));
+    EXPECT_EQ(STATUS_INVALID_ARG, hashTableCreateOpenAddressing(0x10000000, &pHashTable));
+}
+
+TEST(FunctionalTest, HashTableOpenAddressingPutGetRemoveGrow)
+{
+    PHashTable pHashTable;
+    UINT64 count = 1000;
+    UINT64 val;
+    UINT32 retCount, bucketCount;
+    BOOL contains;
+
+    // Create the table and validate the slot count is rounded up to a power of two
+    EXPECT_EQ(STATUS_SUCCESS, hashTableCreateOpenAddressing(MIN_HASH_BUCKET_COUNT + 1, &pHashTable));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetBucketCount(pHashTable, &bucketCount));
+    EXPECT_EQ(2 * MIN_HASH_BUCKET_COUNT, bucketCount);
+
+    // Insert the keys which are the multiples of the slot count to have them collide in the low bits
+    for (UINT64 i = 0; i < count; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, hashTablePut(pHashTable, i * 1024, i));
+        EXPECT_EQ(STATUS_HASH_KEY_ALREADY_PRESENT, hashTablePut(pHashTable, i * 1024, i));
+    }
+
+    // The slots have grown while keeping the load under the limit
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetCount(pHashTable, &retCount));
+    EXPECT_EQ(count, (UINT64) retCount);
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetBucketCount(pHashTable, &bucketCount));
+    EXPECT_EQ(2048, bucketCount);
+
+    for (UINT64 i = 0; i < count; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, hashTableGet(pHashTable, i * 1024, &val));
+        EXPECT_EQ(i, val);
+        EXPECT_EQ(STATUS_SUCCESS, hashTableContains(pHashTable, i * 1024 + 1, &contains));
+        EXPECT_FALSE(contains);
+    }
+
+    // Remove every other item and validate the shifted back entries are still found
+    for (UINT64 i = 0; i < count; i += 2) {
+        EXPECT_EQ(STATUS_SUCCESS, hashTableRemove(pHashTable, i * 1024));
+        EXPECT_EQ(STATUS_HASH_KEY_NOT_PRESENT, hashTableRemove(pHashTable, i * 1024));
+    }
+
+    for (UINT64 i = 0; i < count; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, hashTableContains(pHashTable, i * 1024, &contains));
+        EXPECT_EQ(i % 2 == 1, contains);
+    }
+
+    // Upsert updates the existing items and re-inserts the removed ones
+    for (UINT64 i = 0; i < count; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, hashTableUpsert(pHashTable, i * 1024, i + 1));
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetCount(pHashTable, &retCount));
+    EXPECT_EQ(count, (UINT64) retCount);
+    for (UINT64 i = 0; i < count; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, hashTableGet(pHashTable, i * 1024, &val));
+        EXPECT_EQ(i + 1, val);
+    }
+
+    // Clear keeps the slots
+    EXPECT_EQ(STATUS_SUCCESS, hashTableClear(pHashTable));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetCount(pHashTable, &retCount));
+    EXPECT_EQ(0, retCount);
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetBucketCount(pHashTable, &bucketCount));
+    EXPECT_EQ(2048, bucketCount);
+    EXPECT_EQ(STATUS_HASH_KEY_NOT_PRESENT, hashTableGet(pHashTable, 1024, &val));
+
+    EXPECT_EQ(STATUS_SUCCESS, hashTableFree(pHashTable));
+}
+
+TEST(FunctionalTest, HashTableOpenAddressingGetAllEntriesIterateEntries)
+{
+    PHashTable pHashTable;
+    UINT64 count = 100;
+    UINT32 retCount;
+    BOOL contains;
+    HashEntry entries[110];
+
+    EXPECT_EQ(STATUS_SUCCESS, hashTableCreateOpenAddressing(MIN_HASH_BUCKET_COUNT, &pHashTable));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableIterateEntries(pHashTable, gCallerData, errCallbackFn));
+
+    for (UINT64 i = 0; i < count; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, hashTablePut(pHashTable, i, i));
+    }
+
+    retCount = (UINT32) count - 1;
+    EXPECT_EQ(STATUS_BUFFER_TOO_SMALL, hashTableGetAllEntries(pHashTable, entries, &retCount));
+    retCount = (UINT32) count;
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetAllEntries(pHashTable, entries, &retCount));
+    EXPECT_EQ(count, (UINT64) retCount);
+
+    for (UINT64 i = 0; i < count; i++) {
+        contains = FALSE;
+        for (UINT32 j = 0; j < count; j++) {
+            if (entries[j].key == i && entries[j].value == i) {
+                contains = TRUE;
+                break;
+            }
+        }
+
+        EXPECT_TRUE(contains);
+    }
+
+    // The iteration follows the same slot order
+    EXPECT_EQ(STATUS_INVALID_ARG, hashTableIterateEntries(pHashTable, gCallerData, errCallbackFn));
+    gIteration = 0;
+    EXPECT_EQ(STATUS_SUCCESS, hashTableIterateEntries(pHashTable, gCallerData, abortCallbackFn));
+    EXPECT_EQ(count / 2, gIteration - 1);
+    for (UINT64 i = 0; i < count / 2; i++) {
+        EXPECT_EQ(gEntries[i].key, entries[i].key);
+        EXPECT_EQ(gEntries[i].value, entries[i].value);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, hashTableFree(pHashTable));
+}
+
+TEST(FunctionalTest, HashTableOpenAddressingMatchesBuckets)
+{
+    PHashTable pBucketTable, pOpenTable;
+    UINT64 key, bucketValue, openValue;
+    UINT32 i, bucketCount, openCount;
+
+    EXPECT_EQ(STATUS_SUCCESS, hashTableCreateWithParams(MIN_HASH_BUCKET_COUNT, 2, &pBucketTable));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableCreateOpenAddressing(MIN_HASH_BUCKET_COUNT, &pOpenTable));
+
+    // Random operations over a small key range to exercise the collisions and the back shifting
+    SRAND(12345);
+    for (i = 0; i < 100000; i++) {
+        key = RAND() % 2000;
+        switch (RAND() % 4) {
+            case 0:
+                EXPECT_EQ(hashTablePut(pBucketTable, key, i), hashTablePut(pOpenTable, key, i));
+                break;
+            case 1:
+                EXPECT_EQ(hashTableUpsert(pBucketTable, key, i), hashTableUpsert(pOpenTable, key, i));
+                break;
+            case 2:
+                EXPECT_EQ(hashTableRemove(pBucketTable, key), hashTableRemove(pOpenTable, key));
+                break;
+            default:
+                bucketValue = openValue = 0;
+                EXPECT_EQ(hashTableGet(pBucketTable, key, &bucketValue), hashTableGet(pOpenTable, key, &openValue));
+                EXPECT_EQ(bucketValue, openValue);
+                break;
+        }
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetCount(pBucketTable, &bucketCount));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableGetCount(pOpenTable, &openCount));
+    EXPECT_EQ(bucketCount, openCount);
+    for (key = 0; key < 2000; key++) {
+        bucketValue = openValue = 0;
+        EXPECT_EQ(hashTableGet(pBucketTable, key, &bucketValue), hashTableGet(pOpenTable, key, &openValue));
+        EXPECT_EQ(bucketValue, openValue);
+    }
+
+    EXPECT_EQ(STATUS_SUCCESS, hashTableFree(pBucketTable));
+    EXPECT_EQ(STATUS_SUCCESS, hashTableFree(pOpenTable));
+}
+
+/**
+ * Compares the bucket table with the default parameters to the open addressing table
+ * for inserting, looking up the present and the missing keys and removing.
+ */
+TEST(BenchmarkTest, HashTableBucketsVsOpenAddressing)
+{
+    PHashTable pHashTable;
+    UINT64 count = 200000, key, val, time[2][4];
+    UINT32 type, phase;
+    BOOL contains;
+
+    for (type = 0; type < 2; type++) {
+        if (type == 0) {
+            EXPECT_EQ(STATUS_SUCCESS, hashTableCreate(&pHashTable));
+        } else {
+            EXPECT_EQ(STATUS_SUCCESS, hashTableCreateOpenAddressing(MIN_HASH_BUCKET_COUNT, &pHashTable));
+        }
+
+        for (phase = 0; phase < 4; phase++) {
+            time[type][phase] = GETTIME();
+            for (UINT64 i = 0; i < count; i++) {
+                // Spread the keys like handles and pointers
+                key = i * 0x9E3779B97F4A7C15ULL;
+                switch (phase) {
+                    case 0:
+                        EXPECT_EQ(STATUS_SUCCESS, hashTablePut(pHashTable, key, i));
+                        break;
+                    case 1:
+                        EXPECT_EQ(STATUS_SUCCESS, hashTableGet(pHashTable, key, &val));
+                        break;
+                    case 2:
+                        EXPECT_EQ(STATUS_SUCCESS, hashTableContains(pHashTable, key + 1, &contains));
+                        break;
+                    default:
+                        EXPECT_EQ(STATUS_SUCCESS, hashTableRemove(pHashTable, key));
+                        break;
+                }
+            }
+
+            time[type][phase] = GETTIME() - time[type][phase];
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, hashTableIsEmpty(pHashTable, &contains));
+        EXPECT_TRUE(contains);
+        EXPECT_EQ(STATUS_SUCCESS, hashTableFree(pHashTable));
+    }
+
+    DLOGI("%" PRIu64 " items, ns/op put/get/miss/remove. Buckets: %" PRIu64 "/%" PRIu64 "/%" PRIu64 "/%" PRIu64
+          ", open addressing: %" PRIu64 "/%" PRIu64 "/%" PRIu64 "/%" PRIu64, count,
+          time[0][0] * 100 / count, time[0][1] * 100 / count, time[0][2] * 100 / count, time[0][3] * 100 / count,
+          time[1][0] * 100 / count, time[1][1] * 100 / count, time[1][2] * 100 / count, time[1][3] * 100 / count);
+}
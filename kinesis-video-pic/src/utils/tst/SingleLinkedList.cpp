@@ -1,5 +1,4 @@
-#include "gtest/gtest.h"
-#include <com/amazonaws/kinesis/video/utils/Include.h>
+#include "UtilsTestFixture.h"
 
 TEST(NegativeInvalidInput, SingleListCreate)
 {
@@ -502,3 +501,127 @@ TEST(FunctionalTest, SingleListInsertAfter)
     // Destroy the list
     EXPECT_EQ(STATUS_SUCCESS, singleListFree(pList));
 }
+
+class SingleListPoolTest : public UtilsTestBase {
+};
+
+TEST_F(SingleListPoolTest, SingleListCreateWithPool)
+{
+    PSingleList pList;
+
+    EXPECT_NE(STATUS_SUCCESS, singleListCreateWithPool(10, TRUE, NULL));
+    EXPECT_NE(STATUS_SUCCESS, singleListCreateWithPool(0, TRUE, &pList));
+    EXPECT_EQ(0, gAllocationCount);
+
+    // The list, the pool and its first slab are a single allocation
+    EXPECT_EQ(STATUS_SUCCESS, singleListCreateWithPool(10, FALSE, &pList));
+    EXPECT_EQ(1, gAllocationCount);
+    EXPECT_EQ(STATUS_SUCCESS, singleListFree(pList));
+    EXPECT_EQ(1, gFreeCount);
+}
+
+TEST_F(SingleListPoolTest, SingleListFixedPoolNoAllocations)
+{
+    PSingleList pList;
+    UINT64 data;
+    UINT32 retCount;
+
+    EXPECT_EQ(STATUS_SUCCESS, singleListCreateWithPool(4, FALSE, &pList));
+
+    for (UINT64 i = 0; i < 4; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, singleListInsertItemTail(pList, i));
+    }
+
+    // The fixed pool is exhausted
+    EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY, singleListInsertItemHead(pList, 4));
+    EXPECT_EQ(STATUS_SUCCESS, singleListGetNodeCount(pList, &retCount));
+    EXPECT_EQ(4, retCount);
+
+    // Steady state queue operation reuses the freed nodes
+    for (UINT64 i = 4; i < 1000; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, singleListGetNodeDataAt(pList, 0, &data));
+        EXPECT_EQ(i - 4, data);
+        EXPECT_EQ(STATUS_SUCCESS, singleListDeleteHead(pList));
+        EXPECT_EQ(STATUS_SUCCESS, singleListInsertItemTail(pList, i));
+    }
+
+    EXPECT_EQ(1, gAllocationCount);
+    EXPECT_EQ(0, gFreeCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, singleListClear(pList));
+    EXPECT_EQ(0, gFreeCount);
+    EXPECT_EQ(STATUS_SUCCESS, singleListFree(pList));
+    EXPECT_EQ(1, gFreeCount);
+}
+
+TEST_F(SingleListPoolTest, SingleListGrowingPool)
+{
+    PSingleList pList;
+    UINT64 data;
+
+    EXPECT_EQ(STATUS_SUCCESS, singleListCreateWithPool(2, TRUE, &pList));
+
+    // The slabs double - 2 + 4 + 8 nodes
+    for (UINT64 i = 0; i < 14; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, singleListInsertItemTail(pList, i));
+    }
+
+    EXPECT_EQ(3, gAllocationCount);
+    EXPECT_EQ(STATUS_SUCCESS, singleListInsertItemAfter(pList, pList->pHead, 100));
+    EXPECT_EQ(4, gAllocationCount);
+
+    // Removal and re-insertion don't touch the heap
+    for (UINT64 i = 0; i < 15; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, singleListDeleteNode(pList, pList->pTail));
+    }
+
+    for (UINT64 i = 0; i < 15; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, singleListInsertItemHead(pList, i));
+    }
+
+    for (UINT32 i = 0; i < 15; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, singleListGetNodeDataAt(pList, i, &data));
+        EXPECT_EQ(14 - i, data);
+    }
+
+    EXPECT_EQ(4, gAllocationCount);
+    EXPECT_EQ(0, gFreeCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, singleListFree(pList));
+    EXPECT_EQ(4, gFreeCount);
+}
+
+TEST_F(SingleListPoolTest, SingleListPoolCallerNode)
+{
+    PSingleList pList;
+    PSingleListNode pNode = (PSingleListNode) MEMCALLOC(1, SIZEOF(SingleListNode));
+
+    EXPECT_EQ(STATUS_SUCCESS, singleListCreateWithPool(2, FALSE, &pList));
+    EXPECT_EQ(STATUS_SUCCESS, singleListInsertItemTail(pList, 0));
+    EXPECT_EQ(STATUS_SUCCESS, singleListInsertNodeTail(pList, pNode));
+    EXPECT_EQ(STATUS_SUCCESS, singleListInsertItemTail(pList, 2));
+    EXPECT_EQ(2, gAllocationCount);
+
+    // The caller allocated node is freed to the heap rather than added to the pool
+    EXPECT_EQ(STATUS_SUCCESS, singleListDeleteNode(pList, pNode));
+    EXPECT_EQ(1, gFreeCount);
+    EXPECT_EQ(STATUS_NOT_ENOUGH_MEMORY, singleListInsertItemTail(pList, 3));
+
+    EXPECT_EQ(STATUS_SUCCESS, singleListFree(pList));
+    EXPECT_EQ(2, gFreeCount);
+}
+
+TEST_F(SingleListPoolTest, SingleListNoPoolAllocatesPerItem)
+{
+    PSingleList pList;
+
+    EXPECT_EQ(STATUS_SUCCESS, singleListCreate(&pList));
+    for (UINT64 i = 0; i < 10; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, singleListInsertItemTail(pList, i));
+        EXPECT_EQ(STATUS_SUCCESS, singleListDeleteHead(pList));
+    }
+
+    EXPECT_EQ(11, gAllocationCount);
+    EXPECT_EQ(10, gFreeCount);
+    EXPECT_EQ(STATUS_SUCCESS, singleListFree(pList));
+}
@@ -1,5 +1,4 @@
-#include "gtest/gtest.h"
-#include <com/amazonaws/kinesis/video/utils/Include.h>
+#include "UtilsTestFixture.h"
 
 TEST(NegativeInvalidInput, StackQueueCreate)
 {
@@ -379,4 +378,45 @@ TEST(FunctionalTest, StackQueueIteratorOperations)
 
     // Destroy the list
     EXPECT_EQ(STATUS_SUCCESS, stackQueueFree(pStackQueue));
-}
\ No newline at end of file
+}
+class StackQueuePoolTest : public UtilsTestBase {
+};
+
+TEST_F(StackQueuePoolTest, StackQueueSteadyStateNoAllocations)
+{
+    PStackQueue pStackQueue;
+    UINT64 data;
+
+    EXPECT_NE(STATUS_SUCCESS, stackQueueCreateWithPool(10, TRUE, NULL));
+    EXPECT_NE(STATUS_SUCCESS, stackQueueCreateWithPool(0, TRUE, &pStackQueue));
+
+    EXPECT_EQ(STATUS_SUCCESS, stackQueueCreateWithPool(8, TRUE, &pStackQueue));
+    EXPECT_EQ(1, gAllocationCount);
+
+    // Enqueue, remove and dequeue within the pool capacity
+    for (UINT64 i = 0; i < 1000; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, stackQueueEnqueue(pStackQueue, i));
+        EXPECT_EQ(STATUS_SUCCESS, stackQueueEnqueue(pStackQueue, i + 1));
+        EXPECT_EQ(STATUS_SUCCESS, stackQueuePush(pStackQueue, i + 2));
+        EXPECT_EQ(STATUS_SUCCESS, stackQueueRemoveItem(pStackQueue, i + 1));
+        EXPECT_EQ(STATUS_SUCCESS, stackQueuePop(pStackQueue, &data));
+        EXPECT_EQ(i + 2, data);
+        EXPECT_EQ(STATUS_SUCCESS, stackQueueDequeue(pStackQueue, &data));
+        EXPECT_EQ(i, data);
+    }
+
+    EXPECT_EQ(1, gAllocationCount);
+    EXPECT_EQ(0, gFreeCount);
+
+    // Growing past the capacity adds a single slab
+    for (UINT64 i = 0; i < 20; i++) {
+        EXPECT_EQ(STATUS_SUCCESS, stackQueueEnqueue(pStackQueue, i));
+    }
+
+    EXPECT_EQ(2, gAllocationCount);
+    EXPECT_EQ(STATUS_SUCCESS, stackQueueClear(pStackQueue));
+    EXPECT_EQ(0, gFreeCount);
+
+    EXPECT_EQ(STATUS_SUCCESS, stackQueueFree(pStackQueue));
+    EXPECT_EQ(2, gFreeCount);
+}
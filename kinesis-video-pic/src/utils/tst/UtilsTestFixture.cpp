@@ -0,0 +1,4 @@
+#include "UtilsTestFixture.h"
+
+UINT32 gAllocationCount = 0;
+UINT32 gFreeCount = 0;
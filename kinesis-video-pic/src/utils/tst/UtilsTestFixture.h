@@ -0,0 +1,70 @@
+#include "gtest/gtest.h"
+#include <com/amazonaws/kinesis/video/utils/Include.h>
+
+//
+// Allocation counting allocator functions
+//
+extern UINT32 gAllocationCount;
+extern UINT32 gFreeCount;
+
+INLINE PVOID countingMemAlloc(UINT32 size)
+{
+    gAllocationCount++;
+    return malloc(size);
+}
+
+INLINE PVOID countingMemAlignAlloc(UINT32 size, UINT32 alignment)
+{
+    // Just do malloc
+    UNUSED_PARAM(alignment);
+    return countingMemAlloc(size);
+}
+
+INLINE PVOID countingMemCalloc(UINT32 num, UINT32 size)
+{
+    gAllocationCount++;
+    return calloc(num, size);
+}
+
+INLINE VOID countingMemFree(PVOID ptr)
+{
+    gFreeCount++;
+    free(ptr);
+}
+
+/**
+ * Counts the heap allocations made through the global allocators for the duration of the test
+ */
+class UtilsTestBase : public ::testing::Test {
+public:
+    UtilsTestBase() : mMemAlloc(globalMemAlloc),
+                      mMemAlignAlloc(globalMemAlignAlloc),
+                      mMemCalloc(globalMemCalloc),
+                      mMemFree(globalMemFree)
+    {
+        gAllocationCount = 0;
+        gFreeCount = 0;
+
+        globalMemAlloc = countingMemAlloc;
+        globalMemAlignAlloc = countingMemAlignAlloc;
+        globalMemCalloc = countingMemCalloc;
+        globalMemFree = countingMemFree;
+    }
+
+    ~UtilsTestBase()
+    {
+        // Every allocation has been freed
+        EXPECT_EQ(gAllocationCount, gFreeCount);
+
+        globalMemAlloc = mMemAlloc;
+        globalMemAlignAlloc = mMemAlignAlloc;
+        globalMemCalloc = mMemCalloc;
+        globalMemFree = mMemFree;
+    }
+
+protected:
+    memAlloc mMemAlloc;
+    memAlignAlloc mMemAlignAlloc;
+    memCalloc mMemCalloc;
+    memFree mMemFree;
+};
@@ -63,6 +63,9 @@ extern "C" {
 #define ITEM_FLAG_FRAGMENT_START                     (0x1 << 1)
 #define ITEM_FLAG_BUFFERING_ACK                      (0x1 << 2)
 #define ITEM_FLAG_RECEIVED_ACK                       (0x1 << 3)
+#define ITEM_FLAG_STREAM_ARENA                       (0x1 << 4)
+#define ITEM_FLAG_FRAGMENT_STORAGE                   (0x1 << 5)
+#define ITEM_FLAG_FRAME_REFERENCE                    (0x1 << 6)
 
 /**
  * Macros for checking/setting/clearing for various flags
@@ -71,16 +74,25 @@ extern "C" {
 #define CHECK_ITEM_BUFFERING_ACK(f)                 (((f) & ITEM_FLAG_BUFFERING_ACK) != ITEM_FLAG_NONE)
 #define CHECK_ITEM_RECEIVED_ACK(f)                  (((f) & ITEM_FLAG_RECEIVED_ACK) != ITEM_FLAG_NONE)
 #define CHECK_ITEM_STREAM_START(f)                  (((f) & ITEM_FLAG_STREAM_START) != ITEM_FLAG_NONE)
+#define CHECK_ITEM_STREAM_ARENA(f)                  (((f) & ITEM_FLAG_STREAM_ARENA) != ITEM_FLAG_NONE)
+#define CHECK_ITEM_FRAGMENT_STORAGE(f)              (((f) & ITEM_FLAG_FRAGMENT_STORAGE) != ITEM_FLAG_NONE)
+#define CHECK_ITEM_FRAME_REFERENCE(f)               (((f) & ITEM_FLAG_FRAME_REFERENCE) != ITEM_FLAG_NONE)
 
 #define SET_ITEM_FRAGMENT_START(f)                  ((f) |= ITEM_FLAG_FRAGMENT_START)
 #define SET_ITEM_BUFFERING_ACK(f)                   ((f) |= ITEM_FLAG_BUFFERING_ACK)
 #define SET_ITEM_RECEIVED_ACK(f)                    ((f) |= ITEM_FLAG_RECEIVED_ACK)
 #define SET_ITEM_STREAM_START(f)                    ((f) |= ITEM_FLAG_STREAM_START)
+#define SET_ITEM_STREAM_ARENA(f)                    ((f) |= ITEM_FLAG_STREAM_ARENA)
+#define SET_ITEM_FRAGMENT_STORAGE(f)                ((f) |= ITEM_FLAG_FRAGMENT_STORAGE)
+#define SET_ITEM_FRAME_REFERENCE(f)                 ((f) |= ITEM_FLAG_FRAME_REFERENCE)
 
 #define CLEAR_ITEM_FRAGMENT_START(f)                ((f) &= ~ITEM_FLAG_FRAGMENT_START)
 #define CLEAR_ITEM_BUFFERING_ACK(f)                 ((f) &= ~ITEM_FLAG_BUFFERING_ACK)
 #define CLEAR_ITEM_RECEIVED_ACK(f)                  ((f) &= ~ITEM_FLAG_RECEIVED_ACK)
 #define CLEAR_ITEM_STREAM_START(f)                  ((f) &= ~ITEM_FLAG_STREAM_START)
+#define CLEAR_ITEM_STREAM_ARENA(f)                  ((f) &= ~ITEM_FLAG_STREAM_ARENA)
+#define CLEAR_ITEM_FRAGMENT_STORAGE(f)              ((f) &= ~ITEM_FLAG_FRAGMENT_STORAGE)
+#define CLEAR_ITEM_FRAME_REFERENCE(f)               ((f) &= ~ITEM_FLAG_FRAME_REFERENCE)
 
 #define GET_ITEM_DATA_OFFSET(f)                     ((UINT16) ((f) >> 16))
 #define SET_ITEM_DATA_OFFSET(f, o)                  (((f) &= 0x0000ffff) |= (((UINT16) (o)) << 16))
@@ -116,6 +128,9 @@ typedef struct {
 
     // The data allocation handle
     ALLOCATION_HANDLE handle;
+
+    // Offset of the data within the allocation. Non-zero when the allocation is shared by multiple items.
+    UINT32 allocationOffset;
 } ViewItem, *PViewItem;
 
 /**
@@ -200,6 +215,16 @@ PUBLIC_API STATUS contentViewTimestampInRange(PContentView, UINT64, PBOOL);
  */
 PUBLIC_API STATUS contentViewGetNext(PContentView, PViewItem*);
 
+/**
+ * Gets the next fragment start item from the current and advances the current past it.
+ * The current is moved to the head if there are no more fragment start items.
+ *
+ * PContentView - Content view
+ * PViewItem* - The fragment start item pointer
+ *
+ */
+PUBLIC_API STATUS contentViewGetNextFragmentStart(PContentView, PViewItem*);
+
 /**
  * Gets an item from the given index. Current remains untouched.
  *
@@ -220,6 +245,17 @@ PUBLIC_API STATUS contentViewGetItemAt(PContentView, UINT64, PViewItem*);
  */
 PUBLIC_API STATUS contentViewGetItemWithTimestamp(PContentView, UINT64, PViewItem*);
 
+/**
+ * Sets the data length of an existing item. The item length should not be modified directly
+ * as the view keeps a running allocation size of the window.
+ *
+ * PContentView - Content view
+ * UINT64 - the index of the item
+ * UINT32 - the new size of the data in bytes
+ *
+ */
+PUBLIC_API STATUS contentViewSetItemLength(PContentView, UINT64, UINT32);
+
 /**
  * Gets the current index
  *
@@ -25,13 +25,15 @@ STATUS createContentView(UINT32 maxItemCount, UINT64 bufferDuration, ContentView
 
     // Allocate the main struct
     // NOTE: The calloc will Zero the fields
-    // NOTE: The actual rolling buffer follows the structure
-    allocationSize = SIZEOF(RollingContentView) + SIZEOF(ViewItem) * maxItemCount;
+    // NOTE: The actual rolling buffer follows the structure followed by the item end offsets and the fragment start ring
+    allocationSize = SIZEOF(RollingContentView) + (SIZEOF(ViewItem) + SIZEOF(UINT64) + SIZEOF(UINT64)) * maxItemCount;
     pContentView = (PRollingContentView) MEMCALLOC(1, allocationSize);
     CHK(pContentView != NULL, STATUS_NOT_ENOUGH_MEMORY);
 
-    // Set the pointer
+    // Set the pointers
     pContentView->itemBuffer = (PViewItem)(pContentView + 1);
+    pContentView->itemEndOffsets = (PUINT64)(pContentView->itemBuffer + maxItemCount);
+    pContentView->fragmentBuffer = pContentView->itemEndOffsets + maxItemCount;
 
     // Set the values
     pContentView->contentView.version = CONTENT_VIEW_CURRENT_VERSION;
@@ -152,6 +154,7 @@ STATUS contentViewGetNext(PContentView pContentView, PViewItem* ppItem)
 
     // Increment the current
     pRollingView->current++;
+    pRollingView->currentAllocationSize -= pCurrent->length;
 
     *ppItem = pCurrent;
 
@@ -161,6 +164,38 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Gets the next fragment start item and advances the current past it
+ */
+STATUS contentViewGetNextFragmentStart(PContentView pContentView, PViewItem* ppItem)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRollingContentView pRollingView = (PRollingContentView) pContentView;
+    UINT64 position, index;
+
+    // Check the input params
+    CHK(pContentView != NULL && ppItem != NULL, STATUS_NULL_ARG);
+
+    // Find the first fragment start at or after the current
+    position = findFragmentStartPosition(pRollingView, pRollingView->current);
+    if (position == pRollingView->fragmentHead) {
+        // No more fragments - consume the rest of the items
+        moveCurrentIndex(pRollingView, pRollingView->head);
+        CHK(FALSE, STATUS_CONTENT_VIEW_NO_MORE_ITEMS);
+    }
+
+    index = GET_FRAGMENT_START_INDEX(pRollingView, position);
+    moveCurrentIndex(pRollingView, index + 1);
+
+    *ppItem = GET_VIEW_ITEM_FROM_INDEX(pRollingView, index);
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 /**
  * Gets an item from the given index. Current remains untouched.
  */
@@ -211,6 +246,43 @@ CleanUp:
     return retStatus;
 }
 
+/**
+ * Sets the item length and adjusts the running allocation sizes
+ */
+STATUS contentViewSetItemLength(PContentView pContentView, UINT64 itemIndex, UINT32 length)
+{
+    ENTERS();
+    STATUS retStatus = STATUS_SUCCESS;
+    PRollingContentView pRollingView = (PRollingContentView) pContentView;
+    PViewItem pItem;
+    UINT64 index;
+
+    // Check the input params
+    CHK(pContentView != NULL, STATUS_NULL_ARG);
+    CHK(length > 0, STATUS_INVALID_CONTENT_VIEW_LENGTH);
+    CHK(itemIndex >= pRollingView->tail && itemIndex < pRollingView->head, STATUS_CONTENT_VIEW_INVALID_INDEX);
+
+    pItem = GET_VIEW_ITEM_FROM_INDEX(pRollingView, itemIndex);
+
+    pRollingView->windowAllocationSize = pRollingView->windowAllocationSize - pItem->length + length;
+    if (itemIndex >= pRollingView->current) {
+        pRollingView->currentAllocationSize = pRollingView->currentAllocationSize - pItem->length + length;
+    }
+
+    // Shift the end offsets of the item and the ones following it
+    for (index = itemIndex; index < pRollingView->head; index++) {
+        GET_ITEM_END_OFFSET(pRollingView, index) = GET_ITEM_END_OFFSET(pRollingView, index) - pItem->length + length;
+    }
+
+    pRollingView->streamOffset = pRollingView->streamOffset - pItem->length + length;
+    pItem->length = length;
+
+CleanUp:
+
+    LEAVES();
+    return retStatus;
+}
+
 
 /**
  * Gets the current item index
@@ -245,7 +317,7 @@ STATUS contentViewSetCurrentIndex(PContentView pContentView, UINT64 index)
     CHK(pContentView != NULL, STATUS_NULL_ARG);
     CHK(index >= pRollingView->tail && index <= pRollingView->head, STATUS_CONTENT_VIEW_INVALID_INDEX);
 
-    pRollingView->current = index;
+    moveCurrentIndex(pRollingView, index);
 
 CleanUp:
 
@@ -262,7 +334,7 @@ STATUS contentViewRollbackCurrent(PContentView pContentView, UINT64 duration, BO
     STATUS retStatus = STATUS_SUCCESS;
     PViewItem pCurrent = NULL;
     UINT64 timestamp;
-    UINT64 curIndex, lastIndex;
+    UINT64 curIndex, lastIndex, newIndex, position;
     PRollingContentView pRollingView = (PRollingContentView) pContentView;
 
     // Check the input params
@@ -272,36 +344,47 @@ STATUS contentViewRollbackCurrent(PContentView pContentView, UINT64 duration, BO
     CHK(pRollingView->current != pRollingView->tail && duration != 0, STATUS_SUCCESS);
 
     // Get the timestamp of the current
-    curIndex = lastIndex = pRollingView->current;
+    curIndex = lastIndex = newIndex = pRollingView->current;
     pCurrent = GET_VIEW_ITEM_FROM_INDEX(pRollingView, curIndex);
     timestamp = pCurrent->timestamp;
 
-    while (TRUE) {
-        pCurrent = GET_VIEW_ITEM_FROM_INDEX(pRollingView, curIndex);
+    // Find the position in the fragment start ring of the first fragment start after the current
+    position = findFragmentStartPosition(pRollingView, curIndex + 1);
 
-        // If we don't need a key frame or we need a key frame and the current is a fragment start
-        if (!keyFrame || CHECK_ITEM_FRAGMENT_START(pCurrent->flags)) {
-            // Set the current
-            pRollingView->current = curIndex;
-
-            // Check for the Ack first
-            if (lastReceivedAck && CHECK_ITEM_RECEIVED_ACK(pCurrent->flags)) {
-                // We have the start of the fragment and received Ack.
-                // Move forward till next fragment start and set it as current
-                pRollingView->current = lastIndex;
+    while (TRUE) {
+        // If we need a key frame then iterate over the fragment start items only
+        if (keyFrame) {
+            // Terminate the loop if we have no more fragment starts
+            if (position == pRollingView->fragmentTail) {
                 break;
             }
 
-            // If we have the current item with timestamp and duration
-            // earlier than the specified timestamp then we terminate
-            if (pCurrent->timestamp + duration <= timestamp) {
-                break;
-            }
+            position--;
+            curIndex = GET_FRAGMENT_START_INDEX(pRollingView, position);
+        }
+
+        pCurrent = GET_VIEW_ITEM_FROM_INDEX(pRollingView, curIndex);
+
+        // Set the current
+        newIndex = curIndex;
+
+        // Check for the Ack first
+        if (lastReceivedAck && CHECK_ITEM_RECEIVED_ACK(pCurrent->flags)) {
+            // We have the start of the fragment and received Ack.
+            // Move forward till next fragment start and set it as current
+            newIndex = lastIndex;
+            break;
+        }
 
-            // Store the last index
-            lastIndex = curIndex;
+        // If we have the current item with timestamp and duration
+        // earlier than the specified timestamp then we terminate
+        if (pCurrent->timestamp + duration <= timestamp) {
+            break;
         }
 
+        // Store the last index
+        lastIndex = curIndex;
+
         // Terminate the loop if we reached the tail
         if (curIndex == pRollingView->tail) {
             break;
@@ -311,6 +394,9 @@ STATUS contentViewRollbackCurrent(PContentView pContentView, UINT64 duration, BO
         curIndex--;
     }
 
+    // Set the current
+    moveCurrentIndex(pRollingView, newIndex);
+
 CleanUp:
 
     LEAVES();
@@ -330,7 +416,7 @@ STATUS contentViewResetCurrent(PContentView pContentView)
     CHK(pContentView != NULL, STATUS_NULL_ARG);
 
     // Start from the current and iterate
-    pRollingView->current = pRollingView->tail;
+    moveCurrentIndex(pRollingView, pRollingView->tail);
 
 CleanUp:
 
@@ -438,10 +524,18 @@ STATUS contentViewAddItem(PContentView pContentView, UINT64 timestamp, UINT64 du
                 pHead->timestamp + pHead->duration - pTail->timestamp >= pRollingView->bufferDuration) {
             // Move the tail first
             pRollingView->tail++;
+            pRollingView->windowAllocationSize -= pTail->length;
+
+            // Drop the fragment start if it has been evicted
+            if (pRollingView->fragmentTail != pRollingView->fragmentHead &&
+                    GET_FRAGMENT_START_INDEX(pRollingView, pRollingView->fragmentTail) < pRollingView->tail) {
+                pRollingView->fragmentTail++;
+            }
 
             // Move the current if needed
             if (pRollingView->current < pRollingView->tail) {
                 pRollingView->current = pRollingView->tail;
+                pRollingView->currentAllocationSize -= pTail->length;
                 currentRemoved = TRUE;
             }
 
@@ -459,11 +553,24 @@ STATUS contentViewAddItem(PContentView pContentView, UINT64 timestamp, UINT64 du
     pHead->duration = duration;
     pHead->flags = flags;
     pHead->handle = allocHandle;
+    pHead->allocationOffset = 0;
     pHead->length = length;
     pHead->index = pRollingView->head;
     SET_ITEM_DATA_OFFSET(pHead->flags, offset);
 
+    // Store the running end offset
+    pRollingView->streamOffset += length;
+    GET_ITEM_END_OFFSET(pRollingView, pRollingView->head) = pRollingView->streamOffset;
+
+    // Index the fragment start
+    if (CHECK_ITEM_FRAGMENT_START(flags)) {
+        GET_FRAGMENT_START_INDEX(pRollingView, pRollingView->fragmentHead) = pRollingView->head;
+        pRollingView->fragmentHead++;
+    }
+
     pRollingView->head++;
+    pRollingView->windowAllocationSize += length;
+    pRollingView->currentAllocationSize += length;
 
 CleanUp:
 
@@ -490,10 +597,18 @@ STATUS contentViewRemoveAll(PContentView pContentView)
 
         // Move the tail first
         pRollingView->tail++;
+        pRollingView->windowAllocationSize -= pTail->length;
+
+        // Drop the fragment start if it has been removed
+        if (pRollingView->fragmentTail != pRollingView->fragmentHead &&
+                GET_FRAGMENT_START_INDEX(pRollingView, pRollingView->fragmentTail) < pRollingView->tail) {
+            pRollingView->fragmentTail++;
+        }
 
         // Move the current if needed
         if (pRollingView->current < pRollingView->tail) {
             pRollingView->current = pRollingView->tail;
+            pRollingView->currentAllocationSize -= pTail->length;
             currentRemoved = TRUE;
         } else {
             currentRemoved = FALSE;
@@ -529,10 +644,18 @@ STATUS contentViewTrimTail(PContentView pContentView, UINT64 itemIndex)
 
         // Move the tail first
         pRollingView->tail++;
+        pRollingView->windowAllocationSize -= pTail->length;
+
+        // Drop the fragment start if it has been removed
+        if (pRollingView->fragmentTail != pRollingView->fragmentHead &&
+                GET_FRAGMENT_START_INDEX(pRollingView, pRollingView->fragmentTail) < pRollingView->tail) {
+            pRollingView->fragmentTail++;
+        }
 
         // Move the current if needed
         if (pRollingView->current < pRollingView->tail) {
             pRollingView->current = pRollingView->tail;
+            pRollingView->currentAllocationSize -= pTail->length;
             currentRemoved = TRUE;
         } else {
             currentRemoved = FALSE;
@@ -630,51 +753,21 @@ CleanUp:
 }
 
 /**
- * Gets the view's window allocation size and entire window allocation size (optionally)
+ * Gets the view's window allocation size and entire window allocation size (optionally).
+ * NOTE: The sizes are maintained as the items are added, consumed and removed.
  */
 STATUS contentViewGetWindowAllocationSize(PContentView pContentView, PUINT64 pCurrentAllocationSize, PUINT64 pWindowAllocationSize)
 {
     ENTERS();
     STATUS retStatus = STATUS_SUCCESS;
     PRollingContentView pRollingView = (PRollingContentView) pContentView;
-    PViewItem pCurrent;
     UINT64 currentAllocationSize = 0, windowAllocationSize = 0;
-    UINT64 curIndex;
 
     // Check the input params
     CHK(pContentView != NULL && pCurrentAllocationSize != NULL, STATUS_NULL_ARG);
 
-    // Quick check if any items exist - early return
-    CHK(pRollingView->head != pRollingView->tail, STATUS_SUCCESS);
-
-    // Quick check if we need to calculate the current and the current is at the head and no overall window size is specified
-    CHK(pRollingView->head != pRollingView->current || pWindowAllocationSize != NULL, STATUS_SUCCESS);
-
-    curIndex = pRollingView->head - 1;
-    while (TRUE) {
-        pCurrent = GET_VIEW_ITEM_FROM_INDEX(pRollingView, curIndex);
-
-        if (curIndex >= pRollingView->current && pRollingView->head != pRollingView->current) {
-            // Add to the current window size
-            currentAllocationSize += pCurrent->length;
-        }
-
-        // Add to the overall window size
-        windowAllocationSize += pCurrent->length;
-
-        // Check if we need to terminate after the current if the whole window is not specified
-        if (curIndex == pRollingView->current && pWindowAllocationSize == NULL) {
-            break;
-        }
-
-        // Terminate the loop if we reached the tail
-        if (curIndex == pRollingView->tail) {
-            break;
-        }
-
-        // Iterate backwards
-        curIndex--;
-    }
+    currentAllocationSize = pRollingView->currentAllocationSize;
+    windowAllocationSize = pRollingView->windowAllocationSize;
 
 CleanUp:
 
@@ -724,4 +817,43 @@ PViewItem findViewItemWithTimestamp(PRollingContentView pView, PViewItem pOldest
     }
 
     return pCurItem;
-}
\ No newline at end of file
+}
+
+/**
+ * Moves the current to the specified index and sets the running current allocation size
+ * from the running end offsets of the items.
+ */
+VOID moveCurrentIndex(PRollingContentView pView, UINT64 index)
+{
+    PViewItem pItem;
+
+    pView->current = index;
+
+    if (index == pView->head) {
+        pView->currentAllocationSize = 0;
+    } else {
+        pItem = GET_VIEW_ITEM_FROM_INDEX(pView, index);
+        pView->currentAllocationSize = pView->streamOffset - (GET_ITEM_END_OFFSET(pView, index) - pItem->length);
+    }
+}
+
+/**
+ * Finds the position in the fragment start ring of the first fragment start with
+ * the index greater or equal to the specified one using binary search method.
+ * Returns the fragment head position if none is found.
+ */
+UINT64 findFragmentStartPosition(PRollingContentView pView, UINT64 index)
+{
+    UINT64 low = pView->fragmentTail, high = pView->fragmentHead, mid;
+
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (GET_FRAGMENT_START_INDEX(pView, mid) < index) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
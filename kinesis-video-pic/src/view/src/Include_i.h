@@ -27,6 +27,16 @@ extern "C" {
  */
 #define GET_VIEW_ITEM_FROM_INDEX(view, index) (&(view)->itemBuffer[((index) == 0) ? 0 : ((index) % (view)->itemBufferCount)])
 
+/**
+ * Gets the running byte offset of the end of the item with the given index
+ */
+#define GET_ITEM_END_OFFSET(view, index) ((view)->itemEndOffsets[(index) % (view)->itemBufferCount])
+
+/**
+ * Gets the item index of the fragment start at the given fragment ring position
+ */
+#define GET_FRAGMENT_START_INDEX(view, position) ((view)->fragmentBuffer[(position) % (view)->itemBufferCount])
+
 /**
  * ContentView internal structure
  */
@@ -44,6 +54,19 @@ typedef struct {
     // The current location
     UINT64 current;
 
+    // Running allocation size of the items from the current to the head
+    UINT64 currentAllocationSize;
+
+    // Running allocation size of the items in the entire window
+    UINT64 windowAllocationSize;
+
+    // Running byte offset of the end of the last added item
+    UINT64 streamOffset;
+
+    // The positions of the head and the tail of the fragment start ring
+    UINT64 fragmentHead;
+    UINT64 fragmentTail;
+
     // The custom data for the callback
     UINT64 customData;
 
@@ -59,12 +82,20 @@ typedef struct {
     // The actual buffer which follows immediately after the structure
     PViewItem itemBuffer;
 
+    // Running byte offsets of the item ends which follow the item buffer
+    PUINT64 itemEndOffsets;
+
+    // Ring of fragment start item indexes which follows the item end offsets
+    PUINT64 fragmentBuffer;
+
 } RollingContentView, *PRollingContentView;
 
 ////////////////////////////////////////////////////
 // Internal functionality
 ////////////////////////////////////////////////////
 PViewItem findViewItemWithTimestamp(PRollingContentView, PViewItem, PViewItem, UINT64);
+VOID moveCurrentIndex(PRollingContentView, UINT64);
+UINT64 findFragmentStartPosition(PRollingContentView, UINT64);
 
 #pragma pack(pop, include_i)
 
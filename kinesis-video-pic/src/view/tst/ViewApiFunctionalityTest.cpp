@@ -1081,4 +1081,201 @@ TEST_F(ViewApiFunctionalityTest, DISABLED_IntOverflowRangeCheck)
         ASSERT_EQ(STATUS_SUCCESS, contentViewGetItemWithTimestamp(mContentView, pViewItem->timestamp + pViewItem->duration, &pViewItem));
         ASSERT_EQ(STATUS_SUCCESS, contentViewGetItemWithTimestamp(mContentView, pViewItem->timestamp + pViewItem->duration - 1, &pViewItem));
     }
-}
\ No newline at end of file
+}
+/**
+ * Calculates the allocation sizes by walking the view items
+ */
+VOID walkWindowAllocationSize(PContentView pContentView, PUINT64 pCurrentAllocationSize, PUINT64 pWindowAllocationSize)
+{
+    PRollingContentView pRollingView = (PRollingContentView) pContentView;
+    PViewItem pViewItem;
+    UINT64 index;
+
+    *pCurrentAllocationSize = *pWindowAllocationSize = 0;
+    for (index = pRollingView->tail; index < pRollingView->head; index++) {
+        EXPECT_EQ(STATUS_SUCCESS, contentViewGetItemAt(pContentView, index, &pViewItem));
+        *pWindowAllocationSize += pViewItem->length;
+        if (index >= pRollingView->current) {
+            *pCurrentAllocationSize += pViewItem->length;
+        }
+    }
+}
+
+TEST_F(ViewApiFunctionalityTest, RunningAllocationSizeRandomOperations)
+{
+    UINT32 i, length;
+    UINT64 index, tail, head, timestamp = 0;
+    UINT64 currentAllocationSize, windowAllocationSize, expectedCurrentSize, expectedWindowSize;
+    PViewItem pViewItem;
+
+    CreateContentView();
+    SRAND(0x1234);
+
+    for (i = 0; i < 10000; i++) {
+        switch (RAND() % 8) {
+            case 0:
+            case 1:
+            case 2:
+                // Add an item with a random length which will evict the tail when the view is full
+                length = 1 + RAND() % 1000;
+                EXPECT_EQ(STATUS_SUCCESS, contentViewAddItem(mContentView, timestamp, VIEW_ITEM_DURATION, INVALID_ALLOCATION_HANDLE_VALUE, 0,
+                                                             length, RAND() % 5 == 0 ? ITEM_FLAG_FRAGMENT_START : ITEM_FLAG_NONE));
+                timestamp += VIEW_ITEM_DURATION;
+                break;
+
+            case 3:
+            case 4:
+                contentViewGetNext(mContentView, &pViewItem);
+                break;
+
+            case 5:
+                EXPECT_EQ(STATUS_SUCCESS, contentViewRollbackCurrent(mContentView, (RAND() % 20) * VIEW_ITEM_DURATION, RAND() % 2 == 0, FALSE));
+                break;
+
+            case 6:
+                tail = ((PRollingContentView) mContentView)->tail;
+                head = ((PRollingContentView) mContentView)->head;
+                index = tail + RAND() % (head - tail + 1);
+                if (RAND() % 2 == 0) {
+                    EXPECT_EQ(STATUS_SUCCESS, contentViewSetCurrentIndex(mContentView, index));
+                } else if (index != head) {
+                    EXPECT_EQ(STATUS_SUCCESS, contentViewSetItemLength(mContentView, index, 1 + RAND() % 1000));
+                }
+
+                break;
+
+            default:
+                tail = ((PRollingContentView) mContentView)->tail;
+                head = ((PRollingContentView) mContentView)->head;
+                if (RAND() % 50 == 0) {
+                    EXPECT_EQ(STATUS_SUCCESS, contentViewRemoveAll(mContentView));
+                } else if (head != tail) {
+                    EXPECT_EQ(STATUS_SUCCESS, contentViewTrimTail(mContentView, tail + RAND() % MIN(head - tail, 3)));
+                }
+
+                break;
+        }
+
+        EXPECT_EQ(STATUS_SUCCESS, contentViewGetWindowAllocationSize(mContentView, &currentAllocationSize, &windowAllocationSize));
+        walkWindowAllocationSize(mContentView, &expectedCurrentSize, &expectedWindowSize);
+        EXPECT_EQ(expectedCurrentSize, currentAllocationSize) << "Failed at iteration " << i;
+        EXPECT_EQ(expectedWindowSize, windowAllocationSize) << "Failed at iteration " << i;
+    }
+}
+
+/**
+ * Reference key frame rollback walking the view items one by one
+ */
+UINT64 walkRollbackKeyFrame(PContentView pContentView, UINT64 duration, BOOL lastReceivedAck)
+{
+    PRollingContentView pRollingView = (PRollingContentView) pContentView;
+    PViewItem pViewItem;
+    UINT64 curIndex, lastIndex, newIndex, timestamp;
+
+    if (pRollingView->current == pRollingView->tail || duration == 0) {
+        return pRollingView->current;
+    }
+
+    curIndex = lastIndex = newIndex = pRollingView->current;
+    timestamp = GET_VIEW_ITEM_FROM_INDEX(pRollingView, curIndex)->timestamp;
+
+    while (TRUE) {
+        pViewItem = GET_VIEW_ITEM_FROM_INDEX(pRollingView, curIndex);
+        if (curIndex < pRollingView->head && CHECK_ITEM_FRAGMENT_START(pViewItem->flags)) {
+            newIndex = curIndex;
+            if (lastReceivedAck && CHECK_ITEM_RECEIVED_ACK(pViewItem->flags)) {
+                newIndex = lastIndex;
+                break;
+            }
+
+            if (pViewItem->timestamp + duration <= timestamp) {
+                break;
+            }
+
+            lastIndex = curIndex;
+        }
+
+        if (curIndex == pRollingView->tail) {
+            break;
+        }
+
+        curIndex--;
+    }
+
+    return newIndex;
+}
+
+TEST_F(ViewApiFunctionalityTest, FragmentIndexSparseWrapAround)
+{
+    UINT32 i, fragmentInterval = 1;
+    UINT64 index, curIndex, expectedIndex, timestamp = 0, duration;
+    BOOL lastReceivedAck;
+    PViewItem pViewItem;
+    PRollingContentView pRollingView;
+
+    CreateContentView();
+    pRollingView = (PRollingContentView) mContentView;
+    SRAND(0x4321);
+
+    // Wrap around the item buffer and the fragment ring multiple times
+    for (i = 0; i < 20 * MAX_VIEW_ITEM_COUNT; i++) {
+        // Sparse fragment starts with random intervals
+        if (--fragmentInterval == 0) {
+            fragmentInterval = 1 + RAND() % 15;
+            EXPECT_EQ(STATUS_SUCCESS, contentViewAddItem(mContentView, timestamp, VIEW_ITEM_DURATION, INVALID_ALLOCATION_HANDLE_VALUE, 0,
+                                                         VIEW_ITEM_ALLOCAITON_SIZE, ITEM_FLAG_FRAGMENT_START));
+        } else {
+            EXPECT_EQ(STATUS_SUCCESS, contentViewAddItem(mContentView, timestamp, VIEW_ITEM_DURATION, INVALID_ALLOCATION_HANDLE_VALUE, 0,
+                                                         VIEW_ITEM_ALLOCAITON_SIZE, ITEM_FLAG_NONE));
+        }
+
+        timestamp += VIEW_ITEM_DURATION;
+
+        // Randomly receive ACKs on the fragments
+        EXPECT_EQ(STATUS_SUCCESS, contentViewGetHead(mContentView, &pViewItem));
+        if (CHECK_ITEM_FRAGMENT_START(pViewItem->flags) && RAND() % 3 == 0) {
+            SET_ITEM_RECEIVED_ACK(pViewItem->flags);
+        }
+
+        // Validate the fragment ring has only the fragment starts in the window
+        for (index = pRollingView->fragmentTail; index < pRollingView->fragmentHead; index++) {
+            curIndex = GET_FRAGMENT_START_INDEX(pRollingView, index);
+            EXPECT_TRUE(curIndex >= pRollingView->tail && curIndex < pRollingView->head);
+            EXPECT_TRUE(CHECK_ITEM_FRAGMENT_START(GET_VIEW_ITEM_FROM_INDEX(pRollingView, curIndex)->flags));
+        }
+
+        // Move the current randomly and validate the next fragment start against the item walk
+        EXPECT_EQ(STATUS_SUCCESS, contentViewSetCurrentIndex(mContentView, pRollingView->tail + RAND() % (pRollingView->head - pRollingView->tail + 1)));
+        EXPECT_EQ(STATUS_SUCCESS, contentViewGetCurrentIndex(mContentView, &curIndex));
+        for (expectedIndex = curIndex; expectedIndex < pRollingView->head; expectedIndex++) {
+            if (CHECK_ITEM_FRAGMENT_START(GET_VIEW_ITEM_FROM_INDEX(pRollingView, expectedIndex)->flags)) {
+                break;
+            }
+        }
+
+        if (expectedIndex == pRollingView->head) {
+            EXPECT_EQ(STATUS_CONTENT_VIEW_NO_MORE_ITEMS, contentViewGetNextFragmentStart(mContentView, &pViewItem));
+            EXPECT_EQ(STATUS_SUCCESS, contentViewGetCurrentIndex(mContentView, &index));
+            EXPECT_EQ(pRollingView->head, index);
+        } else {
+            EXPECT_EQ(STATUS_SUCCESS, contentViewGetNextFragmentStart(mContentView, &pViewItem));
+            EXPECT_EQ(expectedIndex, pViewItem->index);
+            EXPECT_EQ(STATUS_SUCCESS, contentViewGetCurrentIndex(mContentView, &index));
+            EXPECT_EQ(expectedIndex + 1, index);
+        }
+
+        // Rollback from a random current and validate against the item walk
+        EXPECT_EQ(STATUS_SUCCESS, contentViewSetCurrentIndex(mContentView, pRollingView->tail + RAND() % (pRollingView->head - pRollingView->tail + 1)));
+        duration = (RAND() % 40) * VIEW_ITEM_DURATION;
+        lastReceivedAck = RAND() % 2 == 0;
+        expectedIndex = walkRollbackKeyFrame(mContentView, duration, lastReceivedAck);
+        EXPECT_EQ(STATUS_SUCCESS, contentViewRollbackCurrent(mContentView, duration, TRUE, lastReceivedAck));
+        EXPECT_EQ(STATUS_SUCCESS, contentViewGetCurrentIndex(mContentView, &index));
+        EXPECT_EQ(expectedIndex, index) << "Failed at iteration " << i;
+    }
+
+    // Removing all of the items should clear the fragment ring
+    EXPECT_EQ(STATUS_SUCCESS, contentViewRemoveAll(mContentView));
+    EXPECT_EQ(pRollingView->fragmentTail, pRollingView->fragmentHead);
+    EXPECT_EQ(STATUS_CONTENT_VIEW_NO_MORE_ITEMS, contentViewGetNextFragmentStart(mContentView, &pViewItem));
+}
@@ -0,0 +1,50 @@
+#include "ViewTestFixture.h"
+
+#define VIEW_PERF_TEST_FPS                      60
+#define VIEW_PERF_TEST_FRAME_COUNT              20000
+#define VIEW_PERF_TEST_FRAME_DURATION           (HUNDREDS_OF_NANOS_IN_A_SECOND / VIEW_PERF_TEST_FPS)
+
+class ViewPerfTest : public ViewTestBase {
+};
+
+/**
+ * Simulates the put frame path which queries the window allocation size after every added item
+ * for the buffer durations up to 5 minutes. The consumer keeps up with the producer so the current
+ * is close to the head while the window is full.
+ */
+TEST_F(ViewPerfTest, WindowAllocationSizeBufferDurationSweep)
+{
+    UINT32 bufferSeconds[] = {10, 30, 60, 120, 300};
+    UINT32 i, j, maxItemCount;
+    UINT64 start, queryTime, currentAllocationSize, windowAllocationSize, timestamp;
+    PContentView pContentView;
+    PViewItem pViewItem;
+
+    for (i = 0; i < ARRAY_SIZE(bufferSeconds); i++) {
+        maxItemCount = bufferSeconds[i] * VIEW_PERF_TEST_FPS + 1;
+        EXPECT_EQ(STATUS_SUCCESS, createContentView(maxItemCount, bufferSeconds[i] * HUNDREDS_OF_NANOS_IN_A_SECOND, NULL, 0, &pContentView));
+
+        // Fill the window first
+        for (j = 0, timestamp = 0; j < maxItemCount; j++, timestamp += VIEW_PERF_TEST_FRAME_DURATION) {
+            EXPECT_EQ(STATUS_SUCCESS, contentViewAddItem(pContentView, timestamp, VIEW_PERF_TEST_FRAME_DURATION, INVALID_ALLOCATION_HANDLE_VALUE, 0, 10000, ITEM_FLAG_NONE));
+            EXPECT_EQ(STATUS_SUCCESS, contentViewGetNext(pContentView, &pViewItem));
+        }
+
+        queryTime = 0;
+        for (j = 0; j < VIEW_PERF_TEST_FRAME_COUNT; j++, timestamp += VIEW_PERF_TEST_FRAME_DURATION) {
+            EXPECT_EQ(STATUS_SUCCESS, contentViewAddItem(pContentView, timestamp, VIEW_PERF_TEST_FRAME_DURATION, INVALID_ALLOCATION_HANDLE_VALUE, 0, 10000, ITEM_FLAG_NONE));
+
+            start = GETTIME();
+            EXPECT_EQ(STATUS_SUCCESS, contentViewGetWindowAllocationSize(pContentView, &currentAllocationSize, &windowAllocationSize));
+            queryTime += GETTIME() - start;
+
+            EXPECT_EQ(10000, currentAllocationSize);
+            EXPECT_EQ(STATUS_SUCCESS, contentViewGetNext(pContentView, &pViewItem));
+        }
+
+        DLOGI("Buffer duration %u seconds with %u items: average window allocation size query %" PRIu64 " ns",
+              bufferSeconds[i], maxItemCount, queryTime * DEFAULT_TIME_UNIT_IN_NANOS / VIEW_PERF_TEST_FRAME_COUNT);
+
+        EXPECT_EQ(STATUS_SUCCESS, freeContentView(pContentView));
+    }
+}
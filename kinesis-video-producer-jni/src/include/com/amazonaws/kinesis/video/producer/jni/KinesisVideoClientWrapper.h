@@ -180,6 +180,8 @@ public:
     void getKinesisVideoStreamMetrics(jlong streamHandle, jobject kinesisVideoStreamMetrics);
     void stopKinesisVideoStream(jlong streamHandle);
     void putKinesisVideoFrame(jlong streamHandle, jobject kinesisVideoFrame);
+    void putKinesisVideoFrameDirect(jlong streamHandle, jobject frameData, jint offset, jint size, jint index, jint flags,
+                                    jlong decodingTs, jlong presentationTs, jlong duration);
     void describeStreamResult(jlong streamHandle, jint httpStatusCode, jobject streamDescription);
     void kinesisVideoStreamTerminated(jlong streamHandle, jlong uploadHandle, jint httpStatusCode);
     void getStreamingEndpointResult(jlong streamHandle, jint httpStatusCode, jstring streamingEndpoint);
@@ -6,9 +6,59 @@
 
 #pragma once
 
+#define KINESIS_VIDEO_FRAME_CLASS_NAME "com/amazonaws/kinesisvideo/producer/KinesisVideoFrame"
+#define READ_RESULT_CLASS_NAME "com/amazonaws/kinesisvideo/producer/ReadResult"
+#define NIO_BUFFER_CLASS_NAME "java/nio/Buffer"
+
+/**
+ * Class references and method IDs of the objects converted on the hot paths. Looked up once when the library
+ * is loaded and read-only afterwards so the per-frame and per-read conversions do no reflection.
+ */
+typedef struct __JniCache JniCache;
+struct __JniCache {
+    // Whether the cache has been successfully initialized
+    BOOL initialized;
+
+    // KinesisVideoFrame class global reference and its getters
+    jclass frameClass;
+    jmethodID frameGetIndexMethodId;
+    jmethodID frameGetFlagsMethodId;
+    jmethodID frameGetDecodingTsMethodId;
+    jmethodID frameGetPresentationTsMethodId;
+    jmethodID frameGetDurationMethodId;
+    jmethodID frameGetSizeMethodId;
+    jmethodID frameGetDataMethodId;
+
+    // Whether the KinesisVideoFrame and the Buffer field ids below are cached. The frame is read with
+    // the field accessors which, unlike the getter upcalls, don't transition into the Java code.
+    BOOL frameFieldsCached;
+    jfieldID frameIndexFieldId;
+    jfieldID frameFlagsFieldId;
+    jfieldID frameDecodingTsFieldId;
+    jfieldID framePresentationTsFieldId;
+    jfieldID frameDurationFieldId;
+    jfieldID frameDataFieldId;
+    jfieldID bufferPositionFieldId;
+    jfieldID bufferLimitFieldId;
+
+    // ReadResult class global reference and its setter
+    jclass readResultClass;
+    jmethodID readResultSetReadResultMethodId;
+};
+
+/**
+ * Initializes the JNI cache. The conversions fall back to the per-call lookups if it fails, i.e. when the classes
+ * are not visible to the class loader of the library.
+ */
+BOOL initializeJniCache(JNIEnv* env);
+VOID releaseJniCache(JNIEnv* env);
+
 BOOL setDeviceInfo(JNIEnv* env, jobject deviceInfo, PDeviceInfo pDeviceInfo);
 BOOL setStreamInfo(JNIEnv* env, jobject streamInfo, PStreamInfo pStreamInfo);
 BOOL setFrame(JNIEnv* env, jobject kinesisVideoFrame, PFrame pFrame);
+BOOL setFrameFromDirectBuffer(JNIEnv* env, jobject frameData, jint offset, jint size, jint index, jint flags,
+                              jlong decodingTs, jlong presentationTs, jlong duration, PFrame pFrame);
+jmethodID getReadResultSetterMethodId(JNIEnv* env, jobject readResult);
 BOOL setFragmentAck(JNIEnv* env, jobject fragmentAck, PFragmentAck pFragmentAck);
 BOOL setStreamDescription(JNIEnv* env, jobject streamDescription, PStreamDescription pStreamDesc);
 BOOL setStreamingEndpoint(JNIEnv* env, jstring streamingEndpoint, PCHAR pEndpoint);
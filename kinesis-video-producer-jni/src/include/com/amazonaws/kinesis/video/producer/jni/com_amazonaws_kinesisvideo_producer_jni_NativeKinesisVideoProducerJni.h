@@ -90,6 +90,14 @@ JNIEXPORT jlong JNICALL Java_com_amazonaws_kinesisvideo_producer_jni_NativeKines
 JNIEXPORT void JNICALL Java_com_amazonaws_kinesisvideo_producer_jni_NativeKinesisVideoProducerJni_putKinesisVideoFrame
   (JNIEnv *, jobject, jlong, jlong, jobject);
 
+/*
+ * Class:     com_amazonaws_kinesisvideo_producer_jni_NativeKinesisVideoProducerJni
+ * Method:    putKinesisVideoFrameDirect
+ * Signature: (JJLjava/nio/ByteBuffer;IIIIJJJ)V
+ */
+JNIEXPORT void JNICALL Java_com_amazonaws_kinesisvideo_producer_jni_NativeKinesisVideoProducerJni_putKinesisVideoFrameDirect
+  (JNIEnv *, jobject, jlong, jlong, jobject, jint, jint, jint, jint, jlong, jlong, jlong);
+
 /*
  * Class:     com_amazonaws_kinesisvideo_producer_jni_NativeKinesisVideoProducerJni
  * Method:    kinesisVideoStreamFragmentAck
@@ -319,6 +319,7 @@ void KinesisVideoClientWrapper::putKinesisVideoFrame(jlong streamHandle, jobject
 
     // Convert the KinesisVideoFrame object
     Frame frame;
+    MEMSET(&frame, 0x00, SIZEOF(Frame));
     if (!setFrame(env, kinesisVideoFrame, &frame))
     {
         DLOGE("Failed converting frame object.");
@@ -334,6 +335,52 @@ void KinesisVideoClientWrapper::putKinesisVideoFrame(jlong streamHandle, jobject
     }
 }
 
+void KinesisVideoClientWrapper::putKinesisVideoFrameDirect(jlong streamHandle,
+                                                           jobject frameData,
+                                                           jint offset,
+                                                           jint size,
+                                                           jint index,
+                                                           jint flags,
+                                                           jlong decodingTs,
+                                                           jlong presentationTs,
+                                                           jlong duration)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    JNIEnv *env;
+    mJvm->GetEnv((PVOID*) &env, JNI_VERSION_1_6);
+
+    if (!IS_VALID_CLIENT_HANDLE(mClientHandle))
+    {
+        DLOGE("Invalid client object");
+        throwNativeException(env, EXCEPTION_NAME, "Invalid call after the client is freed.", STATUS_INVALID_OPERATION);
+        return;
+    }
+
+    if (!IS_VALID_STREAM_HANDLE(streamHandle))
+    {
+        DLOGE("Invalid stream handle 0x%016" PRIx64, (UINT64) streamHandle);
+        throwNativeException(env, EXCEPTION_NAME, "Invalid stream handle.", STATUS_INVALID_OPERATION);
+        return;
+    }
+
+    // The metadata is passed in as primitives and the data is read in place from the direct buffer
+    Frame frame;
+    MEMSET(&frame, 0x00, SIZEOF(Frame));
+    if (!setFrameFromDirectBuffer(env, frameData, offset, size, index, flags, decodingTs, presentationTs, duration, &frame))
+    {
+        DLOGE("Invalid direct frame data buffer.");
+        throwNativeException(env, EXCEPTION_NAME, "Frame data must be a direct ByteBuffer holding the frame.", STATUS_INVALID_ARG);
+        return;
+    }
+
+    if (STATUS_FAILED(retStatus = ::putKinesisVideoFrame(streamHandle, &frame)))
+    {
+        DLOGE("Failed to put a frame with status code 0x%08x", retStatus);
+        throwNativeException(env, EXCEPTION_NAME, "Failed to put a frame into the stream.", retStatus);
+        return;
+    }
+}
+
 void KinesisVideoClientWrapper::getKinesisVideoStreamData(jlong streamHandle, jobject dataBuffer, jint offset, jint length, jobject readResult)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -343,7 +390,6 @@ void KinesisVideoClientWrapper::getKinesisVideoStreamData(jlong streamHandle, jo
     UINT32 filledSize = 0, bufferSize = 0;
     PBYTE pBuffer = NULL;
     jboolean isEos = JNI_FALSE;
-    jclass readResultClass;
     jmethodID setterMethodId;
 
     if (NULL == readResult)
@@ -394,16 +440,8 @@ void KinesisVideoClientWrapper::getKinesisVideoStreamData(jlong streamHandle, jo
         isEos = JNI_TRUE;
     }
 
-    // Get the class
-    readResultClass = env->GetObjectClass(readResult);
-    if (readResultClass == NULL){
-        DLOGE("Failed to get ReadResult class object");
-        throwNativeException(env, EXCEPTION_NAME, "Failed to get ReadResult class object.", STATUS_INVALID_OPERATION);
-        goto CleanUp;
-    }
-
-    // Get the Java method id
-    setterMethodId = env->GetMethodID(readResultClass, "setReadResult", "(JIZ)V");
+    // Get the Java method id - cached unless the class is not visible to the library class loader
+    setterMethodId = getReadResultSetterMethodId(env, readResult);
     if (setterMethodId == NULL)
     {
         DLOGE("Failed to get the setter method id.");
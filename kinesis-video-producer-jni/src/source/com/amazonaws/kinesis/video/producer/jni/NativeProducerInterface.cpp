@@ -12,7 +12,7 @@
 // IMPORTANT: This version number *must* be incremented every time a new library build is checked in.
 // We are seeing a very high incidence of runtime failures due to APKs being deployed with the wrong native libraries,
 // and they are much easier to diagnose when the numeric version check fails.
-#define NATIVE_LIBRARY_VERSION "1.5"
+#define NATIVE_LIBRARY_VERSION "1.6"
 
 // Used for serializing the access to functions
 static SyncMutex ACCESS_LOCK;
@@ -23,6 +23,32 @@ static SyncMutex ACCESS_LOCK;
 #ifdef __cplusplus
 extern "C" {
 #endif
+    /**
+     * Caches the class references and method ids used on the hot paths when the library is loaded.
+     */
+    PUBLIC_API jint JNI_OnLoad(JavaVM* vm, PVOID reserved)
+    {
+        JNIEnv* env = NULL;
+        if (vm->GetEnv((PVOID*) &env, JNI_VER) != JNI_OK) {
+            return JNI_ERR;
+        }
+
+        // The conversions fall back to the per-call lookups if the classes are not visible at this point
+        if (initializeJniCache(env)) {
+            DLOGI("Cached the JNI method ids.");
+        }
+
+        return JNI_VER;
+    }
+
+    PUBLIC_API void JNI_OnUnload(JavaVM* vm, PVOID reserved)
+    {
+        JNIEnv* env = NULL;
+        if (vm->GetEnv((PVOID*) &env, JNI_VER) == JNI_OK) {
+            releaseJniCache(env);
+        }
+    }
+
     /**
      * Returns a hardcoded library version string.
      */
@@ -215,6 +241,26 @@ CleanUp:
         LEAVES();
     }
 
+    /**
+     * Puts a frame in to the frame buffer. The frame data is read in place from the direct ByteBuffer and the frame
+     * metadata is passed in as primitives so there is no reflection involved.
+     */
+    PUBLIC_API void Java_com_amazonaws_kinesisvideo_producer_jni_NativeKinesisVideoProducerJni_putKinesisVideoFrameDirect(JNIEnv* env, jobject thiz, jlong handle, jlong streamHandle, jobject frameData, jint offset, jint size, jint index, jint flags, jlong decodingTs, jlong presentationTs, jlong duration)
+    {
+        ENTERS();
+        SyncMutex::Autolock l(ACCESS_LOCK, __FUNCTION__);
+
+        DLOGS("Putting Kinesis Video frame for stream 0x%016" PRIx64 ".", streamHandle);
+        CHECK(env != NULL && thiz != NULL);
+
+        KinesisVideoClientWrapper* pWrapper = FROM_WRAPPER_HANDLE(handle);
+        if (pWrapper != NULL) {
+            pWrapper->putKinesisVideoFrameDirect(streamHandle, frameData, offset, size, index, flags, decodingTs, presentationTs, duration);
+        }
+
+        LEAVES();
+    }
+
     PUBLIC_API void Java_com_amazonaws_kinesisvideo_producer_jni_NativeKinesisVideoProducerJni_kinesisVideoStreamFragmentAck(JNIEnv* env, jobject thiz, jlong handle, jlong streamHandle, jlong uploadHandle, jobject fragmentAck)
     {
         ENTERS();
@@ -4,6 +4,132 @@
 #define LOG_CLASS "KinesisVideoParametersConversion"
 #include "com/amazonaws/kinesis/video/producer/jni/KinesisVideoClientWrapper.h"
 
+static JniCache gJniCache;
+
+/**
+ * Caches the field ids of the KinesisVideoFrame and its data buffer. The getters are used if the fields
+ * are not found, i.e. with an obfuscated or a changed class.
+ */
+static BOOL cacheFrameFieldIds(JNIEnv* env)
+{
+    jclass bufferClass = NULL;
+
+    gJniCache.frameIndexFieldId = env->GetFieldID(gJniCache.frameClass, "mIndex", "I");
+    gJniCache.frameFlagsFieldId = env->GetFieldID(gJniCache.frameClass, "mFlags", "I");
+    gJniCache.frameDecodingTsFieldId = env->GetFieldID(gJniCache.frameClass, "mDecodingTs", "J");
+    gJniCache.framePresentationTsFieldId = env->GetFieldID(gJniCache.frameClass, "mPresentationTs", "J");
+    gJniCache.frameDurationFieldId = env->GetFieldID(gJniCache.frameClass, "mDuration", "J");
+    gJniCache.frameDataFieldId = env->GetFieldID(gJniCache.frameClass, "mData", "Ljava/nio/ByteBuffer;");
+
+    bufferClass = env->FindClass(NIO_BUFFER_CLASS_NAME);
+    if (bufferClass != NULL) {
+        gJniCache.bufferPositionFieldId = env->GetFieldID(bufferClass, "position", "I");
+        gJniCache.bufferLimitFieldId = env->GetFieldID(bufferClass, "limit", "I");
+        env->DeleteLocalRef(bufferClass);
+    }
+
+    // The failed lookups leave NoSuchFieldError pending which is not an error here
+    env->ExceptionClear();
+
+    return gJniCache.frameIndexFieldId != NULL &&
+           gJniCache.frameFlagsFieldId != NULL &&
+           gJniCache.frameDecodingTsFieldId != NULL &&
+           gJniCache.framePresentationTsFieldId != NULL &&
+           gJniCache.frameDurationFieldId != NULL &&
+           gJniCache.frameDataFieldId != NULL &&
+           gJniCache.bufferPositionFieldId != NULL &&
+           gJniCache.bufferLimitFieldId != NULL;
+}
+
+BOOL initializeJniCache(JNIEnv* env)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    jclass cls = NULL;
+
+    CHECK(env != NULL);
+    MEMSET(&gJniCache, 0x00, SIZEOF(JniCache));
+
+    cls = env->FindClass(KINESIS_VIDEO_FRAME_CLASS_NAME);
+    if (cls == NULL) {
+        // Not visible to the class loader of the library which is not an error
+        env->ExceptionClear();
+        DLOGW("Couldn't find class %s", KINESIS_VIDEO_FRAME_CLASS_NAME);
+        CHK(FALSE, STATUS_INVALID_OPERATION);
+    }
+
+    gJniCache.frameClass = (jclass) env->NewGlobalRef(cls);
+    env->DeleteLocalRef(cls);
+    CHK(gJniCache.frameClass != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    gJniCache.frameGetIndexMethodId = env->GetMethodID(gJniCache.frameClass, "getIndex", "()I");
+    CHK_JVM_EXCEPTION(env);
+    gJniCache.frameGetFlagsMethodId = env->GetMethodID(gJniCache.frameClass, "getFlags", "()I");
+    CHK_JVM_EXCEPTION(env);
+    gJniCache.frameGetDecodingTsMethodId = env->GetMethodID(gJniCache.frameClass, "getDecodingTs", "()J");
+    CHK_JVM_EXCEPTION(env);
+    gJniCache.frameGetPresentationTsMethodId = env->GetMethodID(gJniCache.frameClass, "getPresentationTs", "()J");
+    CHK_JVM_EXCEPTION(env);
+    gJniCache.frameGetDurationMethodId = env->GetMethodID(gJniCache.frameClass, "getDuration", "()J");
+    CHK_JVM_EXCEPTION(env);
+    gJniCache.frameGetSizeMethodId = env->GetMethodID(gJniCache.frameClass, "getSize", "()I");
+    CHK_JVM_EXCEPTION(env);
+    gJniCache.frameGetDataMethodId = env->GetMethodID(gJniCache.frameClass, "getData", "()Ljava/nio/ByteBuffer;");
+    CHK_JVM_EXCEPTION(env);
+
+    gJniCache.frameFieldsCached = cacheFrameFieldIds(env);
+    if (!gJniCache.frameFieldsCached) {
+        DLOGW("Couldn't find the %s fields. Reading the frames through the getters.", KINESIS_VIDEO_FRAME_CLASS_NAME);
+    }
+
+    cls = env->FindClass(READ_RESULT_CLASS_NAME);
+    if (cls == NULL) {
+        // Not visible to the class loader of the library which is not an error
+        env->ExceptionClear();
+        DLOGW("Couldn't find class %s", READ_RESULT_CLASS_NAME);
+        CHK(FALSE, STATUS_INVALID_OPERATION);
+    }
+
+    gJniCache.readResultClass = (jclass) env->NewGlobalRef(cls);
+    env->DeleteLocalRef(cls);
+    CHK(gJniCache.readResultClass != NULL, STATUS_NOT_ENOUGH_MEMORY);
+
+    gJniCache.readResultSetReadResultMethodId = env->GetMethodID(gJniCache.readResultClass, "setReadResult", "(JIZ)V");
+    CHK_JVM_EXCEPTION(env);
+
+    gJniCache.initialized = gJniCache.frameGetIndexMethodId != NULL &&
+                            gJniCache.frameGetFlagsMethodId != NULL &&
+                            gJniCache.frameGetDecodingTsMethodId != NULL &&
+                            gJniCache.frameGetPresentationTsMethodId != NULL &&
+                            gJniCache.frameGetDurationMethodId != NULL &&
+                            gJniCache.frameGetSizeMethodId != NULL &&
+                            gJniCache.frameGetDataMethodId != NULL &&
+                            gJniCache.readResultSetReadResultMethodId != NULL;
+
+CleanUp:
+
+    if (!gJniCache.initialized) {
+        DLOGW("Failed to cache the JNI method ids. Falling back to the per-call lookups.");
+        releaseJniCache(env);
+    }
+
+    return gJniCache.initialized;
+}
+
+VOID releaseJniCache(JNIEnv* env)
+{
+    CHECK(env != NULL);
+
+    if (gJniCache.frameClass != NULL) {
+        env->DeleteGlobalRef(gJniCache.frameClass);
+    }
+
+    if (gJniCache.readResultClass != NULL) {
+        env->DeleteGlobalRef(gJniCache.readResultClass);
+    }
+
+    MEMSET(&gJniCache, 0x00, SIZEOF(JniCache));
+}
+
 BOOL setDeviceInfo(JNIEnv *env, jobject deviceInfo, PDeviceInfo pDeviceInfo)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -525,10 +651,50 @@ BOOL setFrame(JNIEnv* env, jobject kinesisVideoFrame, PFrame pFrame)
 {
     STATUS retStatus = STATUS_SUCCESS;
     jmethodID methodId = NULL;
+    jclass cls = NULL;
+    jobject byteBuffer = NULL;
     CHECK(env != NULL && kinesisVideoFrame != NULL && pFrame != NULL);
 
+    // Fastest path reading the fields directly. The size is the remaining size of the data buffer
+    // the same way the getSize getter reports it.
+    if (gJniCache.initialized && gJniCache.frameFieldsCached && env->IsInstanceOf(kinesisVideoFrame, gJniCache.frameClass)) {
+        pFrame->index = (UINT32) env->GetIntField(kinesisVideoFrame, gJniCache.frameIndexFieldId);
+        pFrame->flags = (FRAME_FLAGS) env->GetIntField(kinesisVideoFrame, gJniCache.frameFlagsFieldId);
+        pFrame->decodingTs = (UINT64) env->GetLongField(kinesisVideoFrame, gJniCache.frameDecodingTsFieldId);
+        pFrame->presentationTs = (UINT64) env->GetLongField(kinesisVideoFrame, gJniCache.framePresentationTsFieldId);
+        pFrame->duration = (UINT64) env->GetLongField(kinesisVideoFrame, gJniCache.frameDurationFieldId);
+        byteBuffer = env->GetObjectField(kinesisVideoFrame, gJniCache.frameDataFieldId);
+        CHK(byteBuffer != NULL, STATUS_NULL_ARG);
+        pFrame->size = (UINT32) (env->GetIntField(byteBuffer, gJniCache.bufferLimitFieldId) -
+                                 env->GetIntField(byteBuffer, gJniCache.bufferPositionFieldId));
+        pFrame->frameData = (PBYTE) env->GetDirectBufferAddress(byteBuffer);
+        env->DeleteLocalRef(byteBuffer);
+        goto CleanUp;
+    }
+
+    // Fast path through the cached method ids
+    if (gJniCache.initialized && env->IsInstanceOf(kinesisVideoFrame, gJniCache.frameClass)) {
+        pFrame->index = env->CallIntMethod(kinesisVideoFrame, gJniCache.frameGetIndexMethodId);
+        CHK_JVM_EXCEPTION(env);
+        pFrame->flags = (FRAME_FLAGS) env->CallIntMethod(kinesisVideoFrame, gJniCache.frameGetFlagsMethodId);
+        CHK_JVM_EXCEPTION(env);
+        pFrame->decodingTs = env->CallLongMethod(kinesisVideoFrame, gJniCache.frameGetDecodingTsMethodId);
+        CHK_JVM_EXCEPTION(env);
+        pFrame->presentationTs = env->CallLongMethod(kinesisVideoFrame, gJniCache.frameGetPresentationTsMethodId);
+        CHK_JVM_EXCEPTION(env);
+        pFrame->duration = env->CallLongMethod(kinesisVideoFrame, gJniCache.frameGetDurationMethodId);
+        CHK_JVM_EXCEPTION(env);
+        pFrame->size = (UINT32) env->CallIntMethod(kinesisVideoFrame, gJniCache.frameGetSizeMethodId);
+        CHK_JVM_EXCEPTION(env);
+        byteBuffer = env->CallObjectMethod(kinesisVideoFrame, gJniCache.frameGetDataMethodId);
+        CHK_JVM_EXCEPTION(env);
+        pFrame->frameData = (PBYTE) env->GetDirectBufferAddress(byteBuffer);
+        env->DeleteLocalRef(byteBuffer);
+        goto CleanUp;
+    }
+
     // Load KinesisVideoFrame
-    jclass cls = env->GetObjectClass(kinesisVideoFrame);
+    cls = env->GetObjectClass(kinesisVideoFrame);
     if (cls == NULL) {
         DLOGE("Failed to create KinesisVideoFrame class.");
         CHK(FALSE, STATUS_INVALID_OPERATION);
@@ -587,7 +753,7 @@ BOOL setFrame(JNIEnv* env, jobject kinesisVideoFrame, PFrame pFrame)
     if (methodId == NULL) {
         DLOGW("Couldn't find method id getData");
     } else {
-        jobject byteBuffer = (jstring) env->CallObjectMethod(kinesisVideoFrame, methodId);
+        byteBuffer = env->CallObjectMethod(kinesisVideoFrame, methodId);
         CHK_JVM_EXCEPTION(env);
         pFrame->frameData = (PBYTE) env->GetDirectBufferAddress(byteBuffer);
     }
@@ -596,6 +762,60 @@ CleanUp:
     return STATUS_FAILED(retStatus) ? FALSE : TRUE;
 }
 
+BOOL setFrameFromDirectBuffer(JNIEnv* env, jobject frameData, jint offset, jint size, jint index, jint flags,
+                              jlong decodingTs, jlong presentationTs, jlong duration, PFrame pFrame)
+{
+    STATUS retStatus = STATUS_SUCCESS;
+    PBYTE pBuffer = NULL;
+    jlong capacity;
+    CHECK(env != NULL && pFrame != NULL);
+
+    CHK(frameData != NULL && offset >= 0 && size >= 0, STATUS_INVALID_ARG);
+
+    // Only the direct buffers have a stable native address so no copy is needed
+    pBuffer = (PBYTE) env->GetDirectBufferAddress(frameData);
+    capacity = env->GetDirectBufferCapacity(frameData);
+    if (pBuffer == NULL || capacity < 0) {
+        DLOGE("Frame data is not a direct ByteBuffer.");
+        CHK(FALSE, STATUS_INVALID_ARG);
+    }
+
+    CHK((jlong) offset + size <= capacity, STATUS_INVALID_ARG_LEN);
+
+    pFrame->index = (UINT32) index;
+    pFrame->flags = (FRAME_FLAGS) flags;
+    pFrame->decodingTs = (UINT64) decodingTs;
+    pFrame->presentationTs = (UINT64) presentationTs;
+    pFrame->duration = (UINT64) duration;
+    pFrame->size = (UINT32) size;
+    pFrame->frameData = pBuffer + offset;
+
+CleanUp:
+    return STATUS_FAILED(retStatus) ? FALSE : TRUE;
+}
+
+jmethodID getReadResultSetterMethodId(JNIEnv* env, jobject readResult)
+{
+    jclass readResultClass = NULL;
+    jmethodID methodId = NULL;
+    CHECK(env != NULL && readResult != NULL);
+
+    if (gJniCache.initialized && env->IsInstanceOf(readResult, gJniCache.readResultClass)) {
+        return gJniCache.readResultSetReadResultMethodId;
+    }
+
+    readResultClass = env->GetObjectClass(readResult);
+    if (readResultClass == NULL) {
+        DLOGE("Failed to get ReadResult class object");
+        return NULL;
+    }
+
+    methodId = env->GetMethodID(readResultClass, "setReadResult", "(JIZ)V");
+    env->DeleteLocalRef(readResultClass);
+
+    return methodId;
+}
+
 BOOL setFragmentAck(JNIEnv* env, jobject fragmentAck, PFragmentAck pFragmentAck)
 {
     STATUS retStatus = STATUS_SUCCESS;
@@ -0,0 +1,230 @@
+/**
+ * Micro-benchmark of the JNI frame submission paths running on an embedded JVM.
+ *
+ * The KinesisVideoFrame and ReadResult classes are loaded from the Java producer SDK jar passed in through the
+ * KVS_JAVA_CLASSPATH environment variable. The tests needing the SDK classes are skipped without it.
+ */
+#define LOG_CLASS "JniFrameConversionBenchmarkTest"
+#include "gtest/gtest.h"
+#include "com/amazonaws/kinesis/video/producer/jni/KinesisVideoClientWrapper.h"
+
+#define JAVA_CLASSPATH_ENV_VAR                  "KVS_JAVA_CLASSPATH"
+#define KINESIS_VIDEO_FRAME_CONSTRUCTOR_SIG     "(IIJJJLjava/nio/ByteBuffer;)V"
+#define BENCHMARK_FRAME_COUNT                   1000000
+#define BENCHMARK_FRAME_SIZE                    10000
+#define TEST_FRAME_INDEX                        10
+#define TEST_FRAME_DECODING_TS                  1000
+#define TEST_FRAME_PRESENTATION_TS              2000
+#define TEST_FRAME_DURATION                     400000
+
+class JniFrameConversionBenchmarkTest : public ::testing::Test {
+public:
+    static void SetUpTestCase()
+    {
+        JavaVMInitArgs initArgs;
+        JavaVMOption options[1];
+        CHAR classPathOption[MAX_PATH_LEN + 32];
+        PCHAR classPath = getenv(JAVA_CLASSPATH_ENV_VAR);
+
+        initArgs.version = JNI_VER;
+        initArgs.nOptions = 0;
+        initArgs.options = options;
+        initArgs.ignoreUnrecognized = JNI_FALSE;
+
+        if (classPath != NULL) {
+            SNPRINTF(classPathOption, SIZEOF(classPathOption), "-Djava.class.path=%s", classPath);
+            options[0].optionString = classPathOption;
+            options[0].extraInfo = NULL;
+            initArgs.nOptions = 1;
+        }
+
+        if (JNI_CreateJavaVM(&mJvm, (PVOID*) &mEnv, &initArgs) != JNI_OK) {
+            DLOGE("Failed to create the JVM");
+            mJvm = NULL;
+            mEnv = NULL;
+        }
+    }
+
+    static void TearDownTestCase()
+    {
+        if (mJvm != NULL) {
+            releaseJniCache(mEnv);
+            mJvm->DestroyJavaVM();
+            mJvm = NULL;
+            mEnv = NULL;
+        }
+    }
+
+protected:
+    virtual void SetUp()
+    {
+        ASSERT_TRUE(mEnv != NULL);
+        mFrameBuffer = (PBYTE) MEMALLOC(BENCHMARK_FRAME_SIZE);
+        ASSERT_TRUE(mFrameBuffer != NULL);
+        MEMSET(mFrameBuffer, 0x55, BENCHMARK_FRAME_SIZE);
+        mByteBuffer = mEnv->NewDirectByteBuffer(mFrameBuffer, BENCHMARK_FRAME_SIZE);
+        ASSERT_TRUE(mByteBuffer != NULL);
+        mFrameObject = NULL;
+        releaseJniCache(mEnv);
+    }
+
+    virtual void TearDown()
+    {
+        if (mFrameObject != NULL) {
+            mEnv->DeleteLocalRef(mFrameObject);
+        }
+
+        mEnv->DeleteLocalRef(mByteBuffer);
+        MEMFREE(mFrameBuffer);
+    }
+
+    /**
+     * Creates the KinesisVideoFrame object the way the Java producer does. Returns FALSE if the SDK is not available.
+     */
+    BOOL createFrameObject()
+    {
+        jclass cls = mEnv->FindClass(KINESIS_VIDEO_FRAME_CLASS_NAME);
+        jmethodID constructor;
+        if (cls == NULL) {
+            mEnv->ExceptionClear();
+            DLOGW("%s is not available. Set %s to the Java producer SDK jar.",
+                  KINESIS_VIDEO_FRAME_CLASS_NAME, JAVA_CLASSPATH_ENV_VAR);
+            return FALSE;
+        }
+
+        constructor = mEnv->GetMethodID(cls, "<init>", KINESIS_VIDEO_FRAME_CONSTRUCTOR_SIG);
+        if (constructor == NULL) {
+            mEnv->ExceptionClear();
+            mEnv->DeleteLocalRef(cls);
+            DLOGW("KinesisVideoFrame constructor %s is not available.", KINESIS_VIDEO_FRAME_CONSTRUCTOR_SIG);
+            return FALSE;
+        }
+
+        mFrameObject = mEnv->NewObject(cls, constructor, (jint) TEST_FRAME_INDEX, (jint) FRAME_FLAG_KEY_FRAME,
+                                       (jlong) TEST_FRAME_DECODING_TS, (jlong) TEST_FRAME_PRESENTATION_TS,
+                                       (jlong) TEST_FRAME_DURATION, mByteBuffer);
+        mEnv->DeleteLocalRef(cls);
+        return mFrameObject != NULL;
+    }
+
+    VOID verifyFrame(PFrame pFrame)
+    {
+        EXPECT_EQ(TEST_FRAME_INDEX, pFrame->index);
+        EXPECT_EQ(FRAME_FLAG_KEY_FRAME, pFrame->flags);
+        EXPECT_EQ(TEST_FRAME_DECODING_TS, pFrame->decodingTs);
+        EXPECT_EQ(TEST_FRAME_PRESENTATION_TS, pFrame->presentationTs);
+        EXPECT_EQ(TEST_FRAME_DURATION, pFrame->duration);
+        EXPECT_EQ(BENCHMARK_FRAME_SIZE, pFrame->size);
+        EXPECT_EQ(mFrameBuffer, pFrame->frameData);
+    }
+
+    VOID reportBenchmark(PCHAR name, UINT64 startTime)
+    {
+        UINT64 elapsed = GETTIME() - startTime;
+        DLOGI("%s: %u frames, %" PRIu64 " ns per frame", name, BENCHMARK_FRAME_COUNT,
+              elapsed * DEFAULT_TIME_UNIT_IN_NANOS / BENCHMARK_FRAME_COUNT);
+    }
+
+    static JavaVM* mJvm;
+    static JNIEnv* mEnv;
+    PBYTE mFrameBuffer;
+    jobject mByteBuffer;
+    jobject mFrameObject;
+};
+
+JavaVM* JniFrameConversionBenchmarkTest::mJvm = NULL;
+JNIEnv* JniFrameConversionBenchmarkTest::mEnv = NULL;
+
+TEST_F(JniFrameConversionBenchmarkTest, directBuffer_Validation)
+{
+    Frame frame;
+    jbyteArray byteArray = mEnv->NewByteArray(BENCHMARK_FRAME_SIZE);
+
+    EXPECT_TRUE(setFrameFromDirectBuffer(mEnv, mByteBuffer, 0, BENCHMARK_FRAME_SIZE, TEST_FRAME_INDEX,
+                                         FRAME_FLAG_KEY_FRAME, TEST_FRAME_DECODING_TS, TEST_FRAME_PRESENTATION_TS,
+                                         TEST_FRAME_DURATION, &frame));
+    verifyFrame(&frame);
+
+    // The frame can start at an offset into the buffer
+    EXPECT_TRUE(setFrameFromDirectBuffer(mEnv, mByteBuffer, 100, BENCHMARK_FRAME_SIZE - 100, 0, 0, 0, 0, 0, &frame));
+    EXPECT_EQ(mFrameBuffer + 100, frame.frameData);
+    EXPECT_EQ(BENCHMARK_FRAME_SIZE - 100, frame.size);
+
+    // Out of bounds, negative values, non-direct buffers and nulls are rejected
+    EXPECT_FALSE(setFrameFromDirectBuffer(mEnv, mByteBuffer, 1, BENCHMARK_FRAME_SIZE, 0, 0, 0, 0, 0, &frame));
+    EXPECT_FALSE(setFrameFromDirectBuffer(mEnv, mByteBuffer, -1, 10, 0, 0, 0, 0, 0, &frame));
+    EXPECT_FALSE(setFrameFromDirectBuffer(mEnv, mByteBuffer, 0, -1, 0, 0, 0, 0, 0, &frame));
+    EXPECT_FALSE(setFrameFromDirectBuffer(mEnv, byteArray, 0, 10, 0, 0, 0, 0, 0, &frame));
+    EXPECT_FALSE(setFrameFromDirectBuffer(mEnv, NULL, 0, 10, 0, 0, 0, 0, 0, &frame));
+
+    mEnv->DeleteLocalRef(byteArray);
+}
+
+TEST_F(JniFrameConversionBenchmarkTest, setFrame_CachedMatchesReflection)
+{
+    Frame reflected, cached;
+
+    if (!createFrameObject()) {
+        return;
+    }
+
+    MEMSET(&reflected, 0x00, SIZEOF(Frame));
+    EXPECT_TRUE(setFrame(mEnv, mFrameObject, &reflected));
+    verifyFrame(&reflected);
+
+    EXPECT_TRUE(initializeJniCache(mEnv));
+    MEMSET(&cached, 0x00, SIZEOF(Frame));
+    EXPECT_TRUE(setFrame(mEnv, mFrameObject, &cached));
+    EXPECT_EQ(0, MEMCMP(&reflected, &cached, SIZEOF(Frame)));
+}
+
+TEST_F(JniFrameConversionBenchmarkTest, benchmark_SetFrameWithReflection)
+{
+    Frame frame;
+    UINT64 startTime;
+
+    if (!createFrameObject()) {
+        return;
+    }
+
+    startTime = GETTIME();
+    for (UINT32 i = 0; i < BENCHMARK_FRAME_COUNT; i++) {
+        setFrame(mEnv, mFrameObject, &frame);
+    }
+
+    reportBenchmark((PCHAR) "KinesisVideoFrame with per-call lookups", startTime);
+    verifyFrame(&frame);
+}
+
+TEST_F(JniFrameConversionBenchmarkTest, benchmark_SetFrameWithCachedMethodIds)
+{
+    Frame frame;
+    UINT64 startTime;
+
+    if (!createFrameObject()) {
+        return;
+    }
+
+    ASSERT_TRUE(initializeJniCache(mEnv));
+    startTime = GETTIME();
+    for (UINT32 i = 0; i < BENCHMARK_FRAME_COUNT; i++) {
+        setFrame(mEnv, mFrameObject, &frame);
+    }
+
+    reportBenchmark((PCHAR) "KinesisVideoFrame with cached method ids", startTime);
+    verifyFrame(&frame);
+}
+
+TEST_F(JniFrameConversionBenchmarkTest, benchmark_DirectBuffer)
+{
+    Frame frame;
+    UINT64 startTime = GETTIME();
+
+    for (UINT32 i = 0; i < BENCHMARK_FRAME_COUNT; i++) {
+        setFrameFromDirectBuffer(mEnv, mByteBuffer, 0, BENCHMARK_FRAME_SIZE, TEST_FRAME_INDEX, FRAME_FLAG_KEY_FRAME,
+                                 TEST_FRAME_DECODING_TS, TEST_FRAME_PRESENTATION_TS, TEST_FRAME_DURATION, &frame);
+    }
+
+    reportBenchmark((PCHAR) "Direct ByteBuffer with primitive metadata", startTime);
+    verifyFrame(&frame);
+}
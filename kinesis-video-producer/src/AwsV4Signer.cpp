@@ -9,6 +9,10 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <strings.h>
 
 namespace {
     const std::string HEADER_AMZ_DATE = "X-Amz-Date";
@@ -18,6 +22,34 @@ namespace {
 
     const std::string ALGORITHM = "AWS4-HMAC-SHA256";
     const std::string SIGNATURE_END = "aws4_request";
+
+    // Hex encoded SHA256 of the empty payload
+    const std::string EMPTY_PAYLOAD_HASH = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+
+    // Max number of the cached signing keys. Allows for a few clients with different credentials
+    // and the overlap of the old and the new credentials during the rotation.
+    const size_t SIGNING_KEY_CACHE_MAX_ENTRIES = 16;
+
+    /// The secret key is not stored in the cache - the entries are matched by its SHA256 hash
+    struct SigningKeyCacheEntry {
+        std::string region;
+        std::string service;
+        uint8_t secretKeyHash[SHA256_DIGEST_LENGTH];
+        std::string date;
+        uint8_t signingKey[SHA256_DIGEST_LENGTH];
+        uint64_t lastUse;
+    };
+
+    struct SigningKeyCache {
+        std::mutex mutex;
+        std::vector<SigningKeyCacheEntry> entries;
+        uint64_t useCounter = 0;
+    };
+
+    SigningKeyCache &getSigningKeyCache() {
+        static SigningKeyCache cache;
+        return cache;
+    }
 } // anonymous namespace
 
 namespace com { namespace amazonaws { namespace kinesis { namespace video {
@@ -64,45 +96,59 @@ AwsV4Signer::AwsV4Signer(
 }
 
 void AwsV4Signer::signRequest(Request &request) const {
+    signRequest(request, std::chrono::system_clock::now());
+}
+
+void AwsV4Signer::signRequest(Request &request, std::chrono::system_clock::time_point signing_time) const {
+    // Per-thread buffers reused across the calls to avoid re-allocating on every request
+    static thread_local std::string canonicalRequest, stringToSign, signedHeaders;
+
     // retrieve credentials from provider
     Credentials credentials;
     credential_provider_->getCredentials(credentials);
 
-    std::string date_time_string = generateTimestamp("%Y%m%dT%H%M%SZ");
+    std::string date_time_string = generateTimestamp(signing_time, "%Y%m%dT%H%M%SZ");
     std::string dateString = date_time_string.substr(0, 8);
 
     // ensure that host and date headers are set as they're required fields in the canonical header string
     request.setHeader(HEADER_HOST, request.getHost());
     request.setHeader(HEADER_AMZ_DATE, date_time_string);
 
+    // The signed header list goes into both the canonical request and the auth header
+    signedHeaders.clear();
+    appendSignedHeaderList(request.getHeaders(), signedHeaders);
+
     // create V4 string to sign
     // http://docs.aws.amazon.com/general/latest/gr/sigv4-create-string-to-sign.html
-    std::string credentialScope = generateCredentialScope(dateString);
-    std::string canonicalRequest = generateCanonicalRequest(request);
-    std::ostringstream stringToSign;
-    stringToSign << ALGORITHM << '\n'
-                 << date_time_string << '\n'
-                 << credentialScope << '\n'
-                 << hashStringSHA256(canonicalRequest);
+    canonicalRequest.clear();
+    appendCanonicalRequest(request, signedHeaders, canonicalRequest);
+
+    stringToSign.clear();
+    stringToSign.append(ALGORITHM).append(1, '\n')
+            .append(date_time_string).append(1, '\n');
+    size_t credentialScopeStart = stringToSign.size();
+    appendCredentialScope(dateString, stringToSign);
+    size_t credentialScopeSize = stringToSign.size() - credentialScopeStart;
+    stringToSign.append(1, '\n');
+    appendHashSHA256(canonicalRequest, stringToSign);
 
     // create V4 signature
     // http://docs.aws.amazon.com/general/latest/gr/sigv4-calculate-signature.html
-    std::string signatureStart = "AWS4" + credentials.getSecretKey();
-    byte_vector hmac(signatureStart.begin(), signatureStart.end());
-    generateHMAC(hmac, dateString, hmac);
-    generateHMAC(hmac, region_, hmac);
-    generateHMAC(hmac, service_, hmac);
-    generateHMAC(hmac, SIGNATURE_END, hmac);
-    generateHMAC(hmac, stringToSign.str(), hmac);
-    std::string signature = hexEncode(hmac);
+    uint8_t hmac[SHA256_DIGEST_LENGTH];
+    getSigningKey(credentials.getSecretKey(), dateString, hmac);
+    generateHMAC(hmac, SHA256_DIGEST_LENGTH, stringToSign, hmac);
 
     // set the auth header
     // http://docs.aws.amazon.com/general/latest/gr/sigv4-add-signature-to-request.html
-    std::ostringstream authHeader;
-    authHeader << ALGORITHM << " Credential=" << credentials.getAccessKey() << '/' << credentialScope << ", "
-               << "SignedHeaders=" << generateSignedHeaderList(request.getHeaders()) << ", "
-               << "Signature=" << signature;
-    request.setHeader(HEADER_AUTH, authHeader.str());
+    std::string authHeader;
+    authHeader.reserve(ALGORITHM.size() + credentials.getAccessKey().size() + credentialScopeSize +
+                       signedHeaders.size() + 2 * SHA256_DIGEST_LENGTH + 64);
+    authHeader.append(ALGORITHM).append(" Credential=").append(credentials.getAccessKey()).append(1, '/')
+            .append(stringToSign, credentialScopeStart, credentialScopeSize).append(", ")
+            .append("SignedHeaders=").append(signedHeaders).append(", ")
+            .append("Signature=");
+    appendHexEncoded(hmac, SHA256_DIGEST_LENGTH, authHeader);
+    request.setHeader(HEADER_AUTH, authHeader);
 
     // set the security token header if provided
     if (!credentials.getSessionToken().empty()) {
@@ -110,67 +156,126 @@ void AwsV4Signer::signRequest(Request &request) const {
     }
 }
 
+void AwsV4Signer::invalidateSigningKeys() {
+    SigningKeyCache &cache = getSigningKeyCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.entries.clear();
+}
+
+void AwsV4Signer::getSigningKey(const std::string &secretKey, const std::string &dateString, uint8_t *signingKey) const {
+    SigningKeyCache &cache = getSigningKeyCache();
+    uint8_t secretKeyHash[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const uint8_t *>(secretKey.data()), secretKey.size(), secretKeyHash);
+
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        for (auto &entry : cache.entries) {
+            if (entry.region == region_ && entry.service == service_ && entry.date == dateString &&
+                0 == std::memcmp(entry.secretKeyHash, secretKeyHash, SHA256_DIGEST_LENGTH)) {
+                entry.lastUse = ++cache.useCounter;
+                std::memcpy(signingKey, entry.signingKey, SHA256_DIGEST_LENGTH);
+                return;
+            }
+        }
+    }
+
+    // Derive the key outside of the lock - date -> region -> service -> aws4_request
+    std::string signatureStart = "AWS4" + secretKey;
+    generateHMAC(reinterpret_cast<const uint8_t *>(signatureStart.data()), signatureStart.size(), dateString, signingKey);
+    generateHMAC(signingKey, SHA256_DIGEST_LENGTH, region_, signingKey);
+    generateHMAC(signingKey, SHA256_DIGEST_LENGTH, service_, signingKey);
+    generateHMAC(signingKey, SHA256_DIGEST_LENGTH, SIGNATURE_END, signingKey);
+
+    // A new date replaces the entry of the same secret. Different secrets for the same region and
+    // service get their own entries and the least recently used entry is evicted when the cache is full.
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    SigningKeyCacheEntry *cacheEntry = nullptr;
+    for (auto &entry : cache.entries) {
+        if (entry.region == region_ && entry.service == service_ &&
+            0 == std::memcmp(entry.secretKeyHash, secretKeyHash, SHA256_DIGEST_LENGTH)) {
+            cacheEntry = &entry;
+            break;
+        }
+    }
 
-std::string AwsV4Signer::generateTimestamp(const char *format_string) {
-    auto now_time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    if (nullptr == cacheEntry) {
+        if (cache.entries.size() < SIGNING_KEY_CACHE_MAX_ENTRIES) {
+            cache.entries.push_back(SigningKeyCacheEntry());
+            cacheEntry = &cache.entries.back();
+        } else {
+            cacheEntry = &*std::min_element(cache.entries.begin(), cache.entries.end(),
+                    [](const SigningKeyCacheEntry &a, const SigningKeyCacheEntry &b) {
+                        return a.lastUse < b.lastUse;
+                    });
+        }
+
+        cacheEntry->region = region_;
+        cacheEntry->service = service_;
+        std::memcpy(cacheEntry->secretKeyHash, secretKeyHash, SHA256_DIGEST_LENGTH);
+    }
+
+    cacheEntry->date = dateString;
+    cacheEntry->lastUse = ++cache.useCounter;
+    std::memcpy(cacheEntry->signingKey, signingKey, SHA256_DIGEST_LENGTH);
+}
+
+std::string AwsV4Signer::generateTimestamp(std::chrono::system_clock::time_point time, const char *format_string) {
+    auto now_time = std::chrono::system_clock::to_time_t(time);
     char timestamp[18] = {0};
-    strftime(reinterpret_cast<char *>(&timestamp), 18, format_string, std::gmtime(&now_time));
+    struct tm tm_time;
+    strftime(reinterpret_cast<char *>(&timestamp), 18, format_string, gmtime_r(&now_time, &tm_time));
     return std::string(timestamp);
 }
 
 
-void AwsV4Signer::generateHMAC(const byte_vector &key, const std::string &message, byte_vector &out) {
+void AwsV4Signer::generateHMAC(const uint8_t *key, size_t key_size, const std::string &message, uint8_t *out) {
     unsigned char hmac[EVP_MAX_MD_SIZE];
     unsigned int hmacLength = 0;
 
     const EVP_MD *evp = EVP_sha256();
-    ::HMAC(evp, &key[0], key.size(),
+    ::HMAC(evp, key, key_size,
            reinterpret_cast<const unsigned char *>(message.c_str()),
            message.size(),
            hmac,
            &hmacLength);
-    out.assign(hmac, hmac + hmacLength);
+    std::memcpy(out, hmac, hmacLength);
 }
 
-std::string AwsV4Signer::hashStringSHA256(const std::string &message) {
-    byte_vector hash;
-    hash.resize(SHA256_DIGEST_LENGTH);
-    SHA256(reinterpret_cast<const uint8_t *>(message.data()), message.size(), hash.data());
-    return hexEncode(hash);
+void AwsV4Signer::appendHashSHA256(const std::string &message, std::string &out) {
+    uint8_t hash[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const uint8_t *>(message.data()), message.size(), hash);
+    appendHexEncoded(hash, SHA256_DIGEST_LENGTH, out);
 }
 
 
-std::string AwsV4Signer::hexEncode(const byte_vector &input) {
+void AwsV4Signer::appendHexEncoded(const uint8_t *input, size_t size, std::string &out) {
     static const char hex_char[] = "0123456789abcdef";
 
-    std::string dest;
-
-    dest.clear();
-    dest.resize(input.size() * 2);
+    size_t start = out.size();
+    out.resize(start + size * 2);
 
-    for (size_t i = 0; i < input.size(); ++i) {
+    for (size_t i = 0; i < size; ++i) {
         // High nybble
-        dest[i << 1] = hex_char[(input[i] >> 4) & 0x0f];
+        out[start + (i << 1)] = hex_char[(input[i] >> 4) & 0x0f];
         // Low nybble
-        dest[(i << 1) + 1] = hex_char[input[i] & 0x0f];
+        out[start + (i << 1) + 1] = hex_char[input[i] & 0x0f];
     }
-
-    return dest;
 }
 
 
 bool AwsV4Signer::isCanonicalHeader(const std::string &headerName) {
-    return headerName != HEADER_AMZ_SECURITY_TOKEN
-           && headerName != HEADER_AUTH;
+    return 0 != strcasecmp(headerName.c_str(), HEADER_AMZ_SECURITY_TOKEN.c_str())
+           && 0 != strcasecmp(headerName.c_str(), HEADER_AUTH.c_str());
 }
 
-std::string AwsV4Signer::generateCredentialScope(const std::string &dateString) const {
-    std::ostringstream credentialScope;
-    credentialScope << dateString << '/' << region_ << '/' << service_ << '/' << SIGNATURE_END;
-    return credentialScope.str();
+void AwsV4Signer::appendCredentialScope(const std::string &dateString, std::string &out) const {
+    out.append(dateString).append(1, '/')
+            .append(region_).append(1, '/')
+            .append(service_).append(1, '/')
+            .append(SIGNATURE_END);
 }
 
-std::string AwsV4Signer::generateCanonicalRequest(const Request &request) const {
+void AwsV4Signer::appendCanonicalRequest(const Request &request, const std::string &signedHeaders, std::string &out) const {
     const char *requestMethod = NULL;
     switch (request.getVerb()) {
         case Request::GET:
@@ -187,34 +292,38 @@ std::string AwsV4Signer::generateCanonicalRequest(const Request &request) const
     }
 
     // http://docs.aws.amazon.com/general/latest/gr/sigv4-create-canonical-request.html
-    std::ostringstream canonicalRequest;
-    canonicalRequest << requestMethod << '\n'
-                     << generateCanonicalURI(request) << '\n'
-                     << generateCanonicalQuery(request) << '\n'
-                     << generateCanonicalHeaders(request.getHeaders()) << '\n'
-                     << generateSignedHeaderList(request.getHeaders()) << '\n';
+    out.append(requestMethod).append(1, '\n');
+    appendCanonicalURI(request, out);
+    out.append(1, '\n');
+    appendCanonicalQuery(request, out);
+    out.append(1, '\n');
+    appendCanonicalHeaders(request.getHeaders(), out);
+    out.append(1, '\n');
+    out.append(signedHeaders).append(1, '\n');
 
     if (V4Streaming == signing_variant_) {
         // Streaming treats this portion as if the body were empty
-        canonicalRequest << hashStringSHA256(std::string());
+        out.append(EMPTY_PAYLOAD_HASH);
     } else {
         // standard signing
-        canonicalRequest << hashStringSHA256(request.getBody());
+        appendHashSHA256(request.getBody(), out);
     }
-
-    return canonicalRequest.str();
 }
 
-std::string AwsV4Signer::generateCanonicalURI(const Request &request) const {
+void AwsV4Signer::appendCanonicalURI(const Request &request, std::string &out) {
     const std::string &path = request.getPath();
     if (path.empty()) {
-        return "/";
+        out.append(1, '/');
+    } else {
+        out.append(path);
     }
-    return path;
 }
 
-std::string AwsV4Signer::generateCanonicalQuery(const Request &request) const {
+void AwsV4Signer::appendCanonicalQuery(const Request &request, std::string &out) {
     const std::string &query = request.getQuery();
+    if (query.empty()) {
+        return;
+    }
 
     // add query params to a vector
     std::vector<std::string> paramList;
@@ -234,53 +343,50 @@ std::string AwsV4Signer::generateCanonicalQuery(const Request &request) const {
     std::sort(paramList.begin(), paramList.end(), Request::icase_less());
 
     // create the canonical query
-    std::ostringstream canonicalQuery;
     for (size_t i = 0; i < paramList.size(); ++i) {
         if (0 != i) {
-            canonicalQuery << '&';
+            out.append(1, '&');
         }
-        canonicalQuery << paramList[i];
+        out.append(paramList[i]);
     }
-    return canonicalQuery.str();
 }
 
-inline std::string trim(const std::string &str) {
-    size_t first = str.find_first_not_of(' ');
-    size_t last = str.find_last_not_of(' ');
-    std::string out = str.substr(first, (last - first + 1));
-    return out;
+inline void append_lower(const std::string &str, std::string &out) {
+    for (char c : str) {
+        out.append(1, static_cast<char>(::tolower(static_cast<unsigned char>(c))));
+    }
 }
 
-inline std::string to_lower_copy(const std::string &str) {
-    std::string cpy = str;
-    std::transform(cpy.begin(), cpy.end(), cpy.begin(), ::tolower);
-    return cpy;
+inline void append_trimmed(const std::string &str, std::string &out) {
+    size_t first = str.find_first_not_of(' ');
+    if (std::string::npos != first) {
+        size_t last = str.find_last_not_of(' ');
+        out.append(str, first, last - first + 1);
+    }
 }
 
-std::string AwsV4Signer::generateCanonicalHeaders(const Request::HeaderMap &headers) const {
-    std::ostringstream canonicalHeaders;
+void AwsV4Signer::appendCanonicalHeaders(const Request::HeaderMap &headers, std::string &out) {
     for (Request::HeaderMap::const_iterator i = headers.begin(); i != headers.end(); ++i) {
-        const std::string headerName = to_lower_copy(i->first);
-        const std::string headerValue = trim(i->second);
-        if (isCanonicalHeader(headerName)) {
-            canonicalHeaders << headerName << ':' << headerValue << '\n';
+        if (isCanonicalHeader(i->first)) {
+            append_lower(i->first, out);
+            out.append(1, ':');
+            append_trimmed(i->second, out);
+            out.append(1, '\n');
         }
     }
-    return canonicalHeaders.str();
 }
 
-std::string AwsV4Signer::generateSignedHeaderList(const Request::HeaderMap &headers) const {
-    std::ostringstream signedHeaders;
+void AwsV4Signer::appendSignedHeaderList(const Request::HeaderMap &headers, std::string &out) {
+    size_t start = out.size();
     for (Request::HeaderMap::const_iterator i = headers.begin(); i != headers.end(); ++i) {
         const std::string &headerName = i->first;
         if (isCanonicalHeader(headerName)) {
-            if (signedHeaders.tellp() > 0) {
-                signedHeaders << ';';
+            if (out.size() > start) {
+                out.append(1, ';');
             }
-            signedHeaders << to_lower_copy(headerName);
+            append_lower(headerName, out);
         }
     }
-    return signedHeaders.str();
 }
 
 } // namespace video
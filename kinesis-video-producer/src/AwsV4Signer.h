@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Auth.h"
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -9,6 +10,11 @@ namespace com { namespace amazonaws { namespace kinesis { namespace video {
 
 /// Implements the AWS V4 signing procedure.
 ///
+/// The derived signing keys are cached process wide per region, service and the SHA256 hash of the secret
+/// key for the date they have been derived for, so only the first request of the day or with new credentials
+/// pays for the key derivation. The secret keys themselves are not kept by the cache. The canonical request and the string to sign are built in per-thread buffers which
+/// are reused across the calls.
+///
 /// See http://docs.aws.amazon.com/general/latest/gr/sigv4_signing.html
 class AwsV4Signer : public RequestSigner {
 public:
@@ -25,9 +31,13 @@ public:
 
     virtual void signRequest(Request &request) const;
 
-private:
-    typedef std::vector<uint8_t> byte_vector;
+    /// Sign the request as of the specified time.
+    void signRequest(Request &request, std::chrono::system_clock::time_point signing_time) const;
+
+    /// Drops the cached signing keys.
+    static void invalidateSigningKeys();
 
+private:
     enum SigningVariant {
         V4Standard,
         V4Streaming
@@ -39,30 +49,33 @@ private:
             std::unique_ptr<CredentialProvider> credentialProvider,
             SigningVariant signingVariant);
 
-    static std::string generateTimestamp(const char *formatString);
+    static std::string generateTimestamp(std::chrono::system_clock::time_point time, const char *formatString);
 
     static void generateHMAC(
-            const byte_vector &key,
+            const uint8_t *key,
+            size_t keySize,
             const std::string &message,
-            byte_vector &out);
+            uint8_t *out);
 
-    static std::string hashStringSHA256(const std::string &data);
+    static void appendHashSHA256(const std::string &data, std::string &out);
 
-    static std::string hexEncode(const byte_vector &input);
+    static void appendHexEncoded(const uint8_t *input, size_t size, std::string &out);
 
     static bool isCanonicalHeader(const std::string &headerName);
 
-    std::string generateCredentialScope(const std::string &dateString) const;
+    void getSigningKey(const std::string &secretKey, const std::string &dateString, uint8_t *signingKey) const;
+
+    void appendCredentialScope(const std::string &dateString, std::string &out) const;
 
-    std::string generateCanonicalRequest(const Request &request) const;
+    void appendCanonicalRequest(const Request &request, const std::string &signedHeaders, std::string &out) const;
 
-    std::string generateCanonicalURI(const Request &request) const;
+    static void appendCanonicalURI(const Request &request, std::string &out);
 
-    std::string generateCanonicalQuery(const Request &request) const;
+    static void appendCanonicalQuery(const Request &request, std::string &out);
 
-    std::string generateCanonicalHeaders(const Request::HeaderMap &headers) const;
+    static void appendCanonicalHeaders(const Request::HeaderMap &headers, std::string &out);
 
-    std::string generateSignedHeaderList(const Request::HeaderMap &headers) const;
+    static void appendSignedHeaderList(const Request::HeaderMap &headers, std::string &out);
 
     std::string region_;                                   ///< The service region.
     std::string service_;                                  ///< The service name.
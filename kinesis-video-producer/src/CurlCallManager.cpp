@@ -24,10 +24,12 @@ CurlCallManager::CurlGlobalInitializer::~CurlGlobalInitializer() {
     LOG_INFO("Curl shutdown.");
 }
 
-CurlCallManager::CurlCallManager() {
+CurlCallManager::CurlCallManager() : multi_engine_(nullptr) {
 }
 
 CurlCallManager::~CurlCallManager() {
+    // Stop the event loops before the curl global cleanup
+    multi_engines_.clear();
 }
 
 shared_ptr<Response> CurlCallManager::call(unique_ptr<Request> request,
@@ -39,7 +41,7 @@ shared_ptr<Response> CurlCallManager::call(unique_ptr<Request> request,
                                            unique_ptr<const RequestSigner> request_signer,
                                            std::shared_ptr<OngoingStreamState> ongoing_state) const {
     move(request_signer)->signRequest(*request);
-    shared_ptr<Response> response = Response::create(*request);
+    shared_ptr<Response> response = Response::create(*request, &handle_pool_);
 
     // Set the response object on state
     if (nullptr != ongoing_state) {
@@ -52,6 +54,63 @@ shared_ptr<Response> CurlCallManager::call(unique_ptr<Request> request,
     return response;
 }
 
+void CurlCallManager::callAsync(unique_ptr<Request> request,
+                                unique_ptr<const RequestSigner> request_signer,
+                                shared_ptr<OngoingStreamState> ongoing_state,
+                                std::chrono::system_clock::time_point start_time,
+                                CurlMultiEngine::CompletionCallback callback) const {
+    CurlMultiEngine* multi_engine;
+    {
+        std::lock_guard<std::mutex> lock(multi_engine_mutex_);
+        multi_engine = multi_engine_;
+    }
+
+    if (nullptr == multi_engine) {
+        // Dedicated thread blocking in the call for its entire duration
+        auto async_call = [this](unique_ptr<Request> request,
+                                 unique_ptr<const RequestSigner> request_signer,
+                                 shared_ptr<OngoingStreamState> ongoing_state,
+                                 std::chrono::system_clock::time_point start_time,
+                                 CurlMultiEngine::CompletionCallback callback) {
+            std::this_thread::sleep_until(start_time);
+            shared_ptr<Response> response = call(move(request), move(request_signer), ongoing_state);
+            callback(response);
+
+            // The thread exits after the call so free its trace ring for the other threads
+            PROFILER_TRACE_THREAD_EXIT();
+        };
+
+        std::thread worker(async_call, move(request), move(request_signer), ongoing_state, start_time, callback);
+        worker.detach();
+        return;
+    }
+
+    // The request is signed by the event loop when the transfer starts as the start might be delayed
+    shared_ptr<Response> response = Response::create(*request, &handle_pool_);
+
+    // Set the response object on state
+    if (nullptr != ongoing_state) {
+        ongoing_state->setResponse(response);
+    }
+
+    multi_engine->submit(move(request), move(request_signer), response, ongoing_state, start_time, callback);
+}
+
+CurlHandlePoolMetrics CurlCallManager::getConnectionMetrics() const {
+    return handle_pool_.getMetrics();
+}
+
+void CurlCallManager::setEventLoopCount(UINT32 loop_count) {
+    std::lock_guard<std::mutex> lock(multi_engine_mutex_);
+    multi_engine_ = nullptr;
+    if (0 != loop_count) {
+        multi_engines_.push_back(std::unique_ptr<CurlMultiEngine>(new CurlMultiEngine(loop_count)));
+        multi_engine_ = multi_engines_.back().get();
+    }
+
+    LOG_INFO("Using " << loop_count << " curl multi event loops for the asynchronous calls");
+}
+
 void CurlCallManager::dumpCurlEasyInfo(CURL *curl_easy) {
     double tt;
     CURLcode ret;
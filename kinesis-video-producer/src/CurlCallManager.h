@@ -4,9 +4,14 @@
 #include "Response.h"
 #include "Auth.h"
 #include "OngoingStreamState.h"
+#include "CurlMultiEngine.h"
+#include "CurlHandlePool.h"
 #include "Logger.h"
 
+#include <chrono>
 #include <memory>
+#include <mutex>
+#include <vector>
 #include <signal.h>
 
 namespace com { namespace amazonaws { namespace kinesis { namespace video {
@@ -24,6 +29,36 @@ public:
                                    std::unique_ptr<const RequestSigner> request_signer,
                                    std::shared_ptr<OngoingStreamState> ongoing_state) const;
 
+    /**
+     * Performs the call asynchronously. Depending on the mode the call is either driven by the curl multi
+     * event loops or by a dedicated detached thread.
+     *
+     * @param request The request to perform
+     * @param request_signer The signer for the request
+     * @param ongoing_state Optional streaming state
+     * @param start_time The call will not start before this time
+     * @param callback Invoked once the call has completed. In the event loop mode it's invoked on the event
+     *      loop thread and must not block.
+     */
+    void callAsync(std::unique_ptr<Request> request,
+                   std::unique_ptr<const RequestSigner> request_signer,
+                   std::shared_ptr<OngoingStreamState> ongoing_state,
+                   std::chrono::system_clock::time_point start_time,
+                   CurlMultiEngine::CompletionCallback callback) const;
+
+    /**
+     * Sets the number of the curl multi event loop threads driving the asynchronous calls. Zero switches
+     * back to a dedicated thread per call. The already running calls are not affected.
+     *
+     * @param loop_count Number of the event loop threads
+     */
+    void setEventLoopCount(UINT32 loop_count);
+
+    /**
+     * Returns the connection reuse metrics of the calls
+     */
+    CurlHandlePoolMetrics getConnectionMetrics() const;
+
 private:
     // RAII initializer for curl.
     struct CurlGlobalInitializer {
@@ -45,6 +80,14 @@ private:
     void dumpCurlEasyInfo(CURL *curl_easy);
 
     CurlGlobalInitializer curl_init_;  ///< Ensures curl initialization.
+
+    mutable CurlHandlePool handle_pool_;  ///< Reusable easy handles and the shared DNS, TLS session and connection caches.
+
+    mutable std::mutex multi_engine_mutex_;
+    CurlMultiEngine* multi_engine_;  ///< The current event loop engine or nullptr in the thread per call mode.
+
+    // The replaced engines are kept alive as the streaming states of the running calls reference them
+    std::vector<std::unique_ptr<CurlMultiEngine>> multi_engines_;
 };
 
 } // namespace video
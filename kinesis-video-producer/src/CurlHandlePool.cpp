@@ -0,0 +1,125 @@
+#include "CurlHandlePool.h"
+
+LOGGER_TAG("com.amazonaws.kinesis.video");
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+CurlHandlePool::CurlHandlePool() : metrics_() {
+    share_ = curl_share_init();
+    if (nullptr == share_) {
+        LOG_AND_THROW("Failed to create the curl share handle");
+    }
+
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, lockShare);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlockShare);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#ifdef CURL_HANDLE_POOL_SHARE_CONNECTIONS
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+}
+
+CurlHandlePool::~CurlHandlePool() {
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        for (auto& entry : idle_handles_) {
+            for (auto curl_easy : entry.second) {
+                curl_easy_cleanup(curl_easy);
+            }
+        }
+
+        idle_handles_.clear();
+    }
+
+    CURLSHcode result = curl_share_cleanup(share_);
+    if (CURLSHE_OK != result) {
+        LOG_WARN("Failed to free the curl share handle with: " << curl_share_strerror(result));
+    }
+
+    LOG_INFO("Curl handle pool created " << metrics_.createdHandleCount
+                                         << " handles, reused handles " << metrics_.reusedHandleCount
+                                         << " times, opened " << metrics_.newConnectionCount
+                                         << " connections, reused connections "
+                                         << metrics_.reusedConnectionCount << " times");
+}
+
+CURL* CurlHandlePool::acquire(const std::string& url) {
+    CURL* curl_easy = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        auto iter = idle_handles_.find(getEndpointKey(url));
+        if (idle_handles_.end() != iter && !iter->second.empty()) {
+            curl_easy = iter->second.back();
+            iter->second.pop_back();
+            metrics_.reusedHandleCount++;
+        } else {
+            metrics_.createdHandleCount++;
+        }
+    }
+
+    if (nullptr == curl_easy && nullptr == (curl_easy = curl_easy_init())) {
+        return nullptr;
+    }
+
+    curl_easy_setopt(curl_easy, CURLOPT_SHARE, share_);
+    return curl_easy;
+}
+
+void CurlHandlePool::release(const std::string& url, CURL* curl_easy, bool reusable) {
+    long connect_count = 0;
+
+    if (nullptr == curl_easy) {
+        return;
+    }
+
+    if (reusable) {
+        // Zero new connections means the completed transfer went over a reused connection
+        curl_easy_getinfo(curl_easy, CURLINFO_NUM_CONNECTS, &connect_count);
+
+        // The reset drops the options referring to the completed request but keeps the live connections and caches
+        curl_easy_reset(curl_easy);
+
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        if (0 == connect_count) {
+            metrics_.reusedConnectionCount++;
+        } else {
+            metrics_.newConnectionCount += connect_count;
+        }
+
+        auto& idle_handles = idle_handles_[getEndpointKey(url)];
+        if (idle_handles.size() < CURL_HANDLE_POOL_MAX_IDLE_HANDLES_PER_ENDPOINT) {
+            idle_handles.push_back(curl_easy);
+            return;
+        }
+    }
+
+    curl_easy_cleanup(curl_easy);
+}
+
+CurlHandlePoolMetrics CurlHandlePool::getMetrics() const {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    return metrics_;
+}
+
+std::string CurlHandlePool::getEndpointKey(const std::string& url) {
+    size_t authority_start = url.find("://");
+    authority_start = (std::string::npos == authority_start) ? 0 : authority_start + 3;
+    return url.substr(0, url.find('/', authority_start));
+}
+
+void CurlHandlePool::lockShare(CURL* curl_easy, curl_lock_data data, curl_lock_access access, void* user_data) {
+    UNUSED_PARAM(curl_easy);
+    UNUSED_PARAM(access);
+    reinterpret_cast<CurlHandlePool*>(user_data)->share_locks_[data].lock();
+}
+
+void CurlHandlePool::unlockShare(CURL* curl_easy, curl_lock_data data, void* user_data) {
+    UNUSED_PARAM(curl_easy);
+    reinterpret_cast<CurlHandlePool*>(user_data)->share_locks_[data].unlock();
+}
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Logger.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+
+#include "com/amazonaws/kinesis/video/common/CommonDefs.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+// Sharing the connection cache through the share handle is available starting with libcurl 7.57.0
+#if LIBCURL_VERSION_NUM >= 0x073900
+#define CURL_HANDLE_POOL_SHARE_CONNECTIONS
+#endif
+
+// Max number of the idle easy handles kept per endpoint
+#define CURL_HANDLE_POOL_MAX_IDLE_HANDLES_PER_ENDPOINT 4
+
+/**
+ * Connection reuse metrics of the handle pool
+ */
+struct CurlHandlePoolMetrics {
+    // Number of the easy handles created
+    UINT64 createdHandleCount;
+
+    // Number of the times an idle easy handle has been reused
+    UINT64 reusedHandleCount;
+
+    // Number of the connections opened by the completed transfers
+    UINT64 newConnectionCount;
+
+    // Number of the completed transfers which reused an existing connection and hence avoided the TCP and TLS handshakes
+    UINT64 reusedConnectionCount;
+};
+
+/**
+ * Pool of the reusable curl easy handles.
+ *
+ * The idle easy handles are kept per endpoint so the next call to the same endpoint picks up the handle along with
+ * its live connection. Additionally, all of the handles are attached to a shared handle holding the DNS cache,
+ * the TLS session cache and the connection cache, so a call to an endpoint can reuse a connection or at least
+ * resume a TLS session regardless of which handle or thread made the previous call.
+ */
+class CurlHandlePool {
+public:
+    CurlHandlePool();
+
+    /**
+     * Frees the idle handles and the shared handle. All of the acquired handles need to be released by then.
+     */
+    ~CurlHandlePool();
+
+    /**
+     * Returns an easy handle to use for the url. The handle is in the default state with the share handle attached.
+     *
+     * @param url The request URL
+     * @return The easy handle or nullptr on failure
+     */
+    CURL* acquire(const std::string& url);
+
+    /**
+     * Returns the handle to the pool once the transfer has completed. The handle is reset and kept around only if
+     * it can be reused and the pool for the endpoint is not full. Otherwise, it's freed.
+     *
+     * @param url The request URL the handle was acquired for
+     * @param curl_easy The easy handle
+     * @param reusable Whether the handle can be reused
+     */
+    void release(const std::string& url, CURL* curl_easy, bool reusable);
+
+    /**
+     * Returns a snapshot of the connection reuse metrics
+     */
+    CurlHandlePoolMetrics getMetrics() const;
+
+    /**
+     * Returns the pool key for the URL which is the scheme, the host and the port
+     */
+    static std::string getEndpointKey(const std::string& url);
+
+private:
+    static void lockShare(CURL* curl_easy, curl_lock_data data, curl_lock_access access, void* user_data);
+
+    static void unlockShare(CURL* curl_easy, curl_lock_data data, void* user_data);
+
+    // non-copyable
+    CurlHandlePool(CurlHandlePool const &);
+
+    void operator=(CurlHandlePool const &);
+
+    CURLSH* share_;
+
+    // The share handle data is accessed from multiple threads so each of the shared data types needs a lock
+    std::mutex share_locks_[CURL_LOCK_DATA_LAST];
+
+    mutable std::mutex pool_mutex_;
+    std::map<std::string, std::vector<CURL*>> idle_handles_;
+    CurlHandlePoolMetrics metrics_;
+};
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,272 @@
+#include "CurlMultiEngine.h"
+
+LOGGER_TAG("com.amazonaws.kinesis.video");
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+using std::unique_ptr;
+using std::shared_ptr;
+using std::move;
+
+bool CurlMultiEngine::isSupported() {
+#ifdef CURL_MULTI_ENGINE_SUPPORTED
+    return true;
+#else
+    return false;
+#endif
+}
+
+CurlMultiEngine::CurlMultiEngine(UINT32 loop_count) : shutdown_(false) {
+    if (!isSupported()) {
+        LOG_AND_THROW("Curl multi event loop requires libcurl 7.68.0 or later. Linked version: " << LIBCURL_VERSION);
+    }
+
+    for (UINT32 i = 0; i < MAX(1, loop_count); i++) {
+        unique_ptr<EventLoop> loop(new EventLoop());
+        loop->multi = curl_multi_init();
+        if (nullptr == loop->multi) {
+            LOG_AND_THROW("Failed to create the curl multi handle");
+        }
+
+        loop->transfer_count = 0;
+        loop->thread = std::thread(&CurlMultiEngine::run, this, loop.get());
+        loops_.push_back(move(loop));
+    }
+
+    LOG_INFO("Started " << loops_.size() << " curl multi event loops");
+}
+
+CurlMultiEngine::~CurlMultiEngine() {
+    shutdown_ = true;
+    for (auto& loop : loops_) {
+#ifdef CURL_MULTI_ENGINE_SUPPORTED
+        curl_multi_wakeup(loop->multi);
+#endif
+        if (loop->thread.joinable()) {
+            loop->thread.join();
+        }
+
+        curl_multi_cleanup(loop->multi);
+    }
+}
+
+void CurlMultiEngine::submit(unique_ptr<Request> request,
+                             unique_ptr<const RequestSigner> request_signer,
+                             shared_ptr<Response> response,
+                             shared_ptr<OngoingStreamState> ongoing_state,
+                             std::chrono::system_clock::time_point start_time,
+                             CompletionCallback callback) {
+    // Pick the least loaded event loop
+    EventLoop* loop = loops_[0].get();
+    for (auto& candidate : loops_) {
+        if (candidate->transfer_count < loop->transfer_count) {
+            loop = candidate.get();
+        }
+    }
+
+    CURL* curl_easy = response->getCurlHandle();
+    response->setMultiEngine(this);
+
+    // The read callback should pause the transfer instead of blocking the event loop
+    if (nullptr != ongoing_state) {
+        ongoing_state->setPausable([this, loop, curl_easy]() {
+            enqueue(loop, &EventLoop::resumed, curl_easy);
+        });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(transfer_loops_mutex_);
+        transfer_loops_[curl_easy] = loop;
+    }
+
+    unique_ptr<Transfer> transfer(new Transfer());
+    transfer->request = move(request);
+    transfer->request_signer = move(request_signer);
+    transfer->response = response;
+    transfer->start_time = start_time;
+    transfer->callback = callback;
+
+    loop->transfer_count++;
+    {
+        std::lock_guard<std::mutex> lock(loop->mutex);
+        loop->submitted.push_back(move(transfer));
+    }
+
+#ifdef CURL_MULTI_ENGINE_SUPPORTED
+    curl_multi_wakeup(loop->multi);
+#endif
+}
+
+void CurlMultiEngine::terminate(CURL* curl_easy) {
+    EventLoop* loop = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(transfer_loops_mutex_);
+        auto iter = transfer_loops_.find(curl_easy);
+        if (iter != transfer_loops_.end()) {
+            loop = iter->second;
+        }
+    }
+
+    // The transfer has already completed
+    if (nullptr != loop) {
+        enqueue(loop, &EventLoop::terminated, curl_easy);
+    }
+}
+
+UINT32 CurlMultiEngine::getTransferCount() const {
+    UINT32 count = 0;
+    for (auto& loop : loops_) {
+        count += loop->transfer_count;
+    }
+
+    return count;
+}
+
+void CurlMultiEngine::enqueue(EventLoop* loop, std::vector<CURL*> EventLoop::*queue, CURL* curl_easy) {
+    {
+        std::lock_guard<std::mutex> lock(loop->mutex);
+        ((*loop).*queue).push_back(curl_easy);
+    }
+
+#ifdef CURL_MULTI_ENGINE_SUPPORTED
+    curl_multi_wakeup(loop->multi);
+#endif
+}
+
+void CurlMultiEngine::run(EventLoop* loop) {
+#ifdef CURL_MULTI_ENGINE_SUPPORTED
+    int running = 0, messages_left = 0;
+    CURLMsg* message;
+
+    while (!shutdown_) {
+        processQueues(loop);
+
+        curl_multi_perform(loop->multi, &running);
+
+        while (nullptr != (message = curl_multi_info_read(loop->multi, &messages_left))) {
+            if (CURLMSG_DONE == message->msg) {
+                completeTransfer(loop, message->easy_handle, message->data.result);
+            }
+        }
+
+        curl_multi_poll(loop->multi, nullptr, 0, getPollTimeout(loop), nullptr);
+    }
+
+    // Complete the outstanding transfers. The delayed ones are started by the queue processing on shutdown.
+    processQueues(loop);
+    while (!loop->active.empty()) {
+        completeTransfer(loop, loop->active.begin()->first, CURLE_ABORTED_BY_CALLBACK);
+    }
+
+    // Free the trace ring of the event loop thread for the other threads
+    PROFILER_TRACE_THREAD_EXIT();
+#else
+    UNUSED_PARAM(loop);
+#endif
+}
+
+void CurlMultiEngine::processQueues(EventLoop* loop) {
+    std::vector<unique_ptr<Transfer>> submitted;
+    std::vector<CURL*> resumed, terminated;
+    auto now = std::chrono::system_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(loop->mutex);
+        submitted.swap(loop->submitted);
+        resumed.swap(loop->resumed);
+        terminated.swap(loop->terminated);
+    }
+
+    for (auto& transfer : submitted) {
+        loop->delayed.push_back(move(transfer));
+    }
+
+    // Start the transfers which are due
+    for (auto iter = loop->delayed.begin(); iter != loop->delayed.end();) {
+        if ((*iter)->start_time <= now || shutdown_) {
+            startTransfer(loop, move(*iter));
+            iter = loop->delayed.erase(iter);
+        } else {
+            iter++;
+        }
+    }
+
+    for (auto curl_easy : resumed) {
+        if (loop->active.end() != loop->active.find(curl_easy)) {
+            curl_easy_pause(curl_easy, CURLPAUSE_CONT);
+        }
+    }
+
+    for (auto curl_easy : terminated) {
+        if (loop->active.end() != loop->active.find(curl_easy)) {
+            LOG_INFO("Terminating the curl transfer");
+            completeTransfer(loop, curl_easy, CURLE_ABORTED_BY_CALLBACK);
+        }
+    }
+}
+
+void CurlMultiEngine::startTransfer(EventLoop* loop, unique_ptr<Transfer> transfer) {
+    CURL* curl_easy = transfer->response->getCurlHandle();
+
+    // Sign the delayed request with the current time and credentials right before it's sent
+    if (nullptr != transfer->request_signer) {
+        transfer->request_signer->signRequest(*transfer->request);
+        transfer->response->setRequestHeaders(*transfer->request);
+        transfer->request_signer.reset();
+    }
+
+    loop->active[curl_easy] = move(transfer);
+
+    CURLMcode result = curl_multi_add_handle(loop->multi, curl_easy);
+    if (CURLM_OK != result) {
+        LOG_ERROR("Failed to add the transfer to the curl multi handle with: " << curl_multi_strerror(result));
+        completeTransfer(loop, curl_easy, CURLE_FAILED_INIT);
+    }
+}
+
+void CurlMultiEngine::completeTransfer(EventLoop* loop, CURL* curl_easy, CURLcode result) {
+    auto iter = loop->active.find(curl_easy);
+    if (loop->active.end() == iter) {
+        return;
+    }
+
+    unique_ptr<Transfer> transfer = move(iter->second);
+    loop->active.erase(iter);
+
+    {
+        std::lock_guard<std::mutex> lock(transfer_loops_mutex_);
+        transfer_loops_.erase(curl_easy);
+    }
+
+    // The easy handle needs to be removed from the multi handle before the response releases it
+    curl_multi_remove_handle(loop->multi, curl_easy);
+    transfer->response->completeAsync(result);
+    loop->transfer_count--;
+
+    if (nullptr != transfer->callback) {
+        transfer->callback(transfer->response);
+    }
+}
+
+long CurlMultiEngine::getPollTimeout(EventLoop* loop) {
+    long timeout = -1;
+    auto now = std::chrono::system_clock::now();
+
+    curl_multi_timeout(loop->multi, &timeout);
+    if (timeout < 0 || timeout > CURL_MULTI_ENGINE_MAX_POLL_TIMEOUT_MILLIS) {
+        timeout = CURL_MULTI_ENGINE_MAX_POLL_TIMEOUT_MILLIS;
+    }
+
+    // Wake up in time for the delayed transfers
+    for (auto& transfer : loop->delayed) {
+        auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(transfer->start_time - now).count();
+        timeout = MIN(timeout, MAX(0, (long) delay));
+    }
+
+    return timeout;
+}
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
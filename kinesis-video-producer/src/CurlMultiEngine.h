@@ -0,0 +1,144 @@
+#pragma once
+
+#include "Auth.h"
+#include "Request.h"
+#include "Response.h"
+#include "OngoingStreamState.h"
+#include "Logger.h"
+#include "com/amazonaws/kinesis/video/trace/Include.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+// curl_multi_poll and curl_multi_wakeup are available starting with libcurl 7.68.0
+#if LIBCURL_VERSION_NUM >= 0x074400
+#define CURL_MULTI_ENGINE_SUPPORTED
+#endif
+
+// Max time the event loop sleeps in the poll when there are no curl timeouts or delayed transfers
+#define CURL_MULTI_ENGINE_MAX_POLL_TIMEOUT_MILLIS 1000
+
+/**
+ * Drives the HTTP transfers on a fixed number of curl multi event loop threads instead of a thread per call.
+ *
+ * The streaming transfers are paused by the read callback when there is no data to send and are resumed by
+ * the data available notification, so an idle stream doesn't occupy a thread. All of the curl easy handle
+ * operations happen on the event loop thread owning the transfer. The other threads only enqueue the
+ * requests and wake the event loop up.
+ */
+class CurlMultiEngine {
+public:
+    typedef std::function<void(std::shared_ptr<Response>)> CompletionCallback;
+
+    /**
+     * Creates the engine and starts the event loop threads.
+     *
+     * @param loop_count Number of event loop threads
+     */
+    explicit CurlMultiEngine(UINT32 loop_count);
+
+    /**
+     * Stops the event loops. The outstanding transfers are completed as terminated.
+     */
+    ~CurlMultiEngine();
+
+    /**
+     * Returns whether the linked libcurl supports the event loop
+     */
+    static bool isSupported();
+
+    /**
+     * Submits the transfer to the least loaded event loop.
+     *
+     * @param request The request. It's owned by the engine until the transfer completes as the curl callbacks refer to it.
+     * @param request_signer Signs the request on the event loop when the transfer starts so the signature
+     *        is not older than the start time of the transfer
+     * @param response The response created for the request
+     * @param ongoing_state Optional streaming state which will be switched to the pausable mode
+     * @param start_time The transfer will not start before this time
+     * @param callback Invoked on the event loop thread once the transfer has completed. Must not block.
+     */
+    void submit(std::unique_ptr<Request> request,
+                std::unique_ptr<const RequestSigner> request_signer,
+                std::shared_ptr<Response> response,
+                std::shared_ptr<OngoingStreamState> ongoing_state,
+                std::chrono::system_clock::time_point start_time,
+                CompletionCallback callback);
+
+    /**
+     * Terminates the transfer. Thread safe and non-blocking.
+     *
+     * @param curl_easy The easy handle of the transfer
+     */
+    void terminate(CURL* curl_easy);
+
+    /**
+     * Returns the number of active and pending transfers
+     */
+    UINT32 getTransferCount() const;
+
+private:
+    struct Transfer {
+        std::unique_ptr<Request> request;
+        std::unique_ptr<const RequestSigner> request_signer;
+        std::shared_ptr<Response> response;
+        std::chrono::system_clock::time_point start_time;
+        CompletionCallback callback;
+    };
+
+    struct EventLoop {
+        CURLM* multi;
+        std::thread thread;
+
+        // Protects the queues below which are filled by the other threads
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Transfer>> submitted;
+        std::vector<CURL*> resumed;
+        std::vector<CURL*> terminated;
+
+        // Owned by the event loop thread
+        std::vector<std::unique_ptr<Transfer>> delayed;
+        std::map<CURL*, std::unique_ptr<Transfer>> active;
+
+        std::atomic<UINT32> transfer_count;
+    };
+
+    void run(EventLoop* loop);
+
+    void enqueue(EventLoop* loop, std::vector<CURL*> EventLoop::*queue, CURL* curl_easy);
+
+    void processQueues(EventLoop* loop);
+
+    void startTransfer(EventLoop* loop, std::unique_ptr<Transfer> transfer);
+
+    void completeTransfer(EventLoop* loop, CURL* curl_easy, CURLcode result);
+
+    long getPollTimeout(EventLoop* loop);
+
+    // non-copyable
+    CurlMultiEngine(CurlMultiEngine const &);
+
+    void operator=(CurlMultiEngine const &);
+
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+
+    std::atomic<bool> shutdown_;
+
+    // Maps the easy handles to the owning event loop for the termination
+    std::mutex transfer_loops_mutex_;
+    std::map<CURL*, EventLoop*> transfer_loops_;
+};
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,50 @@
+/** Copyright 2017 Amazon.com. All rights reserved. */
+
+#include "DataAvailableNotifier.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+UINT64 DataAvailableNotifier::prepareWait() {
+    // Sequentially consistent ordering pairs with notify(). Either the notifier
+    // observes the waiter or the waiter observes the new epoch.
+    waiters_.fetch_add(1);
+    signaled_.store(false);
+    return epoch_.load();
+}
+
+void DataAvailableNotifier::cancelWait() {
+    waiters_.fetch_sub(1);
+}
+
+bool DataAvailableNotifier::commitWait(UINT64 key, std::chrono::nanoseconds timeout) {
+    bool notified;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notified = parked_.wait_for(lock, timeout, [this, key]() { return epoch_.load() != key; });
+    }
+
+    waiters_.fetch_sub(1);
+    return notified;
+}
+
+void DataAvailableNotifier::notify(bool wake) {
+    epoch_.fetch_add(1);
+
+    // Fast path - nobody is parked or the parked waiters have already been signaled
+    if (!wake || 0 == waiters_.load() || signaled_.exchange(true)) {
+        return;
+    }
+
+    // Taking the lock ensures the waiter is either before its predicate check or already parked
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+
+    parked_.notify_all();
+    wakeup_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
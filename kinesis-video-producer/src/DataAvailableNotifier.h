@@ -0,0 +1,111 @@
+/** Copyright 2017 Amazon.com. All rights reserved. */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include "com/amazonaws/kinesis/video/common/CommonDefs.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+/**
+ * Event count used to signal the network thread that the stream data is available.
+ *
+ * The notifying side only bumps an atomic epoch. It takes the mutex and signals the condition variable only
+ * when a reader is actually parked, so the notifications are free while the network thread is busy sending.
+ *
+ * The reader follows the prepare/commit protocol:
+ *
+ *      auto key = notifier.prepareWait();
+ *      if (condition) {
+ *          notifier.cancelWait();
+ *      } else {
+ *          notifier.commitWait(key, timeout);
+ *      }
+ *
+ * The condition is re-checked after the waiter is registered so a notification can't be lost between the
+ * check and the park.
+ */
+class DataAvailableNotifier {
+public:
+    DataAvailableNotifier() : epoch_(0), waiters_(0), signaled_(false), wakeup_count_(0) {}
+
+    /**
+     * Registers the caller as a waiter.
+     *
+     * @return The key to pass to commitWait()
+     */
+    UINT64 prepareWait();
+
+    /**
+     * De-registers the waiter without parking.
+     */
+    void cancelWait();
+
+    /**
+     * Parks the caller until the epoch moves past the key or the timeout elapses and de-registers the waiter.
+     *
+     * @param key The key returned by prepareWait()
+     * @param timeout Max time to park
+     * @return true if notified, false on timeout
+     */
+    bool commitWait(UINT64 key, std::chrono::nanoseconds timeout);
+
+    /**
+     * Advances the epoch and optionally wakes the parked reader.
+     *
+     * @param wake Whether to wake the parked reader. The epoch is advanced regardless so a reader
+     *      waking up on a timeout will still observe the notification.
+     */
+    void notify(bool wake);
+
+    /**
+     * Returns whether there is a registered waiter
+     */
+    bool hasWaiters() const {
+        return 0 != waiters_.load();
+    }
+
+    /**
+     * Returns the number of times the parked reader has been woken up
+     */
+    UINT64 getWakeupCount() const {
+        return wakeup_count_.load(std::memory_order_relaxed);
+    }
+
+private:
+    /**
+     * Incremented on every notification
+     */
+    std::atomic<UINT64> epoch_;
+
+    /**
+     * Number of registered waiters
+     */
+    std::atomic<UINT32> waiters_;
+
+    /**
+     * Whether the currently registered waiters have already been woken up. Reset by every new waiter
+     * so the notifications keep being coalesced until the woken waiter parks again.
+     */
+    std::atomic<bool> signaled_;
+
+    /**
+     * Number of wakeups issued for the parked waiters
+     */
+    std::atomic<UINT64> wakeup_count_;
+
+    /**
+     * Mutex and condition variable used only to park and wake the waiters
+     */
+    std::mutex mutex_;
+    std::condition_variable parked_;
+};
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
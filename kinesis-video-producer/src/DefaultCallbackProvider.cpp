@@ -122,10 +122,20 @@ STATUS DefaultCallbackProvider::createStreamHandler(
 
     LOG_DEBUG("createStreamHandler post body: " << post_body);
 
+    // The description of the new stream which is stored in the bootstrap cache once the ARN is known
+    StreamDescription stream_description;
+    MEMSET(&stream_description, 0x00, SIZEOF(StreamDescription));
+    stream_description.version = STREAM_DESCRIPTION_CURRENT_VERSION;
+    STRNCPY(stream_description.deviceName, device_name, MAX_DEVICE_NAME_LEN - 1);
+    STRNCPY(stream_description.streamName, stream_name, MAX_STREAM_NAME_LEN - 1);
+    STRNCPY(stream_description.contentType, content_type, MAX_CONTENT_TYPE_LEN - 1);
+    stream_description.streamStatus = STREAM_STATUS_ACTIVE;
+
     auto async_call = [](const DefaultCallbackProvider* this_obj,
                          std::unique_ptr<Request> request,
                          std::unique_ptr<const RequestSigner> request_signer,
                          string stream_name_str,
+                         StreamDescription stream_description,
                          PServiceCallContext service_call_ctx) -> auto {
         uint64_t custom_data = service_call_ctx->customData;
 
@@ -156,13 +166,21 @@ STATUS DefaultCallbackProvider::createStreamHandler(
 
         string stream_arn(json_response["StreamARN"].asString());
         LOG_INFO("Created new Kinesis Video stream: " << stream_arn);
+        if (nullptr != this_obj->bootstrap_cache_ && MAX_ARN_LEN > stream_arn.size()) {
+            std::strcpy(stream_description.streamArn, stream_arn.c_str());
+            stream_description.creationTime = this_obj->getCurrentTimeHandler(0);
+            this_obj->bootstrap_cache_->putStreamDescription(this_obj->getBootstrapCacheKey(stream_name_str),
+                                                             stream_description);
+        }
+
         STATUS status = createStreamResultEvent(custom_data, service_call_result,
                                                 const_cast<PCHAR>(stream_arn.c_str()));
 
         this_obj->notifyResult(status, custom_data);
     };
 
-    thread worker(async_call, this_obj, move(request), move(request_signer), stream_name_str, service_call_ctx);
+    thread worker(async_call, this_obj, move(request), move(request_signer), stream_name_str, stream_description,
+                  service_call_ctx);
     worker.detach();
     return STATUS_SUCCESS;
 }
@@ -207,10 +225,14 @@ STATUS DefaultCallbackProvider::tagResourceHandler(
 
     LOG_DEBUG("tagResourceHandler post body: " << post_body);
 
+    // With the cached bootstrap the tagging doesn't gate the streaming and is completed in the background
+    bool report_early = nullptr != this_obj->bootstrap_cache_;
+
     auto async_call = [](const DefaultCallbackProvider* this_obj,
                          std::unique_ptr<Request> request,
                          std::unique_ptr<const RequestSigner> request_signer,
                          string stream_arn_str,
+                         bool report_early,
                          PServiceCallContext service_call_ctx) -> auto {
 
         uint64_t custom_data = service_call_ctx->customData;
@@ -218,6 +240,13 @@ STATUS DefaultCallbackProvider::tagResourceHandler(
         // Wait for the specified amount of time before calling
         auto call_after_time = std::chrono::nanoseconds(service_call_ctx->callAfter * DEFAULT_TIME_UNIT_IN_NANOS);
         auto time_point = std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> (call_after_time);
+
+        // The service call context is not accessed after the result is reported as the stream reuses it
+        if (report_early) {
+            STATUS status = tagResourceResultEvent(custom_data, SERVICE_CALL_RESULT_OK);
+            this_obj->notifyResult(status, custom_data);
+        }
+
         std::this_thread::sleep_until(time_point);
 
         // Perform a sync call
@@ -230,13 +259,18 @@ STATUS DefaultCallbackProvider::tagResourceHandler(
                                                               << string(response->getData()));
         }
 
+        if (report_early) {
+            return;
+        }
+
         SERVICE_CALL_RESULT service_call_result = response->getServiceCallResult();
         STATUS status = tagResourceResultEvent(custom_data, service_call_result);
 
         this_obj->notifyResult(status, custom_data);
     };
 
-    thread worker(async_call, this_obj, move(request), move(request_signer), stream_arn_str, service_call_ctx);
+    thread worker(async_call, this_obj, move(request), move(request_signer), stream_arn_str, report_early,
+                  service_call_ctx);
     worker.detach();
     return STATUS_SUCCESS;
 }
@@ -249,6 +283,26 @@ STATUS DefaultCallbackProvider::describeStreamHandler(
 
     string stream_name_str = string(stream_name);
 
+    if (nullptr != this_obj->bootstrap_cache_) {
+        StreamDescription cached_description;
+        if (this_obj->bootstrap_cache_->getStreamDescription(this_obj->getBootstrapCacheKey(stream_name_str),
+                                                             cached_description)) {
+            LOG_INFO("Using the cached description of Kinesis Video stream: " << cached_description.streamArn);
+            auto cached_call = [this_obj, cached_description, service_call_ctx]() mutable {
+                uint64_t custom_data = service_call_ctx->customData;
+                STATUS status = describeStreamResultEvent(custom_data, SERVICE_CALL_RESULT_OK, &cached_description);
+                this_obj->notifyResult(status, custom_data);
+            };
+
+            thread worker(cached_call);
+            worker.detach();
+            return STATUS_SUCCESS;
+        }
+
+        // The data endpoint doesn't depend on the describe stream result so it's fetched in parallel
+        this_obj->prefetchDataEndpoint(stream_name_str, service_call_ctx);
+    }
+
     Json::Value args = Json::objectValue;
     args["StreamName"] = stream_name_str;
     FastWriter jsonWriter;
@@ -354,6 +408,15 @@ STATUS DefaultCallbackProvider::describeStreamHandler(
                                                                 << " in Kinesis Video (stream will be created)");
         }
 
+        if (nullptr != this_obj->bootstrap_cache_) {
+            string bootstrap_key = this_obj->getBootstrapCacheKey(stream_name_str);
+            if (nullptr != stream_description_ptr && STREAM_STATUS_ACTIVE == stream_description.streamStatus) {
+                this_obj->bootstrap_cache_->putStreamDescription(bootstrap_key, stream_description);
+            } else {
+                this_obj->bootstrap_cache_->invalidate(bootstrap_key);
+            }
+        }
+
         SERVICE_CALL_RESULT service_call_result = response->getServiceCallResult();
         STATUS status = describeStreamResultEvent(custom_data,
                                                   service_call_result,
@@ -375,12 +438,27 @@ STATUS DefaultCallbackProvider::streamingEndpointHandler(
 
     string stream_name_str = string(stream_name);
 
-    Json::Value args = Json::objectValue;
-    args["StreamName"] = stream_name_str;
-    args["APIName"] = api_name;
+    std::shared_future<string> prefetch;
+    if (nullptr != this_obj->bootstrap_cache_) {
+        string cached_endpoint;
+        if (this_obj->bootstrap_cache_->getDataEndpoint(this_obj->getBootstrapCacheKey(stream_name_str),
+                                                        cached_endpoint)) {
+            LOG_INFO("Using the cached data endpoint: " << cached_endpoint);
+            auto cached_call = [this_obj, cached_endpoint, service_call_ctx]() {
+                uint64_t custom_data = service_call_ctx->customData;
+                STATUS status = getStreamingEndpointResultEvent(custom_data,
+                                                                SERVICE_CALL_RESULT_OK,
+                                                                const_cast<PCHAR>(cached_endpoint.c_str()));
+                this_obj->notifyResult(status, custom_data);
+            };
+
+            thread worker(cached_call);
+            worker.detach();
+            return STATUS_SUCCESS;
+        }
 
-    FastWriter jsonWriter;
-    string post_body(jsonWriter.write(args));
+        prefetch = this_obj->takeDataEndpointPrefetch(stream_name_str);
+    }
 
     // De-serialize the credentials from the context
     Credentials credentials;
@@ -390,20 +468,29 @@ STATUS DefaultCallbackProvider::streamingEndpointHandler(
     auto staticCredentialProvider = make_unique<StaticCredentialProvider> (credentials);
     auto request_signer = AwsV4Signer::Create(this_obj->region_, this_obj->service_, move(staticCredentialProvider));
 
-    string endpoint = this_obj->getControlPlaneUri();
-    string url = endpoint + "/getDataEndpoint";
-    unique_ptr<Request> request = make_unique<Request>(Request::POST, url);
-    request->setConnectionTimeout(std::chrono::milliseconds(service_call_ctx->timeout / HUNDREDS_OF_NANOS_IN_A_MILLISECOND));
-    request->setHeader("host", endpoint);
-    request->setBody(post_body);
+    unique_ptr<Request> request = this_obj->createDataEndpointRequest(stream_name_str, api_name, service_call_ctx);
 
     auto async_call = [](const DefaultCallbackProvider* this_obj,
                          std::unique_ptr<Request> request,
                          std::unique_ptr<const RequestSigner> request_signer,
                          string stream_name_str,
+                         std::shared_future<string> prefetch,
                          PServiceCallContext service_call_ctx) -> auto {
         uint64_t custom_data = service_call_ctx->customData;
 
+        // The endpoint fetched in parallel with the describe stream call saves the round trip
+        if (prefetch.valid()) {
+            string prefetched_endpoint = prefetch.get();
+            if (!prefetched_endpoint.empty()) {
+                LOG_INFO("streaming to prefetched endpoint: " << prefetched_endpoint);
+                STATUS status = getStreamingEndpointResultEvent(custom_data,
+                                                                SERVICE_CALL_RESULT_OK,
+                                                                const_cast<PCHAR>(prefetched_endpoint.c_str()));
+                this_obj->notifyResult(status, custom_data);
+                return;
+            }
+        }
+
         // Wait for the specified amount of time before calling
         auto call_after_time = std::chrono::nanoseconds(service_call_ctx->callAfter * DEFAULT_TIME_UNIT_IN_NANOS);
         auto time_point = std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> (call_after_time);
@@ -432,6 +519,15 @@ STATUS DefaultCallbackProvider::streamingEndpointHandler(
             LOG_INFO("streaming to endpoint: " << string(reinterpret_cast<char *>(streaming_endpoint_chars)));
         }
 
+        if (nullptr != this_obj->bootstrap_cache_) {
+            string bootstrap_key = this_obj->getBootstrapCacheKey(stream_name_str);
+            if ('\0' != streaming_endpoint_chars[0]) {
+                this_obj->bootstrap_cache_->putDataEndpoint(bootstrap_key, streaming_endpoint_chars);
+            } else {
+                this_obj->bootstrap_cache_->invalidate(bootstrap_key);
+            }
+        }
+
         SERVICE_CALL_RESULT service_call_result = response->getServiceCallResult();
         STATUS status = getStreamingEndpointResultEvent(custom_data,
                                                         service_call_result,
@@ -440,7 +536,8 @@ STATUS DefaultCallbackProvider::streamingEndpointHandler(
         this_obj->notifyResult(status, custom_data);
     };
 
-    thread worker(async_call, this_obj, move(request), move(request_signer), stream_name_str, service_call_ctx);
+    thread worker(async_call, this_obj, move(request), move(request_signer), stream_name_str, prefetch,
+                  service_call_ctx);
     worker.detach();
     return STATUS_SUCCESS;
 }
@@ -541,29 +638,22 @@ STATUS DefaultCallbackProvider::putStreamHandler(
     request->setHeader("transfer-encoding", "chunked");
     request->setHeader("connection", "keep-alive");
 
-    auto async_call = [](DefaultCallbackProvider* this_obj,
-                         shared_ptr<OngoingStreamState> state,
-                         std::unique_ptr<Request> request,
-                         std::unique_ptr<const RequestSigner> request_signer,
-                         string stream_name_str,
-                         PServiceCallContext service_call_ctx) -> auto {
-        uint64_t custom_data = service_call_ctx->customData;
+    // The call will not start before the specified time
+    auto call_after_time = std::chrono::nanoseconds(service_call_ctx->callAfter * DEFAULT_TIME_UNIT_IN_NANOS);
+    auto time_point = std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>(call_after_time);
 
-        // Wait for the specified amount of time before calling
-        auto call_after_time = std::chrono::nanoseconds(service_call_ctx->callAfter * DEFAULT_TIME_UNIT_IN_NANOS);
-        auto time_point = std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>(call_after_time);
-        std::this_thread::sleep_until(time_point);
+    LOG_INFO("Creating new connection for Kinesis Video stream: " << stream_name_str);
 
-        LOG_INFO("Creating new connection for Kinesis Video stream: " << stream_name_str);
-
-        // Perform a sync call
-        shared_ptr<Response> response = this_obj->ccm_.call(move(request), move(request_signer), state);
+    // The completion runs either on the dedicated network thread or on the curl event loop thread
+    uint64_t stream_custom_data = service_call_ctx->customData;
+    auto on_complete = [this_obj, state, stream_name_str, stream_custom_data](shared_ptr<Response> response) {
+        uint64_t custom_data = stream_custom_data;
 
         LOG_DEBUG("Connection for Kinesis Video stream: " << stream_name_str << " closed.");
 
         auto upload_handle = state->getUploadHandle();
 
-        // does not return until the stream ends.
+        // the call does not complete until the stream ends.
         // this behavior is important because it keeps the cb_data variable valid for the lifetime of the stream.
         LOG_DEBUG("Network thread for Kinesis Video stream: " << stream_name_str
                                                              << " with upload handle: "
@@ -571,9 +661,13 @@ STATUS DefaultCallbackProvider::putStreamHandler(
                                                              << " exited. http status: "
                                                              << response->getStatusCode());
 
+        // Unpin the data the connection didn't get to send. This is a no-op once the stream is shut down.
+        state->releaseDataSpan();
+
         if (state->isShutdown()) {
             LOG_INFO("Streaming session terminated");
         } else {
+
             // Remove the state from the active list
             {
                 // Interlock the operation
@@ -588,13 +682,21 @@ STATUS DefaultCallbackProvider::putStreamHandler(
                                  << " has exited without triggering end-of-stream. Service call result: "
                                  << response->getServiceCallResult());
 
+                // The cached bootstrap information might be the culprit so the next bootstrap refreshes it
+                if (nullptr != this_obj->bootstrap_cache_) {
+                    this_obj->bootstrap_cache_->invalidate(this_obj->getBootstrapCacheKey(stream_name_str));
+                }
+
                 kinesisVideoStreamTerminated(custom_data, upload_handle, response->getServiceCallResult());
             }
         }
     };
 
-    thread worker(async_call, this_obj, state, move(request), move(request_signer), stream_name_str, service_call_ctx);
-    worker.detach();
+    this_obj->ccm_.callAsync(move(request),
+                             move(request_signer),
+                             state,
+                             std::chrono::time_point_cast<std::chrono::system_clock::duration>(time_point),
+                             on_complete);
 
     // Return 200 to Kinesis Video SDK on successful connection establishment as the POST is theoretically infinite.
     STATUS status = putStreamResultEvent(service_call_ctx->customData, SERVICE_CALL_RESULT_OK, upload_handle);
@@ -605,10 +707,16 @@ STATUS DefaultCallbackProvider::putStreamHandler(
 }
 
 void DefaultCallbackProvider::shutdownStream(STREAM_HANDLE stream_handle) {
-    std::unique_lock<std::recursive_mutex> lock(active_streams_mutex_);
+    std::map<UINT64, std::shared_ptr<OngoingStreamState>> map;
+
+    // The states are shut down outside of the lock as the shutdown awaits the span release
+    // which notifies the data availability under the same lock.
+    {
+        std::unique_lock<std::recursive_mutex> lock(active_streams_mutex_);
+        map = active_streams_.getMap();
+    }
 
     // Iterate over the map and make sure to shutdown all the ongoing states
-    auto map = active_streams_.getMap();
     for (std::map<UINT64, std::shared_ptr<OngoingStreamState>>::iterator iter = map.begin();
          iter != map.end();
          iter++) {
@@ -762,6 +870,79 @@ void DefaultCallbackProvider::notifyResult(STATUS status, STREAM_HANDLE stream_h
     }
 }
 
+void DefaultCallbackProvider::enableBootstrapCache(const string &cache_path) {
+    bootstrap_cache_ = make_unique<StreamBootstrapCache>(cache_path);
+}
+
+unique_ptr<Request> DefaultCallbackProvider::createDataEndpointRequest(const string &stream_name,
+                                                                       const string &api_name,
+                                                                       PServiceCallContext service_call_ctx) const {
+    Json::Value args = Json::objectValue;
+    args["StreamName"] = stream_name;
+    args["APIName"] = api_name;
+
+    FastWriter jsonWriter;
+    string post_body(jsonWriter.write(args));
+
+    string endpoint = control_plane_uri_;
+    string url = endpoint + "/getDataEndpoint";
+    unique_ptr<Request> request = make_unique<Request>(Request::POST, url);
+    request->setConnectionTimeout(std::chrono::milliseconds(service_call_ctx->timeout / HUNDREDS_OF_NANOS_IN_A_MILLISECOND));
+    request->setHeader("host", endpoint);
+    request->setBody(post_body);
+    return request;
+}
+
+void DefaultCallbackProvider::prefetchDataEndpoint(const string &stream_name, PServiceCallContext service_call_ctx) {
+    // The context is reused by the stream so everything needed is extracted before returning
+    Credentials credentials;
+    SerializedCredentials::deSerialize(service_call_ctx->pAuthInfo->data, service_call_ctx->pAuthInfo->size, credentials);
+    auto staticCredentialProvider = make_unique<StaticCredentialProvider> (credentials);
+    auto request_signer = AwsV4Signer::Create(region_, service_, move(staticCredentialProvider));
+    auto request = createDataEndpointRequest(stream_name, "PUT_MEDIA", service_call_ctx);
+
+    auto prefetch_call = [this](std::unique_ptr<Request> request,
+                                std::unique_ptr<const RequestSigner> request_signer,
+                                string stream_name) -> string {
+        shared_ptr<Response> response = ccm_.call(move(request), move(request_signer));
+
+        // Any failure falls back to the regular call from the streaming endpoint handler
+        Json::Reader reader;
+        Json::Value json_response = Json::nullValue;
+        if (HTTP_OK != response->getStatusCode() || !reader.parse(response->getData(), json_response)) {
+            LOG_DEBUG("Data endpoint prefetch for stream " << stream_name << " failed: " << response->getData());
+            return "";
+        }
+
+        string streaming_endpoint(json_response["DataEndpoint"].asString());
+        if (streaming_endpoint.empty() || MAX_URI_CHAR_LEN <= streaming_endpoint.size()) {
+            return "";
+        }
+
+        bootstrap_cache_->putDataEndpoint(getBootstrapCacheKey(stream_name), streaming_endpoint);
+        return streaming_endpoint;
+    };
+
+    std::shared_future<string> prefetch = async(launch::async, prefetch_call, move(request), move(request_signer),
+                                                stream_name).share();
+
+    lock_guard<mutex> lock(endpoint_prefetches_mutex_);
+    endpoint_prefetches_[stream_name] = prefetch;
+}
+
+std::shared_future<string> DefaultCallbackProvider::takeDataEndpointPrefetch(const string &stream_name) {
+    std::shared_future<string> prefetch;
+
+    lock_guard<mutex> lock(endpoint_prefetches_mutex_);
+    auto iter = endpoint_prefetches_.find(stream_name);
+    if (endpoint_prefetches_.end() != iter) {
+        prefetch = iter->second;
+        endpoint_prefetches_.erase(iter);
+    }
+
+    return prefetch;
+}
+
 DefaultCallbackProvider::DefaultCallbackProvider(
         unique_ptr <ClientCallbackProvider> client_callback_provider,
         unique_ptr <StreamCallbackProvider> stream_callback_provider,
@@ -11,6 +11,7 @@
 #include "StreamCallbackProvider.h"
 #include "ThreadSafeMap.h"
 #include "OngoingStreamState.h"
+#include "StreamBootstrapCache.h"
 
 #include "json/json.h"
 
@@ -48,6 +49,18 @@ public:
 
     virtual ~DefaultCallbackProvider();
 
+    /**
+     * Enables the cached and parallel stream bootstrap. Needs to be called before the streams are created.
+     *
+     * The stream description and the data endpoint are persisted in the cache file and are served from it on
+     * the subsequent startups so the first PutMedia connection can be opened without any control plane round
+     * trips. On a cache miss the data endpoint is fetched in parallel with the describe stream call and the
+     * tagging is reported as complete right away and performed in the background as it doesn't gate the streaming.
+     *
+     * @param cache_path Path to the cache file
+     */
+    void enableBootstrapCache(const std::string &cache_path);
+
     /**
      * Stream is being freed
      */
@@ -401,6 +414,31 @@ protected:
      */
     void notifyResult(STATUS status, STREAM_HANDLE stream_handle) const;
 
+    /**
+     * Returns the bootstrap cache key of the stream
+     */
+    std::string getBootstrapCacheKey(const std::string &stream_name) const {
+        return StreamBootstrapCache::getKey(control_plane_uri_, stream_name);
+    }
+
+    /**
+     * Creates the get data endpoint request for the stream
+     */
+    std::unique_ptr<Request> createDataEndpointRequest(const std::string &stream_name,
+                                                       const std::string &api_name,
+                                                       PServiceCallContext service_call_ctx) const;
+
+    /**
+     * Starts fetching the data endpoint in the background so the streaming endpoint handler can pick it up
+     * without another round trip once the describe and create stream calls have completed.
+     */
+    void prefetchDataEndpoint(const std::string &stream_name, PServiceCallContext service_call_ctx);
+
+    /**
+     * Takes over the pending data endpoint prefetch of the stream if any
+     */
+    std::shared_future<std::string> takeDataEndpointPrefetch(const std::string &stream_name);
+
     /**
      * SIGV4 request signer used by curl call manager to sign HTTP requests.
      */
@@ -461,6 +499,17 @@ protected:
      *
      */
     ThreadSafeMap<UPLOAD_HANDLE, std::shared_ptr<OngoingStreamState>> active_streams_;
+
+    /**
+     * The stream bootstrap cache. Null unless the cached bootstrap is enabled.
+     */
+    std::unique_ptr<StreamBootstrapCache> bootstrap_cache_;
+
+    /**
+     * The data endpoint calls issued in parallel with the describe stream call keyed by the stream name
+     */
+    std::mutex endpoint_prefetches_mutex_;
+    std::map<std::string, std::shared_future<std::string>> endpoint_prefetches_;
 };
 
 } // namespace video
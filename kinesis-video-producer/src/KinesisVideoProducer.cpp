@@ -151,11 +151,24 @@ shared_ptr<KinesisVideoStream> KinesisVideoProducer::createStream(unique_ptr<Str
         status_strstrm << std::hex << status;
         LOG_ERROR(" Unable to create Kinesis Video stream. " + stream_definition->getStreamName() +
                   " Error status: 0x" + status_strstrm.str());
+
+        // Drop the ready state the failed stream might have recorded so it's not applied to a stream reusing the handle
+        forgetEarlyReadyStream(*kinesis_video_stream->getStreamHandle());
         return nullptr;
     }
 
-    // Add to the map
-    active_streams_.put(*kinesis_video_stream->getStreamHandle(), kinesis_video_stream);
+    // Add to the map and apply the ready state if the stream became ready before it was registered.
+    // The early ready state is consumed before the registration so a failed registration doesn't leave it behind.
+    {
+        std::lock_guard<std::mutex> registration_lock(stream_registration_mutex_);
+        bool early_ready = 0 != early_ready_streams_.erase(*kinesis_video_stream->getStreamHandle());
+        active_streams_.put(*kinesis_video_stream->getStreamHandle(), kinesis_video_stream);
+        if (early_ready) {
+            std::lock_guard<std::mutex> lock(kinesis_video_stream->getStreamMutex());
+            kinesis_video_stream->streamReady();
+            kinesis_video_stream->getStreamReadyVar().notify_one();
+        }
+    }
 
     return kinesis_video_stream;
 }
@@ -203,8 +216,20 @@ void KinesisVideoProducer::freeStream(std::shared_ptr<KinesisVideoStream> kinesi
     // Stop the ongoing CURL operations
     callback_provider_->shutdownStream(*kinesis_video_stream->getStreamHandle());
 
-    // Find the stream and remove it from the map
-    active_streams_.remove(*kinesis_video_stream->getStreamHandle());
+    // Find the stream and remove it from the map along with the ready state the callback racing
+    // the removal might have recorded for it
+    {
+        std::lock_guard<std::mutex> registration_lock(stream_registration_mutex_);
+        active_streams_.remove(*kinesis_video_stream->getStreamHandle());
+        early_ready_streams_.erase(*kinesis_video_stream->getStreamHandle());
+    }
+}
+
+void KinesisVideoProducer::forgetEarlyReadyStream(STREAM_HANDLE stream_handle) {
+    if (IS_VALID_STREAM_HANDLE(stream_handle)) {
+        std::lock_guard<std::mutex> registration_lock(stream_registration_mutex_);
+        early_ready_streams_.erase(stream_handle);
+    }
 }
 
 KinesisVideoProducer::~KinesisVideoProducer() {
@@ -240,11 +265,19 @@ STATUS KinesisVideoProducer::clientReadyFunc(UINT64 custom_data,
 STATUS KinesisVideoProducer::streamReadyFunc(UINT64 custom_data,
                                              STREAM_HANDLE stream_handle) {
     auto this_obj = reinterpret_cast<KinesisVideoProducer*>(custom_data);
-    auto kinesis_video_stream = this_obj->active_streams_.get(stream_handle);
-    assert(nullptr != kinesis_video_stream);
+    shared_ptr<KinesisVideoStream> kinesis_video_stream;
 
-    // Trigger the stream ready state
     {
+        std::lock_guard<std::mutex> registration_lock(this_obj->stream_registration_mutex_);
+        kinesis_video_stream = this_obj->active_streams_.get(stream_handle);
+        if (nullptr == kinesis_video_stream) {
+            // createStream hasn't registered the stream yet and will apply the ready state when it does
+            this_obj->early_ready_streams_.insert(stream_handle);
+        }
+    }
+
+    // Trigger the stream ready state
+    if (nullptr != kinesis_video_stream) {
         std::lock_guard<std::mutex> lock(kinesis_video_stream->getStreamMutex());
         kinesis_video_stream->streamReady();
         kinesis_video_stream->getStreamReadyVar().notify_one();
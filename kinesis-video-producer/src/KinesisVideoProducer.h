@@ -17,6 +17,7 @@
 
 #include <memory>
 #include <mutex>
+#include <unordered_set>
 #include <iostream>
 
 #include "com/amazonaws/kinesis/video/client/Include.h"
@@ -181,6 +182,22 @@ protected:
      */
     ThreadSafeMap<STREAM_HANDLE, shared_ptr<KinesisVideoStream>> active_streams_;
 
+    /**
+     * Mutex guarding the stream registration against the stream ready callback.
+     */
+    std::mutex stream_registration_mutex_;
+
+    /**
+     * Handles of the streams that became ready before they were added to the map. With the cached
+     * stream bootstrap the ready callback can fire before createStream registers the stream.
+     */
+    std::unordered_set<STREAM_HANDLE> early_ready_streams_;
+
+    /**
+     * Drops the early ready state recorded for the stream handle if any.
+     */
+    void forgetEarlyReadyStream(STREAM_HANDLE stream_handle);
+
     /**
      * Callback overrides
      */
@@ -66,6 +66,30 @@ bool KinesisVideoStream::putFrame(KinesisVideoFrame frame) const {
     return true;
 }
 
+bool KinesisVideoStream::putFrame(KinesisVideoFrame frame, uint64_t track_id) const {
+    frame.trackId = track_id;
+    return putFrame(frame);
+}
+
+uint32_t KinesisVideoStream::putFrames(KinesisVideoFrame* frames, uint32_t frame_count) const {
+    if (!isReady()) {
+        LOG_ERROR("Kinesis Video stream is not ready.");
+        return 0;
+    }
+
+    assert(0 != stream_handle_);
+    UINT32 stored_count = 0;
+    STATUS status = putKinesisVideoFrames(stream_handle_, frames, frame_count, &stored_count);
+    if (STATUS_FAILED(status)) {
+        std::stringstream status_strstrm;
+        status_strstrm << "0x" << std::hex << status;
+        LOG_ERROR("Failed to submit a batch of " << frame_count << " frames to Kinesis Video client. Stored "
+                                                 << stored_count << " frames. status: " << status_strstrm.str());
+    }
+
+    return stored_count;
+}
+
 bool KinesisVideoStream::start(const std::string& hexEncodedCodecPrivateData) {
     // Hex-decode the string
     const char* pStrCpd = hexEncodedCodecPrivateData.c_str();
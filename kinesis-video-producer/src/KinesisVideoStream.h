@@ -54,6 +54,27 @@ public:
      */
     bool putFrame(KinesisVideoFrame frame) const;
 
+    /**
+     * Encodes and streams the frame of the track to Kinesis Video service.
+     * The stream should have been defined with the track added.
+     *
+     * @param frame The frame to be encoded and streamed.
+     * @param track_id The id of the track the frame belongs to.
+     * @return true if the encoder accepted the frame and false otherwise.
+     */
+    bool putFrame(KinesisVideoFrame frame, uint64_t track_id) const;
+
+    /**
+     * Encodes and streams a batch of frames to Kinesis Video service. The stream is
+     * locked and notified once for the entire batch rather than for every frame.
+     *
+     * @param frames The array of frames to be encoded and streamed.
+     * @param frame_count The number of frames in the array.
+     * @return the number of the frames the encoder accepted. The frames following the
+     *      first failed frame are not accepted.
+     */
+    uint32_t putFrames(KinesisVideoFrame* frames, uint32_t frame_count) const;
+
     /**
      * Initializes the encoder with a hex-encoded codec private data
      * and puts the stream in a state that it is ready to receive frames via putFrame().
@@ -25,29 +25,70 @@ void OngoingStreamState::noteDataAvailable(UINT64 duration_available, UINT64 siz
 }
 
 void OngoingStreamState::setDataAvailable(UINT64 duration_available, UINT64 size_available) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
     duration_available_ = duration_available;
     bytes_available_ = size_available;
-    data_ready_.notify_one();
+
+    // Only wake the parked network thread once enough data has accumulated.
+    // The end-of-stream needs to be delivered right away.
+    data_notifier_.notify(size_available >= wake_bytes_threshold_ || isEndOfStream());
+    if (0 != size_available) {
+        resumeTransfer();
+    }
+}
+
+void OngoingStreamState::resumeTransfer() {
+    // Only the first notification after the pause resumes the transfer
+    if (paused_.exchange(false) && nullptr != resume_fn_) {
+        resume_fn_();
+    }
+}
+
+bool OngoingStreamState::tryAwaitData(size_t read_size, size_t* available_size) {
+    UINT64 available = bytes_available_.load();
+    while (0 < available) {
+        if (bytes_available_.compare_exchange_weak(available, available - MIN(read_size, available))) {
+            *available_size = available;
+            return true;
+        }
+    }
+
+    // Mark as paused before the re-check. Either the re-check observes the new data
+    // or the notifier observes the pause and resumes the transfer.
+    paused_ = true;
+    if (0 < bytes_available_.load() || isEndOfStream()) {
+        paused_ = false;
+        *available_size = bytes_available_.load();
+        return true;
+    }
+
+    return false;
 }
 
 size_t OngoingStreamState::awaitData(size_t read_size) {
     LOG_TRACE("Awaiting data...");
-    {
-        std::unique_lock<std::mutex> lock(data_mutex_);
-        do {
-            if (0 < bytes_available_ || isEndOfStream()) {
-                // Fast path - bytes are available so return immediately
-                size_t ret_size = bytes_available_;
-                bytes_available_ -= MIN(read_size, bytes_available_);
-                return ret_size;
+    UINT64 available, key;
+    do {
+        // Fast path - bytes are available so return immediately
+        available = bytes_available_.load();
+        while (0 < available) {
+            if (bytes_available_.compare_exchange_weak(available, available - MIN(read_size, available))) {
+                return available;
             }
-            // Slow path - block until data arrives.
-            // Wait may return without any data available due to a spurious wake up.
-            // See: https://en.wikipedia.org/wiki/Spurious_wakeup
-            data_ready_.wait(lock, [this]() { return (0 < bytes_available_ || isEndOfStream()); });
-        } while (true);
-    }
+        }
+
+        if (isEndOfStream()) {
+            return 0;
+        }
+
+        // Slow path - register as a waiter and re-check before parking so the notification is not lost.
+        // The wait is bounded by the max latency to pick up the data below the wake threshold.
+        key = data_notifier_.prepareWait();
+        if (0 < bytes_available_.load() || isEndOfStream()) {
+            data_notifier_.cancelWait();
+        } else {
+            data_notifier_.commitWait(key, max_wake_latency_);
+        }
+    } while (true);
 }
 
 size_t OngoingStreamState::postHeaderReadFunc(char *buffer, size_t item_size, size_t n_items) {
@@ -77,7 +118,17 @@ size_t OngoingStreamState::postBodyStreamingReadFunc(char *buffer, size_t item_s
             break;
         }
 
-        size_t available_bytes = awaitData(buffer_size);
+        size_t available_bytes = 0;
+        if (hasDataSpan()) {
+            // The rest of the pinned data has already been accounted for and is sent right away
+            LOG_TRACE("Sending the held data span for upload stream handle: " << upload_handle);
+        } else if (!isPausable()) {
+            available_bytes = awaitData(buffer_size);
+        } else if (!tryAwaitData(buffer_size, &available_bytes)) {
+            // Nothing to send - pause the transfer until the data becomes available
+            LOG_TRACE("Pausing the transfer for upload stream handle: " << upload_handle);
+            return CURL_READFUNC_PAUSE;
+        }
 
         // Check for EOS and shutdown after the await
         if (isEndOfStream()) {
@@ -92,13 +143,13 @@ size_t OngoingStreamState::postBodyStreamingReadFunc(char *buffer, size_t item_s
         }
 
         UINT64 client_stream_handle = 0;
-        bytes_written = 0;
-        STATUS retStatus = getKinesisVideoStreamData(
-                getStreamHandle(),
+        UINT32 filled_size = 0;
+        STATUS retStatus = getStreamDataWithSpan(
                 &client_stream_handle,
                 reinterpret_cast<PBYTE>(buffer),
-                buffer_size,
-                reinterpret_cast<PUINT32>(&bytes_written));
+                static_cast<UINT32>(buffer_size),
+                &filled_size);
+        bytes_written = filled_size;
 
         LOG_TRACE("Available bytes to read: " << available_bytes
                                               << " buffer size: "
@@ -166,9 +217,20 @@ size_t OngoingStreamState::postBodyStreamingReadFunc(char *buffer, size_t item_s
 
                 break;
 
+            case STATUS_STREAM_DATA_SPAN_PINNED:
+                // The connection of the previous upload handle is still sending its pinned data.
+                // The data available notification on the span release wakes up or resumes this transfer.
+                LOG_DEBUG("Stream data is pinned by a different upload handle.");
+                bytes_written = 0;
+
+                break;
+
             default:
                 LOG_ERROR("Failed to get data from the stream with an error: " << retStatus);
 
+                // The held span is not going to be sent
+                releaseDataSpan();
+
                 // Terminate and close the connection
                 bytes_written = CURL_READFUNC_ABORT;
         }
@@ -179,32 +241,100 @@ size_t OngoingStreamState::postBodyStreamingReadFunc(char *buffer, size_t item_s
     return bytes_written;
 }
 
+STATUS OngoingStreamState::getStreamDataWithSpan(PUINT64 client_stream_handle,
+                                                 PBYTE buffer,
+                                                 UINT32 buffer_size,
+                                                 PUINT32 filled_size) {
+    STATUS retStatus = STATUS_SUCCESS;
+    UINT32 size;
+    std::lock_guard<std::recursive_mutex> lock(data_span_mutex_);
+
+    *filled_size = 0;
+
+    // The stream might be freed after the shutdown
+    if (isShutdown()) {
+        return STATUS_STREAM_HAS_BEEN_STOPPED;
+    }
+
+    if (hasDataSpan()) {
+        // The span is only held for this upload handle
+        *client_stream_handle = getUploadHandle();
+    } else {
+        // Copy the data that fits into the buffer and pin the larger frame data instead of copying it under the lock
+        retStatus = getKinesisVideoStreamDataWithSpan(getStreamHandle(),
+                                                      client_stream_handle,
+                                                      buffer,
+                                                      buffer_size,
+                                                      filled_size,
+                                                      &data_span_);
+        data_span_offset_ = 0;
+
+        // The data for a different upload handle is dropped by the caller
+        if (hasDataSpan() && *client_stream_handle != getUploadHandle()) {
+            releaseDataSpan();
+        }
+    }
+
+    if (hasDataSpan()) {
+        // Send the pinned data straight from the content store without locking the stream
+        size = MIN(buffer_size - *filled_size, data_span_.size - data_span_offset_);
+        MEMCPY(buffer + *filled_size, data_span_.pData + data_span_offset_, size);
+        *filled_size += size;
+        data_span_offset_ += size;
+
+        if (data_span_offset_ == data_span_.size) {
+            retStatus = releaseDataSpan();
+        }
+    }
+
+    return retStatus;
+}
+
+STATUS OngoingStreamState::releaseDataSpan() {
+    STATUS retStatus = STATUS_SUCCESS;
+    std::lock_guard<std::recursive_mutex> lock(data_span_mutex_);
+
+    if (hasDataSpan() && !isShutdown()) {
+        retStatus = releaseKinesisVideoStreamDataSpan(getStreamHandle(), data_span_.releaseToken);
+    }
+
+    data_span_.releaseToken = INVALID_ALLOCATION_HANDLE_VALUE;
+
+    return retStatus;
+}
+
 size_t OngoingStreamState::postBodyStreamingWriteFunc(char *buffer, size_t item_size, size_t n_items) {
     LOG_TRACE("postBodyStreamingWriteFunc (curl callback) invoked");
 
     STATUS status = STATUS_SUCCESS;
     size_t data_size = item_size * n_items;
-    string data_as_string(buffer, data_size);
 
-    LOG_INFO("Curl post body write function for stream: "
+    // The chunk is handed to the parser as-is. The string is only built when the logging is enabled.
+    LOG_TRACE("Curl post body write function for stream: "
                      << getStreamName()
                      << " and upload handle: "
                      << getUploadHandle()
                      << " returned: "
-                     << data_as_string);
+                     << string(buffer, data_size));
 
     // The data can be passed in an arbitrary size so we can't make any assumptions.
-    // What we do is the following. We start with the initial state of expecting to have an open curly brace.
-    // We will accumulate bits until the closing curly brace. All of our ACKs have a form of
-    // {"ackEventType":"PERSISTED","fragmentTimecode":3400,"fragmentNumber":"91343852344490898070324846249945695249403494059"}
-    // and do not contain curlies inside as they are simple jsons. This assumption is valid for now but if it changes
-    // we will need to re-implement this parsing logic. We will be stream parsing the data as it comes.
+    // All of our ACKs have a form of
+    // {"EventType":"PERSISTED","FragmentTimecode":3400,"FragmentNumber":"91343852344490898070324846249945695249403494059"}
+    // The parser works on the chunk in-place and keeps its state between the calls so the ACKs can be split
+    // at any position. Curl can deliver more than the max ACK segment the parser accepts per call so the
+    // chunk is passed in slices.
 
     if (!isShutdown()) {
-        status = kinesisVideoStreamParseFragmentAck(getStreamHandle(), getUploadHandle(), buffer, data_size);
+        for (size_t offset = 0; offset < data_size && STATUS_SUCCEEDED(status); offset += MAX_ACK_FRAGMENT_LEN) {
+            status = kinesisVideoStreamParseFragmentAck(getStreamHandle(),
+                                                        getUploadHandle(),
+                                                        buffer + offset,
+                                                        (UINT32) std::min<size_t>(data_size - offset, MAX_ACK_FRAGMENT_LEN));
+        }
+
         if (STATUS_FAILED(status)) {
             LOG_ERROR("Failed to submit ACK: "
-                              << data_as_string
+                              << string(buffer, data_size)
                               << " with status code: "
                               << status);
         } else {
@@ -5,7 +5,9 @@
 #include <cstddef>
 
 #include <algorithm>
-#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <utility>
 #include <curl/curl.h>
 #include <string>
@@ -14,13 +16,28 @@
 #include "Logger.h"
 #include "com/amazonaws/kinesis/video/client/Include.h"
 #include "CallbackProvider.h"
+#include "DataAvailableNotifier.h"
 
 namespace com { namespace amazonaws { namespace kinesis { namespace video {
 
 /**
- * Internal class to wrap a condition variable that signals the curl callback that data is ready and to try to read
+ * By default the parked network thread is woken up on any data available notification
+ */
+#define DEFAULT_DATA_AVAILABLE_WAKE_BYTES_THRESHOLD             0
+
+/**
+ * Max time the parked network thread sleeps before re-checking the available data
+ */
+#define DEFAULT_DATA_AVAILABLE_MAX_WAKE_LATENCY_MILLIS          20
+
+/**
+ * Internal class to wrap a notifier that signals the curl callback that data is ready and to try to read
  * data off Kinesis Video PIC's internal data buffer in order to post it over the network.
  *
+ * The data available notifications are coalesced. The network thread is only woken up when it's parked
+ * and the available size reaches the wake threshold. Smaller amounts are picked up when the parked thread
+ * times out after the max wake latency.
+ *
  * Additionally, this class contains all the state that is needed by the postBodyStreamingFunc and is passed in as
  * the void* custom_data parameter to that class.
  */
@@ -30,18 +47,29 @@ public:
     OngoingStreamState(CallbackProvider* callback_provider,
                        UPLOAD_HANDLE upload_handle,
                        STREAM_HANDLE stream_handle,
-                       std::string stream_name)
+                       std::string stream_name,
+                       UINT64 wake_bytes_threshold = DEFAULT_DATA_AVAILABLE_WAKE_BYTES_THRESHOLD,
+                       std::chrono::milliseconds max_wake_latency =
+                               std::chrono::milliseconds(DEFAULT_DATA_AVAILABLE_MAX_WAKE_LATENCY_MILLIS))
             : stream_handle_(stream_handle), duration_available_(0),
               bytes_available_(0), stream_name_(stream_name),
               end_of_stream_(false), shutdown_(false),
               upload_handle_(upload_handle),
-              callback_provider_(callback_provider) {}
+              callback_provider_(callback_provider),
+              wake_bytes_threshold_(wake_bytes_threshold),
+              max_wake_latency_(max_wake_latency),
+              paused_(false) {
+        data_span_.pData = NULL;
+        data_span_.size = 0;
+        data_span_.releaseToken = INVALID_ALLOCATION_HANDLE_VALUE;
+        data_span_offset_ = 0;
+    }
 
     ~OngoingStreamState() = default;
 
     /**
      *
-     * Notify the condition variable that data was received and is ready for transit over the network thread.
+     * Notify the network thread that data was received and is ready for transit over the network thread.
      *
      * @param duration_available duration of the data available in 100ns.
      * @param size_available the size available for reading off Kinesis Video PIC's buffer in bytes.
@@ -49,7 +77,7 @@ public:
     void noteDataAvailable(UINT64 duration_available, UINT64 size_available);
 
     /**
-     * Blocks until this.noteDataReceived() is invoked.
+     * Blocks until this.noteDataReceived() is invoked or the max wake latency elapses with data available.
      * @param buffer_size The max buffer size to read
      * @return the bytes available for reading
      */
@@ -93,6 +121,8 @@ public:
      */
     void endOfStream() {
         end_of_stream_ = true;
+        data_notifier_.notify(true);
+        resumeTransfer();
     }
 
     /**
@@ -103,11 +133,38 @@ public:
     }
 
     /**
-     * Signals the CURL shutdown
+     * Signals the CURL shutdown.
+     * NOTE: Waits for the in-flight span operations so the stream can be freed once this returns.
      */
     void shutdown() {
         end_of_stream_ = true;
         shutdown_ = true;
+        data_notifier_.notify(true);
+        resumeTransfer();
+
+        // The held span is released with the stream
+        std::lock_guard<std::recursive_mutex> lock(data_span_mutex_);
+        data_span_.releaseToken = INVALID_ALLOCATION_HANDLE_VALUE;
+    }
+
+    /**
+     * Switches the read callback to the non-blocking mode used by the curl multi event loop.
+     *
+     * Instead of blocking the curl thread until the data is available the read callback pauses the
+     * transfer. The resume function is invoked once when the data becomes available for the paused
+     * transfer and must not block as it's called from the producer putFrame context.
+     *
+     * @param resume_fn Function to unpause the transfer
+     */
+    void setPausable(std::function<void()> resume_fn) {
+        resume_fn_ = resume_fn;
+    }
+
+    /**
+     * Returns whether the read callback pauses the transfer instead of blocking
+     */
+    bool isPausable() const {
+        return nullptr != resume_fn_;
     }
 
     /**
@@ -115,6 +172,13 @@ public:
      */
     void setDataAvailable(UINT64 duration_available, UINT64 size_available);
 
+    /**
+     * Returns the number of times the network thread has been woken up by the data available notifications
+     */
+    UINT64 getDataWakeupCount() const {
+        return data_notifier_.getWakeupCount();
+    }
+
     /**
      * Sets the current CURL response object
      */
@@ -129,6 +193,14 @@ public:
         return curl_response_;
     }
 
+    /**
+     * Releases the stream data span held across the read callbacks if any.
+     * NOTE: This is a no-op after the shutdown as the held span is released with the stream.
+     *
+     * @return Status of the span release
+     */
+    STATUS releaseDataSpan();
+
     /**
      * Returns the stream upload handle
      */
@@ -198,6 +270,40 @@ public:
 
 private:
 
+    /**
+     * Fills the buffer with the stream data. The data larger than the buffer is pinned instead of
+     * being copied under the stream lock and the span is held across the read callbacks until it's
+     * consumed so the stream is locked once per pinned frame rather than once per buffer.
+     *
+     * @param client_stream_handle OUT - client stream upload handle
+     * @param buffer Buffer to fill
+     * @param buffer_size Size of the buffer in bytes
+     * @param filled_size OUT - The number of bytes filled
+     * @return Status with the same semantics as getKinesisVideoStreamData
+     */
+    STATUS getStreamDataWithSpan(PUINT64 client_stream_handle, PBYTE buffer, UINT32 buffer_size, PUINT32 filled_size);
+
+    /**
+     * Returns whether a stream data span is held
+     */
+    bool hasDataSpan() const {
+        return IS_VALID_ALLOCATION_HANDLE(data_span_.releaseToken);
+    }
+
+    /**
+     * Non-blocking version of awaitData used in the pausable mode.
+     *
+     * @param read_size The max buffer size to read
+     * @param available_size OUT - the bytes available for reading
+     * @return true if the data is available or the stream has ended, false if the transfer needs to be paused
+     */
+    bool tryAwaitData(size_t read_size, size_t* available_size);
+
+    /**
+     * Resumes the paused transfer in the pausable mode
+     */
+    void resumeTransfer();
+
     /**
      * Stream handle
      */
@@ -213,12 +319,12 @@ private:
      * NOTE: in the future we may want to support "awaitDuration()" method call which behaves
      * similarly to awaitData(), but that it blocks until a duration is reached, instead of bytes.
      */
-    volatile UINT64 duration_available_;
+    std::atomic<UINT64> duration_available_;
 
     /**
      * The size of the data available to send to Kinesis Video PIC in bytes.
      */
-    volatile UINT64 bytes_available_;
+    std::atomic<UINT64> bytes_available_;
 
     /**
      * Stream name
@@ -231,25 +337,55 @@ private:
     UPLOAD_HANDLE upload_handle_;
 
     /**
-     * Mutex needed for the condition variable for data available locking.
+     * Notifier used to signal between the Kinesis Video PIC state machine execution context and the network thread that
+     * data is ready or to await data.
+     */
+    DataAvailableNotifier data_notifier_;
+
+    /**
+     * The available size at which the parked network thread is woken up
      */
-    std::mutex data_mutex_;
+    UINT64 wake_bytes_threshold_;
 
     /**
-     * Condition variable used to signal between the Kinesis Video PIC state machine execution context and the network thread that
-     * data is ready or to await data.
+     * Max time the network thread is parked while there is data available below the wake threshold
+     */
+    std::chrono::milliseconds max_wake_latency_;
+
+    /**
+     * Function to unpause the transfer in the pausable mode
+     */
+    std::function<void()> resume_fn_;
+
+    /**
+     * Whether the transfer has been paused by the read callback and not yet resumed
+     */
+    std::atomic<bool> paused_;
+
+    /**
+     * The stream data span held across the read callbacks
+     */
+    StreamDataSpan data_span_;
+
+    /**
+     * Guards the span against the shutdown so the span is not touched once the stream is freed
+     */
+    std::recursive_mutex data_span_mutex_;
+
+    /**
+     * The number of the held span bytes already sent
      */
-    std::condition_variable data_ready_;
+    UINT32 data_span_offset_;
 
     /**
      * Whether we have reached end-of-stream and the connection needs to be closed
      */
-    volatile bool end_of_stream_;
+    std::atomic<bool> end_of_stream_;
 
     /**
      * CURL is shutting down
      */
-    volatile bool shutdown_;
+    std::atomic<bool> shutdown_;
 
     /**
      * Ongoing CURL response object
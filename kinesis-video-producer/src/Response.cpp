@@ -1,4 +1,6 @@
 #include "Response.h"
+#include "CurlMultiEngine.h"
+#include "CurlHandlePool.h"
 
 LOGGER_TAG("com.amazonaws.kinesis.video");
 
@@ -77,11 +79,13 @@ namespace com { namespace amazonaws { namespace kinesis { namespace video {
 using std::shared_ptr;
 using std::move;
 
-shared_ptr<Response> Response::create(Request &request) {
+shared_ptr<Response> Response::create(Request &request, CurlHandlePool* handle_pool) {
 
-    // create curl handle
+    // create curl handle or pick up a pooled one along with its live connection
     shared_ptr<Response> response(new Response());
-    response->curl_ = curl_easy_init();
+    response->handle_pool_ = handle_pool;
+    response->url_ = request.get_url();
+    response->curl_ = (nullptr != handle_pool) ? handle_pool->acquire(response->url_) : curl_easy_init();
 
     // set up the friendly error message buffer
     response->error_buffer_[0] = '\0';
@@ -95,12 +99,7 @@ shared_ptr<Response> Response::create(Request &request) {
     curl_easy_setopt(response->curl_, CURLOPT_LOW_SPEED_LIMIT, 10L);
 
     // add headers
-    for (HeaderMap::const_iterator i = request.getHeaders().begin(); i != request.getHeaders().end(); ++i) {
-        std::ostringstream oss;
-        oss << i->first << ": " << i->second;
-        response->request_headers_ = curl_slist_append(response->request_headers_, oss.str().c_str());
-    }
-    curl_easy_setopt(response->curl_, CURLOPT_HTTPHEADER, response->request_headers_);
+    response->setRequestHeaders(request);
 
     // set no verification for SSL connections
     if (request.getScheme() == "https") {
@@ -163,9 +162,12 @@ shared_ptr<Response> Response::create(Request &request) {
 
 Response::Response()
         : curl_(NULL),
+          handle_pool_(nullptr),
+          reusable_(false),
           request_headers_(NULL),
           http_status_code_(0),
           terminated_(false),
+          multi_engine_(nullptr),
           service_call_result_(SERVICE_CALL_RESULT_OK),
           start_time_(std::chrono::system_clock::now()) {
 }
@@ -175,7 +177,37 @@ Response::~Response() {
 }
 
 void Response::completeSync() {
-    CURLcode result = curl_easy_perform(curl_);
+    complete(curl_easy_perform(curl_));
+}
+
+void Response::completeAsync(CURLcode result) {
+    complete(result);
+}
+
+CURL* Response::getCurlHandle() const {
+    return curl_;
+}
+
+void Response::setMultiEngine(CurlMultiEngine* multi_engine) {
+    multi_engine_ = multi_engine;
+}
+
+void Response::setRequestHeaders(const Request &request) {
+    if (request_headers_) {
+        curl_slist_free_all(request_headers_);
+        request_headers_ = NULL;
+    }
+
+    for (HeaderMap::const_iterator i = request.getHeaders().begin(); i != request.getHeaders().end(); ++i) {
+        std::ostringstream oss;
+        oss << i->first << ": " << i->second;
+        request_headers_ = curl_slist_append(request_headers_, oss.str().c_str());
+    }
+
+    curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, request_headers_);
+}
+
+void Response::complete(CURLcode result) {
     if (terminated_) {
         // The transmission has been force terminated.
         http_status_code_ = OK;
@@ -194,6 +226,9 @@ void Response::completeSync() {
             // get the response code and note the request completion time
             curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &http_status_code_);
             service_call_result_ = getServiceCallResultFromHttpStatus(http_status_code_);
+
+            // Only the cleanly completed transfers leave the handle in a reusable state
+            reusable_ = true;
         }
     }
 
@@ -218,9 +253,23 @@ void Response::completeSync() {
 void Response::terminate() {
     LOG_INFO("Force stopping the curl connection");
 
+    terminated_ = true;
+
+    // The handles might be getting closed by the completing transfer. The closed handle might
+    // have been returned to the pool and be used by another transfer already.
+    std::unique_lock<std::mutex> lock(termination_mutex_);
+    if (NULL == curl_) {
+        return;
+    }
+
+    // The event loop owns the easy handle so it needs to remove the transfer itself
+    if (nullptr != multi_engine_) {
+        multi_engine_->terminate(curl_);
+        return;
+    }
+
     // Currently, it seems that the only "good" way to stop CURL is to set
     // the timeout to a small value which will timeout the connection.
-    terminated_ = true;
     curl_easy_setopt(curl_, CURLOPT_TIMEOUT_MS, TIMEOUT_AFTER_STREAM_STOPPED);
 }
 
@@ -231,7 +280,12 @@ void Response::closeCurlHandles() {
         request_headers_ = NULL;
     }
     if (curl_) {
-        curl_easy_cleanup(curl_);
+        if (nullptr != handle_pool_) {
+            handle_pool_->release(url_, curl_, reusable_);
+        } else {
+            curl_easy_cleanup(curl_);
+        }
+
         curl_ = NULL;
     }
 }
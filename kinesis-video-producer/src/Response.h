@@ -16,6 +16,10 @@ struct curl_slist;
 }
 
 namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+class CurlMultiEngine;
+class CurlHandlePool;
+
 #define HTTP_OK 200
 
 // Setting this timeout to terminate CURL connection
@@ -26,7 +30,13 @@ class Response {
 public:
     typedef Request::HeaderMap HeaderMap;
 
-    static std::shared_ptr<Response> create(Request &request);
+    /**
+     * Creates the response for the request and sets up the curl easy handle to perform it.
+     *
+     * @param request The request
+     * @param handle_pool Optional pool to take the easy handle from and return it to once the response completes
+     */
+    static std::shared_ptr<Response> create(Request &request, CurlHandlePool* handle_pool = nullptr);
 
     ~Response();
 
@@ -41,6 +51,31 @@ public:
 
     void completeSync();
 
+    /**
+     * Completes the response once the transfer driven by the curl multi event loop is done.
+     *
+     * @param result The transfer result
+     */
+    void completeAsync(CURLcode result);
+
+    /**
+     * Returns the curl easy handle of the response
+     */
+    CURL* getCurlHandle() const;
+
+    /**
+     * Sets the curl multi event loop driving the transfer. The termination is then routed to the event loop.
+     */
+    void setMultiEngine(CurlMultiEngine* multi_engine);
+
+    /**
+     * Replaces the request headers of the transfer. Used to apply the signature of a request signed
+     * right before the transfer starts. Must be called before the transfer starts.
+     *
+     * @param request The request to take the headers from
+     */
+    void setRequestHeaders(const Request &request);
+
     // Force closes the CURL connection
     void terminate();
 
@@ -65,6 +100,8 @@ private:
 
     void closeCurlHandles();
 
+    void complete(CURLcode result);
+
     // noncopyable
     Response(const Response &);
 
@@ -72,7 +109,11 @@ private:
 
     std::mutex termination_mutex_;
     CURL *curl_;
+    CurlHandlePool* handle_pool_;
+    std::string url_;
+    bool reusable_;
     volatile bool terminated_;
+    CurlMultiEngine* multi_engine_;
     char error_buffer_[CURL_ERROR_SIZE];
     curl_slist *request_headers_;
     HeaderMap response_headers_;
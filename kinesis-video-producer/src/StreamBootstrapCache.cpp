@@ -0,0 +1,153 @@
+#include "StreamBootstrapCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+LOGGER_TAG("com.amazonaws.kinesis.video");
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+StreamBootstrapCache::StreamBootstrapCache(const std::string& path, std::chrono::seconds ttl)
+        : path_(path),
+          ttl_(ttl),
+          entries_(Json::objectValue) {
+    std::ifstream cache_file(path_);
+    if (!cache_file.is_open()) {
+        LOG_INFO("Stream bootstrap cache " << path_ << " doesn't exist yet");
+        return;
+    }
+
+    Json::Reader reader;
+    Json::Value entries = Json::nullValue;
+    if (!reader.parse(cache_file, entries) || !entries.isObject()) {
+        LOG_WARN("Ignoring the malformed stream bootstrap cache " << path_);
+        return;
+    }
+
+    entries_ = entries;
+}
+
+std::string StreamBootstrapCache::getKey(const std::string& control_plane_uri, const std::string& stream_name) {
+    return control_plane_uri + "/" + stream_name;
+}
+
+bool StreamBootstrapCache::getStreamDescription(const std::string& key, StreamDescription& stream_description) const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    const Json::Value* entry = getFreshEntry(key);
+    if (nullptr == entry || !entry->isMember("StreamARN")) {
+        return false;
+    }
+
+    const std::string device_name((*entry)["DeviceName"].asString());
+    const std::string stream_name((*entry)["StreamName"].asString());
+    const std::string content_type((*entry)["MimeType"].asString());
+    const std::string update_version((*entry)["Version"].asString());
+    const std::string stream_arn((*entry)["StreamARN"].asString());
+    if (MAX_DEVICE_NAME_LEN <= device_name.size() || MAX_STREAM_NAME_LEN <= stream_name.size() ||
+        MAX_CONTENT_TYPE_LEN <= content_type.size() || MAX_UPDATE_VERSION_LEN <= update_version.size() ||
+        MAX_ARN_LEN <= stream_arn.size() || stream_arn.empty()) {
+        return false;
+    }
+
+    std::memset(&stream_description, 0x00, sizeof(stream_description));
+    stream_description.version = STREAM_DESCRIPTION_CURRENT_VERSION;
+    std::strcpy(stream_description.deviceName, device_name.c_str());
+    std::strcpy(stream_description.streamName, stream_name.c_str());
+    std::strcpy(stream_description.contentType, content_type.c_str());
+    std::strcpy(stream_description.updateVersion, update_version.c_str());
+    std::strcpy(stream_description.streamArn, stream_arn.c_str());
+
+    // Only the active streams are stored
+    stream_description.streamStatus = STREAM_STATUS_ACTIVE;
+    stream_description.creationTime = (*entry)["CreationTime"].asUInt64();
+    return true;
+}
+
+bool StreamBootstrapCache::getDataEndpoint(const std::string& key, std::string& data_endpoint) const {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    const Json::Value* entry = getFreshEntry(key);
+    if (nullptr == entry || !entry->isMember("DataEndpoint")) {
+        return false;
+    }
+
+    data_endpoint = (*entry)["DataEndpoint"].asString();
+    return !data_endpoint.empty();
+}
+
+void StreamBootstrapCache::putStreamDescription(const std::string& key, const StreamDescription& stream_description) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    Json::Value& entry = entries_[key];
+    entry["DeviceName"] = stream_description.deviceName;
+    entry["StreamName"] = stream_description.streamName;
+    entry["MimeType"] = stream_description.contentType;
+    entry["Version"] = stream_description.updateVersion;
+    entry["StreamARN"] = stream_description.streamArn;
+    entry["CreationTime"] = (Json::UInt64) stream_description.creationTime;
+    entry["UpdateTime"] = (Json::UInt64) getCurrentTimeInSeconds();
+    persist();
+}
+
+void StreamBootstrapCache::putDataEndpoint(const std::string& key, const std::string& data_endpoint) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    Json::Value& entry = entries_[key];
+    entry["DataEndpoint"] = data_endpoint;
+    entry["UpdateTime"] = (Json::UInt64) getCurrentTimeInSeconds();
+    persist();
+}
+
+void StreamBootstrapCache::invalidate(const std::string& key) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    if (!entries_.isMember(key)) {
+        return;
+    }
+
+    LOG_INFO("Invalidating the stream bootstrap cache entry " << key);
+    entries_.removeMember(key);
+    persist();
+}
+
+const Json::Value* StreamBootstrapCache::getFreshEntry(const std::string& key) const {
+    if (!entries_.isMember(key)) {
+        return nullptr;
+    }
+
+    const Json::Value& entry = entries_[key];
+    UINT64 update_time = entry["UpdateTime"].asUInt64();
+    if (update_time + (UINT64) ttl_.count() < getCurrentTimeInSeconds()) {
+        return nullptr;
+    }
+
+    return &entry;
+}
+
+void StreamBootstrapCache::persist() const {
+    std::string temp_path = path_ + ".tmp";
+    {
+        std::ofstream cache_file(temp_path, std::ios::trunc);
+        if (!cache_file.is_open()) {
+            LOG_WARN("Unable to write the stream bootstrap cache " << temp_path);
+            return;
+        }
+
+        cache_file << Json::FastWriter().write(entries_);
+        if (!cache_file.good()) {
+            LOG_WARN("Failed writing the stream bootstrap cache " << temp_path);
+            return;
+        }
+    }
+
+    if (0 != std::rename(temp_path.c_str(), path_.c_str())) {
+        LOG_WARN("Unable to replace the stream bootstrap cache " << path_);
+    }
+}
+
+UINT64 StreamBootstrapCache::getCurrentTimeInSeconds() {
+    return (UINT64) std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
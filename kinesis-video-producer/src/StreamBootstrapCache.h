@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Logger.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+#include "json/json.h"
+#include "com/amazonaws/kinesis/video/client/Include.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+// Default period after which the cached stream bootstrap information is considered stale
+#define STREAM_BOOTSTRAP_CACHE_DEFAULT_TTL_SECONDS (24 * 60 * 60)
+
+/**
+ * File backed cache of the stream bootstrap information - the stream description returned by the describe stream
+ * call and the data endpoint returned by the get data endpoint call.
+ *
+ * The entries are keyed by the control plane URI and the stream name. On a restart the producer serves the
+ * describe stream and the get data endpoint calls from the cache so the first PutMedia connection can be opened
+ * without any control plane round trips. The cached entry is invalidated whenever the information turns out to
+ * be wrong, i.e. the service call fails or the PutMedia session terminates abnormally, so the next bootstrap goes
+ * through the service.
+ *
+ * The cache is persisted on every update by writing a temporary file and renaming it over the cache file so
+ * a crash never leaves a truncated cache behind.
+ */
+class StreamBootstrapCache {
+public:
+    /**
+     * Loads the cache from the file. A missing or unparsable file results in an empty cache.
+     *
+     * @param path Path to the cache file
+     * @param ttl Period after which the entries are considered stale
+     */
+    explicit StreamBootstrapCache(const std::string& path,
+                                  std::chrono::seconds ttl = std::chrono::seconds(STREAM_BOOTSTRAP_CACHE_DEFAULT_TTL_SECONDS));
+
+    /**
+     * Returns the cache key for the stream
+     */
+    static std::string getKey(const std::string& control_plane_uri, const std::string& stream_name);
+
+    /**
+     * Returns the cached stream description.
+     *
+     * @param key The cache key
+     * @param stream_description Stream description to fill in
+     * @return true if a fresh entry with the description has been found
+     */
+    bool getStreamDescription(const std::string& key, StreamDescription& stream_description) const;
+
+    /**
+     * Returns the cached data endpoint.
+     *
+     * @param key The cache key
+     * @param data_endpoint The data endpoint to set
+     * @return true if a fresh entry with the data endpoint has been found
+     */
+    bool getDataEndpoint(const std::string& key, std::string& data_endpoint) const;
+
+    /**
+     * Stores the stream description returned by the service and persists the cache.
+     */
+    void putStreamDescription(const std::string& key, const StreamDescription& stream_description);
+
+    /**
+     * Stores the data endpoint returned by the service and persists the cache.
+     */
+    void putDataEndpoint(const std::string& key, const std::string& data_endpoint);
+
+    /**
+     * Removes the entry and persists the cache. No-op if there is no entry for the key.
+     */
+    void invalidate(const std::string& key);
+
+private:
+    /**
+     * Returns the entry for the key if it exists and hasn't expired. Needs to be called under the lock.
+     */
+    const Json::Value* getFreshEntry(const std::string& key) const;
+
+    /**
+     * Writes out the cache. Needs to be called under the lock.
+     */
+    void persist() const;
+
+    static UINT64 getCurrentTimeInSeconds();
+
+    const std::string path_;
+    const std::chrono::seconds ttl_;
+
+    mutable std::mutex cache_mutex_;
+    Json::Value entries_;
+};
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
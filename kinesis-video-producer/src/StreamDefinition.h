@@ -7,6 +7,7 @@
 #include <tuple>
 #include <memory>
 #include <functional>
+#include <vector>
 
 #include "StreamTags.h"
 
@@ -127,6 +128,49 @@ public:
         return stream_name_;
     }
 
+    /**
+     * Adds a track to the stream. The frames of a stream with the tracks are put with the track id.
+     * The stream level content type, codec id, track name and codec private data are not used for the tracks.
+     *
+     * NOTE: The codec private data bits are not copied and should outlive the stream creation.
+     *
+     * @param track_id The track number the frames of the track are put with. 1 to MKV_MAX_TRACK_ID.
+     * @param content_type Content type of the track. The video tracks should start with "video/".
+     * @param codec_id Codec id of the track.
+     * @param track_name Human readable name of the track.
+     */
+    void addTrack(uint64_t track_id,
+                  const string& content_type,
+                  const string& codec_id,
+                  const string& track_name,
+                  const unsigned char* codecPrivateData = nullptr,
+                  uint32_t codecPrivateDataSize = 0) {
+        TrackInfo track_info;
+        memset(&track_info, 0x00, sizeof(TrackInfo));
+
+        assert(MKV_MAX_TRACK_ID >= track_id);
+        track_info.trackId = track_id;
+
+        assert(MAX_CONTENT_TYPE_LEN > content_type.size());
+        strcpy(track_info.contentType, content_type.c_str());
+
+        assert(MKV_MAX_CODEC_ID_LEN > codec_id.size());
+        strcpy(track_info.codecId, codec_id.c_str());
+
+        assert(MKV_MAX_TRACK_NAME_LEN > track_name.size());
+        strcpy(track_info.trackName, track_name.c_str());
+
+        track_info.codecPrivateDataSize = codecPrivateDataSize;
+        track_info.codecPrivateData = (PBYTE) codecPrivateData;
+
+        assert(MKV_MAX_TRACK_COUNT > track_infos_.size());
+        track_infos_.push_back(track_info);
+
+        // The vector might have been re-allocated
+        stream_info_.streamCaps.trackInfoCount = (UINT32) track_infos_.size();
+        stream_info_.streamCaps.trackInfoList = track_infos_.data();
+    }
+
     /**
      * @return An Kinesis Video StreamInfo object
      */
@@ -145,6 +189,10 @@ private:
      */
     StreamTags tags_;
 
+    /**
+     * The tracks of the stream if any
+     */
+    vector<TrackInfo> track_infos_;
 
     /**
      * The underlying object
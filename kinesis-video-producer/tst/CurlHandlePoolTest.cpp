@@ -0,0 +1,119 @@
+#include "gtest/gtest.h"
+#include "CurlCallManager.h"
+#include "CurlHandlePool.h"
+#include "LoopbackHttpServer.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+#define TEST_CALL_COUNT 5
+
+class CurlHandlePoolTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        // Ensure the curl global initialization
+        CurlCallManager::getInstance();
+        ASSERT_TRUE(server_.start());
+    }
+
+    virtual void TearDown() {
+        server_.stop();
+    }
+
+    std::shared_ptr<Response> describeStream(CurlHandlePool* handle_pool) {
+        Request request(Request::POST, server_.getEndpoint() + "/describeStream");
+        request.setBody("{\"StreamName\":\"LoopbackStream\"}");
+        std::shared_ptr<Response> response = Response::create(request, handle_pool);
+        response->completeSync();
+        return response;
+    }
+
+    LoopbackHttpServer server_;
+};
+
+TEST_F(CurlHandlePoolTest, getEndpointKey_Variations)
+{
+    EXPECT_EQ("https://kinesisvideo.us-west-2.amazonaws.com",
+              CurlHandlePool::getEndpointKey("https://kinesisvideo.us-west-2.amazonaws.com/describeStream"));
+    EXPECT_EQ("https://kinesisvideo.us-west-2.amazonaws.com",
+              CurlHandlePool::getEndpointKey("https://kinesisvideo.us-west-2.amazonaws.com"));
+    EXPECT_EQ("http://127.0.0.1:8080", CurlHandlePool::getEndpointKey("http://127.0.0.1:8080/putMedia"));
+    EXPECT_EQ("127.0.0.1:8080", CurlHandlePool::getEndpointKey("127.0.0.1:8080/putMedia"));
+}
+
+TEST_F(CurlHandlePoolTest, sequentialCalls_ReuseConnection)
+{
+    CurlHandlePool handle_pool;
+
+    for (UINT32 i = 0; i < TEST_CALL_COUNT; i++) {
+        auto response = describeStream(&handle_pool);
+        EXPECT_EQ(HTTP_OK, response->getStatusCode());
+    }
+
+    CurlHandlePoolMetrics metrics = handle_pool.getMetrics();
+    EXPECT_EQ(1, metrics.createdHandleCount);
+    EXPECT_EQ(TEST_CALL_COUNT - 1, metrics.reusedHandleCount);
+    EXPECT_EQ(1, metrics.newConnectionCount);
+    EXPECT_EQ(TEST_CALL_COUNT - 1, metrics.reusedConnectionCount);
+    EXPECT_EQ(1, server_.getAcceptedConnectionCount());
+}
+
+TEST_F(CurlHandlePoolTest, noPool_NewConnectionPerCall)
+{
+    for (UINT32 i = 0; i < TEST_CALL_COUNT; i++) {
+        auto response = describeStream(nullptr);
+        EXPECT_EQ(HTTP_OK, response->getStatusCode());
+    }
+
+    EXPECT_EQ(TEST_CALL_COUNT, server_.getAcceptedConnectionCount());
+}
+
+TEST_F(CurlHandlePoolTest, concurrentResponses_SeparateHandles)
+{
+    CurlHandlePool handle_pool;
+    Request request(Request::POST, server_.getEndpoint() + "/getDataEndpoint");
+    request.setBody("{}");
+
+    // Both responses are alive at the same time so they can't share the handle
+    auto first = Response::create(request, &handle_pool);
+    auto second = Response::create(request, &handle_pool);
+    first->completeSync();
+    second->completeSync();
+    EXPECT_EQ(HTTP_OK, first->getStatusCode());
+    EXPECT_EQ(HTTP_OK, second->getStatusCode());
+
+    // The next call picks up one of the pooled handles
+    auto third = Response::create(request, &handle_pool);
+    third->completeSync();
+    EXPECT_EQ(HTTP_OK, third->getStatusCode());
+
+    CurlHandlePoolMetrics metrics = handle_pool.getMetrics();
+    EXPECT_EQ(2, metrics.createdHandleCount);
+    EXPECT_EQ(1, metrics.reusedHandleCount);
+
+    // The second call might already reuse the connection of the first one through the shared connection cache
+    EXPECT_LE(1, metrics.reusedConnectionCount);
+}
+
+TEST_F(CurlHandlePoolTest, terminateAfterComplete_PooledHandleNotAffected)
+{
+    CurlHandlePool handle_pool;
+
+    // The completed response has returned its handle to the pool
+    auto first = describeStream(&handle_pool);
+    EXPECT_EQ(HTTP_OK, first->getStatusCode());
+
+    Request request(Request::POST, server_.getEndpoint() + "/describeStream");
+    request.setBody("{\"StreamName\":\"LoopbackStream\"}");
+    auto second = Response::create(request, &handle_pool);
+    EXPECT_EQ(1, handle_pool.getMetrics().reusedHandleCount);
+
+    // Terminating the completed response mustn't time out the transfer which has picked up its handle
+    first->terminate();
+    second->completeSync();
+    EXPECT_EQ(HTTP_OK, second->getStatusCode());
+}
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,238 @@
+#include <fstream>
+#include <sys/resource.h>
+
+#include "ProducerTestFixture.h"
+#include "LoopbackHttpServer.h"
+#include "CurlCallManager.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+#define BENCHMARK_MEASUREMENT_DURATION_SECONDS      5
+#define BENCHMARK_WARMUP_DURATION_SECONDS           1
+#define BENCHMARK_FRAME_SIZE                        2000
+#define BENCHMARK_FRAME_DURATION_MILLIS             40
+#define BENCHMARK_KEY_FRAME_INTERVAL                50
+#define BENCHMARK_STORAGE_SIZE_IN_BYTES             (256 * 1024 * 1024ull)
+#define BENCHMARK_STREAM_DRAIN_TIMEOUT_SECONDS      10
+
+class BenchmarkDeviceInfoProvider : public DefaultDeviceInfoProvider {
+public:
+    device_info_t getDeviceInfo() override {
+        auto device_info = DefaultDeviceInfoProvider::getDeviceInfo();
+        device_info.storageInfo.storageSize = BENCHMARK_STORAGE_SIZE_IN_BYTES;
+        device_info.streamCount = MAX_STREAM_COUNT;
+        return device_info;
+    }
+};
+
+/**
+ * Streams the synthetic frames for N streams against the loopback service stand-in and compares the
+ * thread per PutMedia connection mode with the curl multi event loop mode.
+ */
+class CurlMultiEngineBenchmarkTest : public ::testing::Test {
+protected:
+    struct ProcessStats {
+        UINT64 cpu_micros;
+        UINT64 rss_kb;
+        UINT64 thread_count;
+    };
+
+    virtual void SetUp() {
+        ASSERT_TRUE(server_.start());
+    }
+
+    virtual void TearDown() {
+        CurlCallManager::getInstance().setEventLoopCount(0);
+        server_.stop();
+    }
+
+    static ProcessStats getProcessStats() {
+        ProcessStats stats = {0, 0, 0};
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        stats.cpu_micros = (UINT64) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ULL +
+                usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (0 == line.compare(0, 6, "VmRSS:")) {
+                stats.rss_kb = std::stoull(line.substr(6));
+            } else if (0 == line.compare(0, 8, "Threads:")) {
+                stats.thread_count = std::stoull(line.substr(8));
+            }
+        }
+
+        return stats;
+    }
+
+    void runBenchmark(UINT32 stream_count, UINT32 event_loop_count) {
+        Credentials credentials("AccessKey", "SecretKey", "", std::chrono::seconds(TEST_STREAMING_TOKEN_DURATION_IN_SECONDS));
+        std::vector<shared_ptr<KinesisVideoStream>> streams;
+        BYTE frame_buffer[BENCHMARK_FRAME_SIZE];
+        Frame frame;
+        UINT64 start_bytes, base_timestamp, frame_duration = BENCHMARK_FRAME_DURATION_MILLIS * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        UINT32 failed_put_count = 0;
+
+        MEMSET(frame_buffer, 0x55, SIZEOF(frame_buffer));
+        CurlCallManager::getInstance().setEventLoopCount(event_loop_count);
+        ProcessStats baseline = getProcessStats();
+
+        auto producer = KinesisVideoProducer::createSync(make_unique<BenchmarkDeviceInfoProvider>(),
+                                                         make_unique<TestClientCallbackProvider>(),
+                                                         make_unique<TestStreamCallbackProvider>(),
+                                                         make_unique<TestCredentialProvider>(credentials),
+                                                         DEFAULT_AWS_REGION,
+                                                         server_.getEndpoint());
+
+        for (UINT32 i = 0; i < stream_count; i++) {
+            auto stream_definition = make_unique<StreamDefinition>("LoopbackStream_" + std::to_string(i),
+                                                                   hours(2),
+                                                                   nullptr,
+                                                                   "",
+                                                                   STREAMING_TYPE_REALTIME,
+                                                                   "video/h264",
+                                                                   milliseconds(TEST_MAX_STREAM_LATENCY_IN_MILLIS),
+                                                                   seconds(2),
+                                                                   milliseconds(1),
+                                                                   true,
+                                                                   true,
+                                                                   true,
+                                                                   true,
+                                                                   true,
+                                                                   true,
+                                                                   NAL_ADAPTATION_FLAG_NONE);
+            streams.push_back(producer->createStreamSync(move(stream_definition)));
+        }
+
+        // Produce the frames for all of the streams at the real-time rate. The timestamps advance by the frame
+        // duration so the scheduling jitter doesn't produce overlapping frames.
+        base_timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count() / DEFAULT_TIME_UNIT_IN_NANOS;
+        auto produce = [&](UINT32 seconds_to_run, UINT32& index) {
+            auto end_time = std::chrono::steady_clock::now() + std::chrono::seconds(seconds_to_run);
+            auto next_time = std::chrono::steady_clock::now();
+            while (std::chrono::steady_clock::now() < end_time) {
+                UINT64 timestamp = base_timestamp + index * frame_duration;
+                frame.index = index;
+                frame.flags = (index % BENCHMARK_KEY_FRAME_INTERVAL == 0) ? FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+                frame.decodingTs = timestamp;
+                frame.presentationTs = timestamp;
+                frame.duration = frame_duration;
+                frame.size = SIZEOF(frame_buffer);
+                frame.frameData = frame_buffer;
+                for (auto& stream : streams) {
+                    if (!stream->putFrame(frame)) {
+                        failed_put_count++;
+                    }
+                }
+
+                index++;
+                next_time += std::chrono::milliseconds(BENCHMARK_FRAME_DURATION_MILLIS);
+                std::this_thread::sleep_until(next_time);
+            }
+        };
+
+        UINT32 index = 0;
+        produce(BENCHMARK_WARMUP_DURATION_SECONDS, index);
+
+        start_bytes = server_.getPutMediaBytes();
+        ProcessStats start = getProcessStats();
+        produce(BENCHMARK_MEASUREMENT_DURATION_SECONDS, index);
+        ProcessStats end = getProcessStats();
+
+        UINT64 sent_bytes = server_.getPutMediaBytes() - start_bytes;
+        UINT32 connection_count = server_.getPutMediaConnectionCount();
+
+        // The numbers are meaningless if any of the frames were dropped
+        EXPECT_EQ(0, failed_put_count);
+        EXPECT_EQ(stream_count, connection_count);
+        EXPECT_NE(0, sent_bytes);
+        if (0 == failed_put_count) {
+            LOG_INFO("Streams: " << stream_count
+                                 << ", event loops: " << event_loop_count
+                                 << ", connections: " << connection_count
+                                 << ", cpu " << (end.cpu_micros - start.cpu_micros) / 1000 << " ms"
+                                 << " over " << BENCHMARK_MEASUREMENT_DURATION_SECONDS << " s"
+                                 << ", threads +" << (INT64) (end.thread_count - baseline.thread_count)
+                                 << ", rss " << end.rss_kb << " KB (+" << (INT64) (end.rss_kb - baseline.rss_kb) << " KB)"
+                                 << ", uploaded " << sent_bytes / 1024 << " KB");
+        }
+
+        // Stop the streams and let the uploads drain before the teardown
+        for (auto& stream : streams) {
+            EXPECT_TRUE(stream->stop());
+        }
+
+        for (UINT32 i = 0; i < BENCHMARK_STREAM_DRAIN_TIMEOUT_SECONDS * 10 && 0 != server_.getPutMediaConnectionCount(); i++) {
+            usleep(100000L);
+        }
+
+        for (auto& stream : streams) {
+            producer->freeStream(move(stream));
+        }
+    }
+
+    LoopbackHttpServer server_;
+};
+
+TEST_F(CurlMultiEngineBenchmarkTest, streams_1_ThreadPerConnection)
+{
+    runBenchmark(1, 0);
+}
+
+TEST_F(CurlMultiEngineBenchmarkTest, streams_1_EventLoop)
+{
+    if (!CurlMultiEngine::isSupported()) {
+        return;
+    }
+
+    runBenchmark(1, 1);
+}
+
+TEST_F(CurlMultiEngineBenchmarkTest, streams_8_ThreadPerConnection)
+{
+    runBenchmark(8, 0);
+}
+
+TEST_F(CurlMultiEngineBenchmarkTest, streams_8_EventLoop)
+{
+    if (!CurlMultiEngine::isSupported()) {
+        return;
+    }
+
+    runBenchmark(8, 1);
+}
+
+TEST_F(CurlMultiEngineBenchmarkTest, streams_32_ThreadPerConnection)
+{
+    runBenchmark(32, 0);
+}
+
+TEST_F(CurlMultiEngineBenchmarkTest, streams_32_EventLoop)
+{
+    if (!CurlMultiEngine::isSupported()) {
+        return;
+    }
+
+    runBenchmark(32, 1);
+}
+
+TEST_F(CurlMultiEngineBenchmarkTest, streams_64_ThreadPerConnection)
+{
+    runBenchmark(64, 0);
+}
+
+TEST_F(CurlMultiEngineBenchmarkTest, streams_64_EventLoop)
+{
+    if (!CurlMultiEngine::isSupported()) {
+        return;
+    }
+
+    runBenchmark(64, 1);
+}
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,417 @@
+#include "LoopbackHttpServer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "json/json.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+#define LOOPBACK_HTTP_SERVER_POLL_TIMEOUT_MILLIS    100
+#define LOOPBACK_HTTP_SERVER_READ_BUFFER_SIZE       (64 * 1024)
+#define LOOPBACK_HTTP_SERVER_MAX_HEADER_SIZE        (64 * 1024)
+
+LoopbackHttpServer::LoopbackHttpServer() : listen_fd_(-1),
+                                           port_(0),
+                                           stop_(false),
+                                           response_latency_(0),
+                                           put_media_bytes_(0),
+                                           put_media_connections_(0),
+                                           accepted_connections_(0) {
+}
+
+LoopbackHttpServer::~LoopbackHttpServer() {
+    stop();
+}
+
+bool LoopbackHttpServer::start() {
+    struct sockaddr_in address;
+    socklen_t address_len = sizeof(address);
+    int reuse = 1;
+
+    if (-1 == (listen_fd_ = socket(AF_INET, SOCK_STREAM, 0))) {
+        return false;
+    }
+
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    std::memset(&address, 0x00, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+
+    if (0 != bind(listen_fd_, (struct sockaddr*) &address, sizeof(address)) ||
+        0 != listen(listen_fd_, SOMAXCONN) ||
+        0 != getsockname(listen_fd_, (struct sockaddr*) &address, &address_len)) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    fcntl(listen_fd_, F_SETFL, fcntl(listen_fd_, F_GETFL) | O_NONBLOCK);
+    port_ = ntohs(address.sin_port);
+
+    stop_ = false;
+    thread_ = std::thread(&LoopbackHttpServer::run, this);
+    return true;
+}
+
+void LoopbackHttpServer::stop() {
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    for (auto& entry : connections_) {
+        closeConnection(entry.first, entry.second);
+    }
+
+    connections_.clear();
+    pending_sends_.clear();
+
+    if (-1 != listen_fd_) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+std::string LoopbackHttpServer::getEndpoint() const {
+    return "http://127.0.0.1:" + std::to_string(port_);
+}
+
+UINT32 LoopbackHttpServer::getControlPlaneCallCount(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    auto iter = control_plane_calls_.find(path);
+    return control_plane_calls_.end() == iter ? 0 : iter->second;
+}
+
+bool LoopbackHttpServer::getFirstPutMediaByteTime(const std::string& stream_name,
+                                                  std::chrono::steady_clock::time_point& time) const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    auto iter = first_put_media_byte_times_.find(stream_name);
+    if (first_put_media_byte_times_.end() == iter) {
+        return false;
+    }
+
+    time = iter->second;
+    return true;
+}
+
+void LoopbackHttpServer::run() {
+    std::vector<struct pollfd> poll_fds;
+    std::vector<char> read_buffer(LOOPBACK_HTTP_SERVER_READ_BUFFER_SIZE);
+
+    while (!stop_) {
+        int poll_timeout = sendPendingResponses();
+
+        poll_fds.clear();
+        poll_fds.push_back({listen_fd_, POLLIN, 0});
+        for (auto& entry : connections_) {
+            poll_fds.push_back({entry.first, POLLIN, 0});
+        }
+
+        if (0 >= poll(poll_fds.data(), poll_fds.size(), poll_timeout)) {
+            continue;
+        }
+
+        if (0 != (poll_fds[0].revents & POLLIN)) {
+            acceptConnections();
+        }
+
+        for (size_t i = 1; i < poll_fds.size(); i++) {
+            if (0 == poll_fds[i].revents) {
+                continue;
+            }
+
+            int fd = poll_fds[i].fd;
+            auto iter = connections_.find(fd);
+            if (connections_.end() == iter) {
+                // Already closed after the delayed response has been sent
+                continue;
+            }
+
+            auto& connection = iter->second;
+            ssize_t read_size = recv(fd, read_buffer.data(), read_buffer.size(), 0);
+            if (read_size > 0 && connection.closing) {
+                // Nothing is expected after the last response
+                continue;
+            } else if (read_size > 0) {
+                connection.buffer.append(read_buffer.data(), (size_t) read_size);
+                if (processInput(fd, connection)) {
+                    continue;
+                }
+            } else if (read_size < 0 && (EAGAIN == errno || EINTR == errno)) {
+                continue;
+            }
+
+            closeConnection(fd, connection);
+            connections_.erase(fd);
+        }
+    }
+}
+
+void LoopbackHttpServer::acceptConnections() {
+    int fd;
+    while (-1 != (fd = accept(listen_fd_, nullptr, nullptr))) {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        connections_[fd] = Connection();
+        accepted_connections_++;
+    }
+}
+
+bool LoopbackHttpServer::processInput(int fd, Connection& connection) {
+    while (true) {
+        if (!connection.headers_done && !processHeaders(fd, connection)) {
+            return false;
+        }
+
+        if (!connection.headers_done) {
+            // Need more data for the headers
+            return true;
+        }
+
+        if (connection.put_media) {
+            return processChunkedBody(fd, connection);
+        }
+
+        size_t consumed = std::min(connection.body_remaining, connection.buffer.size());
+        connection.body.append(connection.buffer, 0, consumed);
+        connection.buffer.erase(0, consumed);
+        connection.body_remaining -= consumed;
+        if (0 != connection.body_remaining) {
+            return true;
+        }
+
+        if (!sendControlPlaneResponse(fd, connection)) {
+            return false;
+        }
+
+        if (connection.closing) {
+            return true;
+        }
+
+        // Keep the connection for the next request along with any pipelined data
+        Connection next;
+        next.buffer.swap(connection.buffer);
+        connection = next;
+    }
+}
+
+bool LoopbackHttpServer::processHeaders(int fd, Connection& connection) {
+    size_t end = connection.buffer.find("\r\n\r\n");
+    if (std::string::npos == end) {
+        return connection.buffer.size() < LOOPBACK_HTTP_SERVER_MAX_HEADER_SIZE;
+    }
+
+    std::string headers = connection.buffer.substr(0, end + 2);
+    std::string original_headers = headers;
+    connection.buffer.erase(0, end + 4);
+    std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+
+    // The request line is "<method> <path> HTTP/1.1"
+    size_t path_start = headers.find(' ');
+    size_t path_end = headers.find(' ', path_start + 1);
+    if (std::string::npos == path_start || std::string::npos == path_end) {
+        return false;
+    }
+
+    connection.path = headers.substr(path_start + 1, path_end - path_start - 1);
+    connection.put_media = std::string::npos != connection.path.find("/putmedia");
+    connection.keep_alive = std::string::npos == headers.find("\r\nconnection: close");
+    connection.headers_done = true;
+
+    size_t content_length = headers.find("\r\ncontent-length:");
+    if (std::string::npos != content_length) {
+        connection.body_remaining = strtoul(headers.c_str() + content_length + strlen("\r\ncontent-length:"), nullptr, 10);
+    }
+
+    if (std::string::npos != headers.find("\r\nexpect: 100-continue")) {
+        sendResponse(fd, connection, "HTTP/1.1 100 Continue\r\n\r\n", false);
+    }
+
+    if (connection.put_media) {
+        // The header names are case insensitive unlike the stream name
+        size_t stream_name = headers.find("\r\nx-amzn-stream-name:");
+        if (std::string::npos != stream_name) {
+            stream_name += strlen("\r\nx-amzn-stream-name:");
+            size_t stream_name_end = original_headers.find("\r\n", stream_name);
+            size_t stream_name_start = original_headers.find_first_not_of(' ', stream_name);
+            if (stream_name_start < stream_name_end) {
+                connection.stream_name = original_headers.substr(stream_name_start, stream_name_end - stream_name_start);
+            }
+        }
+
+        // The service responds right away and streams the ACKs as the chunked response body
+        put_media_connections_++;
+        sendResponse(fd, connection, "HTTP/1.1 200 OK\r\n"
+                                     "Content-Type: application/json\r\n"
+                                     "Transfer-Encoding: chunked\r\n"
+                                     "\r\n", false);
+    }
+
+    return true;
+}
+
+bool LoopbackHttpServer::processChunkedBody(int fd, Connection& connection) {
+    while (!connection.buffer.empty()) {
+        if (0 != connection.chunk_remaining) {
+            size_t consumed = std::min(connection.chunk_remaining, connection.buffer.size());
+            connection.buffer.erase(0, consumed);
+            connection.chunk_remaining -= consumed;
+            put_media_bytes_ += consumed;
+            if (!connection.received_payload) {
+                connection.received_payload = true;
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                first_put_media_byte_times_[connection.stream_name] = std::chrono::steady_clock::now();
+            }
+
+            connection.chunk_trailer = (0 == connection.chunk_remaining);
+            continue;
+        }
+
+        if (connection.chunk_trailer) {
+            if (connection.buffer.size() < 2) {
+                break;
+            }
+
+            connection.buffer.erase(0, 2);
+            connection.chunk_trailer = false;
+            if (connection.done) {
+                // Complete the response and close the connection
+                return sendResponse(fd, connection, "0\r\n\r\n", true);
+            }
+
+            continue;
+        }
+
+        size_t line_end = connection.buffer.find("\r\n");
+        if (std::string::npos == line_end) {
+            break;
+        }
+
+        // Chunk extensions after the size are ignored
+        connection.chunk_remaining = strtoul(connection.buffer.c_str(), nullptr, 16);
+        connection.buffer.erase(0, line_end + 2);
+
+        // The last chunk is followed by an empty trailer
+        if (0 == connection.chunk_remaining) {
+            connection.done = true;
+            connection.chunk_trailer = true;
+        }
+    }
+
+    return true;
+}
+
+bool LoopbackHttpServer::sendControlPlaneResponse(int fd, Connection& connection) {
+    Json::Reader reader;
+    Json::Value request = Json::nullValue, response = Json::objectValue;
+    reader.parse(connection.body, request);
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        control_plane_calls_[connection.path]++;
+    }
+
+    std::string stream_name = request.get("StreamName", "stream").asString();
+    if (std::string::npos != connection.path.find("/describestream")) {
+        Json::Value stream_info = Json::objectValue;
+        stream_info["DeviceName"] = "loopback";
+        stream_info["StreamName"] = stream_name;
+        stream_info["MimeType"] = "video/h264";
+        stream_info["Version"] = "1";
+        stream_info["StreamARN"] = "arn:aws:kinesisvideo:us-west-2:123456789012:stream/" + stream_name + "/1";
+        stream_info["Status"] = "ACTIVE";
+        stream_info["CreationTime"] = (double) time(nullptr);
+        response["StreamInfo"] = stream_info;
+    } else if (std::string::npos != connection.path.find("/getdataendpoint")) {
+        response["DataEndpoint"] = getEndpoint();
+    } else if (std::string::npos != connection.path.find("/createstream")) {
+        response["StreamARN"] = "arn:aws:kinesisvideo:us-west-2:123456789012:stream/" + stream_name + "/1";
+    }
+
+    std::string body = Json::FastWriter().write(response);
+    return sendResponse(fd, connection, "HTTP/1.1 200 OK\r\n"
+                                        "Content-Type: application/json\r\n"
+                                        "Connection: " + std::string(connection.keep_alive ? "keep-alive" : "close") + "\r\n"
+                                        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                                        "\r\n" + body,
+                        !connection.keep_alive);
+}
+
+bool LoopbackHttpServer::sendResponse(int fd, Connection& connection, const std::string& data, bool close) {
+    if (0 == response_latency_.count()) {
+        sendAll(fd, data);
+        return !close;
+    }
+
+    pending_sends_.push_back({std::chrono::steady_clock::now() + response_latency_, fd, data, close});
+    connection.closing = connection.closing || close;
+    return true;
+}
+
+int LoopbackHttpServer::sendPendingResponses() {
+    auto now = std::chrono::steady_clock::now();
+    while (!pending_sends_.empty() && pending_sends_.front().send_time <= now) {
+        PendingSend pending = std::move(pending_sends_.front());
+        pending_sends_.pop_front();
+        sendAll(pending.fd, pending.data);
+
+        auto iter = connections_.find(pending.fd);
+        if (pending.close && connections_.end() != iter) {
+            closeConnection(pending.fd, iter->second);
+            connections_.erase(iter);
+        }
+    }
+
+    if (pending_sends_.empty()) {
+        return LOOPBACK_HTTP_SERVER_POLL_TIMEOUT_MILLIS;
+    }
+
+    // Round up so the poll doesn't wake up right before the send time
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(pending_sends_.front().send_time - now).count() + 1;
+    return (int) std::min<INT64>(wait, LOOPBACK_HTTP_SERVER_POLL_TIMEOUT_MILLIS);
+}
+
+void LoopbackHttpServer::sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t result = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (result > 0) {
+            sent += result;
+        } else if (result < 0 && (EAGAIN == errno || EINTR == errno)) {
+            // The responses are small so this is very unlikely on the loopback
+            std::this_thread::yield();
+        } else {
+            break;
+        }
+    }
+}
+
+void LoopbackHttpServer::closeConnection(int fd, Connection& connection) {
+    if (connection.put_media && connection.headers_done) {
+        put_media_connections_--;
+    }
+
+    // Drop the delayed responses as the descriptor might get reused
+    pending_sends_.erase(std::remove_if(pending_sends_.begin(), pending_sends_.end(),
+                                        [fd](const PendingSend& pending) { return fd == pending.fd; }),
+                         pending_sends_.end());
+    close(fd);
+}
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
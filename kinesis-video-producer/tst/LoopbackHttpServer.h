@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "com/amazonaws/kinesis/video/common/CommonDefs.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+/**
+ * Minimal HTTP/1.1 stand-in for the Kinesis Video service listening on the loopback interface.
+ *
+ * Serves the control plane calls the producer makes on the stream creation with canned responses and
+ * accepts the PutMedia uploads by decoding and discarding the chunked body. All of the connections are
+ * driven by a single poll() thread so the server itself doesn't skew the thread count of the process.
+ */
+class LoopbackHttpServer {
+public:
+    LoopbackHttpServer();
+
+    ~LoopbackHttpServer();
+
+    /**
+     * Binds to an ephemeral port on 127.0.0.1 and starts the server thread.
+     *
+     * @return true on success
+     */
+    bool start();
+
+    /**
+     * Stops the server thread and closes all of the connections.
+     */
+    void stop();
+
+    /**
+     * Delays all of the responses by the given latency to emulate the network round trip to the service.
+     * Needs to be set before the server is started.
+     */
+    void setResponseLatency(std::chrono::milliseconds latency) {
+        response_latency_ = latency;
+    }
+
+    /**
+     * @return The endpoint URI to use as the control plane and data endpoint
+     */
+    std::string getEndpoint() const;
+
+    /**
+     * @return Total number of the PutMedia payload bytes received
+     */
+    UINT64 getPutMediaBytes() const {
+        return put_media_bytes_.load();
+    }
+
+    /**
+     * @return Number of the currently open PutMedia connections
+     */
+    UINT32 getPutMediaConnectionCount() const {
+        return put_media_connections_.load();
+    }
+
+    /**
+     * @return Total number of the accepted connections
+     */
+    UINT32 getAcceptedConnectionCount() const {
+        return accepted_connections_.load();
+    }
+
+    /**
+     * @param path Lower case request path, i.e. "/describestream"
+     * @return Number of the control plane calls served for the path
+     */
+    UINT32 getControlPlaneCallCount(const std::string& path) const;
+
+    /**
+     * Returns the time the first payload byte of the latest PutMedia connection of the stream has been received.
+     *
+     * @param stream_name Name of the stream from the PutMedia request
+     * @param time The time to set
+     * @return true if any payload of the stream has been received
+     */
+    bool getFirstPutMediaByteTime(const std::string& stream_name, std::chrono::steady_clock::time_point& time) const;
+
+private:
+    struct Connection {
+        Connection() : headers_done(false), put_media(false), keep_alive(true), body_remaining(0),
+                       chunk_remaining(0), chunk_trailer(false), done(false), received_payload(false),
+                       closing(false) {}
+
+        std::string buffer;
+        bool headers_done;
+        bool put_media;
+        bool keep_alive;
+        std::string path;
+        std::string body;
+        std::string stream_name;
+
+        // Content length of the non-chunked body still to be read
+        size_t body_remaining;
+
+        // Chunked decoding state
+        size_t chunk_remaining;
+        bool chunk_trailer;
+
+        bool done;
+
+        // Whether any of the PutMedia payload has been received
+        bool received_payload;
+
+        // The connection is closed once the delayed responses are sent
+        bool closing;
+    };
+
+    struct PendingSend {
+        std::chrono::steady_clock::time_point send_time;
+        int fd;
+        std::string data;
+        bool close;
+    };
+
+    void run();
+
+    void acceptConnections();
+
+    /**
+     * Consumes the buffered input of the connection.
+     *
+     * @return false if the connection should be closed
+     */
+    bool processInput(int fd, Connection& connection);
+
+    bool processHeaders(int fd, Connection& connection);
+
+    bool processChunkedBody(int fd, Connection& connection);
+
+    /**
+     * Sends the control plane response.
+     *
+     * @return false if the connection should be closed
+     */
+    bool sendControlPlaneResponse(int fd, Connection& connection);
+
+    /**
+     * Sends the data right away or queues it until the response latency elapses.
+     *
+     * @param close Whether to close the connection after sending
+     * @return false if the connection should be closed right away
+     */
+    bool sendResponse(int fd, Connection& connection, const std::string& data, bool close);
+
+    /**
+     * Sends the queued data which is due and returns the poll timeout until the next one is.
+     */
+    int sendPendingResponses();
+
+    static void sendAll(int fd, const std::string& data);
+
+    void closeConnection(int fd, Connection& connection);
+
+    int listen_fd_;
+    UINT16 port_;
+    std::thread thread_;
+    std::atomic<bool> stop_;
+
+    std::map<int, Connection> connections_;
+
+    std::chrono::milliseconds response_latency_;
+
+    // As the latency is the same for all of the responses the queue is ordered by the send time
+    std::deque<PendingSend> pending_sends_;
+
+    mutable std::mutex stats_mutex_;
+    std::map<std::string, UINT32> control_plane_calls_;
+    std::map<std::string, std::chrono::steady_clock::time_point> first_put_media_byte_times_;
+
+    std::atomic<UINT64> put_media_bytes_;
+    std::atomic<UINT32> put_media_connections_;
+    std::atomic<UINT32> accepted_connections_;
+};
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
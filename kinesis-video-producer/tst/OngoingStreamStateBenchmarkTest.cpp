@@ -0,0 +1,198 @@
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "OngoingStreamState.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+LOGGER_TAG("com.amazonaws.kinesis.video.TEST");
+
+#define BENCHMARK_FRAME_SIZE                        1000
+#define BENCHMARK_READ_BUFFER_SIZE                  (16 * 1024)
+#define BENCHMARK_BURST_FRAME_COUNT                 200000
+#define BENCHMARK_PACED_FRAME_COUNT                 20000
+#define BENCHMARK_PACED_FRAME_INTERVAL_MICROS       100
+#define BENCHMARK_SEND_COST_MICROS                  20
+#define BENCHMARK_COALESCED_WAKE_BYTES_THRESHOLD    (8 * BENCHMARK_FRAME_SIZE)
+#define BENCHMARK_COALESCED_MAX_WAKE_LATENCY_MILLIS 2
+
+/**
+ * The mutex and condition variable signaling that OngoingStreamState used to do. Kept as the benchmark baseline.
+ */
+class MutexDataAvailableState {
+public:
+    MutexDataAvailableState() : bytes_available_(0), end_of_stream_(false), wakeup_count_(0) {}
+
+    void setDataAvailable(UINT64 duration_available, UINT64 size_available) {
+        UNUSED_PARAM(duration_available);
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        bytes_available_ = size_available;
+        data_ready_.notify_one();
+        wakeup_count_++;
+    }
+
+    void noteDataAvailable(UINT64 duration_available, UINT64 size_available) {
+        if (duration_available == 0 && size_available == 0) {
+            end_of_stream_ = true;
+        }
+
+        setDataAvailable(duration_available, size_available);
+    }
+
+    size_t awaitData(size_t read_size) {
+        std::unique_lock<std::mutex> lock(data_mutex_);
+        data_ready_.wait(lock, [this]() { return (0 < bytes_available_ || end_of_stream_); });
+        size_t ret_size = bytes_available_;
+        bytes_available_ -= MIN(read_size, bytes_available_);
+        return ret_size;
+    }
+
+    bool isEndOfStream() {
+        return end_of_stream_;
+    }
+
+    UINT64 getDataWakeupCount() const {
+        return wakeup_count_;
+    }
+
+private:
+    volatile UINT64 bytes_available_;
+    volatile bool end_of_stream_;
+    UINT64 wakeup_count_;
+    std::mutex data_mutex_;
+    std::condition_variable data_ready_;
+};
+
+class OngoingStreamStateBenchmarkTest : public ::testing::Test {
+protected:
+    static UINT64 nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void spinFor(UINT64 micros) {
+        UINT64 until = nowNanos() + micros * 1000;
+        while (nowNanos() < until);
+    }
+
+    static UINT64 cpuNanos() {
+        struct timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return (UINT64) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+
+    /**
+     * Drives the synthetic frames from the producer thread through the state and drains them
+     * on the network thread. Measures the delivery latency of the oldest pending frame,
+     * the number of wakeups and the process CPU time.
+     */
+    template <typename T> void runBenchmark(const char* name, T& state, UINT32 frame_count, UINT64 frame_interval_micros) {
+        std::atomic<UINT64> pending(0), first_pending_time(0);
+        UINT64 max_latency = 0, total_latency = 0, reads = 0, start_cpu, start_time, elapsed_time, cpu_time;
+
+        start_cpu = cpuNanos();
+        start_time = nowNanos();
+
+        std::thread network_thread([&]() {
+            while (true) {
+                state.awaitData(BENCHMARK_READ_BUFFER_SIZE);
+                if (0 != pending.exchange(0)) {
+                    // The producer might have stamped the time but not yet added the frame
+                    UINT64 first_pending = first_pending_time.exchange(0);
+                    if (0 != first_pending) {
+                        UINT64 latency = nowNanos() - first_pending;
+                        max_latency = MAX(max_latency, latency);
+                        total_latency += latency;
+                    }
+
+                    reads++;
+
+                    // Emulate the network send
+                    spinFor(BENCHMARK_SEND_COST_MICROS);
+                } else if (state.isEndOfStream()) {
+                    break;
+                }
+            }
+        });
+
+        for (UINT32 i = 0; i < frame_count; i++) {
+            UINT64 expected = 0;
+            first_pending_time.compare_exchange_strong(expected, nowNanos());
+            state.setDataAvailable(BENCHMARK_FRAME_SIZE, pending.fetch_add(BENCHMARK_FRAME_SIZE) + BENCHMARK_FRAME_SIZE);
+            if (0 != frame_interval_micros) {
+                spinFor(frame_interval_micros);
+            }
+        }
+
+        // Wait for the network thread to drain and signal the end-of-stream
+        while (0 != pending.load()) {
+            std::this_thread::yield();
+        }
+
+        state.noteDataAvailable(0, 0);
+        network_thread.join();
+
+        elapsed_time = nowNanos() - start_time;
+        cpu_time = cpuNanos() - start_cpu;
+
+        LOG_INFO(name << ": " << frame_count << " frames in " << elapsed_time / 1000000 << " ms"
+                      << ", cpu " << cpu_time / 1000000 << " ms"
+                      << ", wakeups " << state.getDataWakeupCount()
+                      << ", reads " << reads
+                      << ", avg latency " << (0 == reads ? 0 : total_latency / reads / 1000) << " us"
+                      << ", max latency " << max_latency / 1000 << " us");
+
+        EXPECT_NE(0, reads);
+        EXPECT_LE(state.getDataWakeupCount(), (UINT64) frame_count + 1);
+    }
+};
+
+TEST_F(OngoingStreamStateBenchmarkTest, burst_MutexBaseline)
+{
+    MutexDataAvailableState state;
+    runBenchmark("Mutex baseline burst", state, BENCHMARK_BURST_FRAME_COUNT, 0);
+}
+
+TEST_F(OngoingStreamStateBenchmarkTest, burst_Notifier)
+{
+    OngoingStreamState state(nullptr, 0, 0, "benchmark");
+    runBenchmark("Notifier burst", state, BENCHMARK_BURST_FRAME_COUNT, 0);
+}
+
+TEST_F(OngoingStreamStateBenchmarkTest, burst_CoalescedNotifier)
+{
+    OngoingStreamState state(nullptr, 0, 0, "benchmark",
+                             BENCHMARK_COALESCED_WAKE_BYTES_THRESHOLD,
+                             std::chrono::milliseconds(BENCHMARK_COALESCED_MAX_WAKE_LATENCY_MILLIS));
+    runBenchmark("Coalesced notifier burst", state, BENCHMARK_BURST_FRAME_COUNT, 0);
+}
+
+TEST_F(OngoingStreamStateBenchmarkTest, paced_MutexBaseline)
+{
+    MutexDataAvailableState state;
+    runBenchmark("Mutex baseline paced", state, BENCHMARK_PACED_FRAME_COUNT, BENCHMARK_PACED_FRAME_INTERVAL_MICROS);
+}
+
+TEST_F(OngoingStreamStateBenchmarkTest, paced_Notifier)
+{
+    OngoingStreamState state(nullptr, 0, 0, "benchmark");
+    runBenchmark("Notifier paced", state, BENCHMARK_PACED_FRAME_COUNT, BENCHMARK_PACED_FRAME_INTERVAL_MICROS);
+}
+
+TEST_F(OngoingStreamStateBenchmarkTest, paced_CoalescedNotifier)
+{
+    OngoingStreamState state(nullptr, 0, 0, "benchmark",
+                             BENCHMARK_COALESCED_WAKE_BYTES_THRESHOLD,
+                             std::chrono::milliseconds(BENCHMARK_COALESCED_MAX_WAKE_LATENCY_MILLIS));
+    runBenchmark("Coalesced notifier paced", state, BENCHMARK_PACED_FRAME_COUNT, BENCHMARK_PACED_FRAME_INTERVAL_MICROS);
+}
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com
@@ -0,0 +1,263 @@
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+#include "ProducerTestFixture.h"
+#include "LoopbackHttpServer.h"
+#include "DefaultCallbackProvider.h"
+#include "StreamBootstrapCache.h"
+
+namespace com { namespace amazonaws { namespace kinesis { namespace video {
+
+#define BOOTSTRAP_BENCHMARK_RESPONSE_LATENCY_MILLIS     50
+#define BOOTSTRAP_BENCHMARK_FRAME_SIZE                  2000
+#define BOOTSTRAP_BENCHMARK_FRAME_DURATION_MILLIS       40
+#define BOOTSTRAP_BENCHMARK_KEY_FRAME_INTERVAL          50
+#define BOOTSTRAP_BENCHMARK_FIRST_BYTE_TIMEOUT_SECONDS  10
+#define BOOTSTRAP_BENCHMARK_DRAIN_TIMEOUT_SECONDS       10
+
+/**
+ * Measures the time from the stream creation to the first PutMedia byte reaching the loopback service stand-in
+ * which delays every response to emulate the round trip to the service. Compares the sequential bootstrap with
+ * the cached and parallel one on the first startup with an empty cache and on a restart with a warm cache.
+ */
+class StreamBootstrapBenchmarkTest : public ::testing::Test {
+protected:
+    struct StartupResult {
+        UINT64 average_millis;
+        UINT64 max_millis;
+        UINT32 describe_calls;
+        UINT32 endpoint_calls;
+    };
+
+    virtual void SetUp() {
+        cache_path_ = "/tmp/kvs_bootstrap_cache_" + std::to_string(getpid()) + ".json";
+        std::remove(cache_path_.c_str());
+        server_.setResponseLatency(milliseconds(BOOTSTRAP_BENCHMARK_RESPONSE_LATENCY_MILLIS));
+        ASSERT_TRUE(server_.start());
+    }
+
+    virtual void TearDown() {
+        server_.stop();
+        std::remove(cache_path_.c_str());
+    }
+
+    StartupResult runStartup(const char* name, UINT32 stream_count, bool use_cache) {
+        Credentials credentials("AccessKey", "SecretKey", "", std::chrono::seconds(TEST_STREAMING_TOKEN_DURATION_IN_SECONDS));
+        std::map<std::string, std::string> tags = {{"fleet", "bootstrap-benchmark"}};
+        std::vector<shared_ptr<KinesisVideoStream>> streams;
+        std::vector<std::string> stream_names;
+        std::vector<UINT64> first_byte_millis(stream_count, 0);
+        std::vector<bool> stream_started(stream_count, false);
+        BYTE frame_buffer[BOOTSTRAP_BENCHMARK_FRAME_SIZE];
+        Frame frame;
+        StartupResult result = {0, 0, 0, 0};
+        UINT64 base_timestamp, frame_duration = BOOTSTRAP_BENCHMARK_FRAME_DURATION_MILLIS * HUNDREDS_OF_NANOS_IN_A_MILLISECOND;
+        UINT32 failed_put_count = 0;
+
+        MEMSET(frame_buffer, 0x55, SIZEOF(frame_buffer));
+        UINT32 describe_calls = server_.getControlPlaneCallCount("/describestream");
+        UINT32 endpoint_calls = server_.getControlPlaneCallCount("/getdataendpoint");
+
+        auto callback_provider = make_unique<DefaultCallbackProvider>(make_unique<TestClientCallbackProvider>(),
+                                                                      make_unique<TestStreamCallbackProvider>(),
+                                                                      make_unique<TestCredentialProvider>(credentials),
+                                                                      DEFAULT_AWS_REGION,
+                                                                      server_.getEndpoint());
+        if (use_cache) {
+            callback_provider->enableBootstrapCache(cache_path_);
+        }
+
+        auto producer = KinesisVideoProducer::createSync(make_unique<TestDeviceInfoProvider>(), move(callback_provider));
+
+        auto start_time = std::chrono::steady_clock::now();
+        for (UINT32 i = 0; i < stream_count; i++) {
+            stream_names.push_back("BootstrapStream_" + std::to_string(i));
+            auto stream_definition = make_unique<StreamDefinition>(stream_names.back(),
+                                                                   hours(2),
+                                                                   &tags,
+                                                                   "",
+                                                                   STREAMING_TYPE_REALTIME,
+                                                                   "video/h264",
+                                                                   milliseconds(TEST_MAX_STREAM_LATENCY_IN_MILLIS),
+                                                                   seconds(2),
+                                                                   milliseconds(1),
+                                                                   true,
+                                                                   true,
+                                                                   true,
+                                                                   true,
+                                                                   true,
+                                                                   true,
+                                                                   NAL_ADAPTATION_FLAG_NONE);
+            streams.push_back(producer->createStream(move(stream_definition)));
+            EXPECT_NE(nullptr, streams.back());
+        }
+
+        // Produce the frames at the real-time rate until all of the streams have reached the service. The streams
+        // get the frames once they are ready and start with a key frame. The timestamps advance by the frame
+        // duration so the scheduling jitter doesn't produce overlapping frames.
+        base_timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count() / DEFAULT_TIME_UNIT_IN_NANOS;
+        auto end_time = start_time + std::chrono::seconds(BOOTSTRAP_BENCHMARK_FIRST_BYTE_TIMEOUT_SECONDS);
+        auto next_time = start_time;
+        UINT32 pending_count = stream_count;
+        for (UINT32 index = 0; 0 != pending_count && std::chrono::steady_clock::now() < end_time; index++) {
+            UINT64 timestamp = base_timestamp + index * frame_duration;
+            frame.index = index;
+            frame.decodingTs = timestamp;
+            frame.presentationTs = timestamp;
+            frame.duration = frame_duration;
+            frame.size = SIZEOF(frame_buffer);
+            frame.frameData = frame_buffer;
+            for (UINT32 i = 0; i < stream_count; i++) {
+                if (nullptr == streams[i] || !streams[i]->isReady()) {
+                    continue;
+                }
+
+                frame.flags = (!stream_started[i] || index % BOOTSTRAP_BENCHMARK_KEY_FRAME_INTERVAL == 0) ?
+                        FRAME_FLAG_KEY_FRAME : FRAME_FLAG_NONE;
+                stream_started[i] = true;
+                if (!streams[i]->putFrame(frame)) {
+                    failed_put_count++;
+                }
+            }
+
+            // Poll for the first bytes more often than the frames are produced
+            next_time += milliseconds(BOOTSTRAP_BENCHMARK_FRAME_DURATION_MILLIS);
+            while (0 != pending_count && std::chrono::steady_clock::now() < next_time) {
+                for (UINT32 i = 0; i < stream_count; i++) {
+                    std::chrono::steady_clock::time_point first_byte_time;
+                    if (0 == first_byte_millis[i] &&
+                        server_.getFirstPutMediaByteTime(stream_names[i], first_byte_time) &&
+                        first_byte_time >= start_time) {
+                        first_byte_millis[i] = std::max<UINT64>(1, std::chrono::duration_cast<milliseconds>(
+                                first_byte_time - start_time).count());
+                        pending_count--;
+                    }
+                }
+
+                usleep(1000L);
+            }
+        }
+
+        EXPECT_EQ(0, pending_count) << name << ": not all of the streams have started streaming";
+        EXPECT_EQ(0, failed_put_count) << name << ": failed to put frames";
+
+        for (auto millis : first_byte_millis) {
+            result.average_millis += millis;
+            result.max_millis = std::max(result.max_millis, millis);
+        }
+
+        result.average_millis /= stream_count;
+        result.describe_calls = server_.getControlPlaneCallCount("/describestream") - describe_calls;
+        result.endpoint_calls = server_.getControlPlaneCallCount("/getdataendpoint") - endpoint_calls;
+
+        // The numbers are meaningless if any of the frames were dropped
+        if (0 == pending_count && 0 == failed_put_count) {
+            LOG_INFO(name << ": streams " << stream_count
+                          << ", round trip " << BOOTSTRAP_BENCHMARK_RESPONSE_LATENCY_MILLIS << " ms"
+                          << ", time to first byte average " << result.average_millis << " ms"
+                          << ", max " << result.max_millis << " ms"
+                          << ", describe stream calls " << result.describe_calls
+                          << ", get data endpoint calls " << result.endpoint_calls);
+        }
+
+        // Stop the streams gracefully so the cache entries are not invalidated
+        for (auto& stream : streams) {
+            EXPECT_TRUE(stream->stop());
+        }
+
+        for (UINT32 i = 0; i < BOOTSTRAP_BENCHMARK_DRAIN_TIMEOUT_SECONDS * 10 && 0 != server_.getPutMediaConnectionCount(); i++) {
+            usleep(100000L);
+        }
+
+        for (auto& stream : streams) {
+            producer->freeStream(move(stream));
+        }
+
+        return result;
+    }
+
+    void runBenchmark(UINT32 stream_count) {
+        StartupResult sequential = runStartup("Sequential bootstrap", stream_count, false);
+        StartupResult cold = runStartup("Parallel bootstrap with empty cache", stream_count, true);
+        StartupResult warm = runStartup("Restart with warm bootstrap cache", stream_count, true);
+
+        // The restart opens the PutMedia connection without any control plane round trips
+        EXPECT_EQ(stream_count, sequential.endpoint_calls);
+        EXPECT_EQ(stream_count, cold.endpoint_calls);
+        EXPECT_EQ(0, warm.describe_calls);
+        EXPECT_EQ(0, warm.endpoint_calls);
+        EXPECT_GT(sequential.average_millis, warm.average_millis);
+    }
+
+    LoopbackHttpServer server_;
+    std::string cache_path_;
+};
+
+TEST_F(StreamBootstrapBenchmarkTest, bootstrapCache_PersistedAcrossRestarts)
+{
+    StreamDescription stream_description, cached_description;
+    std::string data_endpoint;
+    std::string key = StreamBootstrapCache::getKey("https://kinesisvideo.us-west-2.amazonaws.com", "CachedStream");
+
+    MEMSET(&stream_description, 0x00, SIZEOF(StreamDescription));
+    STRCPY(stream_description.deviceName, "device");
+    STRCPY(stream_description.streamName, "CachedStream");
+    STRCPY(stream_description.contentType, "video/h264");
+    STRCPY(stream_description.updateVersion, "2");
+    STRCPY(stream_description.streamArn, "arn:aws:kinesisvideo:us-west-2:123456789012:stream/CachedStream/1");
+    stream_description.streamStatus = STREAM_STATUS_ACTIVE;
+    stream_description.creationTime = 12345;
+
+    {
+        StreamBootstrapCache cache(cache_path_);
+        EXPECT_FALSE(cache.getStreamDescription(key, cached_description));
+        EXPECT_FALSE(cache.getDataEndpoint(key, data_endpoint));
+        cache.putStreamDescription(key, stream_description);
+        cache.putDataEndpoint(key, "https://data.kinesisvideo.us-west-2.amazonaws.com");
+    }
+
+    // Restart
+    StreamBootstrapCache cache(cache_path_);
+    EXPECT_TRUE(cache.getStreamDescription(key, cached_description));
+    EXPECT_EQ(0, MEMCMP(&stream_description, &cached_description, SIZEOF(StreamDescription)));
+    EXPECT_TRUE(cache.getDataEndpoint(key, data_endpoint));
+    EXPECT_EQ("https://data.kinesisvideo.us-west-2.amazonaws.com", data_endpoint);
+    EXPECT_FALSE(cache.getDataEndpoint(StreamBootstrapCache::getKey("http://127.0.0.1:8080", "CachedStream"),
+                                       data_endpoint));
+
+    cache.invalidate(key);
+    EXPECT_FALSE(cache.getStreamDescription(key, cached_description));
+    EXPECT_FALSE(StreamBootstrapCache(cache_path_).getDataEndpoint(key, data_endpoint));
+}
+
+TEST_F(StreamBootstrapBenchmarkTest, bootstrapCache_StaleAndMalformedIgnored)
+{
+    std::string data_endpoint;
+    std::string key = StreamBootstrapCache::getKey("https://kinesisvideo.us-west-2.amazonaws.com", "CachedStream");
+
+    std::ofstream(cache_path_) << "{\"" << key << "\":{\"DataEndpoint\":\"https://data\",\"UpdateTime\":1}}";
+    EXPECT_FALSE(StreamBootstrapCache(cache_path_).getDataEndpoint(key, data_endpoint));
+
+    std::ofstream(cache_path_) << "{\"" << key << "\":{\"DataEndpoint\":\"https://data\",\"UpdateTime\":1}}";
+    EXPECT_TRUE(StreamBootstrapCache(cache_path_, std::chrono::seconds(INT32_MAX)).getDataEndpoint(key, data_endpoint));
+
+    std::ofstream(cache_path_) << "{\"" << key << "\":";
+    EXPECT_FALSE(StreamBootstrapCache(cache_path_).getDataEndpoint(key, data_endpoint));
+}
+
+TEST_F(StreamBootstrapBenchmarkTest, streams_1)
+{
+    runBenchmark(1);
+}
+
+TEST_F(StreamBootstrapBenchmarkTest, streams_8)
+{
+    runBenchmark(8);
+}
+
+} // namespace video
+} // namespace kinesis
+} // namespace amazonaws
+} // namespace com